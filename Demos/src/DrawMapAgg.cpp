@@ -148,5 +148,11 @@ int main(int argc, char* argv[])
     write_ppm(buffer,width,height,output.c_str());
   }
 
+  osmscout::ComposedStyleStatistics styleStatistics;
+
+  styleConfig->GetComposedStyleStatistics(styleStatistics);
+
+  std::cout << "Composed styles: " << styleStatistics.entries << ", hits " << styleStatistics.hits << ", misses " << styleStatistics.misses << std::endl;
+
   return 0;
 }
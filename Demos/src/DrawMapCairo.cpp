@@ -131,6 +131,12 @@ int main(int argc, char* argv[])
         }
       }
 
+      osmscout::ComposedStyleStatistics styleStatistics;
+
+      styleConfig->GetComposedStyleStatistics(styleStatistics);
+
+      std::cout << "Composed styles: " << styleStatistics.entries << ", hits " << styleStatistics.hits << ", misses " << styleStatistics.misses << std::endl;
+
       cairo_destroy(cairo);
     }
     else {
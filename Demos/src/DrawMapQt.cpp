@@ -133,6 +133,12 @@ int main(int argc, char* argv[])
 
       }
 
+      osmscout::ComposedStyleStatistics styleStatistics;
+
+      styleConfig->GetComposedStyleStatistics(styleStatistics);
+
+      std::cout << "Composed styles: " << styleStatistics.entries << ", hits " << styleStatistics.hits << ", misses " << styleStatistics.misses << std::endl;
+
       delete painter;
     }
     else {
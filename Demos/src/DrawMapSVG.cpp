@@ -140,5 +140,11 @@ int main(int argc, char* argv[])
 
   stream.close();
 
+  osmscout::ComposedStyleStatistics styleStatistics;
+
+  styleConfig->GetComposedStyleStatistics(styleStatistics);
+
+  std::cout << "Composed styles: " << styleStatistics.entries << ", hits " << styleStatistics.hits << ", misses " << styleStatistics.misses << std::endl;
+
   return 0;
 }
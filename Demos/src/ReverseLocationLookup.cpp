@@ -29,9 +29,26 @@ int main(int argc, char* argv[])
 {
   std::string                        map;
   std::list<osmscout::ObjectFileRef> objects;
+  bool                               coordLookup=false;
+  osmscout::GeoCoord                 coord;
 
-  if (argc<4 || argc%2!=0) {
+  if (argc==5 && strcmp("--coord",argv[2])==0) {
+    double lat;
+    double lon;
+
+    if (!osmscout::StringToNumber(argv[3],lat) ||
+        !osmscout::StringToNumber(argv[4],lon)) {
+      std::cerr << "Error: '" << argv[3] << " " << argv[4] << "' cannot be parsed to a coordinate" << std::endl;
+
+      return 1;
+    }
+
+    coord.Set(lat,lon);
+    coordLookup=true;
+  }
+  else if (argc<4 || argc%2!=0) {
     std::cerr << "AddressLookup <map directory> <ObjectType> <FileOffset>..." << std::endl;
+    std::cerr << "AddressLookup <map directory> --coord <lat> <lon>" << std::endl;
     return 1;
   }
 
@@ -39,7 +56,7 @@ int main(int argc, char* argv[])
 
   std::string searchPattern;
 
-  int argIndex=2;
+  int argIndex=coordLookup ? argc : 2;
   while (argIndex<argc) {
     osmscout::RefType    objectType=osmscout::refNone;
     osmscout::FileOffset offset=0;
@@ -87,8 +104,19 @@ int main(int argc, char* argv[])
 
   std::list<osmscout::LocationService::ReverseLookupResult> result;
 
-  if (locationService->ReverseLookupObjects(objects,
-                                            result)) {
+  bool success;
+
+  if (coordLookup) {
+    success=locationService->ReverseLookupCoord(coord,
+                                                0.1,
+                                                result);
+  }
+  else {
+    success=locationService->ReverseLookupObjects(objects,
+                                                  result);
+  }
+
+  if (success) {
     for (std::list<osmscout::LocationService::ReverseLookupResult>::const_iterator entry=result.begin();
          entry!=result.end();
          ++entry) {
@@ -65,29 +65,6 @@ static std::string TimeToString(double time)
   return stream.str();
 }
 
-static void GetCarSpeedTable(std::map<std::string,double>& map)
-{
-  map["highway_motorway"]=110.0;
-  map["highway_motorway_trunk"]=100.0;
-  map["highway_motorway_primary"]=70.0;
-  map["highway_motorway_link"]=60.0;
-  map["highway_motorway_junction"]=60.0;
-  map["highway_trunk"]=100.0;
-  map["highway_trunk_link"]=60.0;
-  map["highway_primary"]=70.0;
-  map["highway_primary_link"]=60.0;
-  map["highway_secondary"]=60.0;
-  map["highway_secondary_link"]=50.0;
-  map["highway_tertiary_link"]=55.0;
-  map["highway_tertiary"]=55.0;
-  map["highway_unclassified"]=50.0;
-  map["highway_road"]=50.0;
-  map["highway_residential"]=40.0;
-  map["highway_roundabout"]=40.0;
-  map["highway_living_street"]=10.0;
-  map["highway_service"]=30.0;
-}
-
 static std::string MoveToTurnCommand(osmscout::RouteDescription::DirectionDescription::Move move)
 {
   switch (move) {
@@ -449,6 +426,9 @@ int main(int argc, char* argv[])
   size_t                                    targetNodeIndex;
 
   bool                                      outputGPX = false;
+  osmscout::OpenListType                    openListType=osmscout::openListSet;
+  bool                                      bidirectional=false;
+  bool                                      contractionHierarchy=false;
 
   int currentArg=1;
   while (currentArg<argc) {
@@ -469,6 +449,18 @@ int main(int argc, char* argv[])
       outputGPX=true;
       currentArg++;
     }
+    else if (strcmp(argv[currentArg],"--heap")==0) {
+      openListType=osmscout::openListHeap;
+      currentArg++;
+    }
+    else if (strcmp(argv[currentArg],"--bidirectional")==0) {
+      bidirectional=true;
+      currentArg++;
+    }
+    else if (strcmp(argv[currentArg],"--ch")==0) {
+      contractionHierarchy=true;
+      currentArg++;
+    }
     else {
       // No more "special" arguments
       break;
@@ -476,7 +468,8 @@ int main(int argc, char* argv[])
   }
 
   if (argc-currentArg!=5) {
-    std::cout << "Routing <map directory>" <<std::endl;
+    std::cout << "Routing [--foot|--bicycle|--car] [--gpx] [--heap] [--bidirectional] [--ch]" << std::endl;
+    std::cout << "        <map directory>" <<std::endl;
     std::cout << "        <start lat> <start lon>" << std::endl;
     std::cout << "        <target lat> <target lon>" << std::endl;
     return 1;
@@ -521,6 +514,10 @@ int main(int argc, char* argv[])
   osmscout::FastestPathRoutingProfile routingProfile(database->GetTypeConfig());
   osmscout::RouterParameter           routerParameter;
 
+  routingProfile.SetOpenListType(openListType);
+  routingProfile.SetBidirectional(bidirectional);
+  routingProfile.SetUseContractionHierarchy(contractionHierarchy);
+
   if (!outputGPX) {
     routerParameter.SetDebugPerformance(true);
   }
@@ -550,13 +547,18 @@ int main(int argc, char* argv[])
                                          20.0);
     break;
   case osmscout::vehicleCar:
-    GetCarSpeedTable(carSpeedTable);
+    osmscout::AbstractRoutingProfile::GetDefaultCarSpeedTable(carSpeedTable);
     routingProfile.ParametrizeForCar(*typeConfig,
                                      carSpeedTable,
-                                     160.0);
+                                     osmscout::AbstractRoutingProfile::defaultCarMaxSpeed);
     break;
   }
 
+  if (contractionHierarchy &&
+      !router->CanUseContractionHierarchy(routingProfile)) {
+    std::cerr << "No contraction hierarchy available for the routing profile, using normal search" << std::endl;
+  }
+
   if (!router->GetClosestRoutableNode(startLat,
                                       startLon,
                                       vehicle,
@@ -17,9 +17,18 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 */
 
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 #include <limits>
+#include <vector>
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_MUTEX)
+#include <mutex>
+#include <thread>
+#endif
 
 #include <osmscout/Database.h>
 #include <osmscout/MapService.h>
@@ -34,12 +43,95 @@
   level directory), drawing the "Ruhrgebiet":
 
   src/Tiler ../TravelJinni/ ../TravelJinni/standard.oss 51.2 6.5 51.7 8 10 13
+
+  The same, but fetching and drawing blocks of 8x8 tiles at once using
+  4 threads:
+
+  src/Tiler ../TravelJinni/ ../TravelJinni/standard.oss 51.2 6.5 51.7 8 10 13 8 4
 */
 
 static unsigned long tileWidth=256;
 static unsigned long tileHeight=256;
 static const double  DPI=96.0;
 
+/**
+ * A block of tiles, that is fetched from the database and drawn in one go
+ */
+struct MetaTile
+{
+  size_t x;      //! X coordinate of the upper left tile
+  size_t y;      //! Y coordinate of the upper left tile
+  size_t xCount; //! Number of tiles in horizontal direction
+  size_t yCount; //! Number of tiles in vertical direction
+};
+
+/**
+ * Minimum, maximum and total time of one phase of drawing metatiles
+ */
+struct PhaseTimes
+{
+  double minTime;
+  double maxTime;
+  double totalTime;
+
+  PhaseTimes()
+  : minTime(std::numeric_limits<double>::max()),
+    maxTime(0.0),
+    totalTime(0.0)
+  {
+    // no code
+  }
+
+  void Add(double time)
+  {
+    minTime=std::min(minTime,time);
+    maxTime=std::max(maxTime,time);
+    totalTime+=time;
+  }
+
+  void Print(const std::string& phase,
+             size_t count) const
+  {
+    std::cout << phase << ": ";
+    std::cout << "total: " << totalTime << " msec ";
+    std::cout << "min: " << minTime << " msec ";
+    std::cout << "avg: " << totalTime/count << " msec ";
+    std::cout << "max: " << maxTime << " msec" << std::endl;
+  }
+};
+
+/**
+ * Everything the worker threads share while drawing the metatiles of one zoom level
+ */
+struct ZoomJob
+{
+  osmscout::MapServiceRef        mapService;
+  osmscout::StyleConfigRef       styleConfig;
+  osmscout::MapParameter         drawParameter;
+  osmscout::AreaSearchParameter  searchParameter;
+
+  osmscout::Magnification        magnification;
+  osmscout::TypeSet              nodeTypes;
+  std::vector<osmscout::TypeSet> wayTypes;
+  osmscout::TypeSet              areaTypes;
+
+  size_t                         xTileStart;
+  size_t                         yTileStart;
+  size_t                         xTileCount;
+  unsigned char*                 buffer;      //! The full map, all tiles of the zoom level
+
+  std::vector<MetaTile>          metaTiles;
+  size_t                         nextMetaTile;
+
+  PhaseTimes                     dbTimes;
+  PhaseTimes                     drawTimes;
+  PhaseTimes                     outputTimes;
+
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_MUTEX)
+  std::mutex                     mutex;       //! Guards the metatile queue, the timings and the console
+#endif
+};
+
 bool write_ppm(const agg::rendering_buffer& buffer,
                const char* file_name)
 {
@@ -62,6 +154,153 @@ bool write_ppm(const agg::rendering_buffer& buffer,
   return false;
 }
 
+static bool GetNextMetaTile(ZoomJob& job,
+                            MetaTile& metaTile)
+{
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_MUTEX)
+  std::lock_guard<std::mutex> lock(job.mutex);
+#endif
+
+  if (job.nextMetaTile>=job.metaTiles.size()) {
+    return false;
+  }
+
+  metaTile=job.metaTiles[job.nextMetaTile];
+  job.nextMetaTile++;
+
+  return true;
+}
+
+/**
+ * Fetch the objects of the metatiles of the given job, draw each metatile into
+ * one buffer and slice it into the individual tiles. Called by every worker thread.
+ */
+static void DrawMetaTiles(ZoomJob* job)
+{
+  osmscout::MapPainterAgg    painter(job->styleConfig);
+  osmscout::TileProjection   projection;
+  osmscout::MapData          data;
+  std::vector<unsigned char> buffer;
+  MetaTile                   metaTile;
+
+  while (GetNextMetaTile(*job,metaTile)) {
+    size_t           width=tileWidth*metaTile.xCount;
+    size_t           height=tileHeight*metaTile.yCount;
+    osmscout::GeoBox boundingBox1;
+    osmscout::GeoBox boundingBox2;
+
+    //
+    // Fetch the objects for the metatile. Nodes and areas of the surrounding
+    // tiles are fetched, too, to get accurate label drawing at metatile borders.
+    //
+
+    osmscout::StopClock dbTimer;
+
+    boundingBox1.Set(osmscout::GeoCoord(osmscout::TileYToLat(metaTile.y+metaTile.yCount,
+                                                             job->magnification),
+                                        osmscout::TileXToLon(metaTile.x,
+                                                             job->magnification)),
+                     osmscout::GeoCoord(osmscout::TileYToLat(metaTile.y,
+                                                             job->magnification),
+                                        osmscout::TileXToLon(metaTile.x+metaTile.xCount,
+                                                             job->magnification)));
+
+    boundingBox2.Set(osmscout::GeoCoord(osmscout::TileYToLat(metaTile.y+metaTile.yCount+1,
+                                                             job->magnification),
+                                        osmscout::TileXToLon(metaTile.x-1,
+                                                             job->magnification)),
+                     osmscout::GeoCoord(osmscout::TileYToLat(metaTile.y-1,
+                                                             job->magnification),
+                                        osmscout::TileXToLon(metaTile.x+metaTile.xCount+1,
+                                                             job->magnification)));
+
+    job->mapService->GetObjects(job->searchParameter,
+                                job->magnification,
+                                job->nodeTypes,
+                                boundingBox2,
+                                data.nodes,
+                                job->wayTypes,
+                                boundingBox1,
+                                data.ways,
+                                job->areaTypes,
+                                boundingBox2,
+                                data.areas);
+
+    dbTimer.Stop();
+
+    //
+    // Draw the metatile
+    //
+
+    osmscout::StopClock drawTimer;
+
+    buffer.assign(width*height*3,0);
+
+    agg::rendering_buffer rbuf(buffer.data(),
+                               width,
+                               height,
+                               width*3);
+    agg::pixfmt_rgb24     pf(rbuf);
+
+    projection.Set(metaTile.x,metaTile.y,
+                   metaTile.xCount,metaTile.yCount,
+                   job->magnification,
+                   DPI,
+                   width,
+                   height);
+
+    painter.DrawMap(projection,
+                    job->drawParameter,
+                    data,
+                    &pf);
+
+    drawTimer.Stop();
+
+    //
+    // Slice the metatile into tiles, copy them into the full map and write them
+    //
+
+    osmscout::StopClock outputTimer;
+
+    for (size_t y=0; y<metaTile.yCount; y++) {
+      for (size_t x=0; x<metaTile.xCount; x++) {
+        size_t tileX=metaTile.x+x;
+        size_t tileY=metaTile.y+y;
+
+        agg::rendering_buffer tileBuffer(buffer.data()+width*3*y*tileHeight+x*tileWidth*3,
+                                         tileWidth,
+                                         tileHeight,
+                                         width*3);
+
+        for (size_t row=0; row<tileHeight; row++) {
+          size_t bufferOffset=job->xTileCount*tileWidth*3*((tileY-job->yTileStart)*tileHeight+row)+
+                              (tileX-job->xTileStart)*tileWidth*3;
+
+          memcpy(job->buffer+bufferOffset,
+                 tileBuffer.row_ptr(row),
+                 tileWidth*3);
+        }
+
+        std::string output=osmscout::NumberToString(job->magnification.GetLevel())+"_"+osmscout::NumberToString(tileX)+"_"+osmscout::NumberToString(tileY)+".ppm";
+
+        write_ppm(tileBuffer,output.c_str());
+      }
+    }
+
+    outputTimer.Stop();
+
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> lock(job->mutex);
+#endif
+
+    std::cout << "Drawing metatile with bounding box " << boundingBox1.GetDisplayText() << " (" << metaTile.xCount*metaTile.yCount << " tiles)" << std::endl;
+
+    job->dbTimes.Add(dbTimer.GetMilliseconds());
+    job->drawTimes.Add(drawTimer.GetMilliseconds());
+    job->outputTimes.Add(outputTimer.GetMilliseconds());
+  }
+}
+
 int main(int argc, char* argv[])
 {
   std::string   map;
@@ -70,13 +309,15 @@ int main(int argc, char* argv[])
   unsigned long xTileStart,xTileEnd,xTileCount,yTileStart,yTileEnd,yTileCount;
   unsigned long startLevel;
   unsigned long endLevel;
+  unsigned long metaTileSize=1;
+  unsigned long threadCount=1;
 
-  if (argc!=9) {
-    std::cerr << "DrawMap ";
+  if (argc<9 || argc>11) {
+    std::cerr << "Tiler ";
     std::cerr << "<map directory> <style-file> ";
     std::cerr << "<lat_top> <lon_left> <lat_bottom> <lon_right> ";
-    std::cerr << "<start_zoom>" << std::endl;
-    std::cerr << "<end_zoom>" << std::endl;
+    std::cerr << "<start_zoom> <end_zoom> ";
+    std::cerr << "[<metatile size> [<thread count>]]" << std::endl;
     return 1;
   }
 
@@ -113,6 +354,25 @@ int main(int argc, char* argv[])
     return 1;
   }
 
+  if (argc>9 &&
+      (sscanf(argv[9],"%lu",&metaTileSize)!=1 || metaTileSize==0)) {
+    std::cerr << "metatile size is not a positive number!" << std::endl;
+    return 1;
+  }
+
+  if (argc>10 &&
+      (sscanf(argv[10],"%lu",&threadCount)!=1 || threadCount==0)) {
+    std::cerr << "thread count is not a positive number!" << std::endl;
+    return 1;
+  }
+
+#if !defined(OSMSCOUT_HAVE_THREAD) || !defined(OSMSCOUT_HAVE_MUTEX)
+  if (threadCount>1) {
+    std::cerr << "No thread support, drawing with one thread" << std::endl;
+    threadCount=1;
+  }
+#endif
+
   osmscout::DatabaseParameter databaseParameter;
   osmscout::DatabaseRef       database(new osmscout::Database(databaseParameter));
   osmscout::MapServiceRef     mapService(new osmscout::MapService(database));
@@ -129,10 +389,8 @@ int main(int argc, char* argv[])
     std::cerr << "Cannot open style" << std::endl;
   }
 
-  osmscout::TileProjection      projection;
   osmscout::MapParameter        drawParameter;
   osmscout::AreaSearchParameter searchParameter;
-  osmscout::MapData             data;
 
   // Change this, to match your system
   drawParameter.SetFontName("/usr/share/fonts/truetype/msttcorefonts/Verdana.ttf");
@@ -150,9 +408,6 @@ int main(int argc, char* argv[])
   searchParameter.SetMaximumWays(std::numeric_limits<unsigned long>::max());
   searchParameter.SetMaximumAreas(std::numeric_limits<unsigned long>::max());
 
-  osmscout::MapPainterAgg painter(styleConfig);
-  osmscout::Magnification magnification;
-
   for (size_t level=std::min(startLevel,endLevel);
        level<=std::max(startLevel,endLevel);
        level++) {
@@ -181,109 +436,71 @@ int main(int argc, char* argv[])
 
     memset(buffer,0,bitmapSize);
 
-    agg::rendering_buffer rbuf(buffer,
-                               tileWidth*xTileCount,
-                               tileHeight*yTileCount,
-                               tileWidth*xTileCount*3);
+    ZoomJob job;
 
-    double minTime=std::numeric_limits<double>::max();
-    double maxTime=0.0;
-    double totalTime=0.0;
-
-    osmscout::TypeSet              nodeTypes;
-    std::vector<osmscout::TypeSet> wayTypes;
-    osmscout::TypeSet              areaTypes;
+    job.mapService=mapService;
+    job.styleConfig=styleConfig;
+    job.drawParameter=drawParameter;
+    job.searchParameter=searchParameter;
+    job.magnification=magnification;
+    job.xTileStart=xTileStart;
+    job.yTileStart=yTileStart;
+    job.xTileCount=xTileCount;
+    job.buffer=buffer;
+    job.nextMetaTile=0;
 
     styleConfig->GetNodeTypesWithMaxMag(magnification,
-                                        nodeTypes);
+                                        job.nodeTypes);
 
     styleConfig->GetWayTypesByPrioWithMaxMag(magnification,
-                                             wayTypes);
+                                             job.wayTypes);
 
     styleConfig->GetAreaTypesWithMaxMag(magnification,
-                                        areaTypes);
-
-    for (size_t y=yTileStart; y<=yTileEnd; y++) {
-      for (size_t x=xTileStart; x<=xTileEnd; x++) {
-        agg::pixfmt_rgb24   pf(rbuf);
-        osmscout::StopClock timer;
-        osmscout::GeoBox    boundingBox1;
-        osmscout::GeoBox    boundingBox2;
-        osmscout::GeoCoord  center;
-
-        boundingBox1.Set(osmscout::GeoCoord(osmscout::TileYToLat(y+1,
-                                                                 magnification),
-                                            osmscout::TileXToLon(x,
-                                                                 magnification)),
-                         osmscout::GeoCoord(osmscout::TileYToLat(y,
-                                                                 magnification),
-                                            osmscout::TileXToLon(x+1,
-                                                                 magnification)));
-
-        boundingBox2.Set(osmscout::GeoCoord(osmscout::TileYToLat(y+2,
-                                                                 magnification),
-                                            osmscout::TileXToLon(x-1,
-                                                                 magnification)),
-                         osmscout::GeoCoord(osmscout::TileYToLat(y-1,
-                                                                 magnification),
-                                            osmscout::TileXToLon(x+2,
-                                                                 magnification)));
-
-        center=boundingBox1.GetCenter();
-
-        std::cout << "Drawing tile with bounding box " << boundingBox1.GetDisplayText() << " and center " << center.GetDisplayText() << std::endl;
-        //std::cout << x << "," << y << "/";
-        //std::cout << x-xTileStart << "," << y-yTileStart << std::endl;
-
-        projection.Set(x,y,
-                       magnification,
-                       DPI,
-                       tileWidth,
-                       tileHeight);
-
-
-        mapService->GetObjects(searchParameter,
-                               projection.GetMagnification(),
-                               nodeTypes,
-                               boundingBox2,
-                               data.nodes,
-                               wayTypes,
-                               boundingBox1,
-                               data.ways,
-                               areaTypes,
-                               boundingBox2,
-                               data.areas);
-
-        size_t bufferOffset=xTileCount*tileWidth*3*(y-yTileStart)*tileHeight+
-                            (x-xTileStart)*tileWidth*3;
-
-        rbuf.attach(buffer+bufferOffset,
-                    tileWidth,tileHeight,
-                    tileWidth*xTileCount*3);
-
-        painter.DrawMap(projection,
-                        drawParameter,
-                        data,
-                        &pf);
-
-        timer.Stop();
-
-        double time=timer.GetMilliseconds();
-
-        minTime=std::min(minTime,time);
-        maxTime=std::max(maxTime,time);
-        totalTime+=time;
-
-        std::string output=osmscout::NumberToString(level)+"_"+osmscout::NumberToString(x)+"_"+osmscout::NumberToString(y)+".ppm";
-
-        write_ppm(rbuf,output.c_str());
+                                        job.areaTypes);
+
+    // Metatiles are aligned to multiples of the metatile size, metatiles at the
+    // border of the requested area are clipped
+    for (size_t y=yTileStart/metaTileSize; y<=yTileEnd/metaTileSize; y++) {
+      for (size_t x=xTileStart/metaTileSize; x<=xTileEnd/metaTileSize; x++) {
+        MetaTile metaTile;
+
+        metaTile.x=std::max((size_t)xTileStart,x*metaTileSize);
+        metaTile.y=std::max((size_t)yTileStart,y*metaTileSize);
+        metaTile.xCount=std::min((size_t)xTileEnd,(x+1)*metaTileSize-1)-metaTile.x+1;
+        metaTile.yCount=std::min((size_t)yTileEnd,(y+1)*metaTileSize-1)-metaTile.y+1;
+
+        job.metaTiles.push_back(metaTile);
+      }
+    }
+
+    osmscout::StopClock timer;
+
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_MUTEX)
+    if (threadCount>1) {
+      std::vector<std::thread> threads;
+
+      for (size_t t=0; t<std::min((size_t)threadCount,job.metaTiles.size()); t++) {
+        threads.push_back(std::thread(DrawMetaTiles,
+                                      &job));
+      }
+
+      for (auto& thread : threads) {
+        thread.join();
       }
     }
+    else {
+      DrawMetaTiles(&job);
+    }
+#else
+    DrawMetaTiles(&job);
+#endif
 
-    rbuf.attach(buffer,
-                tileWidth*xTileCount,
-                tileHeight*yTileCount,
-                tileWidth*xTileCount*3);
+    timer.Stop();
+
+    agg::rendering_buffer rbuf(buffer,
+                               tileWidth*xTileCount,
+                               tileHeight*yTileCount,
+                               tileWidth*xTileCount*3);
 
     std::string output=osmscout::NumberToString(level)+"_full_map.ppm";
 
@@ -291,11 +508,12 @@ int main(int argc, char* argv[])
 
     delete[] buffer;
 
-    std::cout << "=> Time: ";
-    std::cout << "total: " << totalTime << " msec ";
-    std::cout << "min: " << minTime << " msec ";
-    std::cout << "avg: " << totalTime/(xTileCount*yTileCount) << " msec ";
-    std::cout << "max: " << maxTime << " msec" << std::endl;
+    std::cout << "=> " << job.metaTiles.size() << " metatiles, " << xTileCount*yTileCount << " tiles, " << threadCount << " threads" << std::endl;
+    job.dbTimes.Print("GetObjects",job.metaTiles.size());
+    job.drawTimes.Print("DrawMap",job.metaTiles.size());
+    job.outputTimes.Print("Output",job.metaTiles.size());
+    std::cout << "Time: " << timer.GetMilliseconds() << " msec, ";
+    std::cout << xTileCount*yTileCount*1000.0/std::max(timer.GetMilliseconds(),1.0) << " tiles/s" << std::endl;
   }
 
   database->Close();
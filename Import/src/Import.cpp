@@ -55,13 +55,16 @@ static const char* BoolToString(bool value)
 
 void DumpHelp(osmscout::ImportParameter& parameter)
 {
-  std::cout << "Import -h -d -s <start step> -e <end step> [openstreetmapdata.osm|openstreetmapdata.osm.pbf]..." << std::endl;
+  std::cout << "Import -h -d -s <start step> -e <end step> [openstreetmapdata.osm|openstreetmapdata.osm.pbf]... [changes.osc]..." << std::endl;
+  std::cout << "  (changes.osc are merged into the other files before the import, they are clipped to" << std::endl;
+  std::cout << "  the imported data; this is no incremental update of an existing database)" << std::endl;
   std::cout << " -h|--help                            show this help" << std::endl;
   std::cout << " -d                                   show debug output" << std::endl;
   std::cout << " -s <start step>                      set starting step" << std::endl;
   std::cout << " -s <end step>                        set final step" << std::endl;
   std::cout << " --typefile <path>                    path and name of the map.ost file (default: " << parameter.GetTypefile() << ")" << std::endl;
   std::cout << " --destinationDirectory <path>        destination for generated map files (default: " << parameter.GetDestinationDirectory() << ")" << std::endl;
+  std::cout << " --threadCount <number>               number of threads and parallel import steps (default: " << parameter.GetThreadCount() << ")" << std::endl;
 
   std::cout << " --strictAreas true|false             assure that areas are simple (default: " << BoolToString(parameter.GetStrictAreas()) << ")" << std::endl;
 
@@ -79,7 +82,7 @@ void DumpHelp(osmscout::ImportParameter& parameter)
   std::cout << " --rawWayBlockSize <number>           number of raw ways resolved in block (default: " << parameter.GetRawWayBlockSize() << ")" << std::endl;
 
   std::cout << " --noSort                             do not sort objects" << std::endl;
-  std::cout << " --sortBlockSize <number>             size of one data block during sorting (default: " << parameter.GetSortBlockSize() << ")" << std::endl;
+  std::cout << " --sortBufferSize <number>            size of the memory buffer in bytes used for sorting (default: " << parameter.GetSortBufferSize() << ")" << std::endl;
 
   std::cout << " --areaDataMemoryMaped true|false     memory maped area data file access (default: " << BoolToString(parameter.GetAreaDataMemoryMaped()) << ")" << std::endl;
   std::cout << " --areaDataCacheSize <number>         area data cache size (default: " << parameter.GetAreaDataCacheSize() << ")" << std::endl;
@@ -88,6 +91,8 @@ void DumpHelp(osmscout::ImportParameter& parameter)
   std::cout << " --wayDataCacheSize <number>          way data cache size (default: " << parameter.GetWayDataCacheSize() << ")" << std::endl;
 
   std::cout << " --routeNodeBlockSize <number>        number of route nodes resolved in block (default: " << BoolToString(parameter.GetRouteNodeBlockSize()) << ")" << std::endl;
+  std::cout << " --routeReversePaths true|false       write reverse paths for bidirectional routing (default: " << BoolToString(parameter.GetRouteReversePaths()) << ")" << std::endl;
+  std::cout << " --routeContractionHierarchy true|false calculate contraction hierarchy for car routing (default: " << BoolToString(parameter.GetRouteContractionHierarchy()) << ")" << std::endl;
 }
 
 bool ParseBoolArgument(int argc,
@@ -196,6 +201,8 @@ bool CountDataSize(osmscout::Progress& progress,
   files.push_back("areaway.idx");
 
   files.push_back("location.idx");
+  files.push_back("locationsearch.idx");
+  files.push_back("reverselocation.idx");
 
   files.push_back("water.idx");
 
@@ -239,6 +246,7 @@ int main(int argc, char* argv[])
   std::list<std::string>    mapfiles;
   std::string               typefile=parameter.GetTypefile();
   std::string               destinationDirectory=parameter.GetDestinationDirectory();
+  size_t                    threadCount=parameter.GetThreadCount();
 
   size_t                    startStep=parameter.GetStartStep();
   size_t                    endStep=parameter.GetEndStep();
@@ -247,7 +255,7 @@ int main(int argc, char* argv[])
 
   size_t                    numericIndexPageSize=parameter.GetNumericIndexPageSize();
 
-  size_t                    sortBlockSize=parameter.GetSortBlockSize();
+  size_t                    sortBufferSize=parameter.GetSortBufferSize();
 
   bool                      coordDataMemoryMaped=parameter.GetCoordDataMemoryMaped();
 
@@ -267,6 +275,8 @@ int main(int argc, char* argv[])
   size_t                    wayDataCacheSize=parameter.GetWayDataCacheSize();
 
   size_t                    routeNodeBlockSize=parameter.GetRouteNodeBlockSize();
+  bool                      routeReversePaths=parameter.GetRouteReversePaths();
+  bool                      routeContractionHierarchy=parameter.GetRouteContractionHierarchy();
 
   // Simple way to analyse command line parameters, but enough for now...
   int i=1;
@@ -310,6 +320,12 @@ int main(int argc, char* argv[])
                                           i,
                                           destinationDirectory);
     }
+    else if (strcmp(argv[i],"--threadCount")==0) {
+      parameterError=!ParseSizeTArgument(argc,
+                                         argv,
+                                         i,
+                                         threadCount);
+    }
     else if (strcmp(argv[i],"--strictAreas")==0) {
       parameterError=!ParseBoolArgument(argc,
                                         argv,
@@ -375,11 +391,11 @@ int main(int argc, char* argv[])
 
       i++;
     }
-    else if (strcmp(argv[i],"--sortBlockSize")==0) {
+    else if (strcmp(argv[i],"--sortBufferSize")==0) {
       parameterError=!ParseSizeTArgument(argc,
                                          argv,
                                          i,
-                                         sortBlockSize);
+                                         sortBufferSize);
     }
     else if (strcmp(argv[i],"--areaDataMemoryMaped")==0) {
       parameterError=!ParseBoolArgument(argc,
@@ -411,6 +427,18 @@ int main(int argc, char* argv[])
                                          i,
                                          routeNodeBlockSize);
     }
+    else if (strcmp(argv[i],"--routeReversePaths")==0) {
+      parameterError=!ParseBoolArgument(argc,
+                                        argv,
+                                        i,
+                                        routeReversePaths);
+    }
+    else if (strcmp(argv[i],"--routeContractionHierarchy")==0) {
+      parameterError=!ParseBoolArgument(argc,
+                                        argv,
+                                        i,
+                                        routeContractionHierarchy);
+    }
     else if (strncmp(argv[i],"--",2)==0) {
       std::cerr << "Unknown option: " << argv[i] << std::endl;
 
@@ -437,13 +465,14 @@ int main(int argc, char* argv[])
   parameter.SetMapfiles(mapfiles);
   parameter.SetTypefile(typefile);
   parameter.SetDestinationDirectory(destinationDirectory);
+  parameter.SetThreadCount(threadCount);
   parameter.SetSteps(startStep,endStep);
 
   parameter.SetStrictAreas(strictAreas);
 
   parameter.SetNumericIndexPageSize(numericIndexPageSize);
 
-  parameter.SetSortBlockSize(sortBlockSize);
+  parameter.SetSortBufferSize(sortBufferSize);
 
   parameter.SetCoordDataMemoryMaped(coordDataMemoryMaped);
 
@@ -463,6 +492,8 @@ int main(int argc, char* argv[])
   parameter.SetWayDataCacheSize(wayDataCacheSize);
 
   parameter.SetRouteNodeBlockSize(routeNodeBlockSize);
+  parameter.SetRouteReversePaths(routeReversePaths);
+  parameter.SetRouteContractionHierarchy(routeContractionHierarchy);
 
   parameter.SetOptimizationWayMethod(osmscout::TransPolygon::quality);
 
@@ -472,6 +503,8 @@ int main(int argc, char* argv[])
   }
   progress.Info(std::string("typefile: ")+parameter.GetTypefile());
   progress.Info(std::string("Destination directory: ")+parameter.GetDestinationDirectory());
+  progress.Info(std::string("ThreadCount: ")+
+                osmscout::NumberToString(parameter.GetThreadCount()));
   progress.Info(std::string("Steps: ")+
                 osmscout::NumberToString(parameter.GetStartStep())+
                 " - "+
@@ -505,8 +538,8 @@ int main(int argc, char* argv[])
 
   progress.Info(std::string("SortObjects: ")+
                 (parameter.GetSortObjects() ? "true" : "false"));
-  progress.Info(std::string("SortBlockSize: ")+
-                osmscout::NumberToString(parameter.GetSortBlockSize()));
+  progress.Info(std::string("SortBufferSize: ")+
+                osmscout::NumberToString(parameter.GetSortBufferSize()));
 
   progress.Info(std::string("AreaDataMemoryMaped: ")+
                 (parameter.GetAreaDataMemoryMaped() ? "true" : "false"));
@@ -520,6 +553,10 @@ int main(int argc, char* argv[])
 
   progress.Info(std::string("RouteNodeBlockSize: ")+
                 osmscout::NumberToString(parameter.GetRouteNodeBlockSize()));
+  progress.Info(std::string("RouteReversePaths: ")+
+                (parameter.GetRouteReversePaths() ? "true" : "false"));
+  progress.Info(std::string("RouteContractionHierarchy: ")+
+                (parameter.GetRouteContractionHierarchy() ? "true" : "false"));
 
   bool result=osmscout::Import(parameter,
                                progress);
@@ -0,0 +1,319 @@
+/*
+  AreaIsSimplePerformance - a test program for libosmscout
+  Copyright (C) 2015  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <osmscout/Area.h>
+#include <osmscout/GeoCoord.h>
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/Geometry.h>
+#include <osmscout/util/StopClock.h>
+#include <osmscout/util/String.h>
+
+/**
+  Compare the sweep line based AreaIsSimple() with the former implementation,
+  which tested every pair of edges.
+
+  If a map directory is given, the largest rings of the areas in 'areas.dat'
+  are used. Else rings are generated: they are star shaped with a randomly
+  walking radius, which gives coastline like rings with many small details.
+  Generated rings are simple by construction.
+
+  For every ring a second, complex version is generated by swapping two
+  different nodes. Both implementations must return the same result for the
+  original and for the complex ring.
+*/
+
+static const size_t minRealRingNodes=1000;
+static const size_t maxRealRingCount=10;
+
+static bool AreaIsSimplePairwise(std::vector<osmscout::GeoCoord> points)
+{
+  if (points.size()<3) {
+    return false;
+  }
+
+  points.push_back(points[0]);
+
+  size_t edgesIntersect=0;
+
+  for (size_t i=0; i<points.size()-1; i++) {
+    edgesIntersect=0;
+
+    for (size_t j=i+1; j<points.size()-1; j++) {
+      if (osmscout::LinesIntersect(points[i],
+                                   points[i+1],
+                                   points[j],
+                                   points[j+1])) {
+        edgesIntersect++;
+
+        if (i==0) {
+          if (edgesIntersect>2) {
+            return false;
+          }
+        }
+        else {
+          if (edgesIntersect>1) {
+            return false;
+          }
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+static void GenerateRing(size_t nodeCount,
+                         std::vector<osmscout::GeoCoord>& ring)
+{
+  double lat=47.0;
+  double lon=10.0;
+  double radius=0.5;
+
+  ring.clear();
+  ring.reserve(nodeCount);
+
+  for (size_t n=0; n<nodeCount; n++) {
+    double angle=n*2*M_PI/nodeCount;
+
+    radius+=(rand()-RAND_MAX/2)*0.01/RAND_MAX;
+    radius=std::max(0.1,std::min(0.9,radius));
+
+    ring.push_back(osmscout::GeoCoord(lat+radius*sin(angle),
+                                      lon+radius*cos(angle)));
+  }
+}
+
+static bool IsLarger(const std::vector<osmscout::GeoCoord>& a,
+                     const std::vector<osmscout::GeoCoord>& b)
+{
+  return a.size()>b.size();
+}
+
+/**
+ * Load the largest rings (with at least minRealRingNodes nodes) of all
+ * areas in the given map directory
+ */
+static bool LoadRings(const std::string& map,
+                      std::vector<std::vector<osmscout::GeoCoord> >& rings)
+{
+  osmscout::TypeConfig  typeConfig;
+  osmscout::FileScanner scanner;
+  uint32_t              areaCount;
+
+  if (!typeConfig.LoadFromDataFile(map)) {
+    std::cerr << "Cannot open type configuration!" << std::endl;
+    return false;
+  }
+
+  if (!scanner.Open(osmscout::AppendFileToDir(map,
+                                              "areas.dat"),
+                    osmscout::FileScanner::Sequential,
+                    true)) {
+    std::cerr << "Cannot open '" << scanner.GetFilename() << "'!" << std::endl;
+    return false;
+  }
+
+  if (!scanner.Read(areaCount)) {
+    std::cerr << "Cannot read number of entries!" << std::endl;
+    return false;
+  }
+
+  for (uint32_t a=1; a<=areaCount; a++) {
+    osmscout::Area area;
+
+    if (!area.Read(typeConfig,
+                   scanner)) {
+      std::cerr << "Cannot read area " << a << " of " << areaCount << "!" << std::endl;
+      return false;
+    }
+
+    for (const auto& ring : area.rings) {
+      if (ring.nodes.size()>=minRealRingNodes) {
+        rings.push_back(ring.nodes);
+      }
+    }
+  }
+
+  std::sort(rings.begin(),
+            rings.end(),
+            IsLarger);
+
+  if (rings.size()>maxRealRingCount) {
+    rings.resize(maxRealRingCount);
+  }
+
+  return scanner.Close();
+}
+
+/**
+ * Make the ring complex by swapping two different nodes. Real rings can be
+ * complex already, else we retry until the swap results in a complex ring.
+ */
+static bool MakeComplexRing(const std::vector<osmscout::GeoCoord>& ring,
+                            std::vector<osmscout::GeoCoord>& complexRing)
+{
+  for (size_t attempt=0; attempt<10; attempt++) {
+    size_t a=rand()%ring.size();
+    size_t b=rand()%(ring.size()-1);
+
+    // Skip a, so that both indexes always differ
+    if (b>=a) {
+      b++;
+    }
+
+    complexRing=ring;
+    std::swap(complexRing[a],
+              complexRing[b]);
+
+    if (!AreaIsSimplePairwise(complexRing)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static bool CompareRing(const std::string& name,
+                        const std::vector<osmscout::GeoCoord>& ring,
+                        bool simpleByConstruction,
+                        size_t iterations)
+{
+  std::vector<osmscout::GeoCoord> complexRing;
+
+  if (!MakeComplexRing(ring,
+                       complexRing)) {
+    std::cerr << name << ": Cannot create a complex version of the ring!" << std::endl;
+    return false;
+  }
+
+  bool                pairwiseSimple=false;
+  bool                pairwiseComplex=false;
+  osmscout::StopClock pairwiseTimer;
+
+  for (size_t i=0; i<iterations; i++) {
+    pairwiseSimple=AreaIsSimplePairwise(ring);
+    pairwiseComplex=AreaIsSimplePairwise(complexRing);
+  }
+
+  pairwiseTimer.Stop();
+
+  bool                sweepSimple=false;
+  bool                sweepComplex=false;
+  osmscout::StopClock sweepTimer;
+
+  for (size_t i=0; i<iterations; i++) {
+    sweepSimple=osmscout::AreaIsSimple(ring);
+    sweepComplex=osmscout::AreaIsSimple(complexRing);
+  }
+
+  sweepTimer.Stop();
+
+  std::cout << name << ", " << ring.size() << " nodes, " << iterations << " iteration(s)" << std::endl;
+  std::cout << "Pairwise:   " << pairwiseTimer.ResultString() << std::endl;
+  std::cout << "Sweep line: " << sweepTimer.ResultString() << std::endl;
+
+  if (simpleByConstruction &&
+      !pairwiseSimple) {
+    std::cerr << name << ": Generated ring is not simple!" << std::endl;
+    return false;
+  }
+
+  if (sweepSimple!=pairwiseSimple) {
+    std::cerr << name << ": Results for the ring differ!" << std::endl;
+    return false;
+  }
+
+  if (pairwiseComplex ||
+      sweepComplex!=pairwiseComplex) {
+    std::cerr << name << ": Results for the complex ring differ!" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  bool success=true;
+
+  if (argc>2) {
+    std::cerr << "AreaIsSimplePerformance [<map directory>]" << std::endl;
+    return 1;
+  }
+
+  srand(42);
+
+  if (argc==2) {
+    std::vector<std::vector<osmscout::GeoCoord> > rings;
+
+    if (!LoadRings(argv[1],
+                   rings)) {
+      return 1;
+    }
+
+    if (rings.empty()) {
+      std::cerr << "No ring with at least " << minRealRingNodes << " nodes found!" << std::endl;
+      return 1;
+    }
+
+    for (size_t r=0; r<rings.size(); r++) {
+      if (!CompareRing("Ring #"+osmscout::NumberToString(r+1),
+                       rings[r],
+                       false,
+                       1)) {
+        success=false;
+      }
+    }
+  }
+  else {
+    size_t nodeCounts[]={100,1000,5000,10000};
+
+    for (size_t nodeCount : nodeCounts) {
+      std::vector<osmscout::GeoCoord> ring;
+
+      GenerateRing(nodeCount,
+                   ring);
+
+      if (!CompareRing("Generated ring",
+                       ring,
+                       true,
+                       5)) {
+        success=false;
+      }
+    }
+  }
+
+  if (!success) {
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -19,9 +19,21 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <vector>
 
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <thread>
+#endif
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+#include <mutex>
+#endif
+
 #include <osmscout/util/Cache.h>
+#include <osmscout/util/ConcurrentCache.h>
 #include <osmscout/util/FileScanner.h>
 #include <osmscout/util/StopClock.h>
 
@@ -30,6 +42,8 @@
   * cache insertion
   * cache hit
   * cache miss
+  for Cache and ConcurrentCache, and of concurrent cache hits
+  for a mutex guarded Cache and ConcurrentCache.
 */
 
 /**
@@ -64,7 +78,10 @@ private:
 
 static const size_t cacheSize=2000000;
 
-typedef osmscout::Cache<osmscout::Id,Data>     DataCache;
+typedef osmscout::Cache<osmscout::Id,Data>                                     DataCache;
+typedef osmscout::ConcurrentCache<osmscout::Id,Data>                           ConcurrentDataCache;
+typedef osmscout::Cache<osmscout::Id,std::shared_ptr<Data> >                   DataRefCache;
+typedef osmscout::ConcurrentCache<osmscout::Id,std::shared_ptr<Data> >         ConcurrentDataRefCache;
 
 void TestData()
 {
@@ -170,9 +187,251 @@ void TestData()
   std::cout << "Copy time: "  << copyTimer << std::endl;
 }
 
+void TestConcurrentData()
+{
+  std::cout << "*** Caching of struct in concurrent cache ***" << std::endl;
+
+  // Shards are limited individually, leave some room for uneven distribution
+  ConcurrentDataCache cache(2*cacheSize);
+
+  std::cout << "Inserting values into cache..." << std::endl;
+
+  osmscout::StopClock insertTimer;
+
+  for (size_t i=cacheSize; i<2*cacheSize; i++) {
+    Data data;
+    data.value=i;
+    data.value2.resize(10,i);
+
+    cache.InsertEntry(i,
+                      data,
+                      sizeof(Data)+data.value2.capacity()*sizeof(size_t));
+  }
+
+  insertTimer.Stop();
+
+  assert(cache.GetSize()==cacheSize);
+
+  std::cout << "Searching for entries not in cache..." << std::endl;
+
+  osmscout::StopClock missTimer;
+
+  for (size_t i=0; i<cacheSize; i++) {
+    Data data;
+
+    if (cache.GetEntry(i,data)) {
+      assert(false);
+    }
+  }
+
+  for (size_t i=2*cacheSize; i<3*cacheSize; i++) {
+    Data data;
+
+    if (cache.GetEntry(i,data)) {
+      assert(false);
+    }
+  }
+
+  missTimer.Stop();
+
+  std::cout << "Copying entries from cache..." << std::endl;
+
+  osmscout::StopClock copyTimer;
+
+  for (size_t t=1; t<=2; t++) {
+    for (size_t i=cacheSize; i<2*cacheSize; i++) {
+      Data data;
+
+      if (!cache.GetEntry(i,data)) {
+        assert(false);
+      }
+    }
+  }
+
+  copyTimer.Stop();
+
+  std::cout << "Insert time: "  << insertTimer << std::endl;
+  std::cout << "Miss time: "  << missTimer << std::endl;
+  std::cout << "Copy time: "  << copyTimer << std::endl;
+
+  cache.DumpStatistics("Concurrent cache");
+}
+
+void TestConcurrentMemoryLimit()
+{
+  std::cout << "*** Memory limited concurrent cache ***" << std::endl;
+
+  size_t                 maxMemory=64*1024*1024;
+  ConcurrentDataRefCache cache(cacheSize,
+                               maxMemory);
+
+  std::cout << "Inserting values of increasing size into cache..." << std::endl;
+
+  osmscout::StopClock insertTimer;
+
+  for (size_t i=0; i<cacheSize; i++) {
+    std::shared_ptr<Data> data=std::make_shared<Data>();
+
+    data->value=i;
+    data->value2.resize(i%100,i);
+
+    cache.InsertEntry(i,
+                      data,
+                      sizeof(Data)+data->value2.capacity()*sizeof(size_t));
+  }
+
+  insertTimer.Stop();
+
+  ConcurrentDataRefCache::Statistics statistics;
+
+  cache.GetStatistics(statistics);
+
+  assert(statistics.memory<=maxMemory);
+
+  std::cout << "Insert time: "  << insertTimer << std::endl;
+
+  cache.DumpStatistics("Memory limited cache");
+}
+
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_MUTEX)
+static const size_t concurrentCacheSize=100000;
+static const size_t concurrentLookups=2000000;
+
+struct LockedCacheReader
+{
+  DataRefCache& cache;
+  std::mutex&   mutex;
+  size_t        seed;
+
+  LockedCacheReader(DataRefCache& cache,
+                    std::mutex& mutex,
+                    size_t seed)
+  : cache(cache),
+    mutex(mutex),
+    seed(seed)
+  {
+    // no code
+  }
+
+  void operator()()
+  {
+    size_t key=seed;
+
+    for (size_t i=0; i<concurrentLookups; i++) {
+      std::shared_ptr<Data> data;
+
+      key=(key*1103515245+12345)%concurrentCacheSize;
+
+      {
+        std::lock_guard<std::mutex> guard(mutex);
+        DataRefCache::CacheRef      entry;
+
+        if (cache.GetEntry(key,entry)) {
+          data=entry->value;
+        }
+      }
+
+      assert(data);
+    }
+  }
+};
+
+struct ConcurrentCacheReader
+{
+  ConcurrentDataRefCache& cache;
+  size_t                  seed;
+
+  ConcurrentCacheReader(ConcurrentDataRefCache& cache,
+                        size_t seed)
+  : cache(cache),
+    seed(seed)
+  {
+    // no code
+  }
+
+  void operator()()
+  {
+    size_t key=seed;
+
+    for (size_t i=0; i<concurrentLookups; i++) {
+      std::shared_ptr<Data> data;
+
+      key=(key*1103515245+12345)%concurrentCacheSize;
+
+      if (!cache.GetEntry(key,data)) {
+        assert(false);
+      }
+    }
+  }
+};
+
+void TestConcurrentHits()
+{
+  std::cout << "*** Concurrent cache hits ***" << std::endl;
+
+  DataRefCache           lockedCache(concurrentCacheSize);
+  std::mutex             mutex;
+  ConcurrentDataRefCache concurrentCache(concurrentCacheSize);
+
+  for (size_t i=0; i<concurrentCacheSize; i++) {
+    std::shared_ptr<Data> data=std::make_shared<Data>();
+
+    data->value=i;
+
+    lockedCache.SetEntry(DataRefCache::CacheEntry(i,data));
+    concurrentCache.InsertEntry(i,
+                                data,
+                                sizeof(Data));
+  }
+
+  for (size_t threadCount=1; threadCount<=8; threadCount*=2) {
+    std::vector<std::thread> threads;
+    osmscout::StopClock      lockedTimer;
+
+    for (size_t t=0; t<threadCount; t++) {
+      threads.push_back(std::thread(LockedCacheReader(lockedCache,
+                                                      mutex,
+                                                      t)));
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    lockedTimer.Stop();
+
+    threads.clear();
+
+    osmscout::StopClock concurrentTimer;
+
+    for (size_t t=0; t<threadCount; t++) {
+      threads.push_back(std::thread(ConcurrentCacheReader(concurrentCache,
+                                                          t)));
+    }
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    concurrentTimer.Stop();
+
+    std::cout << threadCount << " thread(s), " << concurrentLookups << " lookups each: ";
+    std::cout << "Cache+mutex " << lockedTimer << ", ConcurrentCache " << concurrentTimer << std::endl;
+  }
+
+  concurrentCache.DumpStatistics("Concurrent cache");
+}
+#endif
+
 int main(int argc, char* argv[])
 {
   TestData();
+  TestConcurrentData();
+  TestConcurrentMemoryLimit();
+
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_MUTEX)
+  TestConcurrentHits();
+#endif
 
   return 0;
 }
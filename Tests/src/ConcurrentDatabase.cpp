@@ -0,0 +1,338 @@
+/*
+  ConcurrentDatabase - a test program for libosmscout
+  Copyright (C) 2015  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <thread>
+#endif
+
+#if defined(OSMSCOUT_HAVE_ATOMIC)
+#include <atomic>
+#endif
+
+#include <osmscout/Database.h>
+#include <osmscout/MapService.h>
+
+#include <osmscout/util/StopClock.h>
+
+/**
+  Stress test for concurrent read access to one shared database instance.
+
+  The map is requested for a number of views in the main thread first. Then
+  a number of threads request the same views again and again (while one of
+  the threads flushes the caches from time to time) and compare the result
+  with the reference result.
+*/
+
+struct View
+{
+  double lon;
+  double lat;
+  double magnification;
+};
+
+struct Result
+{
+  std::vector<osmscout::FileOffset> nodes;
+  std::vector<osmscout::FileOffset> ways;
+  std::vector<osmscout::FileOffset> areas;
+
+  bool operator==(const Result& other) const
+  {
+    return nodes==other.nodes &&
+           ways==other.ways &&
+           areas==other.areas;
+  }
+
+  bool operator!=(const Result& other) const
+  {
+    return !(*this==other);
+  }
+};
+
+static const size_t width=800;
+static const size_t height=600;
+static const double dpi=96.0;
+
+static bool LoadView(const osmscout::MapService& mapService,
+                     const osmscout::StyleConfig& styleConfig,
+                     const View& view,
+                     Result& result)
+{
+  osmscout::MercatorProjection  projection;
+  osmscout::AreaSearchParameter searchParameter;
+  osmscout::MapData             data;
+
+  projection.Set(view.lon,
+                 view.lat,
+                 osmscout::Magnification(view.magnification),
+                 dpi,
+                 width,
+                 height);
+
+  if (!mapService.GetObjects(searchParameter,
+                             styleConfig,
+                             projection,
+                             data)) {
+    return false;
+  }
+
+  result.nodes.clear();
+  result.ways.clear();
+  result.areas.clear();
+
+  for (const auto& node : data.nodes) {
+    result.nodes.push_back(node->GetFileOffset());
+  }
+
+  for (const auto& way : data.ways) {
+    result.ways.push_back(way->GetFileOffset());
+  }
+
+  for (const auto& area : data.areas) {
+    result.areas.push_back(area->GetFileOffset());
+  }
+
+  std::sort(result.nodes.begin(),result.nodes.end());
+  std::sort(result.ways.begin(),result.ways.end());
+  std::sort(result.areas.begin(),result.areas.end());
+
+  return true;
+}
+
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_ATOMIC)
+struct Worker
+{
+  const osmscout::DatabaseRef&   database;
+  const osmscout::MapService&    mapService;
+  const osmscout::StyleConfig&   styleConfig;
+  const std::vector<View>&       views;
+  const std::vector<Result>&     references;
+  size_t                         threadIndex;
+  size_t                         iterations;
+  std::atomic<size_t>&           errors;
+  std::atomic<size_t>&           requests;
+
+  Worker(const osmscout::DatabaseRef& database,
+         const osmscout::MapService& mapService,
+         const osmscout::StyleConfig& styleConfig,
+         const std::vector<View>& views,
+         const std::vector<Result>& references,
+         size_t threadIndex,
+         size_t iterations,
+         std::atomic<size_t>& errors,
+         std::atomic<size_t>& requests)
+  : database(database),
+    mapService(mapService),
+    styleConfig(styleConfig),
+    views(views),
+    references(references),
+    threadIndex(threadIndex),
+    iterations(iterations),
+    errors(errors),
+    requests(requests)
+  {
+    // no code
+  }
+
+  void operator()()
+  {
+    for (size_t i=0; i<iterations; i++) {
+      for (size_t v=0; v<views.size(); v++) {
+        // Every thread walks through the views in a different order
+        size_t index=(v+threadIndex*7+i)%views.size();
+        Result result;
+
+        if (!LoadView(mapService,
+                      styleConfig,
+                      views[index],
+                      result)) {
+          std::cerr << "Thread " << threadIndex << ": Cannot load view " << index << std::endl;
+          errors++;
+        }
+        else if (result!=references[index]) {
+          std::cerr << "Thread " << threadIndex << ": Result of view " << index << " differs: ";
+          std::cerr << result.nodes.size() << "/" << references[index].nodes.size() << " nodes, ";
+          std::cerr << result.ways.size() << "/" << references[index].ways.size() << " ways, ";
+          std::cerr << result.areas.size() << "/" << references[index].areas.size() << " areas" << std::endl;
+          errors++;
+        }
+
+        requests++;
+      }
+
+      // Make sure, that cache misses happen concurrently to cache hits
+      if (threadIndex==0) {
+        database->FlushCache();
+      }
+    }
+  }
+};
+#endif
+
+int main(int argc, char* argv[])
+{
+  std::string map;
+  std::string style;
+  size_t      threadCount=8;
+  size_t      iterations=20;
+
+  if (argc<3 || argc>5) {
+    std::cerr << "ConcurrentDatabase <map directory> <style-file> [threads [iterations]]" << std::endl;
+    return 1;
+  }
+
+  map=argv[1];
+  style=argv[2];
+
+  if (argc>=4 &&
+      (sscanf(argv[3],"%zu",&threadCount)!=1 || threadCount==0)) {
+    std::cerr << "threads is not numeric!" << std::endl;
+    return 1;
+  }
+
+  if (argc>=5 &&
+      sscanf(argv[4],"%zu",&iterations)!=1) {
+    std::cerr << "iterations is not numeric!" << std::endl;
+    return 1;
+  }
+
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_ATOMIC)
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::DatabaseRef       database(new osmscout::Database(databaseParameter));
+  osmscout::MapService        mapService(database);
+
+  if (!database->Open(map.c_str())) {
+    std::cerr << "Cannot open database" << std::endl;
+    return 1;
+  }
+
+  osmscout::StyleConfigRef styleConfig(new osmscout::StyleConfig(database->GetTypeConfig()));
+
+  if (!styleConfig->Load(style)) {
+    std::cerr << "Cannot open style" << std::endl;
+    return 1;
+  }
+
+  osmscout::GeoBox boundingBox;
+
+  if (!database->GetBoundingBox(boundingBox)) {
+    std::cerr << "Cannot read bounding box of database" << std::endl;
+    return 1;
+  }
+
+  std::vector<View> views;
+  double            magnifications[]={osmscout::Magnification::magCity,
+                                      osmscout::Magnification::magSuburb,
+                                      osmscout::Magnification::magDetail,
+                                      osmscout::Magnification::magClose};
+
+  // A 3x3 grid of views over the database for each magnification
+  for (size_t m=0; m<sizeof(magnifications)/sizeof(magnifications[0]); m++) {
+    for (size_t y=1; y<=3; y++) {
+      for (size_t x=1; x<=3; x++) {
+        View view;
+
+        view.lon=boundingBox.GetMinLon()+(boundingBox.GetMaxLon()-boundingBox.GetMinLon())*x/4.0;
+        view.lat=boundingBox.GetMinLat()+(boundingBox.GetMaxLat()-boundingBox.GetMinLat())*y/4.0;
+        view.magnification=magnifications[m];
+
+        views.push_back(view);
+      }
+    }
+  }
+
+  std::vector<Result> references(views.size());
+  size_t              objectCount=0;
+
+  std::cout << "Loading " << views.size() << " reference views..." << std::endl;
+
+  osmscout::StopClock referenceTimer;
+
+  for (size_t v=0; v<views.size(); v++) {
+    if (!LoadView(mapService,
+                  *styleConfig,
+                  views[v],
+                  references[v])) {
+      std::cerr << "Cannot load reference view " << v << std::endl;
+      return 1;
+    }
+
+    objectCount+=references[v].nodes.size()+
+                 references[v].ways.size()+
+                 references[v].areas.size();
+  }
+
+  referenceTimer.Stop();
+
+  std::cout << "Loaded " << objectCount << " objects in " << referenceTimer.ResultString() << std::endl;
+
+  std::atomic<size_t>      errors(0);
+  std::atomic<size_t>      requests(0);
+  std::vector<std::thread> threads;
+
+  std::cout << "Starting " << threadCount << " threads with " << iterations << " iterations each..." << std::endl;
+
+  database->FlushCache();
+
+  osmscout::StopClock stressTimer;
+
+  for (size_t t=0; t<threadCount; t++) {
+    threads.push_back(std::thread(Worker(database,
+                                         mapService,
+                                         *styleConfig,
+                                         views,
+                                         references,
+                                         t,
+                                         iterations,
+                                         errors,
+                                         requests)));
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  stressTimer.Stop();
+
+  std::cout << "Executed " << requests << " requests in " << stressTimer.ResultString() << std::endl;
+
+  database->DumpStatistics();
+  database->Close();
+
+  if (errors>0) {
+    std::cerr << errors << " request(s) failed or returned a wrong result!" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+#else
+  std::cerr << "libosmscout was built without thread support, skipping test" << std::endl;
+
+  return 0;
+#endif
+}
@@ -0,0 +1,191 @@
+/*
+  CoordEncodingPerformance - a test program for libosmscout
+  Copyright (C) 2015  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/StopClock.h>
+
+/**
+  Compare file size and decoding speed of coordinate arrays written by
+  FileWriter::Write() (offsets to the minimum coordinate) and by
+  FileWriter::WriteDeltaEncoded() (zigzag encoded differences to the
+  previous coordinate).
+
+  The coordinate arrays are random walks with a node distance similar to
+  typical OSM ways and areas. Both formats must decode to the same
+  coordinates.
+*/
+
+static const char* legacyFilename="coords_legacy.dat";
+static const char* deltaFilename="coords_delta.dat";
+
+static void GenerateArrays(size_t count,
+                           std::vector<std::vector<osmscout::GeoCoord> >& arrays)
+{
+  arrays.resize(count);
+
+  for (size_t a=0; a<count; a++) {
+    // Most ways are short, some are very long
+    size_t nodeCount=rand()%10==0 ? 100+rand()%2000 : 2+rand()%30;
+    double lat=47.0+rand()*2.0/RAND_MAX;
+    double lon=10.0+rand()*2.0/RAND_MAX;
+    double angle=rand()*2*M_PI/RAND_MAX;
+
+    arrays[a].reserve(nodeCount);
+
+    for (size_t n=0; n<nodeCount; n++) {
+      // 5 to 50 meters between nodes
+      double distance=(5.0+rand()*45.0/RAND_MAX)/111000.0;
+
+      arrays[a].push_back(osmscout::GeoCoord(lat,lon));
+
+      angle+=(rand()-RAND_MAX/2)*0.5/RAND_MAX;
+      lat+=distance*cos(angle);
+      lon+=distance*sin(angle)/cos(lat*M_PI/180.0);
+    }
+  }
+}
+
+static bool WriteArrays(const std::vector<std::vector<osmscout::GeoCoord> >& arrays,
+                        bool deltaEncoded,
+                        osmscout::FileOffset& size)
+{
+  osmscout::FileWriter writer;
+
+  if (!writer.Open(deltaEncoded ? deltaFilename : legacyFilename)) {
+    return false;
+  }
+
+  for (const auto& array : arrays) {
+    if (deltaEncoded) {
+      writer.WriteDeltaEncoded(array);
+    }
+    else {
+      writer.Write(array);
+    }
+  }
+
+  if (!writer.GetPos(size)) {
+    return false;
+  }
+
+  return writer.Close();
+}
+
+static bool ReadArrays(size_t count,
+                       bool deltaEncoded,
+                       size_t iterations,
+                       std::vector<std::vector<osmscout::GeoCoord> >& arrays)
+{
+  osmscout::FileScanner scanner;
+
+  if (!scanner.Open(deltaEncoded ? deltaFilename : legacyFilename,
+                    osmscout::FileScanner::Sequential,
+                    true)) {
+    return false;
+  }
+
+  arrays.resize(count);
+
+  for (size_t i=0; i<iterations; i++) {
+    if (!scanner.GotoBegin()) {
+      return false;
+    }
+
+    for (auto& array : arrays) {
+      bool success=deltaEncoded ? scanner.ReadDeltaEncoded(array) : scanner.Read(array);
+
+      if (!success) {
+        return false;
+      }
+    }
+  }
+
+  return scanner.Close();
+}
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+  size_t                                        count=100000;
+  size_t                                        iterations=10;
+  std::vector<std::vector<osmscout::GeoCoord> > arrays;
+  std::vector<std::vector<osmscout::GeoCoord> > legacyArrays;
+  std::vector<std::vector<osmscout::GeoCoord> > deltaArrays;
+  osmscout::FileOffset                          legacySize;
+  osmscout::FileOffset                          deltaSize;
+  size_t                                        nodeCount=0;
+
+  srand(42);
+
+  GenerateArrays(count,
+                 arrays);
+
+  for (const auto& array : arrays) {
+    nodeCount+=array.size();
+  }
+
+  if (!WriteArrays(arrays,false,legacySize) ||
+      !WriteArrays(arrays,true,deltaSize)) {
+    std::cerr << "Cannot write coordinate files" << std::endl;
+    return 1;
+  }
+
+  osmscout::StopClock legacyTimer;
+
+  if (!ReadArrays(count,false,iterations,legacyArrays)) {
+    std::cerr << "Cannot read '" << legacyFilename << "'" << std::endl;
+    return 1;
+  }
+
+  legacyTimer.Stop();
+
+  osmscout::StopClock deltaTimer;
+
+  if (!ReadArrays(count,true,iterations,deltaArrays)) {
+    std::cerr << "Cannot read '" << deltaFilename << "'" << std::endl;
+    return 1;
+  }
+
+  deltaTimer.Stop();
+
+  std::cout << count << " arrays with " << nodeCount << " coordinates, " << iterations << " iterations" << std::endl;
+  std::cout << "Legacy: " << legacySize << " bytes, " << (double)legacySize/nodeCount << " bytes/coord, read: " << legacyTimer.ResultString() << std::endl;
+  std::cout << "Delta:  " << deltaSize << " bytes, " << (double)deltaSize/nodeCount << " bytes/coord, read: " << deltaTimer.ResultString() << std::endl;
+
+  for (size_t a=0; a<count; a++) {
+    for (size_t n=0; n<arrays[a].size(); n++) {
+      // The legacy format rounds the minimum coordinate and the offsets
+      // separately and thus may differ by one unit of the fixed point representation
+      if (fabs(legacyArrays[a][n].GetLat()-deltaArrays[a][n].GetLat())>1.5/osmscout::latConversionFactor ||
+          fabs(legacyArrays[a][n].GetLon()-deltaArrays[a][n].GetLon())>1.5/osmscout::lonConversionFactor) {
+        std::cerr << "Coordinates of array " << a << " differ!" << std::endl;
+        return 1;
+      }
+    }
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,299 @@
+/*
+  LabelPlacementPerformance - a test program for libosmscout
+  Copyright (C) 2015  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <osmscout/LabelGrid.h>
+
+#include <osmscout/util/StopClock.h>
+
+/**
+  Compare performance of label conflict resolution using a plain list of
+  labels (checking every new label against all existing labels) and using
+  LabelGrid. Both variants implement the rules of the MapPainter and must
+  result in exactly the same list of labels.
+*/
+
+static const double width=1920.0;
+static const double height=1080.0;
+
+static const double labelSpace=3.0;
+static const double shieldLabelSpace=3.0;
+static const double sameLabelSpace=40.0;
+static const double maxLabelSpace=3.0;
+
+struct Label
+{
+  double      bx1;
+  double      bx2;
+  double      by1;
+  double      by2;
+  size_t      priority;
+  bool        shield;
+  bool        mark;
+  std::string text;
+};
+
+static void GetLabelSpace(const Label& a,
+                          const Label& b,
+                          double& horizontal,
+                          double& vertical)
+{
+  if (a.shield && b.shield) {
+    horizontal=shieldLabelSpace;
+    vertical=shieldLabelSpace;
+  }
+  else {
+    horizontal=labelSpace;
+    vertical=0;
+  }
+}
+
+static bool IsInConflict(const Label& label,
+                         const Label& other)
+{
+  double horizLabelSpace;
+  double vertLabelSpace;
+
+  GetLabelSpace(label,
+                other,
+                horizLabelSpace,
+                vertLabelSpace);
+
+  return !(label.bx1-horizLabelSpace>=other.bx2 ||
+           label.bx2+horizLabelSpace<=other.bx1 ||
+           label.by1-vertLabelSpace>=other.by2 ||
+           label.by2+vertLabelSpace<=other.by1);
+}
+
+static bool IsTooClose(const Label& label,
+                       const Label& other)
+{
+  return label.shield &&
+         other.shield &&
+         label.text==other.text &&
+         !(label.bx1-sameLabelSpace>other.bx2 ||
+           label.bx2+sameLabelSpace<other.bx1 ||
+           label.by1-sameLabelSpace>other.by2 ||
+           label.by2+sameLabelSpace<other.by1);
+}
+
+static void PlaceLabelsList(const std::vector<Label>& candidates,
+                            std::list<Label>& labels)
+{
+  for (const auto& candidate : candidates) {
+    for (auto& label : labels) {
+      label.mark=false;
+    }
+
+    bool accepted=true;
+
+    for (auto& label : labels) {
+      if (IsInConflict(candidate,label)) {
+        if (label.priority<=candidate.priority) {
+          accepted=false;
+          break;
+        }
+
+        label.mark=true;
+      }
+    }
+
+    if (!accepted) {
+      continue;
+    }
+
+    for (const auto& label : labels) {
+      if (!label.mark &&
+          IsTooClose(candidate,label)) {
+        accepted=false;
+        break;
+      }
+    }
+
+    if (!accepted) {
+      continue;
+    }
+
+    auto label=labels.begin();
+
+    while (label!=labels.end()) {
+      if (label->mark) {
+        label=labels.erase(label);
+      }
+      else {
+        ++label;
+      }
+    }
+
+    labels.push_back(candidate);
+  }
+}
+
+static void PlaceLabelsGrid(const std::vector<Label>& candidates,
+                            osmscout::LabelGrid<Label>& labels)
+{
+  std::vector<osmscout::LabelGrid<Label>::LabelRef> marked;
+  std::vector<osmscout::LabelGrid<Label>::LabelRef> result;
+
+  labels.Initialize(width,height,4*12.0);
+
+  for (const auto& candidate : candidates) {
+    for (auto& label : marked) {
+      label->mark=false;
+    }
+
+    marked.clear();
+
+    bool accepted=true;
+
+    labels.GetLabelsInBox(candidate.bx1-maxLabelSpace,
+                          candidate.bx2+maxLabelSpace,
+                          candidate.by1-maxLabelSpace,
+                          candidate.by2+maxLabelSpace,
+                          result);
+
+    for (auto& label : result) {
+      if (IsInConflict(candidate,*label)) {
+        if (label->priority<=candidate.priority) {
+          accepted=false;
+          break;
+        }
+
+        label->mark=true;
+        marked.push_back(label);
+      }
+    }
+
+    if (!accepted) {
+      continue;
+    }
+
+    labels.GetLabelsWithText(candidate.text,
+                             result);
+
+    for (const auto& label : result) {
+      if (!label->mark &&
+          IsTooClose(candidate,*label)) {
+        accepted=false;
+        break;
+      }
+    }
+
+    if (!accepted) {
+      continue;
+    }
+
+    for (auto& label : marked) {
+      labels.Remove(label);
+    }
+
+    marked.clear();
+
+    labels.Add(candidate);
+  }
+}
+
+static void GenerateLabels(size_t count,
+                           std::vector<Label>& labels)
+{
+  labels.clear();
+  labels.reserve(count);
+
+  for (size_t i=0; i<count; i++) {
+    Label  label;
+    double x=rand()*width/RAND_MAX;
+    double y=rand()*height/RAND_MAX;
+    double w=10.0+rand()*100.0/RAND_MAX;
+    double h=10.0+rand()*10.0/RAND_MAX;
+    char   buffer[20];
+
+    // Labels partly outside the drawing area are possible, too
+    label.bx1=x-w/2-20.0;
+    label.bx2=x+w/2-20.0;
+    label.by1=y-h/2-10.0;
+    label.by2=y+h/2-10.0;
+    label.priority=rand()%10;
+    label.shield=rand()%4==0;
+    label.mark=false;
+
+    sprintf(buffer,"%d",rand()%50);
+
+    label.text=buffer;
+
+    labels.push_back(label);
+  }
+}
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+  size_t counts[]={1000,5000,10000,50000};
+
+  srand(42);
+
+  for (size_t c=0; c<sizeof(counts)/sizeof(counts[0]); c++) {
+    std::vector<Label>         candidates;
+    std::list<Label>           listLabels;
+    osmscout::LabelGrid<Label> gridLabels;
+
+    GenerateLabels(counts[c],
+                   candidates);
+
+    osmscout::StopClock listTimer;
+
+    PlaceLabelsList(candidates,
+                    listLabels);
+
+    listTimer.Stop();
+
+    osmscout::StopClock gridTimer;
+
+    PlaceLabelsGrid(candidates,
+                    gridLabels);
+
+    gridTimer.Stop();
+
+    std::cout << counts[c] << " labels: " << listLabels.size() << " placed, list: " << listTimer.ResultString() << ", grid: " << gridTimer.ResultString() << std::endl;
+
+    if (listLabels.size()!=gridLabels.size()) {
+      std::cerr << "Number of placed labels differ: " << listLabels.size() << " vs. " << gridLabels.size() << std::endl;
+      return 1;
+    }
+
+    auto gridLabel=gridLabels.begin();
+
+    for (const auto& listLabel : listLabels) {
+      if (listLabel.bx1!=gridLabel->bx1 ||
+          listLabel.by1!=gridLabel->by1 ||
+          listLabel.text!=gridLabel->text) {
+        std::cerr << "Placed labels differ!" << std::endl;
+        return 1;
+      }
+
+      ++gridLabel;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,183 @@
+/*
+  ProjectionPerformance - a test program for libosmscout
+  Copyright (C) 2015  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <osmscout/GeoCoord.h>
+
+#include <osmscout/util/Magnification.h>
+#include <osmscout/util/Projection.h>
+#include <osmscout/util/StopClock.h>
+#include <osmscout/util/Transformation.h>
+
+/**
+  Compare the transformation of way nodes to pixel coordinates one coordinate
+  at a time (using Projection::BatchTransformer, as TransPolygon did before)
+  with the transformation of all nodes of a way in one call.
+
+  Ways are random walks with typical node counts and node distances of a city
+  map. Both variants must return the same pixel coordinates.
+*/
+
+static const size_t wayCount=10000;
+static const size_t iterations=20;
+
+static void GenerateWays(std::vector<std::vector<osmscout::GeoCoord> >& ways)
+{
+  ways.resize(wayCount);
+
+  for (auto& way : ways) {
+    size_t nodeCount=2+rand()%60;
+    double lat=47.0+(rand()*0.1)/RAND_MAX;
+    double lon=10.0+(rand()*0.1)/RAND_MAX;
+
+    way.reserve(nodeCount);
+
+    for (size_t n=0; n<nodeCount; n++) {
+      lat+=(rand()-RAND_MAX/2)*0.001/RAND_MAX;
+      lon+=(rand()-RAND_MAX/2)*0.001/RAND_MAX;
+
+      way.push_back(osmscout::GeoCoord(lat,lon));
+    }
+  }
+}
+
+static bool Measure(const std::string& name,
+                    const osmscout::Projection& projection,
+                    const std::vector<std::vector<osmscout::GeoCoord> >& ways)
+{
+  std::vector<osmscout::TransPolygon::TransPoint> singlePoints;
+  std::vector<osmscout::TransPolygon::TransPoint> bulkPoints;
+  size_t                                          pointCount=0;
+
+  for (const auto& way : ways) {
+    pointCount+=way.size();
+  }
+
+  singlePoints.resize(pointCount);
+  bulkPoints.resize(pointCount);
+
+  osmscout::StopClock singleTimer;
+
+  for (size_t i=0; i<iterations; i++) {
+    size_t offset=0;
+
+    for (const auto& way : ways) {
+      osmscout::Projection::BatchTransformer batchTransformer(projection);
+
+      for (size_t n=0; n<way.size(); n++) {
+        batchTransformer.GeoToPixel(way[n].GetLon(),
+                                    way[n].GetLat(),
+                                    singlePoints[offset+n].x,
+                                    singlePoints[offset+n].y);
+      }
+
+      offset+=way.size();
+    }
+  }
+
+  singleTimer.Stop();
+
+  osmscout::StopClock bulkTimer;
+
+  for (size_t i=0; i<iterations; i++) {
+    size_t offset=0;
+
+    for (const auto& way : ways) {
+      projection.GeoToPixel(way.data(),
+                            way.size(),
+                            &bulkPoints[offset].x,
+                            &bulkPoints[offset].y,
+                            sizeof(osmscout::TransPolygon::TransPoint));
+
+      offset+=way.size();
+    }
+  }
+
+  bulkTimer.Stop();
+
+  double transformations=(double)pointCount*iterations;
+
+  std::cout << name << ": " << pointCount << " points, " << iterations << " iterations" << std::endl;
+  std::cout << "Single: " << singleTimer.ResultString() << " "
+            << (size_t)(transformations/singleTimer.GetMilliseconds()*1000) << " points/s" << std::endl;
+  std::cout << "Bulk:   " << bulkTimer.ResultString() << " "
+            << (size_t)(transformations/bulkTimer.GetMilliseconds()*1000) << " points/s" << std::endl;
+
+  for (size_t i=0; i<pointCount; i++) {
+    if (singlePoints[i].x!=bulkPoints[i].x ||
+        singlePoints[i].y!=bulkPoints[i].y) {
+      std::cerr << name << ": Results for point " << i << " differ!" << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int main(int /*argc*/, char* /*argv*/[])
+{
+  std::vector<std::vector<osmscout::GeoCoord> > ways;
+  osmscout::Magnification                       magnification;
+
+  srand(42);
+
+  GenerateWays(ways);
+
+  magnification.SetLevel(14);
+
+  osmscout::MercatorProjection mercatorProjection;
+
+  mercatorProjection.Set(10.05,
+                         47.05,
+                         magnification,
+                         96.0,
+                         1024,
+                         768);
+
+  if (!Measure("MercatorProjection",
+               mercatorProjection,
+               ways)) {
+    return 1;
+  }
+
+  osmscout::TileProjection tileProjection;
+
+  // Tile containing 10.05/47.05 on level 14
+  tileProjection.Set(8649,
+                     5759,
+                     magnification,
+                     96.0,
+                     256,
+                     256);
+
+  if (!Measure("TileProjection",
+               tileProjection,
+               ways)) {
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,379 @@
+/*
+  TextSearchPerformance - a test program for libosmscout
+  Copyright (C) 2015  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <osmscout/TextSearchIndex.h>
+
+#include <osmscout/util/StopClock.h>
+
+/**
+  Measures the queries per second of the plain prefix search and of the
+  ranked (fuzzy) search of the text index of an imported database.
+
+  The queries are generated from texts of the index: prefixes of different
+  length for the prefix search and the complete texts with one random
+  substitution for the fuzzy search. Single letter queries show the effect
+  of the top-K cutoff of the ranked search, which does not enumerate all
+  texts starting with the query. Their results are checked against the
+  complete results of the prefix search.
+*/
+
+static const size_t queryCount=1000;
+static const size_t limit=20;
+
+static bool CollectTexts(const osmscout::TextSearchIndex& textSearch,
+                         std::vector<std::string>& texts)
+{
+  for (char c='A'; c<='Z'; c++) {
+    osmscout::TextSearchIndex::ResultsMap results;
+
+    if (!textSearch.Search(std::string(1,c),
+                           true,
+                           true,
+                           true,
+                           true,
+                           results)) {
+      return false;
+    }
+
+    for (const auto& result : results) {
+      // Only ASCII texts, so that the generated typos are valid UTF-8
+      bool isASCII=true;
+
+      for (const auto textChar : result.first) {
+        if ((unsigned char)textChar>=0x80) {
+          isASCII=false;
+          break;
+        }
+      }
+
+      if (isASCII &&
+          result.first.length()>=5) {
+        texts.push_back(result.first);
+      }
+    }
+  }
+
+  return true;
+}
+
+static void GenerateQueries(const std::vector<std::string>& texts,
+                            std::vector<std::string>& prefixQueries,
+                            std::vector<std::string>& typoQueries,
+                            std::vector<std::string>& typoTexts)
+{
+  for (size_t i=0; i<queryCount; i++) {
+    const std::string& text=texts[rand()%texts.size()];
+    size_t             prefixLength=1+rand()%text.length();
+
+    prefixQueries.push_back(text.substr(0,prefixLength));
+
+    std::string typo(text);
+    size_t      pos=1+rand()%(typo.length()-1);
+    char        replacement=(char)('a'+rand()%26);
+
+    if (replacement==typo[pos]) {
+      replacement=replacement=='z' ? 'a' : replacement+1;
+    }
+
+    typo[pos]=replacement;
+
+    typoQueries.push_back(typo);
+    typoTexts.push_back(text);
+  }
+}
+
+/**
+ * Same order as used by SearchRanked() for results without edits
+ */
+static bool RankedResultLess(const osmscout::TextSearchIndex::RankedResult& a,
+                             const osmscout::TextSearchIndex::RankedResult& b)
+{
+  static const size_t groupRank[]={2,1,0,3};
+
+  if (a.isComplete!=b.isComplete) {
+    return a.isComplete;
+  }
+
+  if (a.group!=b.group) {
+    return groupRank[a.group]<groupRank[b.group];
+  }
+
+  if (a.text.length()!=b.text.length()) {
+    return a.text.length()<b.text.length();
+  }
+
+  return a.text<b.text;
+}
+
+/**
+ * Ranks the complete results of the prefix search and compares the best
+ * results with the results of the ranked search
+ */
+static bool CheckSearchRanked(const osmscout::TextSearchIndex& textSearch,
+                              const std::vector<std::string>& queries)
+{
+  size_t mismatches=0;
+
+  for (const auto& query : queries) {
+    std::vector<osmscout::TextSearchIndex::RankedResult> expected;
+    std::vector<osmscout::TextSearchIndex::RankedResult> results;
+
+    for (size_t group=0; group<4; group++) {
+      osmscout::TextSearchIndex::ResultsMap groupResults;
+
+      if (!textSearch.Search(query,
+                             group==osmscout::TextSearchIndex::groupPOI,
+                             group==osmscout::TextSearchIndex::groupLocation,
+                             group==osmscout::TextSearchIndex::groupRegion,
+                             group==osmscout::TextSearchIndex::groupOther,
+                             groupResults)) {
+        return false;
+      }
+
+      for (const auto& groupResult : groupResults) {
+        osmscout::TextSearchIndex::RankedResult result;
+
+        result.text=groupResult.first;
+        result.group=static_cast<osmscout::TextSearchIndex::ResultGroup>(group);
+        result.distance=0;
+        result.isComplete=groupResult.first==query;
+        result.objects=groupResult.second;
+
+        expected.push_back(result);
+      }
+    }
+
+    std::sort(expected.begin(),
+              expected.end(),
+              RankedResultLess);
+
+    if (expected.size()>limit) {
+      expected.resize(limit);
+    }
+
+    if (!textSearch.SearchRanked(query,
+                                 true,
+                                 true,
+                                 true,
+                                 true,
+                                 0,
+                                 limit,
+                                 results)) {
+      return false;
+    }
+
+    bool equal=results.size()==expected.size();
+
+    for (size_t i=0; equal && i<results.size(); i++) {
+      equal=results[i].text==expected[i].text &&
+            results[i].group==expected[i].group &&
+            results[i].isComplete==expected[i].isComplete &&
+            results[i].objects.size()==expected[i].objects.size();
+    }
+
+    if (!equal) {
+      std::cerr << "Ranked search for '" << query << "' does not return the best results of the prefix search" << std::endl;
+      mismatches++;
+    }
+  }
+
+  return mismatches==0;
+}
+
+static bool MeasureSearch(const osmscout::TextSearchIndex& textSearch,
+                          const std::string& name,
+                          const std::vector<std::string>& queries)
+{
+  osmscout::StopClock timer;
+  size_t              resultCount=0;
+
+  for (const auto& query : queries) {
+    osmscout::TextSearchIndex::ResultsMap results;
+
+    if (!textSearch.Search(query,
+                           true,
+                           true,
+                           true,
+                           true,
+                           results)) {
+      return false;
+    }
+
+    resultCount+=results.size();
+  }
+
+  timer.Stop();
+
+  std::cout << name << ": " << timer.ResultString() << " "
+            << (size_t)(queries.size()/timer.GetMilliseconds()*1000) << " queries/s, "
+            << resultCount/queries.size() << " texts/query" << std::endl;
+
+  return true;
+}
+
+static bool MeasureSearchRanked(const osmscout::TextSearchIndex& textSearch,
+                                const std::string& name,
+                                const std::vector<std::string>& queries,
+                                const std::vector<std::string>& expectedTexts,
+                                size_t maxDistance)
+{
+  osmscout::StopClock timer;
+  size_t              resultCount=0;
+  size_t              found=0;
+
+  for (size_t q=0; q<queries.size(); q++) {
+    std::vector<osmscout::TextSearchIndex::RankedResult> results;
+
+    if (!textSearch.SearchRanked(queries[q],
+                                 true,
+                                 true,
+                                 true,
+                                 true,
+                                 maxDistance,
+                                 limit,
+                                 results)) {
+      return false;
+    }
+
+    resultCount+=results.size();
+
+    if (!expectedTexts.empty()) {
+      for (const auto& result : results) {
+        if (result.text==expectedTexts[q]) {
+          found++;
+          break;
+        }
+      }
+    }
+  }
+
+  timer.Stop();
+
+  std::cout << name << ": " << timer.ResultString() << " "
+            << (size_t)(queries.size()/timer.GetMilliseconds()*1000) << " queries/s, "
+            << resultCount/queries.size() << " texts/query";
+
+  if (!expectedTexts.empty()) {
+    std::cout << ", " << found*100/queries.size() << "% found";
+  }
+
+  std::cout << std::endl;
+
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc!=2) {
+    std::cerr << "TextSearchPerformance <map directory>" << std::endl;
+    return 1;
+  }
+
+  osmscout::TextSearchIndex textSearch;
+
+  if (!textSearch.Load(argv[1])) {
+    std::cerr << "Cannot load text index from '" << argv[1] << "'" << std::endl;
+    return 1;
+  }
+
+  std::vector<std::string> texts;
+
+  if (!CollectTexts(textSearch,
+                    texts)) {
+    std::cerr << "Error while collecting texts" << std::endl;
+    return 1;
+  }
+
+  if (texts.empty()) {
+    std::cerr << "No texts found in text index" << std::endl;
+    return 1;
+  }
+
+  std::vector<std::string> prefixQueries;
+  std::vector<std::string> typoQueries;
+  std::vector<std::string> typoTexts;
+  std::vector<std::string> noTexts;
+  std::vector<std::string> letterQueries;
+
+  for (char c='A'; c<='Z'; c++) {
+    letterQueries.push_back(std::string(1,c));
+  }
+
+  srand(42);
+
+  GenerateQueries(texts,
+                  prefixQueries,
+                  typoQueries,
+                  typoTexts);
+
+  std::cout << texts.size() << " texts, " << queryCount << " queries, limit " << limit << std::endl;
+
+  if (!MeasureSearch(textSearch,
+                     "Search (letter)",
+                     letterQueries) ||
+      !MeasureSearchRanked(textSearch,
+                           "SearchRanked (letter)",
+                           letterQueries,
+                           noTexts,
+                           0) ||
+      !MeasureSearch(textSearch,
+                     "Search (prefix)",
+                     prefixQueries) ||
+      !MeasureSearchRanked(textSearch,
+                           "SearchRanked (prefix)",
+                           prefixQueries,
+                           noTexts,
+                           0) ||
+      !MeasureSearchRanked(textSearch,
+                           "SearchRanked (typo, exact)",
+                           typoQueries,
+                           typoTexts,
+                           0) ||
+      !MeasureSearchRanked(textSearch,
+                           "SearchRanked (typo, 1 edit)",
+                           typoQueries,
+                           typoTexts,
+                           1) ||
+      !MeasureSearchRanked(textSearch,
+                           "SearchRanked (typo, 2 edits)",
+                           typoQueries,
+                           typoTexts,
+                           2)) {
+    std::cerr << "Error while searching" << std::endl;
+    return 1;
+  }
+
+  if (!CheckSearchRanked(textSearch,
+                         letterQueries) ||
+      !CheckSearchRanked(textSearch,
+                         prefixQueries)) {
+    std::cerr << "Results of the ranked search differ" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Ranked search returns the best results of the prefix search" << std::endl;
+
+  return 0;
+}
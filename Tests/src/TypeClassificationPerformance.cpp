@@ -0,0 +1,390 @@
+/*
+  TypeClassificationPerformance - a test program for libosmscout
+  Copyright (C) 2015  Tim Teulings
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/util/StopClock.h>
+#include <osmscout/util/String.h>
+
+/**
+  Compare the performance of classifying objects by their tags using
+  TypeConfig::GetNodeType(), TypeConfig::GetWayAreaType() and
+  TypeConfig::GetRelationType() with a plain linear evaluation of all type
+  conditions. Both must return the same types.
+
+  The tags are either read from a recorded tag stream or are generated
+  randomly. A tag stream is a text file with one object per line. Each line
+  starts with the object type ('n', 'w' or 'r') followed by tab separated
+  'key=value' pairs.
+*/
+
+struct Object
+{
+  char             type;
+  osmscout::TagMap tags;
+};
+
+static osmscout::TypeInfoRef GetNodeTypeLinear(const osmscout::TypeConfig& typeConfig,
+                                               const osmscout::TagMap& tagMap)
+{
+  if (tagMap.empty()) {
+    return typeConfig.typeInfoIgnore;
+  }
+
+  for (const auto &type : typeConfig.GetTypes()) {
+    if (!type->HasConditions() ||
+        !type->CanBeNode()) {
+      continue;
+    }
+
+    for (const auto &cond : type->GetConditions()) {
+      if (!(cond.types & osmscout::TypeInfo::typeNode)) {
+        continue;
+      }
+
+      if (cond.condition->Evaluate(tagMap)) {
+        return type;
+      }
+    }
+  }
+
+  return typeConfig.typeInfoIgnore;
+}
+
+static void GetWayAreaTypeLinear(const osmscout::TypeConfig& typeConfig,
+                                 const osmscout::TagMap& tagMap,
+                                 osmscout::TypeInfoRef& wayType,
+                                 osmscout::TypeInfoRef& areaType)
+{
+  wayType=typeConfig.typeInfoIgnore;
+  areaType=typeConfig.typeInfoIgnore;
+
+  if (tagMap.empty()) {
+    return;
+  }
+
+  for (const auto &type : typeConfig.GetTypes()) {
+    if (!((type->CanBeWay() ||
+           type->CanBeArea()) &&
+           type->HasConditions())) {
+      continue;
+    }
+
+    for (const auto &cond : type->GetConditions()) {
+      if (!((cond.types & osmscout::TypeInfo::typeWay) ||
+            (cond.types & osmscout::TypeInfo::typeArea))) {
+        continue;
+      }
+
+      if (cond.condition->Evaluate(tagMap)) {
+        if (cond.types & osmscout::TypeInfo::typeWay) {
+          wayType=type;
+        }
+
+        if (cond.types & osmscout::TypeInfo::typeArea) {
+          areaType=type;
+        }
+
+        return;
+      }
+    }
+  }
+}
+
+static osmscout::TypeInfoRef GetRelationTypeLinear(const osmscout::TypeConfig& typeConfig,
+                                                   const osmscout::TagMap& tagMap)
+{
+  if (tagMap.empty()) {
+    return typeConfig.typeInfoIgnore;
+  }
+
+  auto          relationType=tagMap.find(typeConfig.tagType);
+  unsigned char conditionType;
+
+  if (relationType!=tagMap.end() &&
+      relationType->second=="multipolygon") {
+    conditionType=osmscout::TypeInfo::typeArea;
+  }
+  else {
+    conditionType=osmscout::TypeInfo::typeRelation;
+  }
+
+  for (const auto &type : typeConfig.GetTypes()) {
+    if (!type->HasConditions() ||
+        (conditionType==osmscout::TypeInfo::typeArea && !type->CanBeArea()) ||
+        (conditionType==osmscout::TypeInfo::typeRelation && !type->CanBeRelation())) {
+      continue;
+    }
+
+    for (const auto &cond : type->GetConditions()) {
+      if (!(cond.types & conditionType)) {
+        continue;
+      }
+
+      if (cond.condition->Evaluate(tagMap)) {
+        return type;
+      }
+    }
+  }
+
+  return typeConfig.typeInfoIgnore;
+}
+
+static void AddTag(const osmscout::TypeConfig& typeConfig,
+                   const std::string& key,
+                   const std::string& value,
+                   Object& object)
+{
+  osmscout::TagId id=typeConfig.GetTagId(key);
+
+  if (id!=osmscout::tagIgnore) {
+    object.tags[id]=value;
+  }
+}
+
+static bool ReadTagStream(const osmscout::TypeConfig& typeConfig,
+                          const std::string& filename,
+                          std::vector<Object>& objects)
+{
+  std::ifstream stream(filename.c_str());
+  std::string   line;
+
+  if (!stream) {
+    return false;
+  }
+
+  while (std::getline(stream,line)) {
+    if (line.empty()) {
+      continue;
+    }
+
+    Object object;
+    size_t pos=1;
+
+    object.type=line[0];
+
+    while (pos<line.length()) {
+      size_t start=pos+1;
+      size_t end=line.find('\t',start);
+
+      if (end==std::string::npos) {
+        end=line.length();
+      }
+
+      std::string tag=line.substr(start,end-start);
+      size_t      equal=tag.find('=');
+
+      if (equal!=std::string::npos) {
+        AddTag(typeConfig,
+               tag.substr(0,equal),
+               tag.substr(equal+1),
+               object);
+      }
+
+      pos=end;
+    }
+
+    objects.push_back(object);
+  }
+
+  return true;
+}
+
+static void GenerateTagStream(const osmscout::TypeConfig& typeConfig,
+                              size_t count,
+                              std::vector<Object>& objects)
+{
+  // A rough approximation of common tags in OSM data
+  static const char* nodeTags[][2]={{"amenity","restaurant"},{"amenity","cafe"},{"amenity","parking"},
+                                    {"shop","supermarket"},{"shop","bakery"},{"highway","bus_stop"},
+                                    {"highway","traffic_signals"},{"place","village"},{"place","city"},
+                                    {"natural","tree"},{"power","tower"},{"tourism","hotel"},
+                                    {"barrier","gate"},{"railway","station"},{"entrance","yes"}};
+  static const char* wayTags[][2]={{"highway","residential"},{"highway","service"},{"highway","track"},
+                                   {"highway","footway"},{"highway","primary"},{"highway","motorway"},
+                                   {"building","yes"},{"building","house"},{"landuse","residential"},
+                                   {"landuse","farmland"},{"natural","water"},{"natural","wood"},
+                                   {"waterway","stream"},{"railway","rail"},{"leisure","park"},
+                                   {"power","line"},{"barrier","fence"},{"amenity","parking"}};
+  static const char* relationTags[][2]={{"type","multipolygon"},{"type","route"},{"type","restriction"},
+                                        {"type","boundary"},{"type","associatedStreet"}};
+  static const char* areaTags[][2]={{"building","yes"},{"landuse","forest"},{"natural","water"},
+                                    {"boundary","administrative"},{"leisure","park"}};
+  static const char* otherTags[][2]={{"name","Name"},{"source","survey"},{"oneway","yes"},
+                                     {"surface","asphalt"},{"addr:street","Street"},
+                                     {"addr:housenumber","1"},{"maxspeed","50"},{"layer","1"},
+                                     {"area","yes"},{"access","private"},{"admin_level","8"}};
+
+  size_t nodeTagsCount=sizeof(nodeTags)/sizeof(nodeTags[0]);
+  size_t wayTagsCount=sizeof(wayTags)/sizeof(wayTags[0]);
+  size_t relationTagsCount=sizeof(relationTags)/sizeof(relationTags[0]);
+  size_t areaTagsCount=sizeof(areaTags)/sizeof(areaTags[0]);
+  size_t otherTagsCount=sizeof(otherTags)/sizeof(otherTags[0]);
+
+  for (size_t i=0; i<count; i++) {
+    Object object;
+    int    kind=rand()%100;
+
+    if (kind<60) {
+      object.type='n';
+
+      // Most nodes do not have any (relevant) tags
+      if (rand()%10==0) {
+        size_t tag=rand()%nodeTagsCount;
+
+        AddTag(typeConfig,nodeTags[tag][0],nodeTags[tag][1],object);
+      }
+    }
+    else if (kind<98) {
+      size_t tag=rand()%wayTagsCount;
+
+      object.type='w';
+
+      AddTag(typeConfig,wayTags[tag][0],wayTags[tag][1],object);
+    }
+    else {
+      size_t tag=rand()%relationTagsCount;
+
+      object.type='r';
+
+      AddTag(typeConfig,relationTags[tag][0],relationTags[tag][1],object);
+
+      tag=rand()%areaTagsCount;
+
+      AddTag(typeConfig,areaTags[tag][0],areaTags[tag][1],object);
+    }
+
+    size_t otherCount=rand()%4;
+
+    for (size_t o=0; o<otherCount; o++) {
+      size_t tag=rand()%otherTagsCount;
+
+      AddTag(typeConfig,otherTags[tag][0],otherTags[tag][1],object);
+    }
+
+    objects.push_back(object);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc<2 || argc>3) {
+    std::cerr << "TypeClassificationPerformance <map.ost> [<tag stream file>]" << std::endl;
+    return 1;
+  }
+
+  osmscout::TypeConfig typeConfig;
+
+  if (!typeConfig.LoadFromOSTFile(argv[1])) {
+    std::cerr << "Cannot load type configuration '" << argv[1] << "'" << std::endl;
+    return 1;
+  }
+
+  std::vector<Object> objects;
+
+  if (argc==3) {
+    if (!ReadTagStream(typeConfig,
+                       argv[2],
+                       objects)) {
+      std::cerr << "Cannot read tag stream '" << argv[2] << "'" << std::endl;
+      return 1;
+    }
+  }
+  else {
+    srand(42);
+
+    GenerateTagStream(typeConfig,
+                      1000000,
+                      objects);
+  }
+
+  std::cout << "Types: " << typeConfig.GetTypes().size() << ", objects: " << objects.size() << std::endl;
+
+  std::vector<osmscout::TypeInfoRef> linearTypes;
+  std::vector<osmscout::TypeInfoRef> indexTypes;
+
+  linearTypes.reserve(2*objects.size());
+  indexTypes.reserve(2*objects.size());
+
+  osmscout::StopClock linearTimer;
+
+  for (const auto& object : objects) {
+    osmscout::TypeInfoRef wayType;
+    osmscout::TypeInfoRef areaType;
+
+    switch (object.type) {
+    case 'n':
+      linearTypes.push_back(GetNodeTypeLinear(typeConfig,object.tags));
+      break;
+    case 'w':
+      GetWayAreaTypeLinear(typeConfig,object.tags,wayType,areaType);
+      linearTypes.push_back(wayType);
+      linearTypes.push_back(areaType);
+      break;
+    case 'r':
+      linearTypes.push_back(GetRelationTypeLinear(typeConfig,object.tags));
+      break;
+    }
+  }
+
+  linearTimer.Stop();
+
+  osmscout::StopClock indexTimer;
+
+  for (const auto& object : objects) {
+    osmscout::TypeInfoRef wayType;
+    osmscout::TypeInfoRef areaType;
+
+    switch (object.type) {
+    case 'n':
+      indexTypes.push_back(typeConfig.GetNodeType(object.tags));
+      break;
+    case 'w':
+      typeConfig.GetWayAreaType(object.tags,wayType,areaType);
+      indexTypes.push_back(wayType);
+      indexTypes.push_back(areaType);
+      break;
+    case 'r':
+      indexTypes.push_back(typeConfig.GetRelationType(object.tags));
+      break;
+    }
+  }
+
+  indexTimer.Stop();
+
+  std::cout << "Linear: " << linearTimer.ResultString() << ", ";
+  std::cout << osmscout::NumberToString((size_t)(objects.size()/(linearTimer.GetMilliseconds()/1000.0+0.0001))) << " objects/s" << std::endl;
+  std::cout << "Index:  " << indexTimer.ResultString() << ", ";
+  std::cout << osmscout::NumberToString((size_t)(objects.size()/(indexTimer.GetMilliseconds()/1000.0+0.0001))) << " objects/s" << std::endl;
+
+  if (linearTypes!=indexTypes) {
+    std::cerr << "Classification results differ!" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,102 @@
+#ifndef OSMSCOUT_IMPORT_BUFFEREDPROGRESS_H
+#define OSMSCOUT_IMPORT_BUFFEREDPROGRESS_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <list>
+#include <string>
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+#include <mutex>
+#endif
+
+#include <osmscout/private/ImportImportExport.h>
+
+#include <osmscout/util/Progress.h>
+
+namespace osmscout {
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+  /**
+    Progress for work executed in parallel to other work, all passing their
+    output to the same target progress. Since the output of the individual
+    jobs should not be mixed, all messages are buffered until the progress is
+    attached. Attaching replays the buffered messages, after that all messages
+    are passed directly to the target progress.
+
+    All access to the target is synchronized by the given mutex.
+    */
+  class OSMSCOUT_IMPORT_API BufferedProgress : public Progress
+  {
+  private:
+    enum MessageType
+    {
+      messageStep,
+      messageAction,
+      messageDebug,
+      messageInfo,
+      messageWarning,
+      messageError
+    };
+
+    struct Message
+    {
+      MessageType type;
+      std::string text;
+    };
+
+  private:
+    std::mutex&        mutex;
+    Progress&          target;
+    bool               attached;
+    std::list<Message> messages;
+
+  private:
+    void Output(MessageType type,
+                const std::string& text);
+    void AddMessage(MessageType type,
+                    const std::string& text);
+
+  public:
+    BufferedProgress(std::mutex& mutex,
+                     Progress& target);
+
+    void Attach();
+
+    inline bool IsAttached() const
+    {
+      return attached;
+    }
+
+    void SetStep(const std::string& step);
+    void SetAction(const std::string& action);
+    void SetProgress(double current, double total);
+
+    void Debug(const std::string& text);
+    void Info(const std::string& text);
+    void Warning(const std::string& text);
+    void Error(const std::string& text);
+  };
+#endif
+}
+
+#endif
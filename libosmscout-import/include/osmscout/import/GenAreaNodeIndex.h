@@ -53,6 +53,8 @@ namespace osmscout {
 
   public:
     std::string GetDescription() const;
+    void GetModuleDescription(const ImportParameter& parameter,
+                              ImportModuleDescription& description) const;
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter& parameter,
                 Progress& progress);
@@ -20,9 +20,11 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <map>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <osmscout/Node.h>
 #include <osmscout/Area.h>
@@ -75,9 +77,10 @@ namespace osmscout {
 
     struct RegionLocation
     {
-      FileOffset               addressOffset; //!< Offset of place where the address list offset is stored
-      std::list<ObjectFileRef> objects;       //!< Objects that represent this location
-      std::list<RegionAddress> addresses;     //!< Addresses at this location
+      FileOffset               locationOffset; //!< Offset of the location entry in the index file
+      FileOffset               addressOffset;  //!< Offset of place where the address list offset is stored
+      std::list<ObjectFileRef> objects;        //!< Objects that represent this location
+      std::list<RegionAddress> addresses;      //!< Addresses at this location
     };
 
     struct Region;
@@ -173,6 +176,24 @@ namespace osmscout {
       }
     };
 
+    /**
+     * Range of the entries of a region and all its sub regions in the location search index
+     */
+    struct SearchRegionRange
+    {
+      FileOffset             regionOffset; //!< Offset of the region in the location index
+      FileOffset             start;        //!< Offset of the first location entry
+      FileOffset             end;          //!< Offset behind the last location entry
+
+      inline bool operator<(const SearchRegionRange& other) const
+      {
+        return regionOffset<other.regionOffset;
+      }
+    };
+
+    //! Offsets of the search index entries containing a given n-gram
+    typedef std::map<uint32_t,std::vector<FileOffset> > NGramMap;
+
   private:
     uint8_t bytesForNodeFileOffset;
     uint8_t bytesForAreaFileOffset;
@@ -379,8 +400,33 @@ namespace osmscout {
     bool WriteAddressData(FileWriter& writer,
                           Region& root);
 
+    void AddSearchNGrams(const std::string& name,
+                         FileOffset entryOffset,
+                         NGramMap& nGrams);
+
+    bool WriteSearchRegionEntries(FileWriter& writer,
+                                  uint8_t bytesForLocationFileOffset,
+                                  const Region& region,
+                                  NGramMap& nGrams);
+
+    bool WriteSearchLocationEntries(FileWriter& writer,
+                                    uint8_t bytesForLocationFileOffset,
+                                    const Region& region,
+                                    std::vector<SearchRegionRange>& ranges,
+                                    NGramMap& nGrams);
+
+    bool WriteSearchDictionary(FileWriter& writer,
+                               const NGramMap& nGrams,
+                               FileOffset& dictionaryOffset);
+
+    bool WriteSearchIndex(const ImportParameter& parameter,
+                          Progress& progress,
+                          const Region& rootRegion);
+
   public:
     std::string GetDescription() const;
+    void GetModuleDescription(const ImportParameter& parameter,
+                              ImportModuleDescription& description) const;
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter& parameter,
                 Progress& progress);
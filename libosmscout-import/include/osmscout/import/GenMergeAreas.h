@@ -176,6 +176,8 @@ namespace osmscout {
 
   public:
     std::string GetDescription() const;
+    void GetModuleDescription(const ImportParameter& parameter,
+                              ImportModuleDescription& description) const;
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter& parameter,
                 Progress& progress);
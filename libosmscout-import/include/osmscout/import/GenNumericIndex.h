@@ -54,6 +54,8 @@ namespace osmscout {
     virtual ~NumericIndexGenerator();
 
     std::string GetDescription() const;
+    void GetModuleDescription(const ImportParameter& parameter,
+                              ImportModuleDescription& description) const;
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter& parameter,
                 Progress& progress);
@@ -91,6 +93,14 @@ namespace osmscout {
     return description;
   }
 
+  template <class N,class T>
+  void NumericIndexGenerator<N,T>::GetModuleDescription(const ImportParameter& /*parameter*/,
+                                                        ImportModuleDescription& description) const
+  {
+    description.AddRequiredFile(datafile);
+    description.AddProvidedFile(indexfile);
+  }
+
   template <class N,class T>
   bool NumericIndexGenerator<N,T>::Import(const TypeConfigRef& typeConfig,
                                           const ImportParameter& parameter,
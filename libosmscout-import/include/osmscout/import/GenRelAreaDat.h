@@ -22,9 +22,19 @@
 
 #include <osmscout/import/Import.h>
 
+#include <list>
 #include <map>
+#include <memory>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+#include <mutex>
+#endif
 
 #include <osmscout/Area.h>
 
@@ -133,6 +143,37 @@ namespace osmscout {
       }
     };
 
+    /**
+     * A multipolygon relation together with its already loaded members. Jobs
+     * of the same batch are resolved independently of each other.
+     */
+    struct MultipolygonJob
+    {
+      RawRelation                 rawRelation;
+      std::string                 name;
+      std::list<MultipolygonPart> parts;
+      Area                        relation;
+      std::list<OSMId>            blacklistedWays; //!< Ids of ways, that are replaced by the relation
+      Progress                    *progress;
+      bool                        success;
+    };
+
+    typedef std::shared_ptr<MultipolygonJob> MultipolygonJobRef;
+
+    /**
+     * Shared state of the worker threads of a batch
+     */
+    struct MultipolygonBatch
+    {
+      const ImportParameter           *parameter;
+      const TypeConfig                *typeConfig;
+      std::vector<MultipolygonJobRef> jobs;
+      size_t                          nextJob; //!< Index of the next job not yet taken by a worker
+#if defined(OSMSCOUT_HAVE_MUTEX)
+      std::mutex                      mutex;   //!< Protects nextJob
+#endif
+    };
+
   private:
     std::list<MultipolygonPart>::const_iterator FindTopLevel(const std::list<MultipolygonPart>& rings,
                                                              const GroupingState& state,
@@ -196,19 +237,22 @@ namespace osmscout {
     bool HandleMultipolygonRelation(const ImportParameter& parameter,
                                     Progress& progress,
                                     const TypeConfig& typeConfig,
-                                    IdSet& wayAreaIndexBlacklist,
-                                    CoordDataFile& coordDataFile,
-                                    RawWayIndexedDataFile& wayDataFile,
-                                    RawRelationIndexedDataFile& relDataFile,
-                                    RawRelation& rawRelation,
-                                    const std::string& name,
-                                    Area& relation);
+                                    MultipolygonJob& job);
+
+    void HandleMultipolygonJobs(MultipolygonBatch* batch);
+
+    void HandleMultipolygonBatch(const ImportParameter& parameter,
+                                 Progress& progress,
+                                 const TypeConfig& typeConfig,
+                                 MultipolygonBatch& batch);
 
     std::string ResolveRelationName(const FeatureRef& featureName,
                                     const RawRelation& rawRelation) const;
 
   public:
     std::string GetDescription() const;
+    void GetModuleDescription(const ImportParameter& parameter,
+                              ImportModuleDescription& description) const;
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter& parameter,
                 Progress& progress);
@@ -0,0 +1,302 @@
+#ifndef OSMSCOUT_IMPORT_GENREVERSELOCATIONINDEX_H
+#define OSMSCOUT_IMPORT_GENREVERSELOCATIONINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/Location.h>
+#include <osmscout/LocationIndex.h>
+#include <osmscout/ObjectRef.h>
+#include <osmscout/Pixel.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+#include <osmscout/import/Import.h>
+
+namespace osmscout {
+
+  /**
+   * Generates the index for coordinate based reverse lookups
+   * (see ReverseLocationIndex) from the location index and the geometry of
+   * the objects it references.
+   *
+   * The cells are generated in bands of rows, so only the data of one band
+   * is held in memory. Cells completely covered by admin regions are held
+   * as ranges per row and cells with the same list of covering regions
+   * share their data in the file.
+   */
+  class ReverseLocationIndexGenerator : public ImportModule
+  {
+  private:
+    typedef std::list<std::vector<GeoCoord> > RunList;
+
+    /**
+     * The part of an admin region boundary within a cell
+     */
+    struct RegionPart
+    {
+      bool                       centerInside;   //!< The center of the cell is within the boundary
+      RunList                    runs;           //!< Consecutive boundary edges crossing the cell
+    };
+
+    struct CellRegion
+    {
+      size_t                     regionIndex;    //!< Index of the region in visiting order
+      FileOffset                 regionOffset;   //!< Offset of the admin region in the location index
+      std::list<RegionPart>      parts;          //!< Boundary parts, empty if the region covers the complete cell
+
+      inline bool operator<(const CellRegion& other) const
+      {
+        return regionIndex<other.regionIndex;
+      }
+    };
+
+    /**
+     * A range of cells in a row, that is completely covered by an admin region
+     */
+    struct CoveredRange
+    {
+      uint32_t                   xStart;         //!< First cell of the range
+      uint32_t                   xEnd;           //!< First cell after the range
+      size_t                     regionIndex;    //!< Index of the region in visiting order
+      FileOffset                 regionOffset;   //!< Offset of the admin region in the location index
+
+      inline bool operator<(const CoveredRange& other) const
+      {
+        return xStart<other.xStart;
+      }
+    };
+
+    typedef std::vector<std::vector<CoveredRange> > CoveredRangeRows;
+
+    struct CellAddress
+    {
+      GeoCoord                   coord;          //!< Coordinate of the address
+      FileOffset                 regionOffset;   //!< Offset of the admin region in the location index
+      FileOffset                 locationOffset; //!< Offset of the location in the location index
+      FileOffset                 addressOffset;  //!< Offset of the address in the location index
+      std::string                name;           //!< Name of the address
+      ObjectFileRef              object;         //!< Object representing the address
+    };
+
+    struct CellLocation
+    {
+      FileOffset                 regionOffset;   //!< Offset of the admin region in the location index
+      FileOffset                 locationOffset; //!< Offset of the location in the location index
+      ObjectFileRef              object;         //!< Object (part of the) location
+      RunList                    runs;           //!< Consecutive segments of the object crossing the sub cell
+    };
+
+    struct SubCell
+    {
+      std::list<CellAddress>     addresses;
+      std::list<CellLocation>    locations;
+    };
+
+    /**
+     * A cell with boundary parts, addresses or locations
+     */
+    struct Cell
+    {
+      std::list<CellRegion>      regions;        //!< Admin regions crossing the cell in visiting order, parents first
+      std::map<uint32_t,SubCell> subCells;       //!< Sub cells with data by their index within the cell
+    };
+
+    typedef std::map<Pixel,Cell> CellMap;
+
+    /**
+     * An admin region with an area, together with the rows of cells it covers
+     */
+    struct RegionEntry
+    {
+      AdminRegionRef             region;
+      size_t                     regionIndex;    //!< Index of the region in visiting order
+      uint32_t                   cellYStart;
+      uint32_t                   cellYEnd;
+    };
+
+    /**
+     * An object of a location or an address, of which the geometry must be loaded
+     */
+    struct ObjectEntry
+    {
+      ObjectFileRef              object;
+      FileOffset                 regionOffset;
+      FileOffset                 locationOffset;
+      FileOffset                 addressOffset;
+      std::string                name;
+      GeoCoord                   coord;          //!< Coordinate of an address
+      uint32_t                   cellYStart;     //!< First row of cells touched by the object
+      uint32_t                   cellYEnd;       //!< Last row of cells touched by the object
+
+      inline bool operator<(const ObjectEntry& other) const
+      {
+        return object<other.object;
+      }
+    };
+
+    /**
+     * One entry of the directory of a row: from cell xStart on (up to the
+     * xStart of the next entry) all cells have the data at the given offset
+     */
+    struct RowRun
+    {
+      uint32_t                   xStart;
+      FileOffset                 offset;
+    };
+
+    typedef std::map<std::vector<FileOffset>,FileOffset> CoveredCellMap;
+
+  private:
+    uint32_t                     cellCount;      //!< Number of cells in each direction
+    double                       cellWidth;
+    double                       cellHeight;
+    uint8_t                      bytesForLocationFileOffset;
+
+  private:
+    static uint32_t GetCellIndex(double value,
+                                 double size,
+                                 uint32_t count);
+
+    static void AddRunsToCells(const std::vector<GeoCoord>& nodes,
+                               bool closed,
+                               double width,
+                               double height,
+                               uint32_t count,
+                               uint32_t yStart,
+                               uint32_t yEnd,
+                               std::map<Pixel,RunList>& runs);
+
+    void AddRegionToCells(const RegionEntry& entry,
+                          const std::vector<std::vector<GeoCoord> >& rings,
+                          uint32_t bandStart,
+                          uint32_t bandEnd,
+                          CellMap& cells,
+                          CoveredRangeRows& coveredRanges);
+
+    bool ReadRegionRings(const TypeConfig& typeConfig,
+                         Progress& progress,
+                         FileScanner& areaScanner,
+                         const AdminRegion& region,
+                         std::vector<std::vector<GeoCoord> >& rings);
+
+    bool ReadObjectGeometry(const TypeConfig& typeConfig,
+                            Progress& progress,
+                            FileScanner& wayScanner,
+                            FileScanner& areaScanner,
+                            const ObjectFileRef& object,
+                            std::list<std::vector<GeoCoord> >& lines,
+                            bool& closed);
+
+    bool CollectRegions(const TypeConfig& typeConfig,
+                        Progress& progress,
+                        FileScanner& areaScanner,
+                        const std::list<AdminRegionRef>& regions,
+                        std::vector<RegionEntry>& regionEntries);
+
+    bool CollectObjects(Progress& progress,
+                        const LocationIndex& locationIndex,
+                        const std::list<AdminRegionRef>& regions,
+                        std::vector<ObjectEntry>& locationObjects,
+                        std::vector<ObjectEntry>& addressObjects);
+
+    bool LocateLocations(const TypeConfig& typeConfig,
+                         Progress& progress,
+                         FileScanner& wayScanner,
+                         FileScanner& areaScanner,
+                         std::vector<ObjectEntry>& locationObjects);
+
+    bool LocateAddresses(const TypeConfig& typeConfig,
+                         Progress& progress,
+                         FileScanner& nodeScanner,
+                         FileScanner& wayScanner,
+                         FileScanner& areaScanner,
+                         std::vector<ObjectEntry>& addressObjects);
+
+    bool IndexRegions(const TypeConfig& typeConfig,
+                      Progress& progress,
+                      FileScanner& areaScanner,
+                      const std::vector<RegionEntry>& regionEntries,
+                      uint32_t bandStart,
+                      uint32_t bandEnd,
+                      CellMap& cells,
+                      CoveredRangeRows& coveredRanges);
+
+    bool IndexLocations(const TypeConfig& typeConfig,
+                        Progress& progress,
+                        FileScanner& wayScanner,
+                        FileScanner& areaScanner,
+                        const std::vector<ObjectEntry>& locationObjects,
+                        uint32_t bandStart,
+                        uint32_t bandEnd,
+                        CellMap& cells);
+
+    void IndexAddresses(const std::vector<ObjectEntry>& addressObjects,
+                        uint32_t bandStart,
+                        uint32_t bandEnd,
+                        CellMap& cells);
+
+    bool WriteCell(FileWriter& writer,
+                   const std::vector<CellRegion>& regions,
+                   const std::map<uint32_t,SubCell>& subCells);
+
+    bool WriteRow(FileWriter& writer,
+                  CellMap::const_iterator cellsBegin,
+                  CellMap::const_iterator cellsEnd,
+                  const std::vector<CoveredRange>& coveredRanges,
+                  CoveredCellMap& coveredCells,
+                  std::vector<RowRun>& runs);
+
+    bool WriteBand(FileWriter& writer,
+                   uint32_t bandStart,
+                   uint32_t bandEnd,
+                   uint32_t cellYStart,
+                   const CellMap& cells,
+                   const CoveredRangeRows& coveredRanges,
+                   CoveredCellMap& coveredCells,
+                   std::vector<FileOffset>& rowOffsets,
+                   size_t& rowRunCount);
+
+    bool WriteIndex(const TypeConfig& typeConfig,
+                    Progress& progress,
+                    FileWriter& writer,
+                    FileScanner& wayScanner,
+                    FileScanner& areaScanner,
+                    const std::vector<RegionEntry>& regionEntries,
+                    const std::vector<ObjectEntry>& locationObjects,
+                    const std::vector<ObjectEntry>& addressObjects);
+
+  public:
+    std::string GetDescription() const;
+    void GetModuleDescription(const ImportParameter& parameter,
+                              ImportModuleDescription& description) const;
+    bool Import(const TypeConfigRef& typeConfig,
+                const ImportParameter& parameter,
+                Progress& progress);
+  };
+}
+
+#endif
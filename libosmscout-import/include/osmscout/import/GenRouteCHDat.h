@@ -0,0 +1,152 @@
+#ifndef OSMSCOUT_IMPORT_GENROUTECHDAT_H
+#define OSMSCOUT_IMPORT_GENROUTECHDAT_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <unordered_map>
+#include <vector>
+
+#include <osmscout/ContractionHierarchy.h>
+#include <osmscout/RoutingProfile.h>
+
+#include <osmscout/import/Import.h>
+
+namespace osmscout {
+
+  /**
+   * Generates the contraction hierarchy for the car routing graph.
+   *
+   * Nodes are contracted in the order of their edge difference (number of
+   * shortcuts needed minus number of edges removed). A shortcut is only
+   * added, if a local witness search does not find a path that is at least
+   * as cheap. Turn restrictions are checked while contracting a node, witness
+   * paths never pass nodes with turn restrictions.
+   *
+   * The hierarchy is calculated using the fastest path metric and the
+   * default car speed table. The metric is stored in the file, so that the
+   * router only uses the hierarchy for matching profiles. The hierarchy is
+   * only calculated, if requested by ImportParameter::GetRouteContractionHierarchy().
+   */
+  class RouteCHDataGenerator : public ImportModule
+  {
+  private:
+    struct Edge
+    {
+      uint32_t      source;      //!< Index of the source node
+      uint32_t      target;      //!< Index of the target node
+      uint32_t      weight;      //!< Costs, multiplied by CHEdge::costFactor
+      uint32_t      middle;      //!< Index of the contracted middle node or CHEdge::noMiddle
+      uint32_t      firstNode;   //!< Index of the node reached by the first path
+      ObjectFileRef firstObject; //!< Object of the first path
+      ObjectFileRef lastObject;  //!< Object of the last path
+    };
+
+    struct Node
+    {
+      FileOffset             routeNodeOffset;      //!< File offset of the route node
+      std::vector<size_t>    outEdges;             //!< Indexes of the outgoing edges
+      std::vector<size_t>    inEdges;              //!< Indexes of the incoming edges
+      std::vector<CHExclude> excludes;             //!< Turn restrictions at this node
+      uint32_t               rank;                 //!< Position in the contraction order
+      uint32_t               contractedNeighbours; //!< Number of neighbours already contracted
+      bool                   contracted;           //!< true, if the node is already contracted
+    };
+
+    struct Graph
+    {
+      std::vector<Node> nodes;
+      std::vector<Edge> edges;
+      size_t            shortcutCount;
+    };
+
+    struct PriorityCompare
+    {
+      const std::vector<int>* priorities;
+
+      PriorityCompare(const std::vector<int>& priorities)
+      : priorities(&priorities)
+      {
+        // no code
+      }
+
+      inline bool operator()(size_t a,
+                             size_t b) const
+      {
+        if ((*priorities)[a]==(*priorities)[b]) {
+          return a<b;
+        }
+
+        return (*priorities)[a]<(*priorities)[b];
+      }
+    };
+
+  private:
+    bool LoadObjectVariantData(const TypeConfig& typeConfig,
+                               const ImportParameter& parameter,
+                               std::vector<ObjectVariantData>& objectVariantData) const;
+
+    bool LoadRouteGraph(const TypeConfig& typeConfig,
+                        const ImportParameter& parameter,
+                        Progress& progress,
+                        const RoutingProfile& profile,
+                        const std::vector<ObjectVariantData>& objectVariantData,
+                        Graph& graph) const;
+
+    bool IsTurnForbidden(const Node& node,
+                         const Edge& incoming,
+                         const Edge& outgoing) const;
+
+    void WitnessSearch(const Graph& graph,
+                       uint32_t source,
+                       uint32_t ignoredNode,
+                       uint32_t maxWeight,
+                       std::unordered_map<uint32_t,uint32_t>& weights) const;
+
+    void AddShortcut(Graph& graph,
+                     const Edge& incoming,
+                     const Edge& outgoing,
+                     uint32_t weight) const;
+
+    size_t ContractNode(Graph& graph,
+                        uint32_t nodeIndex,
+                        bool simulate) const;
+
+    int CalculatePriority(Graph& graph,
+                          uint32_t nodeIndex) const;
+
+    void ContractGraph(Progress& progress,
+                       Graph& graph) const;
+
+    bool WriteContractionHierarchy(const ImportParameter& parameter,
+                                   Progress& progress,
+                                   const CHMetric& metric,
+                                   const Graph& graph) const;
+
+  public:
+    std::string GetDescription() const;
+    void GetModuleDescription(const ImportParameter& parameter,
+                              ImportModuleDescription& description) const;
+    bool Import(const TypeConfigRef& typeConfig,
+                const ImportParameter& parameter,
+                Progress& progress);
+  };
+}
+
+#endif
@@ -22,6 +22,7 @@
 
 #include <list>
 #include <map>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -72,10 +73,47 @@ namespace osmscout {
     typedef std::map<Id,std::list<PendingOffset> >         PendingRouteNodeOffsetsMap;
     typedef std::map<Id,std::vector<TurnRestrictionData> > ViaTurnRestrictionMap;
 
+    /**
+     * A block of route nodes together with all ways and areas referenced by
+     * them. The block is shared (read only) by the route graphs of all vehicles.
+     */
+    struct RouteNodeBlock
+    {
+      const NodeIdObjectsMap                         *nodeObjectsMap;
+      const ViaTurnRestrictionMap                    *restrictions;
+      std::vector<NodeIdObjectsMap::const_iterator>  nodes;
+      size_t                                         nodeCount;
+      std::unordered_map<FileOffset,WayRef>          waysMap;
+      std::unordered_map<FileOffset,AreaRef>         areasMap;
+    };
+
+    /**
+     * State of the route graph of one vehicle while it is written
+     */
+    struct RouteGraph
+    {
+      Vehicle                              vehicle;
+      std::string                          dataFilename;
+      std::string                          variantFilename;
+      FileWriter                           writer;
+      NodeIdOffsetMap                      routeNodeIdOffsetMap;
+      PendingRouteNodeOffsetsMap           pendingOffsetsMap;
+      std::map<ObjectVariantData,uint16_t> routeDataMap;
+      uint32_t                             writtenRouteNodeCount;
+      uint32_t                             objectCount;
+      uint32_t                             pathCount;
+      uint32_t                             excludeCount;
+      uint32_t                             simpleNodesCount;
+      bool                                 success;
+
+      RouteGraph();
+    };
+
     AccessFeatureValueReader      *accessReader;
     AccessRestrictedFeatureReader *accessRestrictedReader;
     MaxSpeedFeatureValueReader    *maxSpeedReader;
     GradeFeatureValueReader       *gradeReader;
+    bool                          reversePaths;
 
   private:
     bool IsAccessRestricted(const FeatureValueBuffer& buffer) const;
@@ -152,6 +190,15 @@ namespace osmscout {
                  FileOffset from,
                  FileOffset to) const;
 
+    void MarkNodesUsedJob(const std::vector<std::vector<Id> >* objectIds,
+                          size_t start,
+                          size_t end,
+                          NodeUseMap* nodeUseMap);
+
+    void MarkNodesUsed(const ImportParameter& parameter,
+                       const std::vector<std::vector<Id> >& objectIds,
+                       NodeUseMap& nodeUseMap);
+
     /**
      * Reads all relevant ways and areas and returns all nodes where these intersect.
      */
@@ -194,8 +241,8 @@ namespace osmscout {
     bool GetRouteNodeCoord(Progress& progress,
                            Id id,
                            const std::list<ObjectFileRef>& objects,
-                           std::unordered_map<FileOffset,WayRef>& waysMap,
-                           std::unordered_map<FileOffset,AreaRef>& areasMap,
+                           const std::unordered_map<FileOffset,WayRef>& waysMap,
+                           const std::unordered_map<FileOffset,AreaRef>& areasMap,
                            GeoCoord& coord) const;
 
     /*
@@ -260,18 +307,45 @@ namespace osmscout {
                                 const std::string& variantFilename,
                                 const std::map<ObjectVariantData,uint16_t>& routeDataMap);
 
-    bool WriteRouteGraph(const ImportParameter& parameter,
-                         Progress& progress,
-                         const TypeConfig& typeConfig,
-                         const NodeIdObjectsMap& nodeObjectsMap,
-                         const ViaTurnRestrictionMap& restrictions,
-                         Vehicle vehicle,
-                         const std::string& dataFilename,
-                         const std::string& variantFilename);
+    /**
+     * Calculates and writes the route nodes of the given block for the route graph
+     * of one vehicle.
+     */
+    bool WriteRouteNodes(Progress& progress,
+                         const RouteNodeBlock& block,
+                         RouteGraph& graph);
+
+    /**
+     * Thread entry point for WriteRouteNodes()
+     */
+    void WriteRouteNodesJob(Progress* progress,
+                            const RouteNodeBlock* block,
+                            RouteGraph* graph);
+
+    /**
+     * Writes the route nodes of the given block for all route graphs, in parallel
+     * if multiple threads are allowed.
+     */
+    bool WriteRouteNodeBlock(const ImportParameter& parameter,
+                             Progress& progress,
+                             const RouteNodeBlock& block,
+                             std::vector<RouteGraph>& graphs);
+
+    /**
+     * Writes the route graphs for all vehicles in one pass over the route nodes,
+     * loading the ways and areas for every block of route nodes only once.
+     */
+    bool WriteRouteGraphs(const ImportParameter& parameter,
+                          Progress& progress,
+                          const TypeConfig& typeConfig,
+                          const NodeIdObjectsMap& nodeObjectsMap,
+                          const ViaTurnRestrictionMap& restrictions);
 
   public:
     RouteDataGenerator();
     std::string GetDescription() const;
+    void GetModuleDescription(const ImportParameter& parameter,
+                              ImportModuleDescription& description) const;
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter& parameter,
                 Progress& progress);
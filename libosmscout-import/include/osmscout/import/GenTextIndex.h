@@ -25,7 +25,9 @@
 
 #include <osmscout/import/Import.h>
 
+#if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
 #include <marisa.h>
+#endif
 
 namespace osmscout
 {
@@ -35,11 +37,14 @@ namespace osmscout
     TextIndexGenerator();
 
     std::string GetDescription() const;
+    void GetModuleDescription(const ImportParameter& parameter,
+                              ImportModuleDescription& description) const;
 
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter &parameter,
                 Progress &progress);
 
+#if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
   private:
     bool SetFileOffsetSize(const ImportParameter &parameter,
                            Progress &progress);
@@ -56,6 +61,9 @@ namespace osmscout
                               Progress &progress,
                               const TypeConfig &typeConfig);
 
+    void BuildAlphabetStr(const marisa::Keyset &keyset,
+                          std::string &alphabetStr) const;
+
     bool BuildKeyStr(const std::string &text,
                      const FileOffset offset,
                      const RefType reftype,
@@ -66,7 +74,9 @@ namespace osmscout
     marisa::Keyset  keysetLocation;
     marisa::Keyset  keysetRegion;
     marisa::Keyset  keysetOther;
+#endif
 
+  private:
     uint8_t         offsetSizeBytes;  //! size in bytes of FileOffsets stored in the tries
   };
 }
@@ -48,13 +48,14 @@ namespace osmscout {
     std::list<std::string>       mapfiles;                 //! Name of the files containing map data (either *.osm or *.osm.pbf)
     std::string                  typefile;                 //! Name and path ff type definition file (map.ost.xml)
     std::string                  destinationDirectory;     //! Name of the destination directory
+    size_t                       threadCount;              //! Number of threads used by import steps supporting parallel processing and maximum number of steps executed in parallel
     size_t                       startStep;                //! Starting step for import
     size_t                       endStep;                  //! End step for import
 
     bool                         strictAreas;              //! Assure that areas conform to "simple" definition
 
     bool                         sortObjects;              //! Sort all objects
-    size_t                       sortBlockSize;            //! Number of entries loaded in one sort iteration
+    size_t                       sortBufferSize;           //! Size of the memory buffer (in bytes) used for sorting objects
     size_t                       sortTileMag;              //! Zoom level for individual sorting cells
 
     size_t                       numericIndexPageSize;     //! Size of an numeric index page in bytes
@@ -96,6 +97,8 @@ namespace osmscout {
     TransPolygon::OptimizeMethod optimizationWayMethod;    //! what method to use to optimize ways
 
     size_t                       routeNodeBlockSize;       //! Number of route nodes loaded during import until ways get resolved
+    bool                         routeReversePaths;        //! Also write paths against the direction of oneways (needed for bidirectional routing)
+    bool                         routeContractionHierarchy; //! Calculate the contraction hierarchy for car routing
 
     bool                         assumeLand;               //! During sea/land detection,we either trust coastlines only or make some
                                                            //! assumptions which tiles are sea and which are land.
@@ -107,13 +110,15 @@ namespace osmscout {
     std::string GetTypefile() const;
     std::string GetDestinationDirectory() const;
 
+    size_t GetThreadCount() const;
+
     size_t GetStartStep() const;
     size_t GetEndStep() const;
 
     bool GetStrictAreas() const;
 
     bool GetSortObjects() const;
-    size_t GetSortBlockSize() const;
+    size_t GetSortBufferSize() const;
     size_t GetSortTileMag() const;
 
     size_t GetNumericIndexPageSize() const;
@@ -155,6 +160,8 @@ namespace osmscout {
     TransPolygon::OptimizeMethod GetOptimizationWayMethod() const;
 
     size_t GetRouteNodeBlockSize() const;
+    bool GetRouteReversePaths() const;
+    bool GetRouteContractionHierarchy() const;
 
     bool GetAssumeLand() const;
 
@@ -162,13 +169,15 @@ namespace osmscout {
     void SetTypefile(const std::string& typefile);
     void SetDestinationDirectory(const std::string& destinationDirectory);
 
+    void SetThreadCount(size_t threadCount);
+
     void SetStartStep(size_t startStep);
     void SetSteps(size_t startStep, size_t endStep);
 
     void SetStrictAreas(bool strictAreas);
 
     void SetSortObjects(bool sortObjects);
-    void SetSortBlockSize(size_t sortBlockSize);
+    void SetSortBufferSize(size_t sortBufferSize);
     void SetSortTileMag(size_t sortTileMag);
 
     void SetNumericIndexPageSize(size_t numericIndexPageSize);
@@ -210,6 +219,8 @@ namespace osmscout {
     void SetOptimizationWayMethod(TransPolygon::OptimizeMethod optimizationWayMethod);
 
     void SetRouteNodeBlockSize(size_t blockSize);
+    void SetRouteReversePaths(bool routeReversePaths);
+    void SetRouteContractionHierarchy(bool routeContractionHierarchy);
 
     void SetAssumeLand(bool assumeLand);
   };
@@ -221,6 +232,46 @@ namespace osmscout {
     works on one object type and generates one output file (though this is just
     an suggestion). Such a step is realized by a ImportModule.
     */
+  /**
+    Describes the files an import module reads and writes. The import uses
+    this information to execute modules that do not depend on each other
+    in parallel.
+
+    A module that neither requires nor provides any file is treated as
+    depending on all previous modules and all following modules depend on it.
+    */
+  class OSMSCOUT_IMPORT_API ImportModuleDescription
+  {
+  private:
+    std::list<std::string> requiredFiles; //! Files read by the module
+    std::list<std::string> providedFiles; //! Files written by the module
+    bool                   exclusive;     //! The module must not run in parallel to other modules
+
+  public:
+    ImportModuleDescription();
+
+    void AddRequiredFile(const std::string& filename);
+    void AddProvidedFile(const std::string& filename);
+    void SetExclusive(bool exclusive);
+
+    inline const std::list<std::string>& GetRequiredFiles() const
+    {
+      return requiredFiles;
+    }
+
+    inline const std::list<std::string>& GetProvidedFiles() const
+    {
+      return providedFiles;
+    }
+
+    inline bool IsExclusive() const
+    {
+      return exclusive;
+    }
+
+    bool DependsOn(const ImportModuleDescription& other) const;
+  };
+
   class OSMSCOUT_IMPORT_API ImportModule
   {
   public:
@@ -231,6 +282,22 @@ namespace osmscout {
      */
     virtual std::string GetDescription() const = 0;
 
+    /**
+     * Return the files (including path) the module reads and writes. Modules
+     * that use multiple threads or a large amount of memory themselves should
+     * mark themselves as exclusive.
+     *
+     * The default implementation does not declare any files, so that the
+     * module is executed strictly in order.
+     *
+     * @param parameter
+     *   Import parameter
+     * @param description
+     *   Description to fill
+     */
+    virtual void GetModuleDescription(const ImportParameter& parameter,
+                                      ImportModuleDescription& description) const;
+
     /**
      * Do the import
      *
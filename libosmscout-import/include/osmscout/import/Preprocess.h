@@ -20,6 +20,7 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <map>
 #include <unordered_map>
 
 #include <osmscout/Coord.h>
@@ -37,7 +38,18 @@ namespace osmscout {
   class Preprocess : public ImportModule
   {
   private:
-    typedef std::unordered_map<PageId,FileOffset> CoordPageOffsetMap;
+    /**
+     * A range of coordinate pages with consecutive page ids, that are stored
+     * consecutively in the coord data file
+     */
+    struct CoordPageRange
+    {
+      PageId     pageCount;       //! Number of pages in the range
+      PageId     unusedPageCount; //! Number of pages in the range without any coordinate
+      FileOffset offset;          //! File offset of the first page of the range
+    };
+
+    typedef std::map<PageId,CoordPageRange> CoordPageRangeMap;
 
     class Callback : public PreprocessorCallback
     {
@@ -70,7 +82,8 @@ namespace osmscout {
       bool                   relationSortingError;
 
       Id                     coordPageCount;
-      CoordPageOffsetMap     coordIndex;
+      CoordPageRangeMap      coordPageRanges;     //! Page ranges by the id of their first page
+      CoordPageRangeMap::iterator lastCoordPageRange; //! The range at the end of the file
       FileWriter             coordWriter;
       PageId                 currentPageId;
       FileOffset             currentPageOffset;
@@ -86,6 +99,10 @@ namespace osmscout {
 
     private:
       bool StoreCurrentPage();
+      bool GetCoordPageOffset(PageId pageId,
+                              FileOffset& offset) const;
+      bool AllocateCoordPage(PageId pageId,
+                             FileOffset& offset);
       bool StoreCoord(OSMId id,
                       const GeoCoord& coord);
 
@@ -134,6 +151,8 @@ namespace osmscout {
 
   public:
     std::string GetDescription() const;
+    void GetModuleDescription(const ImportParameter& parameter,
+                              ImportModuleDescription& description) const;
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter& parameter,
                 Progress& progress);
@@ -0,0 +1,210 @@
+#ifndef OSMSCOUT_IMPORT_PREPROCESS_OSC_H
+#define OSMSCOUT_IMPORT_PREPROCESS_OSC_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <osmscout/util/GeoBox.h>
+
+#include <osmscout/import/Preprocessor.h>
+
+namespace osmscout {
+
+  /**
+   * The content of one or more OSM change files (*.osc). For every object only
+   * the last change is stored. Created and modified objects hold their complete
+   * new version, deleted objects are just marked as deleted. Objects created by
+   * any of the changes are marked as created.
+   */
+  struct OSMChangeSet
+  {
+    struct Node
+    {
+      bool                             created;
+      bool                             deleted;
+      double                           lon;
+      double                           lat;
+      TagMap                           tags;
+    };
+
+    struct Way
+    {
+      bool                             created;
+      bool                             deleted;
+      std::vector<OSMId>               nodes;
+      TagMap                           tags;
+    };
+
+    struct Relation
+    {
+      bool                             created;
+      bool                             deleted;
+      std::vector<RawRelation::Member> members;
+      TagMap                           tags;
+    };
+
+    typedef std::map<OSMId,Node>       NodeMap;
+    typedef std::map<OSMId,Way>        WayMap;
+    typedef std::map<OSMId,Relation>   RelationMap;
+
+    NodeMap                            nodes;
+    WayMap                             ways;
+    RelationMap                        relations;
+  };
+
+  /**
+   * Reads an OSM change file (*.osc) into a OSMChangeSet. Changes of later
+   * files (and later changes within the same file) replace earlier changes
+   * of the same object.
+   */
+  class PreprocessOSC : public Preprocessor
+  {
+  private:
+    OSMChangeSet& changeSet;
+
+  public:
+    PreprocessOSC(OSMChangeSet& changeSet);
+
+    bool Import(const TypeConfigRef& typeConfig,
+                const ImportParameter& parameter,
+                Progress& progress,
+                const std::string& filename);
+  };
+
+  /**
+   * Applies an OSMChangeSet to the data passed by one or more preprocessors
+   * (one after the other) to the given callback, all while keeping the order
+   * of nodes, ways and relations sorted by id. The change set must not be
+   * changed after construction. Finish() must be called after the last
+   * object of the last file, to pass all remaining objects of the change set.
+   *
+   * This is not an incremental update of an existing database. The changes
+   * are merged into the input before the import, all import steps still run
+   * over the complete data. Since change files normally cover the whole
+   * planet while the input often is an extract, changes are clipped to the
+   * input:
+   * - Deleted and modified objects of the input are dropped or replaced.
+   *   Deletions and modifications of objects not part of the input are ignored.
+   * - Created nodes are only inserted, if they are within the bounding box of
+   *   the input nodes read so far. Created objects have higher ids than the
+   *   objects of the input, so they are normally inserted after all objects
+   *   of the input.
+   * - Created ways and relations are only inserted, if they reference at least
+   *   one node, way or relation that has been passed to the callback, either
+   *   an object of the input or an inserted object of the change set.
+   *
+   * To decide on created objects only the ids of input objects referenced
+   * by created objects are recorded, not all ids of the input.
+   */
+  class OSMChangeSetCallback : public PreprocessorCallback
+  {
+  private:
+    PreprocessorCallback&                     callback;
+    const OSMChangeSet&                       changeSet;
+    OSMChangeSet::NodeMap::const_iterator     nextNode;            //!< Next created node to pass
+    OSMChangeSet::WayMap::const_iterator      nextWay;             //!< Next created way to pass
+    OSMChangeSet::RelationMap::const_iterator nextRelation;        //!< Next created relation to pass
+    GeoBox                                    inputBoundingBox;    //!< Bounding box of the input nodes read so far
+    std::unordered_set<OSMId>                 referencedNodes;     //!< Nodes referenced by created ways and relations
+    std::unordered_set<OSMId>                 referencedWays;      //!< Ways referenced by created relations
+    std::unordered_set<OSMId>                 referencedRelations; //!< Relations referenced by created relations
+    std::unordered_set<OSMId>                 passedNodes;         //!< Referenced nodes passed to the callback
+    std::unordered_set<OSMId>                 passedWays;          //!< Referenced ways passed to the callback
+    std::unordered_set<OSMId>                 passedRelations;     //!< Referenced relations passed to the callback
+    size_t                                    changeCount;         //!< Number of changes of existing objects
+    size_t                                    appliedChangeCount;  //!< Number of changes of existing objects applied to the input
+    size_t                                    replacedCount;
+    size_t                                    deletedCount;
+    size_t                                    addedCount;
+    size_t                                    ignoredCount;
+
+  private:
+    bool IsInInput(double lon,
+                   double lat) const;
+    bool ReferencesPassedNode(const std::vector<OSMId>& nodes) const;
+    bool ReferencesPassedMember(const std::vector<RawRelation::Member>& members) const;
+
+    void NodePassed(OSMId id);
+    void WayPassed(OSMId id);
+    void RelationPassed(OSMId id);
+
+    /**
+     * Pass all created objects of the change set with an id lower than the given id, that
+     * have not been passed yet (and thus are not part of the input)
+     */
+    void PassNodesBefore(OSMId id);
+    void PassWaysBefore(OSMId id);
+    void PassRelationsBefore(OSMId id);
+
+  public:
+    OSMChangeSetCallback(PreprocessorCallback& callback,
+                         const OSMChangeSet& changeSet);
+
+    void ProcessNode(const OSMId& id,
+                     const double& lon, const double& lat,
+                     const TagMap& tags);
+    void ProcessWay(const OSMId& id,
+                    std::vector<OSMId>& nodes,
+                    const TagMap& tags);
+    void ProcessRelation(const OSMId& id,
+                         const std::vector<RawRelation::Member>& members,
+                         const TagMap& tags);
+
+    void Finish();
+
+    /**
+     * Number of objects of the input, that were replaced by a newer version
+     */
+    inline size_t GetReplacedCount() const
+    {
+      return replacedCount;
+    }
+
+    /**
+     * Number of objects of the input, that were dropped
+     */
+    inline size_t GetDeletedCount() const
+    {
+      return deletedCount;
+    }
+
+    /**
+     * Number of objects of the change set, that were not part of the input
+     */
+    inline size_t GetAddedCount() const
+    {
+      return addedCount;
+    }
+
+    /**
+     * Number of changes, that were ignored, because they are not related to the input
+     */
+    inline size_t GetIgnoredCount() const
+    {
+      return ignoredCount;
+    }
+  };
+}
+
+#endif
@@ -20,10 +20,20 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <deque>
+#include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+#include <mutex>
+#include <condition_variable>
+#endif
+
 #include <osmscout/Types.h>
 
 #include <osmscout/import/RawRelation.h>
@@ -35,52 +45,166 @@
 
 namespace osmscout {
 
+  /**
+   * Preprocessor for *.osm.pbf files.
+   *
+   * If supported by the platform and ImportParameter::GetThreadCount() is greater than
+   * one, the file is processed in a pipeline: One thread reads the raw blobs from the file,
+   * a number of worker threads inflate and decode the blobs in parallel and the calling
+   * thread hands the decoded blocks over to the PreprocessorCallback in the original order
+   * of the blocks in the file.
+   */
   class PreprocessPBF : public Preprocessor
   {
   private:
-    char                             *buffer;
-    uint32_t                         bufferSize;
-    PreprocessorCallback&            callback;
-    TagMap                           tagMap;
-    std::vector<OSMId>               nodes;
-    std::vector<RawRelation::Member> members;
+    struct RawNodeData
+    {
+      OSMId  id;
+      double lon;
+      double lat;
+      TagMap tags;
+    };
+
+    struct RawWayData
+    {
+      OSMId              id;
+      std::vector<OSMId> nodes;
+      TagMap             tags;
+    };
+
+    struct RawRelationData
+    {
+      OSMId                            id;
+      std::vector<RawRelation::Member> members;
+      TagMap                           tags;
+    };
+
+    /**
+     * A raw (still encoded) data blob as read from the file
+     */
+    struct RawBlob
+    {
+      size_t      index;    //!< Running index of the block in the file
+      FileOffset  position; //!< File position after the block
+      std::string data;     //!< The encoded blob
+    };
+
+    typedef std::shared_ptr<RawBlob> RawBlobRef;
+
+    /**
+     * The decoded content of one primitive block
+     */
+    struct RawBlockData
+    {
+      FileOffset                   position; //!< File position after the block
+      std::vector<RawNodeData>     nodes;
+      std::vector<RawWayData>      ways;
+      std::vector<RawRelationData> relations;
+    };
+
+    typedef std::shared_ptr<RawBlockData> RawBlockDataRef;
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    /**
+     * State shared between the reader thread, the decoder threads and the processing
+     * (calling) thread
+     */
+    struct PipelineState
+    {
+      std::mutex                       mutex;
+      std::condition_variable          blobAvailable;  //!< Reader => Decoder
+      std::condition_variable          blockAvailable; //!< Decoder => Processing
+      std::condition_variable          spaceAvailable; //!< Processing => Reader
+
+      size_t                           maxPending;     //!< Maximum number of blocks read but not yet processed
+      std::deque<RawBlobRef>           blobs;          //!< Blobs read but not yet decoded
+      std::map<size_t,RawBlockDataRef> blocks;         //!< Decoded blocks not yet processed
+      size_t                           nextBlockIndex; //!< Index of the next block to process
+      size_t                           blockCount;     //!< Number of blocks read
+      bool                             readerFinished; //!< The reader has reached the end of the file
+      bool                             aborted;        //!< Processing has been aborted because of an error
+      std::string                      error;          //!< The first error that happened
+
+      double                           readTime;       //!< Time spent reading blobs (milliseconds)
+      double                           decodeTime;     //!< Time spent decoding blobs, summed over all threads (milliseconds)
+    };
+#endif
 
   private:
-    bool GetPos(FILE* file,
-                FileOffset& pos) const;
+    PreprocessorCallback&            callback;
 
-    void AssureBlockSize(uint32_t length);
+  private:
+    static bool GetPos(FILE* file,
+                       FileOffset& pos);
 
-    bool ReadBlockHeader(Progress& progress,
-                         FILE* file,
-                         PBF::BlockHeader& blockHeader,
-                         bool silent);
+    static bool ReadBlockHeader(FILE* file,
+                                PBF::BlockHeader& blockHeader,
+                                std::string& buffer,
+                                bool& eof,
+                                std::string& error);
 
-    bool ReadHeaderBlock(Progress& progress,
-                         FILE* file,
+    static bool ReadBlob(FILE* file,
                          const PBF::BlockHeader& blockHeader,
-                         PBF::HeaderBlock& headerBlock);
-
-    bool ReadPrimitiveBlock(Progress& progress,
-                            FILE* file,
-                            const PBF::BlockHeader& blockHeader,
-                            PBF::PrimitiveBlock& primitiveBlock);
-
-    void ReadNodes(const TypeConfig& typeConfig,
-                   const PBF::PrimitiveBlock& block,
-                   const PBF::PrimitiveGroup &group);
-
-    void ReadDenseNodes(const TypeConfig& typeConfig,
-                        const PBF::PrimitiveBlock& block,
-                        const PBF::PrimitiveGroup &group);
-
-    void ReadWays(const TypeConfig& typeConfig,
-                  const PBF::PrimitiveBlock& block,
-                  const PBF::PrimitiveGroup &group);
-
-    void ReadRelations(const TypeConfig& typeConfig,
-                       const PBF::PrimitiveBlock& block,
-                       const PBF::PrimitiveGroup &group);
+                         std::string& data,
+                         std::string& error);
+
+    static bool DecodeBlob(const std::string& data,
+                           std::string& content,
+                           std::string& error);
+
+    static bool ReadHeaderBlock(FILE* file,
+                                const PBF::BlockHeader& blockHeader,
+                                PBF::HeaderBlock& headerBlock,
+                                std::string& error);
+
+    static void ReadNodes(const TypeConfig& typeConfig,
+                          const PBF::PrimitiveBlock& block,
+                          const PBF::PrimitiveGroup &group,
+                          RawBlockData& data);
+
+    static void ReadDenseNodes(const TypeConfig& typeConfig,
+                               const PBF::PrimitiveBlock& block,
+                               const PBF::PrimitiveGroup &group,
+                               RawBlockData& data);
+
+    static void ReadWays(const TypeConfig& typeConfig,
+                         const PBF::PrimitiveBlock& block,
+                         const PBF::PrimitiveGroup &group,
+                         RawBlockData& data);
+
+    static void ReadRelations(const TypeConfig& typeConfig,
+                              const PBF::PrimitiveBlock& block,
+                              const PBF::PrimitiveGroup &group,
+                              RawBlockData& data);
+
+    static bool DecodePrimitiveBlock(const TypeConfig& typeConfig,
+                                     const RawBlob& blob,
+                                     RawBlockData& data,
+                                     std::string& error);
+
+    void ProcessBlock(RawBlockData& data);
+
+    bool ImportSequential(const TypeConfig& typeConfig,
+                          Progress& progress,
+                          FILE* file,
+                          FileOffset fileSize);
+
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_MUTEX)
+    static void AbortPipeline(PipelineState& state,
+                              const std::string& error);
+
+    static void ReadBlobs(PipelineState& state,
+                          FILE* file);
+
+    static void DecodeBlobs(PipelineState& state,
+                            const TypeConfig& typeConfig);
+
+    bool ImportParallel(const TypeConfig& typeConfig,
+                        Progress& progress,
+                        FILE* file,
+                        FileOffset fileSize,
+                        size_t decoderCount);
+#endif
 
   public:
     PreprocessPBF(PreprocessorCallback& callback);
@@ -39,6 +39,8 @@ namespace osmscout {
     SortAreaDataGenerator();
 
     std::string GetDescription() const;
+    void GetModuleDescription(const ImportParameter& parameter,
+                              ImportModuleDescription& description) const;
   };
 }
 
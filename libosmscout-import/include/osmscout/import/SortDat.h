@@ -20,16 +20,26 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <algorithm>
 #include <cmath>
 #include <list>
 #include <memory>
+#include <queue>
 #include <unordered_map>
+#include <vector>
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <thread>
+#endif
 
 #include <osmscout/import/Import.h>
 
 #include <osmscout/DataFile.h>
 #include <osmscout/ObjectRef.h>
 
+#include <osmscout/util/File.h>
 #include <osmscout/util/FileWriter.h>
 
 namespace osmscout {
@@ -46,33 +56,23 @@ namespace osmscout {
       FileScanner scanner;
     };
 
-    struct CellEntry
+    /**
+     * Sort criteria of an object: The sorting cell and the top left
+     * coordinate of the object. Within a cell objects are sorted
+     * from west to east and from north to south.
+     */
+    struct SortKey
     {
-      uint8_t                              type;
-      Id                                   id;
-      typename std::list<Source>::iterator source;
-      FileOffset                           fileOffset;
-      double                               lat;
-      double                               lon;
-
-      inline CellEntry(uint8_t type,
-                       Id id,
-                       const typename std::list<Source>::iterator source,
-                       FileOffset fileOffset,
-                       double lat,
-                       double lon)
-      : type(type),
-        id(id),
-        source(source),
-        fileOffset(fileOffset),
-        lat(lat),
-        lon(lon)
-      {
-        // no code
-      }
+      uint64_t cell;
+      double   lat;
+      double   lon;
 
-      inline bool operator<(const CellEntry& other) const
+      inline bool operator<(const SortKey& other) const
       {
+        if (cell!=other.cell) {
+          return cell<other.cell;
+        }
+
         if (lon==other.lon) {
           return lat>other.lat;
         }
@@ -82,6 +82,77 @@ namespace osmscout {
       }
     };
 
+    /**
+     * An object in the memory buffer of a run
+     */
+    struct SortEntry
+    {
+      SortKey key;
+      size_t  offset; //!< Offset of the object data in the run buffer
+      size_t  length; //!< Length of the object data
+
+      inline bool operator<(const SortEntry& other) const
+      {
+        return key<other.key;
+      }
+    };
+
+    /**
+     * A run is a block of objects, that gets sorted in memory and written
+     * to a temporary file. The object data is stored (and written)
+     * as read from the source file, prefixed by the sort key.
+     */
+    struct SortRun
+    {
+      std::string            filename;
+      std::vector<SortEntry> entries;
+      std::vector<char>      data;
+      bool                   success;
+    };
+
+    typedef std::shared_ptr<SortRun> SortRunRef;
+
+    /**
+     * Sequential reader for the entries of a run file
+     */
+    struct RunScanner
+    {
+      FileScanner scanner;
+      uint32_t    remaining; //!< Number of entries not yet read
+      SortKey     key;       //!< Key of the current entry
+      uint32_t    length;    //!< Length of the object data of the current entry
+
+      bool Open(const std::string& filename);
+      bool ReadNext();
+    };
+
+    /**
+     * Entry in the priority queue of a k-way merge. The entry with the smallest
+     * key (and for equal keys the one from the run created first, to keep the
+     * original order of the objects) has the highest priority.
+     */
+    struct MergeEntry
+    {
+      SortKey key;
+      size_t  run;
+
+      inline bool operator<(const MergeEntry& other) const
+      {
+        if (key<other.key) {
+          return false;
+        }
+
+        if (other.key<key) {
+          return true;
+        }
+
+        return run>other.run;
+      }
+    };
+
+    //! Maximum number of runs merged in one go
+    static const size_t maxMergeRuns=64;
+
   public:
     class ProcessingFilter
     {
@@ -117,6 +188,21 @@ namespace osmscout {
     std::list<ProcessingFilterRef> filters;
 
   private:
+    static bool WriteRun(SortRun& run);
+    static void WriteRunJob(SortRun* run);
+
+    static bool MergeRuns(const std::vector<std::string>& runFilenames,
+                          const std::string& filename);
+
+    std::string GetRunFilename(const ImportParameter& parameter,
+                               size_t index) const;
+
+    bool GenerateRuns(const TypeConfig& typeConfig,
+                      const ImportParameter& parameter,
+                      Progress& progress,
+                      uint32_t& overallDataCount,
+                      std::vector<std::string>& runFilenames);
+
     bool Renumber(const TypeConfig& typeConfig,
                   const ImportParameter& parameter,
                   Progress& progress);
@@ -138,11 +224,17 @@ namespace osmscout {
     void AddFilter(const ProcessingFilterRef& filter);
 
   public:
+    void GetModuleDescription(const ImportParameter& parameter,
+                              ImportModuleDescription& description) const;
+
     bool Import(const TypeConfigRef& typeConfig,
                 const ImportParameter& parameter,
                 Progress& progress);
   };
 
+  template <class N>
+  const size_t SortDataGenerator<N>::maxMergeRuns;
+
   template <class N>
   SortDataGenerator<N>::ProcessingFilter::~ProcessingFilter()
   {
@@ -175,33 +267,224 @@ namespace osmscout {
   }
 
   template <class N>
-  bool SortDataGenerator<N>::Renumber(const TypeConfig& typeConfig,
-                                      const ImportParameter& parameter,
-                                      Progress& progress)
+  bool SortDataGenerator<N>::RunScanner::Open(const std::string& filename)
   {
-    FileWriter dataWriter;
-    FileWriter mapWriter;
-    uint32_t   overallDataCount=0;
-    uint32_t   dataCopiedCount=0;
-    double     zoomLevel=pow(2.0,(double)parameter.GetSortTileMag());
-    size_t     cellCount=zoomLevel*zoomLevel;
-    size_t     minIndex=0;
-    size_t     maxIndex=cellCount-1;
+    if (!scanner.Open(filename,
+                      FileScanner::Sequential,
+                      false)) {
+      return false;
+    }
 
-    progress.SetAction("Sorting data");
+    return scanner.Read(remaining);
+  }
+
+  /**
+   * Read the key and the data length of the next entry. The scanner is then
+   * positioned at the start of the object data.
+   */
+  template <class N>
+  bool SortDataGenerator<N>::RunScanner::ReadNext()
+  {
+    if (!scanner.ReadNumber(key.cell) ||
+        !scanner.Read((char*)&key.lat,sizeof(key.lat)) ||
+        !scanner.Read((char*)&key.lon,sizeof(key.lon)) ||
+        !scanner.ReadNumber(length)) {
+      return false;
+    }
+
+    remaining--;
+
+    return true;
+  }
+
+  /**
+   * Sort the entries of the run (keeping the original order for entries with the
+   * same key) and write them to the run file. The memory of the run is freed afterwards.
+   *
+   * Run files are only used during sorting, so the key coordinates are written
+   * in their binary in-memory representation.
+   */
+  template <class N>
+  bool SortDataGenerator<N>::WriteRun(SortRun& run)
+  {
+    FileWriter writer;
+
+    std::stable_sort(run.entries.begin(),
+                     run.entries.end());
+
+    if (!writer.Open(run.filename)) {
+      return false;
+    }
+
+    writer.Write((uint32_t)run.entries.size());
+
+    for (const auto& entry : run.entries) {
+      writer.WriteNumber(entry.key.cell);
+      writer.Write((const char*)&entry.key.lat,sizeof(entry.key.lat));
+      writer.Write((const char*)&entry.key.lon,sizeof(entry.key.lon));
+      writer.WriteNumber((uint32_t)entry.length);
+      writer.Write(&run.data[entry.offset],
+                   entry.length);
+    }
+
+    std::vector<SortEntry>().swap(run.entries);
+    std::vector<char>().swap(run.data);
 
+    if (writer.HasError()) {
+      return false;
+    }
+
+    return writer.Close();
+  }
+
+  template <class N>
+  void SortDataGenerator<N>::WriteRunJob(SortRun* run)
+  {
+    run->success=WriteRun(*run);
+  }
+
+  /**
+   * Merge the given runs into one new run, copying the object data without
+   * parsing it.
+   */
+  template <class N>
+  bool SortDataGenerator<N>::MergeRuns(const std::vector<std::string>& runFilenames,
+                                       const std::string& filename)
+  {
+    std::vector<RunScanner>        scanners(runFilenames.size());
+    std::priority_queue<MergeEntry> queue;
+    uint32_t                       entryCount=0;
+    std::vector<char>              buffer;
+    FileWriter                     writer;
+
+    for (size_t r=0; r<runFilenames.size(); r++) {
+      if (!scanners[r].Open(runFilenames[r])) {
+        return false;
+      }
+
+      entryCount+=scanners[r].remaining;
+
+      if (scanners[r].remaining>0) {
+        MergeEntry entry;
+
+        if (!scanners[r].ReadNext()) {
+          return false;
+        }
+
+        entry.key=scanners[r].key;
+        entry.run=r;
+
+        queue.push(entry);
+      }
+    }
+
+    if (!writer.Open(filename)) {
+      return false;
+    }
+
+    writer.Write(entryCount);
+
+    while (!queue.empty()) {
+      MergeEntry  entry=queue.top();
+      RunScanner& scanner=scanners[entry.run];
+
+      queue.pop();
+
+      buffer.resize(scanner.length);
+
+      if (!scanner.scanner.Read(&buffer[0],
+                                scanner.length)) {
+        return false;
+      }
+
+      writer.WriteNumber(entry.key.cell);
+      writer.Write((const char*)&entry.key.lat,sizeof(entry.key.lat));
+      writer.Write((const char*)&entry.key.lon,sizeof(entry.key.lon));
+      writer.WriteNumber(scanner.length);
+      writer.Write(&buffer[0],
+                   scanner.length);
+
+      if (scanner.remaining>0) {
+        if (!scanner.ReadNext()) {
+          return false;
+        }
+
+        entry.key=scanner.key;
+
+        queue.push(entry);
+      }
+    }
+
+    for (auto& scanner : scanners) {
+      scanner.scanner.Close();
+    }
+
+    if (writer.HasError()) {
+      return false;
+    }
+
+    return writer.Close();
+  }
+
+  template <class N>
+  std::string SortDataGenerator<N>::GetRunFilename(const ImportParameter& parameter,
+                                                   size_t index) const
+  {
+    return AppendFileToDir(parameter.GetDestinationDirectory(),
+                           dataFilename+"."+NumberToString(index)+".tmp");
+  }
+
+  /**
+   * Read all sources and write them as sorted runs. Each run holds as much objects as fit
+   * into the sort buffer divided by the number of threads. While the current run gets
+   * filled, the previous runs are sorted and written in parallel.
+   */
+  template <class N>
+  bool SortDataGenerator<N>::GenerateRuns(const TypeConfig& typeConfig,
+                                          const ImportParameter& parameter,
+                                          Progress& progress,
+                                          uint32_t& overallDataCount,
+                                          std::vector<std::string>& runFilenames)
+  {
+    std::list<FileScanner> rawScanners;
+    double                 zoomLevel=pow(2.0,(double)parameter.GetSortTileMag());
+    size_t                 threadCount=1;
+    bool                   success=true;
+    uint32_t               dataReadCount=0;
+    SortRunRef             run;
+    size_t                 runSize=0;
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+    std::list<std::thread> threads;
+    std::list<SortRunRef>  threadRuns;
+
+    threadCount=std::max(parameter.GetThreadCount(),(size_t)1);
+#endif
+
+    size_t runBufferSize=std::max(parameter.GetSortBufferSize()/threadCount,(size_t)1);
+
+    overallDataCount=0;
+
+    // The sources are read twice in parallel, once for parsing the objects
+    // and once for copying the raw object data into the run buffer
     for (auto& source : sources) {
       uint32_t dataCount;
 
+      rawScanners.push_back(FileScanner());
+
       if (!source.scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                                source.filename),
                                 FileScanner::Sequential,
-                                parameter.GetWayDataMemoryMaped())) {
+                                parameter.GetWayDataMemoryMaped()) ||
+          !rawScanners.back().Open(source.scanner.GetFilename(),
+                                   FileScanner::Sequential,
+                                   parameter.GetWayDataMemoryMaped())) {
         progress.Error(std::string("Cannot open '")+source.scanner.GetFilename()+"'");
         return false;
       }
 
-      if (!source.scanner.Read(dataCount)) {
+      if (!source.scanner.Read(dataCount) ||
+          !rawScanners.back().Read(dataCount)) {
         progress.Error("Error while reading number of data entries in file");
         return false;
       }
@@ -211,223 +494,376 @@ namespace osmscout {
       overallDataCount+=dataCount;
     }
 
+    auto rawScanner=rawScanners.begin();
 
-    if (!dataWriter.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
-                                        dataFilename))) {
-      progress.Error(std::string("Cannot create '")+dataWriter.GetFilename()+"'");
-      return false;
-    }
+    for (auto source=sources.begin();
+         source!=sources.end() && success;
+         ++source, ++rawScanner) {
+      uint32_t dataCount;
 
-    dataWriter.Write(overallDataCount);
+      progress.Info("Reading objects from file '"+source->scanner.GetFilename()+"'");
 
-    if (!mapWriter.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
-                                        mapFilename))) {
-      progress.Error(std::string("Cannot create '")+mapWriter.GetFilename()+"'");
-      return false;
-    }
+      if (!source->scanner.GotoBegin() ||
+          !source->scanner.Read(dataCount)) {
+        progress.Error("Error while reading number of data entries in file'"+
+                       source->scanner.GetFilename()+"'");
+        success=false;
+        break;
+      }
 
-    mapWriter.Write(overallDataCount);
+      for (uint32_t current=1; current<=dataCount; current++) {
+        FileOffset entryStart;
+        FileOffset entryEnd;
+        uint8_t    type;
+        Id         id;
+        N          data;
 
-    while (true) {
-      progress.Info("Reading objects in cell range "+NumberToString(minIndex)+ "-"+NumberToString(maxIndex));
+        progress.SetProgress(current,dataCount);
 
-      size_t                                 currentEntries=0;
-      std::map<size_t,std::list<CellEntry> > dataByCellMap;
+        if (!source->scanner.GetPos(entryStart) ||
+            !source->scanner.Read(type) ||
+            !source->scanner.Read(id) ||
+            !data.Read(typeConfig,
+                       source->scanner) ||
+            !source->scanner.GetPos(entryEnd)) {
+          progress.Error(std::string("Error while reading data entry ")+
+                         NumberToString(current)+" of "+
+                         NumberToString(dataCount)+
+                         " in file '"+
+                         source->scanner.GetFilename()+"'");
+          success=false;
+          break;
+        }
 
-      for (typename std::list<Source>::iterator source=sources.begin();
-           source!=sources.end();
-           ++source) {
-        uint32_t dataCount;
-        progress.Info("Reading objects from file '"+source->scanner.GetFilename()+"'");
+        dataReadCount++;
 
-        if (!source->scanner.GotoBegin()) {
-          progress.Error(std::string("Error while setting current position in file '")+
-                         source->scanner.GetFilename()+"'");
+        double maxLat;
+        double minLon;
+
+        GetTopLeftCoordinate(data,maxLat,minLon);
+
+        size_t    cellY=(size_t)((maxLat+90.0)/180.0*zoomLevel);
+        size_t    cellX=(size_t)((minLon+180.0)/360.0*zoomLevel);
+        SortEntry entry;
+
+        entry.key.cell=(size_t)(cellY*zoomLevel+cellX);
+        entry.key.lat=maxLat;
+        entry.key.lon=minLon;
+
+        if (!run) {
+          run=std::make_shared<SortRun>();
+          run->filename=GetRunFilename(parameter,
+                                       runFilenames.size());
+          run->success=false;
+          runFilenames.push_back(run->filename);
+          runSize=0;
         }
 
-        if (!source->scanner.Read(dataCount)) {
-          progress.Error("Error while reading number of data entries in file'"+
-                         source->scanner.GetFilename()+"'");
-          return false;
+        entry.offset=run->data.size();
+        entry.length=(size_t)(entryEnd-entryStart);
+
+        run->data.resize(entry.offset+entry.length);
+
+        if (!rawScanner->Read(&run->data[entry.offset],
+                              entry.length)) {
+          progress.Error(std::string("Error while copying data entry ")+
+                         NumberToString(current)+
+                         " in file '"+
+                         rawScanner->GetFilename()+"'");
+          success=false;
+          break;
         }
 
-        uint32_t current=1;
+        run->entries.push_back(entry);
+        runSize+=sizeof(SortEntry)+entry.length;
 
-        while (current<=dataCount) {
-          uint8_t type;
-          Id      id;
-          N       data;
+        if (runSize<runBufferSize &&
+            dataReadCount<overallDataCount) {
+          continue;
+        }
 
-          progress.SetProgress(current,dataCount);
+#if defined(OSMSCOUT_HAVE_THREAD)
+        if (threadCount>1) {
+          // All threads busy => Wait for the oldest one
+          if (threads.size()>=threadCount-1) {
+            threads.front().join();
+            threads.pop_front();
 
-          if (!source->scanner.Read(type) ||
-              !source->scanner.Read(id) ||
-              !data.Read(typeConfig,
-                         source->scanner)) {
-            progress.Error(std::string("Error while reading data entry ")+
-                           NumberToString(current)+" of "+
-                           NumberToString(dataCount)+
-                           " in file '"+
-                           source->scanner.GetFilename()+"'");
-            return false;
+            if (!threadRuns.front()->success) {
+              progress.Error("Error while writing '"+threadRuns.front()->filename+"'");
+              success=false;
+            }
+
+            threadRuns.pop_front();
           }
 
-          double maxLat;
-          double minLon;
+          threads.push_back(std::thread(WriteRunJob,
+                                        run.get()));
+          threadRuns.push_back(run);
+        }
+        else
+#endif
+        if (!WriteRun(*run)) {
+          progress.Error("Error while writing '"+run->filename+"'");
+          success=false;
+        }
 
-          GetTopLeftCoordinate(data,maxLat,minLon);
+        run.reset();
 
-          size_t cellY=(size_t)((maxLat+90.0)/180.0*zoomLevel);
-          size_t cellX=(size_t)((minLon+180.0)/360.0*zoomLevel);
-          size_t cellIndex=cellY*zoomLevel+cellX;
+        if (!success) {
+          break;
+        }
+      }
+    }
 
-          if (cellIndex>=minIndex &&
-              cellIndex<=maxIndex) {
-            dataByCellMap[cellIndex].push_back(CellEntry(type,
-                                                         id,
-                                                         source,
-                                                         data.GetFileOffset(),
-                                                         maxLat,
-                                                         minLon));
-            currentEntries++;
-          }
+#if defined(OSMSCOUT_HAVE_THREAD)
+    while (!threads.empty()) {
+      threads.front().join();
+      threads.pop_front();
 
-          // Reduce cell interval, deleting all already stored nodes beyond the new
-          // cell range end.
-          if (currentEntries>parameter.GetSortBlockSize() &&
-              dataByCellMap.size()>1) {
-            size_t                                                    count=0;
-            size_t                                                    cutLimit=parameter.GetSortBlockSize()*9/10;
-            typename std::map<size_t,std::list<CellEntry> >::iterator cutOff=dataByCellMap.end();
-
-            for (typename std::map<size_t,std::list<CellEntry> >::iterator iter=dataByCellMap.begin();
-                iter!=dataByCellMap.end();
-                ++iter) {
-              if (count<=cutLimit &&
-                  count+iter->second.size()>cutLimit) {
-                cutOff=iter;
-                break;
-              }
-              else {
-                maxIndex=iter->first;
-                count+=iter->second.size();
-              }
-            }
+      if (!threadRuns.front()->success) {
+        progress.Error("Error while writing '"+threadRuns.front()->filename+"'");
+        success=false;
+      }
 
-            assert(cutOff!=dataByCellMap.end());
+      threadRuns.pop_front();
+    }
+#endif
 
-            currentEntries=count;
-            dataByCellMap.erase(cutOff,dataByCellMap.end());
-          }
+    for (auto& source : sources) {
+      if (!source.scanner.Close()) {
+        progress.Error(std::string("Error while closing '")+source.scanner.GetFilename()+"'");
+        success=false;
+      }
+    }
+
+    for (auto& scanner : rawScanners) {
+      scanner.Close();
+    }
+
+    return success;
+  }
+
+  /**
+   * Sort the data by cell and position within the cell using an external merge sort.
+   * The sources are split into sorted runs (see GenerateRuns()), which then get merged
+   * (in multiple steps if there are too many of them) into the data file.
+   */
+  template <class N>
+  bool SortDataGenerator<N>::Renumber(const TypeConfig& typeConfig,
+                                      const ImportParameter& parameter,
+                                      Progress& progress)
+  {
+    FileWriter               dataWriter;
+    FileWriter               mapWriter;
+    uint32_t                 overallDataCount=0;
+    uint32_t                 dataCopiedCount=0;
+    std::vector<std::string> runFilenames;
+    std::vector<std::string> tmpFilenames;
+    bool                     success;
+
+    progress.SetAction("Sorting data");
+
+    success=GenerateRuns(typeConfig,
+                         parameter,
+                         progress,
+                         overallDataCount,
+                         runFilenames);
+
+    tmpFilenames=runFilenames;
+
+    if (success) {
+      progress.Info(NumberToString(runFilenames.size())+" sorted run(s) written");
+    }
+
+    // Reduce the number of runs until they can be merged in one go
+    while (success &&
+           runFilenames.size()>maxMergeRuns) {
+      std::vector<std::string> mergedRunFilenames;
+
+      progress.Info("Merging "+NumberToString(runFilenames.size())+" runs");
+
+      for (size_t start=0; start<runFilenames.size() && success; start+=maxMergeRuns) {
+        size_t end=std::min(start+maxMergeRuns,runFilenames.size());
+
+        std::vector<std::string> group(runFilenames.begin()+start,
+                                       runFilenames.begin()+end);
+        std::string              filename=GetRunFilename(parameter,
+                                                         tmpFilenames.size());
 
-          current++;
+        tmpFilenames.push_back(filename);
+
+        if (!MergeRuns(group,
+                       filename)) {
+          progress.Error("Error while merging runs into '"+filename+"'");
+          success=false;
+        }
+
+        for (const auto& runFilename : group) {
+          RemoveFile(runFilename);
         }
+
+        mergedRunFilenames.push_back(filename);
       }
 
-      if (maxIndex<cellCount-1) {
-        progress.Info("Cell range was reduced to "+NumberToString(minIndex)+ "-"+NumberToString(maxIndex));
+      runFilenames=mergedRunFilenames;
+    }
+
+    std::vector<RunScanner>         scanners(runFilenames.size());
+    std::priority_queue<MergeEntry> queue;
+
+    for (size_t r=0; r<runFilenames.size() && success; r++) {
+      if (!scanners[r].Open(runFilenames[r])) {
+        progress.Error(std::string("Cannot open '")+runFilenames[r]+"'");
+        success=false;
+        break;
       }
 
-      progress.Info(std::string("Copy renumbered data to '")+dataWriter.GetFilename()+"'");
+      if (scanners[r].remaining>0) {
+        MergeEntry entry;
 
-      size_t copyCount=0;
-      for (typename std::map<size_t,std::list<CellEntry> >::iterator iter=dataByCellMap.begin();
-          iter!=dataByCellMap.end();
-          ++iter) {
+        if (!scanners[r].ReadNext()) {
+          progress.Error(std::string("Error while reading '")+runFilenames[r]+"'");
+          success=false;
+          break;
+        }
 
-        iter->second.sort();
+        entry.key=scanners[r].key;
+        entry.run=r;
 
-        for (auto& entry : iter->second) {
-          progress.SetProgress(copyCount,currentEntries);
+        queue.push(entry);
+      }
+    }
 
-          copyCount++;
+    if (success) {
+      if (dataWriter.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          dataFilename))) {
+        dataWriter.Write(overallDataCount);
+      }
+      else {
+        progress.Error(std::string("Cannot create '")+dataWriter.GetFilename()+"'");
+        success=false;
+      }
+    }
 
-          N data;
+    if (success) {
+      if (mapWriter.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         mapFilename))) {
+        mapWriter.Write(overallDataCount);
+      }
+      else {
+        progress.Error(std::string("Cannot create '")+mapWriter.GetFilename()+"'");
+        success=false;
+      }
+    }
 
-          if (!entry.source->scanner.SetPos(entry.fileOffset)) {
-            progress.Error(std::string("Error while setting current position in file '")+
-                           entry.source->scanner.GetFilename()+"'");
+    if (success) {
+      progress.Info(std::string("Merging ")+NumberToString(runFilenames.size())+" run(s) into '"+dataWriter.GetFilename()+"'");
+    }
 
-            return false;
-          }
+    size_t copyCount=0;
 
-          if (!data.Read(typeConfig,
-                         entry.source->scanner))  {
-            progress.Error(std::string("Error while reading data entry at offset ")+
-                           NumberToString(entry.fileOffset)+
-                           " in file '"+
-                           entry.source->scanner.GetFilename()+"'");
+    while (success &&
+           !queue.empty()) {
+      MergeEntry  entry=queue.top();
+      RunScanner& scanner=scanners[entry.run];
+      uint8_t     type;
+      Id          id;
+      N           data;
 
-            return false;
-          }
+      queue.pop();
 
-          FileOffset fileOffset;
-          bool       save=true;
+      progress.SetProgress(copyCount,overallDataCount);
 
-          if (!dataWriter.GetPos(fileOffset)) {
-            progress.Error(std::string("Error while reading current fileOffset in file '")+
-                           dataWriter.GetFilename()+"'");
-            return false;
-          }
+      copyCount++;
 
-          for (const auto& filter : filters) {
-            if (!filter->Process(progress,
-                                 fileOffset,
-                                 data,
-                                 save)) {
-              progress.Error(std::string("Error while processing data entry to file '")+
-                             dataWriter.GetFilename()+"'");
+      if (!scanner.scanner.Read(type) ||
+          !scanner.scanner.Read(id) ||
+          !data.Read(typeConfig,
+                     scanner.scanner)) {
+        progress.Error(std::string("Error while reading data entry from file '")+
+                       scanner.scanner.GetFilename()+"'");
+        success=false;
+        break;
+      }
 
-              return false;
-            }
+      if (scanner.remaining>0) {
+        if (!scanner.ReadNext()) {
+          progress.Error(std::string("Error while reading '")+scanner.scanner.GetFilename()+"'");
+          success=false;
+          break;
+        }
 
-            if (!save) {
-              break;
-            }
-          }
+        entry.key=scanner.key;
 
-          if (!save) {
-            continue;
-          }
+        queue.push(entry);
+      }
 
-          if (!data.Write(typeConfig,
-                          dataWriter)) {
-            progress.Error(std::string("Error while writing data entry to file '")+
-                           dataWriter.GetFilename()+"'");
-            return false;
-          }
+      FileOffset fileOffset;
+      bool       save=true;
 
-          mapWriter.Write(entry.id);
-          mapWriter.Write(entry.type);
-          mapWriter.WriteFileOffset(fileOffset);
+      if (!dataWriter.GetPos(fileOffset)) {
+        progress.Error(std::string("Error while reading current fileOffset in file '")+
+                       dataWriter.GetFilename()+"'");
+        success=false;
+        break;
+      }
 
-          dataCopiedCount++;
+      for (const auto& filter : filters) {
+        if (!filter->Process(progress,
+                             fileOffset,
+                             data,
+                             save)) {
+          progress.Error(std::string("Error while processing data entry to file '")+
+                         dataWriter.GetFilename()+"'");
+          success=false;
+          break;
+        }
+
+        if (!save) {
+          break;
         }
       }
 
-      if (currentEntries==0) {
-        progress.Info("No more entries found");
+      if (!success) {
         break;
       }
 
-      if (maxIndex==cellCount-1) {
-        // We are finished
+      if (!save) {
+        continue;
+      }
+
+      if (!data.Write(typeConfig,
+                      dataWriter)) {
+        progress.Error(std::string("Error while writing data entry to file '")+
+                       dataWriter.GetFilename()+"'");
+        success=false;
         break;
       }
 
-      minIndex=maxIndex+1;
-      maxIndex=cellCount-1;
-    }
+      mapWriter.Write(id);
+      mapWriter.Write(type);
+      mapWriter.WriteFileOffset(fileOffset);
 
-    assert(overallDataCount>=dataCopiedCount);
+      dataCopiedCount++;
+    }
 
-    for (auto& source : sources) {
-      if (!source.scanner.Close()) {
-        progress.Error(std::string("Error while  closing '")+source.scanner.GetFilename()+"'");
-        return false;
+    for (auto& scanner : scanners) {
+      if (scanner.scanner.IsOpen()) {
+        scanner.scanner.Close();
       }
     }
 
+    for (const auto& filename : tmpFilenames) {
+      RemoveFile(filename);
+    }
+
+    if (!success) {
+      return false;
+    }
+
+    assert(overallDataCount>=dataCopiedCount);
+
     progress.Info(NumberToString(dataCopiedCount)+" of " +NumberToString(overallDataCount) + " object(s) written to file '"+dataWriter.GetFilename()+"'");
 
     dataWriter.SetPos(0);
@@ -570,6 +1006,24 @@ namespace osmscout {
            mapWriter.Close();
   }
 
+  template <class N>
+  void SortDataGenerator<N>::GetModuleDescription(const ImportParameter& parameter,
+                                                  ImportModuleDescription& description) const
+  {
+    for (const auto& source : sources) {
+      description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                  source.filename));
+    }
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                dataFilename));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                mapFilename));
+
+    // Uses multiple threads and the complete sort buffer itself
+    description.SetExclusive(true);
+  }
+
   template <class N>
   bool SortDataGenerator<N>::Import(const TypeConfigRef& typeConfig,
                                     const ImportParameter& parameter,
@@ -37,6 +37,8 @@ namespace osmscout {
     SortNodeDataGenerator();
 
     std::string GetDescription() const;
+    void GetModuleDescription(const ImportParameter& parameter,
+                              ImportModuleDescription& description) const;
   };
 }
 
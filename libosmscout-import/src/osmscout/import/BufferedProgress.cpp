@@ -0,0 +1,132 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/BufferedProgress.h>
+
+namespace osmscout {
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+  BufferedProgress::BufferedProgress(std::mutex& mutex,
+                                     Progress& target)
+  : mutex(mutex),
+    target(target),
+    attached(false)
+  {
+    SetOutputDebug(target.OutputDebug());
+  }
+
+  void BufferedProgress::Output(MessageType type,
+                                const std::string& text)
+  {
+    switch (type) {
+    case messageStep:
+      target.SetStep(text);
+      break;
+    case messageAction:
+      target.SetAction(text);
+      break;
+    case messageDebug:
+      target.Debug(text);
+      break;
+    case messageInfo:
+      target.Info(text);
+      break;
+    case messageWarning:
+      target.Warning(text);
+      break;
+    case messageError:
+      target.Error(text);
+      break;
+    }
+  }
+
+  void BufferedProgress::AddMessage(MessageType type,
+                                    const std::string& text)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (attached) {
+      Output(type,text);
+    }
+    else {
+      Message message;
+
+      message.type=type;
+      message.text=text;
+
+      messages.push_back(message);
+    }
+  }
+
+  /**
+   * Replay all buffered messages and pass all following messages directly to the
+   * target. The caller must hold the mutex.
+   */
+  void BufferedProgress::Attach()
+  {
+    for (const auto& message : messages) {
+      Output(message.type,
+             message.text);
+    }
+
+    messages.clear();
+    attached=true;
+  }
+
+  void BufferedProgress::SetStep(const std::string& step)
+  {
+    AddMessage(messageStep,step);
+  }
+
+  void BufferedProgress::SetAction(const std::string& action)
+  {
+    AddMessage(messageAction,action);
+  }
+
+  void BufferedProgress::SetProgress(double current, double total)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Buffered progress is of no interest later on
+    if (attached) {
+      target.SetProgress(current,total);
+    }
+  }
+
+  void BufferedProgress::Debug(const std::string& text)
+  {
+    AddMessage(messageDebug,text);
+  }
+
+  void BufferedProgress::Info(const std::string& text)
+  {
+    AddMessage(messageInfo,text);
+  }
+
+  void BufferedProgress::Warning(const std::string& text)
+  {
+    AddMessage(messageWarning,text);
+  }
+
+  void BufferedProgress::Error(const std::string& text)
+  {
+    AddMessage(messageError,text);
+  }
+#endif
+}
@@ -38,6 +38,16 @@ namespace osmscout {
     return "Generate 'areaarea.idx'";
   }
 
+  void AreaAreaIndexGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                    ImportModuleDescription& description) const
+  {
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areas.dat"));
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areaarea.idx"));
+  }
+
   void AreaAreaIndexGenerator::SetOffsetOfChildren(const std::map<Pixel,AreaLeaf>& leafs,
                                                    std::map<Pixel,AreaLeaf>& newAreaLeafs)
   {
@@ -55,6 +55,16 @@ namespace osmscout {
     return "Generate 'areanode.idx'";
   }
 
+  void AreaNodeIndexGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                    ImportModuleDescription& description) const
+  {
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "nodes.dat"));
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areanode.idx"));
+  }
+
   bool AreaNodeIndexGenerator::Import(const TypeConfigRef& typeConfig,
                                       const ImportParameter& parameter,
                                       Progress& progress)
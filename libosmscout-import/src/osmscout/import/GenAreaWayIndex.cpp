@@ -55,6 +55,16 @@ namespace osmscout {
     return "Generate 'areaway.idx'";
   }
 
+  void AreaWayIndexGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                   ImportModuleDescription& description) const
+  {
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "ways.dat"));
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areaway.idx"));
+  }
+
   bool AreaWayIndexGenerator::FitsIndexCriteria(const ImportParameter& /*parameter*/,
                                                 Progress& progress,
                                                 const TypeInfo& typeInfo,
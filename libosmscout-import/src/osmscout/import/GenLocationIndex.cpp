@@ -19,6 +19,7 @@
 
 #include <osmscout/import/GenLocationIndex.h>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <limits>
@@ -31,6 +32,7 @@
 #include <osmscout/TypeFeatures.h>
 
 #include <osmscout/LocationIndex.h>
+#include <osmscout/LocationSearchIndex.h>
 
 #include <osmscout/system/Assert.h>
 #include <osmscout/system/Math.h>
@@ -1742,6 +1744,7 @@ namespace osmscout {
     for (auto& location : region.locations) {
       location.second.objects.sort(ObjectFileRefByFileOffsetComparator());
 
+      writer.GetPos(location.second.locationOffset);
       writer.Write(location.first);
       writer.WriteNumber((uint32_t)location.second.objects.size()); // Number of objects
 
@@ -1834,11 +1837,351 @@ namespace osmscout {
     return true;
   }
 
+  void LocationIndexGenerator::AddSearchNGrams(const std::string& name,
+                                               FileOffset entryOffset,
+                                               NGramMap& nGrams)
+  {
+    for (size_t i=0; i+LocationSearchIndex::NGRAM_LENGTH<=name.length(); i++) {
+      uint32_t nGram=((uint32_t)(uint8_t)name[i] << 16) |
+                     ((uint32_t)(uint8_t)name[i+1] << 8) |
+                     (uint32_t)(uint8_t)name[i+2];
+
+      std::vector<FileOffset>& entries=nGrams[nGram];
+
+      // Entries are written in increasing order, so duplicates are always at the end
+      if (entries.empty() ||
+          entries.back()!=entryOffset) {
+        entries.push_back(entryOffset);
+      }
+    }
+  }
+
+  bool LocationIndexGenerator::WriteSearchRegionEntries(FileWriter& writer,
+                                                        uint8_t bytesForLocationFileOffset,
+                                                        const Region& region,
+                                                        NGramMap& nGrams)
+  {
+    FileOffset  entryOffset;
+    std::string name(region.name);
+
+    LocationSearchIndex::NormalizeName(name);
+
+    if (!writer.GetPos(entryOffset) ||
+        !writer.WriteFileOffset(region.indexOffset,
+                                bytesForLocationFileOffset) ||
+        !writer.WriteNumber((uint32_t)0) ||
+        !writer.Write(name)) {
+      return false;
+    }
+
+    AddSearchNGrams(name,
+                    entryOffset,
+                    nGrams);
+
+    uint32_t aliasIndex=1;
+
+    for (const auto& alias : region.aliases) {
+      name=alias.name;
+
+      LocationSearchIndex::NormalizeName(name);
+
+      if (!writer.GetPos(entryOffset) ||
+          !writer.WriteFileOffset(region.indexOffset,
+                                  bytesForLocationFileOffset) ||
+          !writer.WriteNumber(aliasIndex) ||
+          !writer.Write(name)) {
+        return false;
+      }
+
+      AddSearchNGrams(name,
+                      entryOffset,
+                      nGrams);
+
+      aliasIndex++;
+    }
+
+    for (const auto& childRegion : region.regions) {
+      if (!WriteSearchRegionEntries(writer,
+                                    bytesForLocationFileOffset,
+                                    *childRegion,
+                                    nGrams)) {
+        return false;
+      }
+    }
+
+    return !writer.HasError();
+  }
+
+  bool LocationIndexGenerator::WriteSearchLocationEntries(FileWriter& writer,
+                                                          uint8_t bytesForLocationFileOffset,
+                                                          const Region& region,
+                                                          std::vector<SearchRegionRange>& ranges,
+                                                          NGramMap& nGrams)
+  {
+    SearchRegionRange range;
+    std::string       name;
+
+    range.regionOffset=region.indexOffset;
+
+    if (!writer.GetPos(range.start)) {
+      return false;
+    }
+
+    for (const auto& poi : region.pois) {
+      FileOffset entryOffset;
+
+      name=poi.name;
+
+      LocationSearchIndex::NormalizeName(name);
+
+      if (!writer.GetPos(entryOffset) ||
+          !writer.WriteFileOffset(region.indexOffset,
+                                  bytesForLocationFileOffset) ||
+          !writer.Write(true) ||
+          !writer.Write(poi.name) ||
+          !writer.Write(poi.object) ||
+          !writer.Write(name)) {
+        return false;
+      }
+
+      AddSearchNGrams(name,
+                      entryOffset,
+                      nGrams);
+    }
+
+    for (const auto& location : region.locations) {
+      FileOffset entryOffset;
+
+      name=location.first;
+
+      LocationSearchIndex::NormalizeName(name);
+
+      if (!writer.GetPos(entryOffset) ||
+          !writer.WriteFileOffset(region.indexOffset,
+                                  bytesForLocationFileOffset) ||
+          !writer.Write(false) ||
+          !writer.WriteFileOffset(location.second.locationOffset,
+                                  bytesForLocationFileOffset) ||
+          !writer.Write(name)) {
+        return false;
+      }
+
+      AddSearchNGrams(name,
+                      entryOffset,
+                      nGrams);
+    }
+
+    for (const auto& childRegion : region.regions) {
+      if (!WriteSearchLocationEntries(writer,
+                                      bytesForLocationFileOffset,
+                                      *childRegion,
+                                      ranges,
+                                      nGrams)) {
+        return false;
+      }
+    }
+
+    if (!writer.GetPos(range.end)) {
+      return false;
+    }
+
+    ranges.push_back(range);
+
+    return !writer.HasError();
+  }
+
+  /**
+   * Writes the entry lists of all n-grams followed by the dictionary, which
+   * maps each n-gram to the offset of its list.
+   */
+  bool LocationIndexGenerator::WriteSearchDictionary(FileWriter& writer,
+                                                     const NGramMap& nGrams,
+                                                     FileOffset& dictionaryOffset)
+  {
+    std::vector<FileOffset> listOffsets;
+
+    listOffsets.reserve(nGrams.size());
+
+    for (const auto& nGram : nGrams) {
+      FileOffset listOffset;
+      FileOffset lastOffset=0;
+
+      if (!writer.GetPos(listOffset) ||
+          !writer.WriteNumber((uint32_t)nGram.second.size())) {
+        return false;
+      }
+
+      for (const auto offset : nGram.second) {
+        writer.WriteNumber(offset-lastOffset);
+
+        lastOffset=offset;
+      }
+
+      listOffsets.push_back(listOffset);
+    }
+
+    if (!writer.GetPos(dictionaryOffset)) {
+      return false;
+    }
+
+    size_t index=0;
+
+    for (const auto& nGram : nGrams) {
+      writer.Write(nGram.first);
+      writer.WriteFileOffset(listOffsets[index]);
+
+      index++;
+    }
+
+    return !writer.HasError();
+  }
+
+  bool LocationIndexGenerator::WriteSearchIndex(const ImportParameter& parameter,
+                                                Progress& progress,
+                                                const Region& rootRegion)
+  {
+    uint8_t                        bytesForLocationFileOffset;
+    FileWriter                     writer;
+    NGramMap                       nGrams;
+    std::vector<SearchRegionRange> ranges;
+    FileOffset                     regionTableOffset;
+    FileOffset                     regionDictionaryOffset;
+    uint32_t                       regionNGramCount;
+    FileOffset                     locationDictionaryOffset;
+    uint32_t                       locationNGramCount;
+
+    if (!BytesNeededToAddressFileData(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                      LocationIndex::FILENAME_LOCATION_IDX),
+                                      bytesForLocationFileOffset)) {
+      progress.Error("Cannot get file size of '"+std::string(LocationIndex::FILENAME_LOCATION_IDX)+"'");
+      return false;
+    }
+
+    if (!writer.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                     LocationSearchIndex::FILENAME_LOCATION_SEARCH_IDX))) {
+      progress.Error("Cannot open '"+writer.GetFilename()+"'");
+      return false;
+    }
+
+    // Placeholders for the header, which is written at the end
+    if (!writer.Write(bytesForLocationFileOffset) ||
+        !writer.WriteFileOffset(0) ||
+        !writer.Write((uint32_t)0) ||
+        !writer.WriteFileOffset(0) ||
+        !writer.Write((uint32_t)0) ||
+        !writer.WriteFileOffset(0) ||
+        !writer.Write((uint32_t)0)) {
+      progress.Error("Cannot write to '"+writer.GetFilename()+"'");
+      return false;
+    }
+
+    for (const auto& childRegion : rootRegion.regions) {
+      if (!WriteSearchRegionEntries(writer,
+                                    bytesForLocationFileOffset,
+                                    *childRegion,
+                                    nGrams)) {
+        progress.Error("Cannot write to '"+writer.GetFilename()+"'");
+        return false;
+      }
+    }
+
+    if (!WriteSearchDictionary(writer,
+                               nGrams,
+                               regionDictionaryOffset)) {
+      progress.Error("Cannot write to '"+writer.GetFilename()+"'");
+      return false;
+    }
+
+    regionNGramCount=(uint32_t)nGrams.size();
+    nGrams.clear();
+
+    for (const auto& childRegion : rootRegion.regions) {
+      if (!WriteSearchLocationEntries(writer,
+                                      bytesForLocationFileOffset,
+                                      *childRegion,
+                                      ranges,
+                                      nGrams)) {
+        progress.Error("Cannot write to '"+writer.GetFilename()+"'");
+        return false;
+      }
+    }
+
+    if (!WriteSearchDictionary(writer,
+                               nGrams,
+                               locationDictionaryOffset)) {
+      progress.Error("Cannot write to '"+writer.GetFilename()+"'");
+      return false;
+    }
+
+    locationNGramCount=(uint32_t)nGrams.size();
+    nGrams.clear();
+
+    std::sort(ranges.begin(),
+              ranges.end());
+
+    if (!writer.GetPos(regionTableOffset)) {
+      progress.Error("Cannot write to '"+writer.GetFilename()+"'");
+      return false;
+    }
+
+    for (const auto& range : ranges) {
+      writer.WriteFileOffset(range.regionOffset);
+      writer.WriteFileOffset(range.start);
+      writer.WriteFileOffset(range.end);
+    }
+
+    if (!writer.SetPos(sizeof(uint8_t)) ||
+        !writer.WriteFileOffset(regionTableOffset) ||
+        !writer.Write((uint32_t)ranges.size()) ||
+        !writer.WriteFileOffset(regionDictionaryOffset) ||
+        !writer.Write(regionNGramCount) ||
+        !writer.WriteFileOffset(locationDictionaryOffset) ||
+        !writer.Write(locationNGramCount)) {
+      progress.Error("Cannot write to '"+writer.GetFilename()+"'");
+      return false;
+    }
+
+    progress.Info(NumberToString(ranges.size())+" regions, "+
+                  NumberToString(regionNGramCount)+" region n-grams, "+
+                  NumberToString(locationNGramCount)+" location n-grams");
+
+    if (writer.HasError() || !writer.Close()) {
+      progress.Error("Cannot close '"+writer.GetFilename()+"'");
+      return false;
+    }
+
+    return true;
+  }
+
   std::string LocationIndexGenerator::GetDescription() const
   {
     return "Generate 'location.idx'";
   }
 
+  void LocationIndexGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                    ImportModuleDescription& description) const
+  {
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "nodes.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "nodeaddress.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "ways.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "wayaddress.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areas.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areaaddress.dat"));
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                LocationIndex::FILENAME_LOCATION_IDX));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "location.txt"));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                LocationSearchIndex::FILENAME_LOCATION_SEARCH_IDX));
+  }
+
   bool LocationIndexGenerator::Import(const TypeConfigRef& typeConfig,
                                       const ImportParameter& parameter,
                                       Progress& progress)
@@ -2082,6 +2425,14 @@ namespace osmscout {
       return false;
     }
 
+    progress.SetAction(std::string("Write '")+LocationSearchIndex::FILENAME_LOCATION_SEARCH_IDX+"'");
+
+    if (!WriteSearchIndex(parameter,
+                          progress,
+                          *rootRegion)) {
+      return false;
+    }
+
     return true;
   }
 }
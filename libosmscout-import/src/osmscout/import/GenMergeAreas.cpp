@@ -31,6 +31,16 @@ namespace osmscout {
     return "Merge areas";
   }
 
+  void MergeAreasGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                 ImportModuleDescription& description) const
+  {
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areas.tmp"));
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areas2.tmp"));
+  }
+
   /**
    * Returns the index of the first outer ring that contains the given id.
    */
@@ -577,9 +587,7 @@ namespace osmscout {
       }
     }
 
-    std::vector<NodeUseMap> nodeUseMap;
-
-    nodeUseMap.resize(typeConfig->GetTypeCount());
+    std::vector<NodeUseMap> nodeUseMap(typeConfig->GetTypeCount());
 
     if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                       "areas.tmp"),
@@ -605,6 +613,14 @@ namespace osmscout {
       return false;
     }
 
+    size_t nodeUseMapMemory=0;
+
+    for (const auto& typeNodeUseMap : nodeUseMap) {
+      nodeUseMapMemory+=typeNodeUseMap.GetMemoryUsage();
+    }
+
+    progress.Info(ByteSizeToString(nodeUseMapMemory)+" used by node use maps");
+
     /* ------ */
 
     while (!mergeTypes.Empty()) {
@@ -41,6 +41,16 @@ namespace osmscout {
     return "Generate 'nodes.tmp'";
   }
 
+  void NodeDataGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                               ImportModuleDescription& description) const
+  {
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "rawnodes.dat"));
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "nodes.tmp"));
+  }
+
   bool NodeDataGenerator::Import(const TypeConfigRef& typeConfig,
                                  const ImportParameter& parameter,
                                  Progress& progress)
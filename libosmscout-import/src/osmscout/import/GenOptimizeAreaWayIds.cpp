@@ -33,6 +33,20 @@ namespace osmscout {
     return "Optimize ids for areas and ways";
   }
 
+  void OptimizeAreaWayIdsGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                         ImportModuleDescription& description) const
+  {
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areas2.tmp"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "wayway.tmp"));
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areas3.tmp"));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "ways.tmp"));
+  }
+
   bool OptimizeAreaWayIdsGenerator::ScanAreaIds(const ImportParameter& parameter,
                                                 Progress& progress,
                                                 const TypeConfig& typeConfig,
@@ -379,6 +393,9 @@ namespace osmscout {
       return false;
     }
 
+    progress.Info(NumberToString(nodeUseMap.GetNodeUsedCount())+" nodes used, "+
+                  ByteSizeToString(nodeUseMap.GetMemoryUsage())+" used by node use map");
+
     if (!CopyAreas(parameter,
                    progress,
                    *typeConfig,
@@ -59,6 +59,16 @@ namespace osmscout
     return "Generate '"+std::string(FILE_AREASOPT_DAT)+"'";
   }
 
+  void OptimizeAreasLowZoomGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                           ImportModuleDescription& description) const
+  {
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areas.dat"));
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areasopt.dat"));
+  }
+
   void OptimizeAreasLowZoomGenerator::GetAreaTypesToOptimize(const TypeConfig& typeConfig,
                                                              std::set<TypeInfoRef>& types)
   {
@@ -64,6 +64,16 @@ namespace osmscout
     return "Generate '"+std::string(FILE_WAYSOPT_DAT)+"'";
   }
 
+  void OptimizeWaysLowZoomGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                          ImportModuleDescription& description) const
+  {
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "ways.dat"));
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "waysopt.dat"));
+  }
+
   void OptimizeWaysLowZoomGenerator::GetWayTypesToOptimize(const TypeConfig& typeConfig,
                                                            std::set<TypeInfoRef>& types)
   {
@@ -21,14 +21,31 @@
 
 #include <algorithm>
 
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_MUTEX)
+#include <thread>
+#endif
+
 #include <osmscout/TypeFeatures.h>
 
 #include <osmscout/system/Assert.h>
 
 #include <osmscout/util/Geometry.h>
 
+#include <osmscout/import/BufferedProgress.h>
+
 namespace osmscout {
 
+  /**
+   * Maximum number of relations resolved in one batch
+   */
+  static const size_t relationBatchSize=1000;
+
+  /**
+   * Maximum number of member nodes (summed up over all relations) loaded
+   * for one batch
+   */
+  static const size_t relationBatchNodeCount=1000000;
+
   /**
     Returns true, if area a is in area b
    */
@@ -350,11 +367,14 @@ namespace osmscout {
 
     size_t ix=0;
     for (const auto& r1 : parts) {
-      size_t jx=0;
+      // Most rings do not overlap with r1 at all, the locator rejects their
+      // points without testing each edge of r1
+      AreaPointLocator locator(r1.role.nodes);
+      size_t           jx=0;
+
       for (const auto& r2 : parts) {
         if (ix!=jx) {
-          if (IsAreaSubOfArea(r2.role.nodes,
-                              r1.role.nodes)) {
+          if (locator.IsSubArea(r2.role.nodes)) {
             state.SetIncluded(ix,jx);
           }
         }
@@ -782,30 +802,12 @@ namespace osmscout {
   bool RelAreaDataGenerator::HandleMultipolygonRelation(const ImportParameter& parameter,
                                                         Progress& progress,
                                                         const TypeConfig& typeConfig,
-                                                        IdSet& wayAreaIndexBlacklist,
-                                                        CoordDataFile& coordDataFile,
-                                                        RawWayIndexedDataFile& wayDataFile,
-                                                        RawRelationIndexedDataFile& relDataFile,
-                                                        RawRelation& rawRelation,
-                                                        const std::string& name,
-                                                        Area& relation)
+                                                        MultipolygonJob& job)
   {
-    IdSet resolvedRelations;
-
-    std::list<MultipolygonPart> parts;
-
-    if (!ResolveMultipolygonMembers(progress,
-                                    typeConfig,
-                                    coordDataFile,
-                                    wayDataFile,
-                                    relDataFile,
-                                    resolvedRelations,
-                                    relation,
-                                    name,
-                                    rawRelation,
-                                    parts)) {
-      return false;
-    }
+    RawRelation&                 rawRelation=job.rawRelation;
+    const std::string&           name=job.name;
+    std::list<MultipolygonPart>& parts=job.parts;
+    Area&                        relation=job.relation;
 
     // Reconstruct multipolygon relation by applying the multipolygon resolving
     // algorithm as described at
@@ -940,7 +942,7 @@ namespace osmscout {
         // However because we change the type of area rings to typeIgnore above we need some bookkeeping for this
         // to work here.
         // On the other hand do not fill the blacklist until you are sure that the relation will not be rejected.
-        wayAreaIndexBlacklist.insert(ring.ways.front()->GetId());
+        job.blacklistedWays.push_back(ring.ways.front()->GetId());
       }
     }
 
@@ -960,6 +962,91 @@ namespace osmscout {
     return true;
   }
 
+  void RelAreaDataGenerator::HandleMultipolygonJobs(MultipolygonBatch* batch)
+  {
+    while (true) {
+      MultipolygonJobRef job;
+
+      {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+        std::lock_guard<std::mutex> lock(batch->mutex);
+#endif
+
+        if (batch->nextJob>=batch->jobs.size()) {
+          return;
+        }
+
+        job=batch->jobs[batch->nextJob];
+        batch->nextJob++;
+      }
+
+      job->success=HandleMultipolygonRelation(*batch->parameter,
+                                              *job->progress,
+                                              *batch->typeConfig,
+                                              *job);
+    }
+  }
+
+  /**
+   * Resolve all jobs of the batch. Since jobs only share read-only data, they are
+   * distributed over multiple threads, if allowed. The output of each job is
+   * buffered and passed on in the order of the jobs.
+   */
+  void RelAreaDataGenerator::HandleMultipolygonBatch(const ImportParameter& parameter,
+                                                     Progress& progress,
+                                                     const TypeConfig& typeConfig,
+                                                     MultipolygonBatch& batch)
+  {
+    batch.parameter=&parameter;
+    batch.typeConfig=&typeConfig;
+    batch.nextJob=0;
+
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_MUTEX)
+    if (parameter.GetThreadCount()>1 &&
+        batch.jobs.size()>1) {
+      std::mutex                  mutex;
+      std::list<BufferedProgress> progresses;
+      std::vector<std::thread>    threads;
+      size_t                      threadCount=std::min(parameter.GetThreadCount(),
+                                                       batch.jobs.size());
+
+      for (auto& job : batch.jobs) {
+        progresses.emplace_back(mutex,
+                                progress);
+        job->progress=&progresses.back();
+      }
+
+      for (size_t t=0; t<threadCount; t++) {
+        threads.push_back(std::thread(&RelAreaDataGenerator::HandleMultipolygonJobs,
+                                      this,
+                                      &batch));
+      }
+
+      for (auto& thread : threads) {
+        thread.join();
+      }
+
+      std::lock_guard<std::mutex> lock(mutex);
+
+      for (auto& jobProgress : progresses) {
+        jobProgress.Attach();
+      }
+
+      for (auto& job : batch.jobs) {
+        job->progress=&progress;
+      }
+
+      return;
+    }
+#endif
+
+    for (auto& job : batch.jobs) {
+      job->progress=&progress;
+    }
+
+    HandleMultipolygonJobs(&batch);
+  }
+
   std::string RelAreaDataGenerator::ResolveRelationName(const FeatureRef& featureName,
                                                         const RawRelation& rawRelation) const
   {
@@ -983,6 +1070,26 @@ namespace osmscout {
     return "Generate 'relarea.tmp'";
   }
 
+  void RelAreaDataGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                  ImportModuleDescription& description) const
+  {
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "coord.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "rawrels.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "rawrel.idx"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "rawways.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "rawway.idx"));
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "relarea.tmp"));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "wayareablack.dat"));
+  }
+
   bool RelAreaDataGenerator::Import(const TypeConfigRef& typeConfig,
                                     const ImportParameter& parameter,
                                     Progress& progress)
@@ -1060,81 +1167,134 @@ namespace osmscout {
 
     writer.Write(writtenRelationCount);
 
-    for (uint32_t r=1; r<=rawRelationCount; r++) {
-      progress.SetProgress(r,rawRelationCount);
+    MultipolygonBatch batch;
+    uint32_t          r=1;
 
-      RawRelation rawRel;
+    while (r<=rawRelationCount) {
 
-      if (!rawRel.Read(*typeConfig,
-                       scanner)) {
-        progress.Error(std::string("Error while reading data entry ")+
-                       NumberToString(r)+" of "+
-                       NumberToString(rawRelationCount)+
-                       " in file '"+
-                       scanner.GetFilename()+"'");
-        return false;
-      }
+      //
+      // Load the next batch of relations together with their members
+      //
 
-      // Normally we now also skip an object because of its missing type, but
-      // in case of relations things are a little bit more difficult,
-      // type might be placed at the outer ring and not on the relation
-      // itself, we thus still need to parse the complete relation for
-      // type analysis before we can skip it.
+      size_t batchNodeCount=0;
 
-      std::string name=ResolveRelationName(featureName,
-                                           rawRel);
-      Area        rel;
+      batch.jobs.clear();
 
-      if (!HandleMultipolygonRelation(parameter,
-                                      progress,
-                                      *typeConfig,
-                                      wayAreaIndexBlacklist,
-                                      coordDataFile,
-                                      wayDataFile,
-                                      relDataFile,
-                                      rawRel,
-                                      name,
-                                      rel)) {
-        continue;
+      while (r<=rawRelationCount &&
+             batch.jobs.size()<relationBatchSize &&
+             batchNodeCount<relationBatchNodeCount) {
+        progress.SetProgress(r,rawRelationCount);
+
+        MultipolygonJobRef job=std::make_shared<MultipolygonJob>();
+
+        if (!job->rawRelation.Read(*typeConfig,
+                                   scanner)) {
+          progress.Error(std::string("Error while reading data entry ")+
+                         NumberToString(r)+" of "+
+                         NumberToString(rawRelationCount)+
+                         " in file '"+
+                         scanner.GetFilename()+"'");
+          return false;
+        }
+
+        r++;
+
+        // Normally we now also skip an object because of its missing type, but
+        // in case of relations things are a little bit more difficult,
+        // type might be placed at the outer ring and not on the relation
+        // itself, we thus still need to parse the complete relation for
+        // type analysis before we can skip it.
+
+        IdSet resolvedRelations;
+
+        job->name=ResolveRelationName(featureName,
+                                      job->rawRelation);
+        job->progress=&progress;
+        job->success=false;
+
+        if (!ResolveMultipolygonMembers(progress,
+                                        *typeConfig,
+                                        coordDataFile,
+                                        wayDataFile,
+                                        relDataFile,
+                                        resolvedRelations,
+                                        job->relation,
+                                        job->name,
+                                        job->rawRelation,
+                                        job->parts)) {
+          continue;
+        }
+
+        for (const auto& part : job->parts) {
+          batchNodeCount+=part.role.nodes.size();
+        }
+
+        batch.jobs.push_back(job);
       }
 
-      bool valid=true;
+      //
+      // Resolve all multipolygons of the batch
+      //
 
-      for (const auto& ring : rel.rings) {
-        if (ring.ring!=Area::masterRingId) {
-          if (ring.nodes.size()<3) {
-            valid=false;
+      HandleMultipolygonBatch(parameter,
+                              progress,
+                              *typeConfig,
+                              batch);
 
-            break;
+      //
+      // Write the result in the original order of the relations
+      //
+
+      for (const auto& job : batch.jobs) {
+        if (!job->success) {
+          continue;
+        }
+
+        const Area& rel=job->relation;
+        bool        valid=true;
+
+        for (const auto& id : job->blacklistedWays) {
+          wayAreaIndexBlacklist.insert(id);
+        }
+
+        for (const auto& ring : rel.rings) {
+          if (ring.ring!=Area::masterRingId) {
+            if (ring.nodes.size()<3) {
+              valid=false;
+
+              break;
+            }
           }
         }
-      }
 
-      if (!valid) {
-        progress.Warning("Relation "+
-                         NumberToString(rawRel.GetId())+" "+
-                         rel.GetType()->GetName()+" "+
-                         name+" has ring with less than three nodes, skipping");
-        continue;
-      }
+        if (!valid) {
+          progress.Warning("Relation "+
+                           NumberToString(job->rawRelation.GetId())+" "+
+                           rel.GetType()->GetName()+" "+
+                           job->name+" has ring with less than three nodes, skipping");
+          continue;
+        }
 
-      areaTypeCount[rel.GetType()->GetIndex()]++;
-      for (const auto& ring: rel.rings) {
-        if (ring.ring==Area::outerRingId) {
-          areaNodeTypeCount[rel.GetType()->GetIndex()]+=ring.nodes.size();
+        areaTypeCount[rel.GetType()->GetIndex()]++;
+        for (const auto& ring: rel.rings) {
+          if (ring.ring==Area::outerRingId) {
+            areaNodeTypeCount[rel.GetType()->GetIndex()]+=ring.nodes.size();
+          }
         }
-      }
 
-      if (!writer.Write((uint8_t)osmRefRelation) ||
-          !writer.Write(rawRel.GetId()) ||
-          !rel.WriteImport(*typeConfig,
-                           writer)) {
-        return false;
-      }
+        if (!writer.Write((uint8_t)osmRefRelation) ||
+            !writer.Write(job->rawRelation.GetId()) ||
+            !rel.WriteImport(*typeConfig,
+                             writer)) {
+          return false;
+        }
 
-      writtenRelationCount++;
+        writtenRelationCount++;
+      }
     }
 
+    batch.jobs.clear();
+
     progress.Info(NumberToString(rawRelationCount)+" relations read"+
                   ", "+NumberToString(writtenRelationCount)+" relations written");
 
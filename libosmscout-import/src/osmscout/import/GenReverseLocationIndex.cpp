@@ -0,0 +1,1433 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/GenReverseLocationIndex.h>
+
+#include <algorithm>
+
+#include <osmscout/Area.h>
+#include <osmscout/Node.h>
+#include <osmscout/ReverseLocationIndex.h>
+#include <osmscout/Way.h>
+
+#include <osmscout/system/Math.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/String.h>
+
+namespace osmscout {
+
+  //! Level of the cell grid, cells are about 1.2km high
+  static const uint32_t CELL_LEVEL=14;
+
+  //! Number of rows of cells generated at once
+  static const uint32_t CELL_BAND_HEIGHT=256;
+
+  class RegionCollectorVisitor : public AdminRegionVisitor
+  {
+  public:
+    std::list<AdminRegionRef> regions;
+
+  public:
+    Action Visit(const AdminRegion& region);
+  };
+
+  AdminRegionVisitor::Action RegionCollectorVisitor::Visit(const AdminRegion& region)
+  {
+    regions.push_back(std::make_shared<AdminRegion>(region));
+
+    return visitChildren;
+  }
+
+  class LocationCollectorVisitor : public LocationVisitor
+  {
+  public:
+    std::list<Location> locations;
+
+  public:
+    bool Visit(const AdminRegion& adminRegion,
+               const POI &poi);
+    bool Visit(const AdminRegion& adminRegion,
+               const Location &location);
+  };
+
+  bool LocationCollectorVisitor::Visit(const AdminRegion& /*adminRegion*/,
+                                       const POI& /*poi*/)
+  {
+    return true;
+  }
+
+  bool LocationCollectorVisitor::Visit(const AdminRegion& /*adminRegion*/,
+                                       const Location &location)
+  {
+    locations.push_back(location);
+
+    return true;
+  }
+
+  class AddressCollectorVisitor : public AddressVisitor
+  {
+  public:
+    std::list<Address> addresses;
+
+  public:
+    bool Visit(const AdminRegion& adminRegion,
+               const Location &location,
+               const Address& address);
+  };
+
+  bool AddressCollectorVisitor::Visit(const AdminRegion& /*adminRegion*/,
+                                      const Location& /*location*/,
+                                      const Address& address)
+  {
+    addresses.push_back(address);
+
+    return true;
+  }
+
+  /**
+   * Returns true, if the segment from a to b intersects the given box. The box
+   * is enlarged by a small epsilon, so that segments touching the border of
+   * the box are added to all neighbouring boxes.
+   */
+  static bool SegmentIntersectsBox(const GeoCoord& a,
+                                   const GeoCoord& b,
+                                   double minLon,
+                                   double minLat,
+                                   double maxLon,
+                                   double maxLat)
+  {
+    const double epsilon=1e-9;
+    double       p[4];
+    double       q[4];
+    double       u1=0.0;
+    double       u2=1.0;
+    double       xDelta=b.GetLon()-a.GetLon();
+    double       yDelta=b.GetLat()-a.GetLat();
+
+    p[0]=-xDelta;
+    q[0]=a.GetLon()-(minLon-epsilon);
+    p[1]=xDelta;
+    q[1]=(maxLon+epsilon)-a.GetLon();
+    p[2]=-yDelta;
+    q[2]=a.GetLat()-(minLat-epsilon);
+    p[3]=yDelta;
+    q[3]=(maxLat+epsilon)-a.GetLat();
+
+    for (size_t i=0; i<4; i++) {
+      if (p[i]==0.0) {
+        if (q[i]<0.0) {
+          return false;
+        }
+      }
+      else {
+        double u=q[i]/p[i];
+
+        if (p[i]<0.0) {
+          u1=std::max(u1,u);
+        }
+        else {
+          u2=std::min(u2,u);
+        }
+      }
+    }
+
+    return u1<=u2;
+  }
+
+  std::string ReverseLocationIndexGenerator::GetDescription() const
+  {
+    return "Generate 'reverselocation.idx'";
+  }
+
+  /**
+   * Returns the index of the cell (of the given size) containing the value,
+   * the value is relative to the lower bound of the grid
+   */
+  uint32_t ReverseLocationIndexGenerator::GetCellIndex(double value,
+                                                       double size,
+                                                       uint32_t count)
+  {
+    if (value<=0.0) {
+      return 0;
+    }
+
+    return std::min((uint32_t)floor(value/size),
+                    count-1);
+  }
+
+  /**
+   * Adds all edges of the given way or ring to the cells of the given size
+   * they cross, as far as the cells are within the rows yStart to yEnd.
+   * Consecutive edges within a cell are merged into one run.
+   *
+   * The run ending with the closing edge of a ring is joined with the run
+   * starting with the first edge, so that edges sharing a node are always
+   * stored in the same run. Since the coordinates of a run are stored
+   * relative to each other, this makes sure that the shared node is read back
+   * with the same value for both edges.
+   */
+  void ReverseLocationIndexGenerator::AddRunsToCells(const std::vector<GeoCoord>& nodes,
+                                                     bool closed,
+                                                     double width,
+                                                     double height,
+                                                     uint32_t count,
+                                                     uint32_t yStart,
+                                                     uint32_t yEnd,
+                                                     std::map<Pixel,RunList>& runs)
+  {
+    std::map<Pixel,RunList> nodeRuns;
+    size_t                  edgeCount=nodes.size()-1;
+
+    if (closed &&
+        !(nodes.front()==nodes.back())) {
+      edgeCount++;
+    }
+
+    for (size_t e=0; e<edgeCount; e++) {
+      const GeoCoord& a=nodes[e];
+      const GeoCoord& b=nodes[(e+1)%nodes.size()];
+
+      uint32_t edgeYStart=GetCellIndex(std::min(a.GetLat(),b.GetLat())+90.0,height,count);
+      uint32_t edgeYEnd=GetCellIndex(std::max(a.GetLat(),b.GetLat())+90.0,height,count);
+
+      if (edgeYEnd<yStart ||
+          edgeYStart>yEnd) {
+        continue;
+      }
+
+      uint32_t edgeXStart=GetCellIndex(std::min(a.GetLon(),b.GetLon())+180.0,width,count);
+      uint32_t edgeXEnd=GetCellIndex(std::max(a.GetLon(),b.GetLon())+180.0,width,count);
+
+      for (uint32_t y=std::max(edgeYStart,yStart); y<=std::min(edgeYEnd,yEnd); y++) {
+        for (uint32_t x=edgeXStart; x<=edgeXEnd; x++) {
+          if (edgeXStart!=edgeXEnd || edgeYStart!=edgeYEnd) {
+            if (!SegmentIntersectsBox(a,
+                                      b,
+                                      x*width-180.0,
+                                      y*height-90.0,
+                                      (x+1)*width-180.0,
+                                      (y+1)*height-90.0)) {
+              continue;
+            }
+          }
+
+          RunList& cellRuns=nodeRuns[Pixel(x,y)];
+
+          if (!cellRuns.empty() &&
+              cellRuns.back().back()==a) {
+            cellRuns.back().push_back(b);
+          }
+          else {
+            cellRuns.push_back(std::vector<GeoCoord>());
+            cellRuns.back().reserve(2);
+            cellRuns.back().push_back(a);
+            cellRuns.back().push_back(b);
+          }
+        }
+      }
+    }
+
+    for (auto& cell : nodeRuns) {
+      RunList& cellRuns=cell.second;
+
+      if (closed &&
+          cellRuns.size()>1 &&
+          cellRuns.front().front()==nodes.front() &&
+          cellRuns.back().back()==nodes.front()) {
+        cellRuns.back().insert(cellRuns.back().end(),
+                               cellRuns.front().begin()+1,
+                               cellRuns.front().end());
+        cellRuns.pop_front();
+      }
+
+      RunList& targetRuns=runs[cell.first];
+
+      targetRuns.splice(targetRuns.end(),
+                        cellRuns);
+    }
+  }
+
+  /**
+   * Adds the given region to all cells of the band it covers or crosses.
+   *
+   * All rings of the region (outer rings and holes) together form the
+   * boundary, a coordinate is within the region, if a ray from it crosses
+   * the boundary an odd number of times. Whether the center of a cell is
+   * within the region is decided by a scan line through the centers of each
+   * row of cells, using the same crossing rule as IsCoordInArea(). Cells
+   * without boundary edges are completely covered by the region if their
+   * center is inside. They are stored as ranges.
+   */
+  void ReverseLocationIndexGenerator::AddRegionToCells(const RegionEntry& entry,
+                                                       const std::vector<std::vector<GeoCoord> >& rings,
+                                                       uint32_t bandStart,
+                                                       uint32_t bandEnd,
+                                                       CellMap& cells,
+                                                       CoveredRangeRows& coveredRanges)
+  {
+    std::map<Pixel,RunList> runs;
+    uint32_t                yStart=std::max(entry.cellYStart,bandStart);
+    uint32_t                yEnd=std::min(entry.cellYEnd,bandEnd);
+
+    for (const auto& ring : rings) {
+      AddRunsToCells(ring,
+                     true,
+                     cellWidth,
+                     cellHeight,
+                     cellCount,
+                     yStart,
+                     yEnd,
+                     runs);
+    }
+
+    for (uint32_t y=yStart; y<=yEnd; y++) {
+      double              centerLat=(y+0.5)*cellHeight-90.0;
+      std::vector<double> crossings;
+
+      for (const auto& ring : rings) {
+        for (size_t i=0, j=ring.size()-1; i<ring.size(); j=i++) {
+          if ((ring[i].GetLat()>centerLat)!=(ring[j].GetLat()>centerLat)) {
+            crossings.push_back((ring[j].GetLon()-ring[i].GetLon())*(centerLat-ring[i].GetLat())/
+                                (ring[j].GetLat()-ring[i].GetLat())+ring[i].GetLon());
+          }
+        }
+      }
+
+      std::sort(crossings.begin(),
+                crossings.end());
+
+      // Cells with boundary edges in this row
+      std::map<Pixel,RunList>::const_iterator rowBegin=runs.lower_bound(Pixel(0,y));
+      std::map<Pixel,RunList>::const_iterator rowEnd=runs.lower_bound(Pixel(0,y+1));
+
+      for (std::map<Pixel,RunList>::const_iterator cell=rowBegin;
+           cell!=rowEnd;
+           ++cell) {
+        double     centerLon=(cell->first.x+0.5)*cellWidth-180.0;
+        size_t     right=crossings.end()-std::upper_bound(crossings.begin(),
+                                                          crossings.end(),
+                                                          centerLon);
+        CellRegion cellRegion;
+        RegionPart part;
+
+        part.centerInside=right%2==1;
+        part.runs=cell->second;
+
+        cellRegion.regionIndex=entry.regionIndex;
+        cellRegion.regionOffset=entry.region->regionOffset;
+        cellRegion.parts.push_back(part);
+
+        cells[cell->first].regions.push_back(cellRegion);
+      }
+
+      // Cells without boundary edges between pairs of crossings
+      std::vector<CoveredRange>& rowRanges=coveredRanges[y-bandStart];
+
+      for (size_t c=0; c+1<crossings.size(); c+=2) {
+        uint32_t xStart=(uint32_t)std::max(ceil((crossings[c]+180.0)/cellWidth-0.5),0.0);
+        uint32_t xEnd=(uint32_t)std::max(ceil((crossings[c+1]+180.0)/cellWidth-0.5),0.0);
+
+        xEnd=std::min(xEnd,cellCount);
+
+        std::map<Pixel,RunList>::const_iterator cell=runs.lower_bound(Pixel(xStart,y));
+
+        while (xStart<xEnd) {
+          uint32_t rangeEnd=xEnd;
+
+          if (cell!=rowEnd &&
+              cell->first.x<xEnd) {
+            rangeEnd=cell->first.x;
+          }
+
+          if (xStart<rangeEnd) {
+            CoveredRange range;
+
+            range.xStart=xStart;
+            range.xEnd=rangeEnd;
+            range.regionIndex=entry.regionIndex;
+            range.regionOffset=entry.region->regionOffset;
+
+            rowRanges.push_back(range);
+          }
+
+          xStart=rangeEnd+1;
+
+          if (cell!=rowEnd) {
+            ++cell;
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * Reads all rings (outer rings and holes) of the area of the given region
+   */
+  bool ReverseLocationIndexGenerator::ReadRegionRings(const TypeConfig& typeConfig,
+                                                      Progress& progress,
+                                                      FileScanner& areaScanner,
+                                                      const AdminRegion& region,
+                                                      std::vector<std::vector<GeoCoord> >& rings)
+  {
+    Area area;
+
+    rings.clear();
+
+    if (!areaScanner.SetPos(region.object.GetFileOffset()) ||
+        !area.Read(typeConfig,
+                   areaScanner)) {
+      progress.Error(std::string("Error while reading area at offset ")+
+                     NumberToString(region.object.GetFileOffset())+
+                     " in file '"+
+                     areaScanner.GetFilename()+"'");
+      return false;
+    }
+
+    for (const auto& ring : area.rings) {
+      if (ring.ring!=Area::masterRingId &&
+          ring.nodes.size()>=3) {
+        rings.push_back(ring.nodes);
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Reads the nodes of the given way or the rings of the given area
+   */
+  bool ReverseLocationIndexGenerator::ReadObjectGeometry(const TypeConfig& typeConfig,
+                                                         Progress& progress,
+                                                         FileScanner& wayScanner,
+                                                         FileScanner& areaScanner,
+                                                         const ObjectFileRef& object,
+                                                         std::list<std::vector<GeoCoord> >& lines,
+                                                         bool& closed)
+  {
+    lines.clear();
+
+    if (object.GetType()==refWay) {
+      Way way;
+
+      if (!wayScanner.SetPos(object.GetFileOffset()) ||
+          !way.Read(typeConfig,
+                    wayScanner)) {
+        progress.Error(std::string("Error while reading way at offset ")+
+                       NumberToString(object.GetFileOffset())+
+                       " in file '"+
+                       wayScanner.GetFilename()+"'");
+        return false;
+      }
+
+      closed=false;
+
+      if (way.nodes.size()>=2) {
+        lines.push_back(way.nodes);
+      }
+    }
+    else if (object.GetType()==refArea) {
+      Area area;
+
+      if (!areaScanner.SetPos(object.GetFileOffset()) ||
+          !area.Read(typeConfig,
+                     areaScanner)) {
+        progress.Error(std::string("Error while reading area at offset ")+
+                       NumberToString(object.GetFileOffset())+
+                       " in file '"+
+                       areaScanner.GetFilename()+"'");
+        return false;
+      }
+
+      closed=true;
+
+      for (const auto& ring : area.rings) {
+        if (ring.nodes.size()>=2) {
+          lines.push_back(ring.nodes);
+        }
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Collects all regions with an area together with the rows of cells they
+   * cover. The geometry itself is loaded again for each band.
+   */
+  bool ReverseLocationIndexGenerator::CollectRegions(const TypeConfig& typeConfig,
+                                                     Progress& progress,
+                                                     FileScanner& areaScanner,
+                                                     const std::list<AdminRegionRef>& regions,
+                                                     std::vector<RegionEntry>& regionEntries)
+  {
+    size_t current=0;
+
+    for (const auto& region : regions) {
+      current++;
+      progress.SetProgress(current,regions.size());
+
+      if (region->object.GetType()!=refArea) {
+        continue;
+      }
+
+      std::vector<std::vector<GeoCoord> > rings;
+
+      if (!ReadRegionRings(typeConfig,
+                           progress,
+                           areaScanner,
+                           *region,
+                           rings)) {
+        return false;
+      }
+
+      if (rings.empty()) {
+        continue;
+      }
+
+      double minLat=rings.front().front().GetLat();
+      double maxLat=minLat;
+
+      for (const auto& ring : rings) {
+        for (const auto& node : ring) {
+          minLat=std::min(minLat,node.GetLat());
+          maxLat=std::max(maxLat,node.GetLat());
+        }
+      }
+
+      RegionEntry entry;
+
+      entry.region=region;
+      entry.regionIndex=current-1;
+      entry.cellYStart=GetCellIndex(minLat+90.0,cellHeight,cellCount);
+      entry.cellYEnd=GetCellIndex(maxLat+90.0,cellHeight,cellCount);
+
+      regionEntries.push_back(entry);
+    }
+
+    return true;
+  }
+
+  bool ReverseLocationIndexGenerator::CollectObjects(Progress& progress,
+                                                     const LocationIndex& locationIndex,
+                                                     const std::list<AdminRegionRef>& regions,
+                                                     std::vector<ObjectEntry>& locationObjects,
+                                                     std::vector<ObjectEntry>& addressObjects)
+  {
+    size_t current=0;
+
+    for (const auto& region : regions) {
+      LocationCollectorVisitor locationVisitor;
+
+      current++;
+      progress.SetProgress(current,regions.size());
+
+      if (!locationIndex.VisitAdminRegionLocations(*region,
+                                                   locationVisitor,
+                                                   false)) {
+        progress.Error("Error while loading locations of region '"+region->name+"'");
+        return false;
+      }
+
+      for (const auto& location : locationVisitor.locations) {
+        for (const auto& object : location.objects) {
+          ObjectEntry entry;
+
+          entry.object=object;
+          entry.regionOffset=region->regionOffset;
+          entry.locationOffset=location.locationOffset;
+          entry.addressOffset=0;
+          entry.cellYStart=0;
+          entry.cellYEnd=0;
+
+          locationObjects.push_back(entry);
+        }
+
+        if (location.addressesOffset==0) {
+          continue;
+        }
+
+        AddressCollectorVisitor addressVisitor;
+
+        if (!locationIndex.VisitLocationAddresses(*region,
+                                                  location,
+                                                  addressVisitor)) {
+          progress.Error("Error while loading addresses of location '"+location.name+"'");
+          return false;
+        }
+
+        for (const auto& address : addressVisitor.addresses) {
+          ObjectEntry entry;
+
+          entry.object=address.object;
+          entry.regionOffset=region->regionOffset;
+          entry.locationOffset=location.locationOffset;
+          entry.addressOffset=address.addressOffset;
+          entry.name=address.name;
+          entry.cellYStart=0;
+          entry.cellYEnd=0;
+
+          addressObjects.push_back(entry);
+        }
+      }
+    }
+
+    std::sort(locationObjects.begin(),
+              locationObjects.end());
+    std::sort(addressObjects.begin(),
+              addressObjects.end());
+
+    return true;
+  }
+
+  /**
+   * Sets the rows of cells touched by each location object. Objects without
+   * geometry are removed.
+   */
+  bool ReverseLocationIndexGenerator::LocateLocations(const TypeConfig& typeConfig,
+                                                      Progress& progress,
+                                                      FileScanner& wayScanner,
+                                                      FileScanner& areaScanner,
+                                                      std::vector<ObjectEntry>& locationObjects)
+  {
+    size_t objectCount=0;
+
+    for (size_t i=0; i<locationObjects.size(); i++) {
+      ObjectEntry&                      entry=locationObjects[i];
+      std::list<std::vector<GeoCoord> > lines;
+      bool                              closed;
+
+      progress.SetProgress(i,locationObjects.size());
+
+      if (!ReadObjectGeometry(typeConfig,
+                              progress,
+                              wayScanner,
+                              areaScanner,
+                              entry.object,
+                              lines,
+                              closed)) {
+        return false;
+      }
+
+      if (lines.empty()) {
+        continue;
+      }
+
+      double minLat=lines.front().front().GetLat();
+      double maxLat=minLat;
+
+      for (const auto& line : lines) {
+        for (const auto& node : line) {
+          minLat=std::min(minLat,node.GetLat());
+          maxLat=std::max(maxLat,node.GetLat());
+        }
+      }
+
+      entry.cellYStart=GetCellIndex(minLat+90.0,cellHeight,cellCount);
+      entry.cellYEnd=GetCellIndex(maxLat+90.0,cellHeight,cellCount);
+
+      locationObjects[objectCount]=entry;
+      objectCount++;
+    }
+
+    locationObjects.resize(objectCount);
+
+    return true;
+  }
+
+  /**
+   * Sets the coordinate and the row of cells of each address. Addresses
+   * without coordinate are removed.
+   */
+  bool ReverseLocationIndexGenerator::LocateAddresses(const TypeConfig& typeConfig,
+                                                      Progress& progress,
+                                                      FileScanner& nodeScanner,
+                                                      FileScanner& wayScanner,
+                                                      FileScanner& areaScanner,
+                                                      std::vector<ObjectEntry>& addressObjects)
+  {
+    size_t objectCount=0;
+
+    for (size_t i=0; i<addressObjects.size(); i++) {
+      ObjectEntry& entry=addressObjects[i];
+      bool         hasCoord=false;
+
+      progress.SetProgress(i,addressObjects.size());
+
+      if (entry.object.GetType()==refNode) {
+        Node node;
+
+        if (!nodeScanner.SetPos(entry.object.GetFileOffset()) ||
+            !node.Read(typeConfig,
+                       nodeScanner)) {
+          progress.Error(std::string("Error while reading node at offset ")+
+                         NumberToString(entry.object.GetFileOffset())+
+                         " in file '"+
+                         nodeScanner.GetFilename()+"'");
+          return false;
+        }
+
+        entry.coord=node.GetCoords();
+        hasCoord=true;
+      }
+      else if (entry.object.GetType()==refWay) {
+        Way way;
+
+        if (!wayScanner.SetPos(entry.object.GetFileOffset()) ||
+            !way.Read(typeConfig,
+                      wayScanner)) {
+          progress.Error(std::string("Error while reading way at offset ")+
+                         NumberToString(entry.object.GetFileOffset())+
+                         " in file '"+
+                         wayScanner.GetFilename()+"'");
+          return false;
+        }
+
+        hasCoord=way.GetCenter(entry.coord);
+      }
+      else if (entry.object.GetType()==refArea) {
+        Area area;
+
+        if (!areaScanner.SetPos(entry.object.GetFileOffset()) ||
+            !area.Read(typeConfig,
+                       areaScanner)) {
+          progress.Error(std::string("Error while reading area at offset ")+
+                         NumberToString(entry.object.GetFileOffset())+
+                         " in file '"+
+                         areaScanner.GetFilename()+"'");
+          return false;
+        }
+
+        hasCoord=area.GetCenter(entry.coord);
+      }
+
+      if (!hasCoord) {
+        continue;
+      }
+
+      entry.cellYStart=GetCellIndex(entry.coord.GetLat()+90.0,cellHeight,cellCount);
+      entry.cellYEnd=entry.cellYStart;
+
+      addressObjects[objectCount]=entry;
+      objectCount++;
+    }
+
+    addressObjects.resize(objectCount);
+
+    return true;
+  }
+
+  bool ReverseLocationIndexGenerator::IndexRegions(const TypeConfig& typeConfig,
+                                                   Progress& progress,
+                                                   FileScanner& areaScanner,
+                                                   const std::vector<RegionEntry>& regionEntries,
+                                                   uint32_t bandStart,
+                                                   uint32_t bandEnd,
+                                                   CellMap& cells,
+                                                   CoveredRangeRows& coveredRanges)
+  {
+    for (const auto& entry : regionEntries) {
+      if (entry.cellYEnd<bandStart ||
+          entry.cellYStart>bandEnd) {
+        continue;
+      }
+
+      std::vector<std::vector<GeoCoord> > rings;
+
+      if (!ReadRegionRings(typeConfig,
+                           progress,
+                           areaScanner,
+                           *entry.region,
+                           rings)) {
+        return false;
+      }
+
+      AddRegionToCells(entry,
+                       rings,
+                       bandStart,
+                       bandEnd,
+                       cells,
+                       coveredRanges);
+    }
+
+    return true;
+  }
+
+  bool ReverseLocationIndexGenerator::IndexLocations(const TypeConfig& typeConfig,
+                                                     Progress& progress,
+                                                     FileScanner& wayScanner,
+                                                     FileScanner& areaScanner,
+                                                     const std::vector<ObjectEntry>& locationObjects,
+                                                     uint32_t bandStart,
+                                                     uint32_t bandEnd,
+                                                     CellMap& cells)
+  {
+    double   subCellWidth=cellWidth/ReverseLocationIndex::SUB_CELL_DIMENSION;
+    double   subCellHeight=cellHeight/ReverseLocationIndex::SUB_CELL_DIMENSION;
+    uint32_t subCellCount=cellCount*ReverseLocationIndex::SUB_CELL_DIMENSION;
+
+    for (const auto& entry : locationObjects) {
+      if (entry.cellYEnd<bandStart ||
+          entry.cellYStart>bandEnd) {
+        continue;
+      }
+
+      std::list<std::vector<GeoCoord> > lines;
+      bool                              closed;
+      std::map<Pixel,RunList>           runs;
+
+      if (!ReadObjectGeometry(typeConfig,
+                              progress,
+                              wayScanner,
+                              areaScanner,
+                              entry.object,
+                              lines,
+                              closed)) {
+        return false;
+      }
+
+      for (const auto& line : lines) {
+        AddRunsToCells(line,
+                       closed,
+                       subCellWidth,
+                       subCellHeight,
+                       subCellCount,
+                       bandStart*ReverseLocationIndex::SUB_CELL_DIMENSION,
+                       (bandEnd+1)*ReverseLocationIndex::SUB_CELL_DIMENSION-1,
+                       runs);
+      }
+
+      for (const auto& subCell : runs) {
+        Pixel        cell(subCell.first.x/ReverseLocationIndex::SUB_CELL_DIMENSION,
+                          subCell.first.y/ReverseLocationIndex::SUB_CELL_DIMENSION);
+        uint32_t     subCellId=(subCell.first.y%ReverseLocationIndex::SUB_CELL_DIMENSION)*ReverseLocationIndex::SUB_CELL_DIMENSION+
+                               subCell.first.x%ReverseLocationIndex::SUB_CELL_DIMENSION;
+        CellLocation location;
+
+        location.regionOffset=entry.regionOffset;
+        location.locationOffset=entry.locationOffset;
+        location.object=entry.object;
+        location.runs=subCell.second;
+
+        cells[cell].subCells[subCellId].locations.push_back(location);
+      }
+    }
+
+    return true;
+  }
+
+  void ReverseLocationIndexGenerator::IndexAddresses(const std::vector<ObjectEntry>& addressObjects,
+                                                     uint32_t bandStart,
+                                                     uint32_t bandEnd,
+                                                     CellMap& cells)
+  {
+    double   subCellWidth=cellWidth/ReverseLocationIndex::SUB_CELL_DIMENSION;
+    double   subCellHeight=cellHeight/ReverseLocationIndex::SUB_CELL_DIMENSION;
+    uint32_t subCellCount=cellCount*ReverseLocationIndex::SUB_CELL_DIMENSION;
+
+    for (const auto& entry : addressObjects) {
+      if (entry.cellYStart<bandStart ||
+          entry.cellYStart>bandEnd) {
+        continue;
+      }
+
+      uint32_t    subX=GetCellIndex(entry.coord.GetLon()+180.0,subCellWidth,subCellCount);
+      uint32_t    subY=GetCellIndex(entry.coord.GetLat()+90.0,subCellHeight,subCellCount);
+      Pixel       cell(subX/ReverseLocationIndex::SUB_CELL_DIMENSION,
+                       subY/ReverseLocationIndex::SUB_CELL_DIMENSION);
+      uint32_t    subCellId=(subY%ReverseLocationIndex::SUB_CELL_DIMENSION)*ReverseLocationIndex::SUB_CELL_DIMENSION+
+                            subX%ReverseLocationIndex::SUB_CELL_DIMENSION;
+      CellAddress address;
+
+      address.coord=entry.coord;
+      address.regionOffset=entry.regionOffset;
+      address.locationOffset=entry.locationOffset;
+      address.addressOffset=entry.addressOffset;
+      address.name=entry.name;
+      address.object=entry.object;
+
+      cells[cell].subCells[subCellId].addresses.push_back(address);
+    }
+  }
+
+  bool ReverseLocationIndexGenerator::WriteCell(FileWriter& writer,
+                                                const std::vector<CellRegion>& regions,
+                                                const std::map<uint32_t,SubCell>& subCells)
+  {
+    const uint32_t subCellCount=ReverseLocationIndex::SUB_CELL_DIMENSION*ReverseLocationIndex::SUB_CELL_DIMENSION;
+    FileOffset     subCellTableOffset=0;
+    FileOffset     subCellOffsets[2*subCellCount];
+
+    writer.Write(!subCells.empty());
+
+    if (!subCells.empty()) {
+      writer.GetPos(subCellTableOffset);
+
+      for (size_t i=0; i<2*subCellCount; i++) {
+        subCellOffsets[i]=0;
+        writer.WriteFileOffset(0);
+      }
+    }
+
+    writer.WriteNumber((uint32_t)regions.size());
+
+    for (const auto& region : regions) {
+      writer.WriteFileOffset(region.regionOffset,
+                             bytesForLocationFileOffset);
+      writer.WriteNumber((uint32_t)region.parts.size());
+
+      for (const auto& part : region.parts) {
+        writer.Write(part.centerInside);
+        writer.WriteNumber((uint32_t)part.runs.size());
+
+        for (const auto& run : part.runs) {
+          writer.Write(run);
+        }
+      }
+    }
+
+    if (subCells.empty()) {
+      return !writer.HasError();
+    }
+
+    for (const auto& subCell : subCells) {
+      if (!subCell.second.addresses.empty()) {
+        writer.GetPos(subCellOffsets[subCell.first]);
+
+        writer.WriteNumber((uint32_t)subCell.second.addresses.size());
+
+        for (const auto& address : subCell.second.addresses) {
+          writer.WriteCoord(address.coord);
+          writer.WriteFileOffset(address.regionOffset,
+                                 bytesForLocationFileOffset);
+          writer.WriteFileOffset(address.locationOffset,
+                                 bytesForLocationFileOffset);
+          writer.WriteFileOffset(address.addressOffset,
+                                 bytesForLocationFileOffset);
+          writer.Write(address.name);
+          writer.Write(address.object);
+        }
+      }
+
+      if (!subCell.second.locations.empty()) {
+        writer.GetPos(subCellOffsets[subCellCount+subCell.first]);
+
+        writer.WriteNumber((uint32_t)subCell.second.locations.size());
+
+        for (const auto& location : subCell.second.locations) {
+          writer.WriteFileOffset(location.regionOffset,
+                                 bytesForLocationFileOffset);
+          writer.WriteFileOffset(location.locationOffset,
+                                 bytesForLocationFileOffset);
+          writer.Write(location.object);
+          writer.WriteNumber((uint32_t)location.runs.size());
+
+          for (const auto& run : location.runs) {
+            writer.Write(run);
+          }
+        }
+      }
+    }
+
+    FileOffset endOffset;
+
+    writer.GetPos(endOffset);
+    writer.SetPos(subCellTableOffset);
+
+    for (size_t i=0; i<2*subCellCount; i++) {
+      writer.WriteFileOffset(subCellOffsets[i]);
+    }
+
+    writer.SetPos(endOffset);
+
+    return !writer.HasError();
+  }
+
+  /**
+   * Writes the cells of one row and collects the directory of the row.
+   *
+   * The row is split at the start and end of all covered ranges and around
+   * the cells with data. Every cell with data is written on its own, together
+   * with the regions covering it completely. For the cells in between only
+   * the list of covering regions is written, once for each distinct list.
+   */
+  bool ReverseLocationIndexGenerator::WriteRow(FileWriter& writer,
+                                               CellMap::const_iterator cellsBegin,
+                                               CellMap::const_iterator cellsEnd,
+                                               const std::vector<CoveredRange>& coveredRanges,
+                                               CoveredCellMap& coveredCells,
+                                               std::vector<RowRun>& runs)
+  {
+    std::vector<uint32_t>     breaks;
+    std::vector<CoveredRange> ranges(coveredRanges);
+
+    runs.clear();
+
+    for (const auto& range : coveredRanges) {
+      breaks.push_back(range.xStart);
+      breaks.push_back(range.xEnd);
+    }
+
+    for (CellMap::const_iterator cell=cellsBegin; cell!=cellsEnd; ++cell) {
+      breaks.push_back(cell->first.x);
+      breaks.push_back(cell->first.x+1);
+    }
+
+    std::sort(breaks.begin(),
+              breaks.end());
+    breaks.erase(std::unique(breaks.begin(),
+                             breaks.end()),
+                 breaks.end());
+
+    std::sort(ranges.begin(),
+              ranges.end());
+
+    std::map<size_t,const CoveredRange*> activeRanges;
+    size_t                               nextRange=0;
+    CellMap::const_iterator              cell=cellsBegin;
+    FileOffset                           lastOffset=0;
+
+    for (const auto x : breaks) {
+      std::map<size_t,const CoveredRange*>::iterator active=activeRanges.begin();
+
+      while (active!=activeRanges.end()) {
+        if (active->second->xEnd<=x) {
+          activeRanges.erase(active++);
+        }
+        else {
+          ++active;
+        }
+      }
+
+      while (nextRange<ranges.size() &&
+             ranges[nextRange].xStart<=x) {
+        activeRanges[ranges[nextRange].regionIndex]=&ranges[nextRange];
+        nextRange++;
+      }
+
+      FileOffset offset=0;
+
+      if (cell!=cellsEnd &&
+          cell->first.x==x) {
+        std::vector<CellRegion> regions;
+
+        for (const auto& range : activeRanges) {
+          CellRegion region;
+
+          region.regionIndex=range.first;
+          region.regionOffset=range.second->regionOffset;
+
+          regions.push_back(region);
+        }
+
+        for (const auto& region : cell->second.regions) {
+          regions.push_back(region);
+        }
+
+        std::stable_sort(regions.begin(),
+                         regions.end());
+
+        writer.GetPos(offset);
+
+        if (!WriteCell(writer,
+                       regions,
+                       cell->second.subCells)) {
+          return false;
+        }
+
+        ++cell;
+      }
+      else if (!activeRanges.empty()) {
+        std::vector<FileOffset> regionOffsets;
+
+        for (const auto& range : activeRanges) {
+          regionOffsets.push_back(range.second->regionOffset);
+        }
+
+        CoveredCellMap::const_iterator coveredCell=coveredCells.find(regionOffsets);
+
+        if (coveredCell!=coveredCells.end()) {
+          offset=coveredCell->second;
+        }
+        else {
+          std::vector<CellRegion>    regions;
+          std::map<uint32_t,SubCell> subCells;
+
+          for (const auto& range : activeRanges) {
+            CellRegion region;
+
+            region.regionIndex=range.first;
+            region.regionOffset=range.second->regionOffset;
+
+            regions.push_back(region);
+          }
+
+          writer.GetPos(offset);
+
+          if (!WriteCell(writer,
+                         regions,
+                         subCells)) {
+            return false;
+          }
+
+          coveredCells.insert(std::make_pair(regionOffsets,
+                                             offset));
+        }
+      }
+
+      if (offset!=lastOffset) {
+        RowRun run;
+
+        run.xStart=x;
+        run.offset=offset;
+
+        runs.push_back(run);
+
+        lastOffset=offset;
+      }
+    }
+
+    return !writer.HasError();
+  }
+
+  /**
+   * Writes all cells of the given band of rows followed by the directories
+   * of its rows
+   */
+  bool ReverseLocationIndexGenerator::WriteBand(FileWriter& writer,
+                                                uint32_t bandStart,
+                                                uint32_t bandEnd,
+                                                uint32_t cellYStart,
+                                                const CellMap& cells,
+                                                const CoveredRangeRows& coveredRanges,
+                                                CoveredCellMap& coveredCells,
+                                                std::vector<FileOffset>& rowOffsets,
+                                                size_t& rowRunCount)
+  {
+    std::vector<std::vector<RowRun> > rowRuns(bandEnd-bandStart+1);
+
+    for (uint32_t y=bandStart; y<=bandEnd; y++) {
+      if (!WriteRow(writer,
+                    cells.lower_bound(Pixel(0,y)),
+                    cells.lower_bound(Pixel(0,y+1)),
+                    coveredRanges[y-bandStart],
+                    coveredCells,
+                    rowRuns[y-bandStart])) {
+        return false;
+      }
+    }
+
+    for (uint32_t y=bandStart; y<=bandEnd; y++) {
+      const std::vector<RowRun>& runs=rowRuns[y-bandStart];
+
+      if (runs.empty()) {
+        continue;
+      }
+
+      writer.GetPos(rowOffsets[y-cellYStart]);
+
+      writer.Write((uint32_t)runs.size());
+
+      for (const auto& run : runs) {
+        writer.Write(run.xStart);
+        writer.WriteFileOffset(run.offset);
+      }
+
+      rowRunCount+=runs.size();
+    }
+
+    return !writer.HasError();
+  }
+
+  /**
+   * Writes the index band by band. For each band the regions, locations and
+   * addresses touching the band are loaded and added to the cells of the
+   * band. The row directory is written at the end.
+   */
+  bool ReverseLocationIndexGenerator::WriteIndex(const TypeConfig& typeConfig,
+                                                 Progress& progress,
+                                                 FileWriter& writer,
+                                                 FileScanner& wayScanner,
+                                                 FileScanner& areaScanner,
+                                                 const std::vector<RegionEntry>& regionEntries,
+                                                 const std::vector<ObjectEntry>& locationObjects,
+                                                 const std::vector<ObjectEntry>& addressObjects)
+  {
+    uint32_t cellYStart=cellCount;
+    uint32_t cellYEnd=0;
+
+    for (const auto& entry : regionEntries) {
+      cellYStart=std::min(cellYStart,entry.cellYStart);
+      cellYEnd=std::max(cellYEnd,entry.cellYEnd);
+    }
+
+    for (const auto& entry : locationObjects) {
+      cellYStart=std::min(cellYStart,entry.cellYStart);
+      cellYEnd=std::max(cellYEnd,entry.cellYEnd);
+    }
+
+    for (const auto& entry : addressObjects) {
+      cellYStart=std::min(cellYStart,entry.cellYStart);
+      cellYEnd=std::max(cellYEnd,entry.cellYEnd);
+    }
+
+    if (cellYStart>cellYEnd) {
+      cellYStart=1;
+      cellYEnd=0;
+    }
+
+    std::vector<FileOffset> rowOffsets(cellYEnd+1-cellYStart,0);
+    CoveredCellMap          coveredCells;
+    FileOffset              rowTableOffsetPos;
+    FileOffset              rowTableOffset;
+    size_t                  dataCellCount=0;
+    size_t                  rowRunCount=0;
+
+    writer.Write(bytesForLocationFileOffset);
+    writer.WriteNumber(CELL_LEVEL);
+    writer.WriteNumber(cellYStart);
+    writer.WriteNumber(cellYEnd);
+
+    writer.GetPos(rowTableOffsetPos);
+    writer.WriteFileOffset(0);
+
+    for (uint32_t bandStart=cellYStart; bandStart<=cellYEnd; bandStart+=CELL_BAND_HEIGHT) {
+      uint32_t         bandEnd=std::min(bandStart+CELL_BAND_HEIGHT-1,cellYEnd);
+      CellMap          cells;
+      CoveredRangeRows coveredRanges(bandEnd-bandStart+1);
+
+      progress.SetProgress(bandStart-cellYStart,cellYEnd+1-cellYStart);
+
+      if (!IndexRegions(typeConfig,
+                        progress,
+                        areaScanner,
+                        regionEntries,
+                        bandStart,
+                        bandEnd,
+                        cells,
+                        coveredRanges)) {
+        return false;
+      }
+
+      if (!IndexLocations(typeConfig,
+                          progress,
+                          wayScanner,
+                          areaScanner,
+                          locationObjects,
+                          bandStart,
+                          bandEnd,
+                          cells)) {
+        return false;
+      }
+
+      IndexAddresses(addressObjects,
+                     bandStart,
+                     bandEnd,
+                     cells);
+
+      dataCellCount+=cells.size();
+
+      if (!WriteBand(writer,
+                     bandStart,
+                     bandEnd,
+                     cellYStart,
+                     cells,
+                     coveredRanges,
+                     coveredCells,
+                     rowOffsets,
+                     rowRunCount)) {
+        progress.Error(std::string("Error while writing file '")+
+                       writer.GetFilename()+"'");
+        return false;
+      }
+    }
+
+    writer.GetPos(rowTableOffset);
+
+    for (const auto& rowOffset : rowOffsets) {
+      writer.WriteFileOffset(rowOffset);
+    }
+
+    writer.SetPos(rowTableOffsetPos);
+    writer.WriteFileOffset(rowTableOffset);
+
+    progress.Info(NumberToString(dataCellCount)+" cells with data, "+
+                  NumberToString(coveredCells.size())+" distinct covered cells, "+
+                  NumberToString(rowRunCount)+" directory entries in "+
+                  NumberToString(rowOffsets.size())+" rows");
+
+    return !writer.HasError();
+  }
+
+  void ReverseLocationIndexGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                           ImportModuleDescription& description) const
+  {
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                LocationIndex::FILENAME_LOCATION_IDX));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "nodes.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "ways.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areas.dat"));
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                ReverseLocationIndex::FILENAME_REVERSE_LOCATION_IDX));
+  }
+
+  bool ReverseLocationIndexGenerator::Import(const TypeConfigRef& typeConfig,
+                                             const ImportParameter& parameter,
+                                             Progress& progress)
+  {
+    LocationIndex             locationIndex;
+    RegionCollectorVisitor    regionVisitor;
+    std::vector<RegionEntry>  regionEntries;
+    std::vector<ObjectEntry>  locationObjects;
+    std::vector<ObjectEntry>  addressObjects;
+    FileScanner               nodeScanner;
+    FileScanner               wayScanner;
+    FileScanner               areaScanner;
+    FileWriter                writer;
+
+    cellCount=(uint32_t)1 << CELL_LEVEL;
+    cellWidth=360.0/cellCount;
+    cellHeight=180.0/cellCount;
+
+    progress.SetAction("Setup");
+
+    if (!BytesNeededToAddressFileData(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                      LocationIndex::FILENAME_LOCATION_IDX),
+                                      bytesForLocationFileOffset)) {
+      progress.Error(std::string("Cannot get file size of '")+LocationIndex::FILENAME_LOCATION_IDX+"'");
+      return false;
+    }
+
+    if (!locationIndex.Load(parameter.GetDestinationDirectory())) {
+      progress.Error(std::string("Cannot load '")+LocationIndex::FILENAME_LOCATION_IDX+"'");
+      return false;
+    }
+
+    if (!nodeScanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "nodes.dat"),
+                          FileScanner::LowMemRandom,
+                          parameter.GetWayDataMemoryMaped())) {
+      progress.Error("Cannot open 'nodes.dat'");
+      return false;
+    }
+
+    if (!wayScanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                         "ways.dat"),
+                         FileScanner::LowMemRandom,
+                         parameter.GetWayDataMemoryMaped())) {
+      progress.Error("Cannot open 'ways.dat'");
+      return false;
+    }
+
+    if (!areaScanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                          "areas.dat"),
+                          FileScanner::LowMemRandom,
+                          parameter.GetAreaDataMemoryMaped())) {
+      progress.Error("Cannot open 'areas.dat'");
+      return false;
+    }
+
+    progress.SetAction("Loading admin regions");
+
+    if (!locationIndex.VisitAdminRegions(regionVisitor)) {
+      progress.Error("Error while loading admin regions");
+      return false;
+    }
+
+    progress.Info(NumberToString(regionVisitor.regions.size())+" admin regions");
+
+    progress.SetAction("Locating admin region boundaries");
+
+    if (!CollectRegions(*typeConfig,
+                        progress,
+                        areaScanner,
+                        regionVisitor.regions,
+                        regionEntries)) {
+      return false;
+    }
+
+    progress.SetAction("Loading locations and addresses");
+
+    if (!CollectObjects(progress,
+                        locationIndex,
+                        regionVisitor.regions,
+                        locationObjects,
+                        addressObjects)) {
+      return false;
+    }
+
+    progress.Info(NumberToString(locationObjects.size())+" location objects, "+
+                  NumberToString(addressObjects.size())+" addresses");
+
+    progress.SetAction("Locating locations");
+
+    if (!LocateLocations(*typeConfig,
+                         progress,
+                         wayScanner,
+                         areaScanner,
+                         locationObjects)) {
+      return false;
+    }
+
+    progress.SetAction("Locating addresses");
+
+    if (!LocateAddresses(*typeConfig,
+                         progress,
+                         nodeScanner,
+                         wayScanner,
+                         areaScanner,
+                         addressObjects)) {
+      return false;
+    }
+
+    progress.SetAction(std::string("Writing '")+ReverseLocationIndex::FILENAME_REVERSE_LOCATION_IDX+"'");
+
+    if (!writer.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                     ReverseLocationIndex::FILENAME_REVERSE_LOCATION_IDX))) {
+      progress.Error(std::string("Cannot open '")+writer.GetFilename()+"'");
+      return false;
+    }
+
+    if (!WriteIndex(*typeConfig,
+                    progress,
+                    writer,
+                    wayScanner,
+                    areaScanner,
+                    regionEntries,
+                    locationObjects,
+                    addressObjects)) {
+      writer.Close();
+      return false;
+    }
+
+    if (!nodeScanner.Close() ||
+        !wayScanner.Close() ||
+        !areaScanner.Close()) {
+      progress.Error("Cannot close data files");
+      writer.Close();
+      return false;
+    }
+
+    return writer.Close();
+  }
+}
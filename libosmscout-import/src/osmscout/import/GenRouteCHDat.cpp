@@ -0,0 +1,672 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/GenRouteCHDat.h>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <map>
+#include <queue>
+
+#include <osmscout/RouteNode.h>
+#include <osmscout/RoutingService.h>
+
+#include <osmscout/system/Math.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+#include <osmscout/util/IndexedHeap.h>
+#include <osmscout/util/Logger.h>
+#include <osmscout/util/String.h>
+
+namespace osmscout {
+
+  //! Maximum number of nodes settled during one witness search
+  static const size_t maxWitnessSettledNodes=500;
+
+  std::string RouteCHDataGenerator::GetDescription() const
+  {
+    return "Generate contraction hierarchy for car routing";
+  }
+
+  void RouteCHDataGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                  ImportModuleDescription& description) const
+  {
+    if (!parameter.GetRouteContractionHierarchy()) {
+      return;
+    }
+
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                RoutingService::FILENAME_CAR_DAT));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                RoutingService::FILENAME_CAR_VARIANT_DAT));
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                RoutingService::FILENAME_CAR_CH_DAT));
+  }
+
+  bool RouteCHDataGenerator::LoadObjectVariantData(const TypeConfig& typeConfig,
+                                                   const ImportParameter& parameter,
+                                                   std::vector<ObjectVariantData>& objectVariantData) const
+  {
+    FileScanner scanner;
+    uint32_t    objectVariantDataCount;
+
+    if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                      RoutingService::FILENAME_CAR_VARIANT_DAT),
+                      FileScanner::Sequential,
+                      true)) {
+      log.Error() << "Cannot open '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    if (!scanner.Read(objectVariantDataCount)) {
+      return false;
+    }
+
+    objectVariantData.resize(objectVariantDataCount);
+
+    for (size_t i=0; i<objectVariantDataCount; i++) {
+      if (!objectVariantData[i].Read(typeConfig,
+                                     scanner)) {
+        log.Error() << "Cannot read data entry " << i+1 << " from file '" << scanner.GetFilename() << "'";
+        return false;
+      }
+    }
+
+    return scanner.Close();
+  }
+
+  /**
+   * Load the route nodes of the car routing graph and convert all paths that
+   * can be used (and that we have access to) to edges.
+   */
+  bool RouteCHDataGenerator::LoadRouteGraph(const TypeConfig& typeConfig,
+                                            const ImportParameter& parameter,
+                                            Progress& progress,
+                                            const RoutingProfile& profile,
+                                            const std::vector<ObjectVariantData>& objectVariantData,
+                                            Graph& graph) const
+  {
+    FileScanner                             scanner;
+    uint32_t                                routeNodeCount;
+    std::unordered_map<FileOffset,uint32_t> nodeIndexes;
+
+    if (!scanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                      RoutingService::FILENAME_CAR_DAT),
+                      FileScanner::Sequential,
+                      true)) {
+      progress.Error("Cannot open '"+scanner.GetFilename()+"'");
+      return false;
+    }
+
+    if (!scanner.Read(routeNodeCount)) {
+      progress.Error("Error while reading number of data entries in file '"+scanner.GetFilename()+"'");
+      return false;
+    }
+
+    // First pass: Assign an index to every route node
+
+    graph.nodes.resize(routeNodeCount);
+    nodeIndexes.reserve(routeNodeCount);
+
+    for (uint32_t n=0; n<routeNodeCount; n++) {
+      RouteNode routeNode;
+
+      progress.SetProgress(n,2*routeNodeCount);
+
+      if (!routeNode.Read(typeConfig,
+                          scanner)) {
+        progress.Error(std::string("Error while reading data entry ")+
+                       NumberToString(n)+" of "+
+                       NumberToString(routeNodeCount)+
+                       " in file '"+
+                       scanner.GetFilename()+"'");
+        return false;
+      }
+
+      Node& node=graph.nodes[n];
+
+      node.routeNodeOffset=routeNode.GetFileOffset();
+      node.rank=0;
+      node.contractedNeighbours=0;
+      node.contracted=false;
+
+      nodeIndexes[routeNode.GetFileOffset()]=n;
+    }
+
+    // Second pass: Create edges and excludes
+
+    if (!scanner.GotoBegin() ||
+        !scanner.Read(routeNodeCount)) {
+      progress.Error("Cannot rewind file '"+scanner.GetFilename()+"'");
+      return false;
+    }
+
+    for (uint32_t n=0; n<routeNodeCount; n++) {
+      RouteNode routeNode;
+
+      progress.SetProgress(routeNodeCount+n,2*routeNodeCount);
+
+      if (!routeNode.Read(typeConfig,
+                          scanner)) {
+        progress.Error(std::string("Error while reading data entry ")+
+                       NumberToString(n)+" of "+
+                       NumberToString(routeNodeCount)+
+                       " in file '"+
+                       scanner.GetFilename()+"'");
+        return false;
+      }
+
+      for (size_t i=0; i<routeNode.paths.size(); i++) {
+        const RouteNode::Path& path=routeNode.paths[i];
+        auto                   target=nodeIndexes.find(path.offset);
+
+        if (target==nodeIndexes.end() ||
+            target->second==n ||
+            !path.HasAccess() ||
+            !profile.CanUse(routeNode,objectVariantData,i)) {
+          continue;
+        }
+
+        double costs=profile.GetCosts(routeNode,objectVariantData,i);
+        Edge   edge;
+
+        edge.source=n;
+        edge.target=target->second;
+        edge.weight=(uint32_t)std::min(floor(costs*CHEdge::costFactor+0.5),
+                                       (double)std::numeric_limits<uint32_t>::max());
+        edge.middle=CHEdge::noMiddle;
+        edge.firstNode=target->second;
+        edge.firstObject=routeNode.objects[path.objectIndex].object;
+        edge.lastObject=edge.firstObject;
+
+        graph.nodes[edge.source].outEdges.push_back(graph.edges.size());
+        graph.nodes[edge.target].inEdges.push_back(graph.edges.size());
+        graph.edges.push_back(edge);
+      }
+
+      for (const auto& exclude : routeNode.excludes) {
+        if (exclude.targetIndex>=routeNode.paths.size()) {
+          continue;
+        }
+
+        const RouteNode::Path& path=routeNode.paths[exclude.targetIndex];
+        auto                   target=nodeIndexes.find(path.offset);
+
+        if (target==nodeIndexes.end()) {
+          continue;
+        }
+
+        CHExclude chExclude;
+
+        chExclude.source=exclude.source;
+        chExclude.targetObject=routeNode.objects[path.objectIndex].object;
+        chExclude.targetNode=target->second;
+
+        graph.nodes[n].excludes.push_back(chExclude);
+      }
+    }
+
+    return scanner.Close();
+  }
+
+  bool RouteCHDataGenerator::IsTurnForbidden(const Node& node,
+                                             const Edge& incoming,
+                                             const Edge& outgoing) const
+  {
+    for (const auto& exclude : node.excludes) {
+      if (exclude.source==incoming.lastObject &&
+          exclude.targetObject==outgoing.firstObject &&
+          exclude.targetNode==outgoing.firstNode) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * Local Dijkstra search from the source node over not yet contracted nodes,
+   * ignoring the given node. The search stops if the maximum weight is reached
+   * or after a fixed number of settled nodes. Nodes with turn restrictions are
+   * not expanded, since the search cannot evaluate them.
+   */
+  void RouteCHDataGenerator::WitnessSearch(const Graph& graph,
+                                           uint32_t source,
+                                           uint32_t ignoredNode,
+                                           uint32_t maxWeight,
+                                           std::unordered_map<uint32_t,uint32_t>& weights) const
+  {
+    typedef std::pair<uint32_t,uint32_t> QueueEntry; // weight, node index
+
+    std::priority_queue<QueueEntry,std::vector<QueueEntry>,std::greater<QueueEntry> > queue;
+    size_t                                                                          settledCount=0;
+
+    weights.clear();
+    weights[source]=0;
+    queue.push(QueueEntry(0,source));
+
+    while (!queue.empty()) {
+      QueueEntry current=queue.top();
+
+      queue.pop();
+
+      if (current.first>weights[current.second]) {
+        // Outdated entry
+        continue;
+      }
+
+      if (current.first>maxWeight ||
+          settledCount>=maxWitnessSettledNodes) {
+        break;
+      }
+
+      settledCount++;
+
+      if (current.second!=source &&
+          !graph.nodes[current.second].excludes.empty()) {
+        continue;
+      }
+
+      for (size_t edgeIndex : graph.nodes[current.second].outEdges) {
+        const Edge& edge=graph.edges[edgeIndex];
+
+        if (edge.target==ignoredNode ||
+            graph.nodes[edge.target].contracted) {
+          continue;
+        }
+
+        uint64_t weight=(uint64_t)current.first+edge.weight;
+
+        if (weight>maxWeight) {
+          continue;
+        }
+
+        auto entry=weights.find(edge.target);
+
+        if (entry==weights.end() ||
+            weight<entry->second) {
+          weights[edge.target]=(uint32_t)weight;
+          queue.push(QueueEntry((uint32_t)weight,edge.target));
+        }
+      }
+    }
+  }
+
+  /**
+   * Add a shortcut for the two given edges. If there is already an edge between
+   * the two nodes and both nodes do not have any turn restrictions,
+   * the cheaper of both edges is kept.
+   */
+  void RouteCHDataGenerator::AddShortcut(Graph& graph,
+                                         const Edge& incoming,
+                                         const Edge& outgoing,
+                                         uint32_t weight) const
+  {
+    Edge shortcut;
+
+    shortcut.source=incoming.source;
+    shortcut.target=outgoing.target;
+    shortcut.weight=weight;
+    shortcut.middle=incoming.target;
+    shortcut.firstNode=incoming.firstNode;
+    shortcut.firstObject=incoming.firstObject;
+    shortcut.lastObject=outgoing.lastObject;
+
+    Node& source=graph.nodes[shortcut.source];
+    Node& target=graph.nodes[shortcut.target];
+
+    if (source.excludes.empty() &&
+        target.excludes.empty()) {
+      for (size_t edgeIndex : source.outEdges) {
+        Edge& edge=graph.edges[edgeIndex];
+
+        if (edge.target!=shortcut.target) {
+          continue;
+        }
+
+        if (edge.weight>shortcut.weight) {
+          edge=shortcut;
+          graph.shortcutCount++;
+        }
+
+        return;
+      }
+    }
+
+    source.outEdges.push_back(graph.edges.size());
+    target.inEdges.push_back(graph.edges.size());
+    graph.edges.push_back(shortcut);
+    graph.shortcutCount++;
+  }
+
+  /**
+   * Contract the given node by adding shortcuts between all not yet contracted
+   * neighbours, if there is no witness path. If simulate is true, the node
+   * is not contracted, only the number of required shortcuts is calculated.
+   *
+   * @return
+   *    Number of shortcuts (that would have been) added
+   */
+  size_t RouteCHDataGenerator::ContractNode(Graph& graph,
+                                            uint32_t nodeIndex,
+                                            bool simulate) const
+  {
+    std::unordered_map<uint32_t,uint32_t> witnessWeights;
+    std::vector<size_t>                   inEdges;
+    std::vector<size_t>                   outEdges;
+    uint32_t                              maxOutWeight=0;
+    size_t                                shortcutCount=0;
+
+    // Copy, since AddShortcut() modifies the edge lists
+    for (size_t edgeIndex : graph.nodes[nodeIndex].inEdges) {
+      if (!graph.nodes[graph.edges[edgeIndex].source].contracted) {
+        inEdges.push_back(edgeIndex);
+      }
+    }
+
+    for (size_t edgeIndex : graph.nodes[nodeIndex].outEdges) {
+      if (!graph.nodes[graph.edges[edgeIndex].target].contracted) {
+        outEdges.push_back(edgeIndex);
+        maxOutWeight=std::max(maxOutWeight,graph.edges[edgeIndex].weight);
+      }
+    }
+
+    for (size_t inEdgeIndex : inEdges) {
+      // Copy, since AddShortcut() might add to the edge vector
+      Edge     incoming=graph.edges[inEdgeIndex];
+      bool     witnessSearch=graph.nodes[incoming.source].excludes.empty();
+      uint64_t maxWeight=std::min((uint64_t)incoming.weight+maxOutWeight,
+                                  (uint64_t)std::numeric_limits<uint32_t>::max());
+
+      if (witnessSearch) {
+        WitnessSearch(graph,
+                      incoming.source,
+                      nodeIndex,
+                      (uint32_t)maxWeight,
+                      witnessWeights);
+      }
+
+      for (size_t outEdgeIndex : outEdges) {
+        Edge outgoing=graph.edges[outEdgeIndex];
+
+        if (outgoing.target==incoming.source) {
+          continue;
+        }
+
+        if (!graph.nodes[nodeIndex].excludes.empty() &&
+            IsTurnForbidden(graph.nodes[nodeIndex],
+                            incoming,
+                            outgoing)) {
+          continue;
+        }
+
+        uint32_t weight=(uint32_t)std::min((uint64_t)incoming.weight+outgoing.weight,
+                                           (uint64_t)std::numeric_limits<uint32_t>::max());
+
+        // A witness path ending at a node with turn restrictions could hide a turn we need
+        if (witnessSearch &&
+            graph.nodes[outgoing.target].excludes.empty()) {
+          auto witness=witnessWeights.find(outgoing.target);
+
+          if (witness!=witnessWeights.end() &&
+              witness->second<=weight) {
+            continue;
+          }
+        }
+
+        shortcutCount++;
+
+        if (!simulate) {
+          AddShortcut(graph,
+                      incoming,
+                      outgoing,
+                      weight);
+        }
+      }
+    }
+
+    return shortcutCount;
+  }
+
+  /**
+   * Calculate the contraction priority of the given node. Nodes with
+   * a lower priority get contracted first.
+   */
+  int RouteCHDataGenerator::CalculatePriority(Graph& graph,
+                                              uint32_t nodeIndex) const
+  {
+    const Node& node=graph.nodes[nodeIndex];
+    int         removedEdges=0;
+    int         shortcuts=(int)ContractNode(graph,nodeIndex,true);
+
+    for (size_t edgeIndex : node.inEdges) {
+      if (!graph.nodes[graph.edges[edgeIndex].source].contracted) {
+        removedEdges++;
+      }
+    }
+
+    for (size_t edgeIndex : node.outEdges) {
+      if (!graph.nodes[graph.edges[edgeIndex].target].contracted) {
+        removedEdges++;
+      }
+    }
+
+    return 2*(shortcuts-removedEdges)+(int)node.contractedNeighbours;
+  }
+
+  /**
+   * Contract all nodes of the graph, using lazy updates of the node priorities.
+   */
+  void RouteCHDataGenerator::ContractGraph(Progress& progress,
+                                           Graph& graph) const
+  {
+    std::vector<int>             priorities(graph.nodes.size());
+    IndexedHeap<PriorityCompare> queue((PriorityCompare(priorities)));
+    uint32_t                     rank=0;
+
+    progress.SetAction("Calculating initial node order");
+
+    queue.Reserve(graph.nodes.size());
+
+    for (uint32_t n=0; n<graph.nodes.size(); n++) {
+      progress.SetProgress(n,graph.nodes.size());
+
+      priorities[n]=CalculatePriority(graph,n);
+      queue.Push(n);
+    }
+
+    progress.SetAction("Contracting nodes");
+
+    while (!queue.Empty()) {
+      uint32_t nodeIndex=(uint32_t)queue.Pop();
+      int      priority=CalculatePriority(graph,nodeIndex);
+
+      // Priority got worse since last update, re-evaluate later
+      if (!queue.Empty() &&
+          priority>priorities[queue.Top()]) {
+        priorities[nodeIndex]=priority;
+        queue.Push(nodeIndex);
+        continue;
+      }
+
+      progress.SetProgress(rank,graph.nodes.size());
+
+      ContractNode(graph,nodeIndex,false);
+
+      Node& node=graph.nodes[nodeIndex];
+
+      node.rank=rank++;
+      node.contracted=true;
+
+      for (size_t edgeIndex : node.inEdges) {
+        graph.nodes[graph.edges[edgeIndex].source].contractedNeighbours++;
+      }
+
+      for (size_t edgeIndex : node.outEdges) {
+        graph.nodes[graph.edges[edgeIndex].target].contractedNeighbours++;
+      }
+    }
+  }
+
+  bool RouteCHDataGenerator::WriteContractionHierarchy(const ImportParameter& parameter,
+                                                       Progress& progress,
+                                                       const CHMetric& metric,
+                                                       const Graph& graph) const
+  {
+    FileWriter writer;
+    FileOffset graphFileSize;
+
+    if (!GetFileSize(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                     RoutingService::FILENAME_CAR_DAT),
+                     graphFileSize)) {
+      progress.Error(std::string("Cannot get size of '")+RoutingService::FILENAME_CAR_DAT+"'");
+      return false;
+    }
+
+    if (!writer.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                     RoutingService::FILENAME_CAR_CH_DAT))) {
+      progress.Error("Cannot create '"+writer.GetFilename()+"'");
+      return false;
+    }
+
+    if (!ContractionHierarchy::WriteHeader(writer,
+                                           graphFileSize,
+                                           metric,
+                                           (uint32_t)graph.nodes.size())) {
+      progress.Error("Error while writing to '"+writer.GetFilename()+"'");
+      return false;
+    }
+
+    for (uint32_t n=0; n<graph.nodes.size(); n++) {
+      const Node& node=graph.nodes[n];
+      CHNode      chNode;
+
+      progress.SetProgress(n,graph.nodes.size());
+
+      chNode.routeNodeOffset=node.routeNodeOffset;
+      chNode.excludes=node.excludes;
+
+      // Every edge is stored at the node with the lower rank
+      for (size_t edgeIndex : node.outEdges) {
+        const Edge& edge=graph.edges[edgeIndex];
+
+        if (graph.nodes[edge.target].rank>node.rank) {
+          chNode.upEdges.push_back(CHEdge{edge.target,edge.weight,edge.middle,edge.firstNode,edge.firstObject,edge.lastObject});
+        }
+      }
+
+      for (size_t edgeIndex : node.inEdges) {
+        const Edge& edge=graph.edges[edgeIndex];
+
+        if (graph.nodes[edge.source].rank>node.rank) {
+          chNode.downEdges.push_back(CHEdge{edge.source,edge.weight,edge.middle,edge.firstNode,edge.firstObject,edge.lastObject});
+        }
+      }
+
+      if (!chNode.Write(writer)) {
+        progress.Error("Error while writing to '"+writer.GetFilename()+"'");
+        return false;
+      }
+    }
+
+    return writer.Close();
+  }
+
+  bool RouteCHDataGenerator::Import(const TypeConfigRef& typeConfig,
+                                    const ImportParameter& parameter,
+                                    Progress& progress)
+  {
+    FastestPathRoutingProfile      profile(typeConfig);
+    std::map<std::string,double>   speedMap;
+    CHMetric                       metric;
+    std::vector<ObjectVariantData> objectVariantData;
+    Graph                          graph;
+
+    if (!parameter.GetRouteContractionHierarchy()) {
+      std::string filename=AppendFileToDir(parameter.GetDestinationDirectory(),
+                                           RoutingService::FILENAME_CAR_CH_DAT);
+      FileOffset  fileSize;
+
+      progress.Info("Contraction hierarchy not requested");
+
+      // Do not leave a hierarchy of a previous import behind
+      if (GetFileSize(filename,fileSize) &&
+          !RemoveFile(filename)) {
+        progress.Error("Cannot delete '"+filename+"'");
+        return false;
+      }
+
+      return true;
+    }
+
+    graph.shortcutCount=0;
+
+    // The same speeds a car profile uses by default, else the hierarchy cannot be used
+    AbstractRoutingProfile::GetDefaultCarSpeedTable(speedMap);
+
+    if (!profile.ParametrizeForCar(*typeConfig,
+                                   speedMap,
+                                   AbstractRoutingProfile::defaultCarMaxSpeed)) {
+      progress.Warning("Not all routable types have a speed defined, these types are ignored");
+    }
+
+    metric.Set(*typeConfig,
+               profile);
+
+    progress.SetAction(std::string("Loading route graph '")+RoutingService::FILENAME_CAR_DAT+"'");
+
+    if (!LoadObjectVariantData(*typeConfig,
+                               parameter,
+                               objectVariantData)) {
+      progress.Error(std::string("Cannot load '")+RoutingService::FILENAME_CAR_VARIANT_DAT+"'");
+      return false;
+    }
+
+    if (!LoadRouteGraph(*typeConfig,
+                        parameter,
+                        progress,
+                        profile,
+                        objectVariantData,
+                        graph)) {
+      return false;
+    }
+
+    size_t originalEdgeCount=graph.edges.size();
+
+    progress.Info(NumberToString(graph.nodes.size())+" node(s), "+
+                  NumberToString(originalEdgeCount)+" edge(s)");
+
+    ContractGraph(progress,
+                  graph);
+
+    progress.Info(NumberToString(graph.shortcutCount)+" shortcut(s), "+
+                  NumberToString(graph.edges.size()-originalEdgeCount)+" additional edge(s)");
+
+    progress.SetAction(std::string("Writing contraction hierarchy '")+RoutingService::FILENAME_CAR_CH_DAT+"'");
+
+    return WriteContractionHierarchy(parameter,
+                                     progress,
+                                     metric,
+                                     graph);
+  }
+}
@@ -21,6 +21,17 @@
 
 #include <algorithm>
 
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_MUTEX)
+#include <list>
+#include <mutex>
+#endif
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <thread>
+#endif
+
 #include <osmscout/ObjectRef.h>
 
 #include <osmscout/CoordDataFile.h>
@@ -34,9 +45,34 @@
 #include <osmscout/util/StopClock.h>
 #include <osmscout/util/String.h>
 
+#include <osmscout/import/BufferedProgress.h>
+
 namespace osmscout {
 
+  /**
+   * Number of ways or areas, whose node ids are collected before they are
+   * marked as used in one go
+   */
+  static const size_t intersectionBatchSize=10000;
+
+  RouteDataGenerator::RouteGraph::RouteGraph()
+  : vehicle(vehicleFoot),
+    writtenRouteNodeCount(0),
+    objectCount(0),
+    pathCount(0),
+    excludeCount(0),
+    simpleNodesCount(0),
+    success(true)
+  {
+    // no code
+  }
+
   RouteDataGenerator::RouteDataGenerator()
+  : accessReader(NULL),
+    accessRestrictedReader(NULL),
+    maxSpeedReader(NULL),
+    gradeReader(NULL),
+    reversePaths(false)
   {
     // no code
   }
@@ -46,6 +82,36 @@ namespace osmscout {
     return "Generate routing graphs";
   }
 
+  void RouteDataGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                ImportModuleDescription& description) const
+  {
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areas.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "coord.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "turnrestr.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "ways.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "ways.idmap"));
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                RoutingService::FILENAME_INTERSECTIONS_DAT));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                RoutingService::FILENAME_FOOT_DAT));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                RoutingService::FILENAME_FOOT_VARIANT_DAT));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                RoutingService::FILENAME_BICYCLE_DAT));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                RoutingService::FILENAME_BICYCLE_VARIANT_DAT));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                RoutingService::FILENAME_CAR_DAT));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                RoutingService::FILENAME_CAR_VARIANT_DAT));
+  }
+
   bool RouteDataGenerator::IsAccessRestricted(const FeatureValueBuffer& buffer) const
   {
     return accessRestrictedReader->IsSet(buffer);
@@ -576,13 +642,78 @@ namespace osmscout {
     return defaultReturn;
   }
 
+  /**
+   * Marks the (distinct) node ids of the objects in the given range as used
+   */
+  void RouteDataGenerator::MarkNodesUsedJob(const std::vector<std::vector<Id> >* objectIds,
+                                            size_t start,
+                                            size_t end,
+                                            NodeUseMap* nodeUseMap)
+  {
+    for (size_t o=start; o<end; o++) {
+      std::set<Id> nodeIds;
+
+      for (const auto id : (*objectIds)[o]) {
+        if (id==0) {
+          continue;
+        }
+
+        if (nodeIds.find(id)==nodeIds.end()) {
+          nodeUseMap->SetNodeUsed(id);
+
+          nodeIds.insert(id);
+        }
+      }
+    }
+  }
+
+  /**
+   * Marks the node ids of all given objects as used. Since the NodeUseMap can
+   * be updated concurrently, the objects are split into one range per thread,
+   * if allowed.
+   */
+  void RouteDataGenerator::MarkNodesUsed(const ImportParameter& parameter,
+                                         const std::vector<std::vector<Id> >& objectIds,
+                                         NodeUseMap& nodeUseMap)
+  {
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_ATOMIC)
+    if (parameter.GetThreadCount()>1 &&
+        objectIds.size()>1) {
+      std::vector<std::thread> threads;
+      size_t                   threadCount=std::min(parameter.GetThreadCount(),
+                                                    objectIds.size());
+
+      for (size_t t=0; t<threadCount; t++) {
+        threads.push_back(std::thread(&RouteDataGenerator::MarkNodesUsedJob,
+                                      this,
+                                      &objectIds,
+                                      t*objectIds.size()/threadCount,
+                                      (t+1)*objectIds.size()/threadCount,
+                                      &nodeUseMap));
+      }
+
+      for (auto& thread : threads) {
+        thread.join();
+      }
+
+      return;
+    }
+#endif
+
+    MarkNodesUsedJob(&objectIds,
+                     0,
+                     objectIds.size(),
+                     &nodeUseMap);
+  }
+
   bool RouteDataGenerator::ReadIntersections(const ImportParameter& parameter,
                                              Progress& progress,
                                              const TypeConfig& typeConfig,
                                              NodeUseMap& nodeUseMap)
   {
-    FileScanner scanner;
-    uint32_t    dataCount=0;
+    FileScanner                   scanner;
+    uint32_t                      dataCount=0;
+    std::vector<std::vector<Id> > objectIds;
 
     progress.Info("Scanning ways");
 
@@ -623,23 +754,22 @@ namespace osmscout {
         continue;
       }
 
-      std::set<Id> nodeIds;
-
-      for (std::vector<Id>::const_iterator id=way.ids.begin();
-          id!=way.ids.end();
-          id++) {
-        if (*id==0) {
-          continue;
-        }
+      objectIds.push_back(std::vector<Id>());
+      objectIds.back().swap(way.ids);
 
-        if (nodeIds.find(*id)==nodeIds.end()) {
-          nodeUseMap.SetNodeUsed(*id);
-
-          nodeIds.insert(*id);
-        }
+      if (objectIds.size()>=intersectionBatchSize) {
+        MarkNodesUsed(parameter,
+                      objectIds,
+                      nodeUseMap);
+        objectIds.clear();
       }
     }
 
+    MarkNodesUsed(parameter,
+                  objectIds,
+                  nodeUseMap);
+    objectIds.clear();
+
     if (!scanner.Close()) {
       progress.Error("Cannot close file 'ways.dat'");
       return false;
@@ -689,23 +819,22 @@ namespace osmscout {
         continue;
       }
 
-      std::set<Id> nodeIds;
+      objectIds.push_back(std::vector<Id>());
+      objectIds.back().swap(area.rings.front().ids);
 
-      for (std::vector<Id>::const_iterator id=area.rings.front().ids.begin();
-          id!=area.rings.front().ids.end();
-          id++) {
-        if (*id==0) {
-          continue;
-        }
-
-        if (nodeIds.find(*id)==nodeIds.end()) {
-          nodeUseMap.SetNodeUsed(*id);
-
-          nodeIds.insert(*id);
-        }
+      if (objectIds.size()>=intersectionBatchSize) {
+        MarkNodesUsed(parameter,
+                      objectIds,
+                      nodeUseMap);
+        objectIds.clear();
       }
     }
 
+    MarkNodesUsed(parameter,
+                  objectIds,
+                  nodeUseMap);
+    objectIds.clear();
+
     if (!scanner.Close()) {
       progress.Error("Cannot close file 'areas.dat'");
       return false;
@@ -989,22 +1118,24 @@ namespace osmscout {
   bool RouteDataGenerator::GetRouteNodeCoord(Progress& progress,
                                              Id id,
                                              const std::list<ObjectFileRef>& objects,
-                                             std::unordered_map<FileOffset,WayRef>& waysMap,
-                                             std::unordered_map<FileOffset,AreaRef>& areasMap,
+                                             const std::unordered_map<FileOffset,WayRef>& waysMap,
+                                             const std::unordered_map<FileOffset,AreaRef>& areasMap,
                                              GeoCoord& coord) const
   {
     for (const auto& ref : objects) {
       if (ref.GetType()==refWay) {
-        const WayRef& way=waysMap[ref.GetFileOffset()];
+        auto wayEntry=waysMap.find(ref.GetFileOffset());
 
-        if (!way) {
+        if (wayEntry==waysMap.end() ||
+            !wayEntry->second) {
           progress.Error("Error while loading way at offset "+
                          NumberToString(ref.GetFileOffset()) +
                          " (Internal error?)");
           continue;
         }
 
-        int currentNode=0;
+        const WayRef& way=wayEntry->second;
+        int           currentNode=0;
 
         // Find current route node in area
         while (currentNode<(int)way->nodes.size() &&
@@ -1020,9 +1151,10 @@ namespace osmscout {
         return true;
       }
       else if (ref.GetType()==refArea) {
-        const AreaRef& area=areasMap[ref.GetFileOffset()];
+        auto areaEntry=areasMap.find(ref.GetFileOffset());
 
-        if (!area) {
+        if (areaEntry==areasMap.end() ||
+            !areaEntry->second) {
           progress.Error("Error while loading area at offset "+
                          NumberToString(ref.GetFileOffset()) +
                          " (Internal error?)");
@@ -1030,7 +1162,7 @@ namespace osmscout {
         }
 
         int               currentNode=0;
-        const Area::Ring& ring=area->rings.front();
+        const Area::Ring& ring=areaEntry->second->rings.front();
 
         // Find current route node in area
         while (currentNode<(int)ring.nodes.size() &&
@@ -1246,10 +1378,14 @@ namespace osmscout {
 
     assert(currentNode<(int)way.nodes.size());
 
+    // If requested, paths are also written against the direction of oneways
+    // (without any vehicle flag set), so that the router can traverse the
+    // graph backwards
+
     // In path direction
 
     int nextNode=currentNode+1;
-    if (GetAccess(way).CanRouteForward()) {
+    if (reversePaths ? GetAccess(way).CanRoute() : GetAccess(way).CanRouteForward()) {
 
       if (nextNode>=(int)way.nodes.size()) {
         nextNode=0;
@@ -1306,7 +1442,7 @@ namespace osmscout {
 
     // Against path direction
 
-    if (GetAccess(way).CanRouteBackward()) {
+    if (reversePaths ? GetAccess(way).CanRoute() : GetAccess(way).CanRouteBackward()) {
       int prevNode=currentNode-1;
 
       if (prevNode<0) {
@@ -1372,10 +1508,13 @@ namespace osmscout {
                                              const NodeIdOffsetMap& nodeIdOffsetMap,
                                              PendingRouteNodeOffsetsMap& pendingOffsetsMap)
   {
+    // If requested, paths are also written against the direction of oneways
+    // (without any vehicle flag set), so that the router can traverse the
+    // graph backwards
     for (size_t i=0; i<way.nodes.size(); i++) {
       if (way.ids[i]==routeNode.id) {
         // Route backward
-        if (GetAccess(way).CanRouteBackward() &&
+        if ((reversePaths ? GetAccess(way).CanRoute() : GetAccess(way).CanRouteBackward()) &&
             i>0) {
           int j=i-1;
 
@@ -1425,7 +1564,7 @@ namespace osmscout {
         }
 
         // Route forward
-        if (GetAccess(way).CanRouteForward() &&
+        if ((reversePaths ? GetAccess(way).CanRoute() : GetAccess(way).CanRouteForward()) &&
             i+1<way.nodes.size()) {
           size_t j=i+1;
 
@@ -1508,18 +1647,17 @@ namespace osmscout {
         if (!CanTurn(turnConstraints->second,
                      source.GetFileOffset(),
                      dest.GetFileOffset())) {
-          RouteNode::Exclude exclude;
+          // There might be more than one path using the destination
+          // (both directions of a way), exclude all of them
+          for (size_t i=0; i<routeNode.paths.size(); i++) {
+            if (routeNode.objects[routeNode.paths[i].objectIndex].object==dest) {
+              RouteNode::Exclude exclude;
 
-          exclude.source=source;
-          exclude.targetIndex=0;
+              exclude.source=source;
+              exclude.targetIndex=(uint32_t)i;
 
-          while (exclude.targetIndex<routeNode.paths.size() &&
-              routeNode.objects[routeNode.paths[exclude.targetIndex].objectIndex].object!=dest) {
-            exclude.targetIndex++;
-          }
-
-          if (exclude.targetIndex<routeNode.paths.size()) {
-            routeNode.excludes.push_back(exclude);
+              routeNode.excludes.push_back(exclude);
+            }
           }
         }
       }
@@ -1650,6 +1788,16 @@ namespace osmscout {
 
     progress.Info(NumberToString(objectVariantData.size()) + " object variant(s)");
 
+    // Readers not knowing about the flags just ignore the trailing data, readers
+    // not finding them assume a graph without reverse paths
+    uint8_t flags=0;
+
+    if (reversePaths) {
+      flags|=RoutingService::graphHasReversePaths;
+    }
+
+    writer.Write(flags);
+
     if (!writer.Close()) {
       return false;
     }
@@ -1657,42 +1805,283 @@ namespace osmscout {
     return true;
   }
 
-  bool RouteDataGenerator::WriteRouteGraph(const ImportParameter& parameter,
-                                           Progress& progress,
-                                           const TypeConfig& typeConfig,
-                                           const NodeIdObjectsMap& nodeObjectsMap,
-                                           const ViaTurnRestrictionMap& restrictions,
-                                           Vehicle vehicle,
-                                           const std::string& dataFilename,
-                                           const std::string& variantFilename)
+  bool RouteDataGenerator::WriteRouteNodes(Progress& progress,
+                                           const RouteNodeBlock& block,
+                                           RouteGraph& graph)
   {
-    FileScanner                wayScanner;
-    FileScanner                areaScanner;
-    FileWriter                 writer;
+    for (size_t b=0; b<block.nodeCount; b++) {
+      NodeIdObjectsMap::const_iterator node=block.nodes[b];
+      FileOffset                       routeNodeOffset;
+
+      if (!graph.writer.GetPos(routeNodeOffset)) {
+        return false;
+      }
+
+      //
+      // Find out if any of the areas/ways at the intersection is routable
+      // for us for the given vehicle (we already only loaded those objects
+      // that are routable at all).
+      // If none of the objects is routable the complete node is not routable and
+      // we can safely drop this node from the routing graph.
+      //
+
+      if (!IsAnyRoutable(progress,
+                         node->second,
+                         block.waysMap,
+                         block.areasMap,
+                         graph.vehicle)) {
+        continue;
+      }
+
+      RouteNode routeNode;
+
+      routeNode.id=node->first;
+
+      if (!GetRouteNodeCoord(progress,
+                             node->first,
+                             node->second,
+                             block.waysMap,
+                             block.areasMap,
+                             routeNode.coord)) {
+        continue;
+      }
+
+      //
+      // Calculate all outgoing paths
+      //
+
+      for (const auto& ref : node->second) {
+        if (ref.GetType()==refWay) {
+          auto wayEntry=block.waysMap.find(ref.GetFileOffset());
+
+          if (wayEntry==block.waysMap.end() ||
+              !wayEntry->second) {
+            progress.Error("Error while loading way at offset "+
+                           NumberToString(ref.GetFileOffset()) +
+                           " (Internal error?)");
+            continue;
+          }
+
+          const WayRef& way=wayEntry->second;
+
+          if (!GetAccess(*way).CanRoute(graph.vehicle)) {
+            continue;
+          }
+
+          uint16_t objectVariantIndex=RegisterOrUseObjectVariantData(graph.routeDataMap,
+                                                                     way->GetType(),
+                                                                     GetMaxSpeed(*way),
+                                                                     GetGrade(*way));
+
+          if (way->IsCircular()) {
+            // Circular way routing (similar to current area routing, but respecting isOneway())
+            CalculateCircularWayPaths(routeNode,
+                                      *way,
+                                      objectVariantIndex,
+                                      routeNodeOffset,
+                                      *block.nodeObjectsMap,
+                                      graph.routeNodeIdOffsetMap,
+                                      graph.pendingOffsetsMap);
+          }
+          else {
+            // Normal way routing
+            CalculateWayPaths(routeNode,
+                              *way,
+                              objectVariantIndex,
+                              routeNodeOffset,
+                              *block.nodeObjectsMap,
+                              graph.routeNodeIdOffsetMap,
+                              graph.pendingOffsetsMap);
+          }
+        }
+        else if (ref.GetType()==refArea) {
+          auto areaEntry=block.areasMap.find(ref.GetFileOffset());
+
+          if (areaEntry==block.areasMap.end() ||
+              !areaEntry->second) {
+            progress.Error("Error while loading area at offset "+
+                           NumberToString(ref.GetFileOffset()) +
+                           " (Internal error?)");
+            continue;
+          }
+
+          const AreaRef& area=areaEntry->second;
+
+          if (!area->GetType()->CanRoute()) {
+            continue;
+          }
+
+          uint16_t objectVariantIndex=RegisterOrUseObjectVariantData(graph.routeDataMap,
+                                                                     area->GetType(),
+                                                                     0,
+                                                                     1);
+
+          routeNode.AddObject(ref,
+                              objectVariantIndex);
+
+          CalculateAreaPaths(routeNode,
+                             *area,
+                             objectVariantIndex,
+                             routeNodeOffset,
+                             *block.nodeObjectsMap,
+                             graph.routeNodeIdOffsetMap,
+                             graph.pendingOffsetsMap);
+        }
+      }
 
-    uint32_t                   handledRouteNodeCount=0;
-    uint32_t                   writtenRouteNodeCount=0;
-    uint32_t                   objectCount=0;
-    uint32_t                   pathCount=0;
-    uint32_t                   excludeCount=0;
-    uint32_t                   simpleNodesCount=0;
+      FillRoutePathExcludes(routeNode,
+                            node->second,
+                            *block.restrictions);
 
-    NodeIdOffsetMap            routeNodeIdOffsetMap;
-    PendingRouteNodeOffsetsMap pendingOffsetsMap;
+      graph.routeNodeIdOffsetMap.insert(std::make_pair(node->first,routeNodeOffset));
+
+      if (routeNode.paths.size()==1) {
+        graph.simpleNodesCount++;
+      }
 
-    std::map<ObjectVariantData,uint16_t> routeDataMap;
+      graph.objectCount+=routeNode.objects.size();
+      graph.pathCount+=routeNode.paths.size();
+      graph.excludeCount+=routeNode.excludes.size();
+
+      if (!routeNode.Write(graph.writer)) {
+        progress.Error(std::string("Error while writing route node to file '")+
+                       graph.writer.GetFilename()+"'");
+        return false;
+      }
+
+      graph.writtenRouteNodeCount++;
+    }
+
+    graph.writer.Flush();
+
+    //
+    // A route node stores the fileOffset of all other route nodes (destinations) it can route to.
+    // However if the destination route node is not yet stored, we do not have a file offset yet. Route nodes
+    // we do not have a file offset for yet, are stored in the pendingOffsetsMap map.
+    // So for every blocked store we are looking if any node in the block is in the pendingOffsetsMap, reload
+    // the requesting route node, store the new offsets and write the route node back.
+
+    return HandlePendingOffsets(progress,
+                                graph.routeNodeIdOffsetMap,
+                                graph.pendingOffsetsMap,
+                                graph.writer,
+                                block.nodes,
+                                block.nodeCount);
+  }
+
+  void RouteDataGenerator::WriteRouteNodesJob(Progress* progress,
+                                              const RouteNodeBlock* block,
+                                              RouteGraph* graph)
+  {
+    graph->success=WriteRouteNodes(*progress,
+                                   *block,
+                                   *graph);
+  }
+
+  bool RouteDataGenerator::WriteRouteNodeBlock(const ImportParameter& parameter,
+                                               Progress& progress,
+                                               const RouteNodeBlock& block,
+                                               std::vector<RouteGraph>& graphs)
+  {
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_MUTEX)
+    if (parameter.GetThreadCount()>1 &&
+        graphs.size()>1) {
+      size_t current=0;
+
+      // The graphs only share the (constant) block, so each graph can be written
+      // by its own thread. Messages are buffered and passed on in the order of the graphs.
+      while (current<graphs.size()) {
+        std::mutex                  mutex;
+        std::list<BufferedProgress> progresses;
+        std::vector<std::thread>    threads;
+        size_t                      end=std::min(current+parameter.GetThreadCount(),
+                                                 graphs.size());
+
+        for (size_t g=current; g<end; g++) {
+          progresses.emplace_back(mutex,
+                                  progress);
+
+          threads.push_back(std::thread(&RouteDataGenerator::WriteRouteNodesJob,
+                                        this,
+                                        &progresses.back(),
+                                        &block,
+                                        &graphs[g]));
+        }
+
+        for (auto& thread : threads) {
+          thread.join();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (auto& graphProgress : progresses) {
+          graphProgress.Attach();
+        }
+
+        current=end;
+      }
+    }
+    else {
+      for (auto& graph : graphs) {
+        graph.success=WriteRouteNodes(progress,
+                                      block,
+                                      graph);
+      }
+    }
+#else
+    for (auto& graph : graphs) {
+      graph.success=WriteRouteNodes(progress,
+                                    block,
+                                    graph);
+    }
+#endif
+
+    for (const auto& graph : graphs) {
+      if (!graph.success) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool RouteDataGenerator::WriteRouteGraphs(const ImportParameter& parameter,
+                                            Progress& progress,
+                                            const TypeConfig& typeConfig,
+                                            const NodeIdObjectsMap& nodeObjectsMap,
+                                            const ViaTurnRestrictionMap& restrictions)
+  {
+    FileScanner             wayScanner;
+    FileScanner             areaScanner;
+    std::vector<RouteGraph> graphs(3);
+    RouteNodeBlock          block;
+    uint32_t                handledRouteNodeCount=0;
+
+    graphs[0].vehicle=vehicleFoot;
+    graphs[0].dataFilename=RoutingService::FILENAME_FOOT_DAT;
+    graphs[0].variantFilename=RoutingService::FILENAME_FOOT_VARIANT_DAT;
+
+    graphs[1].vehicle=vehicleBicycle;
+    graphs[1].dataFilename=RoutingService::FILENAME_BICYCLE_DAT;
+    graphs[1].variantFilename=RoutingService::FILENAME_BICYCLE_VARIANT_DAT;
+
+    graphs[2].vehicle=vehicleCar;
+    graphs[2].dataFilename=RoutingService::FILENAME_CAR_DAT;
+    graphs[2].variantFilename=RoutingService::FILENAME_CAR_VARIANT_DAT;
 
     //
     // Writing route nodes
     //
 
-    if (!writer.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
-                                     dataFilename))) {
-      progress.Error("Cannot create '"+dataFilename+"'");
-      return false;
-    }
+    for (auto& graph : graphs) {
+      if (!graph.writer.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                             graph.dataFilename))) {
+        progress.Error("Cannot create '"+graph.dataFilename+"'");
+        return false;
+      }
 
-    writer.Write(writtenRouteNodeCount);
+      graph.writer.Write(graph.writtenRouteNodeCount);
+    }
 
     if (!wayScanner.Open(AppendFileToDir(parameter.GetDestinationDirectory(),
                                          "ways.dat"),
@@ -1710,21 +2099,23 @@ namespace osmscout {
       return false;
     }
 
-    std::vector<NodeIdObjectsMap::const_iterator> block(parameter.GetRouteNodeBlockSize());
+    block.nodeObjectsMap=&nodeObjectsMap;
+    block.restrictions=&restrictions;
+    block.nodes.resize(parameter.GetRouteNodeBlockSize());
 
     NodeIdObjectsMap::const_iterator node=nodeObjectsMap.begin();
     while (node!=nodeObjectsMap.end()) {
 
       // Fill the current block of nodes to be processed
 
-      size_t blockCount=0;
+      block.nodeCount=0;
 
-      progress.Info("Loading up to " + NumberToString(block.size()) + " route nodes");
-      while (blockCount<block.size() &&
+      progress.Info("Loading up to " + NumberToString(block.nodes.size()) + " route nodes");
+      while (block.nodeCount<block.nodes.size() &&
              node!=nodeObjectsMap.end()) {
-        block[blockCount]=node;
+        block.nodes[block.nodeCount]=node;
 
-        blockCount++;
+        block.nodeCount++;
         node++;
       }
 
@@ -1735,8 +2126,8 @@ namespace osmscout {
       std::set<FileOffset> wayOffsets;
       std::set<FileOffset> areaOffsets;
 
-      for (size_t b=0; b<blockCount; b++) {
-        for (const auto& ref : block[b]->second) {
+      for (size_t b=0; b<block.nodeCount; b++) {
+        for (const auto& ref : block.nodes[b]->second) {
           switch (ref.GetType())
           {
           case refNone:
@@ -1754,25 +2145,25 @@ namespace osmscout {
         }
       }
 
-      std::unordered_map<FileOffset,WayRef>  waysMap;
+      block.waysMap.clear();
 
       if (!LoadWays(typeConfig,
                     progress,
                     wayScanner,
                     wayOffsets,
-                    waysMap)) {
+                    block.waysMap)) {
         return false;
       }
 
       wayOffsets.clear();
 
-      std::unordered_map<FileOffset,AreaRef> areasMap;
+      block.areasMap.clear();
 
       if (!LoadAreas(typeConfig,
                      progress,
                      areaScanner,
                      areaOffsets,
-                     areasMap)) {
+                     block.areasMap)) {
         return false;
       }
 
@@ -1780,191 +2171,55 @@ namespace osmscout {
 
       progress.Info("Storing route nodes");
 
-      for (size_t b=0; b<blockCount; b++) {
-        NodeIdObjectsMap::const_iterator node=block[b];
-        FileOffset                       routeNodeOffset;
-
-        if (!writer.GetPos(routeNodeOffset)) {
-          return false;
-        }
-
-        handledRouteNodeCount++;
-        progress.SetProgress(handledRouteNodeCount,
-                             nodeObjectsMap.size());
-
-        //
-        // Find out if any of the areas/ways at the intersection is routable
-        // for us for the given vehicle (we already only loaded those objects
-        // that are routable at all).
-        // If none of the objects is routable the complete node is not routable and
-        // we can safely drop this node from the routing graph.
-        //
-
-        if (!IsAnyRoutable(progress,
-                           node->second,
-                           waysMap,
-                           areasMap,
-                           vehicle)) {
-          continue;
-        }
-
-        RouteNode routeNode;
-
-        routeNode.id=node->first;
-
-        if (!GetRouteNodeCoord(progress,
-                               node->first,
-                               node->second,
-                               waysMap,
-                               areasMap,
-                               routeNode.coord)) {
-          continue;
-        }
-
-        //
-        // Calculate all outgoing paths
-        //
-
-        for (const auto& ref : node->second) {
-          if (ref.GetType()==refWay) {
-            const WayRef& way=waysMap[ref.GetFileOffset()];
-
-            if (!way) {
-              progress.Error("Error while loading way at offset "+
-                             NumberToString(ref.GetFileOffset()) +
-                             " (Internal error?)");
-              continue;
-            }
-
-            if (!GetAccess(*way).CanRoute(vehicle)) {
-              continue;
-            }
-
-            uint16_t objectVariantIndex=RegisterOrUseObjectVariantData(routeDataMap,
-                                                                       way->GetType(),
-                                                                       GetMaxSpeed(*way),
-                                                                       GetGrade(*way));
-
-            if (way->IsCircular()) {
-              // Circular way routing (similar to current area routing, but respecting isOneway())
-              CalculateCircularWayPaths(routeNode,
-                                        *way,
-                                        objectVariantIndex,
-                                        routeNodeOffset,
-                                        nodeObjectsMap,
-                                        routeNodeIdOffsetMap,
-                                        pendingOffsetsMap);
-            }
-            else {
-              // Normal way routing
-              CalculateWayPaths(routeNode,
-                                *way,
-                                objectVariantIndex,
-                                routeNodeOffset,
-                                nodeObjectsMap,
-                                routeNodeIdOffsetMap,
-                                pendingOffsetsMap);
-            }
-          }
-          else if (ref.GetType()==refArea) {
-            const AreaRef& area=areasMap[ref.GetFileOffset()];
-
-            if (!area) {
-              progress.Error("Error while loading area at offset "+
-                             NumberToString(ref.GetFileOffset()) +
-                             " (Internal error?)");
-              continue;
-            }
-
-            if (!area->GetType()->CanRoute()) {
-              continue;
-            }
-
-            uint16_t objectVariantIndex=RegisterOrUseObjectVariantData(routeDataMap,
-                                                                       area->GetType(),
-                                                                       0,
-                                                                       1);
-
-            routeNode.AddObject(ref,
-                                objectVariantIndex);
-
-            CalculateAreaPaths(routeNode,
-                               *area,
-                               objectVariantIndex,
-                               routeNodeOffset,
-                               nodeObjectsMap,
-                               routeNodeIdOffsetMap,
-                               pendingOffsetsMap);
-          }
-        }
-
-        FillRoutePathExcludes(routeNode,
-                              node->second,
-                              restrictions);
-
-        routeNodeIdOffsetMap.insert(std::make_pair(node->first,routeNodeOffset));
-
-        if (routeNode.paths.size()==1) {
-          simpleNodesCount++;
-        }
-
-        objectCount+=routeNode.objects.size();
-        pathCount+=routeNode.paths.size();
-        excludeCount+=routeNode.excludes.size();
-
-        if (!routeNode.Write(writer)) {
-          progress.Error(std::string("Error while writing route node to file '")+
-                         writer.GetFilename()+"'");
-          return false;
-        }
-
-        writtenRouteNodeCount++;
-      }
-
-      writer.Flush();
-
-      //
-      // A route node stores the fileOffset of all other route nodes (destinations) it can route to.
-      // However if the destination route node is not yet stored, we do not have a file offset yet. Route nodes
-      // we do not have a file offset for yet, are stored in the pendingOffsetsMap map.
-      // So for every blocked store we are looking if any node in the block is in the pendingOffsetsMap, reload
-      // the requesting route node, store the new offsets and write the route node back.
-
-      if (!HandlePendingOffsets(progress,
-                                routeNodeIdOffsetMap,
-                                pendingOffsetsMap,
-                                writer,
-                                block,
-                                blockCount)) {
+      if (!WriteRouteNodeBlock(parameter,
+                               progress,
+                               block,
+                               graphs)) {
         return false;
       }
+
+      handledRouteNodeCount+=block.nodeCount;
+      progress.SetProgress(handledRouteNodeCount,
+                           nodeObjectsMap.size());
     }
 
-    assert(pendingOffsetsMap.empty());
+    block.waysMap.clear();
+    block.areasMap.clear();
 
     if (!wayScanner.Close()) {
       progress.Error("Cannot close file '"+wayScanner.GetFilename()+"'");
       return false;
     }
 
-    writer.SetPos(0);
-    writer.Write(writtenRouteNodeCount);
-
-    progress.Info(NumberToString(writtenRouteNodeCount) + " route node(s) written");
-    progress.Info(NumberToString(simpleNodesCount)+ " route node(s) are simple and only have 1 path");
-    progress.Info(NumberToString(objectCount)+ " object(s)");
-    progress.Info(NumberToString(pathCount) + " path(s)");
-    progress.Info(NumberToString(excludeCount) + " exclude(s)");
-
-    if (!writer.Close()) {
+    if (!areaScanner.Close()) {
+      progress.Error("Cannot close file '"+areaScanner.GetFilename()+"'");
       return false;
     }
 
-    if (!WriteObjectVariantData(parameter,
-                                progress,
-                                variantFilename,
-                                routeDataMap)) {
-      return false;
+    for (auto& graph : graphs) {
+      assert(graph.pendingOffsetsMap.empty());
+
+      progress.SetAction(std::string("Writing route graph '")+graph.dataFilename+"'");
+
+      graph.writer.SetPos(0);
+      graph.writer.Write(graph.writtenRouteNodeCount);
+
+      progress.Info(NumberToString(graph.writtenRouteNodeCount) + " route node(s) written");
+      progress.Info(NumberToString(graph.simpleNodesCount)+ " route node(s) are simple and only have 1 path");
+      progress.Info(NumberToString(graph.objectCount)+ " object(s)");
+      progress.Info(NumberToString(graph.pathCount) + " path(s)");
+      progress.Info(NumberToString(graph.excludeCount) + " exclude(s)");
+
+      if (!graph.writer.Close()) {
+        return false;
+      }
+
+      if (!WriteObjectVariantData(parameter,
+                                  progress,
+                                  graph.variantFilename,
+                                  graph.routeDataMap)) {
+        return false;
+      }
     }
 
     return true;
@@ -1988,6 +2243,7 @@ namespace osmscout {
     this->accessReader=&accessReader;
     this->maxSpeedReader=&maxSpeedReader;
     this->gradeReader=&gradeReader;
+    this->reversePaths=parameter.GetRouteReversePaths();
 
     //
     // Handling of restriction relations
@@ -2016,6 +2272,9 @@ namespace osmscout {
       return false;
     }
 
+    progress.Info(NumberToString(nodeUseMap.GetNodeUsedCount())+" nodes used, "+
+                  ByteSizeToString(nodeUseMap.GetMemoryUsage())+" used by node use map");
+
     //
     // Building a map of endpoint ids and list of objects (ObjectFileRef for ways and areas) having this point as junction point
     //
@@ -2053,41 +2312,15 @@ namespace osmscout {
     }
 
 
-    progress.SetAction(std::string("Writing route graph '")+RoutingService::FILENAME_FOOT_DAT+"'");
-
-
-    WriteRouteGraph(parameter,
-                    progress,
-                    *typeConfig,
-                    nodeObjectsMap,
-                    restrictions,
-                    vehicleFoot,
-                    RoutingService::FILENAME_FOOT_DAT,
-                    RoutingService::FILENAME_FOOT_VARIANT_DAT);
+    progress.SetAction("Writing route graphs");
 
-    progress.SetAction(std::string("Writing route graph '")+RoutingService::FILENAME_BICYCLE_DAT+"'");
-
-
-    WriteRouteGraph(parameter,
-                    progress,
-                    *typeConfig,
-                    nodeObjectsMap,
-                    restrictions,
-                    vehicleBicycle,
-                    RoutingService::FILENAME_BICYCLE_DAT,
-                    RoutingService::FILENAME_BICYCLE_VARIANT_DAT);
-
-    progress.SetAction(std::string("Writing route graph '")+RoutingService::FILENAME_CAR_DAT+"'");
-
-
-    WriteRouteGraph(parameter,
-                    progress,
-                    *typeConfig,
-                    nodeObjectsMap,
-                    restrictions,
-                    vehicleCar,
-                    RoutingService::FILENAME_CAR_DAT,
-                    RoutingService::FILENAME_CAR_VARIANT_DAT);
+    if (!WriteRouteGraphs(parameter,
+                          progress,
+                          *typeConfig,
+                          nodeObjectsMap,
+                          restrictions)) {
+      return false;
+    }
 
     // Cleaning up...
 
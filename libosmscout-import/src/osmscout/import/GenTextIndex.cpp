@@ -33,7 +33,9 @@
 
 #include <osmscout/import/GenTextIndex.h>
 
+#if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
 #include <marisa.h>
+#endif
 
 namespace osmscout
 {
@@ -48,7 +50,32 @@ namespace osmscout
     return "Generate text data files 'text(poi,loc,region,other).dat'";
   }
 
+  void TextIndexGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                ImportModuleDescription& description) const
+  {
+#if !defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
+    // Without libmarisa the step does nothing
+    return;
+#endif
+
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "nodes.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "ways.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areas.dat"));
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "textpoi.dat"));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "textloc.dat"));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "textregion.dat"));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "textother.dat"));
+  }
 
+#if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
   bool TextIndexGenerator::Import(const TypeConfigRef& typeConfig,
                                   const ImportParameter &parameter,
                                   Progress &progress)
@@ -107,10 +134,26 @@ namespace osmscout
                                         "textother.dat"));
 
     for(size_t i=0; i < keysets.size(); i++) {
+      // Create a string holding all bytes used in the
+      // texts of the keyset, the fuzzy search only tries
+      // these bytes when extending a prefix
+
+      // We use an ASCII control character to denote
+      // the start of the alphabet key:
+      // 0x05: ENQ
+      std::string alphabetStr;
+      alphabetStr.push_back(5);
+      BuildAlphabetStr(*(keysets[i]),
+                       alphabetStr);
+
       // add sz_offset to the keyset
       keysets[i]->push_back(offsetSizeBytesStr.c_str(),
                             offsetSizeBytesStr.length());
 
+      // add the alphabet to the keyset
+      keysets[i]->push_back(alphabetStr.c_str(),
+                            alphabetStr.length());
+
       marisa::Trie trie;
       try {
         trie.build(*(keysets[i]),
@@ -520,6 +563,30 @@ namespace osmscout
     return true;
   }
 
+  void TextIndexGenerator::BuildAlphabetStr(const marisa::Keyset &keyset,
+                                            std::string &alphabetStr) const
+  {
+    std::vector<bool> used(256,false);
+
+    for(size_t k=0; k < keyset.size(); k++) {
+      const marisa::Key &key=keyset[k];
+
+      // Skip the reftype byte and the file offset at the end of the key
+      size_t textLength=key.length()-offsetSizeBytes-1;
+
+      for(size_t i=0; i < textLength; i++) {
+        used[(unsigned char)key.ptr()[i]]=true;
+      }
+    }
+
+    // Control characters are reserved for the keys
+    for(size_t c=0x20; c < used.size(); c++) {
+      if(used[c]) {
+        alphabetStr.push_back((char)c);
+      }
+    }
+  }
+
   bool TextIndexGenerator::BuildKeyStr(const std::string &text,
                                        const FileOffset offset,
                                        const RefType reftype,
@@ -578,4 +645,18 @@ namespace osmscout
 
     return true;
   }
+#else
+  /**
+   * The step is kept without libmarisa, so that step numbers do not depend
+   * on the available libraries, but it does not generate anything
+   */
+  bool TextIndexGenerator::Import(const TypeConfigRef& /*typeConfig*/,
+                                  const ImportParameter& /*parameter*/,
+                                  Progress& progress)
+  {
+    progress.Info("No support for libmarisa, text index is not generated");
+
+    return true;
+  }
+#endif
 }
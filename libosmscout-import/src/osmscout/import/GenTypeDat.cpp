@@ -19,6 +19,7 @@
 
 #include <osmscout/import/GenTypeDat.h>
 
+#include <osmscout/util/File.h>
 #include <osmscout/util/String.h>
 
 namespace osmscout {
@@ -28,6 +29,13 @@ namespace osmscout {
     return "Generate 'types.dat'";
   }
 
+  void TypeDataGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                               ImportModuleDescription& description) const
+  {
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "types.dat"));
+  }
+
   bool TypeDataGenerator::Import(const TypeConfigRef& typeConfig,
                                  const ImportParameter& parameter,
                                  Progress& progress)
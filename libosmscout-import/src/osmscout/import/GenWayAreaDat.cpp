@@ -48,6 +48,22 @@ namespace osmscout {
     return "Generate 'wayarea.tmp'";
   }
 
+  void WayAreaDataGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                  ImportModuleDescription& description) const
+  {
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "coord.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "distribution.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "rawways.dat"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "wayareablack.dat"));
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "wayarea.tmp"));
+  }
+
   bool WayAreaDataGenerator::ReadWayBlacklist(const ImportParameter& parameter,
                                               Progress& progress,
                                               BlacklistSet& wayBlacklist) const
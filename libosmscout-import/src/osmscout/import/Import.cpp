@@ -19,7 +19,21 @@
 
 #include <osmscout/import/Import.h>
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <vector>
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <thread>
+#endif
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+#include <mutex>
+#include <condition_variable>
+#endif
 
 #include <osmscout/Types.h>
 
@@ -36,6 +50,8 @@
 #include <osmscout/RouteNode.h>
 #include <osmscout/Intersection.h>
 
+#include <osmscout/import/BufferedProgress.h>
+
 #include <osmscout/import/GenTypeDat.h>
 
 #include <osmscout/import/Preprocess.h>
@@ -59,6 +75,7 @@
 #include <osmscout/import/GenAreaWayIndex.h>
 
 #include <osmscout/import/GenLocationIndex.h>
+#include <osmscout/import/GenReverseLocationIndex.h>
 #include <osmscout/import/GenOptimizeAreaWayIds.h>
 #include <osmscout/import/GenWaterIndex.h>
 
@@ -66,31 +83,28 @@
 #include <osmscout/import/GenOptimizeWaysLowZoom.h>
 
 // Routing
+#include <osmscout/import/GenRouteCHDat.h>
 #include <osmscout/import/GenRouteDat.h>
 
-#if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
 #include <osmscout/import/GenTextIndex.h>
-#endif
 
+#include <osmscout/util/File.h>
 #include <osmscout/util/Progress.h>
 #include <osmscout/util/StopClock.h>
 
 namespace osmscout {
 
   static const size_t defaultStartStep=1;
-#if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
-  static const size_t defaultEndStep=28;
-#else
-  static const size_t defaultEndStep=27;
-#endif
+  static const size_t defaultEndStep=30;
 
   ImportParameter::ImportParameter()
    : typefile("map.ost"),
+     threadCount(1),
      startStep(defaultStartStep),
      endStep(defaultEndStep),
      strictAreas(false),
      sortObjects(true),
-     sortBlockSize(40000000),
+     sortBufferSize(1024*1024*1024),
      sortTileMag(14),
      numericIndexPageSize(1024/*4096*/),
      coordDataMemoryMaped(false),
@@ -120,9 +134,13 @@ namespace osmscout {
      optimizationCellSizeMax(255),
      optimizationWayMethod(TransPolygon::quality),
      routeNodeBlockSize(500000),
+     routeReversePaths(false),
+     routeContractionHierarchy(false),
      assumeLand(true)
   {
-    // no code
+#if defined(OSMSCOUT_HAVE_THREAD)
+    threadCount=std::max(std::thread::hardware_concurrency(),1u);
+#endif
   }
 
   const std::list<std::string>& ImportParameter::GetMapfiles() const
@@ -140,6 +158,11 @@ namespace osmscout {
     return destinationDirectory;
   }
 
+  size_t ImportParameter::GetThreadCount() const
+  {
+    return threadCount;
+  }
+
   size_t ImportParameter::GetStartStep() const
   {
     return startStep;
@@ -160,9 +183,9 @@ namespace osmscout {
     return sortObjects;
   }
 
-  size_t ImportParameter::GetSortBlockSize() const
+  size_t ImportParameter::GetSortBufferSize() const
   {
-    return sortBlockSize;
+    return sortBufferSize;
   }
 
   size_t ImportParameter::GetSortTileMag() const
@@ -310,6 +333,16 @@ namespace osmscout {
     return routeNodeBlockSize;
   }
 
+  bool ImportParameter::GetRouteReversePaths() const
+  {
+    return routeReversePaths;
+  }
+
+  bool ImportParameter::GetRouteContractionHierarchy() const
+  {
+    return routeContractionHierarchy;
+  }
+
   bool ImportParameter::GetAssumeLand() const
   {
     return assumeLand;
@@ -330,6 +363,11 @@ namespace osmscout {
     this->destinationDirectory=destinationDirectory;
   }
 
+  void ImportParameter::SetThreadCount(size_t threadCount)
+  {
+    this->threadCount=std::max(threadCount,(size_t)1);
+  }
+
   void ImportParameter::SetStartStep(size_t startStep)
   {
     this->startStep=startStep;
@@ -352,9 +390,9 @@ namespace osmscout {
     this->sortObjects=renumberIds;
   }
 
-  void ImportParameter::SetSortBlockSize(size_t sortBlockSize)
+  void ImportParameter::SetSortBufferSize(size_t sortBufferSize)
   {
-    this->sortBlockSize=sortBlockSize;
+    this->sortBufferSize=sortBufferSize;
   }
 
   void ImportParameter::SetSortTileMag(size_t sortTileMag)
@@ -505,23 +543,103 @@ namespace osmscout {
     this->routeNodeBlockSize=blockSize;
   }
 
+  void ImportParameter::SetRouteReversePaths(bool routeReversePaths)
+  {
+    this->routeReversePaths=routeReversePaths;
+  }
+
+  void ImportParameter::SetRouteContractionHierarchy(bool routeContractionHierarchy)
+  {
+    this->routeContractionHierarchy=routeContractionHierarchy;
+  }
+
   void ImportParameter::SetAssumeLand(bool assumeLand)
   {
     this->assumeLand=assumeLand;
   }
 
+  ImportModuleDescription::ImportModuleDescription()
+  : exclusive(false)
+  {
+    // no code
+  }
+
+  void ImportModuleDescription::AddRequiredFile(const std::string& filename)
+  {
+    requiredFiles.push_back(filename);
+  }
+
+  void ImportModuleDescription::AddProvidedFile(const std::string& filename)
+  {
+    providedFiles.push_back(filename);
+  }
+
+  void ImportModuleDescription::SetExclusive(bool exclusive)
+  {
+    this->exclusive=exclusive;
+  }
+
+  /**
+   * Return true, if the module described by this instance must be executed after
+   * the module described by other (assuming that other is a previous step).
+   */
+  bool ImportModuleDescription::DependsOn(const ImportModuleDescription& other) const
+  {
+    if ((requiredFiles.empty() && providedFiles.empty()) ||
+        (other.requiredFiles.empty() && other.providedFiles.empty())) {
+      return true;
+    }
+
+    // We read a file the other module writes
+    for (const auto& file : requiredFiles) {
+      if (std::find(other.providedFiles.begin(),
+                    other.providedFiles.end(),
+                    file)!=other.providedFiles.end()) {
+        return true;
+      }
+    }
+
+    // We (over)write a file the other module reads or writes
+    for (const auto& file : providedFiles) {
+      if (std::find(other.requiredFiles.begin(),
+                    other.requiredFiles.end(),
+                    file)!=other.requiredFiles.end() ||
+          std::find(other.providedFiles.begin(),
+                    other.providedFiles.end(),
+                    file)!=other.providedFiles.end()) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
   ImportModule::~ImportModule()
   {
     // no code
   }
 
-  static bool ExecuteModules(std::list<ImportModule*>& modules,
-                            const ImportParameter& parameter,
-                            Progress& progress,
-                            const TypeConfigRef& typeConfig)
+  void ImportModule::GetModuleDescription(const ImportParameter& /*parameter*/,
+                                          ImportModuleDescription& /*description*/) const
   {
-    StopClock overAllTimer;
-    size_t    currentStep=1;
+    // no code
+  }
+
+  static std::string GetStepName(size_t step,
+                                 const ImportModule& module)
+  {
+    return std::string("Step #")+
+           NumberToString(step)+
+           " - "+
+           module.GetDescription();
+  }
+
+  static bool ExecuteModulesSequential(std::list<ImportModule*>& modules,
+                                       const ImportParameter& parameter,
+                                       Progress& progress,
+                                       const TypeConfigRef& typeConfig)
+  {
+    size_t currentStep=1;
 
     for (const auto& module : modules) {
       if (currentStep>=parameter.GetStartStep() &&
@@ -529,10 +647,8 @@ namespace osmscout {
         StopClock timer;
         bool      success;
 
-        progress.SetStep(std::string("Step #")+
-                         NumberToString(currentStep)+
-                         " - "+
-                         module->GetDescription());
+        progress.SetStep(GetStepName(currentStep,
+                                     *module));
 
         success=module->Import(typeConfig,
                                parameter,
@@ -551,6 +667,289 @@ namespace osmscout {
       currentStep++;
     }
 
+    return true;
+  }
+
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_MUTEX)
+  /**
+   * Executes import modules in parallel, respecting the dependencies between
+   * modules as declared by their ImportModuleDescription. At most threadCount
+   * modules are executed in parallel; exclusive modules are always executed
+   * alone.
+   *
+   * The output of the modules is passed to the progress in step order, exactly
+   * as if the steps were executed one after another. The output of the first
+   * not yet finished step is passed through directly, the output of all
+   * following steps is buffered.
+   */
+  class ModuleScheduler
+  {
+  private:
+    enum JobState
+    {
+      jobWaiting,
+      jobRunning,
+      jobFinished
+    };
+
+    struct Job
+    {
+      size_t                            step;
+      ImportModule*                     module;
+      ImportModuleDescription           description;
+      std::vector<size_t>               dependencies; //! Index of jobs that must have finished before
+      JobState                          state;
+      bool                              success;
+      std::string                       time;
+      std::shared_ptr<BufferedProgress> progress;
+      std::thread                       thread;
+    };
+
+  private:
+    const ImportParameter&  parameter;
+    Progress&               progress;
+    const TypeConfigRef&    typeConfig;
+
+    std::mutex              mutex;
+    std::condition_variable jobDone;
+    std::vector<Job>        jobs;
+    size_t                  runningCount;
+    bool                    exclusiveRunning;
+    size_t                  reportedCount;   //! Number of jobs already reported (in step order)
+    bool                    failed;
+
+  private:
+    void ExecuteJob(Job* job);
+
+    bool CanStart(const Job& job) const;
+    void StartJobs();
+    void ReportJobs();
+
+  public:
+    ModuleScheduler(const ImportParameter& parameter,
+                    Progress& progress,
+                    const TypeConfigRef& typeConfig);
+
+    bool Execute(std::list<ImportModule*>& modules);
+  };
+
+  ModuleScheduler::ModuleScheduler(const ImportParameter& parameter,
+                                   Progress& progress,
+                                   const TypeConfigRef& typeConfig)
+  : parameter(parameter),
+    progress(progress),
+    typeConfig(typeConfig),
+    runningCount(0),
+    exclusiveRunning(false),
+    reportedCount(0),
+    failed(false)
+  {
+    // no code
+  }
+
+  /**
+   * Thread entry point
+   */
+  void ModuleScheduler::ExecuteJob(Job* job)
+  {
+    StopClock timer;
+    bool      success;
+
+    success=job->module->Import(typeConfig,
+                                parameter,
+                                *job->progress);
+
+    timer.Stop();
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    job->state=jobFinished;
+    job->success=success;
+    job->time=timer.ResultString();
+
+    runningCount--;
+
+    if (job->description.IsExclusive()) {
+      exclusiveRunning=false;
+    }
+
+    jobDone.notify_one();
+  }
+
+  bool ModuleScheduler::CanStart(const Job& job) const
+  {
+    for (const auto& dependency : job.dependencies) {
+      if (jobs[dependency].state!=jobFinished ||
+          !jobs[dependency].success) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Start all jobs that do not depend on unfinished jobs, as long as the thread
+   * budget allows. Jobs are started in step order. The caller must hold the mutex.
+   */
+  void ModuleScheduler::StartJobs()
+  {
+    for (auto& job : jobs) {
+      if (failed ||
+          exclusiveRunning ||
+          runningCount>=parameter.GetThreadCount()) {
+        return;
+      }
+
+      if (job.state!=jobWaiting ||
+          !CanStart(job)) {
+        continue;
+      }
+
+      if (job.description.IsExclusive()) {
+        if (runningCount>0) {
+          // Do not start later jobs, else the exclusive job might starve
+          return;
+        }
+
+        exclusiveRunning=true;
+      }
+
+      job.state=jobRunning;
+      runningCount++;
+
+      job.thread=std::thread(&ModuleScheduler::ExecuteJob,
+                             this,
+                             &job);
+    }
+  }
+
+  /**
+   * Write the output of all jobs that can be reported in step order. The caller
+   * must hold the mutex.
+   */
+  void ModuleScheduler::ReportJobs()
+  {
+    while (reportedCount<jobs.size()) {
+      Job& job=jobs[reportedCount];
+
+      if (job.state==jobWaiting) {
+        return;
+      }
+
+      if (!job.progress->IsAttached()) {
+        progress.SetStep(GetStepName(job.step,
+                                     *job.module));
+        job.progress->Attach();
+      }
+
+      if (job.state!=jobFinished) {
+        return;
+      }
+
+      job.thread.join();
+
+      progress.Info(std::string("=> ")+job.time+" second(s)");
+
+      if (!job.success) {
+        progress.Error(std::string("Error while executing step '")+job.module->GetDescription()+"'!");
+        failed=true;
+      }
+
+      reportedCount++;
+    }
+  }
+
+  bool ModuleScheduler::Execute(std::list<ImportModule*>& modules)
+  {
+    size_t currentStep=1;
+
+    for (const auto& module : modules) {
+      if (currentStep>=parameter.GetStartStep() &&
+          currentStep<=parameter.GetEndStep()) {
+        Job job;
+
+        job.step=currentStep;
+        job.module=module;
+        job.state=jobWaiting;
+        job.success=false;
+        job.progress=std::make_shared<BufferedProgress>(mutex,
+                                                      progress);
+
+        module->GetModuleDescription(parameter,
+                                     job.description);
+
+        for (size_t j=0; j<jobs.size(); j++) {
+          if (job.description.DependsOn(jobs[j].description)) {
+            job.dependencies.push_back(j);
+          }
+        }
+
+        jobs.push_back(std::move(job));
+      }
+
+      currentStep++;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+      StartJobs();
+      ReportJobs();
+
+      if (reportedCount==jobs.size() ||
+          (failed && runningCount==0)) {
+        break;
+      }
+
+      jobDone.wait(lock);
+    }
+
+    // In case of an error, there might be finished jobs that were not reported,
+    // because a previous step was not executed
+    for (auto& job : jobs) {
+      if (job.thread.joinable()) {
+        job.thread.join();
+      }
+    }
+
+    return !failed;
+  }
+#endif
+
+  static bool ExecuteModules(std::list<ImportModule*>& modules,
+                             const ImportParameter& parameter,
+                             Progress& progress,
+                             const TypeConfigRef& typeConfig)
+  {
+    StopClock overAllTimer;
+    bool      success;
+
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_MUTEX)
+    if (parameter.GetThreadCount()>1) {
+      ModuleScheduler scheduler(parameter,
+                                progress,
+                                typeConfig);
+
+      success=scheduler.Execute(modules);
+    }
+    else {
+      success=ExecuteModulesSequential(modules,
+                                       parameter,
+                                       progress,
+                                       typeConfig);
+    }
+#else
+    success=ExecuteModulesSequential(modules,
+                                     parameter,
+                                     progress,
+                                     typeConfig);
+#endif
+
+    if (!success) {
+      return false;
+    }
+
     overAllTimer.Stop();
     progress.Info(std::string("=> ")+overAllTimer.ResultString()+" second(s)");
 
@@ -665,37 +1064,41 @@ namespace osmscout {
     modules.push_back(new RouteDataGenerator());
 
     /* 24 */
+    modules.push_back(new RouteCHDataGenerator());
+
+    /* 25 */
     modules.push_back(new NumericIndexGenerator<Id,Intersection>(std::string("Generating '")+RoutingService::FILENAME_INTERSECTIONS_IDX+"'",
                                                                  AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                                  RoutingService::FILENAME_INTERSECTIONS_DAT),
                                                                  AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                                  RoutingService::FILENAME_INTERSECTIONS_IDX)));
 
-    /* 25 */
+    /* 26 */
     modules.push_back(new NumericIndexGenerator<Id,RouteNode>(std::string("Generating '")+RoutingService::FILENAME_FOOT_IDX+"'",
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               RoutingService::FILENAME_FOOT_DAT),
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               RoutingService::FILENAME_FOOT_IDX)));
 
-    /* 26 */
+    /* 27 */
     modules.push_back(new NumericIndexGenerator<Id,RouteNode>(std::string("Generating '")+RoutingService::FILENAME_BICYCLE_IDX+"'",
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               RoutingService::FILENAME_BICYCLE_DAT),
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               RoutingService::FILENAME_BICYCLE_IDX)));
 
-    /* 27 */
+    /* 28 */
     modules.push_back(new NumericIndexGenerator<Id,RouteNode>(std::string("Generating '")+RoutingService::FILENAME_CAR_IDX+"'",
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               RoutingService::FILENAME_CAR_DAT),
                                                               AppendFileToDir(parameter.GetDestinationDirectory(),
                                                                               RoutingService::FILENAME_CAR_IDX)));
 
-#if defined(OSMSCOUT_IMPORT_HAVE_LIB_MARISA)
-    /* 28 */
+    /* 29 */
     modules.push_back(new TextIndexGenerator());
-#endif
+
+    /* 30 */
+    modules.push_back(new ReverseLocationIndexGenerator());
 
     bool result=ExecuteModules(modules,
                                parameter,
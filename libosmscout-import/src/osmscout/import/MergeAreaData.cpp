@@ -31,6 +31,18 @@ namespace osmscout {
     return "Merge area data files";
   }
 
+  void MergeAreaDataGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                    ImportModuleDescription& description) const
+  {
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "relarea.tmp"));
+    description.AddRequiredFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "wayarea.tmp"));
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areas.tmp"));
+  }
+
   bool MergeAreaDataGenerator::MergeAreas(const ImportParameter& parameter,
                                           Progress& progress,
                                           const TypeConfig& typeConfig)
@@ -21,6 +21,8 @@
 
 #include <limits>
 
+#include <osmscout/CoordDataFile.h>
+
 #include <osmscout/system/Math.h>
 
 #include <osmscout/util/File.h>
@@ -33,6 +35,7 @@
 #include <osmscout/private/Config.h>
 
 #if defined(HAVE_LIB_XML)
+  #include <osmscout/import/PreprocessOSC.h>
   #include <osmscout/import/PreprocessOSM.h>
 #endif
 
@@ -44,6 +47,15 @@ namespace osmscout {
 
   static uint32_t coordPageSize=64;
 
+  /**
+   * A page range may be extended by unused pages up to a ratio of
+   * 1/coordPageRangeUnusedRatio of its size. For (nearly) dense node ids
+   * (like in the planet file) this results in only a few, large ranges, making
+   * the page index tiny. For sparse node ids ranges only contain used pages and
+   * the file does not grow.
+   */
+  static PageId coordPageRangeUnusedRatio=16;
+
   bool Preprocess::Callback::StoreCurrentPage()
   {
     if (!coordWriter.SetPos(currentPageOffset)) {
@@ -64,12 +76,93 @@ namespace osmscout {
     return !coordWriter.HasError();
   }
 
+  /**
+   * Return the file offset of the given page, if the page is already part
+   * of a page range
+   */
+  bool Preprocess::Callback::GetCoordPageOffset(PageId pageId,
+                                                FileOffset& offset) const
+  {
+    CoordPageRangeMap::const_iterator range=coordPageRanges.upper_bound(pageId);
+
+    if (range==coordPageRanges.begin()) {
+      return false;
+    }
+
+    --range;
+
+    if (pageId-range->first>=range->second.pageCount) {
+      return false;
+    }
+
+    offset=range->second.offset+(pageId-range->first)*coordPageSize*coordByteSize;
+
+    return true;
+  }
+
+  /**
+   * Allocate a new page at the end of the file. If possible, the last page range
+   * gets extended (possibly including unused pages in between), else a new range
+   * is started.
+   */
+  bool Preprocess::Callback::AllocateCoordPage(PageId pageId,
+                                               FileOffset& offset)
+  {
+    offset=coordPageCount*coordPageSize*coordByteSize;
+
+    if (lastCoordPageRange!=coordPageRanges.end()) {
+      PageId                      rangeEnd=lastCoordPageRange->first+lastCoordPageRange->second.pageCount;
+      CoordPageRangeMap::iterator nextRange=lastCoordPageRange;
+
+      ++nextRange;
+
+      if (pageId>=rangeEnd &&
+          (lastCoordPageRange->second.unusedPageCount+pageId-rangeEnd)*coordPageRangeUnusedRatio<=
+           lastCoordPageRange->second.pageCount+pageId-rangeEnd+1 &&
+          (nextRange==coordPageRanges.end() ||
+           nextRange->first>pageId)) {
+        PageId gap=pageId-rangeEnd;
+
+        if (gap>0) {
+          if (!coordWriter.SetPos(offset)) {
+            return false;
+          }
+
+          for (size_t i=0; i<gap*coordPageSize; i++) {
+            coordWriter.WriteInvalidCoord();
+          }
+
+          offset+=gap*coordPageSize*coordByteSize;
+          coordPageCount+=gap;
+        }
+
+        lastCoordPageRange->second.pageCount+=gap+1;
+        lastCoordPageRange->second.unusedPageCount+=gap;
+        coordPageCount++;
+
+        return !coordWriter.HasError();
+      }
+    }
+
+    CoordPageRange range;
+
+    range.pageCount=1;
+    range.unusedPageCount=0;
+    range.offset=offset;
+
+    lastCoordPageRange=coordPageRanges.insert(std::make_pair(pageId,range)).first;
+    coordPageCount++;
+
+    return true;
+  }
+
   bool Preprocess::Callback::StoreCoord(OSMId id,
                                         const GeoCoord& coord)
   {
     PageId     relatedId=id-std::numeric_limits<Id>::min();
     PageId     pageId=relatedId/coordPageSize;
     FileOffset coordPageIndex=relatedId%coordPageSize;
+    FileOffset pageOffset;
 
     if (currentPageId!=std::numeric_limits<PageId>::max()) {
       if (currentPageId==pageId) {
@@ -83,30 +176,28 @@ namespace osmscout {
       }
     }
 
-    CoordPageOffsetMap::const_iterator pageOffsetEntry=coordIndex.find(pageId);
-
     // Do we write a coord to a page, we have not yet written and
     // thus must begin a new page?
-    if (pageOffsetEntry==coordIndex.end()) {
+    if (!GetCoordPageOffset(pageId,
+                            pageOffset)) {
+      if (!AllocateCoordPage(pageId,
+                             pageOffset)) {
+        return false;
+      }
+
       isSet.assign(coordPageSize,false);
 
       coords[coordPageIndex]=coord;
       isSet[coordPageIndex]=true;
 
-      FileOffset pageOffset=coordPageCount*coordPageSize*coordByteSize;
-
       currentPageId=pageId;
       currentPageOffset=pageOffset;
 
-      pageOffsetEntry=coordIndex.insert(std::make_pair(pageId,pageOffset)).first;
-
-      coordPageCount++;
-
       return true;
     }
 
     // We have to update a coord in a page we have already written
-    if (!coordWriter.SetPos(pageOffsetEntry->second+coordPageIndex*coordByteSize)) {
+    if (!coordWriter.SetPos(pageOffset+coordPageIndex*coordByteSize)) {
       return false;
     }
 
@@ -269,6 +360,7 @@ namespace osmscout {
     waySortingError(false),
     relationSortingError(false),
     coordPageCount(0),
+    lastCoordPageRange(coordPageRanges.end()),
     currentPageId(std::numeric_limits<PageId>::max()),
     currentPageOffset(0)
   {
@@ -308,6 +400,8 @@ namespace osmscout {
 
     FileOffset offset=0;
 
+    coordWriter.Write((uint32_t)0);
+    coordWriter.Write(CoordDataFile::fileFormatVersion);
     coordWriter.Write(coordPageSize);
     coordWriter.Write(offset);
     coordWriter.FlushCurrentBlockWithZeros(coordPageSize*coordByteSize);
@@ -630,7 +724,7 @@ namespace osmscout {
 
   bool Preprocess::Callback::Cleanup(bool success)
   {
-    if (currentPageId!=0) {
+    if (currentPageId!=std::numeric_limits<PageId>::max()) {
       StoreCurrentPage();
     }
 
@@ -651,20 +745,21 @@ namespace osmscout {
 
     coordWriter.SetPos(0);
 
+    coordWriter.Write((uint32_t)0);
+    coordWriter.Write(CoordDataFile::fileFormatVersion);
     coordWriter.Write(coordPageSize);
 
-    FileOffset coordIndexOffset=coordPageCount*coordPageSize*2*sizeof(uint32_t);
+    FileOffset coordIndexOffset=coordPageCount*coordPageSize*coordByteSize;
 
     coordWriter.Write(coordIndexOffset);
 
     coordWriter.SetPos(coordIndexOffset);
-    coordWriter.Write((uint32_t)coordIndex.size());
+    coordWriter.Write((uint32_t)coordPageRanges.size());
 
-    for (CoordPageOffsetMap::const_iterator entry=coordIndex.begin();
-         entry!=coordIndex.end();
-         ++entry) {
-      coordWriter.Write(entry->first);
-      coordWriter.Write(entry->second);
+    for (const auto& range : coordPageRanges) {
+      coordWriter.Write(range.first);
+      coordWriter.Write(range.second.pageCount);
+      coordWriter.Write(range.second.offset);
     }
 
     nodeWriter.Close();
@@ -676,7 +771,8 @@ namespace osmscout {
 
     if (success) {
       progress.Info(std::string("Coords:           ")+NumberToString(coordCount));
-      progress.Info(std::string("Coord pages:      ")+NumberToString(coordIndex.size()));
+      progress.Info(std::string("Coord pages:      ")+NumberToString(coordPageCount-1));
+      progress.Info(std::string("Coord ranges:     ")+NumberToString(coordPageRanges.size()));
       progress.Info(std::string("Nodes:            ")+NumberToString(nodeCount));
       progress.Info(std::string("Ways/Areas/Sum:   ")+NumberToString(wayCount)+" "+
                     NumberToString(areaCount)+" "+
@@ -741,17 +837,92 @@ namespace osmscout {
     return "Preprocess";
   }
 
+  void Preprocess::GetModuleDescription(const ImportParameter& parameter,
+                                        ImportModuleDescription& description) const
+  {
+    for (const auto& mapfile : parameter.GetMapfiles()) {
+      description.AddRequiredFile(mapfile);
+    }
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "bounding.dat"));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "coord.dat"));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "distribution.dat"));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "rawcoastline.dat"));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "rawnodes.dat"));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "rawrels.dat"));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "rawturnrestr.dat"));
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "rawways.dat"));
+
+    // Uses multiple threads itself
+    description.SetExclusive(true);
+  }
+
   bool Preprocess::ProcessFiles(const TypeConfigRef& typeConfig,
                                 const ImportParameter& parameter,
                                 Progress& progress,
                                 Callback& callback)
   {
+    PreprocessorCallback* fileCallback=&callback;
+
+    //
+    // Change files (*.osc) are read first and then applied to the objects of all other files
+    //
+
+#if defined(HAVE_LIB_XML)
+    OSMChangeSet changeSet;
+    bool         hasChanges=false;
+#endif
+
+    for (const auto& filename : parameter.GetMapfiles()) {
+      if (filename.length()>=4 &&
+          filename.substr(filename.length()-4)==".osc") {
+
+#if defined(HAVE_LIB_XML)
+        PreprocessOSC preprocess(changeSet);
+
+        if (!preprocess.Import(typeConfig,
+                               parameter,
+                               progress,
+                               filename)) {
+          return false;
+        }
+
+        hasChanges=true;
+#else
+        progress.Error("Support for the OSM change file format is not enabled!");
+        return false;
+#endif
+      }
+    }
+
+#if defined(HAVE_LIB_XML)
+    // Must be created after the change set is complete
+    OSMChangeSetCallback changeSetCallback(callback,
+                                           changeSet);
+
+    if (hasChanges) {
+      fileCallback=&changeSetCallback;
+    }
+#endif
+
     for (const auto& filename : parameter.GetMapfiles()) {
       if (filename.length()>=4 &&
+          filename.substr(filename.length()-4)==".osc") {
+        continue;
+      }
+      else if (filename.length()>=4 &&
           filename.substr(filename.length()-4)==".osm")  {
 
 #if defined(HAVE_LIB_XML)
-        PreprocessOSM preprocess(callback);
+        PreprocessOSM preprocess(*fileCallback);
 
         if (!preprocess.Import(typeConfig,
                                parameter,
@@ -768,7 +939,7 @@ namespace osmscout {
             filename.substr(filename.length()-4)==".pbf") {
 
 #if defined(HAVE_LIB_PROTOBUF)
-        PreprocessPBF preprocess(callback);
+        PreprocessPBF preprocess(*fileCallback);
 
         if (!preprocess.Import(typeConfig,
                                parameter,
@@ -787,6 +958,19 @@ namespace osmscout {
       }
     }
 
+#if defined(HAVE_LIB_XML)
+    if (fileCallback==&changeSetCallback) {
+      progress.SetAction("Applying changes");
+
+      changeSetCallback.Finish();
+
+      progress.Info(NumberToString(changeSetCallback.GetReplacedCount())+" object(s) replaced, "+
+                    NumberToString(changeSetCallback.GetDeletedCount())+" object(s) deleted, "+
+                    NumberToString(changeSetCallback.GetAddedCount())+" object(s) added, "+
+                    NumberToString(changeSetCallback.GetIgnoredCount())+" change(s) outside of the input ignored");
+    }
+#endif
+
     return true;
   }
 
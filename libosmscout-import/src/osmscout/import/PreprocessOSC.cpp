@@ -0,0 +1,704 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/import/PreprocessOSC.h>
+
+#include <iostream>
+#include <limits>
+
+#include <string.h>
+
+#include <libxml/parser.h>
+
+#include <osmscout/util/String.h>
+
+namespace osmscout {
+
+  class ChangeParser
+  {
+    enum Action {
+      actionUnknown,
+      actionCreate,
+      actionModify,
+      actionDelete
+    };
+
+    enum Context {
+      contextUnknown,
+      contextNode,
+      contextWay,
+      contextRelation
+    };
+
+  private:
+    const TypeConfig&                typeConfig;
+    Progress&                        progress;
+    OSMChangeSet&                    changeSet;
+    Action                           action;
+    Context                          context;
+    OSMId                            id;
+    double                           lon,lat;
+    TagMap                           tags;
+    std::vector<OSMId>               nodes;
+    std::vector<RawRelation::Member> members;
+    size_t                           changeCount;
+
+  private:
+    static const xmlChar* GetAttribute(const xmlChar **atts,
+                                       const char* name)
+    {
+      for (size_t i=0; atts!=NULL && atts[i]!=NULL && atts[i+1]!=NULL; i+=2) {
+        if (strcmp((const char*)atts[i],name)==0) {
+          return atts[i+1];
+        }
+      }
+
+      return NULL;
+    }
+
+    bool StartObject(Context context,
+                     const xmlChar **atts)
+    {
+      const xmlChar *idValue=GetAttribute(atts,"id");
+
+      this->context=contextUnknown;
+
+      tags.clear();
+      nodes.clear();
+      members.clear();
+
+      if (action==actionUnknown) {
+        progress.Warning("Object outside of create, modify or delete section, skipping...");
+        return false;
+      }
+
+      if (idValue==NULL ||
+          !StringToNumber((const char*)idValue,id)) {
+        progress.Warning("Cannot parse id of changed object, skipping...");
+        return false;
+      }
+
+      this->context=context;
+
+      return true;
+    }
+
+  public:
+    ChangeParser(const TypeConfig& typeConfig,
+                 Progress& progress,
+                 OSMChangeSet& changeSet)
+    : typeConfig(typeConfig),
+      progress(progress),
+      changeSet(changeSet),
+      action(actionUnknown),
+      context(contextUnknown),
+      changeCount(0)
+    {
+      // no code
+    }
+
+    inline size_t GetChangeCount() const
+    {
+      return changeCount;
+    }
+
+    void StartElement(const xmlChar *name, const xmlChar **atts)
+    {
+      if (strcmp((const char*)name,"create")==0) {
+        action=actionCreate;
+      }
+      else if (strcmp((const char*)name,"modify")==0) {
+        action=actionModify;
+      }
+      else if (strcmp((const char*)name,"delete")==0) {
+        action=actionDelete;
+      }
+      else if (strcmp((const char*)name,"node")==0) {
+        if (!StartObject(contextNode,
+                         atts)) {
+          return;
+        }
+
+        if (action==actionDelete) {
+          // Deleted nodes do not necessarily have coordinates
+          lon=0.0;
+          lat=0.0;
+          return;
+        }
+
+        const xmlChar *latValue=GetAttribute(atts,"lat");
+        const xmlChar *lonValue=GetAttribute(atts,"lon");
+
+        if (latValue==NULL ||
+            lonValue==NULL ||
+            !StringToNumber((const char*)latValue,lat) ||
+            !StringToNumber((const char*)lonValue,lon)) {
+          progress.Warning("Cannot parse coordinates of node "+NumberToString(id)+", skipping...");
+          context=contextUnknown;
+          return;
+        }
+      }
+      else if (strcmp((const char*)name,"way")==0) {
+        StartObject(contextWay,
+                    atts);
+      }
+      else if (strcmp((const char*)name,"relation")==0) {
+        StartObject(contextRelation,
+                    atts);
+      }
+      else if (strcmp((const char*)name,"tag")==0) {
+        if (context==contextUnknown) {
+          return;
+        }
+
+        const xmlChar *keyValue=GetAttribute(atts,"k");
+        const xmlChar *valueValue=GetAttribute(atts,"v");
+
+        if (keyValue==NULL || valueValue==NULL) {
+          progress.Warning("Cannot parse tag, skipping...");
+          return;
+        }
+
+        TagId tagId=typeConfig.GetTagId((const char*)keyValue);
+
+        if (tagId!=tagIgnore) {
+          tags[tagId]=(const char*)valueValue;
+        }
+      }
+      else if (strcmp((const char*)name,"nd")==0) {
+        if (context!=contextWay) {
+          return;
+        }
+
+        const xmlChar *refValue=GetAttribute(atts,"ref");
+        OSMId         node;
+
+        if (refValue==NULL ||
+            !StringToNumber((const char*)refValue,node)) {
+          progress.Warning("Cannot parse node reference of way "+NumberToString(id)+", skipping...");
+          return;
+        }
+
+        nodes.push_back(node);
+      }
+      else if (strcmp((const char*)name,"member")==0) {
+        if (context!=contextRelation) {
+          return;
+        }
+
+        RawRelation::Member member;
+        const xmlChar       *typeValue=GetAttribute(atts,"type");
+        const xmlChar       *refValue=GetAttribute(atts,"ref");
+        const xmlChar       *roleValue=GetAttribute(atts,"role");
+
+        if (typeValue==NULL ||
+            refValue==NULL ||
+            !StringToNumber((const char*)refValue,member.id)) {
+          progress.Warning("Cannot parse member of relation "+NumberToString(id)+", skipping...");
+          return;
+        }
+
+        if (strcmp((const char*)typeValue,"node")==0) {
+          member.type=RawRelation::memberNode;
+        }
+        else if (strcmp((const char*)typeValue,"way")==0) {
+          member.type=RawRelation::memberWay;
+        }
+        else if (strcmp((const char*)typeValue,"relation")==0) {
+          member.type=RawRelation::memberRelation;
+        }
+        else {
+          progress.Warning(std::string("Cannot parse member type '")+(const char*)typeValue+"' of relation "+NumberToString(id)+", skipping...");
+          return;
+        }
+
+        if (roleValue!=NULL) {
+          member.role=(const char*)roleValue;
+        }
+
+        members.push_back(member);
+      }
+    }
+
+    void EndElement(const xmlChar *name)
+    {
+      if (strcmp((const char*)name,"create")==0 ||
+          strcmp((const char*)name,"modify")==0 ||
+          strcmp((const char*)name,"delete")==0) {
+        action=actionUnknown;
+      }
+      else if (strcmp((const char*)name,"node")==0) {
+        if (context!=contextNode) {
+          return;
+        }
+
+        bool                known=changeSet.nodes.find(id)!=changeSet.nodes.end();
+        OSMChangeSet::Node& node=changeSet.nodes[id];
+
+        node.created=(known && node.created) || action==actionCreate;
+        node.deleted=action==actionDelete;
+        node.lon=lon;
+        node.lat=lat;
+        node.tags.swap(tags);
+
+        changeCount++;
+        context=contextUnknown;
+      }
+      else if (strcmp((const char*)name,"way")==0) {
+        if (context!=contextWay) {
+          return;
+        }
+
+        bool               known=changeSet.ways.find(id)!=changeSet.ways.end();
+        OSMChangeSet::Way& way=changeSet.ways[id];
+
+        way.created=(known && way.created) || action==actionCreate;
+        way.deleted=action==actionDelete;
+        way.nodes.swap(nodes);
+        way.tags.swap(tags);
+
+        changeCount++;
+        context=contextUnknown;
+      }
+      else if (strcmp((const char*)name,"relation")==0) {
+        if (context!=contextRelation) {
+          return;
+        }
+
+        bool                    known=changeSet.relations.find(id)!=changeSet.relations.end();
+        OSMChangeSet::Relation& relation=changeSet.relations[id];
+
+        relation.created=(known && relation.created) || action==actionCreate;
+        relation.deleted=action==actionDelete;
+        relation.members.swap(members);
+        relation.tags.swap(tags);
+
+        changeCount++;
+        context=contextUnknown;
+      }
+    }
+  };
+
+  static xmlEntityPtr GetChangeEntity(void* /*data*/, const xmlChar *name)
+  {
+    return xmlGetPredefinedEntity(name);
+  }
+
+  static void StartChangeElement(void *data, const xmlChar *name, const xmlChar **atts)
+  {
+    ChangeParser* parser=static_cast<ChangeParser*>(data);
+
+    parser->StartElement(name,atts);
+  }
+
+  static void EndChangeElement(void *data, const xmlChar *name)
+  {
+    ChangeParser* parser=static_cast<ChangeParser*>(data);
+
+    parser->EndElement(name);
+  }
+
+  static void ChangeStructuredErrorHandler(void* /*data*/, xmlErrorPtr error)
+  {
+    std::cerr << "XML error, line " << error->line << ": " << error->message << std::endl;
+  }
+
+  static void ChangeErrorHandler(void* /*data*/, const char* msg,...)
+  {
+    std::cerr << "XML error:" << msg << std::endl;
+  }
+
+  PreprocessOSC::PreprocessOSC(OSMChangeSet& changeSet)
+  : changeSet(changeSet)
+  {
+    // no code
+  }
+
+  bool PreprocessOSC::Import(const TypeConfigRef& typeConfig,
+                             const ImportParameter& /*parameter*/,
+                             Progress& progress,
+                             const std::string& filename)
+  {
+    progress.SetAction(std::string("Parsing *.osc file '")+filename+"'");
+
+    ChangeParser  parser(*typeConfig,
+                         progress,
+                         changeSet);
+    xmlSAXHandler saxParser;
+
+    memset(&saxParser,0,sizeof(xmlSAXHandler));
+    saxParser.initialized=XML_SAX2_MAGIC;
+    saxParser.getEntity=GetChangeEntity;
+    saxParser.startElement=StartChangeElement;
+    saxParser.endElement=EndChangeElement;
+    saxParser.error=ChangeErrorHandler;
+    saxParser.fatalError=ChangeErrorHandler;
+    saxParser.serror=ChangeStructuredErrorHandler;
+
+    if (xmlSAXUserParseFile(&saxParser,
+                            &parser,
+                            filename.c_str())!=0) {
+      progress.Error(std::string("Cannot parse *.osc file '")+filename+"'");
+      return false;
+    }
+
+    progress.Info(NumberToString(parser.GetChangeCount())+" change(s) read");
+
+    return true;
+  }
+
+  OSMChangeSetCallback::OSMChangeSetCallback(PreprocessorCallback& callback,
+                                             const OSMChangeSet& changeSet)
+  : callback(callback),
+    changeSet(changeSet),
+    nextNode(changeSet.nodes.begin()),
+    nextWay(changeSet.ways.begin()),
+    nextRelation(changeSet.relations.begin()),
+    changeCount(0),
+    appliedChangeCount(0),
+    replacedCount(0),
+    deletedCount(0),
+    addedCount(0),
+    ignoredCount(0)
+  {
+    for (const auto& node : changeSet.nodes) {
+      if (!node.second.created) {
+        changeCount++;
+      }
+    }
+
+    for (const auto& way : changeSet.ways) {
+      if (!way.second.created) {
+        changeCount++;
+      }
+      else if (!way.second.deleted) {
+        referencedNodes.insert(way.second.nodes.begin(),
+                               way.second.nodes.end());
+      }
+    }
+
+    for (const auto& relation : changeSet.relations) {
+      if (!relation.second.created) {
+        changeCount++;
+      }
+      else if (!relation.second.deleted) {
+        for (const auto& member : relation.second.members) {
+          switch (member.type) {
+          case RawRelation::memberNode:
+            referencedNodes.insert(member.id);
+            break;
+          case RawRelation::memberWay:
+            referencedWays.insert(member.id);
+            break;
+          case RawRelation::memberRelation:
+            referencedRelations.insert(member.id);
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  bool OSMChangeSetCallback::IsInInput(double lon,
+                                       double lat) const
+  {
+    return inputBoundingBox.IsValid() &&
+           lon>=inputBoundingBox.GetMinLon() &&
+           lon<=inputBoundingBox.GetMaxLon() &&
+           lat>=inputBoundingBox.GetMinLat() &&
+           lat<=inputBoundingBox.GetMaxLat();
+  }
+
+  bool OSMChangeSetCallback::ReferencesPassedNode(const std::vector<OSMId>& nodes) const
+  {
+    for (const auto& node : nodes) {
+      if (passedNodes.find(node)!=passedNodes.end()) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  bool OSMChangeSetCallback::ReferencesPassedMember(const std::vector<RawRelation::Member>& members) const
+  {
+    for (const auto& member : members) {
+      switch (member.type) {
+      case RawRelation::memberNode:
+        if (passedNodes.find(member.id)!=passedNodes.end()) {
+          return true;
+        }
+        break;
+      case RawRelation::memberWay:
+        if (passedWays.find(member.id)!=passedWays.end()) {
+          return true;
+        }
+        break;
+      case RawRelation::memberRelation:
+        if (passedRelations.find(member.id)!=passedRelations.end()) {
+          return true;
+        }
+        break;
+      }
+    }
+
+    return false;
+  }
+
+  void OSMChangeSetCallback::NodePassed(OSMId id)
+  {
+    if (referencedNodes.find(id)!=referencedNodes.end()) {
+      passedNodes.insert(id);
+    }
+  }
+
+  void OSMChangeSetCallback::WayPassed(OSMId id)
+  {
+    if (referencedWays.find(id)!=referencedWays.end()) {
+      passedWays.insert(id);
+    }
+  }
+
+  void OSMChangeSetCallback::RelationPassed(OSMId id)
+  {
+    if (referencedRelations.find(id)!=referencedRelations.end()) {
+      passedRelations.insert(id);
+    }
+  }
+
+  void OSMChangeSetCallback::PassNodesBefore(OSMId id)
+  {
+    while (nextNode!=changeSet.nodes.end() &&
+           nextNode->first<id) {
+      const OSMChangeSet::Node& node=nextNode->second;
+
+      if (!node.created) {
+        // Changes of existing objects are applied by ProcessNode()
+      }
+      else if (!node.deleted &&
+               IsInInput(node.lon,
+                         node.lat)) {
+        callback.ProcessNode(nextNode->first,
+                             node.lon,
+                             node.lat,
+                             node.tags);
+        NodePassed(nextNode->first);
+        addedCount++;
+      }
+      else {
+        ignoredCount++;
+      }
+
+      ++nextNode;
+    }
+  }
+
+  void OSMChangeSetCallback::PassWaysBefore(OSMId id)
+  {
+    while (nextWay!=changeSet.ways.end() &&
+           nextWay->first<id) {
+      const OSMChangeSet::Way& way=nextWay->second;
+
+      if (!way.created) {
+        // Changes of existing objects are applied by ProcessWay()
+      }
+      else if (!way.deleted &&
+               ReferencesPassedNode(way.nodes)) {
+        // The callback may modify the node list
+        std::vector<OSMId> nodes(way.nodes);
+
+        callback.ProcessWay(nextWay->first,
+                            nodes,
+                            way.tags);
+        WayPassed(nextWay->first);
+        addedCount++;
+      }
+      else {
+        ignoredCount++;
+      }
+
+      ++nextWay;
+    }
+  }
+
+  void OSMChangeSetCallback::PassRelationsBefore(OSMId id)
+  {
+    while (nextRelation!=changeSet.relations.end() &&
+           nextRelation->first<id) {
+      const OSMChangeSet::Relation& relation=nextRelation->second;
+
+      if (!relation.created) {
+        // Changes of existing objects are applied by ProcessRelation()
+      }
+      else if (!relation.deleted &&
+               ReferencesPassedMember(relation.members)) {
+        callback.ProcessRelation(nextRelation->first,
+                                 relation.members,
+                                 relation.tags);
+        RelationPassed(nextRelation->first);
+        addedCount++;
+      }
+      else {
+        ignoredCount++;
+      }
+
+      ++nextRelation;
+    }
+  }
+
+  void OSMChangeSetCallback::ProcessNode(const OSMId& id,
+                                         const double& lon,
+                                         const double& lat,
+                                         const TagMap& tags)
+  {
+    GeoCoord coord(lat,lon);
+
+    if (inputBoundingBox.IsValid()) {
+      inputBoundingBox.Include(GeoBox(coord,coord));
+    }
+    else {
+      inputBoundingBox.Set(coord,coord);
+    }
+
+    PassNodesBefore(id);
+
+    // A created node, that is already part of the input
+    if (nextNode!=changeSet.nodes.end() &&
+        nextNode->first==id) {
+      ++nextNode;
+    }
+
+    OSMChangeSet::NodeMap::const_iterator change=changeSet.nodes.find(id);
+
+    if (change==changeSet.nodes.end()) {
+      callback.ProcessNode(id,
+                           lon,
+                           lat,
+                           tags);
+      NodePassed(id);
+      return;
+    }
+
+    if (!change->second.created) {
+      appliedChangeCount++;
+    }
+
+    if (change->second.deleted) {
+      deletedCount++;
+    }
+    else {
+      callback.ProcessNode(id,
+                           change->second.lon,
+                           change->second.lat,
+                           change->second.tags);
+      NodePassed(id);
+      replacedCount++;
+    }
+  }
+
+  void OSMChangeSetCallback::ProcessWay(const OSMId& id,
+                                        std::vector<OSMId>& nodes,
+                                        const TagMap& tags)
+  {
+    PassWaysBefore(id);
+
+    // A created way, that is already part of the input
+    if (nextWay!=changeSet.ways.end() &&
+        nextWay->first==id) {
+      ++nextWay;
+    }
+
+    OSMChangeSet::WayMap::const_iterator change=changeSet.ways.find(id);
+
+    if (change==changeSet.ways.end()) {
+      callback.ProcessWay(id,
+                          nodes,
+                          tags);
+      WayPassed(id);
+      return;
+    }
+
+    if (!change->second.created) {
+      appliedChangeCount++;
+    }
+
+    if (change->second.deleted) {
+      deletedCount++;
+    }
+    else {
+      std::vector<OSMId> changedNodes(change->second.nodes);
+
+      callback.ProcessWay(id,
+                          changedNodes,
+                          change->second.tags);
+      WayPassed(id);
+      replacedCount++;
+    }
+  }
+
+  void OSMChangeSetCallback::ProcessRelation(const OSMId& id,
+                                             const std::vector<RawRelation::Member>& members,
+                                             const TagMap& tags)
+  {
+    PassRelationsBefore(id);
+
+    // A created relation, that is already part of the input
+    if (nextRelation!=changeSet.relations.end() &&
+        nextRelation->first==id) {
+      ++nextRelation;
+    }
+
+    OSMChangeSet::RelationMap::const_iterator change=changeSet.relations.find(id);
+
+    if (change==changeSet.relations.end()) {
+      callback.ProcessRelation(id,
+                               members,
+                               tags);
+      RelationPassed(id);
+      return;
+    }
+
+    if (!change->second.created) {
+      appliedChangeCount++;
+    }
+
+    if (change->second.deleted) {
+      deletedCount++;
+    }
+    else {
+      callback.ProcessRelation(id,
+                               change->second.members,
+                               change->second.tags);
+      RelationPassed(id);
+      replacedCount++;
+    }
+  }
+
+  void OSMChangeSetCallback::Finish()
+  {
+    PassNodesBefore(std::numeric_limits<OSMId>::max());
+    PassWaysBefore(std::numeric_limits<OSMId>::max());
+    PassRelationsBefore(std::numeric_limits<OSMId>::max());
+
+    // Changes of objects, that were not part of the input
+    if (changeCount>appliedChangeCount) {
+      ignoredCount+=changeCount-appliedChangeCount;
+    }
+  }
+}
@@ -23,6 +23,10 @@
 
 #include <cstdio>
 
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <thread>
+#endif
+
 #if defined(HAVE_FCNTL_H)
   #include <fcntl.h>
 #endif
@@ -39,6 +43,7 @@
 #endif
 
 #include <osmscout/util/File.h>
+#include <osmscout/util/StopClock.h>
 #include <osmscout/util/String.h>
 
 #include "osmscout/import/Preprocess.h"
@@ -49,8 +54,25 @@
 
 namespace osmscout {
 
+  /**
+   * Format the given duration the same way as StopClock::ResultString()
+   */
+  static std::string TimeToString(double duration)
+  {
+    size_t      seconds=(size_t)(duration/1000);
+    size_t      milliseconds=(size_t)(duration-seconds*1000.0);
+    std::string millisString=NumberToString(milliseconds);
+    std::string result=NumberToString(seconds)+".";
+
+    for (size_t i=millisString.length()+1; i<=3; i++) {
+      result+="0";
+    }
+
+    return result+millisString;
+  }
+
   bool PreprocessPBF::GetPos(FILE* file,
-                             FileOffset& pos) const
+                             FileOffset& pos)
   {
 #if defined(HAVE_FSEEKO)
     off_t filepos=ftello(file);
@@ -75,214 +97,175 @@ namespace osmscout {
     return true;
   }
 
-  void PreprocessPBF::AssureBlockSize(uint32_t length)
-  {
-    if (buffer==NULL) {
-      buffer=new char[length];
-      bufferSize=length;
-    }
-    else if (bufferSize<length) {
-      delete buffer;
-      buffer=new char[length];
-      bufferSize=length;
-    }
-  }
-
-  bool PreprocessPBF::ReadBlockHeader(Progress& progress,
-                                      FILE* file,
+  /**
+   * Read the next block header. If the end of the file is reached before the block header,
+   * false is returned and eof is set to true.
+   */
+  bool PreprocessPBF::ReadBlockHeader(FILE* file,
                                       PBF::BlockHeader& blockHeader,
-                                      bool silent)
+                                      std::string& buffer,
+                                      bool& eof,
+                                      std::string& error)
   {
     uint32_t blockHeaderLength;
 
+    eof=false;
+
     if (fread(&blockHeaderLength,4,1,file)!=1) {
-      if (!silent) {
-        progress.Error("Cannot read block header length!");
+      if (feof(file)) {
+        eof=true;
+      }
+      else {
+        error="Cannot read block header length!";
       }
+
       return false;
     }
 
     uint32_t length=ntohl(blockHeaderLength);
 
     if (length==0 || length>MAX_BLOCK_HEADER_SIZE) {
-      progress.Error("Block header size invalid!");
+      error="Block header size invalid!";
       return false;
     }
 
-    AssureBlockSize(length);
+    buffer.resize(length);
 
-    if (fread(buffer,sizeof(char),length,file)!=length) {
-      progress.Error("Cannot read block header!");
-      delete[] buffer;
+    if (fread(&buffer[0],sizeof(char),length,file)!=length) {
+      error="Cannot read block header!";
       return false;
     }
 
-    if (!blockHeader.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse block header!");
+    if (!blockHeader.ParseFromString(buffer)) {
+      error="Cannot parse block header!";
       return false;
     }
 
     return true;
   }
 
-  bool PreprocessPBF::ReadHeaderBlock(Progress& progress,
-                                      FILE* file,
-                                      const PBF::BlockHeader& blockHeader,
-                                      PBF::HeaderBlock& headerBlock)
+  /**
+   * Read the (still encoded) blob following the given block header
+   */
+  bool PreprocessPBF::ReadBlob(FILE* file,
+                               const PBF::BlockHeader& blockHeader,
+                               std::string& data,
+                               std::string& error)
   {
-    PBF::Blob blob;
-
-    uint32_t length = blockHeader.datasize();
+    uint32_t length=blockHeader.datasize();
 
     if (length==0 || length>MAX_BLOB_SIZE) {
-      progress.Error("Blob size invalid!");
+      error="Blob size invalid!";
       return false;
     }
 
-    AssureBlockSize(length);
+    data.resize(length);
 
-    if (fread(buffer,sizeof(char),length,file)!=length) {
-      progress.Error("Cannot read blob!");
+    if (fread(&data[0],sizeof(char),length,file)!=length) {
+      error="Cannot read blob!";
       return false;
     }
 
-    if (!blob.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse blob!");
+    return true;
+  }
+
+  /**
+   * Parse the given blob and return its (uncompressed) content
+   */
+  bool PreprocessPBF::DecodeBlob(const std::string& data,
+                                 std::string& content,
+                                 std::string& error)
+  {
+    PBF::Blob blob;
+
+    if (!blob.ParseFromString(data)) {
+      error="Cannot parse blob!";
       return false;
     }
 
     if (blob.has_raw()) {
-      length=(uint32_t)blob.raw().length();
-      AssureBlockSize(length);
-      memcpy(buffer,blob.raw().data(),length);
+      content=blob.raw();
     }
     else if (blob.has_zlib_data()){
 #if defined(HAVE_LIB_ZLIB)
-      length=blob.raw_size();
-      AssureBlockSize(length);
+      uint32_t length=blob.raw_size();
+
+      if (length==0 || length>MAX_BLOB_SIZE) {
+        error="Uncompressed blob size invalid!";
+        return false;
+      }
+
+      content.resize(length);
 
       z_stream compressedStream;
 
       compressedStream.next_in=(Bytef*)const_cast<char*>(blob.zlib_data().data());
       compressedStream.avail_in=(uint32_t)blob.zlib_data().size();
-      compressedStream.next_out=(Bytef*)buffer;
+      compressedStream.next_out=(Bytef*)&content[0];
       compressedStream.avail_out=length;
       compressedStream.zalloc=Z_NULL;
       compressedStream.zfree=Z_NULL;
       compressedStream.opaque=Z_NULL;
 
       if (inflateInit( &compressedStream)!=Z_OK) {
-        progress.Error("Cannot decode zlib compressed blob data!");
+        error="Cannot decode zlib compressed blob data!";
         return false;
       }
 
       if (inflate(&compressedStream,Z_FINISH)!=Z_STREAM_END) {
-        progress.Error("Cannot decode zlib compressed blob data!");
+        inflateEnd(&compressedStream);
+        error="Cannot decode zlib compressed blob data!";
         return false;
       }
 
       if (inflateEnd(&compressedStream)!=Z_OK) {
-        progress.Error("Cannot decode zlib compressed blob data!");
+        error="Cannot decode zlib compressed blob data!";
         return false;
       }
 #else
-      progress.Error("Data is zlib encoded but zlib support is not enabled!");
+      error="Data is zlib encoded but zlib support is not enabled!";
       return false;
 #endif
     }
-    else if (blob.has_bzip2_data()){
-      progress.Error("Data is bzip2 encoded but bzip2 support is not enabled!");
+    else if (blob.has_bzip2_data()) {
+      error="Data is bzip2 encoded but bzip2 support is not enabled!";
       return false;
     }
-    else if (blob.has_lzma_data()){
-      progress.Error("Data is lzma encoded but lzma support is not enabled!");
+    else if (blob.has_lzma_data()) {
+      error="Data is lzma encoded but lzma support is not enabled!";
       return false;
     }
-
-    if (!headerBlock.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse header block!");
+    else {
+      error="Blob does not contain any data!";
       return false;
     }
 
     return true;
   }
 
-  bool PreprocessPBF::ReadPrimitiveBlock(Progress& progress,
-                                         FILE* file,
-                                         const PBF::BlockHeader& blockHeader,
-                                         PBF::PrimitiveBlock& primitiveBlock)
+  bool PreprocessPBF::ReadHeaderBlock(FILE* file,
+                                      const PBF::BlockHeader& blockHeader,
+                                      PBF::HeaderBlock& headerBlock,
+                                      std::string& error)
   {
-    PBF::Blob blob;
-
-    uint32_t length = blockHeader.datasize();
-
-    if (length==0 || length>MAX_BLOB_SIZE) {
-      progress.Error("Blob size invalid!");
-      return false;
-    }
-
-    AssureBlockSize(length);
-
-    if (fread(buffer,sizeof(char),length,file)!=length) {
-      progress.Error("Cannot read blob!");
-      return false;
-    }
+    std::string data;
+    std::string content;
 
-    if (!blob.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse blob!");
+    if (!ReadBlob(file,
+                  blockHeader,
+                  data,
+                  error)) {
       return false;
     }
 
-    if (blob.has_raw()) {
-      length=(uint32_t)blob.raw().length();
-      AssureBlockSize(length);
-      memcpy(buffer,blob.raw().data(),length);
-    }
-    else if (blob.has_zlib_data()){
-#if defined(HAVE_LIB_ZLIB)
-      length=blob.raw_size();
-      AssureBlockSize(length);
-
-      z_stream compressedStream;
-
-      compressedStream.next_in=(Bytef*)const_cast<char*>(blob.zlib_data().data());
-      compressedStream.avail_in=(uint32_t)blob.zlib_data().size();
-      compressedStream.next_out=(Bytef*)buffer;
-      compressedStream.avail_out=length;
-      compressedStream.zalloc=Z_NULL;
-      compressedStream.zfree=Z_NULL;
-      compressedStream.opaque=Z_NULL;
-
-      if (inflateInit( &compressedStream)!=Z_OK) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        return false;
-      }
-
-      if (inflate(&compressedStream,Z_FINISH)!=Z_STREAM_END) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        return false;
-      }
-
-      if (inflateEnd(&compressedStream)!=Z_OK) {
-        progress.Error("Cannot decode zlib compressed blob data!");
-        return false;
-      }
-#else
-      progress.Error("Data is zlib encoded but zlib support is not enabled!");
-      return false;
-#endif
-    }
-    else if (blob.has_bzip2_data()) {
-      progress.Error("Data is bzip2 encoded but bzip2 support is not enabled!");
-      return false;
-    }
-    else if (blob.has_lzma_data()) {
-      progress.Error("Data is lzma encoded but lzma support is not enabled!");
+    if (!DecodeBlob(data,
+                    content,
+                    error)) {
       return false;
     }
 
-    if (!primitiveBlock.ParseFromArray(buffer,length)) {
-      progress.Error("Cannot parse primitive block!");
+    if (!headerBlock.ParseFromString(content)) {
+      error="Cannot parse header block!";
       return false;
     }
 
@@ -291,31 +274,36 @@ namespace osmscout {
 
   void PreprocessPBF::ReadNodes(const TypeConfig& typeConfig,
                                 const PBF::PrimitiveBlock& block,
-                                const PBF::PrimitiveGroup& group)
+                                const PBF::PrimitiveGroup& group,
+                                RawBlockData& data)
   {
+    data.nodes.reserve(data.nodes.size()+group.nodes_size());
+
     for (int n=0; n<group.nodes_size(); n++) {
       const PBF::Node &inputNode=group.nodes(n);
 
-      tagMap.clear();
+      data.nodes.push_back(RawNodeData());
+
+      RawNodeData& node=data.nodes.back();
 
       for (int t=0; t<inputNode.keys_size(); t++) {
         TagId id=typeConfig.GetTagId(block.stringtable().s(inputNode.keys(t)));
 
         if (id!=tagIgnore) {
-          tagMap[id]=block.stringtable().s(inputNode.vals(t));
+          node.tags[id]=block.stringtable().s(inputNode.vals(t));
         }
       }
 
-      callback.ProcessNode(inputNode.id(),
-                           (inputNode.lon()*block.granularity()+block.lon_offset())/NANO,
-                           (inputNode.lat()*block.granularity()+block.lat_offset())/NANO,
-                           tagMap);
+      node.id=inputNode.id();
+      node.lon=(inputNode.lon()*block.granularity()+block.lon_offset())/NANO;
+      node.lat=(inputNode.lat()*block.granularity()+block.lat_offset())/NANO;
     }
   }
 
   void PreprocessPBF::ReadDenseNodes(const TypeConfig& typeConfig,
                                      const PBF::PrimitiveBlock& block,
-                                     const PBF::PrimitiveGroup& group)
+                                     const PBF::PrimitiveGroup& group,
+                                     RawBlockData& data)
   {
     const PBF::DenseNodes &dense=group.dense();
     Id     dId=0;
@@ -323,12 +311,16 @@ namespace osmscout {
     double dLon=0;
     int    t=0;
 
+    data.nodes.reserve(data.nodes.size()+dense.id_size());
+
     for (int d=0; d<dense.id_size();d++) {
       dId+=dense.id(d);
       dLat+=dense.lat(d);
       dLon+=dense.lon(d);
 
-      tagMap.clear();
+      data.nodes.push_back(RawNodeData());
+
+      RawNodeData& node=data.nodes.back();
 
       while (true) {
         if (t>=dense.keys_vals_size()) {
@@ -343,68 +335,77 @@ namespace osmscout {
         TagId id=typeConfig.GetTagId(block.stringtable().s(dense.keys_vals(t)));
 
         if (id!=tagIgnore) {
-          tagMap[id]=block.stringtable().s(dense.keys_vals(t+1));
+          node.tags[id]=block.stringtable().s(dense.keys_vals(t+1));
         }
 
         t+=2;
       }
 
-      callback.ProcessNode(dId,
-                           (dLon*block.granularity()+block.lon_offset())/NANO,
-                           (dLat*block.granularity()+block.lat_offset())/NANO,
-                           tagMap);
+      node.id=dId;
+      node.lon=(dLon*block.granularity()+block.lon_offset())/NANO;
+      node.lat=(dLat*block.granularity()+block.lat_offset())/NANO;
     }
   }
 
   void PreprocessPBF::ReadWays(const TypeConfig& typeConfig,
                                const PBF::PrimitiveBlock& block,
-                               const PBF::PrimitiveGroup& group)
+                               const PBF::PrimitiveGroup& group,
+                               RawBlockData& data)
   {
+    data.ways.reserve(data.ways.size()+group.ways_size());
+
     for (int w=0; w<group.ways_size(); w++) {
       const PBF::Way &inputWay=group.ways(w);
 
-      nodes.clear();
-      tagMap.clear();
+      data.ways.push_back(RawWayData());
+
+      RawWayData& way=data.ways.back();
 
       for (int t=0; t<inputWay.keys_size(); t++) {
         TagId id=typeConfig.GetTagId(block.stringtable().s(inputWay.keys(t)));
 
         if (id!=tagIgnore) {
-          tagMap[id]=block.stringtable().s(inputWay.vals(t));
+          way.tags[id]=block.stringtable().s(inputWay.vals(t));
         }
       }
 
+      way.id=inputWay.id();
+      way.nodes.reserve(inputWay.refs_size());
+
       unsigned long ref=0;
       for (int r=0; r<inputWay.refs_size(); r++) {
         ref+=inputWay.refs(r);
 
-        nodes.push_back(ref);
+        way.nodes.push_back(ref);
       }
-
-      callback.ProcessWay(inputWay.id(),
-                          nodes,
-                          tagMap);
     }
   }
 
   void PreprocessPBF::ReadRelations(const TypeConfig& typeConfig,
                                     const PBF::PrimitiveBlock& block,
-                                    const PBF::PrimitiveGroup& group)
+                                    const PBF::PrimitiveGroup& group,
+                                    RawBlockData& data)
   {
+    data.relations.reserve(data.relations.size()+group.relations_size());
+
     for (int r=0; r<group.relations_size(); r++) {
       const PBF::Relation &inputRelation=group.relations(r);
 
-      members.clear();
-      tagMap.clear();
+      data.relations.push_back(RawRelationData());
+
+      RawRelationData& relation=data.relations.back();
 
       for (int t=0; t<inputRelation.keys_size(); t++) {
         TagId id=typeConfig.GetTagId(block.stringtable().s(inputRelation.keys(t)));
 
         if (id!=tagIgnore) {
-          tagMap[id]=block.stringtable().s(inputRelation.vals(t));
+          relation.tags[id]=block.stringtable().s(inputRelation.vals(t));
         }
       }
 
+      relation.id=inputRelation.id();
+      relation.members.reserve(inputRelation.types_size());
+
       Id ref=0;
       for (int r=0; r<inputRelation.types_size();r++) {
         RawRelation::Member member;
@@ -426,35 +427,459 @@ namespace osmscout {
         member.id=ref;
         member.role=block.stringtable().s(inputRelation.roles_sid(r));
 
-        members.push_back(member);
+        relation.members.push_back(member);
       }
+    }
+  }
+
+  /**
+   * Decode the given blob as primitive block and convert its content
+   * into data that can be directly handed over to the PreprocessorCallback.
+   *
+   * This method does not access any state of the PreprocessPBF instance and thus
+   * can be called in parallel for different blobs.
+   */
+  bool PreprocessPBF::DecodePrimitiveBlock(const TypeConfig& typeConfig,
+                                           const RawBlob& blob,
+                                           RawBlockData& data,
+                                           std::string& error)
+  {
+    std::string        content;
+    PBF::PrimitiveBlock block;
+
+    if (!DecodeBlob(blob.data,
+                    content,
+                    error)) {
+      return false;
+    }
+
+    if (!block.ParseFromString(content)) {
+      error="Cannot parse primitive block!";
+      return false;
+    }
+
+    data.position=blob.position;
+
+    for (int currentGroup=0;
+         currentGroup<block.primitivegroup_size();
+         currentGroup++) {
+      const PBF::PrimitiveGroup &group=block.primitivegroup(currentGroup);
+
+      if (group.nodes_size()>0) {
+        ReadNodes(typeConfig,
+                  block,
+                  group,
+                  data);
+      }
+      else if (group.ways_size()>0) {
+        ReadWays(typeConfig,
+                 block,
+                 group,
+                 data);
+      }
+      else if (group.relations_size()>0) {
+        ReadRelations(typeConfig,
+                      block,
+                      group,
+                      data);
+      }
+      else if (group.has_dense()) {
+        ReadDenseNodes(typeConfig,
+                       block,
+                       group,
+                       data);
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Hand the content of the given block over to the callback. Nodes are passed first,
+   * then ways and then relations, which is the order of primitive groups in
+   * sorted files.
+   */
+  void PreprocessPBF::ProcessBlock(RawBlockData& data)
+  {
+    for (const auto& node : data.nodes) {
+      callback.ProcessNode(node.id,
+                           node.lon,
+                           node.lat,
+                           node.tags);
+    }
+
+    for (auto& way : data.ways) {
+      callback.ProcessWay(way.id,
+                          way.nodes,
+                          way.tags);
+    }
 
-      callback.ProcessRelation(inputRelation.id(),
-                               members,
-                               tagMap);
+    for (const auto& relation : data.relations) {
+      callback.ProcessRelation(relation.id,
+                               relation.members,
+                               relation.tags);
     }
   }
 
+  bool PreprocessPBF::ImportSequential(const TypeConfig& typeConfig,
+                                       Progress& progress,
+                                       FILE* file,
+                                       FileOffset fileSize)
+  {
+    std::string buffer;
+    std::string error;
+    double      readTime=0.0;
+    double      decodeTime=0.0;
+    double      processTime=0.0;
+
+    while (true) {
+      PBF::BlockHeader blockHeader;
+      RawBlob          blob;
+      RawBlockData     data;
+      bool             eof;
+
+      StopClock readTimer;
+
+      if (!ReadBlockHeader(file,
+                           blockHeader,
+                           buffer,
+                           eof,
+                           error)) {
+        if (eof) {
+          break;
+        }
+
+        progress.Error(error);
+        return false;
+      }
+
+      if (blockHeader.type()!="OSMData") {
+        progress.Error("File is not an OSM PBF file!");
+        return false;
+      }
+
+      if (!ReadBlob(file,
+                    blockHeader,
+                    blob.data,
+                    error)) {
+        progress.Error(error);
+        return false;
+      }
+
+      if (!GetPos(file,
+                  blob.position)) {
+        progress.Error("Cannot read current file position!");
+        return false;
+      }
+
+      readTimer.Stop();
+      readTime+=readTimer.GetMilliseconds();
+
+      StopClock decodeTimer;
+
+      if (!DecodePrimitiveBlock(typeConfig,
+                                blob,
+                                data,
+                                error)) {
+        progress.Error(error);
+        return false;
+      }
+
+      decodeTimer.Stop();
+      decodeTime+=decodeTimer.GetMilliseconds();
+
+      progress.SetProgress(data.position,
+                           fileSize);
+
+      StopClock processTimer;
+
+      ProcessBlock(data);
+
+      processTimer.Stop();
+      processTime+=processTimer.GetMilliseconds();
+    }
+
+    progress.Info("Reading: "+TimeToString(readTime)+
+                  ", decoding: "+TimeToString(decodeTime)+
+                  ", processing: "+TimeToString(processTime));
+
+    return true;
+  }
+
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_MUTEX)
+  /**
+   * Stop all stages of the pipeline, remembering the first error
+   */
+  void PreprocessPBF::AbortPipeline(PipelineState& state,
+                                    const std::string& error)
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    if (!state.aborted) {
+      state.aborted=true;
+      state.error=error;
+    }
+
+    state.blobAvailable.notify_all();
+    state.blockAvailable.notify_all();
+    state.spaceAvailable.notify_all();
+  }
+
+  /**
+   * Reader stage: Reads blobs from the file and puts them into the queue of the
+   * decoder threads, as long as the number of blocks read but not yet processed
+   * is below the limit.
+   */
+  void PreprocessPBF::ReadBlobs(PipelineState& state,
+                                FILE* file)
+  {
+    std::string buffer;
+    std::string error;
+    double      readTime=0.0;
+    size_t      index=0;
+
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(state.mutex);
+
+        while (!state.aborted &&
+               state.blockCount-state.nextBlockIndex>=state.maxPending) {
+          state.spaceAvailable.wait(lock);
+        }
+
+        if (state.aborted) {
+          return;
+        }
+      }
+
+      PBF::BlockHeader blockHeader;
+      RawBlobRef       blob(new RawBlob());
+      bool             eof;
+
+      StopClock readTimer;
+
+      if (!ReadBlockHeader(file,
+                           blockHeader,
+                           buffer,
+                           eof,
+                           error)) {
+        if (eof) {
+          break;
+        }
+
+        AbortPipeline(state,error);
+        return;
+      }
+
+      if (blockHeader.type()!="OSMData") {
+        AbortPipeline(state,"File is not an OSM PBF file!");
+        return;
+      }
+
+      if (!ReadBlob(file,
+                    blockHeader,
+                    blob->data,
+                    error)) {
+        AbortPipeline(state,error);
+        return;
+      }
+
+      if (!GetPos(file,
+                  blob->position)) {
+        AbortPipeline(state,"Cannot read current file position!");
+        return;
+      }
+
+      readTimer.Stop();
+      readTime+=readTimer.GetMilliseconds();
+
+      blob->index=index;
+      index++;
+
+      std::lock_guard<std::mutex> lock(state.mutex);
+
+      state.blobs.push_back(blob);
+      state.blockCount++;
+      state.blobAvailable.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    state.readerFinished=true;
+    state.readTime=readTime;
+    state.blobAvailable.notify_all();
+    state.blockAvailable.notify_all();
+  }
+
+  /**
+   * Decoder stage: Takes blobs from the queue, decodes them and stores the resulting
+   * blocks for processing
+   */
+  void PreprocessPBF::DecodeBlobs(PipelineState& state,
+                                  const TypeConfig& typeConfig)
+  {
+    std::string error;
+    double      decodeTime=0.0;
+
+    while (true) {
+      RawBlobRef blob;
+
+      {
+        std::unique_lock<std::mutex> lock(state.mutex);
+
+        while (!state.aborted &&
+               state.blobs.empty() &&
+               !state.readerFinished) {
+          state.blobAvailable.wait(lock);
+        }
+
+        if (state.aborted ||
+            state.blobs.empty()) {
+          break;
+        }
+
+        blob=state.blobs.front();
+        state.blobs.pop_front();
+      }
+
+      RawBlockDataRef data(new RawBlockData());
+
+      StopClock decodeTimer;
+
+      if (!DecodePrimitiveBlock(typeConfig,
+                                *blob,
+                                *data,
+                                error)) {
+        AbortPipeline(state,error);
+        break;
+      }
+
+      decodeTimer.Stop();
+      decodeTime+=decodeTimer.GetMilliseconds();
+
+      std::lock_guard<std::mutex> lock(state.mutex);
+
+      state.blocks[blob->index]=data;
+
+      if (blob->index==state.nextBlockIndex) {
+        state.blockAvailable.notify_one();
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    state.decodeTime+=decodeTime;
+  }
+
+  /**
+   * Processing stage: Runs in the calling thread and hands the decoded blocks
+   * over to the callback in the order of the blocks in the file.
+   */
+  bool PreprocessPBF::ImportParallel(const TypeConfig& typeConfig,
+                                     Progress& progress,
+                                     FILE* file,
+                                     FileOffset fileSize,
+                                     size_t decoderCount)
+  {
+    PipelineState            state;
+    std::vector<std::thread> decoders;
+    double                   processTime=0.0;
+
+    state.maxPending=4*decoderCount;
+    state.nextBlockIndex=0;
+    state.blockCount=0;
+    state.readerFinished=false;
+    state.aborted=false;
+    state.readTime=0.0;
+    state.decodeTime=0.0;
+
+    std::thread reader(&PreprocessPBF::ReadBlobs,
+                       std::ref(state),
+                       file);
+
+    for (size_t d=0; d<decoderCount; d++) {
+      decoders.push_back(std::thread(&PreprocessPBF::DecodeBlobs,
+                                     std::ref(state),
+                                     std::cref(typeConfig)));
+    }
+
+    while (true) {
+      RawBlockDataRef data;
+
+      {
+        std::unique_lock<std::mutex> lock(state.mutex);
+
+        auto block=state.blocks.find(state.nextBlockIndex);
+
+        while (!state.aborted &&
+               block==state.blocks.end() &&
+               !(state.readerFinished && state.nextBlockIndex==state.blockCount)) {
+          state.blockAvailable.wait(lock);
+
+          block=state.blocks.find(state.nextBlockIndex);
+        }
+
+        if (state.aborted ||
+            block==state.blocks.end()) {
+          break;
+        }
+
+        data=block->second;
+        state.blocks.erase(block);
+        state.nextBlockIndex++;
+        state.spaceAvailable.notify_one();
+      }
+
+      progress.SetProgress(data->position,
+                           fileSize);
+
+      StopClock processTimer;
+
+      ProcessBlock(*data);
+
+      processTimer.Stop();
+      processTime+=processTimer.GetMilliseconds();
+    }
+
+    reader.join();
+
+    for (auto& decoder : decoders) {
+      decoder.join();
+    }
+
+    if (state.aborted) {
+      progress.Error(state.error);
+      return false;
+    }
+
+    progress.Info("Reading: "+TimeToString(state.readTime)+
+                  ", decoding: "+TimeToString(state.decodeTime)+" ("+NumberToString(decoderCount)+" threads)"+
+                  ", processing: "+TimeToString(processTime));
+
+    return true;
+  }
+#endif
+
   PreprocessPBF::PreprocessPBF(PreprocessorCallback& callback)
-  : buffer(NULL),
-    bufferSize(0),
-    callback(callback)
+  : callback(callback)
   {
     // no code
   }
 
   PreprocessPBF::~PreprocessPBF()
   {
-    delete buffer;
+    // no code
   }
 
   bool PreprocessPBF::Import(const TypeConfigRef& typeConfig,
-                             const ImportParameter& /*parameter*/,
+                             const ImportParameter& parameter,
                              Progress& progress,
                              const std::string& filename)
   {
-    FileOffset fileSize;
-    FileOffset currentPosition;
+    FileOffset  fileSize;
+    std::string buffer;
+    std::string error;
+    bool        eof;
 
     progress.SetAction(std::string("Parsing *.osm.pbf file '")+filename+"'");
 
@@ -477,7 +902,12 @@ namespace osmscout {
 
     PBF::BlockHeader blockHeader;
 
-    if (!ReadBlockHeader(progress,file,blockHeader,false)) {
+    if (!ReadBlockHeader(file,
+                         blockHeader,
+                         buffer,
+                         eof,
+                         error)) {
+      progress.Error(eof ? std::string("File '"+filename+"' is empty!") : error);
       fclose(file);
       return false;
     }
@@ -490,10 +920,11 @@ namespace osmscout {
 
     PBF::HeaderBlock headerBlock;
 
-    if (!ReadHeaderBlock(progress,
-                         file,
+    if (!ReadHeaderBlock(file,
                          blockHeader,
-                         headerBlock)) {
+                         headerBlock,
+                         error)) {
+      progress.Error(error);
       fclose(file);
       return false;
     }
@@ -508,75 +939,33 @@ namespace osmscout {
       }
     }
 
-    nodes.reserve(20000);
-    members.reserve(2000);
+    bool result;
 
-    while (true) {
-      PBF::BlockHeader blockHeader;
-
-      if (!GetPos(file,
-                  currentPosition)) {
-        progress.Error("Cannot read current position in '"+filename+"'!");
-        fclose(file);
-        return false;
-      }
-
-      progress.SetProgress(currentPosition,
-                           fileSize);
-
-      if (!ReadBlockHeader(progress,
-                           file,
-                           blockHeader,
-                           true)) {
-        fclose(file);
-        break;
-      }
-
-      if (blockHeader.type()!="OSMData") {
-        progress.Error("File '"+filename+"' is not an OSM PBF file!");
-        fclose(file);
-        return false;
-      }
-
-      PBF::PrimitiveBlock block;
-
-      if (!ReadPrimitiveBlock(progress,
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_MUTEX)
+    if (parameter.GetThreadCount()>1) {
+      // The calling thread processes the blocks, the reader thread is mostly waiting
+      // for I/O, so all other threads decode
+      result=ImportParallel(*typeConfig,
+                            progress,
+                            file,
+                            fileSize,
+                            parameter.GetThreadCount()-1);
+    }
+    else {
+      result=ImportSequential(*typeConfig,
+                              progress,
                               file,
-                              blockHeader,
-                              block)) {
-        fclose(file);
-        return false;
-      }
-
-      for (int currentGroup=0;
-           currentGroup<block.primitivegroup_size();
-           currentGroup++) {
-        const PBF::PrimitiveGroup &group=block.primitivegroup(currentGroup);
-
-        if (group.nodes_size()>0) {
-          ReadNodes(*typeConfig,
-                    block,
-                    group);
-        }
-        else if (group.ways_size()>0) {
-          ReadWays(*typeConfig,
-                   block,
-                   group);
-        }
-        else if (group.relations_size()>0) {
-          ReadRelations(*typeConfig,
-                        block,
-                        group);
-        }
-        else if (group.has_dense()) {
-          ReadDenseNodes(*typeConfig,
-                         block,
-                         group);
-        }
-      }
+                              fileSize);
     }
+#else
+    result=ImportSequential(*typeConfig,
+                            progress,
+                            file,
+                            fileSize);
+#endif
 
-    return true;
+    fclose(file);
+
+    return result;
   }
 }
-
@@ -544,4 +544,14 @@ namespace osmscout {
   {
     return "Sort/copy areas";
   }
+
+  void SortAreaDataGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                   ImportModuleDescription& description) const
+  {
+    SortDataGenerator::GetModuleDescription(parameter,
+                                            description);
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "areaaddress.dat"));
+  }
 }
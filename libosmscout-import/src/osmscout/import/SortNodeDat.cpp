@@ -230,4 +230,14 @@ namespace osmscout {
   {
     return "Sort/copy nodes";
   }
+
+  void SortNodeDataGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                   ImportModuleDescription& description) const
+  {
+    SortDataGenerator::GetModuleDescription(parameter,
+                                            description);
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "nodeaddress.dat"));
+  }
 }
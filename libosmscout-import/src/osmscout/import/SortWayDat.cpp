@@ -445,4 +445,14 @@ namespace osmscout {
     return "Sort/copy ways";
   }
 
+  void SortWayDataGenerator::GetModuleDescription(const ImportParameter& parameter,
+                                                  ImportModuleDescription& description) const
+  {
+    SortDataGenerator::GetModuleDescription(parameter,
+                                            description);
+
+    description.AddProvidedFile(AppendFileToDir(parameter.GetDestinationDirectory(),
+                                                "wayaddress.dat"));
+  }
+
 }
@@ -0,0 +1,348 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <osmscout/TypeConfig.h>
+
+#include <osmscout/import/Import.h>
+#include <osmscout/import/PreprocessOSC.h>
+
+int errors=0;
+
+struct TestObject
+{
+  osmscout::OSMId                            id;
+  double                                     lon;
+  double                                     lat;
+  std::vector<osmscout::OSMId>               nodes;
+  std::vector<osmscout::RawRelation::Member> members;
+  std::string                                name;
+};
+
+class RecordingCallback : public osmscout::PreprocessorCallback
+{
+private:
+  osmscout::TagId         nameTag;
+
+public:
+  std::vector<TestObject> nodes;
+  std::vector<TestObject> ways;
+  std::vector<TestObject> relations;
+
+private:
+  std::string GetName(const osmscout::TagMap& tags) const
+  {
+    osmscout::TagMap::const_iterator name=tags.find(nameTag);
+
+    if (name==tags.end()) {
+      return "";
+    }
+
+    return name->second;
+  }
+
+public:
+  RecordingCallback(osmscout::TagId nameTag)
+  : nameTag(nameTag)
+  {
+    // no code
+  }
+
+  void ProcessNode(const osmscout::OSMId& id,
+                   const double& lon, const double& lat,
+                   const osmscout::TagMap& tags)
+  {
+    TestObject node;
+
+    node.id=id;
+    node.lon=lon;
+    node.lat=lat;
+    node.name=GetName(tags);
+
+    nodes.push_back(node);
+  }
+
+  void ProcessWay(const osmscout::OSMId& id,
+                  std::vector<osmscout::OSMId>& nodes,
+                  const osmscout::TagMap& tags)
+  {
+    TestObject way;
+
+    way.id=id;
+    way.lon=0.0;
+    way.lat=0.0;
+    way.nodes=nodes;
+    way.name=GetName(tags);
+
+    ways.push_back(way);
+  }
+
+  void ProcessRelation(const osmscout::OSMId& id,
+                       const std::vector<osmscout::RawRelation::Member>& members,
+                       const osmscout::TagMap& tags)
+  {
+    TestObject relation;
+
+    relation.id=id;
+    relation.lon=0.0;
+    relation.lat=0.0;
+    relation.members=members;
+    relation.name=GetName(tags);
+
+    relations.push_back(relation);
+  }
+};
+
+/**
+ * Creates a node inside and a node outside of the input, ways and relations
+ * referencing them or only objects of the input, modifies and deletes
+ * objects of the input and objects not part of the input.
+ */
+static bool WriteFirstChangeFile(const std::string& filename)
+{
+  std::ofstream out(filename.c_str());
+
+  out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
+  out << "<osmChange version=\"0.6\">" << std::endl;
+
+  out << " <create>" << std::endl;
+  out << "  <node id=\"100\" lat=\"10.05\" lon=\"20.05\" version=\"1\"><tag k=\"name\" v=\"Created\"/></node>" << std::endl;
+  out << "  <node id=\"101\" lat=\"50.0\" lon=\"50.0\" version=\"1\"/>" << std::endl;
+  out << "  <way id=\"110\" version=\"1\"><nd ref=\"100\"/><nd ref=\"1\"/><tag k=\"name\" v=\"Created\"/></way>" << std::endl;
+  out << "  <way id=\"111\" version=\"1\"><nd ref=\"1\"/><nd ref=\"3\"/></way>" << std::endl;
+  out << "  <way id=\"112\" version=\"1\"><nd ref=\"101\"/><nd ref=\"1\"/></way>" << std::endl;
+  out << "  <relation id=\"120\" version=\"1\"><member type=\"way\" ref=\"110\" role=\"outer\"/><tag k=\"name\" v=\"Created\"/></relation>" << std::endl;
+  out << "  <relation id=\"121\" version=\"1\"><member type=\"way\" ref=\"12\" role=\"outer\"/></relation>" << std::endl;
+  out << " </create>" << std::endl;
+
+  out << " <modify>" << std::endl;
+  out << "  <node id=\"2\" lat=\"10.02\" lon=\"20.03\" version=\"2\"><tag k=\"name\" v=\"Modified\"/></node>" << std::endl;
+  out << "  <node id=\"200\" lat=\"10.05\" lon=\"20.05\" version=\"2\"/>" << std::endl;
+  out << "  <way id=\"11\" version=\"2\"><nd ref=\"2\"/><nd ref=\"100\"/><tag k=\"name\" v=\"Modified\"/></way>" << std::endl;
+  out << "  <way id=\"210\" version=\"2\"><nd ref=\"1\"/><nd ref=\"2\"/></way>" << std::endl;
+  out << "  <relation id=\"20\" version=\"2\"><member type=\"way\" ref=\"11\" role=\"outer\"/><tag k=\"name\" v=\"Modified\"/></relation>" << std::endl;
+  out << "  <relation id=\"220\" version=\"2\"><member type=\"way\" ref=\"11\" role=\"outer\"/></relation>" << std::endl;
+  out << " </modify>" << std::endl;
+
+  out << " <delete>" << std::endl;
+  out << "  <node id=\"4\" version=\"3\"/>" << std::endl;
+  out << "  <node id=\"300\" version=\"3\"/>" << std::endl;
+  out << "  <way id=\"12\" version=\"3\"/>" << std::endl;
+  out << "  <relation id=\"21\" version=\"3\"/>" << std::endl;
+  out << " </delete>" << std::endl;
+
+  out << "</osmChange>" << std::endl;
+
+  out.close();
+
+  return !out.fail();
+}
+
+/**
+ * Later changes replace earlier changes, created objects stay created
+ */
+static bool WriteSecondChangeFile(const std::string& filename)
+{
+  std::ofstream out(filename.c_str());
+
+  out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
+  out << "<osmChange version=\"0.6\">" << std::endl;
+  out << " <modify>" << std::endl;
+  out << "  <node id=\"100\" lat=\"10.06\" lon=\"20.06\" version=\"2\"><tag k=\"name\" v=\"Created and modified\"/></node>" << std::endl;
+  out << " </modify>" << std::endl;
+  out << "</osmChange>" << std::endl;
+
+  out.close();
+
+  return !out.fail();
+}
+
+static void PassNodes(osmscout::PreprocessorCallback& callback,
+                      osmscout::OSMId from,
+                      osmscout::OSMId to)
+{
+  osmscout::TagMap tags;
+
+  for (osmscout::OSMId id=from; id<=to; id++) {
+    callback.ProcessNode(id,20.00+(id-1)*0.02,10.00+(id-1)*0.02,tags);
+  }
+}
+
+static void PassWay(osmscout::PreprocessorCallback& callback,
+                    osmscout::OSMId id,
+                    osmscout::OSMId firstNode)
+{
+  osmscout::TagMap             tags;
+  std::vector<osmscout::OSMId> nodes;
+
+  nodes.push_back(firstNode);
+  nodes.push_back(firstNode+1);
+  callback.ProcessWay(id,nodes,tags);
+}
+
+static void PassRelation(osmscout::PreprocessorCallback& callback,
+                         osmscout::OSMId id,
+                         osmscout::OSMId firstWay,
+                         osmscout::OSMId lastWay)
+{
+  osmscout::TagMap                           tags;
+  std::vector<osmscout::RawRelation::Member> members;
+  osmscout::RawRelation::Member              member;
+
+  member.type=osmscout::RawRelation::memberWay;
+  member.role="outer";
+
+  for (osmscout::OSMId way=firstWay; way<=lastWay; way++) {
+    member.id=way;
+    members.push_back(member);
+  }
+
+  callback.ProcessRelation(id,members,tags);
+}
+
+/**
+ * Nodes 1-5, ways 10-12 and relations 20 and 21, either as one file or
+ * split into two files, each holding its nodes, ways and relations
+ */
+static void PassInput(osmscout::PreprocessorCallback& callback,
+                      bool split)
+{
+  if (split) {
+    PassNodes(callback,1,3);
+    PassWay(callback,10,1);
+    PassWay(callback,11,2);
+    PassRelation(callback,20,10,11);
+
+    PassNodes(callback,4,5);
+    PassWay(callback,12,3);
+    PassRelation(callback,21,12,12);
+  }
+  else {
+    PassNodes(callback,1,5);
+    PassWay(callback,10,1);
+    PassWay(callback,11,2);
+    PassWay(callback,12,3);
+    PassRelation(callback,20,10,11);
+    PassRelation(callback,21,12,12);
+  }
+}
+
+static void CheckObjects(const std::string& kind,
+                         const std::vector<TestObject>& objects,
+                         const osmscout::OSMId expectedIds[],
+                         const char* const expectedNames[],
+                         size_t expectedCount)
+{
+  if (objects.size()!=expectedCount) {
+    std::cerr << objects.size() << " " << kind << "(s) instead of " << expectedCount << "!" << std::endl;
+    errors++;
+    return;
+  }
+
+  for (size_t i=0; i<expectedCount; i++) {
+    if (objects[i].id!=expectedIds[i] ||
+        objects[i].name!=expectedNames[i]) {
+      std::cerr << kind << " " << objects[i].id << " '" << objects[i].name << "' instead of " << expectedIds[i] << " '" << expectedNames[i] << "'!" << std::endl;
+      errors++;
+    }
+  }
+}
+
+static void CheckChangeSet(const osmscout::TypeConfigRef& typeConfig,
+                           const osmscout::OSMChangeSet& changeSet,
+                           bool split)
+{
+  RecordingCallback              recorder(typeConfig->GetTagId("name"));
+  osmscout::OSMChangeSetCallback changeSetCallback(recorder,
+                                                   changeSet);
+
+  PassInput(changeSetCallback,split);
+  changeSetCallback.Finish();
+
+  // Way 112 references the input node 1, but not the ignored node 101,
+  // relation 121 only references the deleted way 12
+  const osmscout::OSMId expectedNodeIds[]={1,2,3,5,100};
+  const char* const     expectedNodeNames[]={"","Modified","","","Created and modified"};
+  const osmscout::OSMId expectedWayIds[]={10,11,110,111,112};
+  const char* const     expectedWayNames[]={"","Modified","Created","",""};
+  const osmscout::OSMId expectedRelationIds[]={20,120};
+  const char* const     expectedRelationNames[]={"Modified","Created"};
+
+  CheckObjects("Node",recorder.nodes,expectedNodeIds,expectedNodeNames,5);
+  CheckObjects("Way",recorder.ways,expectedWayIds,expectedWayNames,5);
+  CheckObjects("Relation",recorder.relations,expectedRelationIds,expectedRelationNames,2);
+
+  // Modified geometry and members
+  if (recorder.nodes.size()>=2 &&
+      (recorder.nodes[1].lat!=10.02 || recorder.nodes[1].lon!=20.03)) {
+    std::cerr << "Node 2 has not been moved!" << std::endl;
+    errors++;
+  }
+
+  if (recorder.ways.size()>=2 &&
+      (recorder.ways[1].nodes.size()!=2 || recorder.ways[1].nodes[1]!=100)) {
+    std::cerr << "Nodes of way 11 have not been replaced!" << std::endl;
+    errors++;
+  }
+
+  if (recorder.relations.size()>=1 &&
+      (recorder.relations[0].members.size()!=1 || recorder.relations[0].members[0].id!=11)) {
+    std::cerr << "Members of relation 20 have not been replaced!" << std::endl;
+    errors++;
+  }
+
+  if (changeSetCallback.GetReplacedCount()!=3 ||
+      changeSetCallback.GetDeletedCount()!=3 ||
+      changeSetCallback.GetAddedCount()!=5 ||
+      changeSetCallback.GetIgnoredCount()!=6) {
+    std::cerr << "Wrong statistics: " << changeSetCallback.GetReplacedCount() << " replaced, " << changeSetCallback.GetDeletedCount() << " deleted, " << changeSetCallback.GetAddedCount() << " added, " << changeSetCallback.GetIgnoredCount() << " ignored!" << std::endl;
+    errors++;
+  }
+}
+
+int main()
+{
+  if (!WriteFirstChangeFile("ChangeSet1.osc") ||
+      !WriteSecondChangeFile("ChangeSet2.osc")) {
+    std::cerr << "Cannot write test data!" << std::endl;
+    return 1;
+  }
+
+  osmscout::TypeConfigRef   typeConfig(new osmscout::TypeConfig());
+  osmscout::ImportParameter parameter;
+  osmscout::SilentProgress  progress;
+  osmscout::OSMChangeSet    changeSet;
+
+  if (!typeConfig->LoadFromOSTFile(TEST_TYPEFILE)) {
+    std::cerr << "Cannot load type configuration!" << std::endl;
+    return 1;
+  }
+
+  // As done by the import
+  typeConfig->RegisterNameTag("name",0);
+
+  osmscout::PreprocessOSC preprocess(changeSet);
+
+  if (!preprocess.Import(typeConfig,
+                         parameter,
+                         progress,
+                         "ChangeSet1.osc") ||
+      !preprocess.Import(typeConfig,
+                         parameter,
+                         progress,
+                         "ChangeSet2.osc")) {
+    std::cerr << "Cannot parse change files!" << std::endl;
+    return 1;
+  }
+
+  CheckChangeSet(typeConfig,changeSet,false);
+  CheckChangeSet(typeConfig,changeSet,true);
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
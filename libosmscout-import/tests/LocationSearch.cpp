@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <osmscout/Database.h>
+#include <osmscout/LocationSearchIndex.h>
+#include <osmscout/LocationService.h>
+
+#include <osmscout/util/File.h>
+
+#include <osmscout/import/Import.h>
+
+int errors=0;
+
+struct TestNode
+{
+  osmscout::Id id;
+  double       lat;
+  double       lon;
+};
+
+/**
+ * A country with two cities, the names of the cities share a common suffix,
+ * both cities have a street with the same name
+ */
+static const TestNode countryNodes[]={{1,10.00,20.00},{2,10.00,20.60},{3,10.50,20.60},{4,10.50,20.00}};
+static const TestNode firstCityNodes[]={{11,10.05,20.05},{12,10.05,20.15},{13,10.15,20.15},{14,10.15,20.05}};
+static const TestNode secondCityNodes[]={{21,10.30,20.30},{22,10.30,20.40},{23,10.40,20.40},{24,10.40,20.30}};
+static const TestNode firstStreetNodes[]={{31,10.08,20.06},{32,10.08,20.14}};
+static const TestNode secondStreetNodes[]={{41,10.12,20.06},{42,10.12,20.14}};
+static const TestNode thirdStreetNodes[]={{51,10.35,20.31},{52,10.35,20.39}};
+
+static const char* const searchPatterns[]={"Musterstadt",
+                                           "stadt",
+                                           "Mu",
+                                           "Testland",
+                                           "Main Street Musterstadt",
+                                           "Musterstadt Main Street 12",
+                                           "Main Street 1 Beispielstadt",
+                                           "Main Beispielstadt",
+                                           "Station Musterstadt",
+                                           "Post Testland",
+                                           "Musterstadt Zur Post",
+                                           "Nowhere"};
+
+static void WriteNodes(std::ofstream& out,
+                       const TestNode nodes[],
+                       size_t count)
+{
+  for (size_t i=0; i<count; i++) {
+    out << " <node id=\"" << nodes[i].id << "\" lat=\"" << nodes[i].lat << "\" lon=\"" << nodes[i].lon << "\" version=\"1\"/>" << std::endl;
+  }
+}
+
+static void WriteBoundary(std::ofstream& out,
+                          osmscout::Id id,
+                          const TestNode nodes[],
+                          size_t count,
+                          const std::string& name,
+                          const std::string& adminLevel)
+{
+  out << " <way id=\"" << id << "\" version=\"1\">" << std::endl;
+
+  for (size_t i=0; i<=count; i++) {
+    out << "  <nd ref=\"" << nodes[i%count].id << "\"/>" << std::endl;
+  }
+
+  out << "  <tag k=\"boundary\" v=\"administrative\"/>" << std::endl;
+  out << "  <tag k=\"admin_level\" v=\"" << adminLevel << "\"/>" << std::endl;
+  out << "  <tag k=\"name\" v=\"" << name << "\"/>" << std::endl;
+  out << " </way>" << std::endl;
+}
+
+static void WriteStreet(std::ofstream& out,
+                        osmscout::Id id,
+                        const TestNode nodes[],
+                        size_t count,
+                        const std::string& name)
+{
+  out << " <way id=\"" << id << "\" version=\"1\">" << std::endl;
+
+  for (size_t i=0; i<count; i++) {
+    out << "  <nd ref=\"" << nodes[i].id << "\"/>" << std::endl;
+  }
+
+  out << "  <tag k=\"highway\" v=\"residential\"/>" << std::endl;
+  out << "  <tag k=\"name\" v=\"" << name << "\"/>" << std::endl;
+  out << " </way>" << std::endl;
+}
+
+static void WriteRestaurant(std::ofstream& out,
+                            osmscout::Id id,
+                            double lat,
+                            double lon,
+                            const std::string& name,
+                            const std::string& street,
+                            const std::string& houseNumber)
+{
+  out << " <node id=\"" << id << "\" lat=\"" << lat << "\" lon=\"" << lon << "\" version=\"1\">" << std::endl;
+  out << "  <tag k=\"amenity\" v=\"restaurant\"/>" << std::endl;
+  out << "  <tag k=\"name\" v=\"" << name << "\"/>" << std::endl;
+  out << "  <tag k=\"addr:street\" v=\"" << street << "\"/>" << std::endl;
+  out << "  <tag k=\"addr:housenumber\" v=\"" << houseNumber << "\"/>" << std::endl;
+  out << " </node>" << std::endl;
+}
+
+static bool WriteTestData(const std::string& filename)
+{
+  std::ofstream out(filename.c_str());
+
+  out.precision(10);
+
+  out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
+  out << "<osm version=\"0.6\">" << std::endl;
+
+  WriteNodes(out,countryNodes,4);
+  WriteNodes(out,firstCityNodes,4);
+  WriteNodes(out,secondCityNodes,4);
+  WriteNodes(out,firstStreetNodes,2);
+  WriteNodes(out,secondStreetNodes,2);
+  WriteNodes(out,thirdStreetNodes,2);
+
+  WriteRestaurant(out,61,10.081,20.07,"Zur Post","Main Street","1");
+  WriteRestaurant(out,62,10.081,20.09,"Mainhof","Main Street","12");
+  WriteRestaurant(out,63,10.121,20.08,"Zur Bahn","Station Street","3");
+  WriteRestaurant(out,64,10.351,20.35,"Post","Main Street","1");
+
+  WriteBoundary(out,1,countryNodes,4,"Testland","2");
+  WriteBoundary(out,2,firstCityNodes,4,"Musterstadt","8");
+  WriteBoundary(out,3,secondCityNodes,4,"Beispielstadt","8");
+
+  WriteStreet(out,4,firstStreetNodes,2,"Main Street");
+  WriteStreet(out,5,secondStreetNodes,2,"Station Street");
+  WriteStreet(out,6,thirdStreetNodes,2,"Main Street");
+
+  out << "</osm>" << std::endl;
+
+  out.close();
+
+  return !out.fail();
+}
+
+/**
+ * Returns a description of every result entry that only depends on
+ * the referenced objects and the match qualities
+ */
+static std::vector<std::string> GetResultKeys(const osmscout::LocationSearchResult& result)
+{
+  std::vector<std::string> keys;
+
+  for (const auto& entry : result.results) {
+    std::ostringstream key;
+
+    if (entry.adminRegion) {
+      key << "region " << entry.adminRegion->regionOffset << " '" << entry.adminRegion->aliasName << "' " << entry.adminRegionMatchQuality;
+    }
+
+    if (entry.poi) {
+      key << ", poi " << entry.poi->object.GetName() << " " << entry.poiMatchQuality;
+    }
+
+    if (entry.location) {
+      key << ", location " << entry.location->locationOffset << " " << entry.locationMatchQuality;
+    }
+
+    if (entry.address) {
+      key << ", address " << entry.address->addressOffset << " " << entry.addressMatchQuality;
+    }
+
+    keys.push_back(key.str());
+  }
+
+  std::sort(keys.begin(),
+            keys.end());
+
+  return keys;
+}
+
+static bool Search(const osmscout::DatabaseRef& database,
+                   const std::string& pattern,
+                   std::vector<std::string>& keys)
+{
+  osmscout::LocationService      locationService(database);
+  osmscout::LocationSearch       search;
+  osmscout::LocationSearchResult result;
+
+  search.limit=1000;
+
+  if (!locationService.InitializeLocationSearchEntries(pattern,
+                                                       search) ||
+      !locationService.SearchForLocations(search,
+                                          result)) {
+    std::cerr << "Search for '" << pattern << "' failed!" << std::endl;
+    return false;
+  }
+
+  if (result.limitReached) {
+    std::cerr << "Search for '" << pattern << "' reached the limit!" << std::endl;
+    errors++;
+  }
+
+  keys=GetResultKeys(result);
+
+  return true;
+}
+
+int main()
+{
+  if (!WriteTestData("LocationSearch.osm")) {
+    std::cerr << "Cannot write test data!" << std::endl;
+    return 1;
+  }
+
+  osmscout::ImportParameter parameter;
+  osmscout::SilentProgress  progress;
+  std::list<std::string>    mapfiles;
+
+  mapfiles.push_back("LocationSearch.osm");
+
+  parameter.SetMapfiles(mapfiles);
+  parameter.SetTypefile(TEST_TYPEFILE);
+  parameter.SetDestinationDirectory(".");
+
+  if (!osmscout::Import(parameter,
+                        progress)) {
+    std::cerr << "Import failed!" << std::endl;
+    return 1;
+  }
+
+  size_t                                 patternCount=sizeof(searchPatterns)/sizeof(searchPatterns[0]);
+  std::vector<std::vector<std::string> > indexResults(patternCount);
+  osmscout::DatabaseParameter            databaseParameter;
+  osmscout::DatabaseRef                  database(new osmscout::Database(databaseParameter));
+
+  if (!database->Open(".")) {
+    std::cerr << "Cannot open database!" << std::endl;
+    return 1;
+  }
+
+  if (!database->GetLocationSearchIndex()) {
+    std::cerr << "Cannot load location search index!" << std::endl;
+    return 1;
+  }
+
+  for (size_t i=0; i<patternCount; i++) {
+    if (!Search(database,
+                searchPatterns[i],
+                indexResults[i])) {
+      return 1;
+    }
+  }
+
+  database->Close();
+
+  // Without the index all searches traverse the region tree
+  if (std::remove(osmscout::AppendFileToDir(".",
+                                            osmscout::LocationSearchIndex::FILENAME_LOCATION_SEARCH_IDX).c_str())!=0) {
+    std::cerr << "Cannot remove location search index!" << std::endl;
+    return 1;
+  }
+
+  database=std::make_shared<osmscout::Database>(databaseParameter);
+
+  if (!database->Open(".")) {
+    std::cerr << "Cannot open database!" << std::endl;
+    return 1;
+  }
+
+  if (database->GetLocationSearchIndex()) {
+    std::cerr << "Location search index is still available!" << std::endl;
+    return 1;
+  }
+
+  for (size_t i=0; i<patternCount; i++) {
+    std::vector<std::string> scanResults;
+
+    if (!Search(database,
+                searchPatterns[i],
+                scanResults)) {
+      return 1;
+    }
+
+    if (indexResults[i]!=scanResults) {
+      std::cerr << "Search for '" << searchPatterns[i] << "' returned different results with and without index:" << std::endl;
+
+      for (const auto& key : indexResults[i]) {
+        std::cerr << "  index: " << key << std::endl;
+      }
+
+      for (const auto& key : scanResults) {
+        std::cerr << "  scan:  " << key << std::endl;
+      }
+
+      errors++;
+    }
+  }
+
+  // Make sure that the search found the test data at all
+  if (indexResults[0].empty() ||
+      indexResults[4].empty() ||
+      indexResults[5].empty() ||
+      indexResults[9].empty()) {
+    std::cerr << "Search did not find the test data!" << std::endl;
+    errors++;
+  }
+
+  database->Close();
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
@@ -0,0 +1,307 @@
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <osmscout/Database.h>
+#include <osmscout/ReverseLocationIndex.h>
+
+#include <osmscout/util/Geometry.h>
+
+#include <osmscout/import/Import.h>
+
+int errors=0;
+
+struct TestNode
+{
+  osmscout::Id id;
+  double       lat;
+  double       lon;
+};
+
+/**
+ * Country with a hole, the enclave fills the hole and shares its nodes
+ */
+static const TestNode countryNodes[]={{1,10.00,20.00},{2,10.02,20.61},{3,10.51,20.63},{4,10.48,19.97}};
+static const TestNode holeNodes[]={{11,10.15,20.20},{12,10.17,20.45},{13,10.33,20.43},{14,10.30,20.18}};
+static const TestNode childNodes[]={{21,10.05,20.05},{22,10.06,20.15},{23,10.12,20.16},{24,10.10,20.04}};
+
+class RegionCollectorVisitor : public osmscout::AdminRegionVisitor
+{
+public:
+  std::list<osmscout::AdminRegion> regions;
+
+public:
+  Action Visit(const osmscout::AdminRegion& region)
+  {
+    regions.push_back(region);
+
+    return visitChildren;
+  }
+};
+
+struct Region
+{
+  std::string                                   name;
+  std::vector<std::vector<osmscout::GeoCoord> > rings;
+};
+
+static void WriteNodes(std::ofstream& out,
+                       const TestNode nodes[],
+                       size_t count)
+{
+  for (size_t i=0; i<count; i++) {
+    out << " <node id=\"" << nodes[i].id << "\" lat=\"" << nodes[i].lat << "\" lon=\"" << nodes[i].lon << "\" version=\"1\"/>" << std::endl;
+  }
+}
+
+static void WriteWay(std::ofstream& out,
+                     osmscout::Id id,
+                     const TestNode nodes[],
+                     size_t count,
+                     const std::string& name,
+                     const std::string& adminLevel)
+{
+  out << " <way id=\"" << id << "\" version=\"1\">" << std::endl;
+
+  for (size_t i=0; i<=count; i++) {
+    out << "  <nd ref=\"" << nodes[i%count].id << "\"/>" << std::endl;
+  }
+
+  if (!name.empty()) {
+    out << "  <tag k=\"boundary\" v=\"administrative\"/>" << std::endl;
+    out << "  <tag k=\"admin_level\" v=\"" << adminLevel << "\"/>" << std::endl;
+    out << "  <tag k=\"name\" v=\"" << name << "\"/>" << std::endl;
+  }
+
+  out << " </way>" << std::endl;
+}
+
+static bool WriteTestData(const std::string& filename)
+{
+  std::ofstream out(filename.c_str());
+
+  out.precision(10);
+
+  out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
+  out << "<osm version=\"0.6\">" << std::endl;
+
+  WriteNodes(out,countryNodes,4);
+  WriteNodes(out,holeNodes,4);
+  WriteNodes(out,childNodes,4);
+
+  WriteWay(out,1,countryNodes,4,"","");
+  WriteWay(out,2,holeNodes,4,"","");
+  WriteWay(out,3,holeNodes,4,"Enclave","2");
+  WriteWay(out,4,childNodes,4,"Child","8");
+
+  out << " <relation id=\"1\" version=\"1\">" << std::endl;
+  out << "  <member type=\"way\" ref=\"1\" role=\"outer\"/>" << std::endl;
+  out << "  <member type=\"way\" ref=\"2\" role=\"inner\"/>" << std::endl;
+  out << "  <tag k=\"type\" v=\"boundary\"/>" << std::endl;
+  out << "  <tag k=\"boundary\" v=\"administrative\"/>" << std::endl;
+  out << "  <tag k=\"admin_level\" v=\"2\"/>" << std::endl;
+  out << "  <tag k=\"name\" v=\"Country\"/>" << std::endl;
+  out << " </relation>" << std::endl;
+
+  out << "</osm>" << std::endl;
+
+  out.close();
+
+  return !out.fail();
+}
+
+/**
+ * A coordinate is within a region, if it is within an odd number of its rings
+ */
+static std::set<osmscout::FileOffset> GetExpectedRegions(const std::map<osmscout::FileOffset,Region>& regions,
+                                                         const osmscout::GeoCoord& coord)
+{
+  std::set<osmscout::FileOffset> result;
+
+  for (const auto& region : regions) {
+    bool inside=false;
+
+    for (const auto& ring : region.second.rings) {
+      if (osmscout::IsCoordInArea(coord,ring)) {
+        inside=!inside;
+      }
+    }
+
+    if (inside) {
+      result.insert(region.first);
+    }
+  }
+
+  return result;
+}
+
+static void CheckCoord(const osmscout::ReverseLocationIndex& index,
+                       const std::map<osmscout::FileOffset,Region>& regions,
+                       const osmscout::GeoCoord& coord)
+{
+  std::list<osmscout::FileOffset> regionOffsets;
+
+  if (!index.GetRegionOffsets(coord,
+                              regionOffsets)) {
+    std::cerr << "Cannot get regions for " << coord.GetDisplayText() << "!" << std::endl;
+    errors++;
+    return;
+  }
+
+  std::set<osmscout::FileOffset> result(regionOffsets.begin(),
+                                        regionOffsets.end());
+  std::set<osmscout::FileOffset> expected=GetExpectedRegions(regions,
+                                                             coord);
+
+  if (result!=expected) {
+    std::cerr << "Wrong regions for " << coord.GetDisplayText() << ":";
+
+    for (const auto& offset : result) {
+      std::cerr << " " << regions.find(offset)->second.name;
+    }
+
+    std::cerr << " instead of";
+
+    for (const auto& offset : expected) {
+      std::cerr << " " << regions.find(offset)->second.name;
+    }
+
+    std::cerr << std::endl;
+    errors++;
+  }
+}
+
+int main()
+{
+  if (!WriteTestData("ReverseLocationIndex.osm")) {
+    std::cerr << "Cannot write test data!" << std::endl;
+    return 1;
+  }
+
+  osmscout::ImportParameter parameter;
+  osmscout::SilentProgress  progress;
+  std::list<std::string>    mapfiles;
+
+  mapfiles.push_back("ReverseLocationIndex.osm");
+
+  parameter.SetMapfiles(mapfiles);
+  parameter.SetTypefile(TEST_TYPEFILE);
+  parameter.SetDestinationDirectory(".");
+
+  if (!osmscout::Import(parameter,
+                        progress)) {
+    std::cerr << "Import failed!" << std::endl;
+    return 1;
+  }
+
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::Database          database(databaseParameter);
+
+  if (!database.Open(".")) {
+    std::cerr << "Cannot open database!" << std::endl;
+    return 1;
+  }
+
+  osmscout::LocationIndexRef        locationIndex=database.GetLocationIndex();
+  osmscout::ReverseLocationIndexRef reverseLocationIndex=database.GetReverseLocationIndex();
+  RegionCollectorVisitor            visitor;
+
+  if (!locationIndex ||
+      !reverseLocationIndex ||
+      !locationIndex->VisitAdminRegions(visitor)) {
+    std::cerr << "Cannot load location indexes!" << std::endl;
+    return 1;
+  }
+
+  std::map<osmscout::FileOffset,Region> regions;
+
+  for (const auto& adminRegion : visitor.regions) {
+    osmscout::AreaRef area;
+
+    if (adminRegion.object.GetType()!=osmscout::refArea ||
+        !database.GetAreaByOffset(adminRegion.object.GetFileOffset(),
+                                  area)) {
+      std::cerr << "Cannot load area of region '" << adminRegion.name << "'!" << std::endl;
+      return 1;
+    }
+
+    Region& region=regions[adminRegion.regionOffset];
+
+    region.name=adminRegion.name;
+
+    for (const auto& ring : area->rings) {
+      if (ring.ring!=osmscout::Area::masterRingId &&
+          ring.nodes.size()>=3) {
+        region.rings.push_back(ring.nodes);
+      }
+    }
+  }
+
+  if (regions.size()!=3) {
+    std::cerr << "Found " << regions.size() << " instead of 3 regions!" << std::endl;
+    return 1;
+  }
+
+  for (const auto& region : regions) {
+    if (region.second.name=="Country" &&
+        region.second.rings.size()!=2) {
+      std::cerr << "Country has " << region.second.rings.size() << " instead of 2 rings!" << std::endl;
+      return 1;
+    }
+  }
+
+  // Points in the hole, in the enclave, in the child and outside
+  CheckCoord(*reverseLocationIndex,regions,osmscout::GeoCoord(10.25,20.30));
+  CheckCoord(*reverseLocationIndex,regions,osmscout::GeoCoord(10.40,20.50));
+  CheckCoord(*reverseLocationIndex,regions,osmscout::GeoCoord(10.08,20.10));
+  CheckCoord(*reverseLocationIndex,regions,osmscout::GeoCoord(10.60,20.30));
+
+  // A regular grid of points
+  for (size_t y=0; y<=200; y++) {
+    for (size_t x=0; x<=200; x++) {
+      CheckCoord(*reverseLocationIndex,
+                 regions,
+                 osmscout::GeoCoord(9.95+y*0.003,
+                                    19.90+x*0.004));
+    }
+  }
+
+  // Points on and next to the borders of the cells
+  double cellWidth=360.0/pow(2.0,14);
+  double cellHeight=180.0/pow(2.0,14);
+  double delta=1e-7;
+
+  for (double lon=ceil((19.90+180.0)/cellWidth)*cellWidth-180.0; lon<20.70; lon+=cellWidth) {
+    for (size_t y=0; y<=500; y++) {
+      double lat=9.95+y*0.0012;
+
+      CheckCoord(*reverseLocationIndex,regions,osmscout::GeoCoord(lat,lon-delta));
+      CheckCoord(*reverseLocationIndex,regions,osmscout::GeoCoord(lat,lon));
+      CheckCoord(*reverseLocationIndex,regions,osmscout::GeoCoord(lat,lon+delta));
+    }
+  }
+
+  for (double lat=ceil((9.95+90.0)/cellHeight)*cellHeight-90.0; lat<10.55; lat+=cellHeight) {
+    for (size_t x=0; x<=500; x++) {
+      double lon=19.90+x*0.0016;
+
+      CheckCoord(*reverseLocationIndex,regions,osmscout::GeoCoord(lat-delta,lon));
+      CheckCoord(*reverseLocationIndex,regions,osmscout::GeoCoord(lat,lon));
+      CheckCoord(*reverseLocationIndex,regions,osmscout::GeoCoord(lat+delta,lon));
+    }
+  }
+
+  database.Close();
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
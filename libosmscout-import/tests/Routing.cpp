@@ -0,0 +1,567 @@
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include <osmscout/Database.h>
+#include <osmscout/RoutingProfile.h>
+#include <osmscout/RoutingService.h>
+
+#include <osmscout/util/Geometry.h>
+
+#include <osmscout/import/Import.h>
+
+int errors=0;
+int routeCount=0;
+
+static const size_t gridSize=10;
+
+static const char* highwayTypes[]={"primary","secondary","tertiary","residential","residential"};
+
+static osmscout::GeoCoord GetGridCoord(size_t x,
+                                       size_t y)
+{
+  return osmscout::GeoCoord(50.0+y*0.002,
+                            8.0+x*0.003);
+}
+
+static osmscout::Id GetGridNodeId(size_t x,
+                                  size_t y)
+{
+  return y*gridSize+x+1;
+}
+
+static void WriteEdge(std::ofstream& out,
+                      osmscout::Id& wayId,
+                      osmscout::Id& nodeId,
+                      osmscout::Id from,
+                      const osmscout::GeoCoord& fromCoord,
+                      osmscout::Id to,
+                      const osmscout::GeoCoord& toCoord)
+{
+  // A node in the middle of the edge, that is not a junction
+  osmscout::Id middle=nodeId++;
+
+  out << " <node id=\"" << middle << "\" lat=\"" << (fromCoord.GetLat()+toCoord.GetLat())/2+0.0002*(rand()%3) << "\" lon=\"" << (fromCoord.GetLon()+toCoord.GetLon())/2 << "\" version=\"1\"/>" << std::endl;
+
+  bool reverse=rand()%2==0;
+
+  out << " <way id=\"" << wayId++ << "\" version=\"1\">" << std::endl;
+  out << "  <nd ref=\"" << (reverse ? to : from) << "\"/>" << std::endl;
+  out << "  <nd ref=\"" << middle << "\"/>" << std::endl;
+  out << "  <nd ref=\"" << (reverse ? from : to) << "\"/>" << std::endl;
+  out << "  <tag k=\"highway\" v=\"" << highwayTypes[rand()%5] << "\"/>" << std::endl;
+
+  if (rand()%6==0) {
+    out << "  <tag k=\"oneway\" v=\"yes\"/>" << std::endl;
+  }
+
+  out << " </way>" << std::endl;
+}
+
+/**
+ * A grid of junctions, connected by ways of random type and random (one way) direction
+ */
+static bool WriteTestData(const std::string& filename)
+{
+  std::ofstream out(filename.c_str());
+  osmscout::Id  wayId=1;
+  osmscout::Id  nodeId=gridSize*gridSize+1;
+
+  out.precision(10);
+
+  out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
+  out << "<osm version=\"0.6\">" << std::endl;
+
+  for (size_t y=0; y<gridSize; y++) {
+    for (size_t x=0; x<gridSize; x++) {
+      osmscout::GeoCoord coord=GetGridCoord(x,y);
+
+      out << " <node id=\"" << GetGridNodeId(x,y) << "\" lat=\"" << coord.GetLat() << "\" lon=\"" << coord.GetLon() << "\" version=\"1\"/>" << std::endl;
+    }
+  }
+
+  for (size_t y=0; y<gridSize; y++) {
+    for (size_t x=0; x<gridSize; x++) {
+      if (x+1<gridSize) {
+        WriteEdge(out,
+                  wayId,
+                  nodeId,
+                  GetGridNodeId(x,y),
+                  GetGridCoord(x,y),
+                  GetGridNodeId(x+1,y),
+                  GetGridCoord(x+1,y));
+      }
+
+      if (y+1<gridSize) {
+        WriteEdge(out,
+                  wayId,
+                  nodeId,
+                  GetGridNodeId(x,y),
+                  GetGridCoord(x,y),
+                  GetGridNodeId(x,y+1),
+                  GetGridCoord(x,y+1));
+      }
+    }
+  }
+
+  // The area index does not support an import without areas
+  out << " <node id=\"" << nodeId << "\" lat=\"49.9990\" lon=\"7.9990\" version=\"1\"/>" << std::endl;
+  out << " <node id=\"" << nodeId+1 << "\" lat=\"49.9990\" lon=\"7.9995\" version=\"1\"/>" << std::endl;
+  out << " <node id=\"" << nodeId+2 << "\" lat=\"49.9995\" lon=\"7.9995\" version=\"1\"/>" << std::endl;
+  out << " <way id=\"" << wayId << "\" version=\"1\">" << std::endl;
+  out << "  <nd ref=\"" << nodeId << "\"/>" << std::endl;
+  out << "  <nd ref=\"" << nodeId+1 << "\"/>" << std::endl;
+  out << "  <nd ref=\"" << nodeId+2 << "\"/>" << std::endl;
+  out << "  <nd ref=\"" << nodeId << "\"/>" << std::endl;
+  out << "  <tag k=\"leisure\" v=\"park\"/>" << std::endl;
+  out << " </way>" << std::endl;
+
+  out << "</osm>" << std::endl;
+
+  out.close();
+
+  return !out.fail();
+}
+
+/**
+ * Sum up the costs of all steps of the route
+ */
+static bool GetRouteCosts(osmscout::Database& database,
+                          const osmscout::RoutingProfile& profile,
+                          const osmscout::RouteData& route,
+                          double& costs)
+{
+  costs=0.0;
+
+  for (const auto& entry : route.Entries()) {
+    if (!entry.GetPathObject().Valid()) {
+      continue;
+    }
+
+    osmscout::WayRef way;
+
+    if (entry.GetPathObject().GetType()!=osmscout::refWay ||
+        !database.GetWayByOffset(entry.GetPathObject().GetFileOffset(),
+                                 way)) {
+      return false;
+    }
+
+    const osmscout::GeoCoord& from=way->nodes[entry.GetCurrentNodeIndex()];
+    const osmscout::GeoCoord& to=way->nodes[entry.GetTargetNodeIndex()];
+
+    costs+=profile.GetCosts(*way,
+                            osmscout::GetSphericalDistance(from.GetLon(),
+                                                           from.GetLat(),
+                                                           to.GetLon(),
+                                                           to.GetLat()));
+  }
+
+  return true;
+}
+
+static bool CalculateRouteCosts(osmscout::Database& database,
+                                osmscout::RoutingService& router,
+                                const osmscout::RoutingProfile& profile,
+                                const osmscout::GeoCoord& start,
+                                const osmscout::GeoCoord& target,
+                                bool& found,
+                                double& costs)
+{
+  std::vector<osmscout::GeoCoord> via;
+  osmscout::RouteData             route;
+
+  via.push_back(start);
+  via.push_back(target);
+
+  found=false;
+  costs=0.0;
+
+  if (!router.CalculateRoute(profile,
+                             osmscout::vehicleCar,
+                             100.0,
+                             via,
+                             route)) {
+    // An empty route is also signaled as error
+    return true;
+  }
+
+  found=!route.IsEmpty();
+
+  return GetRouteCosts(database,
+                       profile,
+                       route,
+                       costs);
+}
+
+static bool IsSameCost(double a,
+                       double b)
+{
+  return fabs(a-b)<=1e-6+1e-4*std::max(a,b);
+}
+
+/**
+ * All search variants must find a route of the same costs as the plain A* search
+ */
+static void CheckSearches(osmscout::Database& database,
+                          osmscout::RoutingService& router,
+                          osmscout::FastestPathRoutingProfile& profile,
+                          const osmscout::GeoCoord& start,
+                          const osmscout::GeoCoord& target)
+{
+  bool   expectedFound;
+  double expectedCosts;
+
+  profile.SetOpenListType(osmscout::openListSet);
+  profile.SetBidirectional(false);
+  profile.SetUseContractionHierarchy(false);
+
+  if (!CalculateRouteCosts(database,
+                           router,
+                           profile,
+                           start,
+                           target,
+                           expectedFound,
+                           expectedCosts)) {
+    std::cerr << "Cannot calculate route from " << start.GetDisplayText() << " to " << target.GetDisplayText() << "!" << std::endl;
+    errors++;
+    return;
+  }
+
+  if (expectedFound) {
+    routeCount++;
+  }
+
+  const char* variantNames[]={"Heap","Bidirectional","Contraction hierarchy"};
+
+  for (size_t variant=0; variant<3; variant++) {
+    bool   found;
+    double costs;
+
+    profile.SetOpenListType(osmscout::openListHeap);
+    profile.SetBidirectional(variant==1);
+    profile.SetUseContractionHierarchy(variant==2);
+
+    if (!CalculateRouteCosts(database,
+                             router,
+                             profile,
+                             start,
+                             target,
+                             found,
+                             costs)) {
+      std::cerr << "Cannot calculate route from " << start.GetDisplayText() << " to " << target.GetDisplayText() << "!" << std::endl;
+      errors++;
+      continue;
+    }
+
+    if (found!=expectedFound ||
+        !IsSameCost(costs,expectedCosts)) {
+      std::cerr << variantNames[variant] << " search from " << start.GetDisplayText() << " to " << target.GetDisplayText() << " returns " << costs << " instead of " << expectedCosts << "!" << std::endl;
+      errors++;
+    }
+  }
+}
+
+/**
+ * The costs of the matrix must match the costs of the individual routes
+ */
+static void CheckMatrix(osmscout::Database& database,
+                        osmscout::RoutingService& router,
+                        osmscout::FastestPathRoutingProfile& profile,
+                        const std::vector<osmscout::GeoCoord>& sources,
+                        const std::vector<osmscout::GeoCoord>& targets)
+{
+  osmscout::RoutingMatrix matrix;
+
+  profile.SetOpenListType(osmscout::openListSet);
+  profile.SetBidirectional(false);
+
+  if (!router.CalculateMatrix(profile,
+                              100.0,
+                              sources,
+                              targets,
+                              matrix,
+                              2)) {
+    std::cerr << "Cannot calculate matrix!" << std::endl;
+    errors++;
+    return;
+  }
+
+  for (size_t s=0; s<sources.size(); s++) {
+    for (size_t t=0; t<targets.size(); t++) {
+      bool   found;
+      double costs;
+
+      if (sources[s].GetLat()==targets[t].GetLat() &&
+          sources[s].GetLon()==targets[t].GetLon()) {
+        continue;
+      }
+
+      if (!CalculateRouteCosts(database,
+                               router,
+                               profile,
+                               sources[s],
+                               targets[t],
+                               found,
+                               costs)) {
+        std::cerr << "Cannot calculate route from " << sources[s].GetDisplayText() << " to " << targets[t].GetDisplayText() << "!" << std::endl;
+        errors++;
+        continue;
+      }
+
+      if (found!=matrix.IsReachable(s,t) ||
+          (found && !IsSameCost(matrix.GetCosts(s,t),costs))) {
+        std::cerr << "Matrix from " << sources[s].GetDisplayText() << " to " << targets[t].GetDisplayText() << " returns " << matrix.GetCosts(s,t) << " instead of " << costs << "!" << std::endl;
+        errors++;
+      }
+    }
+  }
+}
+
+/**
+ * Exactly the junctions, that can be reached within the maximum costs, must be
+ * reachable with the costs of the route to them and within the outline of the
+ * last band
+ */
+static void CheckReachability(osmscout::Database& database,
+                              osmscout::RoutingService& router,
+                              osmscout::FastestPathRoutingProfile& profile,
+                              const osmscout::GeoCoord& start,
+                              double maxCost)
+{
+  osmscout::RoutingReachability reachability;
+
+  profile.SetOpenListType(osmscout::openListSet);
+  profile.SetBidirectional(false);
+
+  // Invalid parameters must be rejected
+  if (router.CalculateReachability(profile,100.0,start,0.0,2,0.05,reachability) ||
+      router.CalculateReachability(profile,100.0,start,maxCost,0,0.05,reachability) ||
+      router.CalculateReachability(profile,100.0,start,maxCost,2,0.0,reachability) ||
+      router.CalculateReachability(profile,100.0,start,maxCost,2,-0.05,reachability)) {
+    std::cerr << "Reachability from " << start.GetDisplayText() << " accepts invalid parameters!" << std::endl;
+    errors++;
+  }
+
+  if (!router.CalculateReachability(profile,
+                                    100.0,
+                                    start,
+                                    maxCost,
+                                    2,
+                                    0.05,
+                                    reachability)) {
+    std::cerr << "Cannot calculate reachability from " << start.GetDisplayText() << "!" << std::endl;
+    errors++;
+    return;
+  }
+
+  if (reachability.bands.size()!=2 ||
+      reachability.bands.back().maxCosts!=maxCost) {
+    std::cerr << "Reachability from " << start.GetDisplayText() << " does not return the requested bands!" << std::endl;
+    errors++;
+    return;
+  }
+
+  for (const auto& node : reachability.nodes) {
+    if (node.costs>maxCost) {
+      std::cerr << "Reachability from " << start.GetDisplayText() << " returns " << node.coord.GetDisplayText() << " with costs " << node.costs << "!" << std::endl;
+      errors++;
+    }
+  }
+
+  for (size_t y=0; y<gridSize; y++) {
+    for (size_t x=0; x<gridSize; x++) {
+      osmscout::GeoCoord target=GetGridCoord(x,y);
+      bool               found;
+      double             costs;
+
+      if (target.GetLat()==start.GetLat() &&
+          target.GetLon()==start.GetLon()) {
+        continue;
+      }
+
+      if (!CalculateRouteCosts(database,
+                               router,
+                               profile,
+                               start,
+                               target,
+                               found,
+                               costs)) {
+        std::cerr << "Cannot calculate route from " << start.GetDisplayText() << " to " << target.GetDisplayText() << "!" << std::endl;
+        errors++;
+        continue;
+      }
+
+      // Too close to the limit to decide
+      if (found &&
+          IsSameCost(costs,maxCost)) {
+        continue;
+      }
+
+      const osmscout::RoutingReachability::Node* reachableNode=NULL;
+
+      for (const auto& node : reachability.nodes) {
+        if (fabs(node.coord.GetLat()-target.GetLat())<1e-5 &&
+            fabs(node.coord.GetLon()-target.GetLon())<1e-5) {
+          reachableNode=&node;
+          break;
+        }
+      }
+
+      bool expectedReachable=found && costs<maxCost;
+
+      if ((reachableNode!=NULL)!=expectedReachable ||
+          (reachableNode!=NULL && !IsSameCost(reachableNode->costs,costs))) {
+        std::cerr << "Reachability from " << start.GetDisplayText() << " returns " << target.GetDisplayText() << " with costs " << (reachableNode!=NULL ? reachableNode->costs : -1.0) << " instead of " << (expectedReachable ? costs : -1.0) << "!" << std::endl;
+        errors++;
+        continue;
+      }
+
+      if (!expectedReachable) {
+        continue;
+      }
+
+      bool inside=false;
+
+      for (const auto& ring : reachability.bands.back().rings) {
+        if (osmscout::IsCoordInArea(target,ring)) {
+          inside=!inside;
+        }
+      }
+
+      if (!inside) {
+        std::cerr << "Reachable " << target.GetDisplayText() << " is not within the outline!" << std::endl;
+        errors++;
+      }
+    }
+  }
+}
+
+int main()
+{
+  srand(42);
+
+  // Separate directory, since the other tests also import into the current directory
+  mkdir("RoutingData",0755);
+
+  if (!WriteTestData("RoutingData/Routing.osm")) {
+    std::cerr << "Cannot write test data!" << std::endl;
+    return 1;
+  }
+
+  osmscout::ImportParameter parameter;
+  osmscout::SilentProgress  progress;
+  std::list<std::string>    mapfiles;
+
+  mapfiles.push_back("RoutingData/Routing.osm");
+
+  parameter.SetMapfiles(mapfiles);
+  parameter.SetTypefile(TEST_TYPEFILE);
+  parameter.SetDestinationDirectory("RoutingData");
+  parameter.SetRouteReversePaths(true);
+  parameter.SetRouteContractionHierarchy(true);
+
+  if (!osmscout::Import(parameter,
+                        progress)) {
+    std::cerr << "Import failed!" << std::endl;
+    return 1;
+  }
+
+  osmscout::DatabaseParameter databaseParameter;
+  osmscout::DatabaseRef       database(new osmscout::Database(databaseParameter));
+
+  if (!database->Open("RoutingData")) {
+    std::cerr << "Cannot open database!" << std::endl;
+    return 1;
+  }
+
+  osmscout::RouterParameter routerParameter;
+  osmscout::RoutingService  router(database,
+                                   routerParameter,
+                                   osmscout::vehicleCar);
+
+  if (!router.Open()) {
+    std::cerr << "Cannot open routing database!" << std::endl;
+    return 1;
+  }
+
+  osmscout::FastestPathRoutingProfile profile(database->GetTypeConfig());
+  std::map<std::string,double>        carSpeedTable;
+
+  osmscout::AbstractRoutingProfile::GetDefaultCarSpeedTable(carSpeedTable);
+  profile.ParametrizeForCar(*database->GetTypeConfig(),
+                            carSpeedTable,
+                            osmscout::AbstractRoutingProfile::defaultCarMaxSpeed);
+
+  if (!router.CanUseContractionHierarchy(profile)) {
+    std::cerr << "Contraction hierarchy not usable for the default car profile!" << std::endl;
+    errors++;
+  }
+
+  osmscout::FastestPathRoutingProfile slowProfile(database->GetTypeConfig());
+
+  slowProfile.ParametrizeForCar(*database->GetTypeConfig(),
+                                carSpeedTable,
+                                80.0);
+
+  if (router.CanUseContractionHierarchy(slowProfile)) {
+    std::cerr << "Contraction hierarchy usable for a profile with a different metric!" << std::endl;
+    errors++;
+  }
+
+  for (size_t i=0; i<50; i++) {
+    osmscout::GeoCoord start=GetGridCoord(rand()%gridSize,rand()%gridSize);
+    osmscout::GeoCoord target=GetGridCoord(rand()%gridSize,rand()%gridSize);
+
+    CheckSearches(*database,
+                  router,
+                  profile,
+                  start,
+                  target);
+  }
+
+  std::vector<osmscout::GeoCoord> sources;
+  std::vector<osmscout::GeoCoord> targets;
+
+  for (size_t i=0; i<4; i++) {
+    sources.push_back(GetGridCoord(rand()%gridSize,rand()%gridSize));
+  }
+
+  for (size_t i=0; i<6; i++) {
+    targets.push_back(GetGridCoord(rand()%gridSize,rand()%gridSize));
+  }
+
+  CheckMatrix(*database,
+              router,
+              profile,
+              sources,
+              targets);
+
+  CheckReachability(*database,
+                    router,
+                    profile,
+                    GetGridCoord(4,5),
+                    0.02);
+
+  // The grid is connected, only routes from a position to itself are missing
+  if (routeCount<45) {
+    std::cerr << "Only " << routeCount << " routes found!" << std::endl;
+    errors++;
+  }
+
+  router.Close();
+  database->Close();
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
@@ -0,0 +1,283 @@
+#ifndef OSMSCOUT_LABELGRID_H
+#define OSMSCOUT_LABELGRID_H
+
+/*
+  This source is part of the libosmscout-map library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Renderer
+   *
+   * Container for labels that allows fast lookup of all labels that
+   * (possibly) intersect a given bounding box and of all labels with a
+   * given text.
+   *
+   * Labels are stored in a list in the order of insertion. Additionally
+   * each label is registered in all cells of a uniform grid over the drawing
+   * area its bounding box touches. Bounding boxes outside the drawing area
+   * are clamped to the border cells.
+   *
+   * The label type L must have the (double) members bx1, bx2, by1 and by2,
+   * describing its bounding box, and a std::string member text.
+   */
+  template <class L>
+  class LabelGrid
+  {
+  public:
+    typedef std::list<L>                      LabelList;
+    typedef typename LabelList::iterator       LabelRef;
+    typedef typename LabelList::const_iterator const_iterator;
+
+  private:
+    struct LabelRefLess
+    {
+      inline bool operator()(const LabelRef& a,
+                             const LabelRef& b) const
+      {
+        return &*a<&*b;
+      }
+    };
+
+    struct LabelRefEqual
+    {
+      inline bool operator()(const LabelRef& a,
+                             const LabelRef& b) const
+      {
+        return a==b;
+      }
+    };
+
+  private:
+    LabelList                                             labels;     //!< All labels in order of insertion
+    double                                                cellSize;   //!< Width and height of a grid cell in pixel
+    size_t                                                cellWidth;  //!< Number of cells in horizontal direction
+    size_t                                                cellHeight; //!< Number of cells in vertical direction
+    std::vector<std::vector<LabelRef> >                   cells;      //!< The labels in each grid cell
+    std::unordered_map<std::string,std::vector<LabelRef> > texts;     //!< The labels by text
+
+  private:
+    inline size_t GetCellX(double x) const
+    {
+      if (x<=0.0) {
+        return 0;
+      }
+
+      size_t cell=(size_t)(x/cellSize);
+
+      return std::min(cell,cellWidth-1);
+    }
+
+    inline size_t GetCellY(double y) const
+    {
+      if (y<=0.0) {
+        return 0;
+      }
+
+      size_t cell=(size_t)(y/cellSize);
+
+      return std::min(cell,cellHeight-1);
+    }
+
+    static void RemoveFromVector(std::vector<LabelRef>& refs,
+                                 const LabelRef& ref)
+    {
+      for (size_t i=0; i<refs.size(); i++) {
+        if (refs[i]==ref) {
+          refs[i]=refs.back();
+          refs.pop_back();
+          return;
+        }
+      }
+    }
+
+  public:
+    LabelGrid()
+    : cellSize(1.0),
+      cellWidth(1),
+      cellHeight(1),
+      cells(1)
+    {
+      // no code
+    }
+
+    /**
+     * Remove all labels and initialize the grid for a drawing area of the
+     * given dimension (in pixel) using cells of the given size (in pixel).
+     */
+    void Initialize(double width,
+                    double height,
+                    double cellSize)
+    {
+      Clear();
+
+      this->cellSize=std::max(cellSize,1.0);
+
+      cellWidth=std::max((size_t)1,(size_t)std::ceil(width/this->cellSize));
+      cellHeight=std::max((size_t)1,(size_t)std::ceil(height/this->cellSize));
+
+      cells.clear();
+      cells.resize(cellWidth*cellHeight);
+    }
+
+    /**
+     * Remove all labels
+     */
+    void Clear()
+    {
+      for (auto& cell : cells) {
+        cell.clear();
+      }
+
+      texts.clear();
+      labels.clear();
+    }
+
+    /**
+     * Append the given label
+     */
+    LabelRef Add(const L& label)
+    {
+      LabelRef ref=labels.insert(labels.end(),label);
+
+      size_t x1=GetCellX(label.bx1);
+      size_t x2=GetCellX(label.bx2);
+      size_t y1=GetCellY(label.by1);
+      size_t y2=GetCellY(label.by2);
+
+      for (size_t y=y1; y<=y2; y++) {
+        for (size_t x=x1; x<=x2; x++) {
+          cells[y*cellWidth+x].push_back(ref);
+        }
+      }
+
+      texts[label.text].push_back(ref);
+
+      return ref;
+    }
+
+    /**
+     * Remove the given label
+     */
+    void Remove(const LabelRef& ref)
+    {
+      size_t x1=GetCellX(ref->bx1);
+      size_t x2=GetCellX(ref->bx2);
+      size_t y1=GetCellY(ref->by1);
+      size_t y2=GetCellY(ref->by2);
+
+      for (size_t y=y1; y<=y2; y++) {
+        for (size_t x=x1; x<=x2; x++) {
+          RemoveFromVector(cells[y*cellWidth+x],
+                           ref);
+        }
+      }
+
+      auto text=texts.find(ref->text);
+
+      if (text!=texts.end()) {
+        RemoveFromVector(text->second,
+                         ref);
+
+        if (text->second.empty()) {
+          texts.erase(text);
+        }
+      }
+
+      labels.erase(ref);
+    }
+
+    /**
+     * Return all labels, that are registered in a cell touched by the given
+     * bounding box. The result contains every label intersecting the bounding box
+     * (and possibly some more), each label only once.
+     */
+    void GetLabelsInBox(double x1,
+                        double x2,
+                        double y1,
+                        double y2,
+                        std::vector<LabelRef>& result)
+    {
+      size_t cx1=GetCellX(x1);
+      size_t cx2=GetCellX(x2);
+      size_t cy1=GetCellY(y1);
+      size_t cy2=GetCellY(y2);
+
+      result.clear();
+
+      for (size_t y=cy1; y<=cy2; y++) {
+        for (size_t x=cx1; x<=cx2; x++) {
+          const std::vector<LabelRef>& cell=cells[y*cellWidth+x];
+
+          result.insert(result.end(),cell.begin(),cell.end());
+        }
+      }
+
+      if (cx1!=cx2 || cy1!=cy2) {
+        std::sort(result.begin(),result.end(),LabelRefLess());
+        result.erase(std::unique(result.begin(),result.end(),LabelRefEqual()),
+                     result.end());
+      }
+    }
+
+    /**
+     * Return all labels with the given text
+     */
+    void GetLabelsWithText(const std::string& text,
+                           std::vector<LabelRef>& result)
+    {
+      auto entry=texts.find(text);
+
+      result.clear();
+
+      if (entry!=texts.end()) {
+        result=entry->second;
+      }
+    }
+
+    inline size_t size() const
+    {
+      return labels.size();
+    }
+
+    inline bool empty() const
+    {
+      return labels.empty();
+    }
+
+    inline const_iterator begin() const
+    {
+      return labels.begin();
+    }
+
+    inline const_iterator end() const
+    {
+      return labels.end();
+    }
+  };
+}
+
+#endif
@@ -36,6 +36,7 @@
 #include <osmscout/StyleConfig.h>
 
 #include <osmscout/GroundTile.h>
+#include <osmscout/LabelGrid.h>
 
 #include <osmscout/util/Breaker.h>
 #include <osmscout/util/Geometry.h>
@@ -154,6 +155,9 @@ namespace osmscout {
       std::string              text;     //!< The label text
     };
 
+    typedef LabelGrid<LabelData>    LabelDataGrid;
+    typedef LabelDataGrid::LabelRef LabelDataRef;
+
     struct OSMSCOUT_MAP_API LabelLayoutData
     {
       size_t       position;   //!< Relative position of the label
@@ -207,8 +211,10 @@ namespace osmscout {
       Temporary data structures for intelligent label positioning
       */
     //@{
-    std::list<LabelData>         labels;
-    std::list<LabelData>         overlayLabels;
+    LabelDataGrid                labels;
+    LabelDataGrid                overlayLabels;
+    std::vector<LabelDataRef>    markedLabels;      //!< Labels currently marked during label conflict resolution
+    std::vector<LabelDataRef>    candidateLabels;   //!< Temporary storage for label grid query results
     std::vector<ScanCell>        wayScanlines;
     std::vector<LabelLayoutData> labelLayoutData;
     //@}
@@ -248,6 +254,7 @@ namespace osmscout {
     double                       labelSpace;
     double                       shieldLabelSpace;
     double                       sameLabelSpace;
+    double                       maxLabelSpace;
     double                       standardFontSize;
     //@}
 
@@ -266,21 +273,21 @@ namespace osmscout {
      Label placement routines
      */
     //@{
-    void ClearLabelMarks(std::list<LabelData>& labels);
-    void RemoveMarkedLabels(std::list<LabelData>& labels);
+    void ClearLabelMarks();
+    void RemoveMarkedLabels(LabelDataGrid& labels);
     bool MarkAllInBoundingBox(double bx1,
                               double bx2,
                               double by1,
                               double by2,
                               const LabelStyle& style,
-                              std::list<LabelData>& labels);
+                              LabelDataGrid& labels);
     bool MarkCloseLabelsWithSameText(double bx1,
                                      double bx2,
                                      double by1,
                                      double by2,
                                      const LabelStyle& style,
                                      const std::string& text,
-                                     std::list<LabelData>& labels);
+                                     LabelDataGrid& labels);
     //@}
 
     /**
@@ -460,7 +467,9 @@ namespace osmscout {
                                double& vertical);
 
     /**
-      Return the size of the frame around a labels.
+      Return the size of the frame around a labels. The returned values
+      must not be bigger than the maximum of the label space and the
+      plate label space, since this is used to look up conflicting labels.
      */
     virtual void GetLabelSpace(const LabelStyle& styleA,
                                const LabelStyle& styleB,
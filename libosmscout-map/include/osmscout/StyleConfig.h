@@ -25,6 +25,12 @@
 #include <unordered_map>
 #include <vector>
 
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+#include <mutex>
+#endif
+
 #include <osmscout/private/MapImportExport.h>
 
 #include <osmscout/Coord.h>
@@ -1318,13 +1324,139 @@ namespace osmscout {
   typedef std::list<PathSymbolStyleSelector>                           PathSymbolStyleSelectorList; //! List of selectors
   typedef std::vector<std::vector<PathSymbolStyleSelectorList> >       PathSymbolStyleLookupTable;  //!Index selectors by type and level
 
+  /**
+   * Hit and miss counters of the cache of composed styles
+   */
+  struct OSMSCOUT_MAP_API ComposedStyleStatistics
+  {
+    size_t entries; //!< Number of composed styles in the cache
+    size_t hits;    //!< Number of requests that returned an already composed style
+    size_t misses;  //!< Number of requests that had to compose a new style
+  };
+
+  /**
+   * Cache for styles that are composed from multiple matching style selectors.
+   *
+   * The composed style only depends on the list of selectors for the given
+   * slot, type and magnification level and on the subset of selectors of
+   * this list that match, so this is used as key. Objects that result in the
+   * same key share the same (immutable) composed style instance.
+   *
+   * The cache is threadsafe.
+   */
+  template <class S>
+  class ComposedStyleCache
+  {
+  public:
+    struct Key
+    {
+      const void* selectors; //!< Address of the selector list of slot, type and level
+      uint64_t    matches;   //!< Bitmask of the matching selectors in this list
+
+      inline bool operator==(const Key& other) const
+      {
+        return selectors==other.selectors &&
+               matches==other.matches;
+      }
+    };
+
+    struct KeyHasher
+    {
+      inline size_t operator()(const Key& key) const
+      {
+        return std::hash<const void*>()(key.selectors) ^
+               std::hash<uint64_t>()(key.matches*0x9e3779b97f4a7c15ULL);
+      }
+    };
+
+  private:
+    std::unordered_map<Key,std::shared_ptr<S>,KeyHasher> styles;
+    size_t                                                hits;
+    size_t                                                misses;
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    mutable std::mutex                                    mutex;
+#endif
+
+  public:
+    ComposedStyleCache()
+    : hits(0),
+      misses(0)
+    {
+      // no code
+    }
+
+    /**
+     * Return the composed style for the given key, if it is already in the cache.
+     * The returned style may be NULL, if the composed style is not visible.
+     */
+    bool GetStyle(const Key& key,
+                  std::shared_ptr<S>& style)
+    {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+      std::lock_guard<std::mutex> guard(mutex);
+#endif
+
+      auto entry=styles.find(key);
+
+      if (entry==styles.end()) {
+        misses++;
+        return false;
+      }
+
+      hits++;
+      style=entry->second;
+
+      return true;
+    }
+
+    /**
+     * Store the composed style for the given key. If another thread
+     * already stored a style for the same key, this one is returned in style.
+     */
+    void SetStyle(const Key& key,
+                  std::shared_ptr<S>& style)
+    {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+      std::lock_guard<std::mutex> guard(mutex);
+#endif
+
+      auto result=styles.insert(std::make_pair(key,style));
+
+      if (!result.second) {
+        style=result.first->second;
+      }
+    }
+
+    void Clear()
+    {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+      std::lock_guard<std::mutex> guard(mutex);
+#endif
+
+      styles.clear();
+    }
+
+    void AddStatistics(ComposedStyleStatistics& statistics) const
+    {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+      std::lock_guard<std::mutex> guard(mutex);
+#endif
+
+      statistics.entries+=styles.size();
+      statistics.hits+=hits;
+      statistics.misses+=misses;
+    }
+  };
+
   /**
    * A complete style definition
    *
    * Internals:
    * * Fastpath: Fastpath means, that we can directly return the style definition from the style sheet. This is normally
    * the case, if there is excactly one match in the style sheet. If there are multiple matches a new style has to be
-   * allocated and composed from all matches.
+   * allocated and composed from all matches. Composed styles are cached, so that objects with the same
+   * matches share the same composed style instance.
    */
   class OSMSCOUT_MAP_API StyleConfig
   {
@@ -1384,9 +1516,19 @@ namespace osmscout {
 
     std::unordered_map<std::string,StyleVariableRef> variables;
 
+    // Composed styles
+
+    mutable ComposedStyleCache<TextStyle>       composedTextStyles;
+    mutable ComposedStyleCache<IconStyle>       composedIconStyles;
+    mutable ComposedStyleCache<LineStyle>       composedLineStyles;
+    mutable ComposedStyleCache<PathTextStyle>   composedPathTextStyles;
+    mutable ComposedStyleCache<PathSymbolStyle> composedPathSymbolStyles;
+    mutable ComposedStyleCache<PathShieldStyle> composedPathShieldStyles;
+    mutable ComposedStyleCache<FillStyle>       composedFillStyles;
 
   private:
     void Reset();
+    void ClearComposedStyles();
 
     void GetAllNodeTypes(std::list<TypeId>& types);
     void GetAllWayTypes(std::list<TypeId>& types);
@@ -1514,6 +1656,8 @@ namespace osmscout {
                              FillStyleRef& fillStyle) const;
     void GetCoastlineLineStyle(const Projection& projection,
                                LineStyleRef& lineStyle) const;
+
+    void GetComposedStyleStatistics(ComposedStyleStatistics& statistics) const;
     //@}
 
     /**
@@ -168,27 +168,28 @@ namespace osmscout {
              yMax<0);
   }
 
-  void MapPainter::ClearLabelMarks(std::list<LabelData>& labels)
+  /**
+   * Reset the marks of all labels marked during the last conflict resolution
+   */
+  void MapPainter::ClearLabelMarks()
   {
-    for (std::list<LabelData>::iterator label=labels.begin();
-         label!=labels.end();
-         ++label) {
+    for (auto& label : markedLabels) {
       label->mark=false;
     }
+
+    markedLabels.clear();
   }
 
-  void MapPainter::RemoveMarkedLabels(std::list<LabelData>& labels)
+  /**
+   * Remove all labels marked during the current conflict resolution
+   */
+  void MapPainter::RemoveMarkedLabels(LabelDataGrid& labels)
   {
-    std::list<LabelData>::iterator label=labels.begin();
-
-    while (label!=labels.end()) {
-      if (label->mark) {
-        label=labels.erase(label);
-      }
-      else {
-        ++label;
-      }
+    for (auto& label : markedLabels) {
+      labels.Remove(label);
     }
+
+    markedLabels.clear();
   }
 
   bool MapPainter::MarkAllInBoundingBox(double bx1,
@@ -196,11 +197,18 @@ namespace osmscout {
                                         double by1,
                                         double by2,
                                         const LabelStyle& style,
-                                        std::list<LabelData>& labels)
+                                        LabelDataGrid& labels)
   {
-    for (auto& label : labels) {
+    // Every label we could possibly conflict with (including the label space)
+    labels.GetLabelsInBox(bx1-maxLabelSpace,
+                          bx2+maxLabelSpace,
+                          by1-maxLabelSpace,
+                          by2+maxLabelSpace,
+                          candidateLabels);
+
+    for (auto& label : candidateLabels) {
       // We only look at labels, that are not already marked.
-      if (label.mark) {
+      if (label->mark) {
         continue;
       }
 
@@ -213,7 +221,7 @@ namespace osmscout {
       double vertLabelSpace;
 
       GetLabelSpace(style,
-                    *label.style,
+                    *label->style,
                     horizLabelSpace,
                     vertLabelSpace);
 
@@ -224,15 +232,16 @@ namespace osmscout {
 
       // Check for labels that intersect (including space). If our priority is lower,
       // we stop processing, else we mark the other label (as to be deleted)
-      if (!(hx1>=label.bx2 ||
-            hx2<=label.bx1 ||
-            hy1>=label.by2 ||
-            hy2<=label.by1)) {
-        if (label.style->GetPriority()<=style.GetPriority()) {
+      if (!(hx1>=label->bx2 ||
+            hx2<=label->bx1 ||
+            hy1>=label->by2 ||
+            hy2<=label->by1)) {
+        if (label->style->GetPriority()<=style.GetPriority()) {
           return false;
         }
 
-        label.mark=true;
+        label->mark=true;
+        markedLabels.push_back(label);
       }
     }
 
@@ -245,31 +254,35 @@ namespace osmscout {
                                                double by2,
                                                const LabelStyle& style,
                                                const std::string& text,
-                                               std::list<LabelData>& labels)
+                                               LabelDataGrid& labels)
   {
-    for (auto & label : labels) {
-      if (label.mark) {
+    if (dynamic_cast<const ShieldStyle*>(&style)==NULL) {
+      return true;
+    }
+
+    labels.GetLabelsWithText(text,
+                             candidateLabels);
+
+    for (auto& label : candidateLabels) {
+      if (label->mark) {
         continue;
       }
 
-      if (dynamic_cast<const ShieldStyle*>(&style)!=NULL &&
-          dynamic_cast<const ShieldStyle*>(label.style.get())!=NULL) {
+      if (dynamic_cast<const ShieldStyle*>(label->style.get())!=NULL) {
         double hx1=bx1-sameLabelSpace;
         double hx2=bx2+sameLabelSpace;
         double hy1=by1-sameLabelSpace;
         double hy2=by2+sameLabelSpace;
 
-        if (!(hx1>label.bx2 ||
-              hx2<label.bx1 ||
-              hy1>label.by2 ||
-              hy2<label.by1)) {
-          if (text==label.text) {
-            // TODO: It may be possible that the labels belong to the same "thing".
-            // perhaps we should not just draw one or the other, but also change
-            // final position of the label (but this would require more complex
-            // collision handling and perhaps processing labels in different order)?
-            return false;
-          }
+        if (!(hx1>label->bx2 ||
+              hx2<label->bx1 ||
+              hy1>label->by2 ||
+              hy2<label->by1)) {
+          // TODO: It may be possible that the labels belong to the same "thing".
+          // perhaps we should not just draw one or the other, but also change
+          // final position of the label (but this would require more complex
+          // collision handling and perhaps processing labels in different order)?
+          return false;
         }
       }
     }
@@ -577,8 +590,13 @@ namespace osmscout {
       labelData.fontSize=1.2;
       labelData.style=debugLabel;
       labelData.text=label;
+      labelData.bx1=px;
+      labelData.bx2=px;
+      labelData.by1=py;
+      labelData.by2=py;
+      labelData.mark=false;
 
-      labels.push_back(labelData);
+      labels.Add(labelData);
 
       drawnLabels.insert(Coord(x,y));
 #endif
@@ -636,12 +654,7 @@ namespace osmscout {
 
     // Reset all marks on labels, because we needs marks
     // for our internal collision handling
-    if (overlay) {
-      ClearLabelMarks(overlayLabels);
-    }
-    else {
-      ClearLabelMarks(labels);
-    }
+    ClearLabelMarks();
 
     // First rough minimum bounding box, estimated without calculating text dimensions (since this is expensive).
     double bx1;
@@ -776,12 +789,13 @@ namespace osmscout {
     label.fontSize=fontSize;
     label.style=style;
     label.text=text;
+    label.mark=false;
 
     if (overlay) {
-      overlayLabels.push_back(label);
+      overlayLabels.Add(label);
     }
     else {
-      labels.push_back(label);
+      labels.Add(label);
     }
 
     return true;
@@ -1532,20 +1546,27 @@ namespace osmscout {
 
     labelsDrawn=0;
 
-    labels.clear();
-    overlayLabels.clear();
-
     transBuffer.Reset();
 
     labelSpace=projection.ConvertWidthToPixel(parameter.GetLabelSpace());
     shieldLabelSpace=projection.ConvertWidthToPixel(parameter.GetPlateLabelSpace());
     sameLabelSpace=projection.ConvertWidthToPixel(parameter.GetSameLabelSpace());
+    maxLabelSpace=std::max(labelSpace,shieldLabelSpace);
 
     GetFontHeight(projection,
                   parameter,
                   1.0,
                   standardFontSize);
 
+    // Grid cells for label conflict resolution should hold a few labels
+    markedLabels.clear();
+    labels.Initialize(projection.GetWidth(),
+                      projection.GetHeight(),
+                      4*standardFontSize);
+    overlayLabels.Initialize(projection.GetWidth(),
+                             projection.GetHeight(),
+                             4*standardFontSize);
+
     if (parameter.IsAborted()) {
       return false;
     }
@@ -1609,6 +1609,23 @@ namespace osmscout {
     areaTypeSets.clear();
 
     variables.clear();
+
+    ClearComposedStyles();
+  }
+
+  /**
+   * Clears the cache of composed styles. Must be called whenever the
+   * selector lists change, since they are part of the cache key.
+   */
+  void StyleConfig::ClearComposedStyles()
+  {
+    composedTextStyles.Clear();
+    composedIconStyles.Clear();
+    composedLineStyles.Clear();
+    composedPathTextStyles.Clear();
+    composedPathSymbolStyles.Clear();
+    composedPathShieldStyles.Clear();
+    composedFillStyles.Clear();
   }
 
   bool StyleConfig::RegisterLabelProviderFactory(const std::string& name,
@@ -2126,6 +2143,8 @@ namespace osmscout {
 
   void StyleConfig::Postprocess()
   {
+    ClearComposedStyles();
+
     PostprocessNodes();
     PostprocessWays();
     PostprocessAreas();
@@ -2251,16 +2270,18 @@ namespace osmscout {
   /**
    * Get the style data based on the given features of an object,
    * a given style (S) and its style attributes (A).
+   *
+   * If more than one selector matches, the composed style is taken from
+   * (or stored in) the given cache.
    */
   template <class S, class A>
   void GetFeatureStyle(const StyleResolveContext& context,
                        const std::vector<std::list<StyleSelector<S,A> > >& styleSelectors,
                        const FeatureValueBuffer& buffer,
                        const Projection& projection,
+                       ComposedStyleCache<S>& cache,
                        std::shared_ptr<S>& style)
   {
-    bool   fastpath=false;
-    bool   composed=false;
     size_t level=projection.GetMagnification().GetLevel();
     double meterInPixel=1/projection.GetPixelSize();
     double meterInMM=meterInPixel*25.4/projection.GetDPI();
@@ -2269,37 +2290,88 @@ namespace osmscout {
       level=styleSelectors.size()-1;
     }
 
+    const std::list<StyleSelector<S,A> >& selectors=styleSelectors[level];
+    const StyleSelector<S,A>*             firstMatch=NULL;
+    size_t                                matchCount=0;
+    uint64_t                              matches=0;
+    size_t                                index=0;
+
     style=NULL;
 
-    for (const auto& selector : styleSelectors[level]) {
-      if (!selector.criteria.Matches(context,
-                                     buffer,
-                                     meterInPixel,
-                                     meterInMM)) {
-        continue;
-      }
+    for (const auto& selector : selectors) {
+      if (selector.criteria.Matches(context,
+                                    buffer,
+                                    meterInPixel,
+                                    meterInMM)) {
+        if (firstMatch==NULL) {
+          firstMatch=&selector;
+        }
 
-      if (!style) {
-        style=selector.style;
-        fastpath=true;
+        if (index<64) {
+          matches|=(uint64_t)1 << index;
+        }
 
-        continue;
+        matchCount++;
       }
 
-      if (fastpath) {
-        style=std::make_shared<S>(*style);
-        fastpath=false;
+      index++;
+    }
+
+    if (matchCount==0) {
+      return;
+    }
+
+    // Fastpath
+    if (matchCount==1) {
+      style=firstMatch->style;
+
+      return;
+    }
+
+    typename ComposedStyleCache<S>::Key key;
+    bool                                cacheable=selectors.size()<=64;
+
+    key.selectors=&selectors;
+    key.matches=matches;
+
+    if (cacheable &&
+        cache.GetStyle(key,style)) {
+      return;
+    }
+
+    style=std::make_shared<S>(*firstMatch->style);
+
+    index=0;
+    for (const auto& selector : selectors) {
+      if (&selector!=firstMatch) {
+        bool matched;
+
+        if (cacheable) {
+          matched=(matches & ((uint64_t)1 << index))!=0;
+        }
+        else {
+          matched=selector.criteria.Matches(context,
+                                            buffer,
+                                            meterInPixel,
+                                            meterInMM);
+        }
+
+        if (matched) {
+          style->CopyAttributes(*selector.style,
+                                selector.attributes);
+        }
       }
 
-      style->CopyAttributes(*selector.style,
-                            selector.attributes);
-      composed=true;
+      index++;
     }
 
-    if (composed &&
-        !style->IsVisible()) {
+    if (!style->IsVisible()) {
       style=NULL;
     }
+
+    if (cacheable) {
+      cache.SetStyle(key,style);
+    }
   }
 
   void StyleConfig::GetNodeTextStyles(const FeatureValueBuffer& buffer,
@@ -2318,6 +2390,7 @@ namespace osmscout {
                       nodeTextStyleSelectors[slot][buffer.GetType()->GetIndex()],
                       buffer,
                       projection,
+                      composedTextStyles,
                       style);
 
       if (style) {
@@ -2334,6 +2407,7 @@ namespace osmscout {
                     nodeIconStyleSelectors[buffer.GetType()->GetIndex()],
                     buffer,
                     projection,
+                    composedIconStyles,
                     iconStyle);
   }
 
@@ -2353,6 +2427,7 @@ namespace osmscout {
                       wayLineStyleSelectors[slot][buffer.GetType()->GetIndex()],
                       buffer,
                       projection,
+                      composedLineStyles,
                       style);
 
       if (style) {
@@ -2369,6 +2444,7 @@ namespace osmscout {
                     wayPathTextStyleSelectors[buffer.GetType()->GetIndex()],
                     buffer,
                     projection,
+                    composedPathTextStyles,
                     pathTextStyle);
   }
 
@@ -2380,6 +2456,7 @@ namespace osmscout {
                     wayPathSymbolStyleSelectors[buffer.GetType()->GetIndex()],
                     buffer,
                     projection,
+                    composedPathSymbolStyles,
                     pathSymbolStyle);
   }
 
@@ -2391,6 +2468,7 @@ namespace osmscout {
                     wayPathShieldStyleSelectors[buffer.GetType()->GetIndex()],
                     buffer,
                     projection,
+                    composedPathShieldStyles,
                     pathShieldStyle);
   }
 
@@ -2403,6 +2481,7 @@ namespace osmscout {
                     areaFillStyleSelectors[type->GetIndex()],
                     buffer,
                     projection,
+                    composedFillStyles,
                     fillStyle);
   }
 
@@ -2423,6 +2502,7 @@ namespace osmscout {
                       areaTextStyleSelectors[slot][type->GetIndex()],
                       buffer,
                       projection,
+                      composedTextStyles,
                       style);
 
       if (style) {
@@ -2440,6 +2520,7 @@ namespace osmscout {
                     areaIconStyleSelectors[type->GetIndex()],
                     buffer,
                     projection,
+                    composedIconStyles,
                     iconStyle);
   }
 
@@ -2450,6 +2531,7 @@ namespace osmscout {
                     areaFillStyleSelectors[tileLandBuffer.GetType()->GetIndex()],
                     tileLandBuffer,
                     projection,
+                    composedFillStyles,
                     fillStyle);
   }
 
@@ -2460,6 +2542,7 @@ namespace osmscout {
                     areaFillStyleSelectors[tileSeaBuffer.GetType()->GetIndex()],
                     tileSeaBuffer,
                     projection,
+                    composedFillStyles,
                     fillStyle);
   }
 
@@ -2470,6 +2553,7 @@ namespace osmscout {
                     areaFillStyleSelectors[tileCoastBuffer.GetType()->GetIndex()],
                     tileCoastBuffer,
                     projection,
+                    composedFillStyles,
                     fillStyle);
   }
 
@@ -2480,6 +2564,7 @@ namespace osmscout {
                     areaFillStyleSelectors[tileUnknownBuffer.GetType()->GetIndex()],
                     tileUnknownBuffer,
                     projection,
+                    composedFillStyles,
                     fillStyle);
   }
 
@@ -2491,10 +2576,30 @@ namespace osmscout {
                       wayLineStyleSelectors[slot][tileCoastlineBuffer.GetType()->GetIndex()],
                       tileCoastlineBuffer,
                       projection,
+                      composedLineStyles,
                       lineStyle);
     }
   }
 
+  /**
+   * Return the number of cached composed styles and the number of cache
+   * hits and misses for all style types.
+   */
+  void StyleConfig::GetComposedStyleStatistics(ComposedStyleStatistics& statistics) const
+  {
+    statistics.entries=0;
+    statistics.hits=0;
+    statistics.misses=0;
+
+    composedTextStyles.AddStatistics(statistics);
+    composedIconStyles.AddStatistics(statistics);
+    composedLineStyles.AddStatistics(statistics);
+    composedPathTextStyles.AddStatistics(statistics);
+    composedPathSymbolStyles.AddStatistics(statistics);
+    composedPathShieldStyles.AddStatistics(statistics);
+    composedFillStyles.AddStatistics(statistics);
+  }
+
   void StyleConfig::GetNodeTextStyleSelectors(size_t level,
                                               const TypeInfoRef& type,
                                               std::list<TextStyleSelector>& selectors) const
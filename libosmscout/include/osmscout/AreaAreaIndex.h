@@ -25,8 +25,9 @@
 
 #include <osmscout/TypeSet.h>
 
-#include <osmscout/util/Cache.h>
+#include <osmscout/util/ConcurrentCache.h>
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileScannerPool.h>
 
 namespace osmscout {
 
@@ -65,22 +66,9 @@ namespace osmscout {
       std::vector<IndexEntry> areas;
     };
 
-    typedef Cache<FileOffset,IndexCell> IndexCache;
+    typedef std::shared_ptr<IndexCell> IndexCellRef;
 
-    struct IndexCacheValueSizer : public IndexCache::ValueSizer
-    {
-      size_t GetSize(const IndexCell& value) const
-      {
-        size_t memory=0;
-
-        memory+=sizeof(value);
-
-        // Areas
-        memory+=value.areas.size()*sizeof(IndexEntry);
-
-        return memory;
-      }
-    };
+    typedef ConcurrentCache<FileOffset,IndexCellRef> IndexCache;
 
     struct CellRef
     {
@@ -102,7 +90,7 @@ namespace osmscout {
   private:
     std::string                     filepart;       //!< name of the data file
     std::string                     datafilename;   //!< Fullpath and name of the data file
-    mutable FileScanner             scanner;        //!< Scanner instance for reading this file
+    mutable FileScannerPool         scanners;       //!< Scanner instances for reading this file
 
     std::vector<double>             cellWidth;      //!< Precalculated cellWidth for each level of the quadtree
     std::vector<double>             cellHeight;     //!< Precalculated cellHeight for each level of the quadtree
@@ -112,10 +100,11 @@ namespace osmscout {
     mutable IndexCache              indexCache;     //!< Cached map of all index entries by file offset
 
   private:
-    bool GetIndexCell(const TypeConfig& typeConfig,
+    bool GetIndexCell(FileScanner& scanner,
+                      const TypeConfig& typeConfig,
                       uint32_t level,
                       FileOffset offset,
-                      IndexCache::CacheRef& cacheRef) const;
+                      IndexCellRef& cell) const;
 
   public:
     AreaAreaIndex(size_t cacheSize);
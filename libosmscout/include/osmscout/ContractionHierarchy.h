@@ -0,0 +1,191 @@
+#ifndef OSMSCOUT_CONTRACTIONHIERARCHY_H
+#define OSMSCOUT_CONTRACTIONHIERARCHY_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/ObjectRef.h>
+#include <osmscout/RoutingProfile.h>
+#include <osmscout/TypeConfig.h>
+#include <osmscout/Types.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Routing
+   * An edge in the contraction hierarchy. An edge either represents a path
+   * of the routing graph or a shortcut, replacing the two edges
+   * from and to the (contracted) middle node.
+   *
+   * Edges are always stored at the node with the lower rank. The direction
+   * of the edge (as in the routing graph) depends on the list the edge is
+   * stored in (see CHNode).
+   */
+  struct OSMSCOUT_API CHEdge
+  {
+    static const uint32_t noMiddle;   //!< Value of middle for edges that are not shortcuts
+    static const double   costFactor; //!< Factor between routing costs and the stored weight
+
+    uint32_t      target;      //!< Index of the other (higher ranked) node of the edge
+    uint32_t      weight;      //!< Costs of the edge, multiplied by costFactor
+    uint32_t      middle;      //!< Index of the contracted middle node for shortcuts, else noMiddle
+    uint32_t      firstNode;   //!< Index of the node reached by the first path of the edge
+    ObjectFileRef firstObject; //!< Object of the first path of the edge
+    ObjectFileRef lastObject;  //!< Object of the last path of the edge
+
+    inline bool IsShortcut() const
+    {
+      return middle!=noMiddle;
+    }
+
+    inline double GetCosts() const
+    {
+      return weight/costFactor;
+    }
+  };
+
+  /**
+   * \ingroup Routing
+   * A turn restriction at a node of the contraction hierarchy. You
+   * cannot use the path via the target object to the target node if
+   * you come from the source object.
+   */
+  struct OSMSCOUT_API CHExclude
+  {
+    ObjectFileRef source;       //!< The source object
+    ObjectFileRef targetObject; //!< The object of the forbidden path
+    uint32_t      targetNode;   //!< Index of the node the forbidden path leads to
+  };
+
+  /**
+   * \ingroup Routing
+   * A node in the contraction hierarchy, referencing a route node.
+   */
+  class OSMSCOUT_API CHNode
+  {
+  public:
+    FileOffset             routeNodeOffset; //!< File offset of the route node
+    std::vector<CHEdge>    upEdges;         //!< Edges from this node to nodes with higher rank
+    std::vector<CHEdge>    downEdges;       //!< Edges from nodes with higher rank to this node
+    std::vector<CHExclude> excludes;        //!< Turn restrictions at this node
+
+  public:
+    bool IsTurnForbidden(const ObjectFileRef& source,
+                         const CHEdge& edge) const;
+
+    bool Read(FileScanner& scanner);
+    bool Write(FileWriter& writer) const;
+  };
+
+  /**
+   * \ingroup Routing
+   * The metric the contraction hierarchy was calculated with. The hierarchy
+   * can only be used for routing profiles with exactly the same metric
+   * (fastest path, same vehicle, same maximum speed and same speed table).
+   */
+  class OSMSCOUT_API CHMetric
+  {
+  public:
+    static const double speedFactor; //!< Factor between speeds and the stored values
+
+  public:
+    Vehicle                        vehicle;         //!< The vehicle
+    uint32_t                       vehicleMaxSpeed; //!< Maximum speed of the vehicle, multiplied by speedFactor
+    std::map<std::string,uint32_t> speeds;          //!< Speed multiplied by speedFactor by type name
+
+  public:
+    CHMetric();
+
+    bool Set(const TypeConfig& typeConfig,
+             const RoutingProfile& profile);
+
+    bool operator==(const CHMetric& other) const;
+
+    bool Read(FileScanner& scanner);
+    bool Write(FileWriter& writer) const;
+  };
+
+  /**
+   * \ingroup Routing
+   * The contraction hierarchy for one vehicle as written by the import
+   * and loaded (completely into memory) by the RoutingService.
+   *
+   * The file starts with the file format version, the size of the route
+   * graph data file the hierarchy was calculated from and the metric used.
+   */
+  class OSMSCOUT_API ContractionHierarchy
+  {
+  public:
+    static const uint32_t fileFormatVersion; //!< Current version of the file format
+
+  private:
+    CHMetric                                metric;      //!< The metric used for calculating the hierarchy
+    std::vector<CHNode>                     nodes;       //!< Nodes of the hierarchy
+    std::unordered_map<FileOffset,uint32_t> nodeIndexes; //!< Node index by route node file offset
+
+  public:
+    bool Load(const std::string& filename,
+              FileOffset graphFileSize);
+    void Clear();
+
+    static bool WriteHeader(FileWriter& writer,
+                            FileOffset graphFileSize,
+                            const CHMetric& metric,
+                            uint32_t nodeCount);
+
+    bool IsCompatible(const TypeConfig& typeConfig,
+                      const RoutingProfile& profile) const;
+
+    inline bool IsEmpty() const
+    {
+      return nodes.empty();
+    }
+
+    inline size_t GetNodeCount() const
+    {
+      return nodes.size();
+    }
+
+    inline const CHNode& GetNode(uint32_t index) const
+    {
+      return nodes[index];
+    }
+
+    bool GetNodeIndex(FileOffset routeNodeOffset,
+                      uint32_t& index) const;
+
+    bool UnpackEdge(uint32_t from,
+                    uint32_t to,
+                    const CHEdge& edge,
+                    std::vector<uint32_t>& nodes,
+                    std::vector<ObjectFileRef>& objects) const;
+  };
+}
+
+#endif
@@ -29,16 +29,38 @@
 
 #include <osmscout/util/Cache.h>
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileScannerPool.h>
 
 namespace osmscout {
 
   /**
    * \ingroup Database
+   *
+   * Access to the coordinates of all nodes (by their OSM id) as generated by the
+   * import. Coordinates are stored in pages of a fixed number of consecutive ids.
+   * Pages with consecutive page ids are stored in ranges, so for the lookup of a
+   * coordinate only the range must be found (in a small, sorted index), after
+   * that the file offset is a simple calculation.
+   *
+   * The file starts with a 0 marker followed by the file format version. Files
+   * written before the page ranges were introduced start with the page size
+   * instead and are rejected.
+   *
+   * Get() can be called from multiple threads at the same time.
    */
   class OSMSCOUT_API CoordDataFile
   {
   private:
-    typedef std::unordered_map<PageId,FileOffset> CoordPageOffsetMap;
+    /**
+     * A range of coordinate pages with consecutive page ids, that are stored
+     * consecutively in the data file
+     */
+    struct PageRange
+    {
+      PageId     firstPageId; //!< Id of the first page in the range
+      PageId     pageCount;   //!< Number of pages in the range
+      FileOffset offset;      //!< File offset of the first page
+    };
 
   public:
     struct CoordEntry
@@ -56,13 +78,20 @@ namespace osmscout {
 
     typedef std::unordered_map<OSMId,CoordEntry> CoordResultMap;
 
+  public:
+    static const uint32_t fileFormatVersion=1;
+
+  private:
+    bool                    isOpen;             //!< If true,the data file is opened
+    std::string             datafile;           //!< Basename part of the data file name
+    std::string             datafilename;       //!< complete filename for data file
+    mutable FileScannerPool scanners;           //!< File streams to the data file
+    uint32_t                coordPageSize;      //!< Number of coordinates in a page
+    std::vector<PageRange>  pageRanges;         //!< Page ranges, sorted by page id
+
   private:
-    bool                isOpen;             //!< If true,the data file is opened
-    std::string         datafile;           //!< Basename part of the data file name
-    std::string         datafilename;       //!< complete filename for data file
-    mutable FileScanner scanner;            //!< File stream to the data file
-    uint32_t            coordPageSize;
-    CoordPageOffsetMap  coordPageOffsetMap;
+    static bool IsPageBeforeRange(PageId pageId,
+                                  const PageRange& range);
 
   public:
     CoordDataFile(const std::string& datafile);
@@ -20,6 +20,7 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <limits>
 #include <memory>
 #include <set>
 #include <unordered_map>
@@ -27,8 +28,9 @@
 
 #include <osmscout/NumericIndex.h>
 
-#include <osmscout/util/Cache.h>
+#include <osmscout/util/ConcurrentCache.h>
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileScannerPool.h>
 
 namespace osmscout {
 
@@ -38,6 +40,13 @@ namespace osmscout {
    * Access to standard format data files.
    *
    * Allows to load data objects by offset using various standard library data structures.
+   *
+   * Loading is threadsafe, multiple threads can load data at the same time
+   * (each using its own file scanner).
+   *
+   * Loaded objects are cached. The cache is limited by the number of
+   * entries and by memory, where the memory of an object is estimated by its
+   * in-memory base size plus its serialized size in the data file.
    */
   template <class N>
   class DataFile
@@ -46,36 +55,31 @@ namespace osmscout {
     typedef std::shared_ptr<N> ValueType;
 
   private:
-    typedef Cache<FileOffset,ValueType> DataCache;
-
-    struct DataCacheValueSizer : public DataCache::ValueSizer
-    {
-      size_t GetSize(const ValueType& value) const
-      {
-        return sizeof(value);
-      }
-    };
+    typedef ConcurrentCache<FileOffset,ValueType> DataCache;
 
   private:
-    std::string         datafile;        //!< Basename part of the data file name
-    std::string         datafilename;    //!< complete filename for data file
-    FileScanner::Mode   modeData;        //!< Type of file access
-    bool                memoryMapedData; //!< Use memory mapped files for data access
-    mutable DataCache   cache;           //!< Entry cache
-    mutable FileScanner scanner;         //!< File stream to the data file
+    std::string             datafile;        //!< Basename part of the data file name
+    std::string             datafilename;    //!< complete filename for data file
+    mutable DataCache       cache;           //!< Entry cache
+    mutable FileScannerPool scanners;        //!< File streams to the data file
 
   protected:
-    bool                isOpen;          //!< If true,the data file is opened
-    TypeConfigRef       typeConfig;
+    bool                    isOpen;          //!< If true,the data file is opened
+    TypeConfigRef           typeConfig;
 
   private:
     bool ReadData(const TypeConfig& typeConfig,
                   FileScanner& scanner,
                   N& data) const;
 
+    bool GetEntry(FileScanner& scanner,
+                  FileOffset offset,
+                  ValueType& entry) const;
+
   public:
     DataFile(const std::string& datafile,
-                 unsigned long dataCacheSize);
+             unsigned long dataCacheSize,
+             size_t dataCacheMemory=std::numeric_limits<size_t>::max());
 
     virtual ~DataFile();
 
@@ -105,11 +109,11 @@ namespace osmscout {
 
   template <class N>
   DataFile<N>::DataFile(const std::string& datafile,
-                        unsigned long dataCacheSize)
+                        unsigned long dataCacheSize,
+                        size_t dataCacheMemory)
   : datafile(datafile),
-    modeData(FileScanner::LowMemRandom),
-    memoryMapedData(false),
-    cache(dataCacheSize),
+    cache(dataCacheSize,
+          dataCacheMemory),
     isOpen(false)
 
   {
@@ -133,6 +137,43 @@ namespace osmscout {
                      scanner);
   }
 
+  /**
+   * Return the entry at the given offset, either from the cache or by
+   * reading it using the given scanner.
+   *
+   * If two threads read the same entry at the same time, the entry
+   * inserted first into the cache wins.
+   */
+  template <class N>
+  bool DataFile<N>::GetEntry(FileScanner& scanner,
+                             FileOffset offset,
+                             ValueType& entry) const
+  {
+    if (cache.GetEntry(offset,entry)) {
+      return true;
+    }
+
+    ValueType  value=std::make_shared<N>();
+    FileOffset endOffset;
+
+    if (!scanner.SetPos(offset) ||
+        !ReadData(*typeConfig,
+                  scanner,
+                  *value) ||
+        !scanner.GetPos(endOffset)) {
+      std::cerr << "Error while reading data from offset " << offset << " of file " << datafilename << "!" << std::endl;
+      return false;
+    }
+
+    cache.InsertEntry(offset,
+                      value,
+                      sizeof(N)+(size_t)(endOffset-offset));
+
+    entry=value;
+
+    return true;
+  }
+
   template <class N>
   bool DataFile<N>::Open(const TypeConfigRef& typeConfig,
                          const std::string& path,
@@ -143,10 +184,7 @@ namespace osmscout {
 
     datafilename=AppendFileToDir(path,datafile);
 
-    this->memoryMapedData=memoryMapedData;
-    this->modeData=modeData;
-
-    isOpen=scanner.Open(datafilename,modeData,memoryMapedData);
+    isOpen=scanners.Open(datafilename,modeData,memoryMapedData);
 
     return isOpen;
   }
@@ -164,14 +202,15 @@ namespace osmscout {
 
     typeConfig=NULL;
 
-    if (scanner.IsOpen()) {
-      if (!scanner.Close()) {
+    if (scanners.IsOpen()) {
+      if (!scanners.Close()) {
         success=false;
       }
     }
 
     isOpen=false;
-    cache.Flush();
+
+    FlushCache();
 
     return success;
   }
@@ -182,61 +221,25 @@ namespace osmscout {
   {
     assert(isOpen);
 
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,modeData,memoryMapedData)) {
-        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-        return false;
-      }
+    PooledFileScanner scanner(scanners);
+
+    if (!scanner.IsValid()) {
+      std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
+      return false;
     }
 
     data.reserve(data.size()+offsets.size());
 
-    if (!cache.IsActive()) {
-      for (std::vector<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        ValueType value=std::make_shared<N>();
-
-        scanner.SetPos(*offset);
-
-        if (!ReadData(*typeConfig,
-                      scanner,
-                      *value)) {
-          std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-          // TODO: Remove broken entry from cache
-          scanner.Close();
-          return false;
-        }
+    for (const auto& offset : offsets) {
+      ValueType value;
 
-        data.push_back(value);
-      }
-    }
-    else {
-      typename DataCache::CacheRef cacheRef;
-
-      for (std::vector<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        if (!cache.GetEntry(*offset,cacheRef)) {
-          typename DataCache::CacheEntry cacheEntry(*offset);
-
-          cacheRef=cache.SetEntry(cacheEntry);
-
-          scanner.SetPos(*offset);
-          cacheRef->value=std::make_shared<N>();
-
-          if (!ReadData(*typeConfig,
-                        scanner,
-                        *cacheRef->value)) {
-            std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-            // TODO: Remove broken entry from cache
-            scanner.Close();
-            return false;
-          }
-        }
-
-        data.push_back(cacheRef->value);
+      if (!GetEntry(*scanner,
+                    offset,
+                    value)) {
+        return false;
       }
+
+      data.push_back(value);
     }
 
     return true;
@@ -248,61 +251,25 @@ namespace osmscout {
   {
     assert(isOpen);
 
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,modeData,memoryMapedData)) {
-        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-        return false;
-      }
+    PooledFileScanner scanner(scanners);
+
+    if (!scanner.IsValid()) {
+      std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
+      return false;
     }
 
     data.reserve(data.size()+offsets.size());
 
-    if (!cache.IsActive()) {
-      for (std::list<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        ValueType value=std::make_shared<N>();
-
-        scanner.SetPos(*offset);
+    for (const auto& offset : offsets) {
+      ValueType value;
 
-        if (!ReadData(*typeConfig,
-                      scanner,
-                      *value)) {
-          std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-          // TODO: Remove broken entry from cache
-          scanner.Close();
-          return false;
-        }
-
-        data.push_back(value);
-      }
-    }
-    else {
-      typename DataCache::CacheRef cacheRef;
-
-      for (std::list<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        if (!cache.GetEntry(*offset,cacheRef)) {
-          typename DataCache::CacheEntry cacheEntry(*offset);
-
-          cacheRef=cache.SetEntry(cacheEntry);
-
-          scanner.SetPos(*offset);
-          cacheRef->value=std::make_shared<N>();
-
-          if (!ReadData(*typeConfig,
-                        scanner,
-                        *cacheRef->value)) {
-            std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-            // TODO: Remove broken entry from cache
-            scanner.Close();
-            return false;
-          }
-        }
-
-        data.push_back(cacheRef->value);
+      if (!GetEntry(*scanner,
+                    offset,
+                    value)) {
+        return false;
       }
+
+      data.push_back(value);
     }
 
     return true;
@@ -314,61 +281,25 @@ namespace osmscout {
   {
     assert(isOpen);
 
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,modeData,memoryMapedData)) {
-        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-        return false;
-      }
+    PooledFileScanner scanner(scanners);
+
+    if (!scanner.IsValid()) {
+      std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
+      return false;
     }
 
     data.reserve(data.size()+offsets.size());
 
-    if (!cache.IsActive()) {
-      for (std::set<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        ValueType value=std::make_shared<N>();
-
-        scanner.SetPos(*offset);
-
-        if (!ReadData(*typeConfig,
-                      scanner,
-                      *value)) {
-          std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-          // TODO: Remove broken entry from cache
-          scanner.Close();
-          return false;
-        }
+    for (const auto& offset : offsets) {
+      ValueType value;
 
-        data.push_back(value);
-      }
-    }
-    else {
-      typename DataCache::CacheRef cacheRef;
-
-      for (std::set<FileOffset>::const_iterator offset=offsets.begin();
-           offset!=offsets.end();
-           ++offset) {
-        if (!cache.GetEntry(*offset,cacheRef)) {
-          typename DataCache::CacheEntry cacheEntry(*offset);
-
-          cacheRef=cache.SetEntry(cacheEntry);
-
-          scanner.SetPos(*offset);
-          cacheRef->value=std::make_shared<N>();
-
-          if (!ReadData(*typeConfig,
-                        scanner,
-                        *cacheRef->value)) {
-            std::cerr << "Error while reading data from offset " << *offset << " of file " << datafilename << "!" << std::endl;
-            // TODO: Remove broken entry from cache
-            scanner.Close();
-            return false;
-          }
-        }
-
-        data.push_back(cacheRef->value);
+      if (!GetEntry(*scanner,
+                    offset,
+                    value)) {
+        return false;
       }
+
+      data.push_back(value);
     }
 
     return true;
@@ -399,54 +330,16 @@ namespace osmscout {
   {
     assert(isOpen);
 
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,modeData,memoryMapedData)) {
-        std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
-        return false;
-      }
-    }
-
-    if (!cache.IsActive()) {
-      ValueType value=std::make_shared<N>();
-
-      scanner.SetPos(offset);
+    PooledFileScanner scanner(scanners);
 
-      if (!ReadData(*typeConfig,
-                    scanner,
-                    *value)) {
-        std::cerr << "Error while reading data from offset " << offset << " of file " << datafilename << "!" << std::endl;
-        // TODO: Remove broken entry from cache
-        scanner.Close();
-        return false;
-      }
-
-      entry=value;
-    }
-    else {
-      typename DataCache::CacheRef cacheRef;
-
-      if (!cache.GetEntry(offset,cacheRef)) {
-        typename DataCache::CacheEntry cacheEntry(offset);
-
-        cacheRef=cache.SetEntry(cacheEntry);
-
-        scanner.SetPos(offset);
-        cacheRef->value=std::make_shared<N>();
-
-        if (!ReadData(*typeConfig,
-                      scanner,
-                      *cacheRef->value)) {
-          std::cerr << "Error while reading data from offset " << offset << " of file " << datafilename << "!" << std::endl;
-          // TODO: Remove broken entry from cache
-          scanner.Close();
-          return false;
-        }
-      }
-
-      entry=cacheRef->value;
+    if (!scanner.IsValid()) {
+      std::cerr << "Error while opening " << datafilename << " for reading!" << std::endl;
+      return false;
     }
 
-    return true;
+    return GetEntry(*scanner,
+                    offset,
+                    entry);
   }
 
   template <class N>
@@ -458,7 +351,7 @@ namespace osmscout {
   template <class N>
   void DataFile<N>::DumpStatistics() const
   {
-    cache.DumpStatistics(datafile.c_str(),DataCacheValueSizer());
+    cache.DumpStatistics(datafile.c_str());
   }
 
 
@@ -26,6 +26,12 @@
 #include <unordered_map>
 #include <vector>
 
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+#include <mutex>
+#endif
+
 // Type and style sheet configuration
 #include <osmscout/Types.h>
 #include <osmscout/TypeConfig.h>
@@ -46,6 +52,8 @@
 
 // Location index
 #include <osmscout/LocationIndex.h>
+#include <osmscout/LocationSearchIndex.h>
+#include <osmscout/ReverseLocationIndex.h>
 
 // Water index
 #include <osmscout/WaterIndex.h>
@@ -70,7 +78,8 @@ namespace osmscout {
     instance.
 
     The following attributes are currently available:
-    * cache sizes.
+    * cache sizes (in number of entries).
+    * cache memory limits for data files (in bytes).
     */
   class OSMSCOUT_API DatabaseParameter
   {
@@ -79,10 +88,13 @@ namespace osmscout {
     unsigned long areaNodeIndexCacheSize;
 
     unsigned long nodeCacheSize;
+    size_t        nodeCacheMemory;
 
     unsigned long wayCacheSize;
+    size_t        wayCacheMemory;
 
     unsigned long areaCacheSize;
+    size_t        areaCacheMemory;
 
   public:
     DatabaseParameter();
@@ -91,19 +103,25 @@ namespace osmscout {
     void SetAreaNodeIndexCacheSize(unsigned long areaNodeIndexCacheSize);
 
     void SetNodeCacheSize(unsigned long nodeCacheSize);
+    void SetNodeCacheMemory(size_t nodeCacheMemory);
 
     void SetWayCacheSize(unsigned long wayCacheSize);
+    void SetWayCacheMemory(size_t wayCacheMemory);
 
     void SetAreaCacheSize(unsigned long relationCacheSize);
+    void SetAreaCacheMemory(size_t areaCacheMemory);
 
     unsigned long GetAreaAreaIndexCacheSize() const;
     unsigned long GetAreaNodeIndexCacheSize() const;
 
     unsigned long GetNodeCacheSize() const;
+    size_t GetNodeCacheMemory() const;
 
     unsigned long GetWayCacheSize() const;
+    size_t GetWayCacheMemory() const;
 
     unsigned long GetAreaCacheSize() const;
+    size_t GetAreaCacheMemory() const;
   };
 
   /**
@@ -116,6 +134,10 @@ namespace osmscout {
    *
    * The Database is opened by passing the directory that contains
    * all database files.
+   *
+   * Data files and indexes are opened on first access. Data files and
+   * indexes can be queried from multiple threads at the same time, so one
+   * Database instance can be shared by all threads of a process.
    */
   class OSMSCOUT_API Database
   {
@@ -138,12 +160,20 @@ namespace osmscout {
     mutable AreaAreaIndexRef        areaAreaIndex;        //!< Index of ways by containing area
 
     mutable LocationIndexRef        locationIndex;        //!< Location-based index
+    mutable LocationSearchIndexRef  locationSearchIndex;  //!< Index for searching locations by name
+    mutable ReverseLocationIndexRef reverseLocationIndex; //!< Index for coordinate based location lookup
+    mutable bool                    searchIndexFailed;    //!< Loading of the location search index failed before
+    mutable bool                    reverseIndexFailed;   //!< Loading of the reverse location index failed before
 
     mutable WaterIndexRef           waterIndex;           //!< Index of land/sea tiles
 
     mutable OptimizeAreasLowZoomRef optimizeAreasLowZoom; //!< Optimized data for low zoom situations
     mutable OptimizeWaysLowZoomRef  optimizeWaysLowZoom;  //!< Optimized data for low zoom situations
 
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    mutable std::mutex              mutex;                //!< Mutex guarding opening of data files and indexes
+#endif
+
   public:
     Database(const DatabaseParameter& parameter);
     virtual ~Database();
@@ -166,6 +196,8 @@ namespace osmscout {
     AreaWayIndexRef GetAreaWayIndex() const;
 
     LocationIndexRef GetLocationIndex() const;
+    LocationSearchIndexRef GetLocationSearchIndex() const;
+    ReverseLocationIndexRef GetReverseLocationIndex() const;
 
     WaterIndexRef GetWaterIndex() const;
 
@@ -29,6 +29,7 @@
 #include <osmscout/TypeConfig.h>
 
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileScannerPool.h>
 
 namespace osmscout {
 
@@ -55,6 +56,7 @@ namespace osmscout {
     std::unordered_set<std::string> regionIgnoreTokens;
     std::unordered_set<std::string> locationIgnoreTokens;
     FileOffset                      indexOffset;
+    mutable FileScannerPool         scanners;                //!< Scanner instances for lookups by offset
 
   private:
     bool Read(FileScanner& scanner,
@@ -63,6 +65,9 @@ namespace osmscout {
     bool LoadAdminRegion(FileScanner& scanner,
                          AdminRegion& region) const;
 
+    bool LoadLocation(FileScanner& scanner,
+                      Location& location) const;
+
     AdminRegionVisitor::Action VisitRegionEntries(FileScanner& scanner,
                                                   AdminRegionVisitor& visitor) const;
 
@@ -113,6 +118,13 @@ namespace osmscout {
     bool ResolveAdminRegionHierachie(const AdminRegionRef& region,
                                      std::map<FileOffset,AdminRegionRef>& refs) const;
 
+    bool GetAdminRegionByOffset(FileOffset offset,
+                                AdminRegionRef& region) const;
+
+    bool GetLocationByOffset(const AdminRegion& region,
+                             FileOffset offset,
+                             LocationRef& location) const;
+
     void DumpStatistics();
   };
 
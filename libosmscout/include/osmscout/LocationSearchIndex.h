@@ -0,0 +1,139 @@
+#ifndef OSMSCOUT_LOCATIONSEARCHINDEX_H
+#define OSMSCOUT_LOCATIONSEARCHINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <osmscout/ObjectRef.h>
+#include <osmscout/Types.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileScannerPool.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Database
+   * Index for searching admin regions, locations and POIs of the location
+   * index by (part of) their name.
+   *
+   * All names are normalized (see NormalizeName()) and split into n-grams
+   * of NGRAM_LENGTH bytes. For every n-gram the index holds the sorted list
+   * of entries containing it. A pattern can only be contained in a name,
+   * if the name contains all n-grams of the pattern, so candidates are found
+   * by intersecting the lists of the n-grams of the pattern. The candidates
+   * are then verified against the normalized name stored in the entry.
+   *
+   * Locations and POIs are stored in the order of the admin region tree, so
+   * that the entries of an admin region and all its sub regions form a
+   * consecutive range.
+   */
+  class OSMSCOUT_API LocationSearchIndex
+  {
+  public:
+    static const char* const FILENAME_LOCATION_SEARCH_IDX;
+
+    //! Length of the n-grams in bytes, patterns must be at least that long
+    static const size_t      NGRAM_LENGTH=3;
+
+    /**
+     * An admin region whose name or alias contains the search pattern
+     */
+    struct OSMSCOUT_API RegionEntry
+    {
+      FileOffset    regionOffset;   //!< Offset of the admin region in the location index
+      uint32_t      aliasIndex;     //!< 0 for the name of the region, else the index of the alias plus one
+      bool          isMatch;        //!< The name is equal to the search pattern
+    };
+
+    /**
+     * A location or a POI whose name contains the search pattern
+     */
+    struct OSMSCOUT_API LocationEntry
+    {
+      FileOffset    regionOffset;   //!< Offset of the admin region in the location index
+      bool          isPOI;          //!< The entry is a POI and not a location
+      FileOffset    locationOffset; //!< Offset of the location in the location index, 0 for POIs
+      std::string   name;           //!< Name of the POI, empty for locations
+      ObjectFileRef object;         //!< Object of the POI, invalid for locations
+      bool          isMatch;        //!< The name is equal to the search pattern
+    };
+
+    /**
+     * Search for locations, that can be restricted to individual admin
+     * regions without searching the index again
+     */
+    struct OSMSCOUT_API LocationQuery
+    {
+      std::string             pattern;    //!< Normalized search pattern
+      std::vector<FileOffset> candidates; //!< Sorted offsets of the entries containing all n-grams of the pattern
+    };
+
+  private:
+    std::string             datafilename;               //!< Full path and name of the data file
+    mutable FileScannerPool scanners;                   //!< Scanner instances for reading this file
+
+    uint8_t                 bytesForLocationFileOffset;
+    FileOffset              regionTableOffset;
+    uint32_t                regionCount;
+    FileOffset              regionDictionaryOffset;
+    uint32_t                regionNGramCount;
+    FileOffset              locationDictionaryOffset;
+    uint32_t                locationNGramCount;
+
+  private:
+    bool GetCandidates(FileScanner& scanner,
+                       const std::string& pattern,
+                       FileOffset dictionaryOffset,
+                       uint32_t nGramCount,
+                       std::vector<FileOffset>& candidates) const;
+
+    bool GetRegionRange(FileScanner& scanner,
+                        FileOffset regionOffset,
+                        FileOffset& start,
+                        FileOffset& end) const;
+
+  public:
+    LocationSearchIndex();
+
+    static void NormalizeName(std::string& name);
+
+    bool Load(const std::string& path);
+
+    bool SearchRegions(const std::string& pattern,
+                       std::vector<RegionEntry>& entries) const;
+
+    bool PrepareLocationQuery(const std::string& pattern,
+                              LocationQuery& query) const;
+
+    bool SearchRegionLocations(const LocationQuery& query,
+                               FileOffset regionOffset,
+                               std::vector<LocationEntry>& entries) const;
+
+    void DumpStatistics();
+  };
+
+  typedef std::shared_ptr<LocationSearchIndex> LocationSearchIndexRef;
+}
+
+#endif
@@ -25,6 +25,7 @@
 
 #include <osmscout/Database.h>
 #include <osmscout/Location.h>
+#include <osmscout/LocationSearchIndex.h>
 
 namespace osmscout {
 
@@ -113,6 +114,7 @@ namespace osmscout {
    * - General interface for location lookup, offering default visitors for the
    *   individual index traversals.
    * - Retrieve the addresses of one or more objects.
+   * - Retrieve the admin region, location and address at a given coordinate.
    */
   class OSMSCOUT_API LocationService
   {
@@ -138,9 +140,6 @@ namespace osmscout {
        void Match(const std::string& name,
                   bool& match,
                   bool& candidate) const;
-
-     private:
-       void TolowerUmlaut(std::string& s) const;
      };
 
     class AdminRegionMatchVisitor : public AdminRegionVisitor, public VisitorMatcher
@@ -263,8 +262,23 @@ namespace osmscout {
     DatabaseRef database;
 
   private:
+    bool SearchAdminRegions(const LocationSearchIndexRef& locationSearchIndex,
+                            const std::string& pattern,
+                            size_t limit,
+                            std::list<AdminRegionMatchVisitor::AdminRegionResult>& results,
+                            bool& limitReached) const;
+
+    bool SearchAdminRegionLocations(const LocationSearchIndex& locationSearchIndex,
+                                    const LocationSearchIndex::LocationQuery& locationQuery,
+                                    const AdminRegionRef& adminRegion,
+                                    size_t limit,
+                                    std::list<LocationMatchVisitor::POIResult>& poiResults,
+                                    std::list<LocationMatchVisitor::LocationResult>& locationResults) const;
+
     bool HandleAdminRegion(const LocationSearch& search,
                            const LocationSearch::Entry& searchEntry,
+                           const LocationSearchIndexRef& locationSearchIndex,
+                           const LocationSearchIndex::LocationQuery& locationQuery,
                            const AdminRegionMatchVisitor::AdminRegionResult& adminRegionResult,
                            LocationSearchResult& result) const;
 
@@ -310,6 +324,10 @@ namespace osmscout {
                               std::list<ReverseLookupResult>& result) const;
     bool ReverseLookupObject(const ObjectFileRef& object,
                               std::list<ReverseLookupResult>& result) const;
+
+    bool ReverseLookupCoord(const GeoCoord& coord,
+                            double maxDistance,
+                            std::list<ReverseLookupResult>& result) const;
   };
 
   //! \ingroup Service
@@ -33,7 +33,8 @@ namespace osmscout {
   class NodeDataFile : public DataFile<Node>
   {
   public:
-    NodeDataFile(unsigned long dataCacheSize);
+    NodeDataFile(unsigned long dataCacheSize,
+                 size_t dataCacheMemory=std::numeric_limits<size_t>::max());
   };
 
   typedef std::shared_ptr<NodeDataFile> NodeDataFileRef;
@@ -20,14 +20,16 @@
   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 */
 
+#include <algorithm>
 #include <vector>
 
 #include <osmscout/TypeConfig.h>
 
-#include <osmscout/util/Cache.h>
+#include <osmscout/util/ConcurrentCache.h>
 #include <osmscout/util/Number.h>
 #include <osmscout/util/File.h>
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileScannerPool.h>
 #include <osmscout/util/String.h>
 
 namespace osmscout {
@@ -36,6 +38,8 @@ namespace osmscout {
     \ingroup Database
     Numeric index handles an index over instance of class <T> where the index criteria
     is of type <N>, where <N> has a numeric nature (usually Id).
+
+    Lookups are threadsafe.
     */
   template <class N>
   class NumericIndex
@@ -62,36 +66,24 @@ namespace osmscout {
 
     typedef std::shared_ptr<Page> PageRef;
 
-    typedef Cache<N,PageRef> PageCache;
-
-    /**
-      Returns the size of a individual cache entry
-      */
-    struct NumericIndexCacheValueSizer : public PageCache::ValueSizer
-    {
-      size_t GetSize(const PageRef& value) const
-      {
-        return sizeof(value)+sizeof(Page)+sizeof(Entry)*value->entries.size();
-      }
-    };
+    typedef ConcurrentCache<FileOffset,PageRef> PageCache;
 
   private:
     std::string                    filepart;
     std::string                    filename;
     unsigned long                  cacheSize;
-    mutable FileScanner            scanner;
-    bool                           memoryMaped;
-    FileScanner::Mode              mode;
+    mutable FileScannerPool        scanners;
     uint32_t                       pageSize;
     uint32_t                       levels;
     std::vector<uint32_t>          pageCounts;
-    char                           *buffer;
     PageRef                        root;
-    mutable std::vector<PageCache> leafs;
+    mutable PageCache              leafs;      //!< Cache of the pages below the root page by file offset
 
   private:
     size_t GetPageIndex(const PageRef& page, N id) const;
-    bool ReadPage(FileOffset offset, PageRef& page) const;
+    bool ReadPage(FileScanner& scanner,
+                  FileOffset offset,
+                  PageRef& page) const;
 
   public:
     NumericIndex(const std::string& filename,
@@ -116,11 +108,9 @@ namespace osmscout {
                                 unsigned long cacheSize)
    : filepart(filename),
      cacheSize(cacheSize),
-     memoryMaped(false),
-     mode(FileScanner::Normal),
      pageSize(0),
      levels(0),
-     buffer(NULL)
+     leafs(cacheSize)
   {
     // no code
   }
@@ -129,8 +119,6 @@ namespace osmscout {
   NumericIndex<N>::~NumericIndex()
   {
     Close();
-
-    delete [] buffer;
   }
 
   /**
@@ -169,8 +157,12 @@ namespace osmscout {
   }
 
   template <class N>
-  inline bool NumericIndex<N>::ReadPage(FileOffset offset, PageRef& page) const
+  inline bool NumericIndex<N>::ReadPage(FileScanner& scanner,
+                                        FileOffset offset,
+                                        PageRef& page) const
   {
+    std::vector<char> buffer(pageSize);
+
     if (!page) {
       page=std::make_shared<Page>();
     }
@@ -180,15 +172,9 @@ namespace osmscout {
 
     page->entries.reserve(pageSize);
 
-    if (!scanner.IsOpen() &&
-        !scanner.Open(filename,mode,memoryMaped)) {
-      std::cerr << "Cannot open '" << scanner.GetFilename() << "'!" << std::endl;
-      return false;
-    }
-
     scanner.SetPos(offset);
 
-    if (!scanner.Read(buffer,
+    if (!scanner.Read(buffer.data(),
                       pageSize)) {
       std::cerr << "Cannot read index page from file '" << scanner.GetFilename() << "'!" << std::endl;
       return false;
@@ -237,72 +223,66 @@ namespace osmscout {
     FileOffset  indexPageCountsOffset;
 
     filename=AppendFileToDir(path,filepart);
-    this->memoryMaped=memoryMaped;
-    this->mode=mode;
 
-    if (!scanner.Open(filename,mode,memoryMaped)) {
+    if (!scanners.Open(filename,mode,memoryMaped)) {
+      std::cerr << "Cannot open index file '" << filename << "'" << std::endl;
+      return false;
+    }
+
+    PooledFileScanner scanner(scanners);
+
+    if (!scanner.IsValid()) {
       std::cerr << "Cannot open index file '" << filename << "'" << std::endl;
       return false;
     }
 
-    scanner.ReadNumber(pageSize);                  // Size of one index page
-    scanner.ReadNumber(entries);                   // Number of entries in data file
+    scanner->ReadNumber(pageSize);                  // Size of one index page
+    scanner->ReadNumber(entries);                   // Number of entries in data file
 
-    scanner.Read(levels);                          // Number of levels
-    scanner.ReadFileOffset(lastLevelPageStart);    // Start of top level index page
-    scanner.ReadFileOffset(indexPageCountsOffset); // Start of list of sizes of index levels
+    scanner->Read(levels);                          // Number of levels
+    scanner->ReadFileOffset(lastLevelPageStart);    // Start of top level index page
+    scanner->ReadFileOffset(indexPageCountsOffset); // Start of list of sizes of index levels
 
-    if (scanner.HasError()) {
+    if (scanner->HasError()) {
       std::cerr << "Error while loading header data of index file '" << filename << "'" << std::endl;
       return false;
     }
 
     pageCounts.resize(levels);
 
-    scanner.SetPos(indexPageCountsOffset);
+    scanner->SetPos(indexPageCountsOffset);
     for (size_t level=0; level<levels; level++) {
-      scanner.ReadNumber(pageCounts[level]);
+      scanner->ReadNumber(pageCounts[level]);
     }
 
-    delete [] buffer;
-    buffer=new char[pageSize];
-
     //std::cout << entries << " entries to index, " << levels << " levels, pageSize " << pageSize << ", cache size " << cacheSize << std::endl;
 
-    ReadPage(lastLevelPageStart,root);
+    ReadPage(*scanner,
+             lastLevelPageStart,
+             root);
 
-    unsigned long currentCacheSize=cacheSize; // Available free space in cache
-    unsigned long requiredCacheSize=0;        // Space needed for caching everything
+    unsigned long requiredCacheSize=0; // Space needed for caching everything
 
     for (size_t i=1; i<pageCounts.size(); i++) {
-      unsigned long resultingCacheSize; // Cache size we actually use for this level
-
       requiredCacheSize+=pageCounts[i];
+    }
 
-      if (pageCounts[i]>currentCacheSize) {
-        resultingCacheSize=currentCacheSize;
-        currentCacheSize=0;
-      }
-      else {
-        resultingCacheSize=pageCounts[i];
-        currentCacheSize-=pageCounts[i];
-      }
-
-      if (requiredCacheSize>cacheSize) {
-        std::cerr << "Warning: Index " << filepart << " has cache size " << cacheSize<< ", but requires cache size " << requiredCacheSize << " to load index completely into cache!" << std::endl;
-      }
-
-      leafs.push_back(PageCache(resultingCacheSize));
+    if (requiredCacheSize>cacheSize) {
+      std::cerr << "Warning: Index " << filepart << " has cache size " << cacheSize<< ", but requires cache size " << requiredCacheSize << " to load index completely into cache!" << std::endl;
     }
 
-    return !scanner.HasError();
+    leafs.SetMaxSize(std::min(cacheSize,requiredCacheSize));
+
+    return !scanner->HasError();
   }
 
   template <class N>
   bool NumericIndex<N>::Close()
   {
-    if (scanner.IsOpen()) {
-      return scanner.Close();
+    leafs.Flush();
+
+    if (scanners.IsOpen()) {
+      return scanners.Close();
     }
 
     return true;
@@ -323,25 +303,32 @@ namespace osmscout {
 
     N startId=root->entries[r].startId;
     for (size_t level=0; level+2<=levels; level++) {
-      typename PageCache::CacheRef cacheRef;
+      PageRef page;
 
-      if (!leafs[level].GetEntry(startId,cacheRef)) {
-        typename PageCache::CacheEntry cacheEntry(startId);
+      if (!leafs.GetEntry(offset,page)) {
+        PooledFileScanner scanner(scanners);
 
-        cacheRef=leafs[level].SetEntry(cacheEntry);
+        if (!scanner.IsValid() ||
+            !ReadPage(*scanner,
+                      offset,
+                      page)) {
+          return false;
+        }
 
-        ReadPage(offset,cacheRef->value);
+        leafs.InsertEntry(offset,
+                          page,
+                          sizeof(Page)+sizeof(Entry)*page->entries.capacity());
       }
 
-      size_t i=GetPageIndex(cacheRef->value,id);
+      size_t i=GetPageIndex(page,id);
 
-      if (!cacheRef->value->IndexIsValid(i)) {
+      if (!page->IndexIsValid(i)) {
         //std::cerr << "Id " << id << " not found in index level " << level+2 << "!" << std::endl;
         return false;
       }
 
-      startId=cacheRef->value->entries[i].startId;
-      offset=cacheRef->value->entries[i].fileOffset;
+      startId=page->entries[i].startId;
+      offset=page->entries[i].fileOffset;
     }
 
     /*
@@ -412,19 +399,16 @@ namespace osmscout {
   template <class N>
   void NumericIndex<N>::DumpStatistics() const
   {
-    size_t memory=0;
-    size_t pages=0;
+    typename PageCache::Statistics statistics;
 
-    pages+=1;
-    memory+=root->entries.size()*sizeof(Entry);
+    leafs.GetStatistics(statistics);
 
+    size_t memory=root->entries.size()*sizeof(Entry)+statistics.memory;
+    size_t pages=1+statistics.entries;
 
-    for (size_t i=0; i<leafs.size(); i++) {
-      pages+=leafs[i].GetSize();
-      memory+=sizeof(leafs[i])+leafs[i].GetMemory(NumericIndexCacheValueSizer());
-    }
-
-    std::cout << "Index " << filepart << ": " << pages << " pages, memory " << memory << std::endl;
+    std::cout << "Index " << filepart << ": " << pages << " pages, memory " << memory;
+    std::cout << ", hits " << statistics.hits << ", misses " << statistics.misses;
+    std::cout << ", evictions " << statistics.evictions << std::endl;
   }
 }
 
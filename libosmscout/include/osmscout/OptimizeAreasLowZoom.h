@@ -30,6 +30,7 @@
 #include <osmscout/Way.h>
 
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileScannerPool.h>
 #include <osmscout/util/Magnification.h>
 
 namespace osmscout {
@@ -69,7 +70,7 @@ namespace osmscout {
     TypeConfigRef                         typeConfig;    //!< Metadata information for loading the actual obejcts
     std::string                           datafile;      //!< Basename part for the data file name
     std::string                           datafilename;  //!< complete filename for data file
-    mutable FileScanner                   scanner;       //!< File stream to the data file
+    mutable FileScannerPool               scanners;      //!< File streams to the data file
 
     double                                magnification; //!< Magnification, up to which we support optimization
     std::map<TypeId,std::list<TypeData> > areaTypesData; //!< Index information for all area types
@@ -78,7 +79,8 @@ namespace osmscout {
     bool ReadTypeData(FileScanner& scanner,
                       TypeData& data);
 
-    bool GetOffsets(const TypeData& typeData,
+    bool GetOffsets(FileScanner& scanner,
+                    const TypeData& typeData,
                     double minlon,
                     double minlat,
                     double maxlon,
@@ -0,0 +1,129 @@
+#ifndef OSMSCOUT_REVERSELOCATIONINDEX_H
+#define OSMSCOUT_REVERSELOCATIONINDEX_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <list>
+#include <memory>
+#include <string>
+
+#include <osmscout/GeoCoord.h>
+#include <osmscout/ObjectRef.h>
+#include <osmscout/Types.h>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileScannerPool.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Database
+   * Index for coordinate based reverse lookups (which admin region, location
+   * and address is at a given coordinate), that does not need to visit the
+   * complete location index.
+   *
+   * The world is divided into a grid of cells. For every cell the index holds
+   * the admin regions covering the cell, either marked as covering the complete
+   * cell or together with the parts of the region boundary crossing the cell.
+   * Every cell is further divided into sub cells, holding the addresses and the
+   * segments of locations (streets) within the sub cell. All entries reference
+   * their entries in the location index by file offset.
+   *
+   * Only cells with data are stored. For every row of cells the index holds
+   * a sorted list of runs of cells, that share the same data (cells without
+   * data or cells covered by the same regions), so lookups are a binary
+   * search within the row.
+   */
+  class OSMSCOUT_API ReverseLocationIndex
+  {
+  public:
+    static const char* const FILENAME_REVERSE_LOCATION_IDX;
+
+    //! Number of sub cells of a cell in each direction
+    static const uint32_t    SUB_CELL_DIMENSION=4;
+
+    /**
+     * An address or a location close to a given coordinate
+     */
+    struct OSMSCOUT_API Entry
+    {
+      FileOffset    regionOffset;   //!< Offset of the admin region in the location index
+      FileOffset    locationOffset; //!< Offset of the location in the location index
+      FileOffset    addressOffset;  //!< Offset of the address in the location index, 0 for locations
+      std::string   name;           //!< Name of the address, empty for locations
+      ObjectFileRef object;         //!< The object representing the address or the location
+      double        distance;       //!< Distance to the coordinate in km
+    };
+
+  private:
+    std::string             datafilename;               //!< Full path and name of the data file
+    mutable FileScannerPool scanners;                   //!< Scanner instances for reading this file
+
+    uint8_t                 bytesForLocationFileOffset;
+    uint32_t                cellLevel;
+    double                  cellWidth;
+    double                  cellHeight;
+    uint32_t                cellYStart;
+    uint32_t                cellYEnd;
+    FileOffset              rowTableOffset;             //!< Offset of the offsets of the runs of each row
+
+  private:
+    bool GetCellOffset(FileScanner& scanner,
+                       uint32_t x,
+                       uint32_t y,
+                       FileOffset& offset) const;
+
+    bool GetSubCellOffset(FileScanner& scanner,
+                          uint32_t subX,
+                          uint32_t subY,
+                          bool addresses,
+                          FileOffset& offset) const;
+
+    bool GetClosestEntry(const GeoCoord& coord,
+                         double maxDistance,
+                         bool addresses,
+                         Entry& entry,
+                         bool& found) const;
+
+  public:
+    ReverseLocationIndex();
+
+    bool Load(const std::string& path);
+
+    bool GetRegionOffsets(const GeoCoord& coord,
+                          std::list<FileOffset>& regionOffsets) const;
+
+    bool GetClosestAddress(const GeoCoord& coord,
+                           double maxDistance,
+                           Entry& address,
+                           bool& found) const;
+
+    bool GetClosestLocation(const GeoCoord& coord,
+                            double maxDistance,
+                            Entry& location,
+                            bool& found) const;
+
+    void DumpStatistics();
+  };
+
+  typedef std::shared_ptr<ReverseLocationIndex> ReverseLocationIndexRef;
+}
+
+#endif
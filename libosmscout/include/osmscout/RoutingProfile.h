@@ -35,6 +35,17 @@
 
 namespace osmscout {
 
+  /**
+   * \ingroup Routing
+   * Data structure the router uses for holding the route nodes, that still
+   * have to be analysed (the "open list" of the A* algorithm).
+   */
+  enum OpenListType
+  {
+    openListSet  = 0, //!< std::set based open list, every route node visited is allocated individually
+    openListHeap = 1  //!< Indexed 4-ary heap with decrease-key, visited route nodes are stored in a pool
+  };
+
   /**
    * \ingroup Routing
    * Abstract interface for a routing profile. A routing profile decides about the costs
@@ -67,6 +78,10 @@ namespace osmscout {
                            double distance) const = 0;
     virtual double GetTime(const Way& way,
                            double distance) const = 0;
+
+    virtual OpenListType GetOpenListType() const;
+    virtual bool IsBidirectional() const;
+    virtual bool UseContractionHierarchy() const;
   };
 
   typedef std::shared_ptr<RoutingProfile> RoutingProfileRef;
@@ -88,12 +103,24 @@ namespace osmscout {
     double                     minSpeed;
     double                     maxSpeed;
     double                     vehicleMaxSpeed;
+    OpenListType               openListType;
+    bool                       bidirectional;
+    bool                       contractionHierarchy;
+
+  public:
+    //! Default maximum speed of a car in km/h
+    static const double defaultCarMaxSpeed;
 
   public:
     AbstractRoutingProfile(const TypeConfigRef& typeConfig);
 
+    static void GetDefaultCarSpeedTable(std::map<std::string,double>& speedMap);
+
     void SetVehicle(Vehicle vehicle);
     void SetVehicleMaxSpeed(double maxSpeed);
+    void SetOpenListType(OpenListType openListType);
+    void SetBidirectional(bool bidirectional);
+    void SetUseContractionHierarchy(bool contractionHierarchy);
 
     void ParametrizeForFoot(const TypeConfig& typeConfig,
                             double maxSpeed);
@@ -108,6 +135,23 @@ namespace osmscout {
       return vehicle;
     }
 
+    inline double GetVehicleMaxSpeed() const
+    {
+      return vehicleMaxSpeed;
+    }
+
+    /**
+     * Returns the speed for the given type or 0, if the type cannot be used
+     */
+    inline double GetSpeed(const TypeInfo& type) const
+    {
+      return type.GetIndex()<speeds.size() ? speeds[type.GetIndex()] : 0.0;
+    }
+
+    OpenListType GetOpenListType() const;
+    bool IsBidirectional() const;
+    bool UseContractionHierarchy() const;
+
     void AddType(const TypeInfoRef& type, double speed);
 
     bool CanUse(const RouteNode& currentNode,
@@ -25,9 +25,18 @@
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <osmscout/CoreFeatures.h>
 
+#if defined(OSMSCOUT_HAVE_ATOMIC)
+#include <atomic>
+#endif
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+#include <mutex>
+#endif
+
 #include <osmscout/Point.h>
 
 #include <osmscout/TypeConfig.h>
@@ -38,12 +47,14 @@
 #include <osmscout/Database.h>
 
 // Routing
+#include <osmscout/ContractionHierarchy.h>
 #include <osmscout/Intersection.h>
 #include <osmscout/Route.h>
 #include <osmscout/RouteData.h>
 #include <osmscout/RoutingProfile.h>
 
 #include <osmscout/util/Cache.h>
+#include <osmscout/util/IndexedHeap.h>
 
 namespace osmscout {
 
@@ -70,6 +81,102 @@ namespace osmscout {
     bool IsDebugPerformance() const;
   };
 
+  /**
+   * \ingroup Routing
+   * Result of a many-to-many calculation (see RoutingService::CalculateMatrix()).
+   * Holds the costs and the distance (in km) for every combination of
+   * source and target. Combinations without a route are marked as not reachable.
+   */
+  class OSMSCOUT_API RoutingMatrix
+  {
+  private:
+    size_t              sourceCount;
+    size_t              targetCount;
+    std::vector<double> costs;
+    std::vector<double> distances;
+
+  public:
+    RoutingMatrix();
+
+    void Initialize(size_t sourceCount,
+                    size_t targetCount);
+
+    inline size_t GetSourceCount() const
+    {
+      return sourceCount;
+    }
+
+    inline size_t GetTargetCount() const
+    {
+      return targetCount;
+    }
+
+    inline bool IsReachable(size_t source,
+                            size_t target) const
+    {
+      return distances[source*targetCount+target]>=0.0;
+    }
+
+    inline double GetCosts(size_t source,
+                           size_t target) const
+    {
+      return costs[source*targetCount+target];
+    }
+
+    inline double GetDistance(size_t source,
+                              size_t target) const
+    {
+      return distances[source*targetCount+target];
+    }
+
+    inline void Set(size_t source,
+                    size_t target,
+                    double costs,
+                    double distance)
+    {
+      this->costs[source*targetCount+target]=costs;
+      this->distances[source*targetCount+target]=distance;
+    }
+  };
+
+  /**
+   * \ingroup Routing
+   * Result of a reachability calculation (see RoutingService::CalculateReachability()).
+   * Holds all route nodes reachable within the maximum costs (together with the costs
+   * to reach them) and for each cost band the outline of the area reachable with costs
+   * up to the limit of the band.
+   *
+   * The outline is grid based, it consists of the boundary of all grid cells touched
+   * by reachable parts of the routing graph. Outer rings are oriented counterclockwise,
+   * holes are oriented clockwise.
+   */
+  class OSMSCOUT_API RoutingReachability
+  {
+  public:
+    /**
+     * A route node reachable from the start
+     */
+    struct Node
+    {
+      FileOffset routeNodeOffset; //!< File offset of the route node
+      GeoCoord   coord;           //!< Coordinate of the route node
+      double     costs;           //!< Costs to reach the route node
+    };
+
+    /**
+     * The area reachable with costs up to maxCosts
+     */
+    struct Band
+    {
+      double                              maxCosts; //!< Cost limit of the band
+      std::vector<std::vector<GeoCoord> > rings;    //!< Outline of the reachable area
+    };
+
+  public:
+    std::vector<Node> nodes; //!< Reachable route nodes, ordered by costs
+    std::vector<Band> bands; //!< Cost bands, ordered by costs
+  };
+
   /**
    * \ingroup Service
    * \ingroup Routing
@@ -81,6 +188,8 @@ namespace osmscout {
    * - Transformation of the resulting route to a routing description with is the base
    * for further transformations to a textual or visual description of the route
    * - Returning the closest routeable node to  given geolocation
+   * - Calculation of costs for many sources and targets at once
+   * - Calculation of the area reachable within given costs
    */
   class OSMSCOUT_API RoutingService
   {
@@ -172,7 +281,230 @@ namespace osmscout {
     typedef std::unordered_map<FileOffset,OpenListRef>    OpenMap;
     typedef std::unordered_map<FileOffset,RNodeRef>       CloseMap;
 
+    /**
+     * Pool of RNodes as used by the heap based open list. RNodes are stored by value
+     * and are addressed by a dense slot number, that gets assigned to a route node
+     * the first time it is reached during a routing request.
+     */
+    struct RNodePool
+    {
+      std::vector<RNode>                    nodes;  //!< RNodes by slot
+      std::vector<bool>                     closed; //!< true, if the RNode in the given slot is already closed
+      std::unordered_map<FileOffset,size_t> slots;  //!< Slot by route node file offset
+
+      void Reserve(size_t size)
+      {
+        nodes.reserve(size);
+        closed.reserve(size);
+        slots.reserve(size);
+      }
+
+      inline size_t Add(const RNode& node)
+      {
+        size_t slot=nodes.size();
+
+        nodes.push_back(node);
+        closed.push_back(false);
+        slots[node.nodeOffset]=slot;
+
+        return slot;
+      }
+    };
+
+    struct RNodeSlotCostCompare
+    {
+      const std::vector<RNode>* nodes;
+
+      RNodeSlotCostCompare(const std::vector<RNode>& nodes)
+      : nodes(&nodes)
+      {
+        // no code
+      }
+
+      inline bool operator()(size_t a,
+                             size_t b) const
+      {
+        const RNode& nodeA=(*nodes)[a];
+        const RNode& nodeB=(*nodes)[b];
+
+        if (nodeA.overallCost==nodeB.overallCost) {
+          return nodeA.nodeOffset<nodeB.nodeOffset;
+        }
+        else {
+          return nodeA.overallCost<nodeB.overallCost;
+        }
+      }
+    };
+
+    /**
+     * The parts of the relaxation of paths (see RelaxRNode() and RelaxPaths()),
+     * that differ between the individual searches. The default implementation
+     * loads route nodes from the route node data file and does not use an
+     * estimate (Dijkstra).
+     */
+    class RelaxVisitor
+    {
+    private:
+      IndexedDataFile<Id,RouteNode>& routeNodeDataFile;
+
+    public:
+      RelaxVisitor(IndexedDataFile<Id,RouteNode>& routeNodeDataFile);
+      virtual ~RelaxVisitor();
+
+      virtual bool LoadRouteNode(FileOffset offset,
+                                 RouteNodeRef& node);
+      virtual double GetEstimateCost(const RouteNode& node) const;
+      virtual void VisitPath(const RNode& current,
+                             size_t pathIndex,
+                             double pathCosts,
+                             size_t slot,
+                             bool improved);
+    };
+
+    class AStarRelaxVisitor;
+    class BidirectionalRelaxVisitor;
+    class MatrixRelaxVisitor;
+    class ReachabilityRelaxVisitor;
+
+    /**
+     * A node reached during the search in the contraction hierarchy
+     */
+    struct CHLabel
+    {
+      uint32_t      node;    //!< Index of the node in the contraction hierarchy
+      double        cost;    //!< The cost up to this node
+      size_t        parent;  //!< Slot of the label we came from or npos for start labels
+      const CHEdge* edge;    //!< The edge used to get from the parent to this node
+      ObjectFileRef object;  //!< The object we came from, if this is a start label
+      bool          settled; //!< true, if the label was already taken from the open list
+
+      inline const ObjectFileRef& GetArrivalObject() const
+      {
+        return edge!=NULL ? edge->lastObject : object;
+      }
+    };
+
+    /**
+     * Labels of one search direction in the contraction hierarchy
+     */
+    struct CHLabelPool
+    {
+      std::vector<CHLabel>                labels; //!< Labels by slot
+      std::unordered_map<uint32_t,size_t> slots;  //!< Slot by contraction hierarchy node index
+
+      inline size_t Add(const CHLabel& label)
+      {
+        size_t slot=labels.size();
+
+        labels.push_back(label);
+        slots[label.node]=slot;
+
+        return slot;
+      }
+    };
+
+    struct CHLabelCostCompare
+    {
+      const std::vector<CHLabel>* labels;
+
+      CHLabelCostCompare(const std::vector<CHLabel>& labels)
+      : labels(&labels)
+      {
+        // no code
+      }
+
+      inline bool operator()(size_t a,
+                             size_t b) const
+      {
+        return (*labels)[a].cost<(*labels)[b].cost;
+      }
+    };
+
+    /**
+     * Start of a matrix calculation
+     */
+    struct MatrixSource
+    {
+      std::vector<RNode>  nodes;     //!< Start nodes, currentCost holds the costs from the start position
+      std::vector<double> distances; //!< Distance from the start position to the start node
+    };
+
+    /**
+     * Target of a matrix calculation
+     */
+    struct MatrixTarget
+    {
+      std::vector<FileOffset> routeNodeOffsets; //!< Route nodes the target position can be reached from
+      std::vector<double>     costs;            //!< Costs from the route node to the target position
+      std::vector<double>     distances;        //!< Distance from the route node to the target position
+    };
+
+    /**
+     * State of a matrix calculation, shared by all worker threads
+     */
+    struct MatrixJob
+    {
+      const RoutingProfile*                       profile;
+      const std::vector<MatrixSource>*            sources;
+      const std::vector<MatrixTarget>*            targets;
+      RoutingMatrix*                              matrix;
+
+      //! Target (index) and route node (index) by route node file offset
+      std::unordered_map<FileOffset,std::vector<std::pair<size_t,size_t> > > targetRouteNodes;
+
+      //! Route nodes shared between the individual searches
+      std::unordered_map<FileOffset,RouteNodeRef> routeNodes;
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+      std::mutex                                  routeNodesMutex;
+#endif
+
+#if defined(OSMSCOUT_HAVE_ATOMIC)
+      std::atomic<size_t>                         nextSource;
+      std::atomic<size_t>                         nodesLoadedCount;
+      std::atomic<bool>                           success;
+#else
+      size_t                                      nextSource;
+      size_t                                      nodesLoadedCount;
+      bool                                        success;
+#endif
+    };
+
+    /**
+     * A part of the routing graph reached during a reachability calculation
+     */
+    struct ReachabilitySegment
+    {
+      GeoCoord from;      //!< Coordinate the segment starts at
+      GeoCoord to;        //!< Coordinate the segment ends at
+      double   fromCosts; //!< Costs to reach the start of the segment
+      double   costs;     //!< Costs to traverse the segment
+    };
+
+    /**
+     * Statistics collected during route calculation
+     */
+    struct RoutingStatistics
+    {
+      size_t nodesLoadedCount;  //!< Number of route nodes taken from the open list
+      size_t nodesIgnoredCount; //!< Number of paths ignored because they could not be used
+      size_t maxOpenList;       //!< Maximum size of the open list
+      size_t maxCloseMap;       //!< Maximum number of closed route nodes
+
+      RoutingStatistics()
+      : nodesLoadedCount(0),
+        nodesIgnoredCount(0),
+        maxOpenList(0),
+        maxCloseMap(0)
+      {
+        // no code
+      }
+    };
+
   public:
+    //! The route graph also holds paths against the direction of oneways (needed for bidirectional search)
+    static const uint8_t graphHasReversePaths = 1 << 0;
+
     //! Relative filename of the intersection data file
     static const char* const FILENAME_INTERSECTIONS_DAT;
     //! Relative filename of the intersection index file
@@ -198,6 +530,8 @@ namespace osmscout {
     static const char* const FILENAME_CAR_VARIANT_DAT;
     //! Relative filename of the routing graph index file for car
     static const char* const FILENAME_CAR_IDX;
+    //! Relative filename of the contraction hierarchy file for car
+    static const char* const FILENAME_CAR_CH_DAT;
 
   private:
     DatabaseRef                          database;              //!< Database object, holding all index and data files
@@ -212,14 +546,19 @@ namespace osmscout {
     IndexedDataFile<Id,Intersection>     junctionDataFile;      //!< Cached access to the 'junctions.dat' file
 
     std::vector<ObjectVariantData>       objectVariantData;     //!< Cached data regarding object variants
+    uint8_t                              graphFlags;            //!< Flags describing the content of the route graph
+
+    ContractionHierarchy                 contractionHierarchy;  //!< The contraction hierarchy, if available for the vehicle
 
   private:
     std::string GetDataFilename(Vehicle vehicle) const;
     std::string GetData2Filename(Vehicle vehicle) const;
     std::string GetIndexFilename(Vehicle vehicle) const;
+    std::string GetContractionHierarchyFilename(Vehicle vehicle) const;
 
     bool LoadObjectVariantData(Vehicle vehicle,
-                               std::vector<ObjectVariantData>& objectVariantData) const;
+                               std::vector<ObjectVariantData>& objectVariantData,
+                               uint8_t& graphFlags) const;
 
     void GetStartForwardRouteNode(const RoutingProfile& profile,
                                   const WayRef& way,
@@ -258,6 +597,100 @@ namespace osmscout {
                         RouteNodeRef& forwardNode,
                         RouteNodeRef& backwardNode);
 
+    bool CanUsePath(const RoutingProfile& profile,
+                    const RNode& current,
+                    size_t pathIndex) const;
+
+    bool RelaxRNode(RelaxVisitor& visitor,
+                    RNodePool& pool,
+                    IndexedHeap<RNodeSlotCostCompare>& openList,
+                    const RNode& current,
+                    FileOffset offset,
+                    const RouteNodeRef& routeNode,
+                    const ObjectFileRef& object,
+                    double currentCost,
+                    bool access,
+                    size_t& slot,
+                    bool& improved);
+
+    bool RelaxPaths(const RoutingProfile& profile,
+                    RelaxVisitor& visitor,
+                    RNodePool& pool,
+                    IndexedHeap<RNodeSlotCostCompare>& openList,
+                    const RNode& current,
+                    RoutingStatistics& statistics);
+
+    bool SearchRouteUsingSet(const RoutingProfile& profile,
+                             const RNodeRef& startForwardNode,
+                             const RNodeRef& startBackwardNode,
+                             double targetLon,
+                             double targetLat,
+                             const RouteNodeRef& targetForwardRouteNode,
+                             const RouteNodeRef& targetBackwardRouteNode,
+                             std::list<RNodeRef>& nodes,
+                             RoutingStatistics& statistics);
+
+    bool SearchRouteUsingHeap(const RoutingProfile& profile,
+                              const RNodeRef& startForwardNode,
+                              const RNodeRef& startBackwardNode,
+                              double targetLon,
+                              double targetLat,
+                              const RouteNodeRef& targetForwardRouteNode,
+                              const RouteNodeRef& targetBackwardRouteNode,
+                              std::list<RNodeRef>& nodes,
+                              RoutingStatistics& statistics);
+
+    bool FindReversePath(const RouteNode& routeNode,
+                         const RouteNode& targetNode,
+                         const ObjectFileRef& object,
+                         size_t& pathIndex) const;
+
+    bool CanConnect(const RNode& forward,
+                    const RNode& backward,
+                    size_t backwardPathIndex) const;
+
+    bool SearchRouteBidirectional(const RoutingProfile& profile,
+                                  const RNodeRef& startForwardNode,
+                                  const RNodeRef& startBackwardNode,
+                                  double targetLon,
+                                  double targetLat,
+                                  const RouteNodeRef& targetForwardRouteNode,
+                                  const RouteNodeRef& targetBackwardRouteNode,
+                                  std::list<RNodeRef>& nodes,
+                                  RoutingStatistics& statistics);
+
+    bool SearchRouteContractionHierarchy(const RNodeRef& startForwardNode,
+                                         const RNodeRef& startBackwardNode,
+                                         const RouteNodeRef& targetForwardRouteNode,
+                                         const RouteNodeRef& targetBackwardRouteNode,
+                                         std::list<RNodeRef>& nodes,
+                                         RoutingStatistics& statistics);
+
+    bool GetMatrixSource(const RoutingProfile& profile,
+                         const ObjectFileRef& object,
+                         size_t nodeIndex,
+                         MatrixSource& source);
+
+    bool GetMatrixTarget(const RoutingProfile& profile,
+                         const ObjectFileRef& object,
+                         size_t nodeIndex,
+                         MatrixTarget& target);
+
+    bool GetMatrixRouteNode(MatrixJob& job,
+                            FileOffset offset,
+                            RouteNodeRef& node);
+
+    bool CalculateMatrixRow(MatrixJob& job,
+                            size_t sourceIndex);
+
+    void ProcessMatrixJob(MatrixJob& job);
+
+    void CalculateReachabilityBands(const std::vector<ReachabilitySegment>& segments,
+                                    double maxCost,
+                                    size_t bandCount,
+                                    double cellSize,
+                                    RoutingReachability& reachability) const;
+
     void ResolveRNodeChainToList(const RNodeRef& end,
                                  const CloseMap& closeMap,
                                  std::list<RNodeRef>& nodes);
@@ -295,6 +728,8 @@ namespace osmscout {
 
     TypeConfigRef GetTypeConfig() const;
 
+    bool CanUseContractionHierarchy(const RoutingProfile& profile) const;
+
     bool CalculateRoute(const RoutingProfile& profile,
                         const ObjectFileRef& startObject,
                         size_t startNodeIndex,
@@ -308,6 +743,29 @@ namespace osmscout {
                         std::vector<osmscout::GeoCoord> via,
                         RouteData& route);
 
+    bool CalculateMatrix(const RoutingProfile& profile,
+                         double radius,
+                         const std::vector<GeoCoord>& sources,
+                         const std::vector<GeoCoord>& targets,
+                         RoutingMatrix& matrix,
+                         size_t threadCount=1);
+
+    bool CalculateReachability(const RoutingProfile& profile,
+                               const ObjectFileRef& startObject,
+                               size_t startNodeIndex,
+                               double maxCost,
+                               size_t bandCount,
+                               double cellSize,
+                               RoutingReachability& reachability);
+
+    bool CalculateReachability(const RoutingProfile& profile,
+                               double radius,
+                               const GeoCoord& start,
+                               double maxCost,
+                               size_t bandCount,
+                               double cellSize,
+                               RoutingReachability& reachability);
+
     bool TransformRouteDataToWay(const RouteData& data,
                                  Way& way);
 
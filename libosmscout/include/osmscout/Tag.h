@@ -45,6 +45,26 @@ namespace osmscout {
    */
   static const TagId tagIgnore        = 0;
 
+  /**
+   * \ingroup type
+   *
+   * A set of tags (with any value) and tag values. A TagMap contains one of the
+   * keys, if it contains one of the tags or one of the tags with the given value.
+   */
+  struct OSMSCOUT_API TagConditionKeys
+  {
+    std::set<TagId>                        tags;      //!< Tags with any value
+    std::set<std::pair<TagId,std::string>> tagValues; //!< Tags with the given value
+
+    inline size_t Size() const
+    {
+      return tags.size()+tagValues.size();
+    }
+
+    void Clear();
+    void Insert(const TagConditionKeys& other);
+  };
+
   /**
    * \ingroup type
    *
@@ -56,6 +76,16 @@ namespace osmscout {
     virtual ~TagCondition();
 
     virtual bool Evaluate(const TagMap& tagMap) const = 0;
+
+    /**
+     * Return a set of keys of which the TagMap must contain at least one for
+     * the condition to evaluate to true. Returns false, if there is no such set
+     * (for example because the condition also evaluates to true for an
+     * empty TagMap).
+     *
+     * The default implementation returns false.
+     */
+    virtual bool GetRequiredKeys(TagConditionKeys& keys) const;
   };
 
   /**
@@ -79,6 +109,7 @@ namespace osmscout {
     TagNotCondition(const TagConditionRef& condition);
 
     bool Evaluate(const TagMap& tagMap) const;
+    bool GetRequiredKeys(TagConditionKeys& keys) const;
   };
 
   /**
@@ -105,6 +136,7 @@ namespace osmscout {
     void AddCondition(const TagConditionRef& condition);
 
     bool Evaluate(const TagMap& tagMap) const;
+    bool GetRequiredKeys(TagConditionKeys& keys) const;
   };
 
   /**
@@ -128,6 +160,7 @@ namespace osmscout {
     TagExistsCondition(TagId tag);
 
     bool Evaluate(const TagMap& tagMap) const;
+    bool GetRequiredKeys(TagConditionKeys& keys) const;
   };
 
   /**
@@ -160,6 +193,7 @@ namespace osmscout {
                        const size_t& tagValue);
 
     bool Evaluate(const TagMap& tagMap) const;
+    bool GetRequiredKeys(TagConditionKeys& keys) const;
   };
 
   /**
@@ -180,6 +214,7 @@ namespace osmscout {
     void AddTagValue(const std::string& tagValue);
 
     bool Evaluate(const TagMap& tagMap) const;
+    bool GetRequiredKeys(TagConditionKeys& keys) const;
   };
 
   /**
@@ -20,7 +20,9 @@
  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
  */
 
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <osmscout/TypeSet.h>
 #include <osmscout/ObjectRef.h>
@@ -35,6 +37,14 @@ namespace osmscout
    \ingroup Database
    A class that allows prefix-based searching
    of text data indexed during import
+
+   Besides the plain prefix search (Search()) there is a ranked
+   search (SearchRanked()), that also finds texts with a prefix within
+   a given edit distance of the query and returns the best results only.
+   The rank of a result is given by the edit distance, a complete match,
+   the group of the text (regions before locations before POIs before
+   other objects) and the length of the text. Object importance is thus
+   only expressed by the group, there is no weight per object.
    */
   class OSMSCOUT_API TextSearchIndex
   {
@@ -43,6 +53,7 @@ namespace osmscout
     {
       marisa::Trie *trie;
       std::string  file;
+      std::string  alphabet; //! all bytes used in the texts of the trie
       bool         isAvail;
 
       TrieInfo() :
@@ -53,9 +64,44 @@ namespace osmscout
       }
     };
 
+    /**
+     A prefix of texts in a trie, that is within the
+     allowed edit distance of the query
+     */
+    struct FuzzyPrefix
+    {
+      std::string prefix;
+      size_t      distance;
+    };
+
   public:
     typedef std::unordered_map<std::string,std::vector<ObjectFileRef> > ResultsMap;
 
+    /**
+     The kind of objects a text belongs to, the
+     values are the indices of the tries
+     */
+    enum ResultGroup
+    {
+      groupPOI      = 0,
+      groupLocation = 1,
+      groupRegion   = 2,
+      groupOther    = 3
+    };
+
+    /**
+     A text found by SearchRanked() together with all
+     objects in the group carrying this text
+     */
+    struct OSMSCOUT_API RankedResult
+    {
+      std::string                text;       //! the text
+      ResultGroup                group;      //! the kind of objects
+      size_t                     distance;   //! edit distance between the query and a prefix of the text
+      bool                       isComplete; //! the query matches the complete text and not only a prefix
+      std::vector<ObjectFileRef> objects;    //! the objects carrying the text
+    };
+
     TextSearchIndex();
 
     ~TextSearchIndex();
@@ -69,7 +115,47 @@ namespace osmscout
                 bool searchOther,
                 ResultsMap& results) const;
 
+    bool SearchRanked(const std::string& query,
+                      bool searchPOIs,
+                      bool searchLocations,
+                      bool searchRegions,
+                      bool searchOther,
+                      size_t maxDistance,
+                      size_t limit,
+                      std::vector<RankedResult>& results) const;
+
   private:
+    bool HasPrefix(const marisa::Trie& trie,
+                   const std::string& prefix) const;
+
+    bool GetFirstText(const TrieInfo& trie,
+                      const std::string& prefix,
+                      std::string& text) const;
+
+    bool CollectLongerTexts(const TrieInfo& trie,
+                            const std::string& prefix,
+                            size_t maxKeys,
+                            std::vector<std::string>& texts) const;
+
+    void CollectFuzzyPrefixes(const TrieInfo& trie,
+                              const std::string& query,
+                              size_t maxDistance,
+                              const std::vector<size_t>& distances,
+                              std::string& prefix,
+                              std::vector<FuzzyPrefix>& prefixes) const;
+
+    void CollectRankedResults(const TrieInfo& trie,
+                              ResultGroup group,
+                              const FuzzyPrefix& prefix,
+                              bool completeOnly,
+                              size_t limit,
+                              std::unordered_map<std::string,size_t>& textIndex,
+                              std::vector<RankedResult>& results) const;
+
+    void CollectObjects(const TrieInfo& trie,
+                        const std::string& text,
+                        std::vector<ObjectFileRef>& objects) const;
+
     void splitSearchResult(const std::string& result,
                            std::string& text,
                            ObjectFileRef& ref) const;
@@ -929,6 +929,49 @@ namespace osmscout {
     bool operator!=(const FeatureValueBuffer& other) const;
   };
 
+  /**
+   * \ingroup type
+   *
+   * Index over a ordered list of type conditions, that allows to quickly find
+   * the first condition in the list that matches a given TagMap.
+   *
+   * For each condition the keys (tags or tag values) required by the condition
+   * are calculated (see TagCondition::GetRequiredKeys()). For a given TagMap only
+   * the conditions of which at least one required key is part of the TagMap
+   * (and the conditions without required keys) get evaluated, in the order
+   * they were added. The result is thus the same as evaluating all conditions
+   * in order.
+   */
+  class OSMSCOUT_API TypeConditionIndex
+  {
+  public:
+    struct Entry
+    {
+      TypeInfoRef     type;      //!< The type the condition belongs to
+      unsigned char   types;     //!< Bitset of types the condition can be applied to
+      TagConditionRef condition; //!< The condition
+    };
+
+  private:
+    std::vector<Entry>                                                 entries;              //!< All conditions in order
+    std::vector<size_t>                                                unconditionalEntries; //!< Conditions without required keys
+    std::vector<std::vector<size_t> >                                  tagEntries;           //!< Conditions requiring a tag, by TagId
+    std::vector<std::unordered_map<std::string,std::vector<size_t> > > tagValueEntries;      //!< Conditions requiring a tag value, by TagId
+
+  public:
+    void Clear();
+
+    void AddCondition(const TypeInfoRef& type,
+                      const TypeInfo::TypeCondition& condition);
+
+    const Entry* GetFirstMatch(const TagMap& tagMap) const;
+
+    inline size_t GetConditionCount() const
+    {
+      return entries.size();
+    }
+  };
+
   /**
    * \ingroup type
    *
@@ -937,7 +980,14 @@ namespace osmscout {
    */
   class OSMSCOUT_API TypeConfig
   {
+  public:
+    //! Version of the data file format written by this library
+    static const uint32_t fileFormatVersion=1;
+    //! First version of the data file format storing coordinate arrays delta encoded
+    static const uint32_t deltaEncodedCoordsFileFormatVersion=1;
+
   private:
+    uint32_t                                    formatVersion;
 
     // Tags
 
@@ -965,6 +1015,11 @@ namespace osmscout {
 
     std::unordered_map<std::string,TypeInfoRef> nameToTypeMap;
 
+    TypeConditionIndex                          nodeTypeConditions;     //!< Conditions for nodes
+    TypeConditionIndex                          wayAreaTypeConditions;  //!< Conditions for ways and areas
+    TypeConditionIndex                          areaTypeConditions;     //!< Conditions for areas (multipolygon relations)
+    TypeConditionIndex                          relationTypeConditions; //!< Conditions for relations
+
     // Features
 
     std::vector<FeatureRef>                     features;
@@ -1003,6 +1058,26 @@ namespace osmscout {
     TypeConfig();
     virtual ~TypeConfig();
 
+    /**
+     * Return the version of the data file format. This is fileFormatVersion
+     * for a type configuration loaded from an OST file and the version of the
+     * database for a configuration loaded from a data file. Version 0 is the
+     * (unversioned) format before fileFormatVersion was introduced.
+     */
+    inline uint32_t GetFileFormatVersion() const
+    {
+      return formatVersion;
+    }
+
+    /**
+     * Return true, if coordinate arrays of ways and areas are stored using
+     * FileWriter::WriteDeltaEncoded().
+     */
+    inline bool HasDeltaEncodedCoords() const
+    {
+      return formatVersion>=deltaEncodedCoordsFileFormatVersion;
+    }
+
     /**
      * Methods for dealing with tags
      */
@@ -1153,17 +1228,19 @@ namespace osmscout {
 
     /**
      * Return a node type (or an invalid reference if no type got detected)
-     * based on the given map of tag and tag values. The method iterates over all
-     * node type definitions, evaluates their conditions and returns the first matching
-     * type.
+     * based on the given map of tag and tag values. The method evaluates the
+     * conditions of the node type definitions in the order of the types and returns
+     * the first matching type. Conditions, that cannot match because of missing tags
+     * are skipped using an index built during RegisterType(), so conditions must
+     * be added to a type before it gets registered.
      */
     TypeInfoRef GetNodeType(const TagMap& tagMap) const;
 
     /**
      * Return a way/area type (or an invalid reference if no type got detected)
-     * based on the given map of tag and tag values. The method iterates over all
-     * way/area type definitions, evaluates their conditions and returns the first matching
-     * type.
+     * based on the given map of tag and tag values. The method evaluates the
+     * conditions of the way/area type definitions in the order of the types and returns
+     * the first matching type (see GetNodeType()).
      */
     bool GetWayAreaType(const TagMap& tagMap,
                         TypeInfoRef& wayType,
@@ -1171,9 +1248,9 @@ namespace osmscout {
 
     /**
      * Return a relation type (or an invalid reference if no type got detected)
-     * based on the given map of tag and tag values. The method iterates over all
-     * relation type definitions, evaluates their conditions and returns the first matching
-     * type.
+     * based on the given map of tag and tag values. The method evaluates the
+     * conditions of the relation type definitions in the order of the types and returns
+     * the first matching type (see GetNodeType()).
      */
     TypeInfoRef GetRelationType(const TagMap& tagMap) const;
     //@}
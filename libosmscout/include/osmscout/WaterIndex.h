@@ -29,6 +29,7 @@
 #include <osmscout/Types.h>
 
 #include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileScannerPool.h>
 #include <osmscout/util/Magnification.h>
 
 namespace osmscout {
@@ -57,7 +58,7 @@ namespace osmscout {
   private:
     std::string                filepart;       //!< name of the data file
     std::string                datafilename;   //!< Full path and name of the data file
-    mutable FileScanner        scanner;        //!< Scanner instance for reading this file
+    mutable FileScannerPool    scanners;       //!< Scanner instances for reading this file
 
     uint32_t                   waterIndexMinMag;
     uint32_t                   waterIndexMaxMag;
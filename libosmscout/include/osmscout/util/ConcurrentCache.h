@@ -0,0 +1,628 @@
+#ifndef OSMSCOUT_CONCURRENTCACHE_H
+#define OSMSCOUT_CONCURRENTCACHE_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/CoreFeatures.h>
+
+#include <algorithm>
+#include <iostream>
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+#include <mutex>
+#endif
+
+#include <osmscout/system/Assert.h>
+#include <osmscout/system/Types.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Util
+   * Generic LRU cache implementation, that can be used by multiple threads
+   * at the same time.
+   *
+   * Template parameter class K holds the key value (must be a numerical value),
+   * parameter class V holds the data class that is to be cached. V must be
+   * default constructible and should be cheap to copy (usually V is a
+   * std::shared_ptr), since values are returned as copies.
+   *
+   * * The cache is split into a number of shards, each protected by its own
+   *   mutex. The shard of an entry is derived from the hash of its key, so
+   *   threads accessing different entries rarely block each other.
+   * * Each shard stores its entries in a vector. The entries are linked by
+   *   index into a doubly linked LRU list (no allocation per entry) and are
+   *   found using an open addressing hash table with linear probing.
+   * * The cache is limited by the number of entries and by the amount of memory
+   *   used. The memory of an entry is the size given on insertion plus the
+   *   internal overhead per entry. Limits are evenly distributed over the shards.
+   * * The cache counts hits, misses and evictions.
+   */
+  template <class K, class V>
+  class ConcurrentCache
+  {
+  public:
+    /**
+     * Current state and usage counters of the cache
+     */
+    struct Statistics
+    {
+      size_t entries;   //!< Number of entries in the cache
+      size_t memory;    //!< Memory used by the entries in the cache
+      size_t hits;      //!< Number of successful lookups
+      size_t misses;    //!< Number of failed lookups
+      size_t evictions; //!< Number of entries removed because of the cache limits
+    };
+
+  private:
+    static const uint32_t noEntry=std::numeric_limits<uint32_t>::max();
+    static const size_t   maxShardCount=16;
+    static const size_t   minShardSize=64;
+
+    /**
+     * An individual entry in the cache, also used as node of the LRU list
+     * and of the list of free entries.
+     */
+    struct Entry
+    {
+      K        key;
+      V        value;
+      uint64_t hash;
+      size_t   memory;
+      uint32_t prev;   //!< Previous (more recently used) entry
+      uint32_t next;   //!< Next (less recently used) entry or next free entry
+    };
+
+    struct Shard
+    {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+      std::mutex            mutex;
+#endif
+      std::vector<Entry>    entries;   //!< All entries, either part of the LRU or of the free list
+      std::vector<uint32_t> buckets;   //!< Hash table, index of the entry or noEntry
+      uint32_t              head;      //!< Most recently used entry
+      uint32_t              tail;      //!< Least recently used entry
+      uint32_t              firstFree; //!< First unused entry
+      size_t                size;
+      size_t                memory;
+      size_t                maxSize;
+      size_t                maxMemory;
+      size_t                hits;
+      size_t                misses;
+      size_t                evictions;
+
+      Shard()
+      : head(noEntry),
+        tail(noEntry),
+        firstFree(noEntry),
+        size(0),
+        memory(0),
+        maxSize(0),
+        maxMemory(0),
+        hits(0),
+        misses(0),
+        evictions(0)
+      {
+        // no code
+      }
+
+      inline size_t GetBucketMask() const
+      {
+        return buckets.size()-1;
+      }
+
+      size_t FindBucket(uint64_t hash,
+                        const K& key) const
+      {
+        if (buckets.empty()) {
+          return noEntry;
+        }
+
+        size_t mask=GetBucketMask();
+        size_t bucket=(size_t)hash & mask;
+
+        while (buckets[bucket]!=noEntry) {
+          const Entry& entry=entries[buckets[bucket]];
+
+          if (entry.hash==hash &&
+              entry.key==key) {
+            return bucket;
+          }
+
+          bucket=(bucket+1) & mask;
+        }
+
+        return noEntry;
+      }
+
+      size_t FindBucketOfEntry(uint32_t index) const
+      {
+        size_t mask=GetBucketMask();
+        size_t bucket=(size_t)entries[index].hash & mask;
+
+        while (buckets[bucket]!=index) {
+          bucket=(bucket+1) & mask;
+        }
+
+        return bucket;
+      }
+
+      void InsertIntoBuckets(uint32_t index)
+      {
+        size_t mask=GetBucketMask();
+        size_t bucket=(size_t)entries[index].hash & mask;
+
+        while (buckets[bucket]!=noEntry) {
+          bucket=(bucket+1) & mask;
+        }
+
+        buckets[bucket]=index;
+      }
+
+      /**
+       * Remove the given bucket from the hash table, moving following
+       * entries back, so that lookups never stop at a hole.
+       */
+      void RemoveFromBuckets(size_t bucket)
+      {
+        size_t mask=GetBucketMask();
+        size_t hole=bucket;
+        size_t current=bucket;
+
+        while (true) {
+          current=(current+1) & mask;
+
+          if (buckets[current]==noEntry) {
+            break;
+          }
+
+          size_t home=(size_t)entries[buckets[current]].hash & mask;
+
+          // Entry stays if its home bucket is (cyclically) in (hole,current]
+          if (hole<=current ? (hole<home && home<=current) : (hole<home || home<=current)) {
+            continue;
+          }
+
+          buckets[hole]=buckets[current];
+          hole=current;
+        }
+
+        buckets[hole]=noEntry;
+      }
+
+      void Rehash(size_t bucketCount)
+      {
+        buckets.assign(bucketCount,(uint32_t)noEntry);
+
+        for (uint32_t index=head; index!=noEntry; index=entries[index].next) {
+          InsertIntoBuckets(index);
+        }
+      }
+
+      void Unlink(uint32_t index)
+      {
+        Entry& entry=entries[index];
+
+        if (entry.prev!=noEntry) {
+          entries[entry.prev].next=entry.next;
+        }
+        else {
+          head=entry.next;
+        }
+
+        if (entry.next!=noEntry) {
+          entries[entry.next].prev=entry.prev;
+        }
+        else {
+          tail=entry.prev;
+        }
+      }
+
+      void LinkFront(uint32_t index)
+      {
+        Entry& entry=entries[index];
+
+        entry.prev=noEntry;
+        entry.next=head;
+
+        if (head!=noEntry) {
+          entries[head].prev=index;
+        }
+        else {
+          tail=index;
+        }
+
+        head=index;
+      }
+
+      void MoveToFront(uint32_t index)
+      {
+        if (index!=head) {
+          Unlink(index);
+          LinkFront(index);
+        }
+      }
+
+      void Insert(const K& key,
+                  const V& value,
+                  uint64_t hash,
+                  size_t entryMemory)
+      {
+        uint32_t index;
+
+        if ((size+1)*2>buckets.size()) {
+          Rehash(std::max((size_t)16,buckets.size()*2));
+        }
+
+        if (firstFree!=noEntry) {
+          index=firstFree;
+          firstFree=entries[index].next;
+        }
+        else {
+          index=(uint32_t)entries.size();
+          entries.push_back(Entry());
+        }
+
+        Entry& entry=entries[index];
+
+        entry.key=key;
+        entry.value=value;
+        entry.hash=hash;
+        entry.memory=entryMemory;
+
+        InsertIntoBuckets(index);
+        LinkFront(index);
+
+        size++;
+        memory+=entryMemory;
+      }
+
+      void Remove(uint32_t index,
+                  size_t bucket)
+      {
+        Entry& entry=entries[index];
+
+        RemoveFromBuckets(bucket);
+        Unlink(index);
+
+        size--;
+        memory-=entry.memory;
+
+        entry.value=V();
+        entry.next=firstFree;
+        firstFree=index;
+      }
+
+      void Strip()
+      {
+        while (tail!=noEntry &&
+               (size>maxSize || memory>maxMemory)) {
+          uint32_t index=tail;
+
+          Remove(index,
+                 FindBucketOfEntry(index));
+          evictions++;
+        }
+      }
+
+      void Flush()
+      {
+        std::vector<Entry>().swap(entries);
+        std::vector<uint32_t>().swap(buckets);
+
+        head=noEntry;
+        tail=noEntry;
+        firstFree=noEntry;
+        size=0;
+        memory=0;
+      }
+    };
+
+  private:
+    size_t                   shardCount;
+    size_t                   maxSize;
+    size_t                   maxMemory;
+    std::unique_ptr<Shard[]> shards;
+
+  private:
+    static inline uint64_t Hash(const K& key)
+    {
+      uint64_t hash=(uint64_t)key*0x9e3779b97f4a7c15ULL;
+
+      return hash ^ (hash >> 29);
+    }
+
+    inline Shard& GetShard(uint64_t hash) const
+    {
+      return shards[(size_t)(hash >> 48) & (shardCount-1)];
+    }
+
+    static inline size_t GetShardLimit(size_t limit,
+                                       size_t shardCount)
+    {
+      if (limit==std::numeric_limits<size_t>::max()) {
+        return limit;
+      }
+
+      return limit/shardCount+(limit%shardCount!=0 ? 1 : 0);
+    }
+
+    /**
+     * Return the memory accounted for an entry with the given value size
+     */
+    static inline size_t GetEntryMemory(size_t valueMemory)
+    {
+      // Entry itself plus two buckets (the hash table is at most half full)
+      return valueMemory+sizeof(Entry)+2*sizeof(uint32_t);
+    }
+
+  public:
+    /**
+     * Create a new cache object with the given maximum number of entries
+     * and the given maximum amount of memory (in bytes). The number of shards
+     * is derived from the maximum number of entries.
+     */
+    ConcurrentCache(size_t maxSize,
+                    size_t maxMemory=std::numeric_limits<size_t>::max())
+    : shardCount(1),
+      maxSize(maxSize),
+      maxMemory(maxMemory)
+    {
+      while (shardCount<maxShardCount &&
+             maxSize/(shardCount*2)>=minShardSize) {
+        shardCount*=2;
+      }
+
+      shards.reset(new Shard[shardCount]);
+
+      SetMaxSize(maxSize);
+      SetMaxMemory(maxMemory);
+    }
+
+    /**
+     * Returns if the cache is active (maxSize > 0 and maxMemory > 0)
+     */
+    bool IsActive() const
+    {
+      return maxSize>0 && maxMemory>0;
+    }
+
+    /**
+     * Returns the number of shards of the cache
+     */
+    size_t GetShardCount() const
+    {
+      return shardCount;
+    }
+
+    /**
+     * Getting the value with the given key from cache.
+     *
+     * If there is no value stored with the given key, false will be
+     * returned and value will be untouched.
+     *
+     * If there is a value with the given key, a copy of the value will be
+     * returned and the entry will be moved to the front of the cache to
+     * assure LRU behaviour.
+     */
+    bool GetEntry(const K& key,
+                  V& value)
+    {
+      if (!IsActive()) {
+        return false;
+      }
+
+      uint64_t hash=Hash(key);
+      Shard&   shard=GetShard(hash);
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+      std::lock_guard<std::mutex> guard(shard.mutex);
+#endif
+
+      size_t bucket=shard.FindBucket(hash,key);
+
+      if (bucket==noEntry) {
+        shard.misses++;
+
+        return false;
+      }
+
+      uint32_t index=shard.buckets[bucket];
+
+      shard.MoveToFront(index);
+      shard.hits++;
+
+      value=shard.entries[index].value;
+
+      return true;
+    }
+
+    /**
+     * Insert the given value for the given key into the cache.
+     *
+     * valueMemory is the amount of memory (in bytes) hold by the value.
+     *
+     * If there is already a value stored with the given key (because another
+     * thread loaded the same value in the meantime) the existing entry wins,
+     * is moved to the front of the cache and is returned in value.
+     *
+     * Values that alone exceed the memory limit of a shard are not cached.
+     */
+    void InsertEntry(const K& key,
+                     V& value,
+                     size_t valueMemory)
+    {
+      if (!IsActive()) {
+        return;
+      }
+
+      uint64_t hash=Hash(key);
+      Shard&   shard=GetShard(hash);
+      size_t   entryMemory=GetEntryMemory(valueMemory);
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+      std::lock_guard<std::mutex> guard(shard.mutex);
+#endif
+
+      size_t bucket=shard.FindBucket(hash,key);
+
+      if (bucket!=noEntry) {
+        uint32_t index=shard.buckets[bucket];
+
+        shard.MoveToFront(index);
+
+        value=shard.entries[index].value;
+
+        return;
+      }
+
+      if (entryMemory>shard.maxMemory) {
+        return;
+      }
+
+      shard.Insert(key,
+                   value,
+                   hash,
+                   entryMemory);
+
+      shard.Strip();
+    }
+
+    /**
+     * Set a new maximum number of entries, possibly stripping the oldest
+     * entries from cache if the new size is smaller than the old one.
+     */
+    void SetMaxSize(size_t maxSize)
+    {
+      this->maxSize=maxSize;
+
+      for (size_t s=0; s<shardCount; s++) {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+        std::lock_guard<std::mutex> guard(shards[s].mutex);
+#endif
+
+        shards[s].maxSize=GetShardLimit(maxSize,shardCount);
+        shards[s].Strip();
+      }
+    }
+
+    /**
+     * Set a new maximum amount of memory, possibly stripping the oldest
+     * entries from cache if the new limit is smaller than the old one.
+     */
+    void SetMaxMemory(size_t maxMemory)
+    {
+      this->maxMemory=maxMemory;
+
+      for (size_t s=0; s<shardCount; s++) {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+        std::lock_guard<std::mutex> guard(shards[s].mutex);
+#endif
+
+        shards[s].maxMemory=GetShardLimit(maxMemory,shardCount);
+        shards[s].Strip();
+      }
+    }
+
+    /**
+     * Completely flush the cache removing all entries from it. The
+     * counters are not reset.
+     */
+    void Flush()
+    {
+      for (size_t s=0; s<shardCount; s++) {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+        std::lock_guard<std::mutex> guard(shards[s].mutex);
+#endif
+
+        shards[s].Flush();
+      }
+    }
+
+    /**
+     * Return the current number of entries, memory usage and counters,
+     * summed over all shards.
+     */
+    void GetStatistics(Statistics& statistics) const
+    {
+      statistics.entries=0;
+      statistics.memory=0;
+      statistics.hits=0;
+      statistics.misses=0;
+      statistics.evictions=0;
+
+      for (size_t s=0; s<shardCount; s++) {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+        std::lock_guard<std::mutex> guard(shards[s].mutex);
+#endif
+
+        statistics.entries+=shards[s].size;
+        statistics.memory+=shards[s].memory;
+        statistics.hits+=shards[s].hits;
+        statistics.misses+=shards[s].misses;
+        statistics.evictions+=shards[s].evictions;
+      }
+    }
+
+    /**
+     * Returns the current number of entries in the cache.
+     */
+    size_t GetSize() const
+    {
+      Statistics statistics;
+
+      GetStatistics(statistics);
+
+      return statistics.entries;
+    }
+
+    /**
+     * Returns the current amount of memory used by the cache.
+     */
+    size_t GetMemory() const
+    {
+      Statistics statistics;
+
+      GetStatistics(statistics);
+
+      return statistics.memory;
+    }
+
+    /**
+     * Dump some cache statistics to std::cout.
+     */
+    void DumpStatistics(const char* cacheName) const
+    {
+      Statistics statistics;
+
+      GetStatistics(statistics);
+
+      std::cout << cacheName << " entries: " << statistics.entries << ", memory " << statistics.memory;
+      std::cout << ", hits " << statistics.hits << ", misses " << statistics.misses;
+      std::cout << ", evictions " << statistics.evictions << std::endl;
+    }
+  };
+}
+
+#endif
@@ -74,6 +74,9 @@ namespace osmscout {
     FileOffset   size;
     FileOffset   offset;
 
+    // Temporary buffer for reading delta encoded coordinates without mmap
+    std::vector<unsigned char> deltaBuffer;
+
     // For Windows mmap usage
 #if defined(__WIN32__) || defined(WIN32)
     HANDLE       mmfHandle;
@@ -161,6 +164,10 @@ namespace osmscout {
     bool Read(std::vector<GeoCoord>& nodes,
               size_t count);
 
+    bool ReadDeltaEncoded(std::vector<GeoCoord>& nodes);
+    bool ReadDeltaEncoded(std::vector<GeoCoord>& nodes,
+                          size_t count);
+
     bool ReadBox(GeoBox& box);
 
     bool ReadTypeId(TypeId& id,
@@ -0,0 +1,133 @@
+#ifndef OSMSCOUT_UTIL_FILESCANNERPOOL_H
+#define OSMSCOUT_UTIL_FILESCANNERPOOL_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+#include <mutex>
+#endif
+
+#include <string>
+#include <vector>
+
+#include <osmscout/private/CoreImportExport.h>
+
+#include <osmscout/util/FileScanner.h>
+
+namespace osmscout {
+
+  /**
+    \ingroup File
+
+    Pool of FileScanner instances for the same file, allowing read access
+    to the file from multiple threads at the same time.
+
+    A thread acquires a scanner for the duration of a lookup and hands it back
+    afterwards. Additional scanners are opened on demand, so the number of open
+    scanners equals the maximum number of concurrent lookups. If memory mapping is
+    used, all scanners map the same file read only and thus share the same
+    physical pages.
+
+    Close() must not be called while scanners are in use. If the platform
+    does not support std::mutex the pool is not threadsafe.
+    */
+  class OSMSCOUT_API FileScannerPool
+  {
+  private:
+    std::string               filename;
+    FileScanner::Mode         mode;
+    bool                      useMmap;
+    bool                      isOpen;
+    std::vector<FileScanner*> scanners; //!< Open scanners currently not in use
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::mutex                mutex;    //!< Mutex guarding the list of scanners
+#endif
+
+  private:
+    FileScannerPool(const FileScannerPool& other);
+    FileScannerPool& operator=(const FileScannerPool& other);
+
+  public:
+    FileScannerPool();
+    virtual ~FileScannerPool();
+
+    bool Open(const std::string& filename,
+              FileScanner::Mode mode,
+              bool useMmap);
+    bool Close();
+
+    inline bool IsOpen() const
+    {
+      return isOpen;
+    }
+
+    inline std::string GetFilename() const
+    {
+      return filename;
+    }
+
+    FileScanner* Acquire();
+    void Release(FileScanner* scanner);
+  };
+
+  /**
+    \ingroup File
+
+    Acquires a scanner from the given FileScannerPool on construction and
+    hands it back to the pool on destruction.
+    */
+  class OSMSCOUT_API PooledFileScanner
+  {
+  private:
+    FileScannerPool& pool;
+    FileScanner*     scanner;
+
+  private:
+    PooledFileScanner(const PooledFileScanner& other);
+    PooledFileScanner& operator=(const PooledFileScanner& other);
+
+  public:
+    PooledFileScanner(FileScannerPool& pool);
+    ~PooledFileScanner();
+
+    /**
+     * Return true, if a scanner could be acquired
+     */
+    inline bool IsValid() const
+    {
+      return scanner!=NULL;
+    }
+
+    inline FileScanner& operator*() const
+    {
+      return *scanner;
+    }
+
+    inline FileScanner* operator->() const
+    {
+      return scanner;
+    }
+  };
+}
+
+#endif
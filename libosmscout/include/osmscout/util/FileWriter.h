@@ -44,9 +44,10 @@ namespace osmscout {
   class OSMSCOUT_API FileWriter
   {
   private:
-    std::string filename;
-    std::FILE   *file;
-    bool        hasError;
+    std::string       filename;
+    std::FILE         *file;
+    bool              hasError;
+    std::vector<char> deltaBuffer; //!< Temporary buffer for delta encoded coordinates
 
   public:
     FileWriter();
@@ -121,6 +122,10 @@ namespace osmscout {
     bool Write(const std::vector<GeoCoord>& nodes,
                size_t count);
 
+    bool WriteDeltaEncoded(const std::vector<GeoCoord>& nodes);
+    bool WriteDeltaEncoded(const std::vector<GeoCoord>& nodes,
+                           size_t count);
+
     bool WriteTypeId(TypeId id, uint8_t maxBytes);
 
     bool Flush();
@@ -422,48 +422,106 @@ namespace osmscout {
     return false;
   }
 
+  namespace detail {
+    /**
+     * Bounding box of an edge, used by AreaIsSimple() to sweep over the edges
+     * in the order of their minimum latitude.
+     */
+    struct SweepEdge
+    {
+      size_t index;
+      double minLat;
+      double maxLat;
+      double minLon;
+      double maxLon;
+
+      inline bool operator<(const SweepEdge& other) const
+      {
+        return minLat<other.minLat;
+      }
+    };
+  }
+
   /**
    * \ingroup Geometry
-   * Returns true, if the handed polygon is simple (aka not complex).
+   * Returns true, if the handed polygons are simple (aka not complex).
+   * This method supports passing multiple closed polygons and checks
+   * all of them.
    *
-   * Currently the following checks are done:
-   * + Polygon has at least 3 points
-   * + Assure that the line segments that make up the polygon
-   *   only meet at their end points.
+   * Currently it is checked, that the line segments that make up the
+   * polygon, only meet at their end points.
+   *
+   * Instead of testing every pair of edges, a sweep line moves over the edges
+   * ordered by their minimum latitude. An edge is only tested against the edges
+   * whose latitude range is still crossed by the sweep line and whose
+   * longitude range overlaps.
    */
   template<typename N>
-  bool AreaIsSimple(std::vector<N> points)
+  bool AreaIsSimple(const std::vector<std::pair<N,N> >& edges,
+                    const std::vector<bool>& edgeStartsNewPoly)
   {
-    if (points.size()<3) {
-      return false;
+    std::vector<detail::SweepEdge> sweepEdges(edges.size());
+    std::vector<detail::SweepEdge> activeEdges;
+    std::vector<size_t>            edgesIntersect(edges.size(),0);
+
+    for (size_t i=0; i<edges.size(); i++) {
+      sweepEdges[i].index=i;
+      sweepEdges[i].minLat=std::min(edges[i].first.GetLat(),edges[i].second.GetLat());
+      sweepEdges[i].maxLat=std::max(edges[i].first.GetLat(),edges[i].second.GetLat());
+      sweepEdges[i].minLon=std::min(edges[i].first.GetLon(),edges[i].second.GetLon());
+      sweepEdges[i].maxLon=std::max(edges[i].first.GetLon(),edges[i].second.GetLon());
     }
 
-    points.push_back(points[0]);
+    std::sort(sweepEdges.begin(),
+              sweepEdges.end());
 
-    size_t edgesIntersect=0;
+    for (const auto& edge : sweepEdges) {
+      size_t activeCount=0;
 
-    for (size_t i=0; i<points.size()-1; i++) {
-      edgesIntersect=0;
-
-      for (size_t j=i+1; j<points.size()-1; j++) {
-        if (LinesIntersect(points[i],
-                           points[i+1],
-                           points[j],
-                           points[j+1])) {
-          edgesIntersect++;
-
-          if (i==0) {
-            if (edgesIntersect>2) {
-              return false;
-            }
+      for (const auto& active : activeEdges) {
+        // The sweep line has passed the edge, it cannot intersect any further edge
+        if (active.maxLat<edge.minLat) {
+          continue;
+        }
+
+        activeEdges[activeCount]=active;
+        activeCount++;
+
+        if (active.maxLon<edge.minLon ||
+            active.minLon>edge.maxLon) {
+          continue;
+        }
+
+        if (!LinesIntersect(edges[active.index].first,
+                            edges[active.index].second,
+                            edges[edge.index].first,
+                            edges[edge.index].second)) {
+          continue;
+        }
+
+        // Every intersection is counted for the edge with the lower index
+        size_t i=std::min(active.index,edge.index);
+
+        edgesIntersect[i]++;
+
+        // We expect the first edge of a sole polygon to intersect with 2
+        // following edges (its adjacent edges), every other edge to intersect
+        // with 1 following edge (the next adjacent edge); polygon is complex
+        // if there are more intersections
+        if (edgeStartsNewPoly[i]) {
+          if (edgesIntersect[i]>2) {
+            return false;
           }
-          else {
-            if (edgesIntersect>1) {
-              return false;
-            }
+        }
+        else {
+          if (edgesIntersect[i]>1) {
+            return false;
           }
         }
       }
+
+      activeEdges.resize(activeCount);
+      activeEdges.push_back(edge);
     }
 
     return true;
@@ -471,54 +529,35 @@ namespace osmscout {
 
   /**
    * \ingroup Geometry
-   * Returns true, if the handed polygons are simple (aka not complex).
-   * This method supports passing multiple closed polygons and checks
-   * all of them.
+   * Returns true, if the handed polygon is simple (aka not complex).
    *
-   * Currently it is checked, that the line segments that make up the
-   * polygon, only meet at their end points.
+   * Currently the following checks are done:
+   * + Polygon has at least 3 points
+   * + Assure that the line segments that make up the polygon
+   *   only meet at their end points.
    */
   template<typename N>
-  bool AreaIsSimple(const std::vector<std::pair<N,N> >& edges,
-                    const std::vector<bool>& edgeStartsNewPoly)
+  bool AreaIsSimple(const std::vector<N>& points)
   {
-    size_t edgesIntersect=0;
+    if (points.size()<3) {
+      return false;
+    }
 
-    for (size_t i=0; i<edges.size(); i++) {
-      edgesIntersect=0;
-
-      for (size_t j=i+1; j<edges.size(); j++) {
-        if (LinesIntersect(edges[i].first,
-                           edges[i].second,
-                           edges[j].first,
-                           edges[j].second)) {
-          edgesIntersect++;
-
-          // we check the first edge of a sole polygon against every
-          // other edge and expect to see 2 intersections for
-          // adjacent edges; polygon is complex if there are more
-          // intersections
-          if (edgeStartsNewPoly[i]) {
-            if (edgesIntersect>2) {
-              return false;
-            }
-          }
+    std::vector<std::pair<N,N> > edges(points.size());
+    std::vector<bool>            edgeStartsNewPoly(points.size(),false);
 
-          // otherwise we check an edge that isn't the first
-          // edge against every other edge excluding those that
-          // have already been tested (this means one adjacent
-          // edge); polygon is complex if there is more than one
-          // intersection
-          else {
-            if (edgesIntersect>1) {
-              return false;
-            }
-          }
-        }
-      }
+    for (size_t i=0; i<points.size()-1; i++) {
+      edges[i].first=points[i];
+      edges[i].second=points[i+1];
     }
 
-    return true;
+    edges[points.size()-1].first=points[points.size()-1];
+    edges[points.size()-1].second=points[0];
+
+    edgeStartsNewPoly[0]=true;
+
+    return AreaIsSimple(edges,
+                        edgeStartsNewPoly);
   }
 
   /**
@@ -807,6 +846,39 @@ namespace osmscout {
 
     bool Merge(std::list<Polygon>& result);
   };
+
+  /**
+   * \ingroup Geometry
+   *
+   * Answers the same questions as GetRelationOfPointToArea() and
+   * IsAreaSubOfArea() for one area and many points, but only evaluates the
+   * edges that cross the latitude of the given point.
+   *
+   * The latitude range of the area is split into horizontal bands and
+   * every edge is registered in each band its latitude range touches. Points
+   * outside of the latitude range of the area are rejected without looking
+   * at any edge. The results are identical to GetRelationOfPointToArea()
+   * and IsAreaSubOfArea().
+   */
+  class OSMSCOUT_API AreaPointLocator
+  {
+  private:
+    const std::vector<GeoCoord>&       nodes;
+    double                             minLat;
+    double                             maxLat;
+    double                             bandHeight;
+    size_t                             bandCount;
+    std::vector<std::vector<uint32_t>> bands; //!< Index of the start node of each edge in the band
+
+  private:
+    size_t GetBand(double lat) const;
+
+  public:
+    AreaPointLocator(const std::vector<GeoCoord>& nodes);
+
+    int GetRelationOfPoint(const GeoCoord& point) const;
+    bool IsSubArea(const std::vector<GeoCoord>& area) const;
+  };
 }
 
 #endif
@@ -0,0 +1,227 @@
+#ifndef OSMSCOUT_UTIL_INDEXEDHEAP_H
+#define OSMSCOUT_UTIL_INDEXEDHEAP_H
+
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <osmscout/system/Assert.h>
+
+namespace osmscout {
+
+  /**
+   * \ingroup Util
+   * Indexed d-ary min heap over dense slot numbers.
+   *
+   * The heap does not hold the values itself, it only holds slot numbers
+   * (indexes into some external array holding the actual values). The
+   * Compare functor gets two slot numbers and has to return true, if the
+   * value for the first slot is smaller than the value of the second slot.
+   *
+   * Since the heap knows the position of every slot it holds, it supports
+   * an efficient DecreaseKey() operation. This makes it suitable as
+   * open list for Dijkstra/A* style algorithms.
+   *
+   * * The heap is not threadsafe.
+   * * Push(), Pop() and DecreaseKey() are O(log n).
+   * * Contains() is O(1).
+   */
+  template <class Compare, size_t D = 4>
+  class IndexedHeap
+  {
+  private:
+    static const size_t npos;
+
+    Compare             compare;
+    std::vector<size_t> heap;      //!< The heap, holding slot numbers
+    std::vector<size_t> positions; //!< Position in heap for each slot or npos
+
+  private:
+    inline void Place(size_t pos,
+                      size_t slot)
+    {
+      heap[pos]=slot;
+      positions[slot]=pos;
+    }
+
+    void SiftUp(size_t pos)
+    {
+      size_t slot=heap[pos];
+
+      while (pos>0) {
+        size_t parent=(pos-1)/D;
+
+        if (!compare(slot,heap[parent])) {
+          break;
+        }
+
+        Place(pos,heap[parent]);
+        pos=parent;
+      }
+
+      Place(pos,slot);
+    }
+
+    void SiftDown(size_t pos)
+    {
+      size_t slot=heap[pos];
+      size_t size=heap.size();
+
+      while (true) {
+        size_t firstChild=pos*D+1;
+
+        if (firstChild>=size) {
+          break;
+        }
+
+        size_t lastChild=std::min(firstChild+D,size);
+        size_t bestChild=firstChild;
+
+        for (size_t child=firstChild+1; child<lastChild; child++) {
+          if (compare(heap[child],heap[bestChild])) {
+            bestChild=child;
+          }
+        }
+
+        if (!compare(heap[bestChild],slot)) {
+          break;
+        }
+
+        Place(pos,heap[bestChild]);
+        pos=bestChild;
+      }
+
+      Place(pos,slot);
+    }
+
+  public:
+    IndexedHeap(const Compare& compare)
+    : compare(compare)
+    {
+      // no code
+    }
+
+    /**
+     * Reserve memory for the given number of slots
+     */
+    void Reserve(size_t slotCount)
+    {
+      heap.reserve(slotCount);
+      positions.reserve(slotCount);
+    }
+
+    inline bool Empty() const
+    {
+      return heap.empty();
+    }
+
+    inline size_t Size() const
+    {
+      return heap.size();
+    }
+
+    /**
+     * Return true, if the given slot is currently in the heap
+     */
+    inline bool Contains(size_t slot) const
+    {
+      return slot<positions.size() &&
+             positions[slot]!=npos;
+    }
+
+    /**
+     * Return the slot with the smallest value, without removing it.
+     * The heap must not be empty.
+     */
+    inline size_t Top() const
+    {
+      assert(!heap.empty());
+
+      return heap.front();
+    }
+
+    /**
+     * Add the given slot to the heap. The slot must not already be part
+     * of the heap.
+     */
+    void Push(size_t slot)
+    {
+      if (slot>=positions.size()) {
+        positions.resize(slot+1,npos);
+      }
+
+      assert(positions[slot]==npos);
+
+      heap.push_back(slot);
+      positions[slot]=heap.size()-1;
+
+      SiftUp(heap.size()-1);
+    }
+
+    /**
+     * Remove and return the slot with the smallest value.
+     * The heap must not be empty.
+     */
+    size_t Pop()
+    {
+      assert(!heap.empty());
+
+      size_t top=heap.front();
+      size_t last=heap.back();
+
+      heap.pop_back();
+      positions[top]=npos;
+
+      if (!heap.empty()) {
+        Place(0,last);
+        SiftDown(0);
+      }
+
+      return top;
+    }
+
+    /**
+     * Signal that the value of the given slot has decreased. The slot
+     * must be part of the heap.
+     */
+    void DecreaseKey(size_t slot)
+    {
+      assert(Contains(slot));
+
+      SiftUp(positions[slot]);
+    }
+
+    /**
+     * Remove all slots from the heap
+     */
+    void Clear()
+    {
+      heap.clear();
+      positions.clear();
+    }
+  };
+
+  template <class Compare, size_t D>
+  const size_t IndexedHeap<Compare,D>::npos=std::numeric_limits<size_t>::max();
+}
+
+#endif
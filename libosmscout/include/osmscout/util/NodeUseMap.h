@@ -22,7 +22,16 @@
 
 #include <osmscout/private/CoreImportExport.h>
 
-#include <bitset>
+#include <osmscout/CoreFeatures.h>
+
+#if defined(OSMSCOUT_HAVE_ATOMIC)
+#include <atomic>
+#endif
+
+#if defined(OSMSCOUT_HAVE_MUTEX)
+#include <mutex>
+#endif
+
 #include <unordered_map>
 
 #include <osmscout/Types.h>
@@ -39,21 +48,62 @@ namespace osmscout {
    * used. So while the data structure works for Id, it will
    * likely not work for OSMId.
    *
-   * It internally used large bitsets in a hashset to allow
-   * efficient memory usage (only a few entries in hashtable
-   * to reduce management overhead but no need for large
-   * continuous memory areas) and at the same time fast access
-   * (O(1)) for reading and writing.
+   * Every id is represented by 2 bits (used once, used at least twice)
+   * in dense pages of 4096 ids. Pages are referenced by a two level
+   * directory. Directories and pages are allocated on first use, so
+   * only the used id ranges take memory while access stays O(1).
+   * The directories cover the ids below 2^38. Pages for larger ids
+   * (for example negative OSM ids casted to Id) are held in a separate
+   * hash map of overflow pages, which is slower but works for the
+   * complete id range.
+   *
+   * SetNodeUsed() may be called from multiple threads at the same
+   * time. It must not be mixed with Clear() or the destructor and
+   * results must only be read after all writers have finished.
    */
   class OSMSCOUT_API NodeUseMap
   {
   private:
-    size_t                                    nodeCount;
-    typedef std::bitset<4096>                 Bitset;
-    typedef std::unordered_map<PageId,Bitset> Map;
+    static const size_t pageBits=12;
+    static const size_t directoryBits=12;
+    static const size_t rootBits=14;
+
+    static const size_t pageNodeCount=1 << pageBits;
+    static const size_t pageWordCount=pageNodeCount/32;
+    static const size_t directoryPageCount=1 << directoryBits;
+    static const size_t rootDirectoryCount=1 << rootBits;
+
+#if defined(OSMSCOUT_HAVE_ATOMIC)
+    typedef std::atomic<uint64_t>      Word;
+    typedef std::atomic<Word*>         PageRef;
+    typedef std::atomic<PageRef*>      DirectoryRef;
+    typedef std::atomic<DirectoryRef*> RootRef;
+    typedef std::atomic<size_t>        Counter;
+#else
+    typedef uint64_t                   Word;
+    typedef Word*                      PageRef;
+    typedef PageRef*                   DirectoryRef;
+    typedef DirectoryRef*              RootRef;
+    typedef size_t                     Counter;
+#endif
+
+    typedef std::unordered_map<PageId,Word*> OverflowPageMap;
+
+  private:
+    RootRef            root;
+    Counter            nodeCount;
+    Counter            directoryCount;
+    Counter            pageCount;
+    OverflowPageMap    overflowPages;  //!< Pages of ids outside the directories
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    mutable std::mutex overflowMutex;  //!< Mutex guarding overflowPages
+#endif
 
   private:
-    Map nodeUseMap;
+    Word* GetOverflowPage(PageId pageId);
+    const Word* FindOverflowPage(PageId pageId) const;
+    Word* GetPage(PageId pageId);
+    const Word* FindPage(PageId pageId) const;
 
   public:
     NodeUseMap();
@@ -62,6 +112,7 @@ namespace osmscout {
     void SetNodeUsed(Id id);
     bool IsNodeUsedAtLeastTwice(Id id) const;
     size_t GetNodeUsedCount() const;
+    size_t GetMemoryUsage() const;
 
     void Clear();
   };
@@ -218,6 +218,20 @@ namespace osmscout {
     virtual bool GeoToPixel(const GeoCoord& coord,
                             double& x, double& y) const = 0;
 
+    /**
+     * Converts count geo coordinates to pixel coordinates in one call. The pixel
+     * coordinate of coords[i] is stored at x and y advanced by i*stride bytes, so
+     * results can be written directly into an array of structures.
+     *
+     * The default implementation converts one coordinate after the other,
+     * projections overwrite it with a vectorized version, if possible.
+     */
+    virtual bool GeoToPixel(const GeoCoord* coords,
+                            size_t count,
+                            double* x,
+                            double* y,
+                            size_t stride) const;
+
     /**
      * Returns the bounding box of the area covered
      */
@@ -389,6 +403,12 @@ namespace osmscout {
     bool GeoToPixel(const GeoCoord& coord,
                     double& x, double& y) const;
 
+    bool GeoToPixel(const GeoCoord* coords,
+                    size_t count,
+                    double* x,
+                    double* y,
+                    size_t stride) const;
+
     bool GetDimensions(GeoBox& boundingBox) const;
 
     double GetPixelSize() const;
@@ -433,6 +453,8 @@ namespace osmscout {
 
     size_t              tileX;         //! X coordinate of tile
     size_t              tileY;         //! Y coordinate of tile
+    size_t              tileCountX;    //! Number of tiles in horizontal direction
+    size_t              tileCountY;    //! Number of tiles in vertical direction
     double              lon;           //! Longitude coordinate of the center of the image
     double              lat;           //! Latitude coordinate of the center of the image
     Magnification       magnification; //! Current magnification
@@ -529,6 +551,20 @@ namespace osmscout {
     }
 
     bool Set(size_t tileX, size_t tileY,
+             const Magnification& magnification,
+             double dpi,
+             size_t width, size_t height)
+    {
+      return Set(tileX,tileY,1,1,magnification,dpi,width,height);
+    }
+
+    /**
+     * Set up the projection for a block of tileCountX x tileCountY tiles
+     * (a "metatile") with the given tile as its upper left tile. Width and
+     * height are the dimensions of the whole block.
+     */
+    bool Set(size_t tileX, size_t tileY,
+             size_t tileCountX, size_t tileCountY,
              const Magnification& magnification,
              double dpi,
              size_t width, size_t height);
@@ -546,6 +582,12 @@ namespace osmscout {
     bool GeoToPixel(const GeoCoord& coord,
                     double& x, double& y) const;
 
+    bool GeoToPixel(const GeoCoord* coords,
+                    size_t count,
+                    double* x,
+                    double* y,
+                    size_t stride) const;
+
     bool GetDimensions(GeoBox& boundingBox) const;
 
   protected:
@@ -28,6 +28,33 @@
 
 namespace osmscout {
 
+  static inline bool ReadCoords(const TypeConfig& typeConfig,
+                                FileScanner& scanner,
+                                std::vector<GeoCoord>& nodes,
+                                size_t count)
+  {
+    if (typeConfig.HasDeltaEncodedCoords()) {
+      return scanner.ReadDeltaEncoded(nodes,
+                                      count);
+    }
+
+    return scanner.Read(nodes,
+                        count);
+  }
+
+  static inline bool WriteCoords(const TypeConfig& typeConfig,
+                                 FileWriter& writer,
+                                 const std::vector<GeoCoord>& nodes)
+  {
+    if (typeConfig.HasDeltaEncodedCoords()) {
+      return writer.WriteDeltaEncoded(nodes,
+                                      nodes.size());
+    }
+
+    return writer.Write(nodes,
+                        nodes.size());
+  }
+
   bool Area::Ring::GetCenter(GeoCoord& center) const
   {
     double minLat=0.0;
@@ -243,8 +270,10 @@ namespace osmscout {
         }
       }
 
-      if (!scanner.Read(rings[0].nodes,
-                        nodesCount)) {
+      if (!ReadCoords(typeConfig,
+                      scanner,
+                      rings[0].nodes,
+                      nodesCount)) {
         return false;
       }
     }
@@ -277,8 +306,10 @@ namespace osmscout {
           }
         }
 
-        if (!scanner.Read(rings[i].nodes,
-                          nodesCount)) {
+        if (!ReadCoords(typeConfig,
+                        scanner,
+                        rings[i].nodes,
+                        nodesCount)) {
           return false;
         }
       }
@@ -342,8 +373,10 @@ namespace osmscout {
         return false;
       }
 
-      if (!scanner.Read(rings[0].nodes,
-                        nodesCount)) {
+      if (!ReadCoords(typeConfig,
+                      scanner,
+                      rings[0].nodes,
+                      nodesCount)) {
         return false;
       }
     }
@@ -375,8 +408,10 @@ namespace osmscout {
           }
         }
 
-        if (!scanner.Read(rings[i].nodes,
-                          nodesCount)) {
+        if (!ReadCoords(typeConfig,
+                        scanner,
+                        rings[i].nodes,
+                        nodesCount)) {
           return false;
         }
       }
@@ -434,8 +469,10 @@ namespace osmscout {
     }
 
     if (nodesCount>0) {
-      if (!scanner.Read(rings[0].nodes,
-                        nodesCount)) {
+      if (!ReadCoords(typeConfig,
+                      scanner,
+                      rings[0].nodes,
+                      nodesCount)) {
         return false;
       }
     }
@@ -459,8 +496,10 @@ namespace osmscout {
       scanner.ReadNumber(nodesCount);
 
       if (nodesCount>0) {
-        if (!scanner.Read(rings[i].nodes,
-                          nodesCount)) {
+        if (!ReadCoords(typeConfig,
+                        scanner,
+                        rings[i].nodes,
+                        nodesCount)) {
           return false;
         }
       }
@@ -550,8 +589,9 @@ namespace osmscout {
         }
       }
 
-      if (!writer.Write(ring->nodes,
-                        ring->nodes.size())) {
+      if (!WriteCoords(typeConfig,
+                       writer,
+                       ring->nodes)) {
         return false;
       }
     }
@@ -583,8 +623,9 @@ namespace osmscout {
           }
         }
 
-        if (!writer.Write(ring->nodes,
-                          ring->nodes.size())) {
+        if (!WriteCoords(typeConfig,
+                         writer,
+                         ring->nodes)) {
           return false;
         }
       }
@@ -624,8 +665,9 @@ namespace osmscout {
       }
 
 
-      if (!writer.Write(ring->nodes,
-                        ring->nodes.size())) {
+      if (!WriteCoords(typeConfig,
+                       writer,
+                       ring->nodes)) {
         return false;
       }
     }
@@ -656,8 +698,9 @@ namespace osmscout {
           }
         }
 
-        if (!writer.Write(ring->nodes,
-                          ring->nodes.size())) {
+        if (!WriteCoords(typeConfig,
+                         writer,
+                         ring->nodes)) {
           return false;
         }
       }
@@ -691,8 +734,9 @@ namespace osmscout {
     writer.WriteNumber((uint32_t)ring->nodes.size());
 
     if (!ring->nodes.empty()) {
-      if (!writer.Write(ring->nodes,
-                        ring->nodes.size())) {
+      if (!WriteCoords(typeConfig,
+                       writer,
+                       ring->nodes)) {
         return false;
       }
     }
@@ -716,8 +760,9 @@ namespace osmscout {
       writer.WriteNumber((uint32_t)ring->nodes.size());
 
       if (!ring->nodes.empty()) {
-        if (!writer.Write(ring->nodes,
-                          ring->nodes.size())) {
+        if (!WriteCoords(typeConfig,
+                         writer,
+                         ring->nodes)) {
           return false;
         }
       }
@@ -39,84 +39,91 @@ namespace osmscout {
 
   void AreaAreaIndex::Close()
   {
-    if (scanner.IsOpen()) {
-      scanner.Close();
+    indexCache.Flush();
+
+    if (scanners.IsOpen()) {
+      scanners.Close();
     }
   }
 
-  bool AreaAreaIndex::GetIndexCell(const TypeConfig& typeConfig,
+  bool AreaAreaIndex::GetIndexCell(FileScanner& scanner,
+                                   const TypeConfig& typeConfig,
                                    uint32_t level,
                                    FileOffset offset,
-                                   IndexCache::CacheRef& cacheRef) const
+                                   IndexCellRef& cell) const
   {
-    if (!indexCache.GetEntry(offset,cacheRef)) {
-      IndexCache::CacheEntry cacheEntry(offset);
+    if (indexCache.GetEntry(offset,cell)) {
+      return true;
+    }
+
+    IndexCellRef newCell=std::make_shared<IndexCell>();
 
-      cacheRef=indexCache.SetEntry(cacheEntry);
+    if (!scanner.SetPos(offset)) {
+      log.Error() << "Cannot go to index data at offset " << offset << " in file '" << scanner.GetFilename() << "'";
+      return false;
+    }
 
-      if (!scanner.IsOpen()) {
-        if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
-          log.Error() << "Error while opening '" << scanner.GetFilename() << "' for reading!";
+    // Read offsets of children if not in the bottom level
+
+    if (level<maxLevel) {
+      for (size_t c=0; c<4; c++) {
+        if (!scanner.ReadNumber(newCell->children[c])) {
+          log.Error() << "Cannot read index data at offset " << offset << " in file '" << scanner.GetFilename() << "'";
           return false;
         }
       }
+    }
+    else {
+      for (size_t c=0; c<4; c++) {
+        newCell->children[c]=0;
+      }
+    }
 
-      scanner.SetPos(offset);
+    // Now read the way offsets by type in this index entry
 
-      // Read offsets of children if not in the bottom level
+    uint32_t offsetCount;
 
-      if (level<maxLevel) {
-        for (size_t c=0; c<4; c++) {
-          if (!scanner.ReadNumber(cacheRef->value.children[c])) {
-            log.Error() << "Cannot read index data at offset " << offset << " in file '" << scanner.GetFilename() << "'";
-            return false;
-          }
-        }
-      }
-      else {
-        for (size_t c=0; c<4; c++) {
-          cacheRef->value.children[c]=0;
-        }
-      }
+    // Areas
 
-      // Now read the way offsets by type in this index entry
+    if (!scanner.ReadNumber(offsetCount)) {
+      log.Error() << "Cannot read index data for level " << level << " at offset " << offset << " in file '" << scanner.GetFilename() << "'";
+      return false;
+    }
 
-      uint32_t offsetCount;
+    newCell->areas.resize(offsetCount);
 
-      // Areas
+    FileOffset prevOffset=0;
 
-      if (!scanner.ReadNumber(offsetCount)) {
+    for (size_t c=0; c<offsetCount; c++) {
+      if (!scanner.ReadTypeId(newCell->areas[c].type,
+                              typeConfig.GetAreaTypeIdBytes())) {
         log.Error() << "Cannot read index data for level " << level << " at offset " << offset << " in file '" << scanner.GetFilename() << "'";
         return false;
       }
 
-      cacheRef->value.areas.resize(offsetCount);
-
-      FileOffset prevOffset=0;
+      if (!scanner.ReadNumber(newCell->areas[c].offset)) {
+        log.Error() << "Cannot read index data for level " << level << " at offset " << offset << " in file '" << scanner.GetFilename() << "'";
+        return false;
+      }
 
-      for (size_t c=0; c<offsetCount; c++) {
-        if (!scanner.ReadTypeId(cacheRef->value.areas[c].type,
-                                typeConfig.GetAreaTypeIdBytes())) {
-          log.Error() << "Cannot read index data for level " << level << " at offset " << offset << " in file '" << scanner.GetFilename() << "'";
-          return false;
-        }
+      newCell->areas[c].offset+=prevOffset;
 
-        if (!scanner.ReadNumber(cacheRef->value.areas[c].offset)) {
-          log.Error() << "Cannot read index data for level " << level << " at offset " << offset << " in file '" << scanner.GetFilename() << "'";
-          return false;
-        }
+      prevOffset=newCell->areas[c].offset;
+    }
 
-        cacheRef->value.areas[c].offset+=prevOffset;
+    indexCache.InsertEntry(offset,
+                           newCell,
+                           sizeof(IndexCell)+newCell->areas.capacity()*sizeof(IndexEntry));
 
-        prevOffset=cacheRef->value.areas[c].offset;
-      }
-    }
+    cell=newCell;
 
     return true;
   }
 
   bool AreaAreaIndex::Load(const std::string& path)
   {
+    FileScanner scanner;
+
     datafilename=path+"/"+filepart;
 
     if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
@@ -146,7 +153,13 @@ namespace osmscout {
       cellHeight[i]=180.0/pow(2.0,(int)i);
     }
 
-    return !scanner.HasError() && scanner.Close();
+    if (scanner.HasError() ||
+        !scanner.Close()) {
+      log.Error() << "Cannot read data from file '" << datafilename << "'";
+      return false;
+    }
+
+    return scanners.Open(datafilename,FileScanner::LowMemRandom,true);
   }
 
   bool AreaAreaIndex::GetOffsets(const TypeConfigRef& typeConfig,
@@ -162,6 +175,12 @@ namespace osmscout {
     std::vector<CellRef>    cellRefs;     // cells to scan in this level
     std::vector<CellRef>    nextCellRefs; // cells to scan for the next level
     std::vector<FileOffset> newOffsets;   // offsets collected in the current level
+    PooledFileScanner       scanner(scanners);
+
+    if (!scanner.IsValid()) {
+      log.Error() << "Error while opening '" << datafilename << "' for reading!";
+      return false;
+    }
 
     minlon+=180;
     maxlon+=180;
@@ -202,24 +221,25 @@ namespace osmscout {
       for (size_t i=0; !stopArea && i<cellRefs.size(); i++) {
         size_t               cx;
         size_t               cy;
-        IndexCache::CacheRef cell;
+        IndexCellRef         cell;
 
-        if (!GetIndexCell(*typeConfig,
+        if (!GetIndexCell(*scanner,
+                          *typeConfig,
                           level,
                           cellRefs[i].offset,
                           cell)) {
-          log.Error() << "Cannot find offset " << cellRefs[i].offset << " in level " << level << " in file '" << scanner.GetFilename() << "'";
+          log.Error() << "Cannot find offset " << cellRefs[i].offset << " in level " << level << " in file '" << datafilename << "'";
           return false;
         }
 
         if (offsets.size()+
             newOffsets.size()+
-            cell->value.areas.size()>=maxCount) {
+            cell->areas.size()>=maxCount) {
           stopArea=true;
           continue;
         }
 
-        for (const auto entry : cell->value.areas) {
+        for (const auto entry : cell->areas) {
           if (types.IsTypeSet(entry.type)) {
             newOffsets.push_back(entry.offset);
           }
@@ -228,7 +248,7 @@ namespace osmscout {
         cx=cellRefs[i].x*2;
         cy=cellRefs[i].y*2;
 
-        if (cell->value.children[0]!=0) {
+        if (cell->children[0]!=0) {
           // top left
           double x=cx*cellWidth[level+1];
           double y=(cy+1)*cellHeight[level+1];
@@ -237,11 +257,11 @@ namespace osmscout {
                 y>maxlat+cellHeight[level+1]/2 ||
                 x+cellWidth[level+1]<minlon-cellWidth[level+1]/2 ||
                 y+cellHeight[level+1]<minlat-cellHeight[level+1]/2)) {
-            nextCellRefs.push_back(CellRef(cell->value.children[0],cx,cy+1));
+            nextCellRefs.push_back(CellRef(cell->children[0],cx,cy+1));
           }
         }
 
-        if (cell->value.children[1]!=0) {
+        if (cell->children[1]!=0) {
           // top right
           double x=(cx+1)*cellWidth[level+1];
           double y=(cy+1)*cellHeight[level+1];
@@ -250,11 +270,11 @@ namespace osmscout {
                 y>maxlat+cellHeight[level+1]/2 ||
                 x+cellWidth[level+1]<minlon-cellWidth[level+1]/2 ||
                 y+cellHeight[level+1]<minlat-cellHeight[level+1]/2)) {
-            nextCellRefs.push_back(CellRef(cell->value.children[1],cx+1,cy+1));
+            nextCellRefs.push_back(CellRef(cell->children[1],cx+1,cy+1));
           }
         }
 
-        if (cell->value.children[2]!=0) {
+        if (cell->children[2]!=0) {
           // bottom left
           double x=cx*cellWidth[level+1];
           double y=cy*cellHeight[level+1];
@@ -263,11 +283,11 @@ namespace osmscout {
                 y>maxlat+cellHeight[level+1]/2 ||
                 x+cellWidth[level+1]<minlon-cellWidth[level+1]/2 ||
                 y+cellHeight[level+1]<minlat-cellHeight[level+1]/2)) {
-            nextCellRefs.push_back(CellRef(cell->value.children[2],cx,cy));
+            nextCellRefs.push_back(CellRef(cell->children[2],cx,cy));
           }
         }
 
-        if (cell->value.children[3]!=0) {
+        if (cell->children[3]!=0) {
           // bottom right
           double x=(cx+1)*cellWidth[level+1];
           double y=cy*cellHeight[level+1];
@@ -276,7 +296,7 @@ namespace osmscout {
                 y>maxlat+cellHeight[level+1]/2 ||
                 x+cellWidth[level+1]<minlon-cellWidth[level+1]/2 ||
                 y+cellHeight[level+1]<minlat-cellHeight[level+1]/2)) {
-            nextCellRefs.push_back(CellRef(cell->value.children[3],cx+1,cy));
+            nextCellRefs.push_back(CellRef(cell->children[3],cx+1,cy));
           }
         }
       }
@@ -293,7 +313,7 @@ namespace osmscout {
 
   void AreaAreaIndex::DumpStatistics()
   {
-    indexCache.DumpStatistics(filepart.c_str(),IndexCacheValueSizer());
+    indexCache.DumpStatistics(filepart.c_str());
   }
 }
 
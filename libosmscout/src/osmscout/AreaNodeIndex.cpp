@@ -54,13 +54,15 @@ namespace osmscout {
 
   void AreaNodeIndex::Close()
   {
-    if (scanner.IsOpen()) {
-      scanner.Close();
+    if (scanners.IsOpen()) {
+      scanners.Close();
     }
   }
 
   bool AreaNodeIndex::Load(const std::string& path)
   {
+    FileScanner scanner;
+
     datafilename=path+"/"+filepart;
 
     if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
@@ -103,10 +105,17 @@ namespace osmscout {
       nodeTypeData[type].maxLat=(nodeTypeData[type].cellYEnd+1)*nodeTypeData[type].cellHeight-90.0;
     }
 
-    return !scanner.HasError() && scanner.Close();
+    if (scanner.HasError() ||
+        !scanner.Close()) {
+      log.Error() << "Cannot read data from file '" << datafilename << "'";
+      return false;
+    }
+
+    return scanners.Open(datafilename,FileScanner::LowMemRandom,true);
   }
 
-  bool AreaNodeIndex::GetOffsets(const TypeData& typeData,
+  bool AreaNodeIndex::GetOffsets(FileScanner& scanner,
+                                 const TypeData& typeData,
                                  double minlon,
                                  double minlat,
                                  double maxlon,
@@ -237,18 +246,19 @@ namespace osmscout {
                                  size_t maxNodeCount,
                                  std::vector<FileOffset>& nodeOffsets) const
   {
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
-        log.Error() << "Error while opening file '" << scanner.GetFilename() << "' for reading!";
-        return false;
-      }
+    PooledFileScanner scanner(scanners);
+
+    if (!scanner.IsValid()) {
+      log.Error() << "Error while opening file '" << datafilename << "' for reading!";
+      return false;
     }
 
     bool sizeExceeded=false;
 
     for (TypeId i=0; i<nodeTypeData.size(); i++) {
       if (nodeTypes.IsTypeSet(i)) {
-        if (!GetOffsets(nodeTypeData[i],
+        if (!GetOffsets(*scanner,
+                        nodeTypeData[i],
                         minlon,
                         minlat,
                         maxlon,
@@ -54,14 +54,16 @@ namespace osmscout {
 
   void AreaWayIndex::Close()
   {
-    if (scanner.IsOpen()) {
-      scanner.Close();
+    if (scanners.IsOpen()) {
+      scanners.Close();
     }
   }
 
   bool AreaWayIndex::Load(const TypeConfigRef& typeConfig,
                           const std::string& path)
   {
+    FileScanner scanner;
+
     datafilename=path+"/"+filepart;
 
     if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
@@ -108,10 +110,17 @@ namespace osmscout {
       }
     }
 
-    return !scanner.HasError() && scanner.Close();
+    if (scanner.HasError() ||
+        !scanner.Close()) {
+      log.Error() << "Cannot read data from file '" << datafilename << "'";
+      return false;
+    }
+
+    return scanners.Open(datafilename,FileScanner::LowMemRandom,true);
   }
 
-  bool AreaWayIndex::GetOffsets(const TypeData& typeData,
+  bool AreaWayIndex::GetOffsets(FileScanner& scanner,
+                                const TypeData& typeData,
                                 double minlon,
                                 double minlat,
                                 double maxlon,
@@ -242,11 +251,11 @@ namespace osmscout {
                                 size_t maxWayCount,
                                 std::vector<FileOffset>& offsets) const
   {
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
-        log.Error() << "Error while opening " << scanner.GetFilename() << " for reading!";
-        return false;
-      }
+    PooledFileScanner scanner(scanners);
+
+    if (!scanner.IsValid()) {
+      log.Error() << "Error while opening '" << datafilename << "' for reading!";
+      return false;
     }
 
     bool                           sizeExceeded=false;
@@ -262,7 +271,8 @@ namespace osmscout {
           type<wayTypeData.size();
           ++type) {
         if (wayTypes[i].IsTypeSet(type)) {
-          if (!GetOffsets(wayTypeData[type],
+          if (!GetOffsets(*scanner,
+                          wayTypeData[type],
                           minlon,
                           minlat,
                           maxlon,
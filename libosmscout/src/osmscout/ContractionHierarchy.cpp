@@ -0,0 +1,438 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/ContractionHierarchy.h>
+
+#include <cmath>
+#include <limits>
+
+#include <osmscout/util/Logger.h>
+
+namespace osmscout {
+
+  const uint32_t CHEdge::noMiddle=std::numeric_limits<uint32_t>::max();
+  const double   CHEdge::costFactor=10000000.0;
+
+  const double   CHMetric::speedFactor=100.0;
+
+  const uint32_t ContractionHierarchy::fileFormatVersion=1;
+
+  static uint32_t EncodeSpeed(double speed)
+  {
+    return (uint32_t)std::min(floor(speed*CHMetric::speedFactor+0.5),
+                              (double)std::numeric_limits<uint32_t>::max());
+  }
+
+  static bool ReadEdges(FileScanner& scanner,
+                        std::vector<CHEdge>& edges)
+  {
+    uint32_t edgeCount;
+
+    if (!scanner.ReadNumber(edgeCount)) {
+      return false;
+    }
+
+    edges.resize(edgeCount);
+
+    for (auto& edge : edges) {
+      scanner.ReadNumber(edge.target);
+      scanner.ReadNumber(edge.weight);
+      scanner.ReadNumber(edge.middle);
+      scanner.ReadNumber(edge.firstNode);
+      scanner.Read(edge.firstObject);
+      scanner.Read(edge.lastObject);
+    }
+
+    return !scanner.HasError();
+  }
+
+  static bool WriteEdges(FileWriter& writer,
+                         const std::vector<CHEdge>& edges)
+  {
+    writer.WriteNumber((uint32_t)edges.size());
+
+    for (const auto& edge : edges) {
+      writer.WriteNumber(edge.target);
+      writer.WriteNumber(edge.weight);
+      writer.WriteNumber(edge.middle);
+      writer.WriteNumber(edge.firstNode);
+      writer.Write(edge.firstObject);
+      writer.Write(edge.lastObject);
+    }
+
+    return !writer.HasError();
+  }
+
+  /**
+   * Returns true, if - coming from the given source object - the
+   * given edge cannot be used because of a turn restriction.
+   */
+  bool CHNode::IsTurnForbidden(const ObjectFileRef& source,
+                               const CHEdge& edge) const
+  {
+    for (const auto& exclude : excludes) {
+      if (exclude.source==source &&
+          exclude.targetObject==edge.firstObject &&
+          exclude.targetNode==edge.firstNode) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  bool CHNode::Read(FileScanner& scanner)
+  {
+    uint32_t excludeCount;
+
+    scanner.ReadFileOffset(routeNodeOffset);
+
+    if (!ReadEdges(scanner,upEdges) ||
+        !ReadEdges(scanner,downEdges)) {
+      return false;
+    }
+
+    if (!scanner.ReadNumber(excludeCount)) {
+      return false;
+    }
+
+    excludes.resize(excludeCount);
+
+    for (auto& exclude : excludes) {
+      scanner.Read(exclude.source);
+      scanner.Read(exclude.targetObject);
+      scanner.ReadNumber(exclude.targetNode);
+    }
+
+    return !scanner.HasError();
+  }
+
+  bool CHNode::Write(FileWriter& writer) const
+  {
+    writer.WriteFileOffset(routeNodeOffset);
+
+    if (!WriteEdges(writer,upEdges) ||
+        !WriteEdges(writer,downEdges)) {
+      return false;
+    }
+
+    writer.WriteNumber((uint32_t)excludes.size());
+
+    for (const auto& exclude : excludes) {
+      writer.Write(exclude.source);
+      writer.Write(exclude.targetObject);
+      writer.WriteNumber(exclude.targetNode);
+    }
+
+    return !writer.HasError();
+  }
+
+  CHMetric::CHMetric()
+  : vehicle(vehicleCar),
+    vehicleMaxSpeed(0)
+  {
+    // no code
+  }
+
+  /**
+   * Set the metric from the given routing profile.
+   *
+   * @return
+   *    false, if the profile does not use the fastest path metric, else true
+   */
+  bool CHMetric::Set(const TypeConfig& typeConfig,
+                     const RoutingProfile& profile)
+  {
+    const FastestPathRoutingProfile* fastestProfile=dynamic_cast<const FastestPathRoutingProfile*>(&profile);
+
+    speeds.clear();
+
+    if (fastestProfile==NULL) {
+      return false;
+    }
+
+    vehicle=fastestProfile->GetVehicle();
+    vehicleMaxSpeed=EncodeSpeed(fastestProfile->GetVehicleMaxSpeed());
+
+    for (const auto &type : typeConfig.GetTypes()) {
+      double speed=fastestProfile->GetSpeed(*type);
+
+      if (speed>0.0) {
+        speeds[type->GetName()]=EncodeSpeed(speed);
+      }
+    }
+
+    return true;
+  }
+
+  bool CHMetric::operator==(const CHMetric& other) const
+  {
+    return vehicle==other.vehicle &&
+           vehicleMaxSpeed==other.vehicleMaxSpeed &&
+           speeds==other.speeds;
+  }
+
+  bool CHMetric::Read(FileScanner& scanner)
+  {
+    uint8_t  vehicleValue;
+    uint32_t speedCount;
+
+    speeds.clear();
+
+    scanner.Read(vehicleValue);
+    scanner.ReadNumber(vehicleMaxSpeed);
+
+    if (!scanner.ReadNumber(speedCount)) {
+      return false;
+    }
+
+    vehicle=(Vehicle)vehicleValue;
+
+    for (uint32_t i=0; i<speedCount; i++) {
+      std::string typeName;
+      uint32_t    speed;
+
+      scanner.Read(typeName);
+      scanner.ReadNumber(speed);
+
+      speeds[typeName]=speed;
+    }
+
+    return !scanner.HasError();
+  }
+
+  bool CHMetric::Write(FileWriter& writer) const
+  {
+    writer.Write((uint8_t)vehicle);
+    writer.WriteNumber(vehicleMaxSpeed);
+    writer.WriteNumber((uint32_t)speeds.size());
+
+    for (const auto& speed : speeds) {
+      writer.Write(speed.first);
+      writer.WriteNumber(speed.second);
+    }
+
+    return !writer.HasError();
+  }
+
+  /**
+   * Load the contraction hierarchy from the given file. Files of a different
+   * file format version or calculated from a route graph data file of another
+   * size are rejected.
+   */
+  bool ContractionHierarchy::Load(const std::string& filename,
+                                  FileOffset graphFileSize)
+  {
+    FileScanner scanner;
+    uint32_t    version;
+    FileOffset  expectedGraphFileSize;
+    uint32_t    nodeCount;
+
+    Clear();
+
+    if (!scanner.Open(filename,
+                      FileScanner::Sequential,
+                      true)) {
+      log.Error() << "Cannot open '" << filename << "'!";
+      return false;
+    }
+
+    if (!scanner.Read(version)) {
+      log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'!";
+      return false;
+    }
+
+    if (version!=fileFormatVersion) {
+      log.Warn() << "File '" << scanner.GetFilename() << "' has file format version " << version << " instead of " << fileFormatVersion << "!";
+      return false;
+    }
+
+    if (!scanner.ReadFileOffset(expectedGraphFileSize) ||
+        !metric.Read(scanner) ||
+        !scanner.Read(nodeCount)) {
+      log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'!";
+      return false;
+    }
+
+    if (expectedGraphFileSize!=graphFileSize) {
+      log.Warn() << "File '" << scanner.GetFilename() << "' does not match the current route graph!";
+      return false;
+    }
+
+    nodes.resize(nodeCount);
+    nodeIndexes.reserve(nodeCount);
+
+    for (uint32_t i=0; i<nodeCount; i++) {
+      if (!nodes[i].Read(scanner)) {
+        log.Error() << "Error while reading node " << i << " from file '" << scanner.GetFilename() << "'!";
+        Clear();
+        return false;
+      }
+
+      nodeIndexes[nodes[i].routeNodeOffset]=i;
+    }
+
+    if (!scanner.Close()) {
+      log.Error() << "Cannot close file '" << scanner.GetFilename() << "'!";
+      Clear();
+      return false;
+    }
+
+    return true;
+  }
+
+  void ContractionHierarchy::Clear()
+  {
+    metric=CHMetric();
+    nodes.clear();
+    nodeIndexes.clear();
+  }
+
+  /**
+   * Write the file header, the nodes are expected to follow
+   */
+  bool ContractionHierarchy::WriteHeader(FileWriter& writer,
+                                         FileOffset graphFileSize,
+                                         const CHMetric& metric,
+                                         uint32_t nodeCount)
+  {
+    writer.Write(fileFormatVersion);
+    writer.WriteFileOffset(graphFileSize);
+
+    if (!metric.Write(writer)) {
+      return false;
+    }
+
+    writer.Write(nodeCount);
+
+    return !writer.HasError();
+  }
+
+  /**
+   * Returns true, if the hierarchy is loaded and was calculated with the
+   * metric of the given profile.
+   */
+  bool ContractionHierarchy::IsCompatible(const TypeConfig& typeConfig,
+                                          const RoutingProfile& profile) const
+  {
+    CHMetric profileMetric;
+
+    if (nodes.empty() ||
+        !profileMetric.Set(typeConfig,
+                           profile)) {
+      return false;
+    }
+
+    return profileMetric==metric;
+  }
+
+  /**
+   * Return the index of the node referencing the route node with the given file offset.
+   *
+   * @return
+   *    false, if the route node is not part of the contraction hierarchy, else true
+   */
+  bool ContractionHierarchy::GetNodeIndex(FileOffset routeNodeOffset,
+                                          uint32_t& index) const
+  {
+    auto entry=nodeIndexes.find(routeNodeOffset);
+
+    if (entry==nodeIndexes.end()) {
+      return false;
+    }
+
+    index=entry->second;
+
+    return true;
+  }
+
+  /**
+   * Recursively replaces the given edge (leading from node 'from' to node 'to'
+   * in the routing graph) by the paths of the routing graph it represents.
+   * For each path the reached node gets appended to nodes and the object used
+   * gets appended to objects.
+   *
+   * @return
+   *    false, if a shortcut could not be resolved, else true
+   */
+  bool ContractionHierarchy::UnpackEdge(uint32_t from,
+                                        uint32_t to,
+                                        const CHEdge& edge,
+                                        std::vector<uint32_t>& nodes,
+                                        std::vector<ObjectFileRef>& objects) const
+  {
+    struct PendingEdge
+    {
+      uint32_t      from;
+      uint32_t      to;
+      const CHEdge* edge;
+    };
+
+    std::vector<PendingEdge> stack;
+
+    stack.push_back(PendingEdge{from,to,&edge});
+
+    while (!stack.empty()) {
+      PendingEdge current=stack.back();
+
+      stack.pop_back();
+
+      if (!current.edge->IsShortcut()) {
+        nodes.push_back(current.to);
+        objects.push_back(current.edge->firstObject);
+        continue;
+      }
+
+      const CHNode& middle=this->nodes[current.edge->middle];
+      const CHEdge* first=NULL;
+      const CHEdge* second=NULL;
+
+      // The edge from the start to the middle node is stored as down edge
+      // of the middle node, the edge from the middle node to the end as up edge
+      for (const auto& candidate : middle.downEdges) {
+        if (candidate.target==current.from &&
+            candidate.firstObject==current.edge->firstObject &&
+            candidate.firstNode==current.edge->firstNode &&
+            (first==NULL || candidate.weight<first->weight)) {
+          first=&candidate;
+        }
+      }
+
+      for (const auto& candidate : middle.upEdges) {
+        if (candidate.target==current.to &&
+            candidate.lastObject==current.edge->lastObject &&
+            (second==NULL || candidate.weight<second->weight)) {
+          second=&candidate;
+        }
+      }
+
+      if (first==NULL ||
+          second==NULL) {
+        log.Error() << "Cannot unpack shortcut via contraction hierarchy node " << current.edge->middle;
+        return false;
+      }
+
+      // Push in reverse order, so that the first half gets resolved first
+      stack.push_back(PendingEdge{current.edge->middle,current.to,second});
+      stack.push_back(PendingEdge{current.from,current.edge->middle,first});
+    }
+
+    return true;
+  }
+}
@@ -19,6 +19,8 @@
 
 #include "osmscout/CoordDataFile.h"
 
+#include <algorithm>
+
 #include <osmscout/system/Assert.h>
 
 #include <osmscout/util/File.h>
@@ -26,6 +28,8 @@
 
 namespace osmscout {
 
+  const uint32_t CoordDataFile::fileFormatVersion;
+
   CoordDataFile::CoordDataFile(const std::string& datafile)
   : isOpen(false),
     datafile(datafile),
@@ -44,57 +48,83 @@ namespace osmscout {
   bool CoordDataFile::Open(const std::string& path,
                            bool memoryMapedData)
   {
+    FileScanner scanner;
+    uint32_t    marker;
+    uint32_t    formatVersion;
+    FileOffset  mapOffset;
+    uint32_t    rangeCount;
+
     datafilename=AppendFileToDir(path,datafile);
 
     isOpen=false;
-    coordPageOffsetMap.clear();
+    pageRanges.clear();
 
-    if (scanner.Open(datafilename,
-                     FileScanner::FastRandom,
-                     memoryMapedData)) {
-      FileOffset mapOffset;
+    if (!scanner.Open(datafilename,
+                      FileScanner::FastRandom,
+                      memoryMapedData)) {
+      return false;
+    }
 
-      if (!scanner.Read(coordPageSize)) {
-        Close();
+    if (!scanner.Read(marker)) {
+      scanner.Close();
 
-        return false;
-      }
+      return false;
+    }
 
-      if (!scanner.Read(mapOffset)) {
-        Close();
+    if (marker!=0) {
+      log.Error() << "File '" << scanner.GetFilename() << "' has an outdated format, please reimport";
+      scanner.Close();
 
-        return false;
-      }
+      return false;
+    }
 
-      if (!scanner.SetPos(mapOffset)) {
-        Close();
+    if (!scanner.Read(formatVersion)) {
+      scanner.Close();
 
-        return false;
-      }
+      return false;
+    }
 
-      uint32_t mapSize;
+    if (formatVersion!=fileFormatVersion) {
+      log.Error() << "File '" << scanner.GetFilename() << "' has unsupported format version " << formatVersion;
+      scanner.Close();
 
-      if (!scanner.Read(mapSize)) {
-        Close();
+      return false;
+    }
 
-        return false;
-      }
+    if (!scanner.Read(coordPageSize) ||
+        !scanner.Read(mapOffset) ||
+        !scanner.SetPos(mapOffset) ||
+        !scanner.Read(rangeCount)) {
+      scanner.Close();
 
-      for (size_t i=1; i<=mapSize; i++) {
-        PageId     id;
-        FileOffset offset;
+      return false;
+    }
 
-        if (!scanner.Read(id) ||
-            !scanner.Read(offset)) {
-          Close();
+    pageRanges.resize(rangeCount);
 
-          return false;
-        }
+    for (auto& range : pageRanges) {
+      if (!scanner.Read(range.firstPageId) ||
+          !scanner.Read(range.pageCount) ||
+          !scanner.Read(range.offset)) {
+        pageRanges.clear();
+        scanner.Close();
 
-        coordPageOffsetMap[id]=offset;
+        return false;
       }
+    }
 
-      isOpen=true;
+    if (!scanner.Close()) {
+      pageRanges.clear();
+
+      return false;
+    }
+
+    isOpen=scanners.Open(datafilename,
+                         FileScanner::FastRandom,
+                         memoryMapedData);
+
+    if (!isOpen) {
+      pageRanges.clear();
     }
 
     return isOpen;
@@ -104,10 +134,10 @@ namespace osmscout {
   {
     bool success=true;
 
-    coordPageOffsetMap.clear();
+    pageRanges.clear();
 
-    if (scanner.IsOpen()) {
-      if (!scanner.Close()) {
+    if (scanners.IsOpen()) {
+      if (!scanners.Close()) {
         success=false;
       }
     }
@@ -117,6 +147,12 @@ namespace osmscout {
     return success;
   }
 
+  bool CoordDataFile::IsPageBeforeRange(PageId pageId,
+                                        const PageRange& range)
+  {
+    return pageId<range.firstPageId;
+  }
+
   std::string CoordDataFile::GetFilename() const
   {
     return datafilename;
@@ -127,6 +163,13 @@ namespace osmscout {
   {
     assert(isOpen);
 
+    PooledFileScanner scanner(scanners);
+
+    if (!scanner.IsValid()) {
+      log.Error() << "Error while opening " << datafilename << " for reading!";
+      return false;
+    }
+
     coordsMap.clear();
     coordsMap.reserve(ids.size());
 
@@ -134,22 +177,30 @@ namespace osmscout {
       PageId relatedId=id-std::numeric_limits<Id>::min();
       PageId pageId=relatedId/coordPageSize;
 
-      CoordPageOffsetMap::const_iterator pageOffset=coordPageOffsetMap.find(pageId);
+      std::vector<PageRange>::const_iterator range=std::upper_bound(pageRanges.begin(),
+                                                                    pageRanges.end(),
+                                                                    pageId,
+                                                                    IsPageBeforeRange);
 
-      if (pageOffset!=coordPageOffsetMap.end()) {
-        FileOffset offset=pageOffset->second+(relatedId%coordPageSize)*coordByteSize;
+      if (range==pageRanges.begin()) {
+        continue;
+      }
+
+      --range;
+
+      if (pageId-range->firstPageId<range->pageCount) {
+        FileOffset offset=range->offset+
+                          ((pageId-range->firstPageId)*coordPageSize+relatedId%coordPageSize)*coordByteSize;
         // Number of entry in file (file starts with an empty page we skip)
         PageId     substituteId=(offset-coordPageSize*coordByteSize)/coordByteSize;
 
-        scanner.SetPos(offset);
-
         bool     isSet;
         GeoCoord coord;
 
-        if (!scanner.ReadConditionalCoord(coord,
-                                          isSet)) {
-          log.Error() << "Error while reading data from offset " << pageOffset->second << " of file '" << scanner.GetFilename() << "'!";
-          scanner.Close();
+        if (!scanner->SetPos(offset) ||
+            !scanner->ReadConditionalCoord(coord,
+                                           isSet)) {
+          log.Error() << "Error while reading data from offset " << offset << " of file '" << scanner->GetFilename() << "'!";
           return false;
         }
 
@@ -28,6 +28,7 @@
 #include <osmscout/system/Assert.h>
 #include <osmscout/system/Math.h>
 
+#include <osmscout/util/File.h>
 #include <osmscout/util/Geometry.h>
 #include <osmscout/util/Logger.h>
 
@@ -37,8 +38,11 @@ namespace osmscout {
   : areaAreaIndexCacheSize(1000),
     areaNodeIndexCacheSize(1000),
     nodeCacheSize(1000),
+    nodeCacheMemory(1024*1024),
     wayCacheSize(4000),
-    areaCacheSize(4000)
+    wayCacheMemory(16*1024*1024),
+    areaCacheSize(4000),
+    areaCacheMemory(16*1024*1024)
   {
     // no code
   }
@@ -58,16 +62,31 @@ namespace osmscout {
     this->nodeCacheSize=nodeCacheSize;
   }
 
+  void DatabaseParameter::SetNodeCacheMemory(size_t nodeCacheMemory)
+  {
+    this->nodeCacheMemory=nodeCacheMemory;
+  }
+
   void DatabaseParameter::SetWayCacheSize(unsigned long wayCacheSize)
   {
     this->wayCacheSize=wayCacheSize;
   }
 
+  void DatabaseParameter::SetWayCacheMemory(size_t wayCacheMemory)
+  {
+    this->wayCacheMemory=wayCacheMemory;
+  }
+
   void DatabaseParameter::SetAreaCacheSize(unsigned long areaCacheSize)
   {
     this->areaCacheSize=areaCacheSize;
   }
 
+  void DatabaseParameter::SetAreaCacheMemory(size_t areaCacheMemory)
+  {
+    this->areaCacheMemory=areaCacheMemory;
+  }
+
   unsigned long DatabaseParameter::GetAreaAreaIndexCacheSize() const
   {
     return areaAreaIndexCacheSize;
@@ -83,19 +102,36 @@ namespace osmscout {
     return nodeCacheSize;
   }
 
+  size_t DatabaseParameter::GetNodeCacheMemory() const
+  {
+    return nodeCacheMemory;
+  }
+
   unsigned long DatabaseParameter::GetWayCacheSize() const
   {
     return wayCacheSize;
   }
 
+  size_t DatabaseParameter::GetWayCacheMemory() const
+  {
+    return wayCacheMemory;
+  }
+
   unsigned long DatabaseParameter::GetAreaCacheSize() const
   {
     return areaCacheSize;
   }
 
+  size_t DatabaseParameter::GetAreaCacheMemory() const
+  {
+    return areaCacheMemory;
+  }
+
   Database::Database(const DatabaseParameter& parameter)
    : parameter(parameter),
-     isOpen(false)
+     isOpen(false),
+     searchIndexFailed(false),
+     reverseIndexFailed(false)
   {
     // no code
   }
@@ -152,6 +188,10 @@ namespace osmscout {
 
   void Database::Close()
   {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(mutex);
+#endif
+
     if (nodeDataFile &&
         nodeDataFile->IsOpen()) {
       nodeDataFile->Close();
@@ -195,11 +235,20 @@ namespace osmscout {
       optimizeAreasLowZoom=NULL;
     }
 
+    locationSearchIndex=NULL;
+    reverseLocationIndex=NULL;
+    searchIndexFailed=false;
+    reverseIndexFailed=false;
+
     isOpen=false;
   }
 
   void Database::FlushCache()
   {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(mutex);
+#endif
+
     if (nodeDataFile) {
       nodeDataFile->FlushCache();
     }
@@ -225,12 +274,17 @@ namespace osmscout {
 
   NodeDataFileRef Database::GetNodeDataFile() const
   {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(mutex);
+#endif
+
     if (!IsOpen()) {
       return NULL;
     }
 
     if (!nodeDataFile) {
-      nodeDataFile=std::make_shared<NodeDataFile>(parameter.GetNodeCacheSize());
+      nodeDataFile=std::make_shared<NodeDataFile>(parameter.GetNodeCacheSize(),
+                                                  parameter.GetNodeCacheMemory());
     }
 
     if (!nodeDataFile->IsOpen()) {
@@ -254,13 +308,18 @@ namespace osmscout {
 
   AreaDataFileRef Database::GetAreaDataFile() const
   {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(mutex);
+#endif
+
     if (!IsOpen()) {
       return NULL;
     }
 
     if (!areaDataFile) {
       areaDataFile=std::make_shared<AreaDataFile>("areas.dat",
-                                                  parameter.GetAreaCacheSize());
+                                                  parameter.GetAreaCacheSize(),
+                                                  parameter.GetAreaCacheMemory());
     }
 
     if (!areaDataFile->IsOpen()) {
@@ -284,13 +343,18 @@ namespace osmscout {
 
   WayDataFileRef Database::GetWayDataFile() const
   {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(mutex);
+#endif
+
     if (!IsOpen()) {
       return NULL;
     }
 
     if (!wayDataFile) {
       wayDataFile=std::make_shared<WayDataFile>("ways.dat",
-                                                parameter.GetWayCacheSize());
+                                                parameter.GetWayCacheSize(),
+                                                parameter.GetWayCacheMemory());
     }
 
     if (!wayDataFile->IsOpen()) {
@@ -314,6 +378,10 @@ namespace osmscout {
 
   AreaNodeIndexRef Database::GetAreaNodeIndex() const
   {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(mutex);
+#endif
+
     if (!IsOpen()) {
       return NULL;
     }
@@ -340,6 +408,10 @@ namespace osmscout {
 
   AreaAreaIndexRef Database::GetAreaAreaIndex() const
   {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(mutex);
+#endif
+
     if (!IsOpen()) {
       return NULL;
     }
@@ -366,6 +438,10 @@ namespace osmscout {
 
   AreaWayIndexRef Database::GetAreaWayIndex() const
   {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(mutex);
+#endif
+
     if (!IsOpen()) {
       return NULL;
     }
@@ -393,6 +469,10 @@ namespace osmscout {
 
   LocationIndexRef Database::GetLocationIndex() const
   {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(mutex);
+#endif
+
     if (!IsOpen()) {
       return NULL;
     }
@@ -417,8 +497,100 @@ namespace osmscout {
     return locationIndex;
   }
 
+  LocationSearchIndexRef Database::GetLocationSearchIndex() const
+  {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(mutex);
+#endif
+
+    if (!IsOpen() ||
+        searchIndexFailed) {
+      return NULL;
+    }
+
+    if (!locationSearchIndex) {
+      FileOffset fileSize;
+
+      // Databases imported before the index was introduced do not have it,
+      // remember that to not try (and log) it again on every call
+      if (!GetFileSize(AppendFileToDir(path,LocationSearchIndex::FILENAME_LOCATION_SEARCH_IDX),
+                       fileSize)) {
+        log.Warn() << "No location search index available, please reimport the database";
+        searchIndexFailed=true;
+
+        return NULL;
+      }
+
+      locationSearchIndex=std::make_shared<LocationSearchIndex>();
+
+      StopClock timer;
+
+      if (!locationSearchIndex->Load(path)) {
+        log.Error() << "Cannot load location search index!";
+        locationSearchIndex=NULL;
+        searchIndexFailed=true;
+
+        return NULL;
+      }
+
+      timer.Stop();
+
+      log.Debug() << "Opening LocationSearchIndex: " << timer.ResultString();
+    }
+
+    return locationSearchIndex;
+  }
+
+  ReverseLocationIndexRef Database::GetReverseLocationIndex() const
+  {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(mutex);
+#endif
+
+    if (!IsOpen() ||
+        reverseIndexFailed) {
+      return NULL;
+    }
+
+    if (!reverseLocationIndex) {
+      FileOffset fileSize;
+
+      // Databases imported before the index was introduced do not have it,
+      // remember that to not try (and log) it again on every call
+      if (!GetFileSize(AppendFileToDir(path,ReverseLocationIndex::FILENAME_REVERSE_LOCATION_IDX),
+                       fileSize)) {
+        log.Warn() << "No reverse location index available, please reimport the database";
+        reverseIndexFailed=true;
+
+        return NULL;
+      }
+
+      reverseLocationIndex=std::make_shared<ReverseLocationIndex>();
+
+      StopClock timer;
+
+      if (!reverseLocationIndex->Load(path)) {
+        log.Error() << "Cannot load reverse location index!";
+        reverseLocationIndex=NULL;
+        reverseIndexFailed=true;
+
+        return NULL;
+      }
+
+      timer.Stop();
+
+      log.Debug() << "Opening ReverseLocationIndex: " << timer.ResultString();
+    }
+
+    return reverseLocationIndex;
+  }
+
   WaterIndexRef Database::GetWaterIndex() const
   {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(mutex);
+#endif
+
     if (!IsOpen()) {
       return NULL;
     }
@@ -445,6 +617,10 @@ namespace osmscout {
 
   OptimizeAreasLowZoomRef Database::GetOptimizeAreasLowZoom() const
   {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(mutex);
+#endif
+
     if (!IsOpen()) {
       return NULL;
     }
@@ -473,6 +649,10 @@ namespace osmscout {
 
   OptimizeWaysLowZoomRef Database::GetOptimizeWaysLowZoom() const
   {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(mutex);
+#endif
+
     if (!optimizeWaysLowZoom) {
       optimizeWaysLowZoom=std::make_shared<OptimizeWaysLowZoom>();
 
@@ -727,6 +907,14 @@ namespace osmscout {
       locationIndex->DumpStatistics();
     }
 
+    if (locationSearchIndex) {
+      locationSearchIndex->DumpStatistics();
+    }
+
+    if (reverseLocationIndex) {
+      reverseLocationIndex->DumpStatistics();
+    }
+
     if (waterIndex) {
       waterIndex->DumpStatistics();
     }
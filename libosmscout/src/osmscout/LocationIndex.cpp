@@ -93,7 +93,15 @@ namespace osmscout {
       return false;
     }
 
-    return !scanner.HasError() && scanner.Close();
+    if (scanner.HasError() ||
+        !scanner.Close()) {
+      return false;
+    }
+
+    return scanners.Open(AppendFileToDir(path,
+                                         FILENAME_LOCATION_IDX),
+                         FileScanner::LowMemRandom,
+                         true);
   }
 
   bool LocationIndex::IsRegionIgnoreToken(const std::string& token) const
@@ -299,57 +307,69 @@ namespace osmscout {
 
     for (size_t i=0; i<locationCount; i++) {
       Location location;
-      uint32_t  objectCount;
 
-      if (!scanner.GetPos(location.locationOffset)) {
-        return false;
-      }
+      location.regionOffset=adminRegion.regionOffset;
 
-      if (!scanner.Read(location.name)) {
+      if (!LoadLocation(scanner,
+                        location)) {
         return false;
       }
 
-      location.regionOffset=adminRegion.regionOffset;
+      if (!visitor.Visit(adminRegion,
+                         location)) {
+        stopped=true;
 
-      if (!scanner.ReadNumber(objectCount)) {
-        return false;
+        return true;
       }
+    }
 
-      location.objects.reserve(objectCount);
-
-      bool hasAddresses;
+    return !scanner.HasError();
+  }
 
-      if (!scanner.Read(hasAddresses)) {
-        return false;
-      }
+  bool LocationIndex::LoadLocation(FileScanner& scanner,
+                                   Location& location) const
+  {
+    uint32_t objectCount;
+    bool     hasAddresses;
 
-      if (hasAddresses) {
-        if (!scanner.ReadFileOffset(location.addressesOffset)) {
-          return false;
-        }
-      }
-      else {
-        location.addressesOffset=0;
-      }
+    if (!scanner.GetPos(location.locationOffset)) {
+      return false;
+    }
 
-      objectFileRefReader.Reset();
+    if (!scanner.Read(location.name)) {
+      return false;
+    }
 
-      for (size_t j=0; j<objectCount; j++) {
-        ObjectFileRef ref;
+    if (!scanner.ReadNumber(objectCount)) {
+      return false;
+    }
 
-        if (!objectFileRefReader.Read(ref)) {
-          return false;
-        }
+    if (!scanner.Read(hasAddresses)) {
+      return false;
+    }
 
-        location.objects.push_back(ref);
+    if (hasAddresses) {
+      if (!scanner.ReadFileOffset(location.addressesOffset)) {
+        return false;
       }
+    }
+    else {
+      location.addressesOffset=0;
+    }
 
-      if (!visitor.Visit(adminRegion,
-                         location)) {
-        stopped=true;
+    ObjectFileRefStreamReader objectFileRefReader(scanner);
 
-        return true;
+    location.objects.clear();
+    location.objects.reserve(objectCount);
+
+    for (size_t i=0; i<objectCount; i++) {
+      ObjectFileRef ref;
+
+      if (!objectFileRefReader.Read(ref)) {
+        return false;
       }
+
+      location.objects.push_back(ref);
     }
 
     return !scanner.HasError();
@@ -583,16 +603,15 @@ namespace osmscout {
   bool LocationIndex::ResolveAdminRegionHierachie(const AdminRegionRef& adminRegion,
                                                   std::map<FileOffset,AdminRegionRef >& refs) const
   {
-    FileScanner scanner;
+    PooledFileScanner pooledScanner(scanners);
 
-    if (!scanner.Open(AppendFileToDir(path,
-                                      FILENAME_LOCATION_IDX),
-                      FileScanner::LowMemRandom,
-                      true)) {
-      log.Error() << "Cannot open file '" << scanner.GetFilename() << "'!";
+    if (!pooledScanner.IsValid()) {
+      log.Error() << "Cannot open file '" << scanners.GetFilename() << "'!";
       return false;
     }
 
+    FileScanner& scanner=*pooledScanner;
+
     if (!scanner.SetPos(indexOffset)) {
       return false;
     }
@@ -637,7 +656,68 @@ namespace osmscout {
                 newOffsets);
     }
 
-    return !scanner.HasError() && scanner.Close();
+    return !scanner.HasError();
+  }
+
+  /**
+   * Load the admin region stored at the given offset
+   */
+  bool LocationIndex::GetAdminRegionByOffset(FileOffset offset,
+                                             AdminRegionRef& region) const
+  {
+    PooledFileScanner pooledScanner(scanners);
+
+    if (!pooledScanner.IsValid()) {
+      log.Error() << "Cannot open file '" << scanners.GetFilename() << "'!";
+      return false;
+    }
+
+    FileScanner& scanner=*pooledScanner;
+
+    if (!scanner.SetPos(offset)) {
+      return false;
+    }
+
+    region=std::make_shared<AdminRegion>();
+
+    if (!LoadAdminRegion(scanner,
+                         *region)) {
+      return false;
+    }
+
+    return !scanner.HasError();
+  }
+
+  /**
+   * Load the location of the given admin region, stored at the given offset
+   */
+  bool LocationIndex::GetLocationByOffset(const AdminRegion& region,
+                                          FileOffset offset,
+                                          LocationRef& location) const
+  {
+    PooledFileScanner pooledScanner(scanners);
+
+    if (!pooledScanner.IsValid()) {
+      log.Error() << "Cannot open file '" << scanners.GetFilename() << "'!";
+      return false;
+    }
+
+    FileScanner& scanner=*pooledScanner;
+
+    if (!scanner.SetPos(offset)) {
+      return false;
+    }
+
+    location=std::make_shared<Location>();
+
+    location->regionOffset=region.regionOffset;
+
+    if (!LoadLocation(scanner,
+                      *location)) {
+      return false;
+    }
+
+    return !scanner.HasError();
   }
 
   void LocationIndex::DumpStatistics()
@@ -0,0 +1,475 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/LocationSearchIndex.h>
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/Logger.h>
+
+namespace osmscout {
+
+  const char* const LocationSearchIndex::FILENAME_LOCATION_SEARCH_IDX = "locationsearch.idx";
+
+  //! Size of an entry in the n-gram dictionary (n-gram and offset of the list of entries)
+  static const FileOffset DICTIONARY_ENTRY_SIZE=sizeof(uint32_t)+sizeof(FileOffset);
+
+  //! Size of an entry in the region table (region offset and range of location entries)
+  static const FileOffset REGION_ENTRY_SIZE=3*sizeof(FileOffset);
+
+  /**
+   * An n-gram list of entries, which is read completely only after
+   * the length of all lists has been checked
+   */
+  struct NGramList
+  {
+    uint32_t   count;
+    FileOffset offset;
+
+    inline bool operator<(const NGramList& other) const
+    {
+      return count<other.count;
+    }
+  };
+
+  LocationSearchIndex::LocationSearchIndex()
+  {
+    // no code
+  }
+
+  /**
+   * Converts the name to lower case. Besides ASCII characters, the upper
+   * case characters of the Latin-1 Supplement (U+00C0 to U+00DE) in UTF-8
+   * encoding are converted.
+   */
+  void LocationSearchIndex::NormalizeName(std::string& name)
+  {
+    for (std::string::iterator it=name.begin();
+         it!=name.end();
+         ++it)
+    {
+      /* this filter matches all character from the table
+       * http://en.wikipedia.org/wiki/Latin-1_Supplement_%28Unicode_block%29#Compact_table
+       * beginning at U+0x00C0 to U+0x00DE
+       */
+      if((uint8_t)*it == 0xC3)
+      {
+        ++it;
+
+        if (it==name.end()) {
+          break;
+        }
+
+        if((uint8_t)*it>=0x80 && (uint8_t)*it<=0x9E) {
+          // 0x9F is german "sz" which is already small caps.
+          *it+=0x20;
+        }
+      }
+      else {
+        *it=tolower(*it);
+      }
+    }
+  }
+
+  bool LocationSearchIndex::Load(const std::string& path)
+  {
+    FileScanner scanner;
+
+    datafilename=AppendFileToDir(path,
+                                 FILENAME_LOCATION_SEARCH_IDX);
+
+    if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
+      log.Error() << "Cannot open file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    if (!scanner.Read(bytesForLocationFileOffset) ||
+        !scanner.ReadFileOffset(regionTableOffset) ||
+        !scanner.Read(regionCount) ||
+        !scanner.ReadFileOffset(regionDictionaryOffset) ||
+        !scanner.Read(regionNGramCount) ||
+        !scanner.ReadFileOffset(locationDictionaryOffset) ||
+        !scanner.Read(locationNGramCount)) {
+      log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    if (!scanner.Close()) {
+      return false;
+    }
+
+    return scanners.Open(datafilename,FileScanner::LowMemRandom,true);
+  }
+
+  /**
+   * Returns the sorted offsets of all entries, that contain all n-grams of
+   * the given (normalized) pattern. The lists of the n-grams are intersected
+   * starting with the shortest list.
+   */
+  bool LocationSearchIndex::GetCandidates(FileScanner& scanner,
+                                          const std::string& pattern,
+                                          FileOffset dictionaryOffset,
+                                          uint32_t nGramCount,
+                                          std::vector<FileOffset>& candidates) const
+  {
+    std::vector<uint32_t>  nGrams;
+    std::vector<NGramList> lists;
+
+    candidates.clear();
+
+    for (size_t i=0; i+NGRAM_LENGTH<=pattern.length(); i++) {
+      nGrams.push_back(((uint32_t)(uint8_t)pattern[i] << 16) |
+                       ((uint32_t)(uint8_t)pattern[i+1] << 8) |
+                       (uint32_t)(uint8_t)pattern[i+2]);
+    }
+
+    std::sort(nGrams.begin(),
+              nGrams.end());
+    nGrams.erase(std::unique(nGrams.begin(),
+                             nGrams.end()),
+                 nGrams.end());
+
+    lists.reserve(nGrams.size());
+
+    for (const auto nGram : nGrams) {
+      uint32_t   left=0;
+      uint32_t   right=nGramCount;
+      bool       found=false;
+      NGramList  list;
+
+      while (left<right) {
+        uint32_t   middle=left+(right-left)/2;
+        uint32_t   currentNGram;
+        FileOffset listOffset;
+
+        if (!scanner.SetPos(dictionaryOffset+middle*DICTIONARY_ENTRY_SIZE) ||
+            !scanner.Read(currentNGram) ||
+            !scanner.ReadFileOffset(listOffset)) {
+          return false;
+        }
+
+        if (currentNGram==nGram) {
+          if (!scanner.SetPos(listOffset) ||
+              !scanner.ReadNumber(list.count) ||
+              !scanner.GetPos(list.offset)) {
+            return false;
+          }
+
+          found=true;
+          break;
+        }
+        else if (currentNGram<nGram) {
+          left=middle+1;
+        }
+        else {
+          right=middle;
+        }
+      }
+
+      if (!found) {
+        // At least one n-gram of the pattern is not part of any name
+        return true;
+      }
+
+      lists.push_back(list);
+    }
+
+    std::sort(lists.begin(),
+              lists.end());
+
+    std::vector<FileOffset> listEntries;
+    std::vector<FileOffset> intersection;
+
+    for (size_t l=0; l<lists.size(); l++) {
+      FileOffset entryOffset=0;
+
+      listEntries.clear();
+      listEntries.reserve(lists[l].count);
+
+      if (!scanner.SetPos(lists[l].offset)) {
+        return false;
+      }
+
+      for (size_t i=0; i<lists[l].count; i++) {
+        FileOffset delta;
+
+        if (!scanner.ReadNumber(delta)) {
+          return false;
+        }
+
+        entryOffset+=delta;
+        listEntries.push_back(entryOffset);
+      }
+
+      if (l==0) {
+        candidates.swap(listEntries);
+      }
+      else {
+        intersection.clear();
+
+        std::set_intersection(candidates.begin(),
+                              candidates.end(),
+                              listEntries.begin(),
+                              listEntries.end(),
+                              std::back_inserter(intersection));
+
+        candidates.swap(intersection);
+      }
+
+      if (candidates.empty()) {
+        break;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Returns the range of the location entries of the given admin region
+   * and all its sub regions.
+   */
+  bool LocationSearchIndex::GetRegionRange(FileScanner& scanner,
+                                           FileOffset regionOffset,
+                                           FileOffset& start,
+                                           FileOffset& end) const
+  {
+    uint32_t left=0;
+    uint32_t right=regionCount;
+
+    start=0;
+    end=0;
+
+    while (left<right) {
+      uint32_t   middle=left+(right-left)/2;
+      FileOffset currentRegionOffset;
+
+      if (!scanner.SetPos(regionTableOffset+middle*REGION_ENTRY_SIZE) ||
+          !scanner.ReadFileOffset(currentRegionOffset)) {
+        return false;
+      }
+
+      if (currentRegionOffset==regionOffset) {
+        return scanner.ReadFileOffset(start) &&
+               scanner.ReadFileOffset(end);
+      }
+      else if (currentRegionOffset<regionOffset) {
+        left=middle+1;
+      }
+      else {
+        right=middle;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Returns all admin regions, whose name or alias name contains the given
+   * pattern. The pattern must have at least NGRAM_LENGTH bytes. Entries are
+   * returned in the order of the region tree, the name of a region before
+   * its aliases.
+   */
+  bool LocationSearchIndex::SearchRegions(const std::string& pattern,
+                                          std::vector<RegionEntry>& entries) const
+  {
+    std::string             normalizedPattern(pattern);
+    std::vector<FileOffset> candidates;
+
+    entries.clear();
+
+    NormalizeName(normalizedPattern);
+
+    if (normalizedPattern.length()<NGRAM_LENGTH) {
+      log.Error() << "Pattern '" << pattern << "' is too short for the location search index";
+      return false;
+    }
+
+    PooledFileScanner pooledScanner(scanners);
+
+    if (!pooledScanner.IsValid()) {
+      log.Error() << "Error while opening " << datafilename << " for reading!";
+      return false;
+    }
+
+    FileScanner& scanner=*pooledScanner;
+
+    if (!GetCandidates(scanner,
+                       normalizedPattern,
+                       regionDictionaryOffset,
+                       regionNGramCount,
+                       candidates)) {
+      log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    std::string name;
+
+    for (const auto candidate : candidates) {
+      RegionEntry entry;
+
+      if (!scanner.SetPos(candidate) ||
+          !scanner.ReadFileOffset(entry.regionOffset,
+                                  bytesForLocationFileOffset) ||
+          !scanner.ReadNumber(entry.aliasIndex) ||
+          !scanner.Read(name)) {
+        log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+        return false;
+      }
+
+      if (name.find(normalizedPattern)==std::string::npos) {
+        continue;
+      }
+
+      entry.isMatch=name.length()==normalizedPattern.length();
+
+      entries.push_back(entry);
+    }
+
+    return !scanner.HasError();
+  }
+
+  /**
+   * Looks up the candidates for the given location pattern, which then can be
+   * used for searching in one or more admin regions using SearchRegionLocations().
+   * The pattern must have at least NGRAM_LENGTH bytes.
+   */
+  bool LocationSearchIndex::PrepareLocationQuery(const std::string& pattern,
+                                                 LocationQuery& query) const
+  {
+    query.pattern=pattern;
+    query.candidates.clear();
+
+    NormalizeName(query.pattern);
+
+    if (query.pattern.length()<NGRAM_LENGTH) {
+      log.Error() << "Pattern '" << pattern << "' is too short for the location search index";
+      return false;
+    }
+
+    PooledFileScanner pooledScanner(scanners);
+
+    if (!pooledScanner.IsValid()) {
+      log.Error() << "Error while opening " << datafilename << " for reading!";
+      return false;
+    }
+
+    if (!GetCandidates(*pooledScanner,
+                       query.pattern,
+                       locationDictionaryOffset,
+                       locationNGramCount,
+                       query.candidates)) {
+      log.Error() << "Error while reading from file '" << pooledScanner->GetFilename() << "'";
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Returns all locations and POIs of the given admin region and its
+   * sub regions, whose name contains the pattern of the query. For every
+   * region POIs are returned before locations, regions in the order of
+   * the region tree.
+   */
+  bool LocationSearchIndex::SearchRegionLocations(const LocationQuery& query,
+                                                  FileOffset regionOffset,
+                                                  std::vector<LocationEntry>& entries) const
+  {
+    entries.clear();
+
+    if (query.candidates.empty()) {
+      return true;
+    }
+
+    PooledFileScanner pooledScanner(scanners);
+
+    if (!pooledScanner.IsValid()) {
+      log.Error() << "Error while opening " << datafilename << " for reading!";
+      return false;
+    }
+
+    FileScanner& scanner=*pooledScanner;
+    FileOffset   start;
+    FileOffset   end;
+
+    if (!GetRegionRange(scanner,
+                        regionOffset,
+                        start,
+                        end)) {
+      log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    std::string name;
+
+    for (auto candidate=std::lower_bound(query.candidates.begin(),
+                                         query.candidates.end(),
+                                         start);
+         candidate!=query.candidates.end() && *candidate<end;
+         ++candidate) {
+      LocationEntry entry;
+
+      if (!scanner.SetPos(*candidate) ||
+          !scanner.ReadFileOffset(entry.regionOffset,
+                                  bytesForLocationFileOffset) ||
+          !scanner.Read(entry.isPOI)) {
+        log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+        return false;
+      }
+
+      if (entry.isPOI) {
+        entry.locationOffset=0;
+
+        if (!scanner.Read(entry.name) ||
+            !scanner.Read(entry.object)) {
+          log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+          return false;
+        }
+      }
+      else if (!scanner.ReadFileOffset(entry.locationOffset,
+                                       bytesForLocationFileOffset)) {
+        log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+        return false;
+      }
+
+      if (!scanner.Read(name)) {
+        log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+        return false;
+      }
+
+      if (name.find(query.pattern)==std::string::npos) {
+        continue;
+      }
+
+      entry.isMatch=name.length()==query.pattern.length();
+
+      entries.push_back(entry);
+    }
+
+    return !scanner.HasError();
+  }
+
+  void LocationSearchIndex::DumpStatistics()
+  {
+    log.Info() << "LocationSearchIndex: " << regionCount << " regions, " << regionNGramCount << " region n-grams, " << locationNGramCount << " location n-grams";
+  }
+}
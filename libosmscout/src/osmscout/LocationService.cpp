@@ -28,7 +28,7 @@ namespace osmscout {
   LocationService::VisitorMatcher::VisitorMatcher(const std::string& searchPattern)
   :pattern(searchPattern)
   {
-    TolowerUmlaut(pattern);
+    LocationSearchIndex::NormalizeName(pattern);
   }
 
   void LocationService::VisitorMatcher::Match(const std::string& name,
@@ -38,7 +38,7 @@ namespace osmscout {
     std::string            tmpname=name;
     std::string::size_type matchPosition;
 
-    TolowerUmlaut(tmpname);
+    LocationSearchIndex::NormalizeName(tmpname);
 
     matchPosition=tmpname.find(pattern);
 
@@ -46,31 +46,6 @@ namespace osmscout {
     candidate=matchPosition!=std::string::npos;
   }
 
-  void LocationService::VisitorMatcher::TolowerUmlaut(std::string& s) const
-  {
-    for (std::string::iterator it=s.begin();
-         it!=s.end();
-         ++it)
-    {
-      /* this filter matches all character from the table
-       * http://en.wikipedia.org/wiki/Latin-1_Supplement_%28Unicode_block%29#Compact_table
-       * beginning at U+0x00C0 to U+0x00DE
-       */
-      if((uint8_t)*it == 0xC3)
-      {
-        ++it;
-
-        if((uint8_t)*it>=0x80 && (uint8_t)*it<=0x9E) {
-          // 0x9F is german "sz" which is already small caps.
-          *it+=0x20;
-        }
-      }
-      else {
-        *it=tolower(*it);
-      }
-    }
-  }
-
   LocationService::AdminRegionMatchVisitor::AdminRegionMatchVisitor(const std::string& pattern,
                                                                     size_t limit)
   : VisitorMatcher(pattern),
@@ -455,8 +430,226 @@ namespace osmscout {
                                                       refs);
   }
 
+  /**
+   * Search for all admin regions, whose name or alias contains the given pattern.
+   * If the location search index is available and the pattern is long enough,
+   * the index is used, else all regions are visited. If the limit is reached,
+   * matches are returned in favour of candidates.
+   */
+  bool LocationService::SearchAdminRegions(const LocationSearchIndexRef& locationSearchIndex,
+                                           const std::string& pattern,
+                                           size_t limit,
+                                           std::list<AdminRegionMatchVisitor::AdminRegionResult>& results,
+                                           bool& limitReached) const
+  {
+    results.clear();
+    limitReached=false;
+
+    if (!locationSearchIndex ||
+        pattern.length()<LocationSearchIndex::NGRAM_LENGTH) {
+      AdminRegionMatchVisitor adminRegionVisitor(pattern,
+                                                 limit);
+
+      if (!VisitAdminRegions(adminRegionVisitor)) {
+        log.Error() << "Error during traversal of region tree";
+        return false;
+      }
+
+      results.swap(adminRegionVisitor.results);
+      limitReached=adminRegionVisitor.limitReached;
+
+      return true;
+    }
+
+    LocationIndexRef                              locationIndex=database->GetLocationIndex();
+    std::vector<LocationSearchIndex::RegionEntry> entries;
+
+    if (!locationIndex) {
+      return false;
+    }
+
+    if (!locationSearchIndex->SearchRegions(pattern,
+                                            entries)) {
+      log.Error() << "Error during search for regions in location search index";
+      return false;
+    }
+
+    std::list<AdminRegionMatchVisitor::AdminRegionResult> candidates;
+    size_t                                                current=0;
+
+    // The entries of a region are consecutive, its name before its aliases
+    while (current<entries.size()) {
+      size_t end=current;
+      bool   regionMatch=false;
+      bool   regionCandidate=false;
+      bool   atLeastOneAliasMatch=false;
+
+      while (end<entries.size() &&
+             entries[end].regionOffset==entries[current].regionOffset) {
+        if (entries[end].aliasIndex==0) {
+          regionMatch=entries[end].isMatch;
+          regionCandidate=true;
+        }
+
+        end++;
+      }
+
+      AdminRegionRef region;
+
+      if (!locationIndex->GetAdminRegionByOffset(entries[current].regionOffset,
+                                                 region)) {
+        return false;
+      }
+
+      // Same rules as in AdminRegionMatchVisitor
+      if (!regionMatch) {
+        for (size_t i=current; i<end; i++) {
+          if (entries[i].aliasIndex==0) {
+            continue;
+          }
+
+          if (entries[i].aliasIndex>region->aliases.size()) {
+            log.Error() << "Alias index of region '" << region->name << "' is out of range";
+            return false;
+          }
+
+          const AdminRegion::RegionAlias&            alias=region->aliases[entries[i].aliasIndex-1];
+          AdminRegionMatchVisitor::AdminRegionResult result;
+
+          result.adminRegion=std::make_shared<AdminRegion>(*region);
+          result.isMatch=entries[i].isMatch;
+
+          result.adminRegion->aliasName=alias.name;
+          result.adminRegion->aliasObject.Set(alias.objectOffset,refNode);
+
+          if (result.isMatch) {
+            results.push_back(result);
+            atLeastOneAliasMatch=true;
+          }
+          else {
+            candidates.push_back(result);
+          }
+        }
+      }
+
+      if (!atLeastOneAliasMatch &&
+          regionCandidate) {
+        AdminRegionMatchVisitor::AdminRegionResult result;
+
+        result.adminRegion=region;
+        result.isMatch=regionMatch;
+
+        if (result.isMatch) {
+          results.push_back(result);
+        }
+        else {
+          candidates.push_back(result);
+        }
+      }
+
+      current=end;
+    }
+
+    results.splice(results.end(),
+                   candidates);
+
+    if (results.size()>=limit) {
+      limitReached=true;
+      results.resize(limit);
+    }
+
+    return true;
+  }
+
+  /**
+   * Search for all locations and POIs in the given admin region and its sub
+   * regions, that contain the pattern of the given location query. If there are
+   * more than limit results, matches are returned in favour of candidates.
+   */
+  bool LocationService::SearchAdminRegionLocations(const LocationSearchIndex& locationSearchIndex,
+                                                   const LocationSearchIndex::LocationQuery& locationQuery,
+                                                   const AdminRegionRef& adminRegion,
+                                                   size_t limit,
+                                                   std::list<LocationMatchVisitor::POIResult>& poiResults,
+                                                   std::list<LocationMatchVisitor::LocationResult>& locationResults) const
+  {
+    LocationIndexRef                                locationIndex=database->GetLocationIndex();
+    std::vector<LocationSearchIndex::LocationEntry> entries;
+    std::map<FileOffset,AdminRegionRef>             regions;
+    size_t                                          count=0;
+
+    if (!locationIndex) {
+      return false;
+    }
+
+    if (!locationSearchIndex.SearchRegionLocations(locationQuery,
+                                                   adminRegion->regionOffset,
+                                                   entries)) {
+      return false;
+    }
+
+    // Locations in the region itself reference the region (and its alias) we were called with
+    regions[adminRegion->regionOffset]=adminRegion;
+
+    // First pass collects matches, second pass candidates
+    for (size_t pass=0; pass<2; pass++) {
+      bool isMatch=pass==0;
+
+      for (const auto& entry : entries) {
+        if (entry.isMatch!=isMatch) {
+          continue;
+        }
+
+        if (count>=limit) {
+          return true;
+        }
+
+        AdminRegionRef& region=regions[entry.regionOffset];
+
+        if (!region &&
+            !locationIndex->GetAdminRegionByOffset(entry.regionOffset,
+                                                   region)) {
+          return false;
+        }
+
+        if (entry.isPOI) {
+          LocationMatchVisitor::POIResult result;
+
+          result.adminRegion=region;
+          result.poi=std::make_shared<POI>();
+          result.poi->regionOffset=entry.regionOffset;
+          result.poi->name=entry.name;
+          result.poi->object=entry.object;
+          result.isMatch=entry.isMatch;
+
+          poiResults.push_back(result);
+        }
+        else {
+          LocationMatchVisitor::LocationResult result;
+
+          if (!locationIndex->GetLocationByOffset(*region,
+                                                  entry.locationOffset,
+                                                  result.location)) {
+            return false;
+          }
+
+          result.adminRegion=region;
+          result.isMatch=entry.isMatch;
+
+          locationResults.push_back(result);
+        }
+
+        count++;
+      }
+    }
+
+    return true;
+  }
+
   bool LocationService::HandleAdminRegion(const LocationSearch& search,
                                           const LocationSearch::Entry& searchEntry,
+                                          const LocationSearchIndexRef& locationSearchIndex,
+                                          const LocationSearchIndex::LocationQuery& locationQuery,
                                           const AdminRegionMatchVisitor::AdminRegionResult& adminRegionResult,
                                           LocationSearchResult& result) const
   {
@@ -483,26 +676,46 @@ namespace osmscout {
 
     //std::cout << "  Search for location '" << searchEntry.locationPattern << "'" << " in " << adminRegionResult.adminRegion->name << "/" << adminRegionResult.adminRegion->aliasName << std::endl;
 
-    LocationMatchVisitor visitor(adminRegionResult.adminRegion,
-                                 searchEntry.locationPattern,
-                                 search.limit>=result.results.size() ? search.limit-result.results.size() : 0);
+    std::list<LocationMatchVisitor::POIResult>      poiResults;
+    std::list<LocationMatchVisitor::LocationResult> locationResults;
+    size_t                                          limit=search.limit>=result.results.size() ? search.limit-result.results.size() : 0;
+
+    if (locationSearchIndex &&
+        searchEntry.locationPattern.length()>=LocationSearchIndex::NGRAM_LENGTH) {
+      if (!SearchAdminRegionLocations(*locationSearchIndex,
+                                      locationQuery,
+                                      adminRegionResult.adminRegion,
+                                      limit,
+                                      poiResults,
+                                      locationResults)) {
+        log.Error() << "Error during search for region locations in location search index";
+        return false;
+      }
+    }
+    else {
+      LocationMatchVisitor visitor(adminRegionResult.adminRegion,
+                                   searchEntry.locationPattern,
+                                   limit);
 
+      if (!VisitAdminRegionLocations(*adminRegionResult.adminRegion,
+                                     visitor)) {
+        log.Error() << "Error during traversal of region location list";
+        return false;
+      }
 
-    if (!VisitAdminRegionLocations(*adminRegionResult.adminRegion,
-                                   visitor)) {
-      log.Error() << "Error during traversal of region location list";
-      return false;
+      poiResults.swap(visitor.poiResults);
+      locationResults.swap(visitor.locationResults);
     }
 
-    if (visitor.poiResults.empty() &&
-        visitor.locationResults.empty()) {
+    if (poiResults.empty() &&
+        locationResults.empty()) {
       // If we search for a location within an area,
       // we do not return the found area as hit, if we
       // did not find the location in it.
       return true;
     }
 
-    for (const auto& poiResult : visitor.poiResults) {
+    for (const auto& poiResult : poiResults) {
       if (!HandleAdminRegionPOI(search,
                                 adminRegionResult,
                                 poiResult,
@@ -512,7 +725,7 @@ namespace osmscout {
       }
     }
 
-    for (const auto& locationResult : visitor.locationResults) {
+    for (const auto& locationResult : locationResults) {
       //std::cout << "  - '" << locationResult->location->name << "'" << std::endl;
       if (!HandleAdminRegionLocation(search,
                                      searchEntry,
@@ -843,6 +1056,8 @@ namespace osmscout {
   bool LocationService::SearchForLocations(const LocationSearch& search,
                                            LocationSearchResult& result) const
   {
+    LocationSearchIndexRef locationSearchIndex=database->GetLocationSearchIndex();
+
     result.limitReached=false;
     result.results.clear();
 
@@ -853,23 +1068,40 @@ namespace osmscout {
 
       //std::cout << "Search for region '" << searchEntry->adminRegionPattern << "'..." << std::endl;
 
-      AdminRegionMatchVisitor adminRegionVisitor(searchEntry.adminRegionPattern,
-                                                 search.limit);
+      std::list<AdminRegionMatchVisitor::AdminRegionResult> regionResults;
+      bool                                                  limitReached;
 
-      if (!VisitAdminRegions(adminRegionVisitor)) {
-        log.Error() << "Error during traversal of region tree";
+      if (!SearchAdminRegions(locationSearchIndex,
+                              searchEntry.adminRegionPattern,
+                              search.limit,
+                              regionResults,
+                              limitReached)) {
         return false;
       }
 
-      if (adminRegionVisitor.limitReached) {
+      if (limitReached) {
         result.limitReached=true;
       }
 
-      for (const auto& regionResult : adminRegionVisitor.results) {
+      // The candidates for the location pattern are the same for all regions
+      LocationSearchIndex::LocationQuery locationQuery;
+
+      if (locationSearchIndex &&
+          searchEntry.locationPattern.length()>=LocationSearchIndex::NGRAM_LENGTH &&
+          !regionResults.empty()) {
+        if (!locationSearchIndex->PrepareLocationQuery(searchEntry.locationPattern,
+                                                       locationQuery)) {
+          return false;
+        }
+      }
+
+      for (const auto& regionResult : regionResults) {
         // std::cout << "- '" << regionResult.adminRegion->name << "', '" << regionResult.adminRegion->aliasName << "'..." << std::endl;
 
         if (!HandleAdminRegion(search,
                                searchEntry,
+                               locationSearchIndex,
+                               locationQuery,
                                regionResult,
                                result)) {
           return false;
@@ -1254,4 +1486,150 @@ namespace osmscout {
     return ReverseLookupObjects(objects,
                                 result);
   }
+
+  static bool GetAdminRegion(const LocationIndex& locationIndex,
+                             FileOffset offset,
+                             std::map<FileOffset,AdminRegionRef>& adminRegions,
+                             AdminRegionRef& adminRegion)
+  {
+    std::map<FileOffset,AdminRegionRef>::const_iterator entry=adminRegions.find(offset);
+
+    if (entry!=adminRegions.end()) {
+      adminRegion=entry->second;
+
+      return true;
+    }
+
+    if (!locationIndex.GetAdminRegionByOffset(offset,
+                                              adminRegion)) {
+      return false;
+    }
+
+    adminRegions[offset]=adminRegion;
+
+    return true;
+  }
+
+  /**
+   * Lookup the admin region, location and address at the given coordinate
+   * using the reverse location index. In contrast to ReverseLookupObjects()
+   * this does not visit all admin regions.
+   * @param coord
+   *    The coordinate to lookup
+   * @param maxDistance
+   *    Maximum distance (in km) between the coordinate and the returned
+   *    location or address
+   * @param result
+   *    List of results, most specific entry first: The closest address, the
+   *    closest location (normally a street) and the innermost admin region
+   *    containing the coordinate. Every entry is only returned if found.
+   *    The object of an entry is the object representing the address, the
+   *    location or the admin region.
+   * @return
+   *    True, if there was no error
+   */
+  bool LocationService::ReverseLookupCoord(const GeoCoord& coord,
+                                           double maxDistance,
+                                           std::list<ReverseLookupResult>& result) const
+  {
+    result.clear();
+
+    LocationIndexRef        locationIndex=database->GetLocationIndex();
+    ReverseLocationIndexRef reverseLocationIndex=database->GetReverseLocationIndex();
+
+    if (!locationIndex ||
+        !reverseLocationIndex) {
+      return false;
+    }
+
+    std::map<FileOffset,AdminRegionRef> adminRegions;
+    ReverseLocationIndex::Entry         entry;
+    bool                                found;
+
+    if (!reverseLocationIndex->GetClosestAddress(coord,
+                                                 maxDistance,
+                                                 entry,
+                                                 found)) {
+      return false;
+    }
+
+    if (found) {
+      ReverseLookupResult address;
+
+      if (!GetAdminRegion(*locationIndex,
+                          entry.regionOffset,
+                          adminRegions,
+                          address.adminRegion)) {
+        return false;
+      }
+
+      if (!locationIndex->GetLocationByOffset(*address.adminRegion,
+                                              entry.locationOffset,
+                                              address.location)) {
+        return false;
+      }
+
+      address.object=entry.object;
+      address.address=std::make_shared<Address>();
+      address.address->addressOffset=entry.addressOffset;
+      address.address->locationOffset=entry.locationOffset;
+      address.address->regionOffset=entry.regionOffset;
+      address.address->name=entry.name;
+      address.address->object=entry.object;
+
+      result.push_back(address);
+    }
+
+    if (!reverseLocationIndex->GetClosestLocation(coord,
+                                                  maxDistance,
+                                                  entry,
+                                                  found)) {
+      return false;
+    }
+
+    if (found) {
+      ReverseLookupResult location;
+
+      if (!GetAdminRegion(*locationIndex,
+                          entry.regionOffset,
+                          adminRegions,
+                          location.adminRegion)) {
+        return false;
+      }
+
+      if (!locationIndex->GetLocationByOffset(*location.adminRegion,
+                                              entry.locationOffset,
+                                              location.location)) {
+        return false;
+      }
+
+      location.object=entry.object;
+
+      result.push_back(location);
+    }
+
+    std::list<FileOffset> regionOffsets;
+
+    if (!reverseLocationIndex->GetRegionOffsets(coord,
+                                                regionOffsets)) {
+      return false;
+    }
+
+    if (!regionOffsets.empty()) {
+      ReverseLookupResult region;
+
+      if (!GetAdminRegion(*locationIndex,
+                          regionOffsets.back(),
+                          adminRegions,
+                          region.adminRegion)) {
+        return false;
+      }
+
+      region.object=region.adminRegion->object;
+
+      result.push_back(region);
+    }
+
+    return true;
+  }
 }
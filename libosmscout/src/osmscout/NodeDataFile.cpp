@@ -21,9 +21,11 @@
 
 namespace osmscout {
 
-  NodeDataFile::NodeDataFile(unsigned long dataCacheSize)
+  NodeDataFile::NodeDataFile(unsigned long dataCacheSize,
+                             size_t dataCacheMemory)
   : DataFile<Node>("nodes.dat",
-                   dataCacheSize)
+                   dataCacheSize,
+                   dataCacheMemory)
   {
     // no code
   }
@@ -44,7 +44,7 @@ namespace osmscout
 
   OptimizeAreasLowZoom::~OptimizeAreasLowZoom()
   {
-    if (scanner.IsOpen()) {
+    if (scanners.IsOpen()) {
       Close();
     }
   }
@@ -82,11 +82,20 @@ namespace osmscout
     this->typeConfig=typeConfig;
     datafilename=AppendFileToDir(path,datafile);
 
-    if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
-      log.Error() << "Cannot open file '" << scanner.GetFilename() << "'!";
+    if (!scanners.Open(datafilename,FileScanner::LowMemRandom,true)) {
+      log.Error() << "Cannot open file '" << datafilename << "'!";
       return false;
     }
 
+    PooledFileScanner pooledScanner(scanners);
+
+    if (!pooledScanner.IsValid()) {
+      log.Error() << "Cannot open file '" << datafilename << "'!";
+      return false;
+    }
+
+    FileScanner& scanner=*pooledScanner;
+
     FileOffset indexOffset;
 
     if (!scanner.ReadFileOffset(indexOffset)) {
@@ -133,8 +142,8 @@ namespace osmscout
   {
     bool success=true;
 
-    if (scanner.IsOpen()) {
-      if (!scanner.Close()) {
+    if (scanners.IsOpen()) {
+      if (!scanners.Close()) {
         success=false;
       }
     }
@@ -147,7 +156,8 @@ namespace osmscout
     return magnification<=this->magnification;
   }
 
-  bool OptimizeAreasLowZoom::GetOffsets(const TypeData& typeData,
+  bool OptimizeAreasLowZoom::GetOffsets(FileScanner& scanner,
+                                        const TypeData& typeData,
                                         double minlon,
                                         double minlat,
                                         double maxlon,
@@ -272,13 +282,15 @@ namespace osmscout
   {
     std::vector<FileOffset> offsets;
 
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
-        log.Error() << "Error while opening file '" << scanner.GetFilename() << "' for reading!";
-        return false;
-      }
+    PooledFileScanner pooledScanner(scanners);
+
+    if (!pooledScanner.IsValid()) {
+      log.Error() << "Error while opening file '" << datafilename << "' for reading!";
+      return false;
     }
 
+    FileScanner& scanner=*pooledScanner;
+
     offsets.reserve(20000);
 
     for (std::map<TypeId,std::list<TypeData> >::const_iterator type=areaTypesData.begin();
@@ -297,7 +309,8 @@ namespace osmscout
 
         if (match!=type->second.end()) {
           if (match->bitmapOffset!=0) {
-            if (!GetOffsets(*match,
+            if (!GetOffsets(scanner,
+                            *match,
                             lonMin,
                             latMin,
                             lonMax,
@@ -42,7 +42,7 @@ namespace osmscout
 
   OptimizeWaysLowZoom::~OptimizeWaysLowZoom()
   {
-    if (scanner.IsOpen()) {
+    if (scanners.IsOpen()) {
       Close();
     }
   }
@@ -80,11 +80,20 @@ namespace osmscout
     this->typeConfig=typeConfig;
     datafilename=AppendFileToDir(path,datafile);
 
-    if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
-      log.Error() << "Cannot open file '" << scanner.GetFilename() << "'!";
+    if (!scanners.Open(datafilename,FileScanner::LowMemRandom,true)) {
+      log.Error() << "Cannot open file '" << datafilename << "'!";
       return false;
     }
 
+    PooledFileScanner pooledScanner(scanners);
+
+    if (!pooledScanner.IsValid()) {
+      log.Error() << "Cannot open file '" << datafilename << "'!";
+      return false;
+    }
+
+    FileScanner& scanner=*pooledScanner;
+
     FileOffset indexOffset;
 
     if (!scanner.ReadFileOffset(indexOffset)) {
@@ -131,8 +140,8 @@ namespace osmscout
   {
     bool success=true;
 
-    if (scanner.IsOpen()) {
-      if (!scanner.Close()) {
+    if (scanners.IsOpen()) {
+      if (!scanners.Close()) {
         success=false;
       }
     }
@@ -145,7 +154,8 @@ namespace osmscout
     return magnification<=this->magnification;
   }
 
-  bool OptimizeWaysLowZoom::GetOffsets(const TypeData& typeData,
+  bool OptimizeWaysLowZoom::GetOffsets(FileScanner& scanner,
+                                       const TypeData& typeData,
                                        double minlon,
                                        double minlat,
                                        double maxlon,
@@ -270,13 +280,15 @@ namespace osmscout
   {
     std::vector<FileOffset> offsets;
 
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
-        log.Error() << "Error while opening file '" << scanner.GetFilename() << "' for reading!";
-        return false;
-      }
+    PooledFileScanner pooledScanner(scanners);
+
+    if (!pooledScanner.IsValid()) {
+      log.Error() << "Error while opening file '" << datafilename << "' for reading!";
+      return false;
     }
 
+    FileScanner& scanner=*pooledScanner;
+
     offsets.reserve(20000);
 
     for (size_t i=0; i<wayTypes.size(); i++) {
@@ -296,7 +308,8 @@ namespace osmscout
 
           if (match!=type->second.end()) {
             if (match->bitmapOffset!=0) {
-              if (!GetOffsets(*match,
+              if (!GetOffsets(scanner,
+                              *match,
                               lonMin,
                               latMin,
                               lonMax,
@@ -0,0 +1,581 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/ReverseLocationIndex.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <osmscout/system/Math.h>
+
+#include <osmscout/util/File.h>
+#include <osmscout/util/Geometry.h>
+#include <osmscout/util/Logger.h>
+
+namespace osmscout {
+
+  const char* const ReverseLocationIndex::FILENAME_REVERSE_LOCATION_IDX = "reverselocation.idx";
+
+  /**
+   * Returns the side of the line from a to b the point c is on (>0 for left,
+   * <0 for right, 0 for on the line).
+   */
+  static inline double GetSide(const GeoCoord& a,
+                               const GeoCoord& b,
+                               const GeoCoord& c)
+  {
+    return (b.GetLon()-a.GetLon())*(c.GetLat()-a.GetLat())-
+           (b.GetLat()-a.GetLat())*(c.GetLon()-a.GetLon());
+  }
+
+  /**
+   * Returns true, if the edge from edgeStart to edgeEnd crosses the segment
+   * from start to end. Edge nodes on the line of the segment are counted as
+   * being on the right side, so that a boundary touching the segment in one of
+   * its nodes is either counted twice or not at all.
+   */
+  static bool EdgeCrossesSegment(const GeoCoord& start,
+                                 const GeoCoord& end,
+                                 const GeoCoord& edgeStart,
+                                 const GeoCoord& edgeEnd)
+  {
+    if ((GetSide(start,end,edgeStart)>0.0)==(GetSide(start,end,edgeEnd)>0.0)) {
+      return false;
+    }
+
+    return (GetSide(edgeStart,edgeEnd,start)>0.0)!=(GetSide(edgeStart,edgeEnd,end)>0.0);
+  }
+
+  /**
+   * Returns the square of the distance of coord to the segment from a to b
+   * and the closest point on the segment. Longitude differences are scaled by
+   * the given cosine of the latitude, so that distances are roughly
+   * proportional to the real distance in the vicinity of coord.
+   */
+  static double GetDistanceSquareToSegment(const GeoCoord& coord,
+                                           double lonFactor,
+                                           const GeoCoord& a,
+                                           const GeoCoord& b,
+                                           GeoCoord& closest)
+  {
+    double xDelta=(b.GetLon()-a.GetLon())*lonFactor;
+    double yDelta=b.GetLat()-a.GetLat();
+    double u=0.0;
+
+    if (xDelta!=0.0 || yDelta!=0.0) {
+      u=((coord.GetLon()-a.GetLon())*lonFactor*xDelta+(coord.GetLat()-a.GetLat())*yDelta)/
+        (xDelta*xDelta+yDelta*yDelta);
+    }
+
+    if (u<=0.0) {
+      closest=a;
+    }
+    else if (u>=1.0) {
+      closest=b;
+    }
+    else {
+      closest.Set(a.GetLat()+u*(b.GetLat()-a.GetLat()),
+                  a.GetLon()+u*(b.GetLon()-a.GetLon()));
+    }
+
+    double dx=(closest.GetLon()-coord.GetLon())*lonFactor;
+    double dy=closest.GetLat()-coord.GetLat();
+
+    return dx*dx+dy*dy;
+  }
+
+  ReverseLocationIndex::ReverseLocationIndex()
+  {
+    // no code
+  }
+
+  bool ReverseLocationIndex::Load(const std::string& path)
+  {
+    FileScanner scanner;
+
+    datafilename=AppendFileToDir(path,
+                                 FILENAME_REVERSE_LOCATION_IDX);
+
+    if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
+      log.Error() << "Cannot open file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    if (!scanner.Read(bytesForLocationFileOffset) ||
+        !scanner.ReadNumber(cellLevel) ||
+        !scanner.ReadNumber(cellYStart) ||
+        !scanner.ReadNumber(cellYEnd) ||
+        !scanner.ReadFileOffset(rowTableOffset)) {
+      log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    cellWidth=360.0/pow(2.0,cellLevel);
+    cellHeight=180.0/pow(2.0,cellLevel);
+
+    if (!scanner.Close()) {
+      return false;
+    }
+
+    return scanners.Open(datafilename,FileScanner::LowMemRandom,true);
+  }
+
+  /**
+   * Returns the offset of the data of the given cell, or 0 if there is no data
+   * for the cell. The run of the row containing the cell is found by a binary
+   * search over the start of the runs.
+   */
+  bool ReverseLocationIndex::GetCellOffset(FileScanner& scanner,
+                                           uint32_t x,
+                                           uint32_t y,
+                                           FileOffset& offset) const
+  {
+    // Size of a run: start of the run and offset of its data
+    const FileOffset runSize=sizeof(uint32_t)+sizeof(FileOffset);
+
+    FileOffset rowOffset;
+    uint32_t   runCount;
+
+    offset=0;
+
+    if (y<cellYStart ||
+        y>cellYEnd) {
+      return true;
+    }
+
+    if (!scanner.SetPos(rowTableOffset+(FileOffset)(y-cellYStart)*sizeof(FileOffset)) ||
+        !scanner.ReadFileOffset(rowOffset)) {
+      return false;
+    }
+
+    if (rowOffset==0) {
+      return true;
+    }
+
+    if (!scanner.SetPos(rowOffset) ||
+        !scanner.Read(runCount)) {
+      return false;
+    }
+
+    // Find the last run starting at or before x
+    uint32_t lower=0;
+    uint32_t upper=runCount;
+
+    while (lower<upper) {
+      uint32_t middle=lower+(upper-lower)/2;
+      uint32_t xStart;
+
+      if (!scanner.SetPos(rowOffset+sizeof(uint32_t)+middle*runSize) ||
+          !scanner.Read(xStart)) {
+        return false;
+      }
+
+      if (xStart<=x) {
+        lower=middle+1;
+      }
+      else {
+        upper=middle;
+      }
+    }
+
+    if (lower==0) {
+      return true;
+    }
+
+    if (!scanner.SetPos(rowOffset+sizeof(uint32_t)+(lower-1)*runSize+sizeof(uint32_t))) {
+      return false;
+    }
+
+    return scanner.ReadFileOffset(offset);
+  }
+
+  /**
+   * Returns the offset of the addresses or of the locations of the given sub
+   * cell, or 0 if there is no such data for the sub cell.
+   */
+  bool ReverseLocationIndex::GetSubCellOffset(FileScanner& scanner,
+                                              uint32_t subX,
+                                              uint32_t subY,
+                                              bool addresses,
+                                              FileOffset& offset) const
+  {
+    FileOffset cellOffset;
+    bool       hasSubCells;
+
+    if (!GetCellOffset(scanner,
+                       subX/SUB_CELL_DIMENSION,
+                       subY/SUB_CELL_DIMENSION,
+                       cellOffset)) {
+      return false;
+    }
+
+    if (cellOffset==0) {
+      offset=0;
+
+      return true;
+    }
+
+    if (!scanner.SetPos(cellOffset) ||
+        !scanner.Read(hasSubCells)) {
+      return false;
+    }
+
+    if (!hasSubCells) {
+      offset=0;
+
+      return true;
+    }
+
+    FileOffset subCellId=(subY%SUB_CELL_DIMENSION)*SUB_CELL_DIMENSION+subX%SUB_CELL_DIMENSION;
+
+    if (!addresses) {
+      subCellId+=SUB_CELL_DIMENSION*SUB_CELL_DIMENSION;
+    }
+
+    if (!scanner.SetPos(cellOffset+1+subCellId*sizeof(FileOffset))) {
+      return false;
+    }
+
+    return scanner.ReadFileOffset(offset);
+  }
+
+  /**
+   * Returns the offsets of all admin regions (in the location index), that
+   * contain the given coordinate. Parent regions are returned before their
+   * child regions, so the last entry is the most specific region.
+   */
+  bool ReverseLocationIndex::GetRegionOffsets(const GeoCoord& coord,
+                                              std::list<FileOffset>& regionOffsets) const
+  {
+    regionOffsets.clear();
+
+    if (coord.GetLon()<-180.0 || coord.GetLon()>180.0 ||
+        coord.GetLat()<-90.0 || coord.GetLat()>90.0) {
+      return true;
+    }
+
+    uint32_t cellX=(uint32_t)floor((coord.GetLon()+180.0)/cellWidth);
+    uint32_t cellY=(uint32_t)floor((coord.GetLat()+90.0)/cellHeight);
+
+    PooledFileScanner pooledScanner(scanners);
+
+    if (!pooledScanner.IsValid()) {
+      log.Error() << "Error while opening " << datafilename << " for reading!";
+      return false;
+    }
+
+    FileScanner& scanner=*pooledScanner;
+    FileOffset   cellOffset;
+
+    if (!GetCellOffset(scanner,
+                       cellX,
+                       cellY,
+                       cellOffset)) {
+      log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    if (cellOffset==0) {
+      return true;
+    }
+
+    bool hasSubCells;
+
+    if (!scanner.SetPos(cellOffset) ||
+        !scanner.Read(hasSubCells)) {
+      log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    if (hasSubCells) {
+      if (!scanner.SetPos(cellOffset+1+2*SUB_CELL_DIMENSION*SUB_CELL_DIMENSION*sizeof(FileOffset))) {
+        return false;
+      }
+    }
+
+    // All boundary parts stored for a cell are tested against the
+    // segment from the center of the cell to the coordinate. Since both
+    // are within the cell, every boundary edge crossing the segment is
+    // part of the cell.
+    GeoCoord              center((cellY+0.5)*cellHeight-90.0,
+                                 (cellX+0.5)*cellWidth-180.0);
+    uint32_t              regionCount;
+    std::vector<GeoCoord> nodes;
+
+    if (!scanner.ReadNumber(regionCount)) {
+      log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+      return false;
+    }
+
+    for (size_t r=0; r<regionCount; r++) {
+      FileOffset regionOffset;
+      uint32_t   partCount;
+
+      if (!scanner.ReadFileOffset(regionOffset,
+                                  bytesForLocationFileOffset) ||
+          !scanner.ReadNumber(partCount)) {
+        log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+        return false;
+      }
+
+      bool inside=partCount==0;
+
+      for (size_t p=0; p<partCount; p++) {
+        bool     centerInside;
+        uint32_t runCount;
+        size_t   crossings=0;
+
+        if (!scanner.Read(centerInside) ||
+            !scanner.ReadNumber(runCount)) {
+          log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+          return false;
+        }
+
+        for (size_t run=0; run<runCount; run++) {
+          if (!scanner.Read(nodes)) {
+            log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+            return false;
+          }
+
+          for (size_t n=1; n<nodes.size(); n++) {
+            if (EdgeCrossesSegment(center,
+                                   coord,
+                                   nodes[n-1],
+                                   nodes[n])) {
+              crossings++;
+            }
+          }
+        }
+
+        if (centerInside!=(crossings%2==1)) {
+          inside=true;
+        }
+      }
+
+      if (inside) {
+        regionOffsets.push_back(regionOffset);
+      }
+    }
+
+    return !scanner.HasError();
+  }
+
+  bool ReverseLocationIndex::GetClosestEntry(const GeoCoord& coord,
+                                             double maxDistance,
+                                             bool addresses,
+                                             Entry& entry,
+                                             bool& found) const
+  {
+    found=false;
+
+    if (coord.GetLon()<-180.0 || coord.GetLon()>180.0 ||
+        coord.GetLat()<-90.0 || coord.GetLat()>90.0) {
+      return true;
+    }
+
+    // One degree of latitude is at least 110km, one degree of longitude
+    // at most 111.4km times the cosine of the latitude
+    double   lonFactor=std::max(cos(coord.GetLat()*M_PI/180.0),0.01);
+    double   latDelta=maxDistance/110.0;
+    double   lonDelta=maxDistance/(111.0*lonFactor);
+    double   subCellWidth=cellWidth/SUB_CELL_DIMENSION;
+    double   subCellHeight=cellHeight/SUB_CELL_DIMENSION;
+    uint32_t subCellCount=(uint32_t)pow(2.0,cellLevel)*SUB_CELL_DIMENSION;
+
+    uint32_t subXStart=(uint32_t)floor(std::max(coord.GetLon()-lonDelta+180.0,0.0)/subCellWidth);
+    uint32_t subXEnd=(uint32_t)floor(std::min(coord.GetLon()+lonDelta+180.0,360.0)/subCellWidth);
+    uint32_t subYStart=(uint32_t)floor(std::max(coord.GetLat()-latDelta+90.0,0.0)/subCellHeight);
+    uint32_t subYEnd=(uint32_t)floor(std::min(coord.GetLat()+latDelta+90.0,180.0)/subCellHeight);
+
+    subXEnd=std::min(subXEnd,subCellCount-1);
+    subYEnd=std::min(subYEnd,subCellCount-1);
+
+    PooledFileScanner pooledScanner(scanners);
+
+    if (!pooledScanner.IsValid()) {
+      log.Error() << "Error while opening " << datafilename << " for reading!";
+      return false;
+    }
+
+    FileScanner&          scanner=*pooledScanner;
+    double                bestDistance=0.0;
+    GeoCoord              bestCoord(0.0,0.0);
+    std::vector<GeoCoord> nodes;
+
+    for (uint32_t subY=subYStart; subY<=subYEnd; subY++) {
+      for (uint32_t subX=subXStart; subX<=subXEnd; subX++) {
+        FileOffset subCellOffset;
+        uint32_t   entryCount;
+
+        if (!GetSubCellOffset(scanner,
+                              subX,
+                              subY,
+                              addresses,
+                              subCellOffset)) {
+          log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+          return false;
+        }
+
+        if (subCellOffset==0) {
+          continue;
+        }
+
+        if (!scanner.SetPos(subCellOffset) ||
+            !scanner.ReadNumber(entryCount)) {
+          log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+          return false;
+        }
+
+        for (size_t e=0; e<entryCount; e++) {
+          FileOffset    regionOffset;
+          FileOffset    locationOffset;
+          FileOffset    addressOffset=0;
+          std::string   name;
+          ObjectFileRef object;
+          GeoCoord      closest;
+          double        distance;
+          bool          closer=false;
+
+          if (addresses) {
+            GeoCoord addressCoord;
+
+            if (!scanner.ReadCoord(addressCoord) ||
+                !scanner.ReadFileOffset(regionOffset,
+                                        bytesForLocationFileOffset) ||
+                !scanner.ReadFileOffset(locationOffset,
+                                        bytesForLocationFileOffset) ||
+                !scanner.ReadFileOffset(addressOffset,
+                                        bytesForLocationFileOffset) ||
+                !scanner.Read(name) ||
+                !scanner.Read(object)) {
+              log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+              return false;
+            }
+
+            distance=GetDistanceSquareToSegment(coord,
+                                                lonFactor,
+                                                addressCoord,
+                                                addressCoord,
+                                                closest);
+
+            if (!found || distance<bestDistance) {
+              bestDistance=distance;
+              bestCoord=closest;
+              closer=true;
+            }
+          }
+          else {
+            uint32_t runCount;
+
+            if (!scanner.ReadFileOffset(regionOffset,
+                                        bytesForLocationFileOffset) ||
+                !scanner.ReadFileOffset(locationOffset,
+                                        bytesForLocationFileOffset) ||
+                !scanner.Read(object) ||
+                !scanner.ReadNumber(runCount)) {
+              log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+              return false;
+            }
+
+            for (size_t run=0; run<runCount; run++) {
+              if (!scanner.Read(nodes)) {
+                log.Error() << "Error while reading from file '" << scanner.GetFilename() << "'";
+                return false;
+              }
+
+              for (size_t n=1; n<nodes.size(); n++) {
+                distance=GetDistanceSquareToSegment(coord,
+                                                    lonFactor,
+                                                    nodes[n-1],
+                                                    nodes[n],
+                                                    closest);
+
+                if ((!found && !closer) || distance<bestDistance) {
+                  bestDistance=distance;
+                  bestCoord=closest;
+                  closer=true;
+                }
+              }
+            }
+          }
+
+          if (closer) {
+            entry.regionOffset=regionOffset;
+            entry.locationOffset=locationOffset;
+            entry.addressOffset=addressOffset;
+            entry.name=name;
+            entry.object=object;
+
+            found=true;
+          }
+        }
+      }
+    }
+
+    if (found) {
+      entry.distance=GetEllipsoidalDistance(coord.GetLon(),
+                                            coord.GetLat(),
+                                            bestCoord.GetLon(),
+                                            bestCoord.GetLat());
+
+      found=entry.distance<=maxDistance;
+    }
+
+    return !scanner.HasError();
+  }
+
+  /**
+   * Returns the address closest to the given coordinate, if its distance
+   * is not larger than maxDistance (in km). The number of cells read grows
+   * with maxDistance, so it should be chosen as small as possible.
+   */
+  bool ReverseLocationIndex::GetClosestAddress(const GeoCoord& coord,
+                                               double maxDistance,
+                                               Entry& address,
+                                               bool& found) const
+  {
+    return GetClosestEntry(coord,
+                           maxDistance,
+                           true,
+                           address,
+                           found);
+  }
+
+  /**
+   * Returns the location (normally a street) closest to the given coordinate,
+   * if its distance is not larger than maxDistance (in km). The number of cells
+   * read grows with maxDistance, so it should be chosen as small as possible.
+   */
+  bool ReverseLocationIndex::GetClosestLocation(const GeoCoord& coord,
+                                                double maxDistance,
+                                                Entry& location,
+                                                bool& found) const
+  {
+    return GetClosestEntry(coord,
+                           maxDistance,
+                           false,
+                           location,
+                           found);
+  }
+
+  void ReverseLocationIndex::DumpStatistics()
+  {
+    log.Info() << "ReverseLocationIndex: Level " << cellLevel << ", rows " << cellYStart << "-" << cellYEnd;
+  }
+}
@@ -32,6 +32,35 @@ namespace osmscout {
     // no code
   }
 
+  /**
+   * Returns the type of open list the router should use for this profile.
+   * The default implementation returns openListSet.
+   */
+  OpenListType RoutingProfile::GetOpenListType() const
+  {
+    return openListSet;
+  }
+
+  /**
+   * Returns true, if the router should search from the start and the target
+   * at the same time. The default implementation returns false.
+   */
+  bool RoutingProfile::IsBidirectional() const
+  {
+    return false;
+  }
+
+  /**
+   * Returns true, if the router should use the precalculated contraction
+   * hierarchy (if available). The default implementation returns false.
+   */
+  bool RoutingProfile::UseContractionHierarchy() const
+  {
+    return false;
+  }
+
+  const double AbstractRoutingProfile::defaultCarMaxSpeed=160.0;
+
   AbstractRoutingProfile::AbstractRoutingProfile(const TypeConfigRef& typeConfig)
    : typeConfig(typeConfig),
      accessReader(*typeConfig),
@@ -40,7 +69,10 @@ namespace osmscout {
      vehicleRouteNodeBit(RouteNode::usableByCar),
      minSpeed(0),
      maxSpeed(0),
-     vehicleMaxSpeed(std::numeric_limits<double>::max())
+     vehicleMaxSpeed(std::numeric_limits<double>::max()),
+     openListType(openListSet),
+     bidirectional(false),
+     contractionHierarchy(false)
   {
     // no code
   }
@@ -67,6 +99,91 @@ namespace osmscout {
     vehicleMaxSpeed=maxSpeed;
   }
 
+  /**
+   * Set the type of open list the router uses for this profile. openListHeap
+   * avoids the allocation of individual route nodes and the node based
+   * std::set and is thus faster for long routes.
+   */
+  void AbstractRoutingProfile::SetOpenListType(OpenListType openListType)
+  {
+    this->openListType=openListType;
+  }
+
+  OpenListType AbstractRoutingProfile::GetOpenListType() const
+  {
+    return openListType;
+  }
+
+  /**
+   * Enable or disable bidirectional search. A bidirectional search expands
+   * from the start and (over the reversed paths) from the target at the same
+   * time and thus visits far less route nodes for long routes. It always uses
+   * the heap based open list and requires a routing graph that also holds
+   * paths against the direction of oneways (see
+   * ImportParameter::SetRouteReversePaths()). For other routing graphs the
+   * router falls back to the forward search.
+   */
+  void AbstractRoutingProfile::SetBidirectional(bool bidirectional)
+  {
+    this->bidirectional=bidirectional;
+  }
+
+  bool AbstractRoutingProfile::IsBidirectional() const
+  {
+    return bidirectional;
+  }
+
+  /**
+   * Enable or disable the use of the contraction hierarchy generated during
+   * import (see ImportParameter::SetRouteContractionHierarchy()). The
+   * contraction hierarchy is only available for cars and is calculated using
+   * the fastest path metric with the default car speed table of the import.
+   * It is only used, if the profile has exactly the same metric (see
+   * RoutingService::CanUseContractionHierarchy()). If no matching contraction
+   * hierarchy is available or no route could be found using it, the router
+   * falls back to the normal search.
+   */
+  void AbstractRoutingProfile::SetUseContractionHierarchy(bool contractionHierarchy)
+  {
+    this->contractionHierarchy=contractionHierarchy;
+  }
+
+  bool AbstractRoutingProfile::UseContractionHierarchy() const
+  {
+    return contractionHierarchy;
+  }
+
+  /**
+   * Fills the given map with the default speeds (in km/h) of the routable car
+   * types of the standard type configuration, to be passed to ParametrizeForCar().
+   * The import uses the same table (together with defaultCarMaxSpeed) for
+   * building the contraction hierarchy, so a profile parametrized this way can use it.
+   */
+  void AbstractRoutingProfile::GetDefaultCarSpeedTable(std::map<std::string,double>& speedMap)
+  {
+    speedMap.clear();
+
+    speedMap["highway_motorway"]=110.0;
+    speedMap["highway_motorway_trunk"]=100.0;
+    speedMap["highway_motorway_primary"]=70.0;
+    speedMap["highway_motorway_link"]=60.0;
+    speedMap["highway_motorway_junction"]=60.0;
+    speedMap["highway_trunk"]=100.0;
+    speedMap["highway_trunk_link"]=60.0;
+    speedMap["highway_primary"]=70.0;
+    speedMap["highway_primary_link"]=60.0;
+    speedMap["highway_secondary"]=60.0;
+    speedMap["highway_secondary_link"]=50.0;
+    speedMap["highway_tertiary_link"]=55.0;
+    speedMap["highway_tertiary"]=55.0;
+    speedMap["highway_unclassified"]=50.0;
+    speedMap["highway_road"]=50.0;
+    speedMap["highway_residential"]=40.0;
+    speedMap["highway_roundabout"]=40.0;
+    speedMap["highway_living_street"]=10.0;
+    speedMap["highway_service"]=30.0;
+  }
+
   void AbstractRoutingProfile::ParametrizeForFoot(const TypeConfig& typeConfig,
                                                   double maxSpeed)
   {
@@ -20,12 +20,20 @@
 #include <osmscout/RoutingService.h>
 
 #include <algorithm>
+#include <limits>
+
+#if defined(OSMSCOUT_HAVE_THREAD)
+#include <thread>
+#endif
 
 #include <osmscout/RoutingProfile.h>
 
 #include <osmscout/system/Assert.h>
+#include <osmscout/system/Math.h>
 
+#include <osmscout/util/File.h>
 #include <osmscout/util/Geometry.h>
+#include <osmscout/util/IndexedHeap.h>
 #include <osmscout/util/Logger.h>
 #include <osmscout/util/StopClock.h>
 
@@ -49,6 +57,27 @@ namespace osmscout {
     return debugPerformance;
   }
 
+  RoutingMatrix::RoutingMatrix()
+  : sourceCount(0),
+    targetCount(0)
+  {
+    // no code
+  }
+
+  /**
+   * Resize the matrix to the given number of sources and targets and mark
+   * all combinations as not reachable.
+   */
+  void RoutingMatrix::Initialize(size_t sourceCount,
+                                 size_t targetCount)
+  {
+    this->sourceCount=sourceCount;
+    this->targetCount=targetCount;
+
+    costs.assign(sourceCount*targetCount,std::numeric_limits<double>::max());
+    distances.assign(sourceCount*targetCount,-1.0);
+  }
+
   const char* const RoutingService::FILENAME_INTERSECTIONS_DAT   = "intersections.dat";
   const char* const RoutingService::FILENAME_INTERSECTIONS_IDX   = "intersections.idx";
 
@@ -63,6 +92,7 @@ namespace osmscout {
   const char* const RoutingService::FILENAME_CAR_DAT           = "routecar.dat";
   const char* const RoutingService::FILENAME_CAR_VARIANT_DAT   = "routecar2.dat";
   const char* const RoutingService::FILENAME_CAR_IDX           = "routecar.idx";
+  const char* const RoutingService::FILENAME_CAR_CH_DAT        = "routecarch.dat";
 
   /**
    * Create a new instance of the routing service.
@@ -90,7 +120,8 @@ namespace osmscout {
      junctionDataFile(RoutingService::FILENAME_INTERSECTIONS_DAT,
                       RoutingService::FILENAME_INTERSECTIONS_IDX,
                       0,
-                      6000)
+                      6000),
+     graphFlags(0)
   {
     assert(database);
   }
@@ -150,6 +181,20 @@ namespace osmscout {
     return ""; // make the compiler happy
   }
 
+  /**
+   * Returns the filename of the contraction hierarchy for the given vehicle
+   * or an empty string, if there is no contraction hierarchy for the vehicle.
+   */
+  std::string RoutingService::GetContractionHierarchyFilename(Vehicle vehicle) const
+  {
+    switch (vehicle) {
+    case vehicleCar:
+      return FILENAME_CAR_CH_DAT;
+    default:
+      return "";
+    }
+  }
+
   /**
    * Returns the vehicle this routing service instance was created for
    *
@@ -162,7 +207,8 @@ namespace osmscout {
   }
 
   bool RoutingService::LoadObjectVariantData(Vehicle vehicle,
-                                             std::vector<ObjectVariantData>& objectVariantData) const
+                                             std::vector<ObjectVariantData>& objectVariantData,
+                                             uint8_t& graphFlags) const
   {
     FileScanner scanner;
 
@@ -188,6 +234,15 @@ namespace osmscout {
       }
     }
 
+    // Graph flags are optional, older files end after the object variants
+    graphFlags=0;
+
+    if (!scanner.IsEOF() &&
+        !scanner.Read(graphFlags)) {
+      log.Error() << "Cannot read graph flags from file '" << scanner.GetFilename() << "'!";
+      return false;
+    }
+
     if (!scanner.Close()) {
       log.Error() << "Cannot close '" << scanner.GetFilename() << "'!";
       return false;
@@ -223,10 +278,38 @@ namespace osmscout {
     log.Debug() << "Opening RouteNodeData: " << timer.ResultString();
 
     if (!LoadObjectVariantData(vehicle,
-                               objectVariantData)) {
+                               objectVariantData,
+                               graphFlags)) {
       return false;
     }
 
+    std::string chFilename=GetContractionHierarchyFilename(vehicle);
+    FileOffset  chFileSize;
+    FileOffset  graphFileSize;
+
+    // The contraction hierarchy is optional, an outdated or unreadable
+    // file is ignored and the router falls back to the normal search
+    if (!chFilename.empty() &&
+        GetFileSize(AppendFileToDir(path,
+                                    chFilename),
+                    chFileSize) &&
+        GetFileSize(AppendFileToDir(path,
+                                    GetDataFilename(vehicle)),
+                    graphFileSize)) {
+      StopClock chTimer;
+
+      if (!contractionHierarchy.Load(AppendFileToDir(path,
+                                                     chFilename),
+                                     graphFileSize)) {
+        log.Warn() << "Ignoring contraction hierarchy '" << chFilename << "'";
+        contractionHierarchy.Clear();
+      }
+
+      chTimer.Stop();
+
+      log.Debug() << "Opening ContractionHierarchy: " << chTimer.ResultString();
+    }
+
     isOpen=true;
 
     return true;
@@ -249,6 +332,7 @@ namespace osmscout {
   void RoutingService::Close()
   {
     routeNodeDataFile.Close();
+    contractionHierarchy.Clear();
 
     isOpen=false;
   }
@@ -274,6 +358,16 @@ namespace osmscout {
     return database->GetTypeConfig();
   }
 
+  /**
+   * Returns true, if a contraction hierarchy is available, that has been
+   * calculated with the metric of the given profile.
+   */
+  bool RoutingService::CanUseContractionHierarchy(const RoutingProfile& profile) const
+  {
+    return contractionHierarchy.IsCompatible(*database->GetTypeConfig(),
+                                             profile);
+  }
+
   void RoutingService::GetStartForwardRouteNode(const RoutingProfile& profile,
                                                 const WayRef& way,
                                                 size_t nodeIndex,
@@ -1109,306 +1203,2417 @@ namespace osmscout {
       return true;
   }
 
-  /**
-   * Calculate a route
-   *
-   * @param profile
-   *    Profile to use
-   * @param startObject
-   *    Start object
-   * @param startNodeIndex
-   *    Index of the node within the start object used as starting point
-   * @param targetObject
-   *    Target object
-   * @param targetNodeIndex
-   *    Index of the node within the target object used as target point
-   * @param route
-   *    The route object holding the resulting route on success
-   * @return
-   *    True, if the engine was able to find a route, else false
-   */
-  bool RoutingService::CalculateRoute(const RoutingProfile& profile,
-                                      const ObjectFileRef& startObject,
-                                      size_t startNodeIndex,
-                                      const ObjectFileRef& targetObject,
-                                      size_t targetNodeIndex,
-                                      RouteData& route)
+  RoutingService::RelaxVisitor::RelaxVisitor(IndexedDataFile<Id,RouteNode>& routeNodeDataFile)
+  : routeNodeDataFile(routeNodeDataFile)
   {
-    RouteNodeRef             startForwardRouteNode;
-    RouteNodeRef             startBackwardRouteNode;
-    RNodeRef                 startForwardNode;
-    RNodeRef                 startBackwardNode;
+    // no code
+  }
 
-    double                   targetLon=0.0L;
-    double                   targetLat=0.0L;
+  RoutingService::RelaxVisitor::~RelaxVisitor()
+  {
+    // no code
+  }
 
-    RouteNodeRef             targetForwardRouteNode;
-    RouteNodeRef             targetBackwardRouteNode;
+  bool RoutingService::RelaxVisitor::LoadRouteNode(FileOffset offset,
+                                                   RouteNodeRef& node)
+  {
+    if (!routeNodeDataFile.GetByOffset(offset,
+                                       node)) {
+      log.Error() << "Cannot load route node with id " << offset;
+      return false;
+    }
 
-    // Sorted list (smallest cost first) of ways to check (we are using a std::set)
-    OpenList                 openList;
-    // Map routing nodes by id
-    OpenMap                  openMap;
-    CloseMap                 closeMap;
+    return true;
+  }
 
-    size_t                   nodesLoadedCount=0;
-    size_t                   nodesIgnoredCount=0;
-    size_t                   maxOpenList=0;
-    size_t                   maxCloseMap=0;
+  double RoutingService::RelaxVisitor::GetEstimateCost(const RouteNode& /*node*/) const
+  {
+    return 0.0;
+  }
 
-    route.Clear();
+  void RoutingService::RelaxVisitor::VisitPath(const RNode& /*current*/,
+                                               size_t /*pathIndex*/,
+                                               double /*pathCosts*/,
+                                               size_t /*slot*/,
+                                               bool /*improved*/)
+  {
+    // no code
+  }
 
-    openMap.reserve(10000);
-    closeMap.reserve(300000);
+  /**
+   * A* search, the estimate is the costs for the spherical distance to the target
+   */
+  class RoutingService::AStarRelaxVisitor : public RoutingService::RelaxVisitor
+  {
+  private:
+    const RoutingProfile& profile;
+    double                targetLon;
+    double                targetLat;
+
+  public:
+    AStarRelaxVisitor(IndexedDataFile<Id,RouteNode>& routeNodeDataFile,
+                      const RoutingProfile& profile,
+                      double targetLon,
+                      double targetLat)
+    : RelaxVisitor(routeNodeDataFile),
+      profile(profile),
+      targetLon(targetLon),
+      targetLat(targetLat)
+    {
+      // no code
+    }
+
+    double GetEstimateCost(const RouteNode& node) const
+    {
+      return profile.GetCosts(GetSphericalDistance(node.coord.GetLon(),
+                                                   node.coord.GetLat(),
+                                                   targetLon,
+                                                   targetLat));
+    }
+  };
+
+  static inline double GetBidirectionalPotential(const RoutingProfile& profile,
+                                                 const GeoCoord& coord,
+                                                 double startLon,
+                                                 double startLat,
+                                                 double targetLon,
+                                                 double targetLat)
+  {
+    double toTarget=profile.GetCosts(GetSphericalDistance(coord.GetLon(),
+                                                          coord.GetLat(),
+                                                          targetLon,
+                                                          targetLat));
+    double toStart=profile.GetCosts(GetSphericalDistance(coord.GetLon(),
+                                                         coord.GetLat(),
+                                                         startLon,
+                                                         startLat));
+
+    return (toTarget-toStart)/2;
+  }
 
-    if (!GetTargetNodes(profile,
-                        targetObject,
-                        targetNodeIndex,
-                        targetLon,
-                        targetLat,
-                        targetForwardRouteNode,
-                        targetBackwardRouteNode)) {
-      return false;
+  /**
+   * One direction of the bidirectional A* search. The estimate is the potential
+   * for the forward search and the negated potential for the backward search.
+   * The slots of all improved RNodes are collected for the check, if the search
+   * meets the search in the other direction.
+   */
+  class RoutingService::BidirectionalRelaxVisitor : public RoutingService::RelaxVisitor
+  {
+  private:
+    const RoutingProfile& profile;
+    double                startLon;
+    double                startLat;
+    double                targetLon;
+    double                targetLat;
+    bool                  forward;
+
+  public:
+    std::vector<size_t>   improvedSlots;
+
+  public:
+    BidirectionalRelaxVisitor(IndexedDataFile<Id,RouteNode>& routeNodeDataFile,
+                              const RoutingProfile& profile,
+                              double startLon,
+                              double startLat,
+                              double targetLon,
+                              double targetLat,
+                              bool forward)
+    : RelaxVisitor(routeNodeDataFile),
+      profile(profile),
+      startLon(startLon),
+      startLat(startLat),
+      targetLon(targetLon),
+      targetLat(targetLat),
+      forward(forward)
+    {
+      // no code
+    }
+
+    double GetEstimateCost(const RouteNode& node) const
+    {
+      double potential=GetBidirectionalPotential(profile,
+                                                 node.coord,
+                                                 startLon,
+                                                 startLat,
+                                                 targetLon,
+                                                 targetLat);
+
+      return forward ? potential : -potential;
+    }
+
+    void VisitPath(const RNode& /*current*/,
+                   size_t /*pathIndex*/,
+                   double /*pathCosts*/,
+                   size_t slot,
+                   bool improved)
+    {
+      if (improved) {
+        improvedSlots.push_back(slot);
+      }
     }
+  };
 
-    if (!GetStartNodes(profile,
-                       startObject,
-                       startNodeIndex,
-                       targetLon,
-                       targetLat,
-                       startForwardRouteNode,
-                       startBackwardRouteNode,
-                       startForwardNode,
-                       startBackwardNode)) {
-      return false;
-    }
+  /**
+   * Dijkstra search of a matrix row. Route nodes are shared between all searches
+   * of the job and the distance of the route is tracked for every slot.
+   */
+  class RoutingService::MatrixRelaxVisitor : public RoutingService::RelaxVisitor
+  {
+  private:
+    RoutingService&      service;
+    MatrixJob&           job;
+
+  public:
+    std::vector<double>& distances;
+    size_t               currentSlot;
+
+  public:
+    MatrixRelaxVisitor(RoutingService& service,
+                       MatrixJob& job,
+                       std::vector<double>& distances)
+    : RelaxVisitor(service.routeNodeDataFile),
+      service(service),
+      job(job),
+      distances(distances),
+      currentSlot(0)
+    {
+      // no code
+    }
+
+    bool LoadRouteNode(FileOffset offset,
+                       RouteNodeRef& node)
+    {
+      return service.GetMatrixRouteNode(job,
+                                        offset,
+                                        node);
+    }
+
+    void VisitPath(const RNode& current,
+                   size_t pathIndex,
+                   double /*pathCosts*/,
+                   size_t slot,
+                   bool improved)
+    {
+      if (!improved) {
+        return;
+      }
 
-    if (startForwardNode) {
-      std::pair<OpenListRef,bool> result=openList.insert(startForwardNode);
+      double distance=distances[currentSlot]+current.node->paths[pathIndex].distance;
 
-      openMap[startForwardNode->nodeOffset]=result.first;
+      if (slot<distances.size()) {
+        distances[slot]=distance;
+      }
+      else {
+        distances.push_back(distance);
+      }
     }
+  };
 
-    if (startBackwardNode) {
-      std::pair<OpenListRef,bool> result=openList.insert(startBackwardNode);
+  /**
+   * Dijkstra search of the reachable area. Every usable path is recorded as
+   * segment, also paths to already settled route nodes.
+   */
+  class RoutingService::ReachabilityRelaxVisitor : public RoutingService::RelaxVisitor
+  {
+  private:
+    const RNodePool&                  pool;
 
-      openMap[startBackwardNode->nodeOffset]=result.first;
+  public:
+    std::vector<ReachabilitySegment>& segments;
+
+  public:
+    ReachabilityRelaxVisitor(IndexedDataFile<Id,RouteNode>& routeNodeDataFile,
+                             const RNodePool& pool,
+                             std::vector<ReachabilitySegment>& segments)
+    : RelaxVisitor(routeNodeDataFile),
+      pool(pool),
+      segments(segments)
+    {
+      // no code
     }
 
-    StopClock    clock;
-    RNodeRef     current;
-    RouteNodeRef currentRouteNode;
+    void VisitPath(const RNode& current,
+                   size_t /*pathIndex*/,
+                   double pathCosts,
+                   size_t slot,
+                   bool /*improved*/)
+    {
+      ReachabilitySegment segment;
 
-    do {
-      //
-      // Take entry from open list with lowest cost
-      //
+      segment.from=current.node->coord;
+      segment.to=pool.nodes[slot].node->coord;
+      segment.fromCosts=current.currentCost;
+      segment.costs=pathCosts;
 
-      current=*openList.begin();
+      segments.push_back(segment);
+    }
+  };
 
-      openMap.erase(current->nodeOffset);
-      openList.erase(openList.begin());
+  /**
+   * Reach the route node with the given file offset from the current RNode with the
+   * given costs. If the route node is not yet part of the pool, it is added to the
+   * pool and the open list, if the new costs are cheaper than the costs of the not yet
+   * closed RNode in the pool, the RNode is updated.
+   *
+   * @param routeNode
+   *    The route node, if already loaded by the caller, else it is loaded via the visitor
+   * @param slot
+   *    The slot of the RNode in the pool, if the route node is part of the pool afterwards
+   * @param improved
+   *    true, if the RNode was added or updated
+   * @return
+   *    False on error, else true
+   */
+  bool RoutingService::RelaxRNode(RelaxVisitor& visitor,
+                                  RNodePool& pool,
+                                  IndexedHeap<RNodeSlotCostCompare>& openList,
+                                  const RNode& current,
+                                  FileOffset offset,
+                                  const RouteNodeRef& routeNode,
+                                  const ObjectFileRef& object,
+                                  double currentCost,
+                                  bool access,
+                                  size_t& slot,
+                                  bool& improved)
+  {
+    std::unordered_map<FileOffset,size_t>::const_iterator slotEntry=pool.slots.find(offset);
 
-      currentRouteNode=current->node;
+    improved=false;
 
-      nodesLoadedCount++;
+    if (slotEntry!=pool.slots.end()) {
+      RNode& node=pool.nodes[slotEntry->second];
 
-      // Get potential follower in the current way
+      slot=slotEntry->second;
 
+      // Check, if the node is already settled or if we already have a cheaper path to it
+      if (pool.closed[slot]) {
 #if defined(DEBUG_ROUTING)
-      std::cout << "Analysing follower of node " << currentRouteNode->GetFileOffset();
-      std::cout << " (" << current->object.GetTypeName() << " " << current->object.GetFileOffset() << "["  << currentRouteNode->GetId() << "]" << ")";
-      std::cout << " " << current->currentCost << " " << current->estimateCost << " " << current->overallCost << std::endl;
-#endif
-      size_t i=0;
-      for (const auto& path : currentRouteNode->paths) {
-        if (path.offset==current->prev) {
-#if defined(DEBUG_ROUTING)
-          std::cout << "  Skipping route";
-          std::cout << " to " << path->offset;
-          std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
-          std::cout << " => back to the last node visited" << std::endl;
+        std::cout << "  Skipping route";
+        std::cout << " to " << offset;
+        std::cout << " (" << object.GetTypeName() << " " << object.GetFileOffset() << ")";
+        std::cout << " => already calculated" << std::endl;
 #endif
-          nodesIgnoredCount++;
-          i++;
-          continue;
-        }
+        return true;
+      }
 
-        if (!current->access &&
-            path.HasAccess()) {
+      if (node.currentCost<=currentCost) {
 #if defined(DEBUG_ROUTING)
-          std::cout << "  Skipping route";
-          std::cout << " to " << path->offset;
-          std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
-          std::cout << " => moving from non-accessible way back to accessible way" << std::endl;
+        std::cout << "  Skipping route";
+        std::cout << " to " << offset;
+        std::cout << " (" << object.GetTypeName() << " " << object.GetFileOffset() << ")";
+        std::cout << "  => cheaper route exists " << currentCost << "<=>" << node.currentCost << std::endl;
 #endif
-          nodesIgnoredCount++;
-          i++;
-          continue;
-        }
+        return true;
+      }
 
-        if (!profile.CanUse(*currentRouteNode,objectVariantData,i)) {
-#if defined(DEBUG_ROUTING)
-          std::cout << "  Skipping route";
-          std::cout << " to " << path->offset;
-          std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
-          std::cout << " => Cannot be used"<< std::endl;
-#endif
-          nodesIgnoredCount++;
-          i++;
-          continue;
-        }
+      // The estimate does not change, since the node is the same
+      node.prev=current.nodeOffset;
+      node.object=object;
+      node.currentCost=currentCost;
+      node.overallCost=currentCost+node.estimateCost;
+      node.access=access;
 
-        if (closeMap.find(path.offset)!=closeMap.end()) {
 #if defined(DEBUG_ROUTING)
-          std::cout << "  Skipping route";
-          std::cout << " to " << path->offset;
-          std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
-          std::cout << " => already calculated" << std::endl;
+      std::cout << "  Updating route " << current.nodeOffset << " via " << node.object.GetTypeName() << " " << node.object.GetFileOffset() << " " << node.currentCost << " " << node.estimateCost << " " << node.overallCost << " " << current.node->GetId() << std::endl;
 #endif
-          i++;
-          continue;
-        }
-
-        if (!currentRouteNode->excludes.empty()) {
-          bool canTurnedInto=true;
 
-          for (const auto& exclude : currentRouteNode->excludes) {
-            if (exclude.source==current->object &&
-                exclude.targetIndex==i) {
-#if defined(DEBUG_ROUTING)
-              std::cout << "  Skipping route";
-              std::cout << " to " << path->offset;
-              std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
-              std::cout << " => turn not allowed" << std::endl;
-#endif
-              canTurnedInto=false;
-              break;
-            }
-          }
+      openList.DecreaseKey(slot);
+    }
+    else {
+      RouteNodeRef nextNode=routeNode;
 
-          if (!canTurnedInto) {
-            nodesIgnoredCount++;
-            i++;
-            continue;
-          }
-        }
+      if (!nextNode &&
+          !visitor.LoadRouteNode(offset,
+                                 nextNode)) {
+        return false;
+      }
 
-        double currentCost=current->currentCost+
-                           profile.GetCosts(*currentRouteNode,objectVariantData,i);
+      RNode node(offset,
+                 nextNode,
+                 object,
+                 current.nodeOffset);
 
-        OpenMap::iterator openEntry=openMap.find(path.offset);
+      node.currentCost=currentCost;
+      node.estimateCost=visitor.GetEstimateCost(*nextNode);
+      node.overallCost=node.currentCost+node.estimateCost;
+      node.access=access;
 
-        // Check, if we already have a cheaper path to the new node. If yes, do not put the new path
-        // into the open list
-        if (openEntry!=openMap.end() &&
-            (*openEntry->second)->currentCost<=currentCost) {
 #if defined(DEBUG_ROUTING)
-          std::cout << "  Skipping route";
-          std::cout << " to " << path->offset;
-          std::cout << " (" << currentRouteNode->objects[path->objectIndex].GetTypeName() << " " << currentRouteNode->objects[path->objectIndex].GetFileOffset() << ")";
-          std::cout << "  => cheaper route exists " << currentCost << "<=>" << (*openEntry->second)->currentCost << std::endl;
+      std::cout << "  Inserting route to " << offset;
+      std::cout <<  " (" << node.object.GetTypeName() << " " << node.object.GetFileOffset() << ")";
+      std::cout << " " << node.currentCost << " " << node.estimateCost << " " << node.overallCost << " " << current.node->GetId() << std::endl;
 #endif
-          i++;
-          continue;
-        }
-
-        RouteNodeRef nextNode;
-
-        if (openEntry!=openMap.end()) {
-          nextNode=(*openEntry->second)->node;
-        }
-        else {
-          if (!routeNodeDataFile.GetByOffset(path.offset,
-                                             nextNode)) {
-            log.Error() << "Cannot load route node with id " << path.offset;
-            return false;
-          }
-        }
 
-        double distanceToTarget=GetSphericalDistance(nextNode->coord.GetLon(),
-                                                     nextNode->coord.GetLat(),
-                                                     targetLon,
-                                                     targetLat);
-        // Estimate costs for the rest of the distance to the target
-        double estimateCost=profile.GetCosts(distanceToTarget);
-        double overallCost=currentCost+estimateCost;
+      slot=pool.Add(node);
+      openList.Push(slot);
+    }
 
-        // If we already have the node in the open list, but the new path is cheaper,
-        // update the existing entry
-        if (openEntry!=openMap.end()) {
-          RNodeRef node=*openEntry->second;
+    improved=true;
 
-          node->prev=current->nodeOffset;
-          node->object=currentRouteNode->objects[path.objectIndex].object;
+    return true;
+  }
 
-          node->currentCost=currentCost;
-          node->estimateCost=estimateCost;
-          node->overallCost=overallCost;
-          node->access=currentRouteNode->paths[i].HasAccess();
+  /**
+   * Relax all paths of the current RNode, that can be used, see RelaxRNode().
+   *
+   * @return
+   *    False on error, else true
+   */
+  bool RoutingService::RelaxPaths(const RoutingProfile& profile,
+                                  RelaxVisitor& visitor,
+                                  RNodePool& pool,
+                                  IndexedHeap<RNodeSlotCostCompare>& openList,
+                                  const RNode& current,
+                                  RoutingStatistics& statistics)
+  {
+    const RouteNode& currentRouteNode=*current.node;
 
 #if defined(DEBUG_ROUTING)
-          std::cout << "  Updating route " << current->nodeOffset << " via " << node->object.GetTypeName() << " " << node->object.GetFileOffset() << " " << currentCost << " " << estimateCost << " " << overallCost << " " << currentRouteNode->id << std::endl;
+    std::cout << "Analysing follower of node " << currentRouteNode.GetFileOffset();
+    std::cout << " (" << current.object.GetTypeName() << " " << current.object.GetFileOffset() << "["  << currentRouteNode.GetId() << "]" << ")";
+    std::cout << " " << current.currentCost << " " << current.estimateCost << " " << current.overallCost << std::endl;
 #endif
 
-          openList.erase(openEntry->second);
+    for (size_t i=0; i<currentRouteNode.paths.size(); i++) {
+      const RouteNode::Path& path=currentRouteNode.paths[i];
 
-          std::pair<OpenListRef,bool> result=openList.insert(node);
-          openEntry->second=result.first;
-        }
-        else {
-          RNodeRef node=std::make_shared<RNode>(path.offset,
-                                                nextNode,
-                                                currentRouteNode->objects[path.objectIndex].object,
-                                                current->nodeOffset);
+      if (!CanUsePath(profile,
+                      current,
+                      i)) {
+        statistics.nodesIgnoredCount++;
+        continue;
+      }
 
-          node->currentCost=currentCost;
-          node->estimateCost=estimateCost;
-          node->overallCost=overallCost;
-          node->access=path.HasAccess();
+      double pathCosts=profile.GetCosts(currentRouteNode,objectVariantData,i);
+      size_t slot;
+      bool   improved;
+
+      if (!RelaxRNode(visitor,
+                      pool,
+                      openList,
+                      current,
+                      path.offset,
+                      RouteNodeRef(),
+                      currentRouteNode.objects[path.objectIndex].object,
+                      current.currentCost+pathCosts,
+                      path.HasAccess(),
+                      slot,
+                      improved)) {
+        return false;
+      }
 
-#if defined(DEBUG_ROUTING)
-          std::cout << "  Inserting route to " << path->offset;
-          std::cout <<  " (" << node->object.GetTypeName() << " " << node->object.GetFileOffset() << ")";
-          std::cout << " " << currentCost << " " << estimateCost << " " << overallCost << " " << currentRouteNode->id << std::endl;
-#endif
+      visitor.VisitPath(current,
+                        i,
+                        pathCosts,
+                        slot,
+                        improved);
+    }
 
-          std::pair<OpenListRef,bool> result=openList.insert(node);
+    return true;
+  }
+
+  /**
+   * Collect the start nodes (together with the costs and the distance from the
+   * start position) for a source of a matrix calculation.
+   */
+  bool RoutingService::GetMatrixSource(const RoutingProfile& profile,
+                                       const ObjectFileRef& object,
+                                       size_t nodeIndex,
+                                       MatrixSource& source)
+  {
+    WayDataFileRef wayDataFile(database->GetWayDataFile());
+    WayRef         way;
+    RouteNodeRef   forwardRouteNode;
+    RouteNodeRef   backwardRouteNode;
+    RNodeRef       forwardRNode;
+    RNodeRef       backwardRNode;
+    double         targetLon=0.0;
+    double         targetLat=0.0;
+
+    if (!wayDataFile ||
+        object.GetType()!=refWay ||
+        !wayDataFile->GetByOffset(object.GetFileOffset(),
+                                  way)) {
+      return false;
+    }
+
+    if (!GetStartNodes(profile,
+                       object,
+                       nodeIndex,
+                       targetLon,
+                       targetLat,
+                       forwardRouteNode,
+                       backwardRouteNode,
+                       forwardRNode,
+                       backwardRNode)) {
+      return false;
+    }
+
+    RNodeRef startNodes[]={forwardRNode,backwardRNode};
+
+    for (const auto& startNode : startNodes) {
+      if (!startNode) {
+        continue;
+      }
+
+      source.nodes.push_back(*startNode);
+      source.distances.push_back(GetSphericalDistance(way->nodes[nodeIndex].GetLon(),
+                                                      way->nodes[nodeIndex].GetLat(),
+                                                      startNode->node->coord.GetLon(),
+                                                      startNode->node->coord.GetLat()));
+    }
+
+    return true;
+  }
+
+  /**
+   * Collect the route nodes (together with the remaining costs and distance
+   * to the target position) for a target of a matrix calculation.
+   */
+  bool RoutingService::GetMatrixTarget(const RoutingProfile& profile,
+                                       const ObjectFileRef& object,
+                                       size_t nodeIndex,
+                                       MatrixTarget& target)
+  {
+    WayDataFileRef wayDataFile(database->GetWayDataFile());
+    WayRef         way;
+    RouteNodeRef   forwardRouteNode;
+    RouteNodeRef   backwardRouteNode;
+    double         targetLon=0.0;
+    double         targetLat=0.0;
+
+    if (!wayDataFile ||
+        object.GetType()!=refWay ||
+        !wayDataFile->GetByOffset(object.GetFileOffset(),
+                                  way)) {
+      return false;
+    }
+
+    if (!GetTargetNodes(profile,
+                        object,
+                        nodeIndex,
+                        targetLon,
+                        targetLat,
+                        forwardRouteNode,
+                        backwardRouteNode)) {
+      return false;
+    }
+
+    RouteNodeRef routeNodes[]={forwardRouteNode,backwardRouteNode};
+
+    for (const auto& routeNode : routeNodes) {
+      if (!routeNode) {
+        continue;
+      }
+
+      double distance=GetSphericalDistance(routeNode->coord.GetLon(),
+                                           routeNode->coord.GetLat(),
+                                           targetLon,
+                                           targetLat);
+
+      target.routeNodeOffsets.push_back(routeNode->GetFileOffset());
+      target.costs.push_back(profile.GetCosts(*way,distance));
+      target.distances.push_back(distance);
+    }
+
+    return true;
+  }
+
+  /**
+   * Return the route node with the given file offset. Route nodes are loaded
+   * only once per matrix calculation and shared between all searches (and threads).
+   */
+  bool RoutingService::GetMatrixRouteNode(MatrixJob& job,
+                                          FileOffset offset,
+                                          RouteNodeRef& node)
+  {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(job.routeNodesMutex);
+#endif
+
+    auto entry=job.routeNodes.find(offset);
+
+    if (entry!=job.routeNodes.end()) {
+      node=entry->second;
+
+      return true;
+    }
+
+    if (!routeNodeDataFile.GetByOffset(offset,
+                                       node)) {
+      log.Error() << "Cannot load route node with id " << offset;
+      return false;
+    }
+
+    job.routeNodes[offset]=node;
+
+    return true;
+  }
+
+  /**
+   * One-to-many Dijkstra search from the given source to all targets of the job.
+   * The search stops as soon as the route nodes of all targets are settled.
+   *
+   * @return
+   *    False on error, else true
+   */
+  bool RoutingService::CalculateMatrixRow(MatrixJob& job,
+                                          size_t sourceIndex)
+  {
+    const RoutingProfile&             profile=*job.profile;
+    const MatrixSource&               source=(*job.sources)[sourceIndex];
+    RNodePool                         pool;
+    std::vector<double>               distances;
+    IndexedHeap<RNodeSlotCostCompare> openList(RNodeSlotCostCompare(pool.nodes));
+    MatrixRelaxVisitor                visitor(*this,
+                                              job,
+                                              distances);
+    RoutingStatistics                 statistics;
+    size_t                            pendingTargetRouteNodes=job.targetRouteNodes.size();
+
+    for (size_t i=0; i<source.nodes.size(); i++) {
+      RNode node=source.nodes[i];
+
+      // Plain Dijkstra, we do not use an estimate
+      node.estimateCost=0.0;
+      node.overallCost=node.currentCost;
+
+      auto entry=pool.slots.find(node.nodeOffset);
+
+      if (entry!=pool.slots.end()) {
+        if (node.currentCost<pool.nodes[entry->second].currentCost) {
+          pool.nodes[entry->second]=node;
+          distances[entry->second]=source.distances[i];
+          openList.DecreaseKey(entry->second);
+        }
+
+        continue;
+      }
+
+      distances.push_back(source.distances[i]);
+      openList.Push(pool.Add(node));
+    }
+
+    while (!openList.Empty() &&
+           pendingTargetRouteNodes>0) {
+      size_t currentSlot=openList.Pop();
+
+      pool.closed[currentSlot]=true;
+      statistics.nodesLoadedCount++;
+
+      // Copy, since adding new nodes to the pool invalidates references
+      RNode current=pool.nodes[currentSlot];
+
+      auto targetEntry=job.targetRouteNodes.find(current.nodeOffset);
+
+      if (targetEntry!=job.targetRouteNodes.end()) {
+        pendingTargetRouteNodes--;
+
+        for (const auto& targetRouteNode : targetEntry->second) {
+          const MatrixTarget& target=(*job.targets)[targetRouteNode.first];
+          double              costs=current.currentCost+target.costs[targetRouteNode.second];
+          double              distance=distances[currentSlot]+target.distances[targetRouteNode.second];
+
+          if (!job.matrix->IsReachable(sourceIndex,targetRouteNode.first) ||
+              costs<job.matrix->GetCosts(sourceIndex,targetRouteNode.first)) {
+            job.matrix->Set(sourceIndex,
+                            targetRouteNode.first,
+                            costs,
+                            distance);
+          }
+        }
+      }
+
+      visitor.currentSlot=currentSlot;
+
+      if (!RelaxPaths(profile,
+                      visitor,
+                      pool,
+                      openList,
+                      current,
+                      statistics)) {
+        return false;
+      }
+
+      // We do not need the route node anymore
+      pool.nodes[currentSlot].node=NULL;
+    }
+
+    job.nodesLoadedCount+=statistics.nodesLoadedCount;
+
+    return true;
+  }
+
+  /**
+   * Calculate rows of the matrix until all sources are processed. Called
+   * by every worker thread.
+   */
+  void RoutingService::ProcessMatrixJob(MatrixJob& job)
+  {
+    size_t sourceIndex;
+
+    while ((sourceIndex=job.nextSource++)<job.sources->size()) {
+      if (!CalculateMatrixRow(job,
+                              sourceIndex)) {
+        job.success=false;
+      }
+    }
+  }
+
+  /**
+   * Calculate the costs and distances for all combinations of the given sources and
+   * targets (many-to-many). All positions are mapped to the closest routable node
+   * only once and instead of one search for each combination only one (one-to-many)
+   * search for each source is done. No route data is generated.
+   *
+   * Route nodes loaded are shared between the searches. If threadCount is greater
+   * than one (and the platform supports threads) the searches for different sources
+   * are run in parallel.
+   *
+   * @param profile
+   *    Profile to use
+   * @param radius
+   *    Maximum distance of a position to the closest routable node
+   * @param sources
+   *    Start positions
+   * @param targets
+   *    Target positions
+   * @param matrix
+   *    Matrix holding the costs and distances on success
+   * @param threadCount
+   *    Number of threads to use
+   * @return
+   *    False on error, else true
+   */
+  bool RoutingService::CalculateMatrix(const RoutingProfile& profile,
+                                       double radius,
+                                       const std::vector<GeoCoord>& sources,
+                                       const std::vector<GeoCoord>& targets,
+                                       RoutingMatrix& matrix,
+                                       size_t threadCount)
+  {
+    std::vector<MatrixSource> matrixSources(sources.size());
+    std::vector<MatrixTarget> matrixTargets(targets.size());
+    MatrixJob                 job;
+    StopClock                 clock;
+
+    matrix.Initialize(sources.size(),
+                      targets.size());
+
+    for (size_t s=0; s<sources.size(); s++) {
+      ObjectFileRef object;
+      size_t        nodeIndex;
+
+      if (!GetClosestRoutableNode(sources[s].GetLat(),
+                                  sources[s].GetLon(),
+                                  vehicle,
+                                  radius,
+                                  object,
+                                  nodeIndex)) {
+        return false;
+      }
+
+      if (!object.Valid() ||
+          !GetMatrixSource(profile,
+                           object,
+                           nodeIndex,
+                           matrixSources[s])) {
+        log.Warn() << "Source " << s << " cannot be mapped to the routing graph";
+      }
+    }
+
+    for (size_t t=0; t<targets.size(); t++) {
+      ObjectFileRef object;
+      size_t        nodeIndex;
+
+      if (!GetClosestRoutableNode(targets[t].GetLat(),
+                                  targets[t].GetLon(),
+                                  vehicle,
+                                  radius,
+                                  object,
+                                  nodeIndex)) {
+        return false;
+      }
+
+      if (!object.Valid() ||
+          !GetMatrixTarget(profile,
+                           object,
+                           nodeIndex,
+                           matrixTargets[t])) {
+        log.Warn() << "Target " << t << " cannot be mapped to the routing graph";
+        continue;
+      }
+
+      for (size_t i=0; i<matrixTargets[t].routeNodeOffsets.size(); i++) {
+        job.targetRouteNodes[matrixTargets[t].routeNodeOffsets[i]].push_back(std::make_pair(t,i));
+      }
+    }
+
+    job.profile=&profile;
+    job.sources=&matrixSources;
+    job.targets=&matrixTargets;
+    job.matrix=&matrix;
+    job.nextSource=0;
+    job.nodesLoadedCount=0;
+    job.success=true;
+
+#if defined(OSMSCOUT_HAVE_THREAD) && defined(OSMSCOUT_HAVE_ATOMIC) && defined(OSMSCOUT_HAVE_MUTEX)
+    std::vector<std::thread> threads;
+
+    for (size_t i=1; i<std::min(threadCount,sources.size()); i++) {
+      threads.push_back(std::thread(&RoutingService::ProcessMatrixJob,
+                                    this,
+                                    std::ref(job)));
+    }
+
+    ProcessMatrixJob(job);
+
+    for (auto& thread : threads) {
+      thread.join();
+    }
+#else
+    threadCount=1;
+
+    ProcessMatrixJob(job);
+#endif
+
+    clock.Stop();
+
+    if (debugPerformance) {
+      std::cout << "Matrix:              " << sources.size() << "x" << targets.size() << std::endl;
+      std::cout << "Threads:             " << std::max(std::min(threadCount,sources.size()),(size_t)1) << std::endl;
+      std::cout << "Time:                " << clock << std::endl;
+      std::cout << "Route nodes loaded:  " << job.nodesLoadedCount << std::endl;
+      std::cout << "Route nodes cached:  " << job.routeNodes.size() << std::endl;
+    }
+
+    return job.success;
+  }
+
+  namespace {
+    /**
+     * Helper for tracing the outline of the occupied cells of a grid.
+     */
+    class GridOutlineTracer
+    {
+    private:
+      struct Edge
+      {
+        size_t from;  //!< Index of the start vertex
+        size_t to;    //!< Index of the end vertex
+        int    dx;    //!< Direction in x
+        int    dy;    //!< Direction in y
+        bool   used;  //!< true, if the edge is already part of a ring
+      };
+
+    private:
+      size_t                                          width;
+      size_t                                          height;
+      std::vector<Edge>                               edges;
+      std::unordered_map<size_t,std::vector<size_t> > outgoing;
+
+    private:
+      inline size_t GetVertex(size_t x,
+                              size_t y) const
+      {
+        return y*(width+1)+x;
+      }
+
+      inline bool IsSet(const std::vector<bool>& cells,
+                        size_t x,
+                        size_t y) const
+      {
+        return x<width &&
+               y<height &&
+               cells[y*width+x];
+      }
+
+      void AddEdge(size_t fromX,
+                   size_t fromY,
+                   size_t toX,
+                   size_t toY)
+      {
+        Edge edge;
+
+        edge.from=GetVertex(fromX,fromY);
+        edge.to=GetVertex(toX,toY);
+        edge.dx=(int)toX-(int)fromX;
+        edge.dy=(int)toY-(int)fromY;
+        edge.used=false;
+
+        outgoing[edge.from].push_back(edges.size());
+        edges.push_back(edge);
+      }
+
+      /**
+       * Return the next unused edge starting at the end of the given edge.
+       * If there is a choice (two cells only touching at the vertex), a left
+       * turn is preferred, so that the rings of both cells stay separated.
+       */
+      size_t GetNextEdge(const Edge& current) const
+      {
+        auto   entry=outgoing.find(current.to);
+        size_t next=edges.size();
+
+        if (entry==outgoing.end()) {
+          return next;
+        }
+
+        for (const auto& candidate : entry->second) {
+          if (edges[candidate].used) {
+            continue;
+          }
+
+          if (edges[candidate].dx==-current.dy &&
+              edges[candidate].dy==current.dx) {
+            return candidate;
+          }
+
+          next=candidate;
+        }
+
+        return next;
+      }
+
+    public:
+      /**
+       * Trace the boundary of all set cells. Each cell gets bounded counterclockwise,
+       * boundary edges between set cells are dropped. Every resulting ring only contains
+       * the corners of the outline.
+       */
+      void Trace(const std::vector<bool>& cells,
+                 size_t width,
+                 size_t height,
+                 std::vector<std::vector<std::pair<size_t,size_t> > >& rings)
+      {
+        this->width=width;
+        this->height=height;
+
+        edges.clear();
+        outgoing.clear();
+
+        for (size_t y=0; y<height; y++) {
+          for (size_t x=0; x<width; x++) {
+            if (!cells[y*width+x]) {
+              continue;
+            }
+
+            if (y==0 || !IsSet(cells,x,y-1)) {
+              AddEdge(x,y,x+1,y);
+            }
+
+            if (!IsSet(cells,x+1,y)) {
+              AddEdge(x+1,y,x+1,y+1);
+            }
+
+            if (!IsSet(cells,x,y+1)) {
+              AddEdge(x+1,y+1,x,y+1);
+            }
+
+            if (x==0 || !IsSet(cells,x-1,y)) {
+              AddEdge(x,y+1,x,y);
+            }
+          }
+        }
+
+        for (size_t start=0; start<edges.size(); start++) {
+          if (edges[start].used) {
+            continue;
+          }
+
+          std::vector<std::pair<size_t,size_t> > ring;
+          size_t                                 current=start;
+
+          while (current<edges.size() &&
+                 !edges[current].used) {
+            size_t next;
+
+            edges[current].used=true;
+            next=GetNextEdge(edges[current]);
+
+            // If the ring is closed, the start edge follows (but is already used)
+            const Edge& following=next<edges.size() ? edges[next] : edges[start];
+
+            // Only store vertices where the direction changes
+            if (following.dx!=edges[current].dx ||
+                following.dy!=edges[current].dy) {
+              ring.push_back(std::make_pair(edges[current].to%(width+1),
+                                            edges[current].to/(width+1)));
+            }
+
+            current=next;
+          }
+
+          if (ring.size()>=3) {
+            rings.push_back(ring);
+          }
+        }
+      }
+    };
+  }
+
+  /**
+   * Rasterize the given segments into a grid and calculate the outline of the reachable
+   * area for every cost band. Segments are only partially taken into account, if the
+   * costs of the band limit are reached within the segment.
+   */
+  void RoutingService::CalculateReachabilityBands(const std::vector<ReachabilitySegment>& segments,
+                                                  double maxCost,
+                                                  size_t bandCount,
+                                                  double cellSize,
+                                                  RoutingReachability& reachability) const
+  {
+    // Rough number of kilometers per degree latitude
+    const double kmPerDegree=111.2;
+    // Upper limit for the number of grid cells
+    const size_t maxCellCount=4000000;
+
+    reachability.bands.clear();
+
+    if (segments.empty() ||
+        bandCount==0) {
+      return;
+    }
+
+    double minLat=segments.front().from.GetLat();
+    double maxLat=minLat;
+    double minLon=segments.front().from.GetLon();
+    double maxLon=minLon;
+
+    for (const auto& segment : segments) {
+      minLat=std::min(minLat,std::min(segment.from.GetLat(),segment.to.GetLat()));
+      maxLat=std::max(maxLat,std::max(segment.from.GetLat(),segment.to.GetLat()));
+      minLon=std::min(minLon,std::min(segment.from.GetLon(),segment.to.GetLon()));
+      maxLon=std::max(maxLon,std::max(segment.from.GetLon(),segment.to.GetLon()));
+    }
+
+    double cellLat=cellSize/kmPerDegree;
+    double cellLon=cellLat/std::max(cos((minLat+maxLat)/2*M_PI/180),0.01);
+    size_t width=(size_t)ceil((maxLon-minLon)/cellLon)+1;
+    size_t height=(size_t)ceil((maxLat-minLat)/cellLat)+1;
+
+    if (width*height>maxCellCount) {
+      double factor=sqrt((double)(width*height)/maxCellCount);
+
+      cellLat*=factor;
+      cellLon*=factor;
+      width=(size_t)ceil((maxLon-minLon)/cellLon)+1;
+      height=(size_t)ceil((maxLat-minLat)/cellLat)+1;
+    }
+
+    // Center the grid over the reachable area
+    double originLat=(minLat+maxLat)/2-height*cellLat/2;
+    double originLon=(minLon+maxLon)/2-width*cellLon/2;
+
+    // The minimum costs to reach any point within the cell
+    std::vector<double> cellCosts(width*height,std::numeric_limits<double>::max());
+
+    for (const auto& segment : segments) {
+      if (segment.fromCosts>maxCost) {
+        continue;
+      }
+
+      double deltaLat=segment.to.GetLat()-segment.from.GetLat();
+      double deltaLon=segment.to.GetLon()-segment.from.GetLon();
+      double fraction=1.0;
+
+      if (segment.fromCosts+segment.costs>maxCost) {
+        fraction=(maxCost-segment.fromCosts)/segment.costs;
+      }
+
+      // Sample the segment at least twice per cell
+      size_t steps=(size_t)ceil(std::max(fabs(deltaLat)/cellLat,
+                                         fabs(deltaLon)/cellLon)*fraction*2);
+
+      for (size_t step=0; step<=steps; step++) {
+        double t=steps>0 ? fraction*step/steps : 0.0;
+        size_t x=(size_t)((segment.from.GetLon()+t*deltaLon-originLon)/cellLon);
+        size_t y=(size_t)((segment.from.GetLat()+t*deltaLat-originLat)/cellLat);
+
+        if (x>=width ||
+            y>=height) {
+          continue;
+        }
+
+        cellCosts[y*width+x]=std::min(cellCosts[y*width+x],
+                                      segment.fromCosts+t*segment.costs);
+      }
+    }
+
+    GridOutlineTracer tracer;
+    std::vector<bool> cells(width*height);
+
+    reachability.bands.resize(bandCount);
+
+    for (size_t b=0; b<bandCount; b++) {
+      RoutingReachability::Band&                           band=reachability.bands[b];
+      std::vector<std::vector<std::pair<size_t,size_t> > > rings;
+
+      band.maxCosts=maxCost*(b+1)/bandCount;
+
+      for (size_t i=0; i<cellCosts.size(); i++) {
+        cells[i]=cellCosts[i]<=band.maxCosts;
+      }
+
+      tracer.Trace(cells,
+                   width,
+                   height,
+                   rings);
+
+      band.rings.reserve(rings.size());
+
+      for (const auto& ring : rings) {
+        std::vector<GeoCoord> coords;
+
+        coords.reserve(ring.size());
+
+        for (const auto& vertex : ring) {
+          coords.push_back(GeoCoord(originLat+vertex.second*cellLat,
+                                    originLon+vertex.first*cellLon));
+        }
+
+        band.rings.push_back(coords);
+      }
+    }
+  }
+
+  /**
+   * Calculate the part of the routing graph reachable from the given start within the
+   * given costs (isochrone). A Dijkstra search is done that stops as soon as the maximum
+   * costs are reached. No route data is generated.
+   *
+   * The costs are split into bandCount bands of equal size and for every band the
+   * outline of the reachable area is calculated using a grid with the given cell size.
+   * Paths between route nodes are approximated by straight lines.
+   *
+   * @param profile
+   *    Profile to use
+   * @param startObject
+   *    Object the start position is on
+   * @param startNodeIndex
+   *    Index of the start node of the object
+   * @param maxCost
+   *    Maximum costs (in units of the profile)
+   * @param bandCount
+   *    Number of cost bands to calculate an outline for
+   * @param cellSize
+   *    Size of a grid cell in km
+   * @param reachability
+   *    Reachable nodes and the outlines of the cost bands on success
+   * @return
+   *    False on error (including maxCost or cellSize not being positive or
+   *    bandCount being 0), else true
+   */
+  bool RoutingService::CalculateReachability(const RoutingProfile& profile,
+                                             const ObjectFileRef& startObject,
+                                             size_t startNodeIndex,
+                                             double maxCost,
+                                             size_t bandCount,
+                                             double cellSize,
+                                             RoutingReachability& reachability)
+  {
+    WayDataFileRef                    wayDataFile(database->GetWayDataFile());
+    WayRef                            way;
+    RouteNodeRef                      startForwardRouteNode;
+    RouteNodeRef                      startBackwardRouteNode;
+    RNodeRef                          startForwardNode;
+    RNodeRef                          startBackwardNode;
+    double                            targetLon=0.0;
+    double                            targetLat=0.0;
+    RNodePool                         pool;
+    IndexedHeap<RNodeSlotCostCompare> openList(RNodeSlotCostCompare(pool.nodes));
+    std::vector<ReachabilitySegment>  segments;
+    ReachabilityRelaxVisitor          visitor(routeNodeDataFile,
+                                              pool,
+                                              segments);
+    RoutingStatistics                 statistics;
+    StopClock                         clock;
+
+    reachability.nodes.clear();
+    reachability.bands.clear();
+
+    if (maxCost<=0.0) {
+      log.Error() << "Maximum costs must be greater than 0!";
+      return false;
+    }
+
+    if (bandCount==0) {
+      log.Error() << "At least one band is required!";
+      return false;
+    }
+
+    if (cellSize<=0.0) {
+      log.Error() << "Cell size must be greater than 0!";
+      return false;
+    }
+
+    if (!wayDataFile ||
+        startObject.GetType()!=refWay ||
+        !wayDataFile->GetByOffset(startObject.GetFileOffset(),
+                                  way)) {
+      log.Error() << "Cannot get start way!";
+      return false;
+    }
+
+    if (!GetStartNodes(profile,
+                       startObject,
+                       startNodeIndex,
+                       targetLon,
+                       targetLat,
+                       startForwardRouteNode,
+                       startBackwardRouteNode,
+                       startForwardNode,
+                       startBackwardNode)) {
+      return false;
+    }
+
+    RNodeRef startNodes[]={startForwardNode,startBackwardNode};
+
+    for (const auto& startNode : startNodes) {
+      if (!startNode) {
+        continue;
+      }
+
+      RNode node=*startNode;
+
+      // Plain Dijkstra, we do not use an estimate
+      node.estimateCost=0.0;
+      node.overallCost=node.currentCost;
+
+      ReachabilitySegment segment;
+
+      segment.from=way->nodes[startNodeIndex];
+      segment.to=node.node->coord;
+      segment.fromCosts=0.0;
+      segment.costs=node.currentCost;
+
+      segments.push_back(segment);
+
+      auto entry=pool.slots.find(node.nodeOffset);
+
+      if (entry!=pool.slots.end()) {
+        if (node.currentCost<pool.nodes[entry->second].currentCost) {
+          pool.nodes[entry->second]=node;
+          openList.DecreaseKey(entry->second);
+        }
+
+        continue;
+      }
+
+      openList.Push(pool.Add(node));
+    }
+
+    while (!openList.Empty() &&
+           pool.nodes[openList.Top()].currentCost<=maxCost) {
+      size_t currentSlot=openList.Pop();
+
+      pool.closed[currentSlot]=true;
+
+      // Copy, since adding new nodes to the pool invalidates references
+      RNode current=pool.nodes[currentSlot];
+
+      RoutingReachability::Node reachableNode;
+
+      reachableNode.routeNodeOffset=current.nodeOffset;
+      reachableNode.coord=current.node->coord;
+      reachableNode.costs=current.currentCost;
+
+      reachability.nodes.push_back(reachableNode);
+
+      if (!RelaxPaths(profile,
+                      visitor,
+                      pool,
+                      openList,
+                      current,
+                      statistics)) {
+        return false;
+      }
+    }
+
+    CalculateReachabilityBands(segments,
+                               maxCost,
+                               bandCount,
+                               cellSize,
+                               reachability);
+
+    clock.Stop();
+
+    if (debugPerformance) {
+      std::cout << "Reachability:        " << maxCost << " in " << bandCount << " band(s)" << std::endl;
+      std::cout << "Time:                " << clock << std::endl;
+      std::cout << "Route nodes settled: " << reachability.nodes.size() << std::endl;
+      std::cout << "Route nodes loaded:  " << pool.nodes.size() << std::endl;
+      std::cout << "Segments:            " << segments.size() << std::endl;
+    }
+
+    return true;
+  }
+
+  /**
+   * Calculate the reachable area for the given start position, see the other
+   * variant of CalculateReachability() for details.
+   *
+   * @param radius
+   *    Maximum distance of the start position to the closest routable node
+   */
+  bool RoutingService::CalculateReachability(const RoutingProfile& profile,
+                                             double radius,
+                                             const GeoCoord& start,
+                                             double maxCost,
+                                             size_t bandCount,
+                                             double cellSize,
+                                             RoutingReachability& reachability)
+  {
+    ObjectFileRef object;
+    size_t        nodeIndex;
+
+    if (!GetClosestRoutableNode(start.GetLat(),
+                                start.GetLon(),
+                                vehicle,
+                                radius,
+                                object,
+                                nodeIndex)) {
+      return false;
+    }
+
+    if (!object.Valid()) {
+      log.Error() << "Start position cannot be mapped to the routing graph";
+      return false;
+    }
+
+    return CalculateReachability(profile,
+                                 object,
+                                 nodeIndex,
+                                 maxCost,
+                                 bandCount,
+                                 cellSize,
+                                 reachability);
+  }
+
+  /**
+   * Checks if the path with the given index can be used coming from the
+   * given current RNode (taking the previous node, access restrictions,
+   * the profile and turn restrictions into account).
+   */
+  bool RoutingService::CanUsePath(const RoutingProfile& profile,
+                                  const RNode& current,
+                                  size_t pathIndex) const
+  {
+    const RouteNode&       routeNode=*current.node;
+    const RouteNode::Path& path=routeNode.paths[pathIndex];
+
+    // Skipping route back to the last node visited
+    if (path.offset==current.prev) {
+#if defined(DEBUG_ROUTING)
+      std::cout << "  Skipping route";
+      std::cout << " to " << path.offset;
+      std::cout << " (" << routeNode.objects[path.objectIndex].object.GetTypeName() << " " << routeNode.objects[path.objectIndex].object.GetFileOffset() << ")";
+      std::cout << " => back to the last node visited" << std::endl;
+#endif
+      return false;
+    }
+
+    // Moving from non-accessible way back to accessible way is not allowed
+    if (!current.access &&
+        path.HasAccess()) {
+#if defined(DEBUG_ROUTING)
+      std::cout << "  Skipping route";
+      std::cout << " to " << path.offset;
+      std::cout << " (" << routeNode.objects[path.objectIndex].object.GetTypeName() << " " << routeNode.objects[path.objectIndex].object.GetFileOffset() << ")";
+      std::cout << " => moving from non-accessible way back to accessible way" << std::endl;
+#endif
+      return false;
+    }
+
+    if (!profile.CanUse(routeNode,objectVariantData,pathIndex)) {
+#if defined(DEBUG_ROUTING)
+      std::cout << "  Skipping route";
+      std::cout << " to " << path.offset;
+      std::cout << " (" << routeNode.objects[path.objectIndex].object.GetTypeName() << " " << routeNode.objects[path.objectIndex].object.GetFileOffset() << ")";
+      std::cout << " => Cannot be used"<< std::endl;
+#endif
+      return false;
+    }
+
+    for (const auto& exclude : routeNode.excludes) {
+      if (exclude.source==current.object &&
+          exclude.targetIndex==pathIndex) {
+#if defined(DEBUG_ROUTING)
+        std::cout << "  Skipping route";
+        std::cout << " to " << path.offset;
+        std::cout << " (" << routeNode.objects[path.objectIndex].object.GetTypeName() << " " << routeNode.objects[path.objectIndex].object.GetFileOffset() << ")";
+        std::cout << " => turn not allowed" << std::endl;
+#endif
+        // Turn not allowed
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * A* search using a std::set as open list and individually allocated RNodes.
+   *
+   * @return
+   *    False on error, else true. If no route could be found, nodes is empty.
+   */
+  bool RoutingService::SearchRouteUsingSet(const RoutingProfile& profile,
+                                           const RNodeRef& startForwardNode,
+                                           const RNodeRef& startBackwardNode,
+                                           double targetLon,
+                                           double targetLat,
+                                           const RouteNodeRef& targetForwardRouteNode,
+                                           const RouteNodeRef& targetBackwardRouteNode,
+                                           std::list<RNodeRef>& nodes,
+                                           RoutingStatistics& statistics)
+  {
+    // Sorted list (smallest cost first) of ways to check (we are using a std::set)
+    OpenList     openList;
+    // Map routing nodes by id
+    OpenMap      openMap;
+    CloseMap     closeMap;
+
+    openMap.reserve(10000);
+    closeMap.reserve(300000);
+
+    if (startForwardNode) {
+      std::pair<OpenListRef,bool> result=openList.insert(startForwardNode);
+
+      openMap[startForwardNode->nodeOffset]=result.first;
+    }
+
+    if (startBackwardNode) {
+      std::pair<OpenListRef,bool> result=openList.insert(startBackwardNode);
+
+      openMap[startBackwardNode->nodeOffset]=result.first;
+    }
+
+    RNodeRef     current;
+    RouteNodeRef currentRouteNode;
+
+    do {
+      //
+      // Take entry from open list with lowest cost
+      //
+
+      current=*openList.begin();
+
+      openMap.erase(current->nodeOffset);
+      openList.erase(openList.begin());
+
+      currentRouteNode=current->node;
+
+      statistics.nodesLoadedCount++;
+
+      // Get potential follower in the current way
+
+#if defined(DEBUG_ROUTING)
+      std::cout << "Analysing follower of node " << currentRouteNode->GetFileOffset();
+      std::cout << " (" << current->object.GetTypeName() << " " << current->object.GetFileOffset() << "["  << currentRouteNode->GetId() << "]" << ")";
+      std::cout << " " << current->currentCost << " " << current->estimateCost << " " << current->overallCost << std::endl;
+#endif
+      for (size_t i=0; i<currentRouteNode->paths.size(); i++) {
+        const RouteNode::Path& path=currentRouteNode->paths[i];
+
+        if (closeMap.find(path.offset)!=closeMap.end()) {
+#if defined(DEBUG_ROUTING)
+          std::cout << "  Skipping route";
+          std::cout << " to " << path.offset;
+          std::cout << " (" << currentRouteNode->objects[path.objectIndex].object.GetTypeName() << " " << currentRouteNode->objects[path.objectIndex].object.GetFileOffset() << ")";
+          std::cout << " => already calculated" << std::endl;
+#endif
+          continue;
+        }
+
+        if (!CanUsePath(profile,
+                        *current,
+                        i)) {
+          statistics.nodesIgnoredCount++;
+          continue;
+        }
+
+        double currentCost=current->currentCost+
+                           profile.GetCosts(*currentRouteNode,objectVariantData,i);
+
+        OpenMap::iterator openEntry=openMap.find(path.offset);
+
+        // Check, if we already have a cheaper path to the new node. If yes, do not put the new path
+        // into the open list
+        if (openEntry!=openMap.end() &&
+            (*openEntry->second)->currentCost<=currentCost) {
+#if defined(DEBUG_ROUTING)
+          std::cout << "  Skipping route";
+          std::cout << " to " << path.offset;
+          std::cout << " (" << currentRouteNode->objects[path.objectIndex].object.GetTypeName() << " " << currentRouteNode->objects[path.objectIndex].object.GetFileOffset() << ")";
+          std::cout << "  => cheaper route exists " << currentCost << "<=>" << (*openEntry->second)->currentCost << std::endl;
+#endif
+          continue;
+        }
+
+        RouteNodeRef nextNode;
+
+        if (openEntry!=openMap.end()) {
+          nextNode=(*openEntry->second)->node;
+        }
+        else {
+          if (!routeNodeDataFile.GetByOffset(path.offset,
+                                             nextNode)) {
+            log.Error() << "Cannot load route node with id " << path.offset;
+            return false;
+          }
+        }
+
+        double distanceToTarget=GetSphericalDistance(nextNode->coord.GetLon(),
+                                                     nextNode->coord.GetLat(),
+                                                     targetLon,
+                                                     targetLat);
+        // Estimate costs for the rest of the distance to the target
+        double estimateCost=profile.GetCosts(distanceToTarget);
+        double overallCost=currentCost+estimateCost;
+
+        // If we already have the node in the open list, but the new path is cheaper,
+        // update the existing entry
+        if (openEntry!=openMap.end()) {
+          RNodeRef node=*openEntry->second;
+
+          node->prev=current->nodeOffset;
+          node->object=currentRouteNode->objects[path.objectIndex].object;
+
+          node->currentCost=currentCost;
+          node->estimateCost=estimateCost;
+          node->overallCost=overallCost;
+          node->access=path.HasAccess();
+
+#if defined(DEBUG_ROUTING)
+          std::cout << "  Updating route " << current->nodeOffset << " via " << node->object.GetTypeName() << " " << node->object.GetFileOffset() << " " << currentCost << " " << estimateCost << " " << overallCost << " " << currentRouteNode->id << std::endl;
+#endif
+
+          openList.erase(openEntry->second);
+
+          std::pair<OpenListRef,bool> result=openList.insert(node);
+          openEntry->second=result.first;
+        }
+        else {
+          RNodeRef node=std::make_shared<RNode>(path.offset,
+                                                nextNode,
+                                                currentRouteNode->objects[path.objectIndex].object,
+                                                current->nodeOffset);
+
+          node->currentCost=currentCost;
+          node->estimateCost=estimateCost;
+          node->overallCost=overallCost;
+          node->access=path.HasAccess();
+
+#if defined(DEBUG_ROUTING)
+          std::cout << "  Inserting route to " << path.offset;
+          std::cout <<  " (" << node->object.GetTypeName() << " " << node->object.GetFileOffset() << ")";
+          std::cout << " " << currentCost << " " << estimateCost << " " << overallCost << " " << currentRouteNode->id << std::endl;
+#endif
+
+          std::pair<OpenListRef,bool> result=openList.insert(node);
           openMap[node->nodeOffset]=result.first;
         }
+      }
+
+      //
+      // Added current node to close map
+      //
+
+      closeMap[current->nodeOffset]=current;
+      current->node=NULL;
+
+      statistics.maxOpenList=std::max(statistics.maxOpenList,openMap.size());
+      statistics.maxCloseMap=std::max(statistics.maxCloseMap,closeMap.size());
+    } while (!openList.empty() &&
+             (!targetForwardRouteNode || current->nodeOffset!=targetForwardRouteNode->fileOffset) &&
+             (!targetBackwardRouteNode || current->nodeOffset!=targetBackwardRouteNode->fileOffset));
+
+#if defined(DEBUG_ROUTING)
+    if (openList.empty()) {
+      std::cout << "No more alternatives, stopping" << std::endl;
+    }
+
+    if ((targetForwardRouteNode && current->nodeOffset==targetForwardRouteNode->fileOffset)) {
+      std::cout << "Reached target: " << current->nodeOffset << " == " << targetForwardRouteNode->fileOffset << " (forward)" << std::endl;
+    }
+
+    if (targetBackwardRouteNode && current->nodeOffset==targetBackwardRouteNode->fileOffset) {
+      std::cout << "Reached target: " << current->nodeOffset << " == " << targetBackwardRouteNode->fileOffset << " (backward)" << std::endl;
+    }
+#endif
+
+    if (!((targetForwardRouteNode && currentRouteNode->GetId()==targetForwardRouteNode->id) ||
+          (targetBackwardRouteNode && currentRouteNode->GetId()==targetBackwardRouteNode->id))) {
+      return true;
+    }
+
+    ResolveRNodeChainToList(current,
+                            closeMap,
+                            nodes);
+
+    return true;
+  }
+
+  /**
+   * A* search using an indexed heap with decrease-key as open list and a pool
+   * of RNodes addressed by slot numbers. In contrast to SearchRouteUsingSet()
+   * no memory is allocated per visited route node (besides the route node itself).
+   *
+   * @return
+   *    False on error, else true. If no route could be found, nodes is empty.
+   */
+  bool RoutingService::SearchRouteUsingHeap(const RoutingProfile& profile,
+                                            const RNodeRef& startForwardNode,
+                                            const RNodeRef& startBackwardNode,
+                                            double targetLon,
+                                            double targetLat,
+                                            const RouteNodeRef& targetForwardRouteNode,
+                                            const RouteNodeRef& targetBackwardRouteNode,
+                                            std::list<RNodeRef>& nodes,
+                                            RoutingStatistics& statistics)
+  {
+    RNodePool                         pool;
+    IndexedHeap<RNodeSlotCostCompare> openList(RNodeSlotCostCompare(pool.nodes));
+    AStarRelaxVisitor                 visitor(routeNodeDataFile,
+                                              profile,
+                                              targetLon,
+                                              targetLat);
+    size_t                            closedCount=0;
+
+    pool.Reserve(300000);
+    openList.Reserve(300000);
+
+    if (startForwardNode) {
+      openList.Push(pool.Add(*startForwardNode));
+    }
+
+    if (startBackwardNode &&
+        (!startForwardNode ||
+         startBackwardNode->nodeOffset!=startForwardNode->nodeOffset)) {
+      openList.Push(pool.Add(*startBackwardNode));
+    }
+
+    bool   targetReached=false;
+    size_t currentSlot=0;
+
+    while (!openList.Empty()) {
+      //
+      // Take entry from open list with lowest cost
+      //
+
+      currentSlot=openList.Pop();
+      pool.closed[currentSlot]=true;
+      closedCount++;
+
+      // Copy, since adding new nodes to the pool invalidates references
+      RNode current=pool.nodes[currentSlot];
+
+      statistics.nodesLoadedCount++;
+
+      if ((targetForwardRouteNode && current.nodeOffset==targetForwardRouteNode->fileOffset) ||
+          (targetBackwardRouteNode && current.nodeOffset==targetBackwardRouteNode->fileOffset)) {
+        targetReached=true;
+        break;
+      }
+
+      if (!RelaxPaths(profile,
+                      visitor,
+                      pool,
+                      openList,
+                      current,
+                      statistics)) {
+        return false;
+      }
+
+      // We do not need the route node anymore
+      pool.nodes[currentSlot].node=NULL;
+
+      statistics.maxOpenList=std::max(statistics.maxOpenList,openList.Size());
+      statistics.maxCloseMap=std::max(statistics.maxCloseMap,closedCount);
+    }
+
+#if defined(DEBUG_ROUTING)
+    if (!targetReached) {
+      std::cout << "No more alternatives, stopping" << std::endl;
+    }
+    else if (targetForwardRouteNode && pool.nodes[currentSlot].nodeOffset==targetForwardRouteNode->fileOffset) {
+      std::cout << "Reached target: " << pool.nodes[currentSlot].nodeOffset << " == " << targetForwardRouteNode->fileOffset << " (forward)" << std::endl;
+    }
+    else {
+      std::cout << "Reached target: " << pool.nodes[currentSlot].nodeOffset << " == " << targetBackwardRouteNode->fileOffset << " (backward)" << std::endl;
+    }
+#endif
+
+    if (!targetReached) {
+      return true;
+    }
+
+    // Resolve the chain of RNodes from the target back to the start
+    size_t slot=currentSlot;
+
+    while (true) {
+      const RNode& node=pool.nodes[slot];
+
+      nodes.push_front(std::make_shared<RNode>(node));
+
+      if (node.prev==0) {
+        break;
+      }
+
+      slot=pool.slots[node.prev];
+    }
+
+    return true;
+  }
+
+  /**
+   * Return the index of the path in routeNode, that leads to targetNode via the given object.
+   *
+   * @return
+   *    True, if such a path was found, else false
+   */
+  bool RoutingService::FindReversePath(const RouteNode& routeNode,
+                                       const RouteNode& targetNode,
+                                       const ObjectFileRef& object,
+                                       size_t& pathIndex) const
+  {
+    for (size_t i=0; i<routeNode.paths.size(); i++) {
+      const RouteNode::Path& path=routeNode.paths[i];
+
+      if (path.offset==targetNode.GetFileOffset() &&
+          routeNode.objects[path.objectIndex].object==object) {
+        pathIndex=i;
+
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * Checks if the route reaching a node as described by the forward RNode can be continued
+   * by the route leaving the same node as described by the backward RNode (which uses
+   * the path with the given index).
+   */
+  bool RoutingService::CanConnect(const RNode& forward,
+                                  const RNode& backward,
+                                  size_t backwardPathIndex) const
+  {
+    // The backward RNode is one of the target nodes
+    if (backward.prev==0) {
+      return true;
+    }
+
+    // Going back to the node we came from
+    if (forward.prev!=0 &&
+        forward.prev==backward.prev) {
+      return false;
+    }
+
+    // Moving from non-accessible way back to accessible way
+    if (!forward.access &&
+        backward.access) {
+      return false;
+    }
+
+    for (const auto& exclude : forward.node->excludes) {
+      if (exclude.source==forward.object &&
+          exclude.targetIndex==backwardPathIndex) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Bidirectional A* search. The forward search expands from the start nodes, the backward search
+   * expands over the reversed paths from the target nodes. Both use the average of the
+   * estimates to the target and to the start as (consistent) potential, thus the search
+   * can stop as soon as the sum of the smallest keys of both open lists is not
+   * smaller than the costs of the best route found so far.
+   *
+   * The backward search requires a routing graph, that also contains paths against
+   * the direction of oneways (flagged as not usable).
+   *
+   * @return
+   *    False on error, else true. If no route could be found, nodes is empty.
+   */
+  bool RoutingService::SearchRouteBidirectional(const RoutingProfile& profile,
+                                                const RNodeRef& startForwardNode,
+                                                const RNodeRef& startBackwardNode,
+                                                double targetLon,
+                                                double targetLat,
+                                                const RouteNodeRef& targetForwardRouteNode,
+                                                const RouteNodeRef& targetBackwardRouteNode,
+                                                std::list<RNodeRef>& nodes,
+                                                RoutingStatistics& statistics)
+  {
+    const size_t                      noPath=std::numeric_limits<size_t>::max();
+
+    RNodePool                         forwardPool;
+    IndexedHeap<RNodeSlotCostCompare> forwardOpenList(RNodeSlotCostCompare(forwardPool.nodes));
+    RNodePool                         backwardPool;
+    std::vector<size_t>               backwardPathIndexes; //!< Per backward slot the index of the path leading towards the target
+    IndexedHeap<RNodeSlotCostCompare> backwardOpenList(RNodeSlotCostCompare(backwardPool.nodes));
+    size_t                            closedCount=0;
+
+    double                            bestCost=std::numeric_limits<double>::max();
+    size_t                            bestForwardSlot=0;
+    size_t                            bestBackwardSlot=0;
+    bool                              found=false;
+
+    const RNodeRef&                   startNode=startForwardNode ? startForwardNode : startBackwardNode;
+    double                            startLon=startNode->node->coord.GetLon();
+    double                            startLat=startNode->node->coord.GetLat();
+    BidirectionalRelaxVisitor         forwardVisitor(routeNodeDataFile,
+                                                     profile,
+                                                     startLon,
+                                                     startLat,
+                                                     targetLon,
+                                                     targetLat,
+                                                     true);
+    BidirectionalRelaxVisitor         backwardVisitor(routeNodeDataFile,
+                                                      profile,
+                                                      startLon,
+                                                      startLat,
+                                                      targetLon,
+                                                      targetLat,
+                                                      false);
+
+    forwardPool.Reserve(100000);
+    forwardOpenList.Reserve(100000);
+    backwardPool.Reserve(100000);
+    backwardPathIndexes.reserve(100000);
+    backwardOpenList.Reserve(100000);
+
+    //
+    // Initialize forward search with the start nodes
+    //
+
+    for (const auto& start : {startForwardNode,startBackwardNode}) {
+      if (!start ||
+          forwardPool.slots.find(start->nodeOffset)!=forwardPool.slots.end()) {
+        continue;
+      }
+
+      RNode node(*start);
+
+      node.estimateCost=forwardVisitor.GetEstimateCost(*node.node);
+      node.overallCost=node.currentCost+node.estimateCost;
+
+      forwardOpenList.Push(forwardPool.Add(node));
+    }
+
+    //
+    // Initialize backward search with the target nodes
+    //
+
+    for (const auto& target : {targetForwardRouteNode,targetBackwardRouteNode}) {
+      if (!target ||
+          backwardPool.slots.find(target->GetFileOffset())!=backwardPool.slots.end()) {
+        continue;
+      }
+
+      RNode node(target->GetFileOffset(),
+                 target,
+                 ObjectFileRef());
+
+      node.estimateCost=backwardVisitor.GetEstimateCost(*target);
+      node.overallCost=node.estimateCost;
+
+      backwardOpenList.Push(backwardPool.Add(node));
+      backwardPathIndexes.push_back(noPath);
+
+      // Start and target might be the same
+      std::unordered_map<FileOffset,size_t>::const_iterator forwardEntry=forwardPool.slots.find(node.nodeOffset);
+
+      if (forwardEntry!=forwardPool.slots.end() &&
+          forwardPool.nodes[forwardEntry->second].currentCost<bestCost) {
+        bestCost=forwardPool.nodes[forwardEntry->second].currentCost;
+        bestForwardSlot=forwardEntry->second;
+        bestBackwardSlot=backwardPool.nodes.size()-1;
+        found=true;
+      }
+    }
+
+    while (!forwardOpenList.Empty() &&
+           !backwardOpenList.Empty()) {
+      double forwardMin=forwardPool.nodes[forwardOpenList.Top()].overallCost;
+      double backwardMin=backwardPool.nodes[backwardOpenList.Top()].overallCost;
+
+      // No shorter route possible
+      if (found &&
+          forwardMin+backwardMin>=bestCost) {
+        break;
+      }
+
+      statistics.nodesLoadedCount++;
+      closedCount++;
+
+      // Always expand the smaller search
+      if (forwardOpenList.Size()<=backwardOpenList.Size()) {
+        size_t currentSlot=forwardOpenList.Pop();
+
+        forwardPool.closed[currentSlot]=true;
+
+        // Copy, since adding new nodes to the pool invalidates references
+        RNode current=forwardPool.nodes[currentSlot];
+
+        forwardVisitor.improvedSlots.clear();
+
+        if (!RelaxPaths(profile,
+                        forwardVisitor,
+                        forwardPool,
+                        forwardOpenList,
+                        current,
+                        statistics)) {
+          return false;
+        }
 
-        i++;
+        // Check, if we meet the backward search
+        for (const auto slot : forwardVisitor.improvedSlots) {
+          const RNode&                                          forwardNode=forwardPool.nodes[slot];
+          std::unordered_map<FileOffset,size_t>::const_iterator backwardEntry=backwardPool.slots.find(forwardNode.nodeOffset);
+
+          if (backwardEntry!=backwardPool.slots.end()) {
+            const RNode& backwardNode=backwardPool.nodes[backwardEntry->second];
+
+            if (forwardNode.currentCost+backwardNode.currentCost<bestCost &&
+                CanConnect(forwardNode,
+                           backwardNode,
+                           backwardPathIndexes[backwardEntry->second])) {
+              bestCost=forwardNode.currentCost+backwardNode.currentCost;
+              bestForwardSlot=slot;
+              bestBackwardSlot=backwardEntry->second;
+              found=true;
+            }
+          }
+        }
       }
+      else {
+        size_t currentSlot=backwardOpenList.Pop();
+
+        backwardPool.closed[currentSlot]=true;
+
+        // Copy, since adding new nodes to the pool invalidates references
+        RNode        current=backwardPool.nodes[currentSlot];
+        size_t       currentPathIndex=backwardPathIndexes[currentSlot];
+        RouteNodeRef currentRouteNode=current.node;
+
+        for (size_t i=0; i<currentRouteNode->paths.size(); i++) {
+          const RouteNode::Path&                          path=currentRouteNode->paths[i];
+          const ObjectFileRef&                            object=currentRouteNode->objects[path.objectIndex].object;
+          std::unordered_map<FileOffset,size_t>::iterator slotEntry=backwardPool.slots.find(path.offset);
+          RouteNodeRef                                    prevNode;
+          size_t                                          reversePathIndex;
+          size_t                                          slot;
+          bool                                            improved;
+
+          if (path.offset==current.prev) {
+            statistics.nodesIgnoredCount++;
+            continue;
+          }
 
-      //
-      // Added current node to close map
-      //
+          if (slotEntry!=backwardPool.slots.end()) {
+            if (backwardPool.closed[slotEntry->second]) {
+              continue;
+            }
 
-      closeMap[current->nodeOffset]=current;
-      current->node=NULL;
+            prevNode=backwardPool.nodes[slotEntry->second].node;
+          }
+          else if (!backwardVisitor.LoadRouteNode(path.offset,
+                                                  prevNode)) {
+            return false;
+          }
 
-      maxOpenList=std::max(maxOpenList,openMap.size());
-      maxCloseMap=std::max(maxCloseMap,closeMap.size());
+          // We need the path from the previous node to the current node
+          if (!FindReversePath(*prevNode,
+                               *currentRouteNode,
+                               object,
+                               reversePathIndex) ||
+              !profile.CanUse(*prevNode,objectVariantData,reversePathIndex)) {
+            statistics.nodesIgnoredCount++;
+            continue;
+          }
 
-#if defined(DEBUG_ROUTING)
-      if (openList.empty()) {
-        std::cout << "No more alternatives, stopping" << std::endl;
+          const RouteNode::Path& reversePath=prevNode->paths[reversePathIndex];
+
+          if (currentPathIndex!=noPath) {
+            bool canTurnInto=true;
+
+            // Moving from non-accessible way back to accessible way
+            if (!reversePath.HasAccess() &&
+                current.access) {
+              canTurnInto=false;
+            }
+
+            for (const auto& exclude : currentRouteNode->excludes) {
+              if (exclude.source==object &&
+                  exclude.targetIndex==currentPathIndex) {
+                canTurnInto=false;
+                break;
+              }
+            }
+
+            if (!canTurnInto) {
+              statistics.nodesIgnoredCount++;
+              continue;
+            }
+          }
+
+          double currentCost=current.currentCost+
+                             profile.GetCosts(*prevNode,objectVariantData,reversePathIndex);
+
+          if (!RelaxRNode(backwardVisitor,
+                          backwardPool,
+                          backwardOpenList,
+                          current,
+                          path.offset,
+                          prevNode,
+                          object,
+                          currentCost,
+                          reversePath.HasAccess(),
+                          slot,
+                          improved)) {
+            return false;
+          }
+
+          if (!improved) {
+            continue;
+          }
+
+          if (slot<backwardPathIndexes.size()) {
+            backwardPathIndexes[slot]=reversePathIndex;
+          }
+          else {
+            backwardPathIndexes.push_back(reversePathIndex);
+          }
+
+          // Check, if we meet the forward search
+          std::unordered_map<FileOffset,size_t>::const_iterator forwardEntry=forwardPool.slots.find(path.offset);
+
+          if (forwardEntry!=forwardPool.slots.end()) {
+            const RNode& forwardNode=forwardPool.nodes[forwardEntry->second];
+            const RNode& backwardNode=backwardPool.nodes[slot];
+
+            if (forwardNode.currentCost+backwardNode.currentCost<bestCost &&
+                CanConnect(forwardNode,
+                           backwardNode,
+                           backwardPathIndexes[slot])) {
+              bestCost=forwardNode.currentCost+backwardNode.currentCost;
+              bestForwardSlot=forwardEntry->second;
+              bestBackwardSlot=slot;
+              found=true;
+            }
+          }
+        }
+      }
+
+      statistics.maxOpenList=std::max(statistics.maxOpenList,forwardOpenList.Size()+backwardOpenList.Size());
+      statistics.maxCloseMap=std::max(statistics.maxCloseMap,closedCount);
+    }
+
+    if (!found) {
+      return true;
+    }
+
+    // Resolve the chain of RNodes from the meeting node back to the start
+    size_t slot=bestForwardSlot;
+
+    while (true) {
+      const RNode& node=forwardPool.nodes[slot];
+
+      nodes.push_front(std::make_shared<RNode>(node));
+
+      if (node.prev==0) {
+        break;
+      }
+
+      slot=forwardPool.slots[node.prev];
+    }
+
+    // ...and from the meeting node forward to the target
+    slot=bestBackwardSlot;
+
+    while (backwardPool.nodes[slot].prev!=0) {
+      const RNode& node=backwardPool.nodes[slot];
+
+      nodes.push_back(std::make_shared<RNode>(node.prev,
+                                              RouteNodeRef(),
+                                              node.object,
+                                              node.nodeOffset));
+
+      slot=backwardPool.slots[node.prev];
+    }
+
+    return true;
+  }
+
+  /**
+   * Bidirectional Dijkstra search in the contraction hierarchy. The forward search
+   * only follows edges to nodes with higher rank, the backward search only follows
+   * edges from nodes with higher rank. The route is the cheapest combination of
+   * both searches at a common node. Shortcuts on the route are unpacked to the
+   * paths of the routing graph.
+   *
+   * Paths without access rights are not part of the contraction hierarchy.
+   *
+   * @return
+   *    False on error, else true. If no route could be found, nodes is empty.
+   */
+  bool RoutingService::SearchRouteContractionHierarchy(const RNodeRef& startForwardNode,
+                                                       const RNodeRef& startBackwardNode,
+                                                       const RouteNodeRef& targetForwardRouteNode,
+                                                       const RouteNodeRef& targetBackwardRouteNode,
+                                                       std::list<RNodeRef>& nodes,
+                                                       RoutingStatistics& statistics)
+  {
+    static const size_t npos=std::numeric_limits<size_t>::max();
+
+    CHLabelPool                     forwardPool;
+    CHLabelPool                     backwardPool;
+    IndexedHeap<CHLabelCostCompare> forwardOpenList(CHLabelCostCompare(forwardPool.labels));
+    IndexedHeap<CHLabelCostCompare> backwardOpenList(CHLabelCostCompare(backwardPool.labels));
+    size_t                          closedCount=0;
+
+    RNodeRef startNodes[]={startForwardNode,startBackwardNode};
+
+    for (const auto& startNode : startNodes) {
+      uint32_t index;
+
+      if (!startNode ||
+          !contractionHierarchy.GetNodeIndex(startNode->nodeOffset,index)) {
+        continue;
+      }
+
+      auto entry=forwardPool.slots.find(index);
+
+      if (entry!=forwardPool.slots.end()) {
+        CHLabel& label=forwardPool.labels[entry->second];
+
+        if (startNode->currentCost<label.cost) {
+          label.cost=startNode->currentCost;
+          label.object=startNode->object;
+          forwardOpenList.DecreaseKey(entry->second);
+        }
+
+        continue;
       }
 
-      if ((targetForwardRouteNode && current->nodeOffset==targetForwardRouteNode->fileOffset)) {
-        std::cout << "Reached target: " << current->nodeOffset << " == " << targetForwardRouteNode->fileOffset << " (forward)" << std::endl;
+      forwardOpenList.Push(forwardPool.Add(CHLabel{index,startNode->currentCost,npos,NULL,startNode->object,false}));
+    }
+
+    RouteNodeRef targetNodes[]={targetForwardRouteNode,targetBackwardRouteNode};
+
+    for (const auto& targetNode : targetNodes) {
+      uint32_t index;
+
+      if (!targetNode ||
+          !contractionHierarchy.GetNodeIndex(targetNode->fileOffset,index) ||
+          backwardPool.slots.find(index)!=backwardPool.slots.end()) {
+        continue;
       }
 
-      if (targetBackwardRouteNode && current->nodeOffset==targetBackwardRouteNode->fileOffset) {
-        std::cout << "Reached target: " << current->nodeOffset << " == " << targetBackwardRouteNode->fileOffset << " (backward)" << std::endl;
+      backwardOpenList.Push(backwardPool.Add(CHLabel{index,0.0,npos,NULL,ObjectFileRef(),false}));
+    }
+
+    double bestCost=std::numeric_limits<double>::max();
+    size_t bestForwardSlot=npos;
+    size_t bestBackwardSlot=npos;
+
+    while (!forwardOpenList.Empty() ||
+           !backwardOpenList.Empty()) {
+      double forwardMin=forwardOpenList.Empty() ? std::numeric_limits<double>::max() : forwardPool.labels[forwardOpenList.Top()].cost;
+      double backwardMin=backwardOpenList.Empty() ? std::numeric_limits<double>::max() : backwardPool.labels[backwardOpenList.Top()].cost;
+
+      // Neither search can find a cheaper connection anymore
+      if (std::min(forwardMin,backwardMin)>=bestCost) {
+        break;
       }
-#endif
-    } while (!openList.empty() &&
-             (!targetForwardRouteNode || current->nodeOffset!=targetForwardRouteNode->fileOffset) &&
-             (!targetBackwardRouteNode || current->nodeOffset!=targetBackwardRouteNode->fileOffset));
+
+      bool          forward=forwardMin<=backwardMin;
+      CHLabelPool&  pool=forward ? forwardPool : backwardPool;
+      CHLabelPool&  otherPool=forward ? backwardPool : forwardPool;
+      size_t        slot=forward ? forwardOpenList.Pop() : backwardOpenList.Pop();
+
+      pool.labels[slot].settled=true;
+      closedCount++;
+      statistics.nodesLoadedCount++;
+
+      // Copy, since adding new labels to the pool invalidates references
+      CHLabel       current=pool.labels[slot];
+      const CHNode& node=contractionHierarchy.GetNode(current.node);
+
+      // Check, if we can connect to the other search at the current node
+      auto otherEntry=otherPool.slots.find(current.node);
+
+      if (otherEntry!=otherPool.slots.end()) {
+        const CHLabel& other=otherPool.labels[otherEntry->second];
+        const CHLabel& forwardLabel=forward ? current : other;
+        const CHLabel& backwardLabel=forward ? other : current;
+
+        if (current.cost+other.cost<bestCost &&
+            (backwardLabel.edge==NULL ||
+             !node.IsTurnForbidden(forwardLabel.GetArrivalObject(),*backwardLabel.edge))) {
+          bestCost=current.cost+other.cost;
+          bestForwardSlot=forward ? slot : otherEntry->second;
+          bestBackwardSlot=forward ? otherEntry->second : slot;
+        }
+      }
+
+      const std::vector<CHEdge>& edges=forward ? node.upEdges : node.downEdges;
+
+      for (const auto& edge : edges) {
+        if (!node.excludes.empty()) {
+          if (forward &&
+              node.IsTurnForbidden(current.GetArrivalObject(),edge)) {
+            statistics.nodesIgnoredCount++;
+            continue;
+          }
+
+          if (!forward &&
+              current.edge!=NULL &&
+              node.IsTurnForbidden(edge.lastObject,*current.edge)) {
+            statistics.nodesIgnoredCount++;
+            continue;
+          }
+        }
+
+        double cost=current.cost+edge.GetCosts();
+        auto   entry=pool.slots.find(edge.target);
+
+        if (entry!=pool.slots.end()) {
+          CHLabel& label=pool.labels[entry->second];
+
+          // Check, if we already have a cheaper path to the node
+          if (label.settled ||
+              label.cost<=cost) {
+            continue;
+          }
+
+          label.cost=cost;
+          label.parent=slot;
+          label.edge=&edge;
+
+          if (forward) {
+            forwardOpenList.DecreaseKey(entry->second);
+          }
+          else {
+            backwardOpenList.DecreaseKey(entry->second);
+          }
+        }
+        else {
+          size_t newSlot=pool.Add(CHLabel{edge.target,cost,slot,&edge,ObjectFileRef(),false});
+
+          if (forward) {
+            forwardOpenList.Push(newSlot);
+          }
+          else {
+            backwardOpenList.Push(newSlot);
+          }
+        }
+      }
+
+      statistics.maxOpenList=std::max(statistics.maxOpenList,forwardOpenList.Size()+backwardOpenList.Size());
+      statistics.maxCloseMap=std::max(statistics.maxCloseMap,closedCount);
+    }
+
+    if (bestForwardSlot==npos) {
+      return true;
+    }
+
+    // Collect the edges from the start to the meeting node...
+    std::list<size_t> forwardSlots;
+
+    for (size_t slot=bestForwardSlot; slot!=npos; slot=forwardPool.labels[slot].parent) {
+      forwardSlots.push_front(slot);
+    }
+
+    const CHLabel&             startLabel=forwardPool.labels[forwardSlots.front()];
+    std::vector<uint32_t>      routeNodes;
+    std::vector<ObjectFileRef> objects;
+
+    for (size_t slot : forwardSlots) {
+      const CHLabel& label=forwardPool.labels[slot];
+
+      if (label.edge!=NULL &&
+          !contractionHierarchy.UnpackEdge(forwardPool.labels[label.parent].node,
+                                           label.node,
+                                           *label.edge,
+                                           routeNodes,
+                                           objects)) {
+        return false;
+      }
+    }
+
+    // ...and from the meeting node to the target
+    for (size_t slot=bestBackwardSlot; backwardPool.labels[slot].parent!=npos; slot=backwardPool.labels[slot].parent) {
+      const CHLabel& label=backwardPool.labels[slot];
+
+      if (!contractionHierarchy.UnpackEdge(label.node,
+                                           backwardPool.labels[label.parent].node,
+                                           *label.edge,
+                                           routeNodes,
+                                           objects)) {
+        return false;
+      }
+    }
+
+    FileOffset prev=contractionHierarchy.GetNode(startLabel.node).routeNodeOffset;
+
+    nodes.push_back(std::make_shared<RNode>(prev,
+                                            RouteNodeRef(),
+                                            startLabel.object));
+
+    for (size_t i=0; i<routeNodes.size(); i++) {
+      FileOffset offset=contractionHierarchy.GetNode(routeNodes[i]).routeNodeOffset;
+
+      nodes.push_back(std::make_shared<RNode>(offset,
+                                              RouteNodeRef(),
+                                              objects[i],
+                                              prev));
+
+      prev=offset;
+    }
+
+    return true;
+  }
+
+  /**
+   * Calculate a route
+   *
+   * @param profile
+   *    Profile to use
+   * @param startObject
+   *    Start object
+   * @param startNodeIndex
+   *    Index of the node within the start object used as starting point
+   * @param targetObject
+   *    Target object
+   * @param targetNodeIndex
+   *    Index of the node within the target object used as target point
+   * @param route
+   *    The route object holding the resulting route on success
+   * @return
+   *    True, if the engine was able to find a route, else false
+   */
+  bool RoutingService::CalculateRoute(const RoutingProfile& profile,
+                                      const ObjectFileRef& startObject,
+                                      size_t startNodeIndex,
+                                      const ObjectFileRef& targetObject,
+                                      size_t targetNodeIndex,
+                                      RouteData& route)
+  {
+    RouteNodeRef             startForwardRouteNode;
+    RouteNodeRef             startBackwardRouteNode;
+    RNodeRef                 startForwardNode;
+    RNodeRef                 startBackwardNode;
+
+    double                   targetLon=0.0L;
+    double                   targetLat=0.0L;
+
+    RouteNodeRef             targetForwardRouteNode;
+    RouteNodeRef             targetBackwardRouteNode;
+
+    RoutingStatistics        statistics;
+    std::list<RNodeRef>      nodes;
+
+    route.Clear();
+
+    if (!GetTargetNodes(profile,
+                        targetObject,
+                        targetNodeIndex,
+                        targetLon,
+                        targetLat,
+                        targetForwardRouteNode,
+                        targetBackwardRouteNode)) {
+      return false;
+    }
+
+    if (!GetStartNodes(profile,
+                       startObject,
+                       startNodeIndex,
+                       targetLon,
+                       targetLat,
+                       startForwardRouteNode,
+                       startBackwardRouteNode,
+                       startForwardNode,
+                       startBackwardNode)) {
+      return false;
+    }
+
+    StopClock clock;
+    bool      success=false;
+    bool      contractionHierarchyUsed=false;
+    // The backward search needs the reversed paths of oneways, route graphs
+    // without them fall back to the forward search
+    bool      bidirectional=profile.IsBidirectional() &&
+                            (graphFlags & graphHasReversePaths)!=0;
+
+    if (profile.UseContractionHierarchy() &&
+        CanUseContractionHierarchy(profile)) {
+      success=SearchRouteContractionHierarchy(startForwardNode,
+                                              startBackwardNode,
+                                              targetForwardRouteNode,
+                                              targetBackwardRouteNode,
+                                              nodes,
+                                              statistics);
+
+      // Fall back to the normal search (for example if start or target
+      // are only reachable via paths without access rights)
+      contractionHierarchyUsed=success && !nodes.empty();
+    }
+
+    if (!contractionHierarchyUsed) {
+      if (bidirectional) {
+        success=SearchRouteBidirectional(profile,
+                                         startForwardNode,
+                                         startBackwardNode,
+                                         targetLon,
+                                         targetLat,
+                                         targetForwardRouteNode,
+                                         targetBackwardRouteNode,
+                                         nodes,
+                                         statistics);
+      }
+      else {
+        switch (profile.GetOpenListType()) {
+        case openListHeap:
+          success=SearchRouteUsingHeap(profile,
+                                       startForwardNode,
+                                       startBackwardNode,
+                                       targetLon,
+                                       targetLat,
+                                       targetForwardRouteNode,
+                                       targetBackwardRouteNode,
+                                       nodes,
+                                       statistics);
+          break;
+        case openListSet:
+        default:
+          success=SearchRouteUsingSet(profile,
+                                      startForwardNode,
+                                      startBackwardNode,
+                                      targetLon,
+                                      targetLat,
+                                      targetForwardRouteNode,
+                                      targetBackwardRouteNode,
+                                      nodes,
+                                      statistics);
+          break;
+        }
+      }
+    }
 
     clock.Stop();
 
+    if (!success) {
+      return false;
+    }
+
     if (debugPerformance) {
       std::cout << "From:                " << startObject.GetTypeName() << " " << startObject.GetFileOffset();
       std::cout << "[";
@@ -1432,28 +3637,35 @@ namespace osmscout {
       }
       std::cout << "]" << std::endl;
 
+      if (contractionHierarchyUsed) {
+        std::cout << "Search:              contraction hierarchy" << std::endl;
+      }
+      else if (bidirectional) {
+        std::cout << "Search:              bidirectional, heap" << std::endl;
+      }
+      else {
+        std::cout << "Search:              forward, " << (profile.GetOpenListType()==openListHeap ? "heap" : "set") << std::endl;
+      }
+
       std::cout << "Time:                " << clock << std::endl;
 
-      std::cout << "Route nodes loaded:  " << nodesLoadedCount << std::endl;
-      std::cout << "Route nodes ignored: " << nodesIgnoredCount << std::endl;
-      std::cout << "Max. OpenList size:  " << maxOpenList << std::endl;
-      std::cout << "Max. CloseMap size:  " << maxCloseMap << std::endl;
+      std::cout << "Route nodes loaded:  " << statistics.nodesLoadedCount << std::endl;
+      std::cout << "Route nodes ignored: " << statistics.nodesIgnoredCount << std::endl;
+      std::cout << "Max. OpenList size:  " << statistics.maxOpenList << std::endl;
+      std::cout << "Max. CloseMap size:  " << statistics.maxCloseMap << std::endl;
+
+      if (clock.GetMilliseconds()>0) {
+        std::cout << "Expansion rate:      " << (size_t)(statistics.nodesLoadedCount*1000.0/clock.GetMilliseconds()) << " route nodes/s" << std::endl;
+      }
     }
 
-    if (!((targetForwardRouteNode && currentRouteNode->GetId()==targetForwardRouteNode->id) ||
-          (targetBackwardRouteNode && currentRouteNode->GetId()==targetBackwardRouteNode->id))) {
+    if (nodes.empty()) {
       std::cout << "No route found!" << std::endl;
       route.Clear();
 
       return true;
     }
 
-    std::list<RNodeRef> nodes;
-
-    ResolveRNodeChainToList(current,
-                            closeMap,
-                            nodes);
-
     if (!ResolveRNodesToRouteData(profile,
                                   nodes,
                                   startObject,
@@ -25,11 +25,30 @@
 
 namespace osmscout {
 
+  void TagConditionKeys::Clear()
+  {
+    tags.clear();
+    tagValues.clear();
+  }
+
+  void TagConditionKeys::Insert(const TagConditionKeys& other)
+  {
+    tags.insert(other.tags.begin(),
+                other.tags.end());
+    tagValues.insert(other.tagValues.begin(),
+                     other.tagValues.end());
+  }
+
   TagCondition::~TagCondition()
   {
     // no code
   }
 
+  bool TagCondition::GetRequiredKeys(TagConditionKeys& /*keys*/) const
+  {
+    return false;
+  }
+
   TagNotCondition::TagNotCondition(const TagConditionRef& condition)
   : condition(condition)
   {
@@ -41,6 +60,12 @@ namespace osmscout {
     return !condition->Evaluate(tagMap);
   }
 
+  bool TagNotCondition::GetRequiredKeys(TagConditionKeys& /*keys*/) const
+  {
+    // The negation of a condition is true, if the tags of the condition are missing
+    return false;
+  }
+
   TagBoolCondition::TagBoolCondition(Type type)
   : type(type)
   {
@@ -78,6 +103,45 @@ namespace osmscout {
     }
   }
 
+  bool TagBoolCondition::GetRequiredKeys(TagConditionKeys& keys) const
+  {
+    TagConditionKeys childKeys;
+    bool             found=false;
+
+    keys.Clear();
+
+    switch (type) {
+    case boolAnd:
+      // All child conditions must be true, so the keys of any child condition
+      // are required. We take the smallest set.
+      for (const auto &condition : conditions) {
+        if (condition->GetRequiredKeys(childKeys) &&
+            (!found || childKeys.Size()<keys.Size())) {
+          keys=childKeys;
+          found=true;
+        }
+      }
+
+      return found;
+    case boolOr:
+      // One of the child conditions must be true, so we need the keys of all
+      // child conditions
+      for (const auto &condition : conditions) {
+        if (!condition->GetRequiredKeys(childKeys)) {
+          return false;
+        }
+
+        keys.Insert(childKeys);
+      }
+
+      return true;
+    default:
+      assert(false);
+
+      return false;
+    }
+  }
+
   TagExistsCondition::TagExistsCondition(TagId tag)
   : tag(tag)
   {
@@ -89,6 +153,14 @@ namespace osmscout {
     return tagMap.find(tag)!=tagMap.end();
   }
 
+  bool TagExistsCondition::GetRequiredKeys(TagConditionKeys& keys) const
+  {
+    keys.Clear();
+    keys.tags.insert(tag);
+
+    return true;
+  }
+
   TagBinaryCondition::TagBinaryCondition(TagId tag,
                                          BinaryOperator binaryOperator,
                                          const std::string& tagValue)
@@ -174,6 +246,21 @@ namespace osmscout {
     }
   }
 
+  bool TagBinaryCondition::GetRequiredKeys(TagConditionKeys& keys) const
+  {
+    keys.Clear();
+
+    if (valueType==string &&
+        binaryOperator==operatorEqual) {
+      keys.tagValues.insert(std::make_pair(tag,tagStringValue));
+    }
+    else {
+      keys.tags.insert(tag);
+    }
+
+    return true;
+  }
+
   TagIsInCondition::TagIsInCondition(TagId tag)
   : tag(tag)
   {
@@ -196,6 +283,17 @@ namespace osmscout {
     return tagValues.find(t->second)!=tagValues.end();
   }
 
+  bool TagIsInCondition::GetRequiredKeys(TagConditionKeys& keys) const
+  {
+    keys.Clear();
+
+    for (const auto& tagValue : tagValues) {
+      keys.tagValues.insert(std::make_pair(tag,tagValue));
+    }
+
+    return true;
+  }
+
   TagInfo::TagInfo()
    : id(0)
   {
@@ -1,10 +1,54 @@
 #include <osmscout/TextSearchIndex.h>
 
+#include <algorithm>
+
 #include <osmscout/util/String.h>
 #include <osmscout/util/Logger.h>
 
 namespace osmscout
 {
+  /**
+   * Order of ranked results: lower edit distance first, complete matches
+   * before prefix matches, then by the importance of the kind of object
+   * (regions, locations, POIs, other) and finally shorter texts first.
+   */
+  static bool RankedResultLess(const TextSearchIndex::RankedResult& a,
+                               const TextSearchIndex::RankedResult& b)
+  {
+    static const size_t groupRank[]={2,1,0,3};
+
+    if (a.distance!=b.distance) {
+      return a.distance<b.distance;
+    }
+
+    if (a.isComplete!=b.isComplete) {
+      return a.isComplete;
+    }
+
+    if (a.group!=b.group) {
+      return groupRank[a.group]<groupRank[b.group];
+    }
+
+    if (a.text.length()!=b.text.length()) {
+      return a.text.length()<b.text.length();
+    }
+
+    return a.text<b.text;
+  }
+
+  /**
+   * Order of texts sharing the same prefix: shorter texts first, then
+   * in lexicographic order.
+   */
+  static bool ShorterTextLess(const std::string& a,
+                              const std::string& b)
+  {
+    if (a.length()!=b.length()) {
+      return a.length()<b.length();
+    }
+
+    return a<b;
+  }
 
   TextSearchIndex::TextSearchIndex()
   {
@@ -97,6 +141,36 @@ namespace osmscout
       }
     }
 
+    // Determine the bytes used in the texts of each trie
+    for(size_t i=0; i < tries.size(); i++) {
+      if(tries[i].isAvail) {
+        // The alphabet key starts with the
+        // ASCII control character 0x05: ENQ
+        std::string alphabetQuery;
+        alphabetQuery.push_back(5);
+
+        marisa::Agent agent;
+        agent.set_query(alphabetQuery.c_str(),
+                        alphabetQuery.length());
+
+        if(tries[i].trie->predictive_search(agent)) {
+          tries[i].alphabet.assign(agent.key().ptr()+1,
+                                   agent.key().length()-1);
+        }
+        else {
+          // Text data of older imports does not contain
+          // the alphabet, so we have to try all bytes that
+          // can be part of a text
+          log.Warn() << "No alphabet in " << tries[i].file << ", fuzzy search will be slow";
+
+          tries[i].alphabet.clear();
+          for(size_t c=0x20; c <= 0xff; c++) {
+            tries[i].alphabet.push_back((char)c);
+          }
+        }
+      }
+    }
+
     return true;
   }
 
@@ -161,6 +235,440 @@ namespace osmscout
     return true;
   }
 
+  /**
+   * Search for texts starting with the given query or with a prefix that
+   * has an edit distance (in bytes) of at most maxDistance to the query.
+   *
+   * The tries are traversed like a Levenshtein automaton: a prefix is only
+   * extended, as long as it can still be within maxDistance of the query
+   * and the trie contains texts starting with it. For every prefix within
+   * maxDistance only the best limit texts are retrieved (see
+   * CollectRankedResults). The prefixes are handled in the order of their
+   * distance and the search stops as soon as limit texts have been found,
+   * since texts with a larger distance always rank worse.
+   *
+   * The results are ranked (see RankedResultLess) and the best limit results
+   * are returned. The ranking is exact with respect to RankedResultLess.
+   * Note that the importance of an object is only given by its group
+   * (the trie the text is stored in), there is no further per object weight.
+   *
+   * @param query
+   *    The query, like Search() the search is case-sensitive
+   * @param maxDistance
+   *    The maximum edit distance, 0 for a (ranked) prefix search,
+   *    every additional edit increases the search effort considerably
+   * @param limit
+   *    The maximum number of results
+   * @param results
+   *    The ranked results
+   * @return
+   *    True, if there was no error
+   */
+  bool TextSearchIndex::SearchRanked(const std::string& query,
+                                     bool searchPOIs,
+                                     bool searchLocations,
+                                     bool searchRegions,
+                                     bool searchOther,
+                                     size_t maxDistance,
+                                     size_t limit,
+                                     std::vector<RankedResult>& results) const
+  {
+    results.clear();
+
+    if(query.empty() ||
+       limit==0) {
+      return true;
+    }
+
+    std::vector<bool> searchGroups;
+
+    searchGroups.push_back(searchPOIs);
+    searchGroups.push_back(searchLocations);
+    searchGroups.push_back(searchRegions);
+    searchGroups.push_back(searchOther);
+
+    std::vector<size_t> distances(query.length()+1);
+
+    for(size_t i=0; i < distances.size(); i++) {
+      distances[i]=i;
+    }
+
+    std::vector<std::vector<FuzzyPrefix> >               prefixes(tries.size());
+    std::vector<std::vector<bool> >                      completeOnly(tries.size());
+    std::vector<std::unordered_map<std::string,size_t> > textIndex(tries.size());
+
+    try {
+      for(size_t i=0; i < tries.size(); i++) {
+        if(searchGroups[i] && tries[i].isAvail) {
+          std::string prefix;
+
+          CollectFuzzyPrefixes(tries[i],
+                               query,
+                               maxDistance,
+                               distances,
+                               prefix,
+                               prefixes[i]);
+
+          completeOnly[i].resize(prefixes[i].size(),false);
+
+          for(size_t p=0; p < prefixes[i].size(); p++) {
+            // If a shorter prefix is at least as close to the query, it
+            // already delivers the texts of this prefix with a better or equal
+            // distance. Only texts equal to the prefix itself may rank better.
+            for(size_t a=0; a < prefixes[i].size(); a++) {
+              if(prefixes[i][a].distance <= prefixes[i][p].distance &&
+                 prefixes[i][a].prefix.length() < prefixes[i][p].prefix.length() &&
+                 prefixes[i][p].prefix.compare(0,prefixes[i][a].prefix.length(),prefixes[i][a].prefix)==0) {
+                completeOnly[i][p]=true;
+                break;
+              }
+            }
+          }
+        }
+      }
+
+      for(size_t distance=0; distance <= maxDistance; distance++) {
+        for(size_t i=0; i < tries.size(); i++) {
+          for(size_t p=0; p < prefixes[i].size(); p++) {
+            if(prefixes[i][p].distance!=distance) {
+              continue;
+            }
+
+            CollectRankedResults(tries[i],
+                                 static_cast<ResultGroup>(i),
+                                 prefixes[i][p],
+                                 completeOnly[i][p],
+                                 limit,
+                                 textIndex[i],
+                                 results);
+          }
+        }
+
+        // All results have at most the current distance and thus rank better
+        // than the texts of the remaining prefixes
+        if(results.size() >= limit) {
+          break;
+        }
+      }
+    }
+    catch(const marisa::Exception &ex) {
+      log.Error() << "Error searching for text: " << ex.what();
+      return false;
+    }
+
+    std::sort(results.begin(),
+              results.end(),
+              RankedResultLess);
+
+    if(results.size() > limit) {
+      results.resize(limit);
+    }
+
+    return true;
+  }
+
+  bool TextSearchIndex::HasPrefix(const marisa::Trie& trie,
+                                  const std::string& prefix) const
+  {
+    marisa::Agent agent;
+
+    agent.set_query(prefix.c_str(),
+                    prefix.length());
+
+    return trie.predictive_search(agent);
+  }
+
+  /**
+   * Returns the lexicographically first text starting with the given prefix.
+   * The keys of a text come before the keys of longer texts, so if the
+   * prefix itself is a text, it is returned.
+   */
+  bool TextSearchIndex::GetFirstText(const TrieInfo& trie,
+                                     const std::string& prefix,
+                                     std::string& text) const
+  {
+    marisa::Agent agent;
+
+    agent.set_query(prefix.c_str(),
+                    prefix.length());
+
+    if(!trie.trie->predictive_search(agent)) {
+      return false;
+    }
+
+    std::string   result(agent.key().ptr(),
+                         agent.key().length());
+    ObjectFileRef ref;
+
+    splitSearchResult(result,text,ref);
+
+    return true;
+  }
+
+  /**
+   * Adds the texts that are longer than the given prefix and start with it,
+   * if there are at most maxKeys keys starting with the prefix. Returns
+   * false without adding any text otherwise.
+   */
+  bool TextSearchIndex::CollectLongerTexts(const TrieInfo& trie,
+                                           const std::string& prefix,
+                                           size_t maxKeys,
+                                           std::vector<std::string>& texts) const
+  {
+    marisa::Agent            agent;
+    std::vector<std::string> longerTexts;
+    size_t                   keyCount=0;
+
+    agent.set_query(prefix.c_str(),
+                    prefix.length());
+
+    while(trie.trie->predictive_search(agent)) {
+      keyCount++;
+
+      if(keyCount > maxKeys) {
+        return false;
+      }
+
+      std::string   result(agent.key().ptr(),
+                           agent.key().length());
+      std::string   text;
+      ObjectFileRef ref;
+
+      splitSearchResult(result,text,ref);
+
+      // The keys of a text are consecutive
+      if(text.length() > prefix.length() &&
+         (longerTexts.empty() || longerTexts.back()!=text)) {
+        longerTexts.push_back(text);
+      }
+    }
+
+    texts.insert(texts.end(),
+                 longerTexts.begin(),
+                 longerTexts.end());
+
+    return true;
+  }
+
+  /**
+   * Extends the given prefix by every byte of the alphabet of the trie and
+   * collects all prefixes within maxDistance of the query. distances holds
+   * the edit distances between the prefix and all prefixes of the query
+   * (a row of the Levenshtein matrix).
+   */
+  void TextSearchIndex::CollectFuzzyPrefixes(const TrieInfo& trie,
+                                             const std::string& query,
+                                             size_t maxDistance,
+                                             const std::vector<size_t>& distances,
+                                             std::string& prefix,
+                                             std::vector<FuzzyPrefix>& prefixes) const
+  {
+    std::vector<size_t> nextDistances(distances.size());
+
+    for(const auto c : trie.alphabet) {
+      size_t minDistance;
+
+      nextDistances[0]=distances[0]+1;
+      minDistance=nextDistances[0];
+
+      for(size_t i=1; i < nextDistances.size(); i++) {
+        size_t substitution=distances[i-1]+(query[i-1]==c ? 0 : 1);
+        size_t insertion=distances[i]+1;
+        size_t deletion=nextDistances[i-1]+1;
+
+        nextDistances[i]=std::min(substitution,std::min(insertion,deletion));
+        minDistance=std::min(minDistance,nextDistances[i]);
+      }
+
+      // No extension of this prefix can get closer to the query
+      if(minDistance > maxDistance) {
+        continue;
+      }
+
+      prefix.push_back(c);
+
+      if(HasPrefix(*trie.trie,
+                   prefix)) {
+        if(nextDistances[query.length()] <= maxDistance) {
+          FuzzyPrefix fuzzyPrefix;
+
+          fuzzyPrefix.prefix=prefix;
+          fuzzyPrefix.distance=nextDistances[query.length()];
+
+          prefixes.push_back(fuzzyPrefix);
+        }
+
+        CollectFuzzyPrefixes(trie,
+                             query,
+                             maxDistance,
+                             nextDistances,
+                             prefix,
+                             prefixes);
+      }
+
+      prefix.erase(prefix.length()-1);
+    }
+  }
+
+  /**
+   * Adds the best limit texts starting with the given prefix to the results
+   * or improves the rank of already found texts.
+   *
+   * All texts of a prefix share distance and group, so their rank only
+   * depends on the length (the complete match is the shortest text). The
+   * subtree of the prefix is thus traversed breadth first, one byte of the
+   * alphabet at a time, and the traversal stops as soon as limit texts are
+   * known that are not longer than the current length. Expanding a node
+   * costs one lookup per byte of the alphabet, so sparse subtrees with not
+   * more keys than that are enumerated directly instead. Only the objects
+   * of the kept texts are collected.
+   */
+  void TextSearchIndex::CollectRankedResults(const TrieInfo& trie,
+                                             ResultGroup group,
+                                             const FuzzyPrefix& prefix,
+                                             bool completeOnly,
+                                             size_t limit,
+                                             std::unordered_map<std::string,size_t>& textIndex,
+                                             std::vector<RankedResult>& results) const
+  {
+    std::vector<std::string> bestTexts;
+    std::vector<std::string> nodes;     // prefixes of the current length
+    std::vector<std::string> nextNodes;
+    std::string              firstText;
+    size_t                   length=prefix.prefix.length();
+    size_t                   shortTextCount=0; // texts not longer than length
+
+    if(!GetFirstText(trie,
+                     prefix.prefix,
+                     firstText)) {
+      return;
+    }
+
+    if(firstText.length()==length) {
+      bestTexts.push_back(firstText);
+      shortTextCount++;
+    }
+
+    if(!completeOnly) {
+      nodes.push_back(prefix.prefix);
+    }
+
+    while(!nodes.empty() &&
+          shortTextCount < limit) {
+      nextNodes.clear();
+      length++;
+
+      for(const auto& node : nodes) {
+        if(CollectLongerTexts(trie,
+                              node,
+                              trie.alphabet.length(),
+                              bestTexts)) {
+          continue;
+        }
+
+        for(const auto c : trie.alphabet) {
+          std::string child(node);
+
+          child.push_back(c);
+
+          if(!GetFirstText(trie,
+                           child,
+                           firstText)) {
+            continue;
+          }
+
+          if(firstText.length()==length) {
+            bestTexts.push_back(firstText);
+          }
+
+          nextNodes.push_back(child);
+        }
+      }
+
+      // All texts up to the current length are known now
+      shortTextCount=0;
+
+      for(const auto& text : bestTexts) {
+        if(text.length() <= length) {
+          shortTextCount++;
+        }
+      }
+
+      nodes.swap(nextNodes);
+    }
+
+    std::sort(bestTexts.begin(),
+              bestTexts.end(),
+              ShorterTextLess);
+
+    if(bestTexts.size() > limit) {
+      bestTexts.resize(limit);
+    }
+
+    for(const auto& text : bestTexts) {
+      bool isComplete=text.length()==prefix.prefix.length();
+
+      std::unordered_map<std::string,size_t>::const_iterator entry=textIndex.find(text);
+
+      if(entry!=textIndex.end()) {
+        RankedResult& rankedResult=results[entry->second];
+
+        // All objects of the text have already been collected
+        if(prefix.distance < rankedResult.distance ||
+           (prefix.distance==rankedResult.distance && isComplete)) {
+          rankedResult.distance=prefix.distance;
+          rankedResult.isComplete=isComplete;
+        }
+
+        continue;
+      }
+
+      RankedResult rankedResult;
+
+      rankedResult.text=text;
+      rankedResult.group=group;
+      rankedResult.distance=prefix.distance;
+      rankedResult.isComplete=isComplete;
+
+      CollectObjects(trie,
+                     text,
+                     rankedResult.objects);
+
+      textIndex.insert(std::make_pair(text,results.size()));
+      results.push_back(rankedResult);
+    }
+  }
+
+  /**
+   * Collects the objects carrying the given text. Because the text is
+   * terminated by a control character in the keys, its keys come first
+   * in the label ordered trie, followed by longer texts.
+   */
+  void TextSearchIndex::CollectObjects(const TrieInfo& trie,
+                                       const std::string& text,
+                                       std::vector<ObjectFileRef>& objects) const
+  {
+    marisa::Agent agent;
+
+    agent.set_query(text.c_str(),
+                    text.length());
+
+    while(trie.trie->predictive_search(agent)) {
+      std::string   result(agent.key().ptr(),
+                           agent.key().length());
+      std::string   resultText;
+      ObjectFileRef ref;
+
+      splitSearchResult(result,resultText,ref);
+
+      if(resultText!=text) {
+        break;
+      }
+
+      objects.push_back(ref);
+    }
+  }
+
   void TextSearchIndex::splitSearchResult(const std::string& result,
                                           std::string& text,
                                           ObjectFileRef& ref) const
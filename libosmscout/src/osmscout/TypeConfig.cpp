@@ -694,8 +694,109 @@ namespace osmscout {
     }
   }
 
+  void TypeConditionIndex::Clear()
+  {
+    entries.clear();
+    unconditionalEntries.clear();
+    tagEntries.clear();
+    tagValueEntries.clear();
+  }
+
+  void TypeConditionIndex::AddCondition(const TypeInfoRef& type,
+                                        const TypeInfo::TypeCondition& condition)
+  {
+    TagConditionKeys keys;
+    Entry            entry;
+    size_t           index=entries.size();
+
+    entry.type=type;
+    entry.types=condition.types;
+    entry.condition=condition.condition;
+
+    entries.push_back(entry);
+
+    if (!condition.condition->GetRequiredKeys(keys)) {
+      unconditionalEntries.push_back(index);
+      return;
+    }
+
+    for (const auto& tag : keys.tags) {
+      if (tag>=tagEntries.size()) {
+        tagEntries.resize(tag+1);
+      }
+
+      tagEntries[tag].push_back(index);
+    }
+
+    for (const auto& tagValue : keys.tagValues) {
+      if (tagValue.first>=tagValueEntries.size()) {
+        tagValueEntries.resize(tagValue.first+1);
+      }
+
+      tagValueEntries[tagValue.first][tagValue.second].push_back(index);
+    }
+  }
+
+  /**
+   * Return the first condition (in the order the conditions were added) that
+   * matches the given TagMap, or NULL if no condition matches.
+   */
+  const TypeConditionIndex::Entry* TypeConditionIndex::GetFirstMatch(const TagMap& tagMap) const
+  {
+    std::vector<size_t> candidates(unconditionalEntries);
+
+    for (const auto& tag : tagMap) {
+      if (tag.first<tagEntries.size()) {
+        const std::vector<size_t>& indexes=tagEntries[tag.first];
+
+        candidates.insert(candidates.end(),
+                          indexes.begin(),
+                          indexes.end());
+      }
+
+      if (tag.first<tagValueEntries.size() &&
+          !tagValueEntries[tag.first].empty()) {
+        auto value=tagValueEntries[tag.first].find(tag.second);
+
+        if (value!=tagValueEntries[tag.first].end()) {
+          candidates.insert(candidates.end(),
+                            value->second.begin(),
+                            value->second.end());
+        }
+      }
+    }
+
+    if (candidates.empty()) {
+      return NULL;
+    }
+
+    std::sort(candidates.begin(),
+              candidates.end());
+
+    size_t lastIndex=entries.size();
+
+    for (const auto& index : candidates) {
+      // A condition may be registered for more than one of the keys
+      if (index==lastIndex) {
+        continue;
+      }
+
+      lastIndex=index;
+
+      if (entries[index].condition->Evaluate(tagMap)) {
+        return &entries[index];
+      }
+    }
+
+    return NULL;
+  }
+
+  const uint32_t TypeConfig::fileFormatVersion;
+  const uint32_t TypeConfig::deltaEncodedCoordsFileFormatVersion;
+
   TypeConfig::TypeConfig()
-   : nextTagId(0),
+   : formatVersion(fileFormatVersion),
+     nextTagId(0),
      nodeTypIdBytes(1),
      wayTypIdBytes(1),
      areaTypIdBytes(1)
@@ -981,6 +1082,33 @@ namespace osmscout {
 
     types.push_back(typeInfo);
 
+    // Conditions are evaluated in the order of the types, so we just append them
+    for (const auto &cond : typeInfo->GetConditions()) {
+      if (typeInfo->CanBeNode() &&
+          (cond.types & TypeInfo::typeNode)) {
+        nodeTypeConditions.AddCondition(typeInfo,
+                                        cond);
+      }
+
+      if ((typeInfo->CanBeWay() || typeInfo->CanBeArea()) &&
+          ((cond.types & TypeInfo::typeWay) || (cond.types & TypeInfo::typeArea))) {
+        wayAreaTypeConditions.AddCondition(typeInfo,
+                                           cond);
+      }
+
+      if (typeInfo->CanBeArea() &&
+          (cond.types & TypeInfo::typeArea)) {
+        areaTypeConditions.AddCondition(typeInfo,
+                                        cond);
+      }
+
+      if (typeInfo->CanBeRelation() &&
+          (cond.types & TypeInfo::typeRelation)) {
+        relationTypeConditions.AddCondition(typeInfo,
+                                            cond);
+      }
+    }
+
     if (!typeInfo->GetIgnore() &&
         (typeInfo->CanBeNode() ||
          typeInfo->CanBeWay() ||
@@ -1112,21 +1240,10 @@ namespace osmscout {
       return typeInfoIgnore;
     }
 
-    for (const auto &type : types) {
-      if (!type->HasConditions() ||
-          !type->CanBeNode()) {
-        continue;
-      }
+    const TypeConditionIndex::Entry* match=nodeTypeConditions.GetFirstMatch(tagMap);
 
-      for (const auto &cond : type->GetConditions()) {
-        if (!(cond.types & TypeInfo::typeNode)) {
-          continue;
-        }
-
-        if (cond.condition->Evaluate(tagMap)) {
-          return type;
-        }
-      }
+    if (match!=NULL) {
+      return match->type;
     }
 
     return typeInfoIgnore;
@@ -1143,39 +1260,21 @@ namespace osmscout {
       return false;
     }
 
-    for (const auto &type : types) {
-      if (!((type->CanBeWay() ||
-             type->CanBeArea()) &&
-             type->HasConditions())) {
-        continue;
-      }
-
-      for (const auto &cond : type->GetConditions()) {
-        if (!((cond.types & TypeInfo::typeWay) ||
-              (cond.types & TypeInfo::typeArea))) {
-          continue;
-        }
+    const TypeConditionIndex::Entry* match=wayAreaTypeConditions.GetFirstMatch(tagMap);
 
-        if (cond.condition->Evaluate(tagMap)) {
-          if (wayType==typeInfoIgnore &&
-              (cond.types & TypeInfo::typeWay)) {
-            wayType=type;
-          }
+    if (match==NULL) {
+      return false;
+    }
 
-          if (areaType==typeInfoIgnore &&
-              (cond.types & TypeInfo::typeArea)) {
-            areaType=type;
-          }
+    if (match->types & TypeInfo::typeWay) {
+      wayType=match->type;
+    }
 
-          if (wayType!=typeInfoIgnore ||
-              areaType!=typeInfoIgnore) {
-            return true;
-          }
-        }
-      }
+    if (match->types & TypeInfo::typeArea) {
+      areaType=match->type;
     }
 
-    return false;
+    return true;
   }
 
   TypeInfoRef TypeConfig::GetRelationType(const TagMap& tagMap) const
@@ -1184,44 +1283,19 @@ namespace osmscout {
       return typeInfoIgnore;
     }
 
-    auto relationType=tagMap.find(tagType);
+    const TypeConditionIndex::Entry* match;
+    auto                             relationType=tagMap.find(tagType);
 
     if (relationType!=tagMap.end() &&
         relationType->second=="multipolygon") {
-      for (size_t i=0; i<types.size(); i++) {
-        if (!types[i]->HasConditions() ||
-            !types[i]->CanBeArea()) {
-          continue;
-        }
-
-        for (const auto &cond : types[i]->GetConditions()) {
-          if (!(cond.types & TypeInfo::typeArea)) {
-            continue;
-          }
-
-          if (cond.condition->Evaluate(tagMap)) {
-            return types[i];
-          }
-        }
-      }
+      match=areaTypeConditions.GetFirstMatch(tagMap);
     }
     else {
-      for (size_t i=0; i<types.size(); i++) {
-        if (!types[i]->HasConditions() ||
-            !types[i]->CanBeRelation()) {
-          continue;
-        }
-
-        for (const auto &cond : types[i]->GetConditions()) {
-          if (!(cond.types & TypeInfo::typeRelation)) {
-            continue;
-          }
+      match=relationTypeConditions.GetFirstMatch(tagMap);
+    }
 
-          if (cond.condition->Evaluate(tagMap)) {
-            return types[i];
-          }
-        }
-      }
+    if (match!=NULL) {
+      return match->type;
     }
 
     return typeInfoIgnore;
@@ -1357,8 +1431,10 @@ namespace osmscout {
      return false;
     }
 
-    // Tags
+    // File format version
 
+    // Files without version information start directly with the (never zero)
+    // number of tags, versioned files start with a zero followed by the version
     uint32_t tagCount;
 
     if (!scanner.ReadNumber(tagCount)) {
@@ -1366,6 +1442,24 @@ namespace osmscout {
       return false;
     }
 
+    if (tagCount==0) {
+      if (!(scanner.ReadNumber(formatVersion) &&
+            scanner.ReadNumber(tagCount))) {
+        log.Error() << "Format error in file '" << scanner.GetFilename() << "'";
+        return false;
+      }
+
+      if (formatVersion>fileFormatVersion) {
+        log.Error() << "File '" << scanner.GetFilename() << "' has unsupported format version " << formatVersion;
+        return false;
+      }
+    }
+    else {
+      formatVersion=0;
+    }
+
+    // Tags
+
     for (size_t i=1; i<=tagCount; i++) {
       TagId       requestedId;
       TagId       actualId;
@@ -1594,6 +1688,9 @@ namespace osmscout {
       return false;
     }
 
+    writer.WriteNumber((uint32_t)0);
+    writer.WriteNumber(formatVersion);
+
     writer.WriteNumber((uint32_t)tags.size());
     for (const auto &tag : tags) {
       writer.WriteNumber(tag.GetId());
@@ -36,6 +36,8 @@ namespace osmscout {
 
   bool WaterIndex::Load(const std::string& path)
   {
+    FileScanner scanner;
+
     datafilename=path+"/"+filepart;
 
     if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
@@ -89,7 +91,11 @@ namespace osmscout {
       return false;
     }
 
-    return scanner.Close();
+    if (!scanner.Close()) {
+      return false;
+    }
+
+    return scanners.Open(datafilename,FileScanner::LowMemRandom,true);
   }
 
   bool WaterIndex::GetRegions(double minlon,
@@ -115,13 +121,15 @@ namespace osmscout {
 
     tiles.clear();
 
-    if (!scanner.IsOpen()) {
-      if (!scanner.Open(datafilename,FileScanner::LowMemRandom,true)) {
-        log.Error() << "Error while opening " << scanner.GetFilename() << " for reading!";
-        return false;
-      }
+    PooledFileScanner pooledScanner(scanners);
+
+    if (!pooledScanner.IsValid()) {
+      log.Error() << "Error while opening " << datafilename << " for reading!";
+      return false;
     }
 
+    FileScanner& scanner=*pooledScanner;
+
     cx1=(uint32_t)floor((minlon+180.0)/levels[idx].cellWidth);
     cx2=(uint32_t)floor((maxlon+180.0)/levels[idx].cellWidth);
     cy1=(uint32_t)floor((minlat+90.0)/levels[idx].cellHeight);
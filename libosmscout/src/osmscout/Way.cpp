@@ -28,6 +28,28 @@
 
 namespace osmscout {
 
+  static inline bool ReadCoords(const TypeConfig& typeConfig,
+                                FileScanner& scanner,
+                                std::vector<GeoCoord>& nodes)
+  {
+    if (typeConfig.HasDeltaEncodedCoords()) {
+      return scanner.ReadDeltaEncoded(nodes);
+    }
+
+    return scanner.Read(nodes);
+  }
+
+  static inline bool WriteCoords(const TypeConfig& typeConfig,
+                                 FileWriter& writer,
+                                 const std::vector<GeoCoord>& nodes)
+  {
+    if (typeConfig.HasDeltaEncodedCoords()) {
+      return writer.WriteDeltaEncoded(nodes);
+    }
+
+    return writer.Write(nodes);
+  }
+
   bool Way::GetCenter(GeoCoord& center) const
   {
     if (nodes.empty()) {
@@ -138,7 +160,9 @@ namespace osmscout {
       return false;
     }
 
-    if (!scanner.Read(nodes)) {
+    if (!ReadCoords(typeConfig,
+                    scanner,
+                    nodes)) {
       return false;
     }
 
@@ -172,7 +196,9 @@ namespace osmscout {
       return false;
     }
 
-    if (!scanner.Read(nodes)) {
+    if (!ReadCoords(typeConfig,
+                    scanner,
+                    nodes)) {
       return false;
     }
 
@@ -241,7 +267,9 @@ namespace osmscout {
       return false;
     }
 
-    if (!writer.Write(nodes)) {
+    if (!WriteCoords(typeConfig,
+                     writer,
+                     nodes)) {
       return false;
     }
 
@@ -267,7 +295,9 @@ namespace osmscout {
       return false;
     }
 
-    if (!writer.Write(nodes)) {
+    if (!WriteCoords(typeConfig,
+                     writer,
+                     nodes)) {
       return false;
     }
 
@@ -2355,6 +2355,210 @@ namespace osmscout {
     return !HasError();
   }
 
+  /**
+   * Decode a variable length encoded unsigned number without checking for the
+   * end of the buffer. The caller must make sure, that at least 5 bytes are left.
+   */
+  static inline uint32_t DecodeVarUInt32Unchecked(const unsigned char*& data)
+  {
+    uint32_t value=*data & 0x7f;
+
+    if ((*(data++) & 0x80)==0) {
+      return value;
+    }
+
+    value|=static_cast<uint32_t>(*data & 0x7f) << 7;
+
+    if ((*(data++) & 0x80)==0) {
+      return value;
+    }
+
+    value|=static_cast<uint32_t>(*data & 0x7f) << 14;
+
+    if ((*(data++) & 0x80)==0) {
+      return value;
+    }
+
+    value|=static_cast<uint32_t>(*data & 0x7f) << 21;
+
+    if ((*(data++) & 0x80)==0) {
+      return value;
+    }
+
+    value|=static_cast<uint32_t>(*(data++)) << 28;
+
+    return value;
+  }
+
+  /**
+   * Decode a variable length encoded unsigned number, checking for the end
+   * of the buffer for each byte.
+   */
+  static inline bool DecodeVarUInt32(const unsigned char*& data,
+                                     const unsigned char* end,
+                                     uint32_t& value)
+  {
+    unsigned int shift=0;
+
+    value=0;
+
+    while (data<end && shift<=28) {
+      unsigned char byte=*(data++);
+
+      value|=static_cast<uint32_t>(byte & 0x7f) << shift;
+
+      if ((byte & 0x80)==0) {
+        return true;
+      }
+
+      shift+=7;
+    }
+
+    return false;
+  }
+
+  static inline uint32_t DecodeZigZag(uint32_t value)
+  {
+    return (value >> 1) ^ (0u-(value & 1));
+  }
+
+  /**
+   * Decode count coordinates as written by FileWriter::WriteDeltaEncoded()
+   * from the given buffer. Returns false, if the buffer does not contain exactly
+   * the expected amount of data.
+   */
+  static bool DecodeDeltaEncodedCoords(const unsigned char* data,
+                                       size_t bytes,
+                                       std::vector<GeoCoord>& nodes,
+                                       size_t count)
+  {
+    nodes.resize(count);
+
+    if (count==0) {
+      return bytes==0;
+    }
+
+    if (bytes<coordByteSize) {
+      return false;
+    }
+
+    const unsigned char* end=data+bytes;
+    // As long as there is space for two numbers of maximum length left, we
+    // can decode without checking for the end of the buffer
+    const unsigned char* safeEnd=bytes>=coordByteSize+10 ? end-10 : data;
+    uint32_t             latValue;
+    uint32_t             lonValue;
+    size_t               i=1;
+
+    latValue=  (data[0] <<  0)
+             | (data[1] <<  8)
+             | (data[2] << 16)
+             | ((data[6] & 0x0f) << 24);
+
+    lonValue=  (data[3] <<  0)
+             | (data[4] <<  8)
+             | (data[5] << 16)
+             | ((data[6] & 0xf0) << 20);
+
+    nodes[0].Set(latValue/latConversionFactor-90.0,
+                 lonValue/lonConversionFactor-180.0);
+
+    data+=coordByteSize;
+
+    while (i<count &&
+           data<=safeEnd) {
+      latValue+=DecodeZigZag(DecodeVarUInt32Unchecked(data));
+      lonValue+=DecodeZigZag(DecodeVarUInt32Unchecked(data));
+
+      nodes[i].Set(latValue/latConversionFactor-90.0,
+                   lonValue/lonConversionFactor-180.0);
+      i++;
+    }
+
+    while (i<count) {
+      uint32_t latDelta;
+      uint32_t lonDelta;
+
+      if (!DecodeVarUInt32(data,end,latDelta) ||
+          !DecodeVarUInt32(data,end,lonDelta)) {
+        return false;
+      }
+
+      latValue+=DecodeZigZag(latDelta);
+      lonValue+=DecodeZigZag(lonDelta);
+
+      nodes[i].Set(latValue/latConversionFactor-90.0,
+                   lonValue/lonConversionFactor-180.0);
+      i++;
+    }
+
+    return data==end;
+  }
+
+  bool FileScanner::ReadDeltaEncoded(std::vector<GeoCoord>& nodes)
+  {
+    uint32_t nodeCount;
+
+    if (!ReadNumber(nodeCount)) {
+      return false;
+    }
+
+    return ReadDeltaEncoded(nodes,
+                            nodeCount);
+  }
+
+  /**
+   * Read count coordinates as written by FileWriter::WriteDeltaEncoded().
+   */
+  bool FileScanner::ReadDeltaEncoded(std::vector<GeoCoord>& nodes,
+                                     size_t count)
+  {
+    uint32_t bytes;
+
+    if (!ReadNumber(bytes)) {
+      return false;
+    }
+
+    const unsigned char* data;
+
+#if defined(HAVE_MMAP) || defined(__WIN32__) || defined(WIN32)
+    if (buffer!=NULL) {
+      if (offset+(FileOffset)bytes>size) {
+        log.Error() << "Cannot read coordinates beyond end of file'"  << filename << "'";
+        hasError=true;
+        return false;
+      }
+
+      data=reinterpret_cast<const unsigned char*>(&buffer[offset]);
+      offset+=bytes;
+    }
+    else
+#endif
+    {
+      deltaBuffer.resize(bytes);
+
+      if (bytes>0 &&
+          fread(&deltaBuffer[0],1,bytes,file)!=bytes) {
+        log.Error() << "Cannot read coordinates beyond end of file'"  << filename << "'";
+        hasError=true;
+        return false;
+      }
+
+      data=deltaBuffer.empty() ? NULL : &deltaBuffer[0];
+    }
+
+    if (!DecodeDeltaEncodedCoords(data,
+                                  bytes,
+                                  nodes,
+                                  count)) {
+      log.Error() << "Cannot decode coordinates in file '"  << filename << "'";
+      hasError=true;
+      return false;
+    }
+
+    return true;
+  }
+
   bool FileScanner::ReadBox(GeoBox& box)
   {
     if (HasError()) {
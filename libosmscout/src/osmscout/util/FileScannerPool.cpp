@@ -0,0 +1,178 @@
+/*
+  This source is part of the libosmscout library
+  Copyright (C) 2015  Tim Teulings
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+*/
+
+#include <osmscout/util/FileScannerPool.h>
+
+#include <osmscout/util/Logger.h>
+
+namespace osmscout {
+
+  FileScannerPool::FileScannerPool()
+  : mode(FileScanner::Normal),
+    useMmap(false),
+    isOpen(false)
+  {
+    // no code
+  }
+
+  FileScannerPool::~FileScannerPool()
+  {
+    if (isOpen) {
+      Close();
+    }
+  }
+
+  /**
+   * Open the pool for the given file. The first scanner gets opened
+   * immediately to make sure that the file can be accessed.
+   */
+  bool FileScannerPool::Open(const std::string& filename,
+                             FileScanner::Mode mode,
+                             bool useMmap)
+  {
+    if (isOpen) {
+      log.Error() << "File '" << filename << "' already opened, cannot open it again!";
+      return false;
+    }
+
+    this->filename=filename;
+    this->mode=mode;
+    this->useMmap=useMmap;
+
+    FileScanner* scanner=new FileScanner();
+
+    if (!scanner->Open(filename,
+                       mode,
+                       useMmap)) {
+      delete scanner;
+      return false;
+    }
+
+    scanners.push_back(scanner);
+    isOpen=true;
+
+    return true;
+  }
+
+  /**
+   * Close all scanners of the pool
+   */
+  bool FileScannerPool::Close()
+  {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(mutex);
+#endif
+
+    bool success=true;
+
+    for (auto scanner : scanners) {
+      if (scanner->IsOpen() &&
+          !scanner->Close()) {
+        success=false;
+      }
+
+      delete scanner;
+    }
+
+    scanners.clear();
+    isOpen=false;
+
+    return success;
+  }
+
+  /**
+   * Return a scanner for exclusive use by the caller. The scanner
+   * must be handed back using Release().
+   *
+   * @return
+   *    The scanner or NULL, if no scanner could be opened
+   */
+  FileScanner* FileScannerPool::Acquire()
+  {
+    {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+      std::lock_guard<std::mutex> guard(mutex);
+#endif
+
+      if (!isOpen) {
+        return NULL;
+      }
+
+      if (!scanners.empty()) {
+        FileScanner* scanner=scanners.back();
+
+        scanners.pop_back();
+
+        return scanner;
+      }
+    }
+
+    FileScanner* scanner=new FileScanner();
+
+    if (!scanner->Open(filename,
+                       mode,
+                       useMmap)) {
+      log.Error() << "Error while opening '" << filename << "' for reading!";
+      delete scanner;
+      return NULL;
+    }
+
+    return scanner;
+  }
+
+  /**
+   * Hand back a scanner acquired by Acquire(). Scanners in an error
+   * state are closed and dropped.
+   */
+  void FileScannerPool::Release(FileScanner* scanner)
+  {
+    if (scanner==NULL) {
+      return;
+    }
+
+    if (!scanner->HasError()) {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+      std::lock_guard<std::mutex> guard(mutex);
+#endif
+
+      if (isOpen) {
+        scanners.push_back(scanner);
+        return;
+      }
+    }
+
+    if (scanner->IsOpen()) {
+      scanner->Close();
+    }
+
+    delete scanner;
+  }
+
+  PooledFileScanner::PooledFileScanner(FileScannerPool& pool)
+  : pool(pool),
+    scanner(pool.Acquire())
+  {
+    // no code
+  }
+
+  PooledFileScanner::~PooledFileScanner()
+  {
+    pool.Release(scanner);
+  }
+}
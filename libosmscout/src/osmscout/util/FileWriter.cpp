@@ -651,6 +651,70 @@ namespace osmscout {
     return true;
   }
 
+  /**
+   * Write the given nodes prefixed by their number, see
+   * WriteDeltaEncoded(const std::vector<GeoCoord>&,size_t) for details.
+   */
+  bool FileWriter::WriteDeltaEncoded(const std::vector<GeoCoord>& nodes)
+  {
+    if (!WriteNumber((uint32_t)nodes.size())) {
+      return false;
+    }
+
+    return WriteDeltaEncoded(nodes,
+                             nodes.size());
+  }
+
+  /**
+   * Write the first count nodes. Latitude and longitude are converted to
+   * the same fixed point representation as used by WriteCoord(). The first
+   * coordinate is stored like WriteCoord() does, all following coordinates
+   * relative to their predecessor. The differences are zigzag encoded
+   * (so that small negative values become small positive values) and
+   * written as variable length numbers.
+   *
+   * The encoded data is prefixed by its length in bytes, so the reader
+   * can fetch and decode the whole array in one go.
+   */
+  bool FileWriter::WriteDeltaEncoded(const std::vector<GeoCoord>& nodes,
+                                     size_t count)
+  {
+    if (count==0) {
+      return WriteNumber((uint32_t)0);
+    }
+
+    // Each following coordinate requires at most two times 5 bytes
+    deltaBuffer.resize(coordByteSize+(count-1)*10);
+
+    nodes[0].EncodeToBuffer(reinterpret_cast<unsigned char*>(&deltaBuffer[0]));
+
+    size_t  bytes=coordByteSize;
+    int32_t lastLat=(int32_t)round((nodes[0].GetLat()+90.0)*latConversionFactor);
+    int32_t lastLon=(int32_t)round((nodes[0].GetLon()+180.0)*lonConversionFactor);
+
+    for (size_t i=1; i<count; i++) {
+      int32_t latValue=(int32_t)round((nodes[i].GetLat()+90.0)*latConversionFactor);
+      int32_t lonValue=(int32_t)round((nodes[i].GetLon()+180.0)*lonConversionFactor);
+      int32_t latDelta=latValue-lastLat;
+      int32_t lonDelta=lonValue-lastLon;
+
+      bytes+=EncodeNumberUnsigned(((uint32_t)latDelta << 1) ^ (uint32_t)(latDelta >> 31),
+                                  &deltaBuffer[bytes]);
+      bytes+=EncodeNumberUnsigned(((uint32_t)lonDelta << 1) ^ (uint32_t)(lonDelta >> 31),
+                                  &deltaBuffer[bytes]);
+
+      lastLat=latValue;
+      lastLon=lonValue;
+    }
+
+    if (!WriteNumber((uint32_t)bytes)) {
+      return false;
+    }
+
+    return Write(&deltaBuffer[0],
+                 bytes);
+  }
+
   bool FileWriter::WriteTypeId(TypeId id, uint8_t maxBytes)
   {
     if (maxBytes==1) {
@@ -675,5 +675,111 @@ namespace osmscout {
     return true;
   }
 
-}
 
+  /**
+   * Create the index for the given area. The area must exist at least as long
+   * as the locator.
+   */
+  AreaPointLocator::AreaPointLocator(const std::vector<GeoCoord>& nodes)
+  : nodes(nodes),
+    minLat(0.0),
+    maxLat(0.0),
+    bandHeight(1.0),
+    bandCount(1)
+  {
+    if (nodes.empty()) {
+      bands.resize(bandCount);
+      return;
+    }
+
+    minLat=nodes[0].GetLat();
+    maxLat=nodes[0].GetLat();
+
+    for (const auto& node : nodes) {
+      minLat=std::min(minLat,node.GetLat());
+      maxLat=std::max(maxLat,node.GetLat());
+    }
+
+    // A few edges per band on average
+    bandCount=std::max((size_t)1,nodes.size()/4);
+
+    if (maxLat>minLat) {
+      bandHeight=(maxLat-minLat)/bandCount;
+    }
+
+    bands.resize(bandCount);
+
+    // Edge from node j to node i, as in GetRelationOfPointToArea()
+    for (size_t i=0, j=nodes.size()-1; i<nodes.size(); j=i++) {
+      size_t firstBand=GetBand(std::min(nodes[i].GetLat(),nodes[j].GetLat()));
+      size_t lastBand=GetBand(std::max(nodes[i].GetLat(),nodes[j].GetLat()));
+
+      for (size_t band=firstBand; band<=lastBand; band++) {
+        bands[band].push_back((uint32_t)i);
+      }
+    }
+  }
+
+  size_t AreaPointLocator::GetBand(double lat) const
+  {
+    // Monotonic in lat, so a point is always in one of the bands of all edges
+    // whose latitude range contains the latitude of the point
+    size_t band=(size_t)((lat-minLat)/bandHeight);
+
+    return std::min(band,bandCount-1);
+  }
+
+  /**
+   * Returns -1 if the point is outside the area, 0 if it is one of the nodes of
+   * the area and 1 if it is within the area (see GetRelationOfPointToArea()).
+   */
+  int AreaPointLocator::GetRelationOfPoint(const GeoCoord& point) const
+  {
+    if (nodes.empty() ||
+        point.GetLat()<minLat ||
+        point.GetLat()>maxLat) {
+      return -1;
+    }
+
+    bool c=false;
+
+    // Any node equal to the point is the start or the end of an edge in the band
+    // of the point, the parity of crossing edges does not depend on their order
+    for (const auto i : bands[GetBand(point.GetLat())]) {
+      size_t j=i==0 ? nodes.size()-1 : i-1;
+
+      if (point==nodes[i] ||
+          point==nodes[j]) {
+        return 0;
+      }
+
+      if ((((nodes[i].GetLat()<=point.GetLat()) && (point.GetLat()<nodes[j].GetLat())) ||
+           ((nodes[j].GetLat()<=point.GetLat()) && (point.GetLat()<nodes[i].GetLat()))) &&
+          (point.GetLon()<(nodes[j].GetLon()-nodes[i].GetLon())*(point.GetLat()-nodes[i].GetLat())/(nodes[j].GetLat()-nodes[i].GetLat())+
+           nodes[i].GetLon())) {
+        c=!c;
+      }
+    }
+
+    return c ? 1 : -1;
+  }
+
+  /**
+   * Returns the same result as IsAreaSubOfArea(area,nodes)
+   */
+  bool AreaPointLocator::IsSubArea(const std::vector<GeoCoord>& area) const
+  {
+    for (const auto& point : area) {
+      int relPos=GetRelationOfPoint(point);
+
+      if (relPos>0) {
+        return true;
+      }
+      else if (relPos<0) {
+        return false;
+      }
+    }
+
+    return false;
+  }
+}
@@ -21,60 +21,229 @@
 
 #include <limits>
 
+#include <osmscout/system/Assert.h>
+
 namespace osmscout {
 
+  /**
+   * Stores the given newly allocated array in ref, if ref is still empty.
+   * Returns false, if another thread was faster. In this case the caller
+   * must free the array and use the one stored by the other thread.
+   */
+#if defined(OSMSCOUT_HAVE_ATOMIC)
+  template<typename T>
+  static bool InstallArray(std::atomic<T*>& ref,
+                           T* array)
+  {
+    T* expected=NULL;
+
+    return ref.compare_exchange_strong(expected,
+                                       array);
+  }
+#else
+  template<typename T>
+  static bool InstallArray(T*& ref,
+                           T* array)
+  {
+    ref=array;
+
+    return true;
+  }
+#endif
+
   NodeUseMap::NodeUseMap()
-  : nodeCount(0)
+  : root(NULL),
+    nodeCount(0),
+    directoryCount(0),
+    pageCount(0)
   {
     // no code
   }
 
   NodeUseMap::~NodeUseMap()
   {
-    // no code
+    Clear();
   }
 
-  void NodeUseMap::SetNodeUsed(Id id)
+  /**
+   * Returns the overflow page with the given id, allocating it
+   * if necessary
+   */
+  NodeUseMap::Word* NodeUseMap::GetOverflowPage(PageId pageId)
   {
-    PageId resolvedId=id-std::numeric_limits<Id>::min();
-    PageId offset=resolvedId/(4096/2);
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(overflowMutex);
+#endif
 
-    Map::iterator entry=nodeUseMap.find(offset);
+    OverflowPageMap::const_iterator entry=overflowPages.find(pageId);
 
-    if (entry==nodeUseMap.end()) {
-      entry=nodeUseMap.insert(std::make_pair(offset,Bitset())).first;
+    if (entry!=overflowPages.end()) {
+      return entry->second;
     }
 
-    uint32_t index=(resolvedId%(4096/2))*2;
+    Word* page=new Word[pageWordCount]();
+
+    overflowPages.insert(std::make_pair(pageId,
+                                        page));
+    pageCount++;
 
-    if (entry->second[index+1]) {
+    return page;
+  }
+
+  /**
+   * Returns the overflow page with the given id or NULL, if no id of the
+   * page has been used yet
+   */
+  const NodeUseMap::Word* NodeUseMap::FindOverflowPage(PageId pageId) const
+  {
+#if defined(OSMSCOUT_HAVE_MUTEX)
+    std::lock_guard<std::mutex> guard(overflowMutex);
+#endif
+
+    OverflowPageMap::const_iterator entry=overflowPages.find(pageId);
+
+    if (entry==overflowPages.end()) {
+      return NULL;
+    }
+
+    return entry->second;
+  }
+
+  /**
+   * Returns the page with the given id, allocating it (and its directory)
+   * if necessary
+   */
+  NodeUseMap::Word* NodeUseMap::GetPage(PageId pageId)
+  {
+    PageId        directoryIndex=pageId >> directoryBits;
+    PageId        pageIndex=pageId & (directoryPageCount-1);
+    DirectoryRef* directories=root;
+
+    if (directoryIndex>=rootDirectoryCount) {
+      return GetOverflowPage(pageId);
+    }
+
+    if (directories==NULL) {
+      DirectoryRef* newDirectories=new DirectoryRef[rootDirectoryCount]();
+
+      if (!InstallArray(root,
+                        newDirectories)) {
+        delete [] newDirectories;
+      }
+
+      directories=root;
+    }
+
+    PageRef* pages=directories[directoryIndex];
+
+    if (pages==NULL) {
+      PageRef* newPages=new PageRef[directoryPageCount]();
+
+      if (InstallArray(directories[directoryIndex],
+                       newPages)) {
+        directoryCount++;
+      }
+      else {
+        delete [] newPages;
+      }
+
+      pages=directories[directoryIndex];
+    }
+
+    Word* page=pages[pageIndex];
+
+    if (page==NULL) {
+      Word* newPage=new Word[pageWordCount]();
+
+      if (InstallArray(pages[pageIndex],
+                       newPage)) {
+        pageCount++;
+      }
+      else {
+        delete [] newPage;
+      }
+
+      page=pages[pageIndex];
+    }
+
+    return page;
+  }
+
+  /**
+   * Returns the page with the given id or NULL, if no id of the page
+   * has been used yet
+   */
+  const NodeUseMap::Word* NodeUseMap::FindPage(PageId pageId) const
+  {
+    PageId        directoryIndex=pageId >> directoryBits;
+    PageId        pageIndex=pageId & (directoryPageCount-1);
+    DirectoryRef* directories=root;
+
+    if (directoryIndex>=rootDirectoryCount) {
+      return FindOverflowPage(pageId);
+    }
+
+    if (directories==NULL) {
+      return NULL;
+    }
+
+    PageRef* pages=directories[directoryIndex];
+
+    if (pages==NULL) {
+      return NULL;
+    }
+
+    return pages[pageIndex];
+  }
+
+  void NodeUseMap::SetNodeUsed(Id id)
+  {
+    PageId   resolvedId=id-std::numeric_limits<Id>::min();
+    Word*    page=GetPage(resolvedId >> pageBits);
+    size_t   index=resolvedId & (pageNodeCount-1);
+    Word&    word=page[index/32];
+    uint64_t usedOnce=uint64_t(1) << ((index%32)*2);
+    uint64_t usedTwice=usedOnce << 1;
+
+#if defined(OSMSCOUT_HAVE_ATOMIC)
+    uint64_t value=word.load();
+
+    if ((value & usedTwice)!=0) {
+      // do nothing
+    }
+    else if ((word.fetch_or(usedOnce) & usedOnce)!=0) {
+      word.fetch_or(usedTwice);
+    }
+    else {
+      nodeCount++;
+    }
+#else
+    if ((word & usedTwice)!=0) {
       // do nothing
     }
-    else if (entry->second[index]) {
-      entry->second.set(index+1);
+    else if ((word & usedOnce)!=0) {
+      word|=usedTwice;
     }
     else {
       nodeCount++;
-      entry->second.set(index);
+      word|=usedOnce;
     }
+#endif
   }
 
   bool NodeUseMap::IsNodeUsedAtLeastTwice(Id id) const
   {
-    PageId resolvedId=id-std::numeric_limits<Id>::min();
-    PageId offset=resolvedId/(4096/2);
+    PageId      resolvedId=id-std::numeric_limits<Id>::min();
+    const Word* page=FindPage(resolvedId >> pageBits);
 
-    Map::const_iterator entry=nodeUseMap.find(offset);
-
-    if (entry==nodeUseMap.end()) {
+    if (page==NULL) {
       return false;
     }
 
-    uint32_t index=(resolvedId%(4096/2))*2+1;
-
-    bool result=entry->second[index];
+    size_t   index=resolvedId & (pageNodeCount-1);
+    uint64_t usedTwice=uint64_t(2) << ((index%32)*2);
 
-    return result;
+    return (page[index/32] & usedTwice)!=0;
   }
 
   size_t NodeUseMap::GetNodeUsedCount() const
@@ -82,9 +251,56 @@ namespace osmscout {
     return nodeCount;
   }
 
+  /**
+   * Returns the number of bytes allocated for the directories and pages
+   */
+  size_t NodeUseMap::GetMemoryUsage() const
+  {
+    size_t memory=0;
+
+    if (root!=NULL) {
+      memory+=rootDirectoryCount*sizeof(DirectoryRef);
+    }
+
+    memory+=directoryCount*directoryPageCount*sizeof(PageRef);
+    memory+=pageCount*pageWordCount*sizeof(Word);
+
+    return memory;
+  }
+
   void NodeUseMap::Clear()
   {
-    nodeUseMap.clear();
+    DirectoryRef* directories=root;
+
+    if (directories!=NULL) {
+      for (size_t d=0; d<rootDirectoryCount; d++) {
+        PageRef* pages=directories[d];
+
+        if (pages==NULL) {
+          continue;
+        }
+
+        for (size_t p=0; p<directoryPageCount; p++) {
+          Word* page=pages[p];
+
+          delete [] page;
+        }
+
+        delete [] pages;
+      }
+
+      delete [] directories;
+    }
+
+    for (const auto& entry : overflowPages) {
+      delete [] entry.second;
+    }
+
+    overflowPages.clear();
+
+    root=NULL;
     nodeCount=0;
+    directoryCount=0;
+    pageCount=0;
   }
 }
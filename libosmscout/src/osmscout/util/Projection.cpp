@@ -51,11 +51,38 @@ namespace osmscout {
 
   static const double gradtorad=2*M_PI/360;
 
+  /**
+   * Returns the value at base advanced by index*stride bytes
+   */
+  static inline double& StridedValue(double* base,
+                                     size_t index,
+                                     size_t stride)
+  {
+    return *reinterpret_cast<double*>(reinterpret_cast<char*>(base)+index*stride);
+  }
+
   Projection::~Projection()
   {
     // no code
   }
 
+  bool Projection::GeoToPixel(const GeoCoord* coords,
+                              size_t count,
+                              double* x,
+                              double* y,
+                              size_t stride) const
+  {
+    for (size_t i=0; i<count; i++) {
+      if (!GeoToPixel(coords[i],
+                      StridedValue(x,i,stride),
+                      StridedValue(y,i,stride))) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
   MercatorProjection::MercatorProjection()
   : valid(false),
     lon(0),
@@ -270,6 +297,35 @@ namespace osmscout {
     return true;
   }
 
+  bool MercatorProjection::GeoToPixel(const GeoCoord* coords,
+                                      size_t count,
+                                      double* x,
+                                      double* y,
+                                      size_t stride) const
+  {
+    assert(valid);
+
+    if (angle!=0.0) {
+      return Projection::GeoToPixel(coords,
+                                    count,
+                                    x,
+                                    y,
+                                    stride);
+    }
+
+    // Same calculation as for a single coordinate, but without the
+    // virtual call and the rotation check for each coordinate
+    double canvasX=width/2;
+    double canvasY=height/2;
+
+    for (size_t i=0; i<count; i++) {
+      StridedValue(x,i,stride)=(coords[i].GetLon()-this->lon)*scaleGradtorad+canvasX;
+      StridedValue(y,i,stride)=canvasY-(atanh(sin(coords[i].GetLat()*gradtorad))-latOffset)*scale;
+    }
+
+    return true;
+  }
+
   bool MercatorProjection::GeoToPixel(const BatchTransformer& /*transformData*/) const
   {
     assert(false); //should not be called
@@ -325,6 +381,8 @@ namespace osmscout {
   : valid(false),
     tileX(0),
     tileY(0),
+    tileCountX(1),
+    tileCountY(1),
     magnification(0),
     dpi(96),
     width(256),
@@ -343,13 +401,16 @@ namespace osmscout {
   }
 
   bool TileProjection::Set(size_t tileX, size_t tileY,
+                           size_t tileCountX, size_t tileCountY,
                            const Magnification& magnification,
                            double dpi,
                            size_t width, size_t height)
   {
     if (valid &&
-        this->tileX==tileY &&
+        this->tileX==tileX &&
         this->tileY==tileY &&
+        this->tileCountX==tileCountX &&
+        this->tileCountY==tileCountY &&
         this->magnification==magnification &&
         this->dpi==dpi &&
         this->width==width &&
@@ -362,19 +423,21 @@ namespace osmscout {
     // Make a copy of the context information
     this->tileX=tileX;
     this->tileY=tileY;
+    this->tileCountX=tileCountX;
+    this->tileCountY=tileCountY;
     this->magnification=magnification;
     this->dpi=dpi;
     this->width=width;
     this->height=height;
 
-    latMin=TileYToLat(tileY+1,
+    latMin=TileYToLat(tileY+tileCountY,
                       magnification);
     latMax=TileYToLat(tileY,
                       magnification);
 
     lonMin=TileXToLon(tileX,
                       magnification);
-    lonMax=TileXToLon(tileX+1,
+    lonMax=TileXToLon(tileX+tileCountX,
                       magnification);
 
     lat=(latMin+latMax)/2;
@@ -468,6 +531,62 @@ namespace osmscout {
       return true;
     }
 
+    bool TileProjection::GeoToPixel(const GeoCoord* coords,
+                                    size_t count,
+                                    double* x,
+                                    double* y,
+                                    size_t stride) const
+    {
+      assert(valid);
+
+      v2df   gradtorad2=ARRAY2V2DF(sseGradtorad);
+      size_t i=0;
+
+      // Two independent pairs of coordinates per iteration, to keep the
+      // pipeline busy while the other pair waits for its results
+      for (; i+4<=count; i+=4) {
+        v2df lon1=_mm_setr_pd(coords[i].GetLon(),coords[i+1].GetLon());
+        v2df lat1=_mm_setr_pd(coords[i].GetLat(),coords[i+1].GetLat());
+        v2df lon2=_mm_setr_pd(coords[i+2].GetLon(),coords[i+3].GetLon());
+        v2df lat2=_mm_setr_pd(coords[i+2].GetLat(),coords[i+3].GetLat());
+
+        v2df x1=_mm_sub_pd(_mm_mul_pd(lon1,sse2ScaleGradtorad),sse2LonOffset);
+        v2df x2=_mm_sub_pd(_mm_mul_pd(lon2,sse2ScaleGradtorad),sse2LonOffset);
+        v2df y1=_mm_sub_pd(sse2Height,_mm_sub_pd(_mm_mul_pd(sse2Scale,atanh_sin_pd(_mm_mul_pd(lat1,gradtorad2))),sse2LatOffset));
+        v2df y2=_mm_sub_pd(sse2Height,_mm_sub_pd(_mm_mul_pd(sse2Scale,atanh_sin_pd(_mm_mul_pd(lat2,gradtorad2))),sse2LatOffset));
+
+        _mm_storel_pd(&StridedValue(x,i,stride),x1);
+        _mm_storeh_pd(&StridedValue(x,i+1,stride),x1);
+        _mm_storel_pd(&StridedValue(x,i+2,stride),x2);
+        _mm_storeh_pd(&StridedValue(x,i+3,stride),x2);
+        _mm_storel_pd(&StridedValue(y,i,stride),y1);
+        _mm_storeh_pd(&StridedValue(y,i+1,stride),y1);
+        _mm_storel_pd(&StridedValue(y,i+2,stride),y2);
+        _mm_storeh_pd(&StridedValue(y,i+3,stride),y2);
+      }
+
+      for (; i+2<=count; i+=2) {
+        v2df lon1=_mm_setr_pd(coords[i].GetLon(),coords[i+1].GetLon());
+        v2df lat1=_mm_setr_pd(coords[i].GetLat(),coords[i+1].GetLat());
+
+        v2df x1=_mm_sub_pd(_mm_mul_pd(lon1,sse2ScaleGradtorad),sse2LonOffset);
+        v2df y1=_mm_sub_pd(sse2Height,_mm_sub_pd(_mm_mul_pd(sse2Scale,atanh_sin_pd(_mm_mul_pd(lat1,gradtorad2))),sse2LatOffset));
+
+        _mm_storel_pd(&StridedValue(x,i,stride),x1);
+        _mm_storeh_pd(&StridedValue(x,i+1,stride),x1);
+        _mm_storel_pd(&StridedValue(y,i,stride),y1);
+        _mm_storeh_pd(&StridedValue(y,i+1,stride),y1);
+      }
+
+      for (; i<count; i++) {
+        GeoToPixel(coords[i],
+                   StridedValue(x,i,stride),
+                   StridedValue(y,i,stride));
+      }
+
+      return true;
+    }
+
   #else
 
     bool TileProjection::GeoToPixel(double lon, double lat,
@@ -492,6 +611,22 @@ namespace osmscout {
       return true;
     }
 
+    bool TileProjection::GeoToPixel(const GeoCoord* coords,
+                                    size_t count,
+                                    double* x,
+                                    double* y,
+                                    size_t stride) const
+    {
+      assert(valid);
+
+      for (size_t i=0; i<count; i++) {
+        StridedValue(x,i,stride)=coords[i].GetLon()*scaleGradtorad-lonOffset;
+        StridedValue(y,i,stride)=height-(scale*atanh(sin(coords[i].GetLat()*gradtorad))-latOffset);
+      }
+
+      return true;
+    }
+
     bool TileProjection::GeoToPixel(const BatchTransformer& /*transformData*/) const
     {
       assert(false); //should not be called
@@ -185,18 +185,18 @@ namespace osmscout {
   void TransPolygon::TransformGeoToPixel(const Projection& projection,
                                          const std::vector<GeoCoord>& nodes)
   {
-    Projection::BatchTransformer batchTransformer(projection);
-
     if (!nodes.empty()) {
       start=0;
       length=nodes.size();
       end=length-1;
 
+      projection.GeoToPixel(nodes.data(),
+                            length,
+                            &points[0].x,
+                            &points[0].y,
+                            sizeof(TransPoint));
+
       for (size_t i=start; i<=end; i++) {
-         batchTransformer.GeoToPixel(nodes[i].GetLon(),
-                                     nodes[i].GetLat(),
-                                     points[i].x,
-                                     points[i].y);
         points[i].draw=true;
       }
     }
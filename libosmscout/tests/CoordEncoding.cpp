@@ -0,0 +1,156 @@
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <osmscout/util/FileScanner.h>
+#include <osmscout/util/FileWriter.h>
+
+#include <osmscout/system/Math.h>
+
+int errors=0;
+
+static osmscout::GeoCoord GetExpectedCoord(const osmscout::GeoCoord& coord)
+{
+  uint32_t latValue=(uint32_t)round((coord.GetLat()+90.0)*osmscout::latConversionFactor);
+  uint32_t lonValue=(uint32_t)round((coord.GetLon()+180.0)*osmscout::lonConversionFactor);
+
+  return osmscout::GeoCoord(latValue/osmscout::latConversionFactor-90.0,
+                            lonValue/osmscout::lonConversionFactor-180.0);
+}
+
+static void CheckCoords(const std::string& context,
+                        const std::vector<osmscout::GeoCoord>& expected,
+                        const std::vector<osmscout::GeoCoord>& actual)
+{
+  if (expected.size()!=actual.size()) {
+    std::cerr << context << ": Expected " << expected.size() << " coordinates, got " << actual.size() << std::endl;
+    errors++;
+    return;
+  }
+
+  for (size_t i=0; i<expected.size(); i++) {
+    osmscout::GeoCoord expectedCoord=GetExpectedCoord(expected[i]);
+
+    if (!expectedCoord.IsEqual(actual[i])) {
+      std::cerr << context << ": Coordinate " << i << ": Expected " << expectedCoord.GetDisplayText() << ", got " << actual[i].GetDisplayText() << std::endl;
+      errors++;
+      return;
+    }
+  }
+}
+
+static void CheckFile(const std::vector<std::vector<osmscout::GeoCoord> >& arrays,
+                      bool useMmap)
+{
+  osmscout::FileScanner scanner;
+  std::string           context=useMmap ? "mmap" : "fread";
+
+  if (!scanner.Open("coords.dat",
+                    osmscout::FileScanner::Sequential,
+                    useMmap)) {
+    std::cerr << "Cannot open file for reading" << std::endl;
+    errors++;
+    return;
+  }
+
+  for (const auto& array : arrays) {
+    std::vector<osmscout::GeoCoord> nodes;
+
+    if (!scanner.ReadDeltaEncoded(nodes)) {
+      std::cerr << context << ": Cannot read coordinates" << std::endl;
+      errors++;
+      return;
+    }
+
+    CheckCoords(context+" ReadDeltaEncoded(nodes)",array,nodes);
+
+    if (!scanner.ReadDeltaEncoded(nodes,
+                                  array.size())) {
+      std::cerr << context << ": Cannot read coordinates" << std::endl;
+      errors++;
+      return;
+    }
+
+    CheckCoords(context+" ReadDeltaEncoded(nodes,count)",array,nodes);
+  }
+
+  // Reading more coordinates than stored must fail
+  std::vector<osmscout::GeoCoord> nodes;
+
+  if (scanner.ReadDeltaEncoded(nodes,
+                               arrays.back().size()+1)) {
+    std::cerr << context << ": Reading beyond the encoded data did not fail" << std::endl;
+    errors++;
+  }
+
+  scanner.Close();
+}
+
+int main()
+{
+  std::vector<std::vector<osmscout::GeoCoord> > arrays;
+
+  srand(42);
+
+  arrays.push_back(std::vector<osmscout::GeoCoord>());
+
+  // Single coordinates at the corners of the value range
+  arrays.push_back(std::vector<osmscout::GeoCoord>(1,osmscout::GeoCoord(-90.0,-180.0)));
+  arrays.push_back(std::vector<osmscout::GeoCoord>(1,osmscout::GeoCoord(90.0,180.0)));
+
+  // Maximum jumps in both directions
+  std::vector<osmscout::GeoCoord> jumps;
+
+  jumps.push_back(osmscout::GeoCoord(-90.0,-180.0));
+  jumps.push_back(osmscout::GeoCoord(90.0,180.0));
+  jumps.push_back(osmscout::GeoCoord(-90.0,-180.0));
+  jumps.push_back(osmscout::GeoCoord(0.0,0.0));
+  jumps.push_back(osmscout::GeoCoord(0.0,0.0));
+
+  arrays.push_back(jumps);
+
+  // Random walks, similar to the nodes of ways and areas
+  for (size_t a=0; a<100; a++) {
+    std::vector<osmscout::GeoCoord> walk;
+    double                          lat=-80.0+rand()*160.0/RAND_MAX;
+    double                          lon=-170.0+rand()*340.0/RAND_MAX;
+    size_t                          count=2+rand()%500;
+
+    for (size_t i=0; i<count; i++) {
+      lat+=(rand()-RAND_MAX/2)*0.001/RAND_MAX;
+      lon+=(rand()-RAND_MAX/2)*0.001/RAND_MAX;
+
+      walk.push_back(osmscout::GeoCoord(lat,lon));
+    }
+
+    arrays.push_back(walk);
+  }
+
+  osmscout::FileWriter writer;
+
+  if (!writer.Open("coords.dat")) {
+    std::cerr << "Cannot open file for writing" << std::endl;
+    return 1;
+  }
+
+  for (const auto& array : arrays) {
+    writer.WriteDeltaEncoded(array);
+    writer.WriteDeltaEncoded(array,
+                             array.size());
+  }
+
+  if (!writer.Close()) {
+    std::cerr << "Cannot write file" << std::endl;
+    return 1;
+  }
+
+  CheckFile(arrays,true);
+  CheckFile(arrays,false);
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
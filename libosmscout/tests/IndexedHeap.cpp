@@ -0,0 +1,89 @@
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <osmscout/util/IndexedHeap.h>
+
+int errors=0;
+
+struct ValueCompare
+{
+  const std::vector<double>* values;
+
+  ValueCompare(const std::vector<double>& values)
+  : values(&values)
+  {
+    // no code
+  }
+
+  bool operator()(size_t a, size_t b) const
+  {
+    return (*values)[a]<(*values)[b];
+  }
+};
+
+int main()
+{
+  std::vector<double>                 values;
+  osmscout::IndexedHeap<ValueCompare> heap((ValueCompare(values)));
+
+  srand(42);
+
+  for (size_t i=0; i<1000; i++) {
+    values.push_back(rand()%10000);
+    heap.Push(i);
+  }
+
+  if (heap.Size()!=1000) {
+    std::cerr << "Heap size is " << heap.Size() << " instead of 1000!" << std::endl;
+    errors++;
+  }
+
+  // Decrease the value of every third slot
+  for (size_t i=0; i<1000; i+=3) {
+    values[i]=values[i]/2;
+    heap.DecreaseKey(i);
+  }
+
+  double last=-1;
+
+  for (size_t i=0; i<500; i++) {
+    size_t slot=heap.Pop();
+
+    if (heap.Contains(slot)) {
+      std::cerr << "Slot " << slot << " still in heap after Pop()!" << std::endl;
+      errors++;
+    }
+
+    if (values[slot]<last) {
+      std::cerr << "Value " << values[slot] << " of slot " << slot << " is smaller than previous value " << last << "!" << std::endl;
+      errors++;
+    }
+
+    last=values[slot];
+  }
+
+  // Add some new slots after popping
+  for (size_t i=1000; i<1100; i++) {
+    values.push_back(last+rand()%10000);
+    heap.Push(i);
+  }
+
+  while (!heap.Empty()) {
+    size_t slot=heap.Pop();
+
+    if (values[slot]<last) {
+      std::cerr << "Value " << values[slot] << " of slot " << slot << " is smaller than previous value " << last << "!" << std::endl;
+      errors++;
+    }
+
+    last=values[slot];
+  }
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
@@ -0,0 +1,111 @@
+#include <iostream>
+
+#include <osmscout/util/NodeUseMap.h>
+
+int errors=0;
+
+int main()
+{
+  osmscout::NodeUseMap map;
+
+  if (map.IsNodeUsedAtLeastTwice(1)) {
+    std::cerr << "1 used twice in empty map!" << std::endl;
+    errors++;
+  }
+
+  if (map.GetMemoryUsage()!=0) {
+    std::cerr << "Empty map uses memory!" << std::endl;
+    errors++;
+  }
+
+  map.SetNodeUsed(1);
+
+  if (map.IsNodeUsedAtLeastTwice(1)) {
+    std::cerr << "1 used twice after one use!" << std::endl;
+    errors++;
+  }
+
+  map.SetNodeUsed(1);
+
+  if (!map.IsNodeUsedAtLeastTwice(1)) {
+    std::cerr << "1 not used twice after two uses!" << std::endl;
+    errors++;
+  }
+
+  map.SetNodeUsed(1);
+
+  if (!map.IsNodeUsedAtLeastTwice(1)) {
+    std::cerr << "1 not used twice after three uses!" << std::endl;
+    errors++;
+  }
+
+  // Every third id is used twice, crossing page and directory borders
+  for (osmscout::Id id=2; id<20000000; id+=3) {
+    map.SetNodeUsed(id);
+
+    if (id%2==0) {
+      map.SetNodeUsed(id);
+    }
+  }
+
+  for (osmscout::Id id=2; id<20000000; id++) {
+    bool expected=id%3==2 && id%2==0;
+
+    if (map.IsNodeUsedAtLeastTwice(id)!=expected) {
+      std::cerr << id << " has wrong use state!" << std::endl;
+      errors++;
+      break;
+    }
+  }
+
+  if (map.GetNodeUsedCount()!=1+(20000000-2+2)/3) {
+    std::cerr << "Wrong number of used nodes: " << map.GetNodeUsedCount() << std::endl;
+    errors++;
+  }
+
+  // Ids outside of the range covered by the directories
+  osmscout::Id largeIds[]={(osmscout::Id)1 << 38,
+                           ((osmscout::Id)1 << 38)+4097,
+                           (osmscout::Id)-2,
+                           (osmscout::Id)-1};
+
+  for (const auto id : largeIds) {
+    map.SetNodeUsed(id);
+    map.SetNodeUsed(id);
+  }
+
+  for (const auto id : largeIds) {
+    if (!map.IsNodeUsedAtLeastTwice(id)) {
+      std::cerr << id << " not used twice after two uses!" << std::endl;
+      errors++;
+    }
+  }
+
+  if (map.IsNodeUsedAtLeastTwice(((osmscout::Id)1 << 38)+1) ||
+      map.IsNodeUsedAtLeastTwice((osmscout::Id)-3) ||
+      map.IsNodeUsedAtLeastTwice((osmscout::Id)1 << 40)) {
+    std::cerr << "Unused large id has wrong use state!" << std::endl;
+    errors++;
+  }
+
+  if (map.GetNodeUsedCount()!=1+(20000000-2+2)/3+4) {
+    std::cerr << "Wrong number of used nodes: " << map.GetNodeUsedCount() << std::endl;
+    errors++;
+  }
+
+  map.Clear();
+
+  if (map.IsNodeUsedAtLeastTwice(1) ||
+      map.GetNodeUsedCount()!=0 ||
+      map.GetMemoryUsage()!=0) {
+    std::cerr << "Map not empty after Clear()!" << std::endl;
+    errors++;
+  }
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
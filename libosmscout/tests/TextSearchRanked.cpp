@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <marisa.h>
+
+#include <osmscout/TextSearchIndex.h>
+
+#include <osmscout/util/String.h>
+
+int errors=0;
+
+static const size_t offsetSizeBytes=4;
+
+struct Entry
+{
+  std::string text;
+  size_t      objectCount;
+};
+
+static std::string BuildKey(const std::string& text,
+                            osmscout::FileOffset offset)
+{
+  std::string key=text;
+
+  key.push_back((char)osmscout::refNode);
+
+  for (size_t i=0; i<offsetSizeBytes; i++) {
+    key.push_back((char)((offset >> ((offsetSizeBytes-1-i)*8)) & 0xff));
+  }
+
+  return key;
+}
+
+static void WriteTrie(const std::string& filename,
+                      const std::vector<Entry>& entries)
+{
+  marisa::Keyset    keyset;
+  std::string       offsetSizeBytesStr;
+  std::string       alphabetStr;
+  std::vector<bool> used(256,false);
+
+  offsetSizeBytesStr.push_back(4);
+  offsetSizeBytesStr+=osmscout::NumberToString(offsetSizeBytes);
+
+  keyset.push_back(offsetSizeBytesStr.c_str(),
+                   offsetSizeBytesStr.length());
+
+  osmscout::FileOffset offset=1;
+
+  for (const auto& entry : entries) {
+    for (size_t o=0; o<entry.objectCount; o++) {
+      std::string key=BuildKey(entry.text,
+                               offset++);
+
+      keyset.push_back(key.c_str(),
+                       key.length());
+    }
+
+    for (const auto c : entry.text) {
+      used[(unsigned char)c]=true;
+    }
+  }
+
+  alphabetStr.push_back(5);
+
+  for (size_t c=0x20; c<used.size(); c++) {
+    if (used[c]) {
+      alphabetStr.push_back((char)c);
+    }
+  }
+
+  keyset.push_back(alphabetStr.c_str(),
+                   alphabetStr.length());
+
+  marisa::Trie trie;
+
+  trie.build(keyset,
+             MARISA_DEFAULT_NUM_TRIES |
+             MARISA_BINARY_TAIL |
+             MARISA_LABEL_ORDER |
+             MARISA_DEFAULT_CACHE);
+  trie.save(filename.c_str());
+}
+
+static size_t EditDistance(const std::string& a,
+                           const std::string& b)
+{
+  std::vector<size_t> row(b.length()+1);
+
+  for (size_t j=0; j<row.size(); j++) {
+    row[j]=j;
+  }
+
+  for (size_t i=1; i<=a.length(); i++) {
+    size_t diagonal=row[0];
+
+    row[0]=i;
+
+    for (size_t j=1; j<=b.length(); j++) {
+      size_t above=row[j];
+
+      row[j]=std::min(diagonal+(a[i-1]==b[j-1] ? 0 : 1),
+                      std::min(row[j]+1,row[j-1]+1));
+      diagonal=above;
+    }
+  }
+
+  return row[b.length()];
+}
+
+/**
+ * Same order as used by TextSearchIndex::SearchRanked()
+ */
+static bool ResultLess(const osmscout::TextSearchIndex::RankedResult& a,
+                       const osmscout::TextSearchIndex::RankedResult& b)
+{
+  static const size_t groupRank[]={2,1,0,3};
+
+  if (a.distance!=b.distance) {
+    return a.distance<b.distance;
+  }
+
+  if (a.isComplete!=b.isComplete) {
+    return a.isComplete;
+  }
+
+  if (a.group!=b.group) {
+    return groupRank[a.group]<groupRank[b.group];
+  }
+
+  if (a.text.length()!=b.text.length()) {
+    return a.text.length()<b.text.length();
+  }
+
+  return a.text<b.text;
+}
+
+/**
+ * Ranks all texts of all groups by brute force
+ */
+static void SearchBruteForce(const std::vector<std::vector<Entry> >& groups,
+                             const std::string& query,
+                             size_t maxDistance,
+                             size_t limit,
+                             std::vector<osmscout::TextSearchIndex::RankedResult>& results)
+{
+  results.clear();
+
+  for (size_t g=0; g<groups.size(); g++) {
+    for (const auto& entry : groups[g]) {
+      size_t distance=maxDistance+1;
+
+      for (size_t length=1; length<=entry.text.length(); length++) {
+        distance=std::min(distance,
+                          EditDistance(query,
+                                       entry.text.substr(0,length)));
+      }
+
+      if (distance>maxDistance) {
+        continue;
+      }
+
+      osmscout::TextSearchIndex::RankedResult result;
+
+      result.text=entry.text;
+      result.group=static_cast<osmscout::TextSearchIndex::ResultGroup>(g);
+      result.distance=distance;
+      result.isComplete=EditDistance(query,entry.text)==distance;
+
+      results.push_back(result);
+    }
+  }
+
+  std::sort(results.begin(),
+            results.end(),
+            ResultLess);
+
+  if (results.size()>limit) {
+    results.resize(limit);
+  }
+}
+
+static size_t GetObjectCount(const std::vector<Entry>& entries,
+                             const std::string& text)
+{
+  for (const auto& entry : entries) {
+    if (entry.text==text) {
+      return entry.objectCount;
+    }
+  }
+
+  return 0;
+}
+
+static void CheckSearch(const osmscout::TextSearchIndex& index,
+                        const std::vector<std::vector<Entry> >& groups,
+                        const std::string& query,
+                        size_t maxDistance,
+                        size_t limit)
+{
+  std::vector<osmscout::TextSearchIndex::RankedResult> results;
+  std::vector<osmscout::TextSearchIndex::RankedResult> expected;
+
+  if (!index.SearchRanked(query,
+                          true,
+                          true,
+                          true,
+                          true,
+                          maxDistance,
+                          limit,
+                          results)) {
+    std::cerr << "Search for '" << query << "' failed!" << std::endl;
+    errors++;
+    return;
+  }
+
+  SearchBruteForce(groups,
+                   query,
+                   maxDistance,
+                   limit,
+                   expected);
+
+  if (results.size()!=expected.size()) {
+    std::cerr << "Search for '" << query << "' (" << maxDistance << "/" << limit << ") returns " << results.size() << " instead of " << expected.size() << " results!" << std::endl;
+    errors++;
+    return;
+  }
+
+  for (size_t i=0; i<results.size(); i++) {
+    if (results[i].text!=expected[i].text ||
+        results[i].group!=expected[i].group ||
+        results[i].distance!=expected[i].distance ||
+        results[i].isComplete!=expected[i].isComplete) {
+      std::cerr << "Search for '" << query << "' (" << maxDistance << "/" << limit << ") returns '" << results[i].text << "' instead of '" << expected[i].text << "' at rank " << i << "!" << std::endl;
+      errors++;
+      return;
+    }
+
+    if (results[i].objects.size()!=GetObjectCount(groups[results[i].group],
+                                                  results[i].text)) {
+      std::cerr << "Search for '" << query << "' returns " << results[i].objects.size() << " objects for '" << results[i].text << "'!" << std::endl;
+      errors++;
+      return;
+    }
+  }
+}
+
+static void AddEntry(std::vector<Entry>& entries,
+                     const std::string& text,
+                     size_t objectCount)
+{
+  Entry entry;
+
+  entry.text=text;
+  entry.objectCount=objectCount;
+
+  entries.push_back(entry);
+}
+
+int main()
+{
+  std::vector<std::vector<Entry> > groups(4);
+
+  // Many texts, that come before the shorter "Bernstrasse" in label order
+  for (size_t i=0; i<50; i++) {
+    AddEntry(groups[osmscout::TextSearchIndex::groupLocation],
+             "Bergstrasse "+osmscout::NumberToString(i),
+             1);
+  }
+
+  AddEntry(groups[osmscout::TextSearchIndex::groupRegion],"Berg",1);
+  AddEntry(groups[osmscout::TextSearchIndex::groupRegion],"Bergheim",2);
+  AddEntry(groups[osmscout::TextSearchIndex::groupRegion],"Berlin",3);
+  AddEntry(groups[osmscout::TextSearchIndex::groupRegion],"Bern",1);
+  AddEntry(groups[osmscout::TextSearchIndex::groupLocation],"Berliner Allee",2);
+  AddEntry(groups[osmscout::TextSearchIndex::groupLocation],"Bernstrasse",1);
+  AddEntry(groups[osmscout::TextSearchIndex::groupPOI],"Berlin",1);
+  AddEntry(groups[osmscout::TextSearchIndex::groupPOI],"Bar",4);
+  AddEntry(groups[osmscout::TextSearchIndex::groupPOI],"Bakery Berlin",1);
+  AddEntry(groups[osmscout::TextSearchIndex::groupOther],"Berlin Wall",1);
+  AddEntry(groups[osmscout::TextSearchIndex::groupOther],"Brandenburg Gate",1);
+
+  // Random texts over a small alphabet, to get many near matches
+  srand(42);
+
+  for (size_t i=0; i<400; i++) {
+    std::string text;
+    size_t      length=1+rand()%8;
+
+    for (size_t c=0; c<length; c++) {
+      text.push_back("abcd"[rand()%4]);
+    }
+
+    std::vector<Entry>& entries=groups[rand()%4];
+
+    if (GetObjectCount(entries,text)==0) {
+      AddEntry(entries,text,1+rand()%3);
+    }
+  }
+
+  WriteTrie("textpoi.dat",groups[osmscout::TextSearchIndex::groupPOI]);
+  WriteTrie("textloc.dat",groups[osmscout::TextSearchIndex::groupLocation]);
+  WriteTrie("textregion.dat",groups[osmscout::TextSearchIndex::groupRegion]);
+  WriteTrie("textother.dat",groups[osmscout::TextSearchIndex::groupOther]);
+
+  osmscout::TextSearchIndex index;
+
+  if (!index.Load(".")) {
+    std::cerr << "Cannot load text index!" << std::endl;
+    return 1;
+  }
+
+  std::vector<osmscout::TextSearchIndex::RankedResult> results;
+
+  if (!index.SearchRanked("Ber",
+                          false,
+                          false,
+                          true,
+                          false,
+                          0,
+                          3,
+                          results) ||
+      results.size()!=3 ||
+      results[0].text!="Berg" ||
+      results[1].text!="Bern" ||
+      results[2].text!="Berlin") {
+    std::cerr << "Short texts are pushed out by texts earlier in label order!" << std::endl;
+    errors++;
+  }
+
+  const char* queries[]={"Ber","Berl","Brelin","Berlni","B","Bar","a","ab","abc","abcd","dcba","bad","ccc"};
+
+  for (const auto query : queries) {
+    for (size_t maxDistance=0; maxDistance<=2; maxDistance++) {
+      CheckSearch(index,groups,query,maxDistance,1);
+      CheckSearch(index,groups,query,maxDistance,5);
+      CheckSearch(index,groups,query,maxDistance,20);
+      CheckSearch(index,groups,query,maxDistance,10000);
+    }
+  }
+
+  if (errors!=0) {
+    return 1;
+  }
+  else {
+    return 0;
+  }
+}
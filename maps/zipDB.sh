@@ -30,6 +30,8 @@ zip -u -9 -du \
     "$mapDirectory/areasopt.dat" \
     "$mapDirectory/waysopt.dat" \
     "$mapDirectory/location.idx" \
+    "$mapDirectory/locationsearch.idx" \
+    "$mapDirectory/reverselocation.idx" \
     "$mapDirectory/water.idx" \
     "$mapDirectory/intersections.dat" \
     "$mapDirectory/intersections.idx" \
@@ -55,6 +55,9 @@
 /* system header <thread> is available */
 #define OSMSCOUT_HAVE_THREAD 1
 
+/* standard library has support for mutex */
+#define OSMSCOUT_HAVE_MUTEX 1
+
 /* libmarisa is available */
 /* #undef OSMSCOUT_HAVE_LIB_MARISA 1 */
 